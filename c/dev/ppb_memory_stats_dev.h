@@ -0,0 +1,78 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_C_DEV_PPB_MEMORY_STATS_DEV_H_
+#define PPAPI_C_DEV_PPB_MEMORY_STATS_DEV_H_
+
+#include "ppapi/c/pp_module.h"
+#include "ppapi/c/pp_stdint.h"
+
+#define PPB_MEMORY_STATS_DEV_INTERFACE "PPB_MemoryStats(Dev);0.1"
+
+// The kinds of objects whose lifetimes are accounted for.
+typedef enum {
+  PP_MEMORYSTATSCATEGORY_IMAGEDATA = 0,
+  PP_MEMORYSTATSCATEGORY_BUFFER = 1,
+  PP_MEMORYSTATSCATEGORY_URLLOADER = 2,
+  PP_MEMORYSTATSCATEGORY_FILEIO = 3,
+  PP_MEMORYSTATSCATEGORY_STRINGVAR = 4,
+  PP_MEMORYSTATSCATEGORY_OBJECTVAR = 5,
+  // Blocks handed out by PPB_Core.MemAlloc. MemAlloc isn't associated with a
+  // module, so this category covers the whole process whatever module is
+  // asked for.
+  PP_MEMORYSTATSCATEGORY_MEMALLOC = 6,
+  PP_MEMORYSTATSCATEGORY_BINARYARRAYVAR = 7,
+
+  // Number of categories; not a category itself.
+  PP_MEMORYSTATSCATEGORY_COUNT = 8
+} PP_MemoryStatsCategory_Dev;
+
+struct PP_MemoryStats_Dev {
+  // Objects (or MemAlloc blocks) currently alive, and their total size in
+  // bytes. The size is the payload the plugin sees: pixels for image data,
+  // characters for strings, elements for binary arrays, the requested size
+  // for MemAlloc. Objects without a meaningful payload, such as FileIO, have
+  // a size of 0.
+  uint32_t live_count;
+  uint64_t live_bytes;
+
+  // High-water marks of the above since accounting was enabled or the peaks
+  // were last reset.
+  uint32_t peak_count;
+  uint64_t peak_bytes;
+
+  // Number of objects created since accounting was enabled.
+  uint64_t total_count;
+};
+
+// This interface keeps count of the objects a module creates, so that leaks
+// and memory spikes can be found under load. Like PPB_Testing_Dev, it is
+// meant for testing and diagnostics and may not be available.
+//
+// Accounting is off by default and costs next to nothing until it is turned
+// on. Only objects created while it is on are counted, so enable it before
+// the code being measured runs.
+struct PPB_MemoryStats_Dev {
+  // Turns accounting on or off. Turning it off discards all counts.
+  void (*SetEnabled)(bool enabled);
+
+  // Returns true if accounting is on.
+  bool (*IsEnabled)();
+
+  // Fills |stats| with the counts for the given module and category. Returns
+  // false if accounting is off or the category is invalid.
+  bool (*GetStats)(PP_Module module,
+                   PP_MemoryStatsCategory_Dev category,
+                   struct PP_MemoryStats_Dev* stats);
+
+  // Resets the high-water marks of every category of the module to the
+  // current live values.
+  void (*ResetPeaks)(PP_Module module);
+
+  // Writes the counts of every category of the module to the log of the
+  // implementation (stderr for the headless host and the NaCl proxy).
+  void (*Dump)(PP_Module module);
+};
+
+#endif  // PPAPI_C_DEV_PPB_MEMORY_STATS_DEV_H_
@@ -5,13 +5,14 @@
 #ifndef PPAPI_C_PPB_VAR_DEPRECATED_H_
 #define PPAPI_C_PPB_VAR_DEPRECATED_H_
 
+#include "ppapi/c/pp_macros.h"
 #include "ppapi/c/pp_module.h"
 #include "ppapi/c/pp_stdint.h"
 #include "ppapi/c/pp_var.h"
 
 struct PPP_Class_Deprecated;
 
-#define PPB_VAR_DEPRECATED_INTERFACE "PPB_Var(Deprecated);0.1"
+#define PPB_VAR_DEPRECATED_INTERFACE "PPB_Var(Deprecated);0.3"
 
 /**
  * @file
@@ -24,6 +25,33 @@ struct PPP_Class_Deprecated;
  * @{
  */
 
+/**
+ * The element types of a PP_VARTYPE_BINARY_ARRAY var.
+ */
+typedef enum {
+  PP_BINARYARRAYTYPE_UINT8 = 0,
+  PP_BINARYARRAYTYPE_INT32 = 1,
+  PP_BINARYARRAYTYPE_FLOAT32 = 2,
+  PP_BINARYARRAYTYPE_FLOAT64 = 3
+} PP_BinaryArrayType;
+
+/**
+ * Returns the size in bytes of one element of the given type, or 0 if the
+ * type isn't one of the above.
+ */
+PP_INLINE uint32_t PP_BinaryArrayElementSize(PP_BinaryArrayType type) {
+  switch (type) {
+    case PP_BINARYARRAYTYPE_UINT8:
+      return 1;
+    case PP_BINARYARRAYTYPE_INT32:
+    case PP_BINARYARRAYTYPE_FLOAT32:
+      return 4;
+    case PP_BINARYARRAYTYPE_FLOAT64:
+      return 8;
+  }
+  return 0;
+}
+
 struct PPB_Var_Deprecated {
   /**
    * Adds a reference to the given var. If this is not a refcounted object,
@@ -233,6 +261,82 @@ struct PPB_Var_Deprecated {
   struct PP_Var (*CreateObject)(PP_Module module,
                                 const struct PPP_Class_Deprecated* object_class,
                                 void* object_data);
+
+  /**
+   * Creates a binary array var of |count| elements of the given type. This is
+   * how bulk numeric data crosses to and from script in one piece, instead of
+   * a GetProperty or SetProperty call per element.
+   *
+   * The elements are copied from |data|, which must hold |count| elements of
+   * the type in the machine's byte order. If |data| is NULL they are set to
+   * zero. The resulting var will be AddRef()ed for the caller, like strings.
+   *
+   * On error (an unknown type, or out of memory), this function will return a
+   * Null var.
+   */
+  struct PP_Var (*CreateBinaryArray)(PP_Module module,
+                                     PP_BinaryArrayType type,
+                                     uint32_t count,
+                                     const void* data);
+
+  /**
+   * Returns a pointer to the elements of a binary array var, and puts their
+   * type in |*type| and their number in |*count|. The elements are packed, in
+   * the machine's byte order, and may be both read and written; writes are
+   * seen by every holder of the var. A non-empty array's elements are aligned
+   * for their type.
+   *
+   * If the var is not a binary array, this function will return NULL and
+   * |*count| will be 0.
+   *
+   * Like VarToUtf8, the returned buffer is only valid while the var is alive.
+   */
+  void* (*BinaryArrayData)(struct PP_Var var,
+                           PP_BinaryArrayType* type,
+                           uint32_t* count);
+
+  /**
+   * Gets the values of |count| properties of the given object in one call.
+   * For an object in another process this is one round trip instead of one
+   * per property, so it's the way to read an object's fields.
+   *
+   * The value of |names[i]| is put in |values[i]|, AddRef()ed for the
+   * caller like the return value of GetProperty(). If getting a property
+   * sets the exception, that property and the ones after it are Undefined.
+   * The exception will be set, if it is non-NULL, on failure.
+   */
+  void (*GetProperties)(struct PP_Var object,
+                        uint32_t count,
+                        const struct PP_Var names[],
+                        struct PP_Var values[],
+                        struct PP_Var* exception);
+
+  /**
+   * Sets |count| properties of the given object in one call, |names[i]| to
+   * |values[i]|, in order. Stops at the first property that sets the
+   * exception. The exception will be set, if it is non-NULL, on failure.
+   */
+  void (*SetProperties)(struct PP_Var object,
+                        uint32_t count,
+                        const struct PP_Var names[],
+                        const struct PP_Var values[],
+                        struct PP_Var* exception);
+
+  /**
+   * Like GetAllPropertyNames(), but also gets the value of each property, so
+   * an object can be read whole in one call. |*values| is an array of
+   * |*property_count| values in the same order as |*names|; the caller
+   * releases both arrays and their contents like the result of
+   * GetAllPropertyNames().
+   *
+   * On failure, |*names| and |*values| will be set to NULL and
+   * |*property_count| will be set to 0.
+   */
+  void (*GetAllProperties)(struct PP_Var object,
+                           uint32_t* property_count,
+                           struct PP_Var** names,
+                           struct PP_Var** values,
+                           struct PP_Var* exception);
 };
 
 /**
@@ -0,0 +1,33 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_C_PP_MACROS_H_
+#define PPAPI_C_PP_MACROS_H_
+
+/**
+ * @file
+ * Defines macros shared by the C interface headers.
+ *
+ * @addtogroup PP
+ * @{
+ */
+
+/**
+ * Marks a function defined in a header. Plain C has no inline before C99,
+ * and a C99 inline function on its own doesn't give a definition to link
+ * against, so C gets a static function instead.
+ */
+#if defined(__cplusplus)
+#define PP_INLINE inline
+#elif defined(_MSC_VER)
+#define PP_INLINE static __inline
+#else
+#define PP_INLINE static __inline__
+#endif
+
+/**
+ * @}
+ * End addtogroup PP
+ */
+#endif  // PPAPI_C_PP_MACROS_H_
@@ -22,7 +22,12 @@ typedef enum {
   PP_VARTYPE_INT32,
   PP_VARTYPE_DOUBLE,
   PP_VARTYPE_STRING,
-  PP_VARTYPE_OBJECT
+  PP_VARTYPE_OBJECT,
+  /**
+   * A refcounted array of numbers of one type, stored packed so it can be
+   * read and written as a C array. See PPB_Var_Deprecated.CreateBinaryArray.
+   */
+  PP_VARTYPE_BINARY_ARRAY
 } PP_VarType;
 
 /**
@@ -45,9 +50,10 @@ struct PP_Var {
     double as_double;
 
     /**
-     * Internal ID for strings and objects. The identifier is an opaque handle
-     * assigned by the browser to the plugin. It is guaranteed never to be 0,
-     * so a plugin can initialize this ID to 0 to indicate a "NULL handle."
+     * Internal ID for strings, objects and binary arrays. The identifier is
+     * an opaque handle assigned by the browser to the plugin. It is
+     * guaranteed never to be 0, so a plugin can initialize this ID to 0 to
+     * indicate a "NULL handle."
      */
     int64_t as_id;
   } value;
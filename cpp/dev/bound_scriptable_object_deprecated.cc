@@ -0,0 +1,111 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/dev/bound_scriptable_object_deprecated.h"
+
+#include <string.h>
+
+#include "ppapi/c/dev/ppb_var_deprecated.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/cpp/module_impl.h"
+
+namespace {
+
+DeviceFuncs<PPB_Var_Deprecated> ppb_var_f(PPB_VAR_DEPRECATED_INTERFACE);
+
+// Seeds tried for a table size before it's doubled.
+const uint32_t kMaxSeedsPerSize = 32;
+
+// FNV-1a from a seeded start, with the high bits folded into the low ones
+// that pick the slot.
+uint32_t HashName(uint32_t seed, const char* data, size_t len) {
+  uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+  for (size_t i = 0; i < len; i++)
+    hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+  hash ^= hash >> 15;
+  hash *= 0x85EBCA6Bu;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+}  // namespace
+
+namespace pp {
+
+namespace deprecated {
+
+namespace internal {
+
+BoundMethodNames::BoundMethodNames() : seed_(0) {
+}
+
+BoundMethodNames::~BoundMethodNames() {
+}
+
+size_t BoundMethodNames::Add(const char* name) {
+  for (size_t i = 0; i < names_.size(); i++) {
+    if (names_[i] == name)
+      return i;
+  }
+  names_.push_back(name);
+  Rebuild();
+  return names_.size() - 1;
+}
+
+int32_t BoundMethodNames::Find(const PP_Var& name) const {
+  if (name.type != PP_VARTYPE_STRING || slots_.empty() || !ppb_var_f)
+    return -1;
+  uint32_t len;
+  const char* data = ppb_var_f->VarToUtf8(name, &len);
+  if (!data)
+    return -1;
+  int32_t index =
+      slots_[HashName(seed_, data, len) & (slots_.size() - 1)];
+  if (index < 0 || names_[index].size() != len ||
+      memcmp(names_[index].data(), data, len) != 0)
+    return -1;
+  return index;
+}
+
+void BoundMethodNames::Rebuild() {
+  // At least twice as many slots as names, so that a seed without
+  // collisions turns up quickly.
+  size_t size = 2;
+  while (size < names_.size() * 2)
+    size *= 2;
+  for (uint32_t seed = 0; ; seed++) {
+    if (seed > 0 && seed % kMaxSeedsPerSize == 0)
+      size *= 2;
+    slots_.assign(size, -1);
+    bool collided = false;
+    for (size_t i = 0; i < names_.size() && !collided; i++) {
+      int32_t& slot = slots_[HashName(seed, names_[i].data(),
+                                      names_[i].size()) & (size - 1)];
+      collided = slot >= 0;
+      slot = static_cast<int32_t>(i);
+    }
+    if (!collided) {
+      seed_ = seed;
+      return;
+    }
+  }
+}
+
+// static
+bool ScriptArg<std::string>::Get(const PP_Var& var, std::string* out) {
+  if (var.type != PP_VARTYPE_STRING || !ppb_var_f)
+    return false;
+  uint32_t len;
+  const char* data = ppb_var_f->VarToUtf8(var, &len);
+  if (!data)
+    return false;
+  out->assign(data, len);
+  return true;
+}
+
+}  // namespace internal
+
+}  // namespace deprecated
+
+}  // namespace pp
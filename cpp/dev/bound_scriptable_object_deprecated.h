@@ -0,0 +1,484 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_DEV_BOUND_SCRIPTABLE_OBJECT_DEPRECATED_H_
+#define PPAPI_CPP_DEV_BOUND_SCRIPTABLE_OBJECT_DEPRECATED_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/pp_var.h"
+#include "ppapi/cpp/dev/scriptable_object_deprecated.h"
+#include "ppapi/cpp/var.h"
+
+namespace pp {
+
+namespace deprecated {
+
+namespace internal {
+
+// The method names of a BoundScriptableObject class, looked up through a
+// perfect hash: the slots are rehashed with new seeds until every name has
+// one to itself, so finding a name hashes it once and compares it with the
+// single name in its slot.
+class BoundMethodNames {
+ public:
+  BoundMethodNames();
+  ~BoundMethodNames();
+
+  size_t size() const { return names_.size(); }
+  const std::string& name(size_t index) const { return names_[index]; }
+
+  // Returns the index of |name|, adding it if it's new.
+  size_t Add(const char* name);
+
+  // Returns the index of the method named by |name|, or -1 if it's not a
+  // string or not one of the names. The string isn't copied.
+  int32_t Find(const PP_Var& name) const;
+
+ private:
+  void Rebuild();
+
+  std::vector<std::string> names_;
+
+  uint32_t seed_;
+
+  // Indexed by the hash of a name; -1 for empty slots. The size is a power
+  // of two.
+  std::vector<int32_t> slots_;
+
+  // Disallow copy and assign (these are unimplemented).
+  BoundMethodNames(const BoundMethodNames&);
+  BoundMethodNames& operator=(const BoundMethodNames&);
+};
+
+// Converts an argument from script to a parameter of type |A|. Get returns
+// false if the var has the wrong type; Pass gives the converted value to the
+// method. Only the types specialized below can be parameters.
+template <class A> struct ScriptArg;
+
+template <class A> struct ScriptArg<const A&> : public ScriptArg<A> {};
+
+template <> struct ScriptArg<bool> {
+  typedef bool Type;
+  static bool Get(const PP_Var& var, bool* out) {
+    if (var.type != PP_VARTYPE_BOOL)
+      return false;
+    *out = var.value.as_bool;
+    return true;
+  }
+  static bool Pass(bool value) { return value; }
+};
+
+// Doubles with an integer value are taken too, since script doesn't tell
+// the two apart.
+template <> struct ScriptArg<int32_t> {
+  typedef int32_t Type;
+  static bool Get(const PP_Var& var, int32_t* out) {
+    if (var.type == PP_VARTYPE_INT32) {
+      *out = var.value.as_int;
+      return true;
+    }
+    if (var.type != PP_VARTYPE_DOUBLE ||
+        !(var.value.as_double >= -2147483648.0 &&
+          var.value.as_double <= 2147483647.0))
+      return false;
+    *out = static_cast<int32_t>(var.value.as_double);
+    return *out == var.value.as_double;
+  }
+  static int32_t Pass(int32_t value) { return value; }
+};
+
+template <> struct ScriptArg<double> {
+  typedef double Type;
+  static bool Get(const PP_Var& var, double* out) {
+    if (var.type == PP_VARTYPE_INT32)
+      *out = var.value.as_int;
+    else if (var.type == PP_VARTYPE_DOUBLE)
+      *out = var.value.as_double;
+    else
+      return false;
+    return true;
+  }
+  static double Pass(double value) { return value; }
+};
+
+template <> struct ScriptArg<std::string> {
+  typedef std::string Type;
+  static bool Get(const PP_Var& var, std::string* out);
+  static const std::string& Pass(const std::string& value) { return value; }
+};
+
+// Any var, unconverted. The method gets the caller's reference, so it has to
+// copy the Var to keep it.
+template <> struct ScriptArg<Var> {
+  typedef PP_Var Type;
+  static bool Get(const PP_Var& var, PP_Var* out) {
+    *out = var;
+    return true;
+  }
+  static Var Pass(const PP_Var& value) {
+    return Var(Var::DontManage(), value);
+  }
+};
+
+// Calls a method of type |M| of a |T| with the arguments from script,
+// converted to its parameter types. Sets |*converted| to false, without
+// calling the method, if they don't match.
+template <class T, class M> struct MethodInvoker;
+
+template <class T, class R>
+struct MethodInvoker<T, R (T::*)()> {
+  typedef R (T::*Method)();
+
+  static Var Invoke(T* object,
+                    Method method,
+                    uint32_t argc,
+                    const PP_Var*,
+                    bool* converted) {
+    *converted = argc == 0;
+    if (!*converted)
+      return Var();
+    return Var((object->*method)());
+  }
+};
+
+template <class T>
+struct MethodInvoker<T, void (T::*)()> {
+  typedef void (T::*Method)();
+
+  static Var Invoke(T* object,
+                    Method method,
+                    uint32_t argc,
+                    const PP_Var*,
+                    bool* converted) {
+    *converted = argc == 0;
+    if (*converted)
+      (object->*method)();
+    return Var();
+  }
+};
+
+template <class T, class R, class A1>
+struct MethodInvoker<T, R (T::*)(A1)> {
+  typedef R (T::*Method)(A1);
+
+  static Var Invoke(T* object,
+                    Method method,
+                    uint32_t argc,
+                    const PP_Var* argv,
+                    bool* converted) {
+    typename ScriptArg<A1>::Type a1 = typename ScriptArg<A1>::Type();
+    *converted = argc == 1 && ScriptArg<A1>::Get(argv[0], &a1);
+    if (!*converted)
+      return Var();
+    return Var((object->*method)(ScriptArg<A1>::Pass(a1)));
+  }
+};
+
+template <class T, class A1>
+struct MethodInvoker<T, void (T::*)(A1)> {
+  typedef void (T::*Method)(A1);
+
+  static Var Invoke(T* object,
+                    Method method,
+                    uint32_t argc,
+                    const PP_Var* argv,
+                    bool* converted) {
+    typename ScriptArg<A1>::Type a1 = typename ScriptArg<A1>::Type();
+    *converted = argc == 1 && ScriptArg<A1>::Get(argv[0], &a1);
+    if (*converted)
+      (object->*method)(ScriptArg<A1>::Pass(a1));
+    return Var();
+  }
+};
+
+template <class T, class R, class A1, class A2>
+struct MethodInvoker<T, R (T::*)(A1, A2)> {
+  typedef R (T::*Method)(A1, A2);
+
+  static Var Invoke(T* object,
+                    Method method,
+                    uint32_t argc,
+                    const PP_Var* argv,
+                    bool* converted) {
+    typename ScriptArg<A1>::Type a1 = typename ScriptArg<A1>::Type();
+    typename ScriptArg<A2>::Type a2 = typename ScriptArg<A2>::Type();
+    *converted = argc == 2 &&
+                 ScriptArg<A1>::Get(argv[0], &a1) &&
+                 ScriptArg<A2>::Get(argv[1], &a2);
+    if (!*converted)
+      return Var();
+    return Var((object->*method)(ScriptArg<A1>::Pass(a1),
+                                 ScriptArg<A2>::Pass(a2)));
+  }
+};
+
+template <class T, class A1, class A2>
+struct MethodInvoker<T, void (T::*)(A1, A2)> {
+  typedef void (T::*Method)(A1, A2);
+
+  static Var Invoke(T* object,
+                    Method method,
+                    uint32_t argc,
+                    const PP_Var* argv,
+                    bool* converted) {
+    typename ScriptArg<A1>::Type a1 = typename ScriptArg<A1>::Type();
+    typename ScriptArg<A2>::Type a2 = typename ScriptArg<A2>::Type();
+    *converted = argc == 2 &&
+                 ScriptArg<A1>::Get(argv[0], &a1) &&
+                 ScriptArg<A2>::Get(argv[1], &a2);
+    if (*converted)
+      (object->*method)(ScriptArg<A1>::Pass(a1), ScriptArg<A2>::Pass(a2));
+    return Var();
+  }
+};
+
+template <class T, class R, class A1, class A2, class A3>
+struct MethodInvoker<T, R (T::*)(A1, A2, A3)> {
+  typedef R (T::*Method)(A1, A2, A3);
+
+  static Var Invoke(T* object,
+                    Method method,
+                    uint32_t argc,
+                    const PP_Var* argv,
+                    bool* converted) {
+    typename ScriptArg<A1>::Type a1 = typename ScriptArg<A1>::Type();
+    typename ScriptArg<A2>::Type a2 = typename ScriptArg<A2>::Type();
+    typename ScriptArg<A3>::Type a3 = typename ScriptArg<A3>::Type();
+    *converted = argc == 3 &&
+                 ScriptArg<A1>::Get(argv[0], &a1) &&
+                 ScriptArg<A2>::Get(argv[1], &a2) &&
+                 ScriptArg<A3>::Get(argv[2], &a3);
+    if (!*converted)
+      return Var();
+    return Var((object->*method)(
+        ScriptArg<A1>::Pass(a1), ScriptArg<A2>::Pass(a2),
+        ScriptArg<A3>::Pass(a3)));
+  }
+};
+
+template <class T, class A1, class A2, class A3>
+struct MethodInvoker<T, void (T::*)(A1, A2, A3)> {
+  typedef void (T::*Method)(A1, A2, A3);
+
+  static Var Invoke(T* object,
+                    Method method,
+                    uint32_t argc,
+                    const PP_Var* argv,
+                    bool* converted) {
+    typename ScriptArg<A1>::Type a1 = typename ScriptArg<A1>::Type();
+    typename ScriptArg<A2>::Type a2 = typename ScriptArg<A2>::Type();
+    typename ScriptArg<A3>::Type a3 = typename ScriptArg<A3>::Type();
+    *converted = argc == 3 &&
+                 ScriptArg<A1>::Get(argv[0], &a1) &&
+                 ScriptArg<A2>::Get(argv[1], &a2) &&
+                 ScriptArg<A3>::Get(argv[2], &a3);
+    if (*converted) {
+      (object->*method)(
+          ScriptArg<A1>::Pass(a1), ScriptArg<A2>::Pass(a2),
+          ScriptArg<A3>::Pass(a3));
+    }
+    return Var();
+  }
+};
+
+template <class T, class R, class A1, class A2, class A3, class A4>
+struct MethodInvoker<T, R (T::*)(A1, A2, A3, A4)> {
+  typedef R (T::*Method)(A1, A2, A3, A4);
+
+  static Var Invoke(T* object,
+                    Method method,
+                    uint32_t argc,
+                    const PP_Var* argv,
+                    bool* converted) {
+    typename ScriptArg<A1>::Type a1 = typename ScriptArg<A1>::Type();
+    typename ScriptArg<A2>::Type a2 = typename ScriptArg<A2>::Type();
+    typename ScriptArg<A3>::Type a3 = typename ScriptArg<A3>::Type();
+    typename ScriptArg<A4>::Type a4 = typename ScriptArg<A4>::Type();
+    *converted = argc == 4 &&
+                 ScriptArg<A1>::Get(argv[0], &a1) &&
+                 ScriptArg<A2>::Get(argv[1], &a2) &&
+                 ScriptArg<A3>::Get(argv[2], &a3) &&
+                 ScriptArg<A4>::Get(argv[3], &a4);
+    if (!*converted)
+      return Var();
+    return Var((object->*method)(
+        ScriptArg<A1>::Pass(a1), ScriptArg<A2>::Pass(a2),
+        ScriptArg<A3>::Pass(a3), ScriptArg<A4>::Pass(a4)));
+  }
+};
+
+template <class T, class A1, class A2, class A3, class A4>
+struct MethodInvoker<T, void (T::*)(A1, A2, A3, A4)> {
+  typedef void (T::*Method)(A1, A2, A3, A4);
+
+  static Var Invoke(T* object,
+                    Method method,
+                    uint32_t argc,
+                    const PP_Var* argv,
+                    bool* converted) {
+    typename ScriptArg<A1>::Type a1 = typename ScriptArg<A1>::Type();
+    typename ScriptArg<A2>::Type a2 = typename ScriptArg<A2>::Type();
+    typename ScriptArg<A3>::Type a3 = typename ScriptArg<A3>::Type();
+    typename ScriptArg<A4>::Type a4 = typename ScriptArg<A4>::Type();
+    *converted = argc == 4 &&
+                 ScriptArg<A1>::Get(argv[0], &a1) &&
+                 ScriptArg<A2>::Get(argv[1], &a2) &&
+                 ScriptArg<A3>::Get(argv[2], &a3) &&
+                 ScriptArg<A4>::Get(argv[3], &a4);
+    if (*converted) {
+      (object->*method)(
+          ScriptArg<A1>::Pass(a1), ScriptArg<A2>::Pass(a2),
+          ScriptArg<A3>::Pass(a3), ScriptArg<A4>::Pass(a4));
+    }
+    return Var();
+  }
+};
+
+}  // namespace internal
+
+// A ScriptableObject whose methods are member functions of |T| with typed
+// parameters, bound by name once for the class. It replaces a hand-written
+// HasMethod and a Call comparing the name with each method it knows:
+//
+//   class Counter : public pp::deprecated::BoundScriptableObject<Counter> {
+//    public:
+//     static void BindMethods(Methods* methods) {
+//       methods->Add("add", &Counter::Add);
+//       methods->Add("reset", &Counter::Reset);
+//     }
+//
+//    private:
+//     int32_t Add(int32_t amount) { return count_ += amount; }
+//     void Reset() { count_ = 0; }
+//
+//     int32_t count_;
+//   };
+//
+// BindMethods is called the first time a method of the class is looked up.
+// The parameters can be bool, int32_t, double, std::string or pp::Var, by
+// value or const reference, and the result anything pp::Var can be made
+// from, or void. A call with the wrong number or types of arguments raises
+// an exception instead of calling the method. Methods have to be members of
+// |T| itself, with up to four parameters.
+template <class T>
+class BoundScriptableObject : public ScriptableObject {
+ public:
+  class Methods {
+   public:
+    ~Methods() {
+      for (size_t i = 0; i < methods_.size(); i++)
+        delete methods_[i];
+    }
+
+    // Binds |name| to |method|, replacing the method it was bound to.
+    template <class M>
+    void Add(const char* name, M method) {
+      size_t index = names_.Add(name);
+      if (index == methods_.size()) {
+        methods_.push_back(new BoundMethod<M>(method));
+      } else {
+        delete methods_[index];
+        methods_[index] = new BoundMethod<M>(method);
+      }
+    }
+
+   private:
+    friend class BoundScriptableObject<T>;
+
+    class MethodBase {
+     public:
+      virtual ~MethodBase() {}
+      virtual Var Invoke(T* object,
+                         uint32_t argc,
+                         const PP_Var* argv,
+                         bool* converted) const = 0;
+    };
+
+    template <class M>
+    class BoundMethod : public MethodBase {
+     public:
+      explicit BoundMethod(M method) : method_(method) {}
+      virtual Var Invoke(T* object,
+                         uint32_t argc,
+                         const PP_Var* argv,
+                         bool* converted) const {
+        return internal::MethodInvoker<T, M>::Invoke(object, method_, argc,
+                                                     argv, converted);
+      }
+
+     private:
+      M method_;
+    };
+
+    Methods() {}
+
+    internal::BoundMethodNames names_;
+
+    // Owned; indexed like |names_|.
+    std::vector<MethodBase*> methods_;
+
+    // Disallow copy and assign (these are unimplemented).
+    Methods(const Methods&);
+    Methods& operator=(const Methods&);
+  };
+
+  BoundScriptableObject() {}
+  virtual ~BoundScriptableObject() {}
+
+  // ScriptableObject overrides.
+  virtual bool HasMethod(const Var& name, Var*) {
+    return GetMethods().names_.Find(name.pp_var()) >= 0;
+  }
+  virtual Var Call(const Var& method_name,
+                   const std::vector<Var>& args,
+                   Var* exception) {
+    std::vector<PP_Var> argv(args.size());
+    for (size_t i = 0; i < args.size(); i++)
+      argv[i] = args[i].pp_var();
+    return CallWithArgList(method_name, static_cast<uint32_t>(argv.size()),
+                           argv.empty() ? NULL : &argv[0], exception);
+  }
+  virtual Var CallWithArgList(const Var& method_name,
+                              uint32_t argc,
+                              const PP_Var* argv,
+                              Var* exception) {
+    const Methods& methods = GetMethods();
+    int32_t index = methods.names_.Find(method_name.pp_var());
+    if (index < 0)
+      return ScriptableObject::Call(method_name, std::vector<Var>(), exception);
+    bool converted;
+    Var result = methods.methods_[index]->Invoke(static_cast<T*>(this), argc,
+                                                 argv, &converted);
+    if (!converted) {
+      *exception = Var("Bad arguments to method " +
+                       methods.names_.name(index));
+    }
+    return result;
+  }
+
+ private:
+  static const Methods& GetMethods() {
+    // Kept for the life of the module, like the classes of the objects the
+    // browser holds.
+    static Methods* methods = NULL;
+    if (!methods) {
+      methods = new Methods;
+      T::BindMethods(methods);
+    }
+    return *methods;
+  }
+
+  // Disallow copy and assign (these are unimplemented).
+  BoundScriptableObject(const BoundScriptableObject&);
+  BoundScriptableObject& operator=(const BoundScriptableObject&);
+};
+
+}  // namespace deprecated
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_DEV_BOUND_SCRIPTABLE_OBJECT_DEPRECATED_H_
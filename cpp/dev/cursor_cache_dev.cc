@@ -0,0 +1,169 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/dev/cursor_cache_dev.h"
+
+#include <string.h>
+
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/cpp/module.h"
+
+namespace pp {
+
+namespace {
+
+// FNV-1a over the pixels of |image|, row by row so that the padding at the
+// end of the rows doesn't count.
+uint32_t HashImage(const ImageData& image) {
+  uint32_t hash = 2166136261u;
+  hash = (hash ^ static_cast<uint32_t>(image.size().width())) * 16777619u;
+  hash = (hash ^ static_cast<uint32_t>(image.size().height())) * 16777619u;
+  for (int32_t y = 0; y < image.size().height(); y++) {
+    const uint32_t* row = image.GetAddr32(Point(0, y));
+    for (int32_t x = 0; x < image.size().width(); x++)
+      hash = (hash ^ row[x]) * 16777619u;
+  }
+  return hash;
+}
+
+bool SamePixels(const ImageData& a, const ImageData& b) {
+  if (a.size() != b.size() || a.format() != b.format())
+    return false;
+  size_t row_size = a.size().width() * sizeof(uint32_t);
+  for (int32_t y = 0; y < a.size().height(); y++) {
+    if (memcmp(a.GetAddr32(Point(0, y)), b.GetAddr32(Point(0, y)),
+               row_size) != 0)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+CursorCache_Dev::CursorCache_Dev(Instance* instance)
+    : cursor_control_(instance),
+      max_images_(8),
+      type_(PP_CURSORTYPE_POINTER),
+      has_sent_(false),
+      sent_type_(PP_CURSORTYPE_POINTER),
+      sent_image_(0),
+      image_use_count_(0),
+      flush_pending_(false),
+      request_count_(0),
+      issued_count_(0),
+      callback_factory_(this) {
+}
+
+CursorCache_Dev::~CursorCache_Dev() {
+}
+
+void CursorCache_Dev::SetCursor(PP_CursorType_Dev type) {
+  PP_DCHECK(type != PP_CURSORTYPE_CUSTOM);
+  Request(type, ImageData(), Point());
+}
+
+void CursorCache_Dev::SetCustomCursor(const ImageData& image,
+                                      const Point& hot_spot) {
+  const CachedImage* cached = GetCachedImage(image);
+  if (!cached) {
+    request_count_++;
+    return;
+  }
+  Request(PP_CURSORTYPE_CUSTOM, cached->image, hot_spot);
+}
+
+void CursorCache_Dev::Flush() {
+  bool changed = !has_sent_ || type_ != sent_type_ ||
+      image_.pp_resource() != sent_image_ || hot_spot_ != sent_hot_spot_;
+  if (!changed)
+    return;
+  SendCursor(type_, image_, hot_spot_);
+  issued_count_++;
+  has_sent_ = true;
+  sent_type_ = type_;
+  sent_image_ = image_.pp_resource();
+  sent_hot_spot_ = hot_spot_;
+}
+
+void CursorCache_Dev::InvalidateSentCursor() {
+  has_sent_ = false;
+}
+
+void CursorCache_Dev::SendCursor(PP_CursorType_Dev type,
+                                 const ImageData& image,
+                                 const Point& hot_spot) {
+  cursor_control_.SetCursor(type, image, hot_spot);
+}
+
+const CursorCache_Dev::CachedImage* CursorCache_Dev::GetCachedImage(
+    const ImageData& image) {
+  if (image.is_null())
+    return NULL;
+  uint32_t hash = HashImage(image);
+  image_use_count_++;
+  for (size_t i = 0; i < images_.size(); i++) {
+    if (images_[i].hash == hash && SamePixels(images_[i].image, image)) {
+      images_[i].last_used = image_use_count_;
+      return &images_[i];
+    }
+  }
+
+  // A copy, so that later changes to |image| don't show through.
+  CachedImage cached;
+  cached.hash = hash;
+  cached.image = ImageData(image.format(), image.size(), false);
+  cached.last_used = image_use_count_;
+  if (cached.image.is_null())
+    return NULL;
+  size_t row_size = image.size().width() * sizeof(uint32_t);
+  for (int32_t y = 0; y < image.size().height(); y++) {
+    memcpy(cached.image.GetAddr32(Point(0, y)),
+           image.GetAddr32(Point(0, y)), row_size);
+  }
+
+  if (images_.size() < max_images_ || images_.empty()) {
+    images_.push_back(cached);
+    return &images_.back();
+  }
+  // Replaces the least recently used image, unless it's the cursor being
+  // shown or requested.
+  size_t oldest = images_.size();
+  for (size_t i = 0; i < images_.size(); i++) {
+    PP_Resource resource = images_[i].image.pp_resource();
+    if (resource == image_.pp_resource() ||
+        (has_sent_ && resource == sent_image_))
+      continue;
+    if (oldest == images_.size() ||
+        images_[i].last_used < images_[oldest].last_used)
+      oldest = i;
+  }
+  if (oldest == images_.size()) {
+    images_.push_back(cached);
+    return &images_.back();
+  }
+  images_[oldest] = cached;
+  return &images_[oldest];
+}
+
+void CursorCache_Dev::Request(PP_CursorType_Dev type,
+                              const ImageData& image,
+                              const Point& hot_spot) {
+  request_count_++;
+  type_ = type;
+  image_ = image;
+  hot_spot_ = hot_spot;
+  if (flush_pending_)
+    return;
+  flush_pending_ = true;
+  Module::Get()->core()->CallOnMainThread(
+      0, callback_factory_.NewCallback(&CursorCache_Dev::OnEndOfBatch));
+}
+
+void CursorCache_Dev::OnEndOfBatch(int32_t) {
+  flush_pending_ = false;
+  Flush();
+}
+
+}  // namespace pp
@@ -0,0 +1,129 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_DEV_CURSOR_CACHE_DEV_H_
+#define PPAPI_CPP_DEV_CURSOR_CACHE_DEV_H_
+
+#include <vector>
+
+#include "ppapi/c/dev/pp_cursor_type_dev.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/dev/cursor_control_dev.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/size.h"
+
+namespace pp {
+
+class Instance;
+
+// Keeps track of the cursor of an instance so that it can be set as often as
+// convenient, such as on every mouse move, without a call to the browser
+// each time.
+//
+// A change of cursor is sent at the end of the batch of input events being
+// handled (in a main thread callback, which runs after the events already
+// queued), and only if the cursor is then different from the one last sent:
+// hovering back and forth over an element within one batch costs nothing.
+// Custom cursor images are compared by content; each different image is
+// copied once into an ImageData of the cache, which is what is sent, so that
+// a plugin that draws its cursor anew each time still only sends it once.
+//
+//   virtual bool HandleInputEvent(const PP_InputEvent& event) {
+//     if (event.type == PP_INPUTEVENT_TYPE_MOUSEMOVE)
+//       cursor_cache_.SetCursor(IsOverLink(event) ? PP_CURSORTYPE_HAND
+//                                                 : PP_CURSORTYPE_POINTER);
+//     ...
+//   }
+class CursorCache_Dev {
+ public:
+  explicit CursorCache_Dev(Instance* instance);
+  virtual ~CursorCache_Dev();
+
+  // How many custom cursor images are kept. Defaults to 8.
+  void set_max_images(size_t max_images) { max_images_ = max_images; }
+
+  // Sets a standard cursor. |type| must not be PP_CURSORTYPE_CUSTOM.
+  void SetCursor(PP_CursorType_Dev type);
+
+  // Sets a custom cursor: the pixels of |image|, with its |hot_spot|.
+  // |image| isn't used after the call.
+  void SetCustomCursor(const ImageData& image, const Point& hot_spot);
+
+  // Sends the cursor now rather than at the end of the batch, if it
+  // changed.
+  void Flush();
+
+  // Forgets which cursor was sent, so that the next one is sent whatever it
+  // is. For when the browser may have changed the cursor, as when the mouse
+  // comes back into the instance.
+  void InvalidateSentCursor();
+
+  // Calls to SetCursor() and SetCustomCursor(), and how many of them
+  // resulted in a call to the browser or didn't.
+  int request_count() const { return request_count_; }
+  int issued_count() const { return issued_count_; }
+  int suppressed_count() const { return request_count_ - issued_count_; }
+
+  // Number of custom cursor images kept.
+  size_t image_count() const { return images_.size(); }
+
+ protected:
+  // Sends the cursor to the browser. |image| is null unless |type| is
+  // PP_CURSORTYPE_CUSTOM.
+  virtual void SendCursor(PP_CursorType_Dev type,
+                          const ImageData& image,
+                          const Point& hot_spot);
+
+ private:
+  // A custom cursor image, copied.
+  struct CachedImage {
+    uint32_t hash;
+    ImageData image;
+    uint32_t last_used;
+  };
+
+  // Returns the cached image with the pixels of |image|, copying it in if
+  // there is none. Returns NULL if it can't be copied.
+  const CachedImage* GetCachedImage(const ImageData& image);
+
+  // Requests |type| with |image|, to be sent at the end of the batch.
+  void Request(PP_CursorType_Dev type,
+               const ImageData& image,
+               const Point& hot_spot);
+
+  void OnEndOfBatch(int32_t);
+
+  CursorControl_Dev cursor_control_;
+  size_t max_images_;
+
+  // The cursor requested last. |image| is one of |images_| or null.
+  PP_CursorType_Dev type_;
+  ImageData image_;
+  Point hot_spot_;
+
+  // The cursor sent last, if |has_sent_|.
+  bool has_sent_;
+  PP_CursorType_Dev sent_type_;
+  PP_Resource sent_image_;
+  Point sent_hot_spot_;
+
+  std::vector<CachedImage> images_;
+  uint32_t image_use_count_;
+
+  bool flush_pending_;
+  int request_count_;
+  int issued_count_;
+
+  CompletionCallbackFactory<CursorCache_Dev> callback_factory_;
+
+  // Disallow copy and assign (these are unimplemented).
+  CursorCache_Dev(const CursorCache_Dev&);
+  CursorCache_Dev& operator=(const CursorCache_Dev&);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_DEV_CURSOR_CACHE_DEV_H_
@@ -0,0 +1,59 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/dev/cursor_control_dev.h"
+
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/instance.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/module_impl.h"
+#include "ppapi/cpp/point.h"
+
+namespace pp {
+
+namespace {
+
+DeviceFuncs<PPB_CursorControl_Dev> ppb_cursor_control_f(
+    PPB_CURSOR_CONTROL_DEV_INTERFACE);
+
+}  // anonymous namespace
+
+CursorControl_Dev::CursorControl_Dev(Instance* instance)
+    : associated_instance_(instance) {
+}
+
+CursorControl_Dev::~CursorControl_Dev() {
+}
+
+bool CursorControl_Dev::SetCursor(PP_CursorType_Dev type,
+                                  const ImageData& custom_image,
+                                  const Point& hot_spot) {
+  if (!ppb_cursor_control_f)
+    return false;
+  return ppb_cursor_control_f->SetCursor(associated_instance_->pp_instance(),
+                                         type, custom_image.pp_resource(),
+                                         &hot_spot.pp_point());
+}
+
+bool CursorControl_Dev::LockCursor() {
+  return ppb_cursor_control_f && ppb_cursor_control_f->LockCursor(
+      associated_instance_->pp_instance());
+}
+
+bool CursorControl_Dev::UnlockCursor() {
+  return ppb_cursor_control_f && ppb_cursor_control_f->UnlockCursor(
+      associated_instance_->pp_instance());
+}
+
+bool CursorControl_Dev::HasCursorLock() {
+  return ppb_cursor_control_f && ppb_cursor_control_f->HasCursorLock(
+      associated_instance_->pp_instance());
+}
+
+bool CursorControl_Dev::CanLockCursor() {
+  return ppb_cursor_control_f && ppb_cursor_control_f->CanLockCursor(
+      associated_instance_->pp_instance());
+}
+
+}  // namespace pp
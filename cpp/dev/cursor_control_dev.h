@@ -0,0 +1,37 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_DEV_CURSOR_CONTROL_DEV_H_
+#define PPAPI_CPP_DEV_CURSOR_CONTROL_DEV_H_
+
+#include "ppapi/c/dev/ppb_cursor_control_dev.h"
+
+namespace pp {
+
+class ImageData;
+class Instance;
+class Point;
+
+class CursorControl_Dev {
+ public:
+  CursorControl_Dev(Instance* instance);
+  virtual ~CursorControl_Dev();
+
+  // PPB_CursorControl_Dev methods. |custom_image| and |hot_spot| are only
+  // used for PP_CURSORTYPE_CUSTOM.
+  bool SetCursor(PP_CursorType_Dev type,
+                 const ImageData& custom_image,
+                 const Point& hot_spot);
+  bool LockCursor();
+  bool UnlockCursor();
+  bool HasCursorLock();
+  bool CanLockCursor();
+
+ private:
+  Instance* associated_instance_;
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_DEV_CURSOR_CONTROL_DEV_H_
@@ -0,0 +1,512 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/dev/find_engine_dev.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/cpp/module.h"
+
+namespace pp {
+
+namespace {
+
+const size_t kDefaultSliceSize = 256 * 1024;
+
+inline unsigned char FoldCase(unsigned char c) {
+  return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+// The other case of an ASCII letter, or |c|.
+inline unsigned char OtherCase(unsigned char c) {
+  if (c >= 'A' && c <= 'Z')
+    return c + ('a' - 'A');
+  if (c >= 'a' && c <= 'z')
+    return c - ('a' - 'A');
+  return c;
+}
+
+bool MatchesAt(const unsigned char* text,
+               const std::string& query,
+               bool case_sensitive) {
+  if (case_sensitive)
+    return memcmp(text, query.data(), query.size()) == 0;
+  for (size_t i = 0; i < query.size(); i++) {
+    if (FoldCase(text[i]) != FoldCase(query[i]))
+      return false;
+  }
+  return true;
+}
+
+// Boyer-Moore-Horspool over the match starts |begin| to |end|.
+void FindMatchesHorspool(const unsigned char* text,
+                         size_t begin,
+                         size_t end,
+                         const std::string& query,
+                         bool case_sensitive,
+                         std::vector<size_t>* matches) {
+  size_t length = query.size();
+  size_t skip[256];
+  for (int i = 0; i < 256; i++)
+    skip[i] = length;
+  for (size_t i = 0; i + 1 < length; i++) {
+    unsigned char c = query[i];
+    skip[c] = length - 1 - i;
+    if (!case_sensitive)
+      skip[OtherCase(c)] = skip[c];
+  }
+
+  size_t pos = begin;
+  while (pos < end) {
+    if (MatchesAt(text + pos, query, case_sensitive))
+      matches->push_back(pos);
+    pos += skip[text[pos + length - 1]];
+  }
+}
+
+#if defined(__SSE2__)
+
+// Compares 16 positions at a time against the first and last byte of the
+// query, in either case if case insensitive, and only checks the whole query
+// where both match. The second byte compare rejects most candidates that
+// a first byte scan, like memchr, would stop at.
+size_t FindMatchesSSE2(const unsigned char* text,
+                       size_t begin,
+                       size_t end,
+                       const std::string& query,
+                       bool case_sensitive,
+                       std::vector<size_t>* matches) {
+  size_t last = query.size() - 1;
+  unsigned char first_char = query[0];
+  unsigned char last_char = query[last];
+  __m128i first = _mm_set1_epi8(first_char);
+  __m128i last_vector = _mm_set1_epi8(last_char);
+  __m128i first_other =
+      _mm_set1_epi8(case_sensitive ? first_char : OtherCase(first_char));
+  __m128i last_other =
+      _mm_set1_epi8(case_sensitive ? last_char : OtherCase(last_char));
+
+  size_t pos = begin;
+  for (; pos + 16 <= end; pos += 16) {
+    __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos));
+    __m128i block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos + last));
+    __m128i found = _mm_and_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block_first, first),
+                     _mm_cmpeq_epi8(block_first, first_other)),
+        _mm_or_si128(_mm_cmpeq_epi8(block_last, last_vector),
+                     _mm_cmpeq_epi8(block_last, last_other)));
+    int mask = _mm_movemask_epi8(found);
+    for (size_t i = 0; mask; i++, mask >>= 1) {
+      if ((mask & 1) && MatchesAt(text + pos + i, query, case_sensitive))
+        matches->push_back(pos + i);
+    }
+  }
+  return pos;
+}
+
+#endif  // defined(__SSE2__)
+
+// Appends the starts of all the matches of |query| in |text| that start from
+// |begin| to |end|, overlapping ones included. The matches may run past
+// |end|.
+void FindMatches(const std::string& text,
+                 size_t begin,
+                 size_t end,
+                 const std::string& query,
+                 bool case_sensitive,
+                 std::vector<size_t>* matches) {
+  if (query.empty() || query.size() > text.size())
+    return;
+  end = std::min(end, text.size() - query.size() + 1);
+  if (begin >= end)
+    return;
+  const unsigned char* data =
+      reinterpret_cast<const unsigned char*>(text.data());
+
+  if (query.size() == 1 && case_sensitive) {
+    const unsigned char* pos = data + begin;
+    while ((pos = static_cast<const unsigned char*>(
+                memchr(pos, query[0], data + end - pos)))) {
+      matches->push_back(pos - data);
+      pos++;
+    }
+    return;
+  }
+
+#if defined(__SSE2__)
+  begin = FindMatchesSSE2(data, begin, end, query, case_sensitive, matches);
+#endif
+  FindMatchesHorspool(data, begin, end, query, case_sensitive, matches);
+}
+
+}  // namespace
+
+// Worker threads --------------------------------------------------------------
+
+#if defined(_WIN32)
+
+// No threads; the slices are searched on the main thread.
+class FindEngine_Dev::Workers {
+ public:
+  Workers(FindEngine_Dev*, int) {}
+
+  bool started() const { return false; }
+
+  void Start(uint32_t, size_t, size_t) {
+    PP_NOTREACHED();
+  }
+
+  void Cancel(uint32_t) {}
+};
+
+#else
+
+// Searches slices on a fixed set of threads. Searched slices are collected
+// and handed back to the engine in one main thread callback.
+class FindEngine_Dev::Workers {
+ public:
+  Workers(FindEngine_Dev* engine, int count);
+  ~Workers();
+
+  bool started() const { return !threads_.empty(); }
+
+  // Searches |slice_count| slices of |slice_size| of the engine's text for
+  // its query, for |generation|. The text and query must not change until
+  // Cancel.
+  void Start(uint32_t generation, size_t slice_size, size_t slice_count);
+
+  // Drops the slices not being searched yet, and waits for the others. Their
+  // matches are handed back tagged with their generation, and ignored by
+  // the engine, which moved on to |generation|.
+  void Cancel(uint32_t generation);
+
+ private:
+  // The state shared with the threads and with the main thread callback,
+  // which can still be pending after the engine is gone.
+  struct Shared {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_cond_t idle_cond;
+
+    // The engine's text and query. Only read while slices are queued or
+    // being searched.
+    const std::string* text;
+    std::string query;
+    bool case_sensitive;
+    size_t slice_size;
+    uint32_t generation;
+
+    std::deque<size_t> queue;
+    int searching;
+    std::vector<SliceMatches> done;
+
+    // NULL once the engine is gone.
+    FindEngine_Dev* engine;
+
+    // One for the Workers, one for a pending callback.
+    int ref_count;
+    bool callback_pending;
+    bool quit;
+  };
+
+  static void* ThreadMain(void* data);
+  static void OnSlicesDone(void* user_data, int32_t result);
+
+  // Drops a reference to |shared|, which must be locked, and unlocks it.
+  static void ReleaseAndUnlock(Shared* shared);
+
+  Shared* shared_;
+  std::vector<pthread_t> threads_;
+};
+
+FindEngine_Dev::Workers::Workers(FindEngine_Dev* engine, int count)
+    : shared_(new Shared) {
+  pthread_mutex_init(&shared_->lock, NULL);
+  pthread_cond_init(&shared_->cond, NULL);
+  pthread_cond_init(&shared_->idle_cond, NULL);
+  shared_->text = &engine->text_;
+  shared_->case_sensitive = false;
+  shared_->slice_size = 0;
+  shared_->generation = 0;
+  shared_->searching = 0;
+  shared_->engine = engine;
+  shared_->ref_count = 1;
+  shared_->callback_pending = false;
+  shared_->quit = false;
+  for (int i = 0; i < count; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &ThreadMain, shared_) != 0)
+      break;
+    threads_.push_back(thread);
+  }
+}
+
+FindEngine_Dev::Workers::~Workers() {
+  pthread_mutex_lock(&shared_->lock);
+  shared_->quit = true;
+  shared_->queue.clear();
+  pthread_cond_broadcast(&shared_->cond);
+  pthread_mutex_unlock(&shared_->lock);
+  for (size_t i = 0; i < threads_.size(); i++)
+    pthread_join(threads_[i], NULL);
+
+  pthread_mutex_lock(&shared_->lock);
+  shared_->engine = NULL;
+  shared_->done.clear();
+  ReleaseAndUnlock(shared_);
+}
+
+void FindEngine_Dev::Workers::Start(uint32_t generation,
+                                    size_t slice_size,
+                                    size_t slice_count) {
+  pthread_mutex_lock(&shared_->lock);
+  PP_DCHECK(shared_->queue.empty() && shared_->searching == 0);
+  shared_->query = shared_->engine->query_;
+  shared_->case_sensitive = shared_->engine->case_sensitive_;
+  shared_->slice_size = slice_size;
+  shared_->generation = generation;
+  for (size_t i = 0; i < slice_count; i++)
+    shared_->queue.push_back(i);
+  pthread_cond_broadcast(&shared_->cond);
+  pthread_mutex_unlock(&shared_->lock);
+}
+
+void FindEngine_Dev::Workers::Cancel(uint32_t generation) {
+  pthread_mutex_lock(&shared_->lock);
+  shared_->queue.clear();
+  shared_->generation = generation;
+  while (shared_->searching > 0)
+    pthread_cond_wait(&shared_->idle_cond, &shared_->lock);
+  pthread_mutex_unlock(&shared_->lock);
+}
+
+// static
+void* FindEngine_Dev::Workers::ThreadMain(void* data) {
+  Shared* shared = static_cast<Shared*>(data);
+  pthread_mutex_lock(&shared->lock);
+  for (;;) {
+    while (!shared->quit && shared->queue.empty())
+      pthread_cond_wait(&shared->cond, &shared->lock);
+    if (shared->quit)
+      break;
+    SliceMatches slice;
+    slice.slice = shared->queue.front();
+    slice.generation = shared->generation;
+    shared->queue.pop_front();
+    shared->searching++;
+    size_t begin = slice.slice * shared->slice_size;
+    pthread_mutex_unlock(&shared->lock);
+
+    // Nothing else changes the text or the query until this is done.
+    FindMatches(*shared->text, begin, begin + shared->slice_size,
+                shared->query, shared->case_sensitive, &slice.matches);
+
+    pthread_mutex_lock(&shared->lock);
+    if (--shared->searching == 0)
+      pthread_cond_signal(&shared->idle_cond);
+    if (slice.generation != shared->generation)
+      continue;
+    shared->done.push_back(slice);
+    if (!shared->callback_pending && !shared->quit) {
+      shared->callback_pending = true;
+      shared->ref_count++;
+      Module::Get()->core()->CallOnMainThread(
+          0, CompletionCallback(&OnSlicesDone, shared));
+    }
+  }
+  pthread_mutex_unlock(&shared->lock);
+  return NULL;
+}
+
+// static
+void FindEngine_Dev::Workers::OnSlicesDone(void* user_data, int32_t) {
+  Shared* shared = static_cast<Shared*>(user_data);
+  pthread_mutex_lock(&shared->lock);
+  shared->callback_pending = false;
+  std::vector<SliceMatches> done;
+  done.swap(shared->done);
+  // The engine can only go away on this thread, so it stays valid after
+  // unlocking.
+  FindEngine_Dev* engine = shared->engine;
+  ReleaseAndUnlock(shared);
+
+  if (engine)
+    engine->DidSearchSlices(done);
+}
+
+// static
+void FindEngine_Dev::Workers::ReleaseAndUnlock(Shared* shared) {
+  bool last = --shared->ref_count == 0;
+  pthread_mutex_unlock(&shared->lock);
+  if (last) {
+    pthread_cond_destroy(&shared->idle_cond);
+    pthread_cond_destroy(&shared->cond);
+    pthread_mutex_destroy(&shared->lock);
+    delete shared;
+  }
+}
+
+#endif  // defined(_WIN32)
+
+// FindEngine_Dev --------------------------------------------------------------
+
+FindEngine_Dev::FindEngine_Dev(Instance* instance, int worker_count)
+    : Find_Dev(instance),
+      slice_size_(kDefaultSliceSize),
+      case_sensitive_(false),
+      generation_(0),
+      finding_(false),
+      next_slice_(0),
+      next_search_slice_(0),
+      selected_index_(-1),
+      workers_(NULL),
+      callback_factory_(this) {
+  if (worker_count > 0) {
+    workers_ = new Workers(this, worker_count);
+    if (!workers_->started()) {
+      delete workers_;
+      workers_ = NULL;
+    }
+  }
+}
+
+FindEngine_Dev::~FindEngine_Dev() {
+  // Stop the threads before the text they search goes away.
+  delete workers_;
+}
+
+void FindEngine_Dev::SetText(const std::string& text) {
+  Cancel();
+  text_ = text;
+}
+
+bool FindEngine_Dev::StartFind(const std::string& text, bool case_sensitive) {
+  Cancel();
+  query_ = text;
+  case_sensitive_ = case_sensitive;
+  size_t slice_count = query_.empty() ? 0 : GetSliceCount();
+  if (slice_count == 0) {
+    NumberOfFindResultsChanged(0, true);
+    return true;
+  }
+
+  finding_ = true;
+  if (workers_) {
+    workers_->Start(generation_, slice_size_, slice_count);
+  } else {
+    Module::Get()->core()->CallOnMainThread(
+        0, callback_factory_.NewCallback(&FindEngine_Dev::SearchNextSlice), 0);
+  }
+  return true;
+}
+
+void FindEngine_Dev::SelectFindResult(bool forward) {
+  if (results_.empty())
+    return;
+  int32_t count = static_cast<int32_t>(results_.size());
+  int32_t index;
+  if (selected_index_ < 0)
+    index = forward ? 0 : count - 1;
+  else
+    index = (selected_index_ + (forward ? 1 : count - 1)) % count;
+  SelectResult(index);
+}
+
+void FindEngine_Dev::StopFind() {
+  Cancel();
+  query_.clear();
+}
+
+void FindEngine_Dev::FindResultSelected(size_t, size_t) {
+}
+
+void FindEngine_Dev::Cancel() {
+  generation_++;
+  if (workers_)
+    workers_->Cancel(generation_);
+  callback_factory_.CancelAll();
+  finding_ = false;
+  searched_slices_.clear();
+  next_slice_ = 0;
+  next_search_slice_ = 0;
+  results_.clear();
+  selected_index_ = -1;
+}
+
+size_t FindEngine_Dev::GetSliceCount() const {
+  if (slice_size_ == 0)
+    return 0;
+  return (text_.size() + slice_size_ - 1) / slice_size_;
+}
+
+void FindEngine_Dev::SearchNextSlice(int32_t) {
+  std::vector<SliceMatches> searched(1);
+  searched[0].generation = generation_;
+  searched[0].slice = next_search_slice_++;
+  size_t begin = searched[0].slice * slice_size_;
+  FindMatches(text_, begin, begin + slice_size_, query_, case_sensitive_,
+              &searched[0].matches);
+
+  // One slice per callback, so that input and painting get in between.
+  if (next_search_slice_ < GetSliceCount()) {
+    Module::Get()->core()->CallOnMainThread(
+        0, callback_factory_.NewCallback(&FindEngine_Dev::SearchNextSlice), 0);
+  }
+  DidSearchSlices(searched);
+}
+
+void FindEngine_Dev::DidSearchSlices(
+    const std::vector<SliceMatches>& searched) {
+  size_t old_count = results_.size();
+  for (size_t i = 0; i < searched.size(); i++) {
+    if (searched[i].generation == generation_)
+      searched_slices_[searched[i].slice] = searched[i].matches;
+  }
+
+  // Slices are added in order, skipping the matches that overlap the one
+  // before, so the results don't depend on where the slices end.
+  std::map<size_t, std::vector<size_t> >::iterator next;
+  while ((next = searched_slices_.find(next_slice_)) !=
+         searched_slices_.end()) {
+    const std::vector<size_t>& matches = next->second;
+    for (size_t i = 0; i < matches.size(); i++) {
+      if (results_.empty() || matches[i] >= results_.back() + query_.size())
+        results_.push_back(matches[i]);
+    }
+    searched_slices_.erase(next);
+    next_slice_++;
+  }
+
+  bool done = next_slice_ >= GetSliceCount();
+  if (done)
+    finding_ = false;
+  if (results_.size() != old_count || done) {
+    NumberOfFindResultsChanged(static_cast<int32_t>(results_.size()), done);
+    if (selected_index_ < 0 && !results_.empty())
+      SelectResult(0);
+  }
+}
+
+void FindEngine_Dev::SelectResult(int32_t index) {
+  selected_index_ = index;
+  SelectedFindResultChanged(index);
+  FindResultSelected(results_[index], query_.size());
+}
+
+}  // namespace pp
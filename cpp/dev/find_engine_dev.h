@@ -0,0 +1,147 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_DEV_FIND_ENGINE_DEV_H_
+#define PPAPI_CPP_DEV_FIND_ENGINE_DEV_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/dev/find_dev.h"
+
+namespace pp {
+
+class Instance;
+
+// Implements find in page over the text of a document, without blocking the
+// main thread however long the document is.
+//
+// The text is split into slices that are searched one at a time, either on
+// worker threads or, without them, in separate main thread callbacks. The
+// browser is told the number of results found so far as slices complete, and
+// the final number at the end. The first result is selected as soon as it's
+// found. A new query, StopFind or a change of the text cancel the search in
+// progress; at most the slices being searched at that moment run to the end.
+//
+// Matches don't overlap, and are found first to last, like the browser does
+// in web pages. Case insensitive finds only fold ASCII letters. Offsets and
+// lengths are in bytes of the UTF-8 text.
+//
+// Plugins give the engine their text and override FindResultSelected to show
+// the selected result:
+//
+//   class MyInstance : public pp::Instance, public pp::FindEngine_Dev {
+//    public:
+//     MyInstance(PP_Instance instance)
+//         : pp::Instance(instance),
+//           pp::FindEngine_Dev(this, 2) {
+//     }
+//
+//     void DidLoadDocument() {
+//       SetText(document_->GetText());
+//     }
+//
+//    protected:
+//     virtual void FindResultSelected(size_t offset, size_t length) {
+//       ScrollToAndHighlight(offset, length);
+//     }
+//   };
+class FindEngine_Dev : public Find_Dev {
+ public:
+  // Searches on |worker_count| threads, or in main thread callbacks if 0.
+  // Worker threads aren't available on all platforms; the main thread is
+  // then used.
+  FindEngine_Dev(Instance* instance, int worker_count);
+  virtual ~FindEngine_Dev();
+
+  // How many bytes of text are searched at a time. Defaults to 256 KB.
+  // Applies from the next find.
+  void set_slice_size(size_t slice_size) { slice_size_ = slice_size; }
+
+  // Sets the text to search. Cancels the find in progress and drops the
+  // results.
+  void SetText(const std::string& text);
+  const std::string& text() const { return text_; }
+
+  // Whether a find is in progress.
+  bool is_finding() const { return finding_; }
+
+  // The offsets of the results found so far, in order, and their length.
+  const std::vector<size_t>& results() const { return results_; }
+  size_t result_length() const { return query_.size(); }
+
+  // The index in results() of the selected result, or -1.
+  int32_t selected_index() const { return selected_index_; }
+
+  // Find_Dev implementation.
+  virtual bool StartFind(const std::string& text, bool case_sensitive);
+  virtual void SelectFindResult(bool forward);
+  virtual void StopFind();
+
+ protected:
+  // Called when a result is selected, to show it. Does nothing by default.
+  virtual void FindResultSelected(size_t offset, size_t length);
+
+ private:
+  class Workers;
+  friend class Workers;
+
+  // The matches starting in one slice, overlapping ones included.
+  struct SliceMatches {
+    uint32_t generation;
+    size_t slice;
+    std::vector<size_t> matches;
+  };
+
+  // Stops searching and drops the results.
+  void Cancel();
+
+  size_t GetSliceCount() const;
+
+  // Searches the next slice on the main thread.
+  void SearchNextSlice(int32_t);
+
+  // Adds the matches of searched slices to the results, in order, and tells
+  // the browser.
+  void DidSearchSlices(const std::vector<SliceMatches>& searched);
+
+  void SelectResult(int32_t index);
+
+  size_t slice_size_;
+  std::string text_;
+
+  // The current query.
+  std::string query_;
+  bool case_sensitive_;
+
+  // Tells the results of a find from those of cancelled ones.
+  uint32_t generation_;
+  bool finding_;
+
+  // Slices searched but not yet added to the results, because a slice
+  // before them isn't done.
+  std::map<size_t, std::vector<size_t> > searched_slices_;
+
+  // The slice whose matches are added next, and, without workers, the next
+  // to be searched.
+  size_t next_slice_;
+  size_t next_search_slice_;
+
+  std::vector<size_t> results_;
+  int32_t selected_index_;
+
+  Workers* workers_;
+  CompletionCallbackFactory<FindEngine_Dev> callback_factory_;
+
+  // Disallow copy and assign (these are unimplemented).
+  FindEngine_Dev(const FindEngine_Dev&);
+  FindEngine_Dev& operator=(const FindEngine_Dev&);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_DEV_FIND_ENGINE_DEV_H_
@@ -0,0 +1,149 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/dev/instance_recorder_dev.h"
+
+#include <map>
+
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/dev/instance_recording_dev.h"
+#include "ppapi/cpp/dev/url_loader_dev.h"
+#include "ppapi/cpp/dev/url_response_info_dev.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/var.h"
+
+namespace pp {
+
+namespace {
+
+InstanceRecordWriter_Dev* g_writer = NULL;
+Module* g_module = NULL;
+PP_TimeTicks g_start_time = 0;
+
+// Maps the live instances to their numbers in the log.
+typedef std::map<PP_Instance, uint32_t> InstanceNumberMap;
+InstanceNumberMap* g_instance_numbers = NULL;
+uint32_t g_next_instance_number = 0;
+
+PP_TimeTicks Now() {
+  return g_module->core()->GetTimeTicks();
+}
+
+// Fills in the instance number and time of |record|. Instances that were
+// created before recording started are numbered when first seen.
+void InitRecord(PP_Instance instance,
+                InstanceRecord_Dev::Type type,
+                InstanceRecord_Dev* record) {
+  record->type = type;
+  InstanceNumberMap::iterator found = g_instance_numbers->find(instance);
+  if (found == g_instance_numbers->end()) {
+    found = g_instance_numbers->insert(
+        std::make_pair(instance, g_next_instance_number++)).first;
+  }
+  record->instance = found->second;
+  record->time = Now() - g_start_time;
+}
+
+}  // namespace
+
+bool InstanceRecorder_Dev::recording_ = false;
+
+// static
+bool InstanceRecorder_Dev::Start(Module* module, const char* path) {
+#if !defined(PPAPI_ENABLE_INSTANCE_RECORDING)
+  return false;
+#endif
+  Stop();
+  g_module = module;
+  g_writer = new InstanceRecordWriter_Dev;
+  g_start_time = Now();
+  if (!g_writer->Open(path, g_start_time)) {
+    delete g_writer;
+    g_writer = NULL;
+    return false;
+  }
+  g_instance_numbers = new InstanceNumberMap;
+  g_next_instance_number = 0;
+  recording_ = true;
+  return true;
+}
+
+// static
+void InstanceRecorder_Dev::Stop() {
+  recording_ = false;
+  delete g_writer;
+  g_writer = NULL;
+  delete g_instance_numbers;
+  g_instance_numbers = NULL;
+}
+
+// static
+void InstanceRecorder_Dev::RecordDidCreate(PP_Instance instance,
+                                           uint32_t argc,
+                                           const char* argn[],
+                                           const char* argv[]) {
+  InstanceRecord_Dev record;
+  InitRecord(instance, InstanceRecord_Dev::TYPE_DID_CREATE, &record);
+  for (uint32_t i = 0; i < argc; i++) {
+    record.arg_names.push_back(argn[i]);
+    record.arg_values.push_back(argv[i]);
+  }
+  g_writer->Write(record);
+}
+
+// static
+void InstanceRecorder_Dev::RecordDidDestroy(PP_Instance instance) {
+  InstanceRecord_Dev record;
+  InitRecord(instance, InstanceRecord_Dev::TYPE_DID_DESTROY, &record);
+  g_writer->Write(record);
+  // The browser may reuse the id for a new instance.
+  g_instance_numbers->erase(instance);
+}
+
+// static
+void InstanceRecorder_Dev::RecordDidChangeView(PP_Instance instance,
+                                               const PP_Rect& position,
+                                               const PP_Rect& clip) {
+  InstanceRecord_Dev record;
+  InitRecord(instance, InstanceRecord_Dev::TYPE_DID_CHANGE_VIEW, &record);
+  record.position = position;
+  record.clip = clip;
+  g_writer->Write(record);
+}
+
+// static
+void InstanceRecorder_Dev::RecordDidChangeFocus(PP_Instance instance,
+                                                bool has_focus) {
+  InstanceRecord_Dev record;
+  InitRecord(instance, InstanceRecord_Dev::TYPE_DID_CHANGE_FOCUS, &record);
+  record.has_focus = has_focus;
+  g_writer->Write(record);
+}
+
+// static
+void InstanceRecorder_Dev::RecordHandleInputEvent(PP_Instance instance,
+                                                  const PP_InputEvent& event) {
+  InstanceRecord_Dev record;
+  InitRecord(instance, InstanceRecord_Dev::TYPE_HANDLE_INPUT_EVENT, &record);
+  record.event = event;
+  g_writer->Write(record);
+}
+
+// static
+void InstanceRecorder_Dev::RecordHandleDocumentLoad(
+    PP_Instance instance,
+    const URLLoader_Dev& url_loader) {
+  InstanceRecord_Dev record;
+  InitRecord(instance, InstanceRecord_Dev::TYPE_HANDLE_DOCUMENT_LOAD,
+             &record);
+  URLResponseInfo_Dev response = url_loader.GetResponseInfo();
+  if (!response.is_null()) {
+    Var url = response.GetURL();
+    if (url.is_string())
+      record.url = url.AsString();
+  }
+  g_writer->Write(record);
+}
+
+}  // namespace pp
@@ -0,0 +1,73 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_DEV_INSTANCE_RECORDER_DEV_H_
+#define PPAPI_CPP_DEV_INSTANCE_RECORDER_DEV_H_
+
+#include "ppapi/c/pp_instance.h"
+#include "ppapi/c/pp_stdint.h"
+
+struct PP_InputEvent;
+struct PP_Rect;
+
+namespace pp {
+
+class Module;
+class URLLoader_Dev;
+
+// Records the PPP_Instance calls the module receives from the browser, with
+// their timing, so that a session can be replayed deterministically later,
+// for instance to profile or A/B two builds on exactly the same input. The
+// log format is described in instance_recording_dev.h; the headless test
+// host replays logs with "ppapi_headless_runner --replay=<log>".
+//
+// Recording is only compiled in when PPAPI_ENABLE_INSTANCE_RECORDING is
+// defined (ppapi_instance_recording=1 in gyp); otherwise IsRecording() is
+// always false, so the hooks in module.cc compile away, and Start() fails.
+// In such a build recording starts when the module is initialized if the
+// PPAPI_INSTANCE_RECORDING environment variable names a file, or
+// explicitly with Start(). DidCreate, DidDestroy, DidChangeView,
+// DidChangeFocus, HandleInputEvent and HandleDocumentLoad are recorded; the
+// document loaded by HandleDocumentLoad is represented by its URL only.
+//
+// Calls are recorded on the way in, before the instance handles them, so
+// that calls made from nested message loops are logged in the order they
+// were made.
+class InstanceRecorder_Dev {
+ public:
+  // Starts recording the calls to |module| to |path|, replacing any
+  // recording in progress. Returns false if the file can't be created.
+  static bool Start(Module* module, const char* path);
+
+  // Stops recording and closes the log.
+  static void Stop();
+
+#if defined(PPAPI_ENABLE_INSTANCE_RECORDING)
+  static bool IsRecording() { return recording_; }
+#else
+  static bool IsRecording() { return false; }
+#endif
+
+  // Called by the PPP_Instance implementation in module.cc when recording.
+  static void RecordDidCreate(PP_Instance instance,
+                              uint32_t argc,
+                              const char* argn[],
+                              const char* argv[]);
+  static void RecordDidDestroy(PP_Instance instance);
+  static void RecordDidChangeView(PP_Instance instance,
+                                  const PP_Rect& position,
+                                  const PP_Rect& clip);
+  static void RecordDidChangeFocus(PP_Instance instance, bool has_focus);
+  static void RecordHandleInputEvent(PP_Instance instance,
+                                     const PP_InputEvent& event);
+  static void RecordHandleDocumentLoad(PP_Instance instance,
+                                       const URLLoader_Dev& url_loader);
+
+ private:
+  static bool recording_;
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_DEV_INSTANCE_RECORDER_DEV_H_
@@ -0,0 +1,271 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/dev/instance_recording_dev.h"
+
+#include <string.h>
+
+namespace {
+
+const char kMagic[8] = { 'P', 'P', 'I', 'R', 'E', 'C', '1', '\n' };
+
+// Largest payload a reader accepts; bounds the allocation for corrupt logs.
+const uint32_t kMaxPayloadSize = 16 * 1024 * 1024;
+
+template <class T>
+void Append(std::string* buffer, const T& value) {
+  buffer->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(std::string* buffer, const std::string& str) {
+  Append(buffer, static_cast<uint32_t>(str.size()));
+  buffer->append(str);
+}
+
+void AppendRect(std::string* buffer, const PP_Rect& rect) {
+  Append(buffer, rect.point.x);
+  Append(buffer, rect.point.y);
+  Append(buffer, rect.size.width);
+  Append(buffer, rect.size.height);
+}
+
+// Reads fixed-size values and strings out of a payload, checking bounds.
+class PayloadReader {
+ public:
+  explicit PayloadReader(const std::string& payload)
+      : payload_(payload), offset_(0) {}
+
+  template <class T>
+  bool Read(T* value) {
+    if (payload_.size() - offset_ < sizeof(T))
+      return false;
+    memcpy(value, payload_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool ReadString(std::string* str) {
+    uint32_t size;
+    if (!Read(&size) || payload_.size() - offset_ < size)
+      return false;
+    str->assign(payload_, offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool ReadRect(PP_Rect* rect) {
+    return Read(&rect->point.x) && Read(&rect->point.y) &&
+           Read(&rect->size.width) && Read(&rect->size.height);
+  }
+
+  bool AtEnd() const { return offset_ == payload_.size(); }
+
+ private:
+  const std::string& payload_;
+  size_t offset_;
+};
+
+}  // namespace
+
+namespace pp {
+
+InstanceRecord_Dev::InstanceRecord_Dev()
+    : type(TYPE_DID_DESTROY),
+      instance(0),
+      time(0),
+      has_focus(false) {
+  memset(&position, 0, sizeof(position));
+  memset(&clip, 0, sizeof(clip));
+  memset(&event, 0, sizeof(event));
+}
+
+// InstanceRecordWriter_Dev ----------------------------------------------------
+
+InstanceRecordWriter_Dev::InstanceRecordWriter_Dev()
+    : file_(NULL),
+      last_time_(0) {
+}
+
+InstanceRecordWriter_Dev::~InstanceRecordWriter_Dev() {
+  Close();
+}
+
+bool InstanceRecordWriter_Dev::Open(const char* path,
+                                    PP_TimeTicks start_time) {
+  Close();
+  file_ = fopen(path, "wb");
+  if (!file_)
+    return false;
+  std::string header(kMagic, sizeof(kMagic));
+  Append(&header, static_cast<uint32_t>(sizeof(PP_InputEvent)));
+  Append(&header, start_time);
+  last_time_ = 0;
+  return fwrite(header.data(), 1, header.size(), file_) == header.size();
+}
+
+bool InstanceRecordWriter_Dev::Write(const InstanceRecord_Dev& record) {
+  if (!file_ || record.instance > 0xff)
+    return false;
+
+  std::string payload;
+  switch (record.type) {
+    case InstanceRecord_Dev::TYPE_DID_CREATE:
+      Append(&payload, static_cast<uint32_t>(record.arg_names.size()));
+      for (size_t i = 0; i < record.arg_names.size(); i++) {
+        AppendString(&payload, record.arg_names[i]);
+        AppendString(&payload, record.arg_values[i]);
+      }
+      break;
+    case InstanceRecord_Dev::TYPE_DID_DESTROY:
+      break;
+    case InstanceRecord_Dev::TYPE_DID_CHANGE_VIEW:
+      AppendRect(&payload, record.position);
+      AppendRect(&payload, record.clip);
+      break;
+    case InstanceRecord_Dev::TYPE_DID_CHANGE_FOCUS:
+      Append(&payload, static_cast<uint8_t>(record.has_focus ? 1 : 0));
+      break;
+    case InstanceRecord_Dev::TYPE_HANDLE_INPUT_EVENT:
+      Append(&payload, record.event);
+      break;
+    case InstanceRecord_Dev::TYPE_HANDLE_DOCUMENT_LOAD:
+      AppendString(&payload, record.url);
+      break;
+  }
+
+  // Deltas are stored so that they fit in 32 bits; a pause of over an hour
+  // between two calls is shortened to that.
+  double delta_us = (record.time - last_time_) * 1e6;
+  if (delta_us < 0)
+    delta_us = 0;
+  if (delta_us > 0xffffffffu)
+    delta_us = 0xffffffffu;
+  last_time_ = record.time;
+
+  std::string buffer;
+  Append(&buffer, static_cast<uint8_t>(record.type));
+  Append(&buffer, static_cast<uint8_t>(record.instance));
+  Append(&buffer, static_cast<uint32_t>(delta_us + 0.5));
+  Append(&buffer, static_cast<uint32_t>(payload.size()));
+  buffer.append(payload);
+  return fwrite(buffer.data(), 1, buffer.size(), file_) == buffer.size();
+}
+
+void InstanceRecordWriter_Dev::Close() {
+  if (file_) {
+    fclose(file_);
+    file_ = NULL;
+  }
+}
+
+// InstanceRecordReader_Dev ----------------------------------------------------
+
+InstanceRecordReader_Dev::InstanceRecordReader_Dev()
+    : file_(NULL),
+      start_time_(0),
+      time_(0) {
+}
+
+InstanceRecordReader_Dev::~InstanceRecordReader_Dev() {
+  if (file_)
+    fclose(file_);
+}
+
+bool InstanceRecordReader_Dev::Open(const char* path, std::string* error) {
+  file_ = fopen(path, "rb");
+  if (!file_) {
+    *error = std::string("Can't open ") + path;
+    return false;
+  }
+  char magic[sizeof(kMagic)];
+  uint32_t event_size;
+  if (fread(magic, sizeof(magic), 1, file_) != 1 ||
+      memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      fread(&event_size, sizeof(event_size), 1, file_) != 1 ||
+      fread(&start_time_, sizeof(start_time_), 1, file_) != 1) {
+    *error = std::string(path) + " is not an instance recording";
+    return false;
+  }
+  if (event_size != sizeof(PP_InputEvent)) {
+    *error = std::string(path) +
+        " was recorded on a different architecture";
+    return false;
+  }
+  time_ = 0;
+  return true;
+}
+
+bool InstanceRecordReader_Dev::Read(InstanceRecord_Dev* record) {
+  if (!file_ || !error_.empty())
+    return false;
+
+  uint8_t type;
+  if (fread(&type, sizeof(type), 1, file_) != 1)
+    return false;  // End of the log.
+
+  uint8_t instance;
+  uint32_t delta_us;
+  uint32_t payload_size;
+  std::string payload;
+  if (fread(&instance, sizeof(instance), 1, file_) != 1 ||
+      fread(&delta_us, sizeof(delta_us), 1, file_) != 1 ||
+      fread(&payload_size, sizeof(payload_size), 1, file_) != 1 ||
+      payload_size > kMaxPayloadSize) {
+    error_ = "Truncated record";
+    return false;
+  }
+  payload.resize(payload_size);
+  if (payload_size &&
+      fread(&payload[0], payload_size, 1, file_) != 1) {
+    error_ = "Truncated record";
+    return false;
+  }
+
+  *record = InstanceRecord_Dev();
+  record->type = static_cast<InstanceRecord_Dev::Type>(type);
+  record->instance = instance;
+  time_ += delta_us / 1e6;
+  record->time = time_;
+
+  PayloadReader reader(payload);
+  bool ok = false;
+  switch (record->type) {
+    case InstanceRecord_Dev::TYPE_DID_CREATE: {
+      uint32_t argc;
+      ok = reader.Read(&argc);
+      for (uint32_t i = 0; ok && i < argc; i++) {
+        std::string name, value;
+        ok = reader.ReadString(&name) && reader.ReadString(&value);
+        record->arg_names.push_back(name);
+        record->arg_values.push_back(value);
+      }
+      break;
+    }
+    case InstanceRecord_Dev::TYPE_DID_DESTROY:
+      ok = true;
+      break;
+    case InstanceRecord_Dev::TYPE_DID_CHANGE_VIEW:
+      ok = reader.ReadRect(&record->position) && reader.ReadRect(&record->clip);
+      break;
+    case InstanceRecord_Dev::TYPE_DID_CHANGE_FOCUS: {
+      uint8_t has_focus = 0;
+      ok = reader.Read(&has_focus);
+      record->has_focus = has_focus != 0;
+      break;
+    }
+    case InstanceRecord_Dev::TYPE_HANDLE_INPUT_EVENT:
+      ok = reader.Read(&record->event);
+      break;
+    case InstanceRecord_Dev::TYPE_HANDLE_DOCUMENT_LOAD:
+      ok = reader.ReadString(&record->url);
+      break;
+  }
+  if (!ok || !reader.AtEnd()) {
+    error_ = "Bad record";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace pp
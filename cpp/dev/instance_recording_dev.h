@@ -0,0 +1,146 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_DEV_INSTANCE_RECORDING_DEV_H_
+#define PPAPI_CPP_DEV_INSTANCE_RECORDING_DEV_H_
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_input_event.h"
+#include "ppapi/c/pp_rect.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/pp_time.h"
+
+namespace pp {
+
+// One PPP_Instance call captured by InstanceRecorder_Dev. Only the fields
+// belonging to |type| are meaningful.
+struct InstanceRecord_Dev {
+  enum Type {
+    TYPE_DID_CREATE = 1,
+    TYPE_DID_DESTROY = 2,
+    TYPE_DID_CHANGE_VIEW = 3,
+    TYPE_DID_CHANGE_FOCUS = 4,
+    TYPE_HANDLE_INPUT_EVENT = 5,
+    TYPE_HANDLE_DOCUMENT_LOAD = 6
+  };
+
+  InstanceRecord_Dev();
+
+  Type type;
+
+  // Instances are numbered from 0 in the order they first appear in the log,
+  // so that a replay can map them to instances of its own.
+  uint32_t instance;
+
+  // Seconds since the recording started.
+  PP_TimeTicks time;
+
+  // TYPE_DID_CREATE: the attributes of the embed element.
+  std::vector<std::string> arg_names;
+  std::vector<std::string> arg_values;
+
+  // TYPE_DID_CHANGE_VIEW.
+  PP_Rect position;
+  PP_Rect clip;
+
+  // TYPE_DID_CHANGE_FOCUS.
+  bool has_focus;
+
+  // TYPE_HANDLE_INPUT_EVENT. The time stamp is the original one; see
+  // InstanceRecordReader_Dev::start_time().
+  PP_InputEvent event;
+
+  // TYPE_HANDLE_DOCUMENT_LOAD: the URL of the document. The document itself
+  // is not recorded.
+  std::string url;
+};
+
+// Writes instance records to a file.
+//
+// The format is meant to be compact and quick to write while a session is
+// being recorded, not portable: numbers are in host byte order and input
+// events are stored as raw PP_InputEvent structs, so a log must be replayed
+// on the same architecture it was recorded on. The file starts with
+//
+//   char magic[8] = "PPIREC1\n"
+//   uint32_t sizeof(PP_InputEvent)
+//   double start_time   (PPB_Core.GetTimeTicks when recording started)
+//
+// and each record is
+//
+//   uint8_t type
+//   uint8_t instance
+//   uint32_t microseconds since the previous record
+//   uint32_t payload size, followed by the payload.
+//
+// Payloads: DidCreate is a uint32_t argument count followed by the names
+// and values as length-prefixed strings, DidChangeView the 8 int32_t of the
+// two rects, DidChangeFocus one byte, HandleInputEvent the PP_InputEvent and
+// HandleDocumentLoad the length-prefixed URL. DidDestroy has no payload.
+class InstanceRecordWriter_Dev {
+ public:
+  InstanceRecordWriter_Dev();
+  ~InstanceRecordWriter_Dev();
+
+  // Creates or truncates the file at |path| and writes the header. Returns
+  // false if the file can't be written.
+  bool Open(const char* path, PP_TimeTicks start_time);
+
+  // Appends |record|. The instance number must be below 256. Records must be
+  // written in time order.
+  bool Write(const InstanceRecord_Dev& record);
+
+  // Flushes and closes the file. Called by the destructor.
+  void Close();
+
+  bool is_open() const { return file_ != NULL; }
+
+ private:
+  FILE* file_;
+  PP_TimeTicks last_time_;
+
+  // Disallow copy and assign (these are unimplemented).
+  InstanceRecordWriter_Dev(const InstanceRecordWriter_Dev&);
+  InstanceRecordWriter_Dev& operator=(const InstanceRecordWriter_Dev&);
+};
+
+// Reads the records written by InstanceRecordWriter_Dev.
+class InstanceRecordReader_Dev {
+ public:
+  InstanceRecordReader_Dev();
+  ~InstanceRecordReader_Dev();
+
+  // Opens the log at |path| and checks its header. On failure returns false
+  // and sets |error|.
+  bool Open(const char* path, std::string* error);
+
+  // Reads the next record into |record|. Returns false at the end of the log
+  // or if the log is corrupt; error() tells them apart.
+  bool Read(InstanceRecord_Dev* record);
+
+  // Empty unless Open() or Read() failed because of a bad log.
+  const std::string& error() const { return error_; }
+
+  // The clock value when the recording started. Subtract it from the time
+  // stamps of recorded input events to get times relative to the start.
+  PP_TimeTicks start_time() const { return start_time_; }
+
+ private:
+  FILE* file_;
+  PP_TimeTicks start_time_;
+  PP_TimeTicks time_;
+  std::string error_;
+
+  // Disallow copy and assign (these are unimplemented).
+  InstanceRecordReader_Dev(const InstanceRecordReader_Dev&);
+  InstanceRecordReader_Dev& operator=(const InstanceRecordReader_Dev&);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_DEV_INSTANCE_RECORDING_DEV_H_
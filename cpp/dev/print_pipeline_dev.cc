@@ -0,0 +1,647 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/dev/print_pipeline_dev.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/dev/buffer_dev.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/cpp/module.h"
+
+namespace pp {
+
+namespace {
+
+const int32_t kDefaultBandHeight = 256;
+
+// The end of data marker of RunLengthDecode.
+const char kRunLengthEnd = static_cast<char>(128);
+
+uint32_t Luma(uint32_t red, uint32_t green, uint32_t blue) {
+  return (red * 77 + green * 150 + blue * 29 + 128) >> 8;
+}
+
+// Appends |size| bytes of |data| to |out| encoded for the PDF
+// RunLengthDecode filter, without the end of data marker, so that encoded
+// rows and bands can be concatenated.
+void AppendRunLength(const unsigned char* data,
+                     size_t size,
+                     std::string* out) {
+  size_t i = 0;
+  while (i < size) {
+    size_t run = 1;
+    while (i + run < size && run < 128 && data[i + run] == data[i])
+      run++;
+    if (run > 1) {
+      out->push_back(static_cast<char>(257 - run));
+      out->push_back(static_cast<char>(data[i]));
+      i += run;
+      continue;
+    }
+
+    // Literal bytes, up to where a run starts.
+    size_t start = i;
+    while (i < size && i - start < 128 &&
+           !(i + 1 < size && data[i] == data[i + 1]))
+      i++;
+    out->push_back(static_cast<char>(i - start - 1));
+    out->append(reinterpret_cast<const char*>(data + start), i - start);
+  }
+}
+
+class StringOutput : public PrintPipeline_Dev::Output {
+ public:
+  const std::string& data() const { return data_; }
+
+  virtual bool Write(const void* data, size_t size) {
+    data_.append(static_cast<const char*>(data), size);
+    return true;
+  }
+
+ private:
+  std::string data_;
+};
+
+std::string Format(const char* format, unsigned long value) {
+  char buffer[64];
+  sprintf(buffer, format, value);
+  return buffer;
+}
+
+}  // namespace
+
+// PDF writer ------------------------------------------------------------------
+
+// Writes a PDF with each page as an image, streamed a band at a time. The
+// objects are numbered so that they can be referred to before they're
+// written: the catalog, the page tree, and then for each page its page
+// object, content stream, image and the image's length.
+class PrintPipeline_Dev::PdfWriter {
+ public:
+  PdfWriter(Output* output,
+            const Size& page_pixels,
+            const PP_Size& page_points,
+            bool grayscale,
+            uint32_t page_count);
+
+  // Writes everything up to the first page.
+  bool Begin();
+
+  // Writes the next band. Bands must come in order.
+  bool WriteBand(const Band& band, const std::string& data);
+
+  // Writes what follows the last page.
+  bool Finish();
+
+ private:
+  static int PageObject(uint32_t slot) { return 3 + 4 * slot; }
+
+  bool Write(const void* data, size_t size);
+  bool Write(const std::string& data) {
+    return Write(data.data(), data.size());
+  }
+
+  // Notes where object |number| starts and writes its header.
+  bool StartObject(int number);
+
+  Output* output_;
+  Size page_pixels_;
+  PP_Size page_points_;
+  bool grayscale_;
+  uint32_t page_count_;
+
+  // Bytes written so far.
+  size_t offset_;
+
+  // Where each object starts, for the cross-reference table.
+  std::vector<size_t> object_offsets_;
+
+  // Where the image stream of the current page starts.
+  size_t stream_start_;
+};
+
+PrintPipeline_Dev::PdfWriter::PdfWriter(Output* output,
+                                        const Size& page_pixels,
+                                        const PP_Size& page_points,
+                                        bool grayscale,
+                                        uint32_t page_count)
+    : output_(output),
+      page_pixels_(page_pixels),
+      page_points_(page_points),
+      grayscale_(grayscale),
+      page_count_(page_count),
+      offset_(0),
+      object_offsets_(PageObject(page_count), 0),
+      stream_start_(0) {
+}
+
+bool PrintPipeline_Dev::PdfWriter::Begin() {
+  // The second line marks the file as binary.
+  std::string pages = "<< /Type /Pages /Kids [";
+  for (uint32_t i = 0; i < page_count_; i++)
+    pages += Format("%lu 0 R ", PageObject(i));
+  pages += Format("] /Count %lu >>\nendobj\n", page_count_);
+  return Write("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n", 15) &&
+      StartObject(1) &&
+      Write("<< /Type /Catalog /Pages 2 0 R >>\nendobj\n") &&
+      StartObject(2) &&
+      Write(pages);
+}
+
+bool PrintPipeline_Dev::PdfWriter::WriteBand(const Band& band,
+                                             const std::string& data) {
+  int object = PageObject(band.page_slot);
+  if (band.rect.y() == 0) {
+    std::string page =
+        "<< /Type /Page /Parent 2 0 R" +
+        Format(" /MediaBox [0 0 %lu", page_points_.width) +
+        Format(" %lu]", page_points_.height) +
+        Format(" /Resources << /XObject << /Im0 %lu 0 R >> >>", object + 2) +
+        Format(" /Contents %lu 0 R >>\nendobj\n", object + 1);
+    std::string content = Format("q %lu 0 0", page_points_.width) +
+        Format(" %lu 0 0 cm /Im0 Do Q", page_points_.height);
+    std::string image =
+        "<< /Type /XObject /Subtype /Image" +
+        Format(" /Width %lu", page_pixels_.width()) +
+        Format(" /Height %lu", page_pixels_.height()) +
+        (grayscale_ ? " /ColorSpace /DeviceGray" : " /ColorSpace /DeviceRGB") +
+        " /BitsPerComponent 8 /Filter /RunLengthDecode" +
+        Format(" /Length %lu 0 R >>\nstream\n", object + 3);
+    if (!StartObject(object) || !Write(page) ||
+        !StartObject(object + 1) ||
+        !Write(Format("<< /Length %lu >>\nstream\n", content.size())) ||
+        !Write(content) || !Write("\nendstream\nendobj\n") ||
+        !StartObject(object + 2) || !Write(image))
+      return false;
+    stream_start_ = offset_;
+  }
+
+  if (!Write(data))
+    return false;
+
+  if (band.rect.bottom() == page_pixels_.height()) {
+    size_t length = offset_ + 1 - stream_start_;
+    return Write(&kRunLengthEnd, 1) &&
+        Write("\nendstream\nendobj\n") &&
+        StartObject(object + 3) &&
+        Write(Format("%lu\nendobj\n", length));
+  }
+  return true;
+}
+
+bool PrintPipeline_Dev::PdfWriter::Finish() {
+  size_t xref_offset = offset_;
+  std::string xref = Format("xref\n0 %lu\n", object_offsets_.size()) +
+      "0000000000 65535 f \n";
+  for (size_t i = 1; i < object_offsets_.size(); i++)
+    xref += Format("%010lu 00000 n \n", object_offsets_[i]);
+  xref += Format("trailer\n<< /Size %lu /Root 1 0 R >>\n",
+                 object_offsets_.size());
+  xref += Format("startxref\n%lu\n%%%%EOF\n", xref_offset);
+  return Write(xref);
+}
+
+bool PrintPipeline_Dev::PdfWriter::Write(const void* data, size_t size) {
+  if (size == 0)
+    return true;
+  offset_ += size;
+  return output_->Write(data, size);
+}
+
+bool PrintPipeline_Dev::PdfWriter::StartObject(int number) {
+  object_offsets_[number] = offset_;
+  return Write(Format("%lu 0 obj\n", number));
+}
+
+// Worker threads --------------------------------------------------------------
+
+#if defined(_WIN32)
+
+// No threads; the bands are rasterized on the main thread.
+class PrintPipeline_Dev::Workers {
+ public:
+  Workers(PrintPipeline_Dev*, int) {}
+
+  size_t thread_count() const { return 0; }
+
+  bool Run(const std::vector<Band>&,
+           std::vector<ImageData>*,
+           const RasterOutput*,
+           PdfWriter*) {
+    PP_NOTREACHED();
+    return false;
+  }
+};
+
+#else
+
+// Rasterizes bands on a fixed set of threads, each with its own scratch
+// image. The calling thread waits and writes the compressed bands in order.
+class PrintPipeline_Dev::Workers {
+ public:
+  Workers(PrintPipeline_Dev* pipeline, int count);
+  ~Workers();
+
+  size_t thread_count() const { return threads_.size(); }
+
+  // Processes |bands| with one image of |scratch| per thread, and writes
+  // them to |pdf| if it's not NULL. Returns when all of them are done.
+  bool Run(const std::vector<Band>& bands,
+           std::vector<ImageData>* scratch,
+           const RasterOutput* raster_output,
+           PdfWriter* pdf);
+
+ private:
+  // The state shared with the threads. Only used on the main thread while a
+  // Run is in progress.
+  struct Shared {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_cond_t done_cond;
+
+    PrintPipeline_Dev* pipeline;
+    const std::vector<Band>* bands;
+    std::vector<ImageData>* scratch;
+    const RasterOutput* raster_output;
+
+    // Indices in |bands|.
+    std::deque<size_t> queue;
+    int busy;
+
+    // The compressed bands that are done but not yet written, by index.
+    std::map<size_t, std::string> done;
+
+    bool quit;
+  };
+
+  struct Thread {
+    Shared* shared;
+    size_t index;
+  };
+
+  static void* ThreadMain(void* data);
+
+  Shared shared_;
+  std::vector<Thread> thread_data_;
+  std::vector<pthread_t> threads_;
+};
+
+PrintPipeline_Dev::Workers::Workers(PrintPipeline_Dev* pipeline, int count)
+    : thread_data_(count) {
+  pthread_mutex_init(&shared_.lock, NULL);
+  pthread_cond_init(&shared_.cond, NULL);
+  pthread_cond_init(&shared_.done_cond, NULL);
+  shared_.pipeline = pipeline;
+  shared_.bands = NULL;
+  shared_.scratch = NULL;
+  shared_.raster_output = NULL;
+  shared_.busy = 0;
+  shared_.quit = false;
+  for (int i = 0; i < count; i++) {
+    thread_data_[i].shared = &shared_;
+    thread_data_[i].index = i;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &ThreadMain, &thread_data_[i]) != 0)
+      break;
+    threads_.push_back(thread);
+  }
+}
+
+PrintPipeline_Dev::Workers::~Workers() {
+  pthread_mutex_lock(&shared_.lock);
+  shared_.quit = true;
+  pthread_cond_broadcast(&shared_.cond);
+  pthread_mutex_unlock(&shared_.lock);
+  for (size_t i = 0; i < threads_.size(); i++)
+    pthread_join(threads_[i], NULL);
+  pthread_cond_destroy(&shared_.done_cond);
+  pthread_cond_destroy(&shared_.cond);
+  pthread_mutex_destroy(&shared_.lock);
+}
+
+bool PrintPipeline_Dev::Workers::Run(const std::vector<Band>& bands,
+                                     std::vector<ImageData>* scratch,
+                                     const RasterOutput* raster_output,
+                                     PdfWriter* pdf) {
+  // Bands done ahead of the one being written are held in memory, so only
+  // a few are let ahead.
+  const size_t kWindow = threads_.size() * 2;
+
+  pthread_mutex_lock(&shared_.lock);
+  shared_.bands = &bands;
+  shared_.scratch = scratch;
+  shared_.raster_output = raster_output;
+  bool ok = true;
+  size_t next_post = 0;
+  for (size_t next_write = 0; ok && next_write < bands.size(); next_write++) {
+    for (; next_post < bands.size() && next_post < next_write + kWindow;
+         next_post++)
+      shared_.queue.push_back(next_post);
+    pthread_cond_broadcast(&shared_.cond);
+
+    std::map<size_t, std::string>::iterator found;
+    while ((found = shared_.done.find(next_write)) == shared_.done.end())
+      pthread_cond_wait(&shared_.done_cond, &shared_.lock);
+    std::string data;
+    data.swap(found->second);
+    shared_.done.erase(found);
+
+    if (pdf) {
+      pthread_mutex_unlock(&shared_.lock);
+      ok = pdf->WriteBand(bands[next_write], data);
+      pthread_mutex_lock(&shared_.lock);
+    }
+  }
+
+  // After a failure, the bands being rasterized still use |scratch|.
+  shared_.queue.clear();
+  while (shared_.busy > 0)
+    pthread_cond_wait(&shared_.done_cond, &shared_.lock);
+  shared_.done.clear();
+  shared_.bands = NULL;
+  shared_.scratch = NULL;
+  shared_.raster_output = NULL;
+  pthread_mutex_unlock(&shared_.lock);
+  return ok;
+}
+
+// static
+void* PrintPipeline_Dev::Workers::ThreadMain(void* data) {
+  Thread* thread = static_cast<Thread*>(data);
+  Shared* shared = thread->shared;
+  pthread_mutex_lock(&shared->lock);
+  for (;;) {
+    while (!shared->quit && shared->queue.empty())
+      pthread_cond_wait(&shared->cond, &shared->lock);
+    if (shared->quit)
+      break;
+    size_t index = shared->queue.front();
+    shared->queue.pop_front();
+    shared->busy++;
+    pthread_mutex_unlock(&shared->lock);
+
+    std::string compressed;
+    shared->pipeline->ProcessBand((*shared->bands)[index],
+                                  &(*shared->scratch)[thread->index],
+                                  shared->raster_output, &compressed);
+
+    pthread_mutex_lock(&shared->lock);
+    shared->busy--;
+    shared->done[index].swap(compressed);
+    pthread_cond_signal(&shared->done_cond);
+  }
+  pthread_mutex_unlock(&shared->lock);
+  return NULL;
+}
+
+#endif  // defined(_WIN32)
+
+// PrintPipeline_Dev -----------------------------------------------------------
+
+PrintPipeline_Dev::PrintPipeline_Dev(Instance* instance, int worker_count)
+    : Printing_Dev(instance),
+      band_height_(kDefaultBandHeight),
+      page_count_(0),
+      workers_(NULL) {
+  memset(&settings_, 0, sizeof(settings_));
+  if (worker_count > 0) {
+    workers_ = new Workers(this, worker_count);
+    if (workers_->thread_count() == 0) {
+      delete workers_;
+      workers_ = NULL;
+    }
+  }
+}
+
+PrintPipeline_Dev::~PrintPipeline_Dev() {
+  delete workers_;
+}
+
+Size PrintPipeline_Dev::GetPageSize() const {
+  return Size(
+      static_cast<int32_t>(
+          settings_.printable_area.size.width / 72.0 * settings_.dpi),
+      static_cast<int32_t>(
+          settings_.printable_area.size.height / 72.0 * settings_.dpi));
+}
+
+ImageData PrintPipeline_Dev::RasterizePages(
+    const PP_PrintPageNumberRange_Dev* page_ranges,
+    uint32_t page_range_count) {
+  std::vector<uint32_t> pages;
+  if (!GetPages(page_ranges, page_range_count, &pages))
+    return ImageData();
+
+  Size page_size = GetPageSize();
+  ImageData image(ImageData::GetNativeImageDataFormat(),
+                  Size(page_size.width(),
+                       page_size.height() * static_cast<int32_t>(pages.size())),
+                  false);
+  if (image.is_null())
+    return ImageData();
+  RasterOutput raster_output;
+  raster_output.data = static_cast<uint32_t*>(image.data());
+  raster_output.stride = image.stride();
+  if (!RunBands(pages, &raster_output, NULL))
+    return ImageData();
+  return image;
+}
+
+bool PrintPipeline_Dev::WritePdf(
+    const PP_PrintPageNumberRange_Dev* page_ranges,
+    uint32_t page_range_count,
+    Output* output) {
+  std::vector<uint32_t> pages;
+  if (!GetPages(page_ranges, page_range_count, &pages))
+    return false;
+
+  PdfWriter pdf(output, GetPageSize(), settings_.printable_area.size,
+                settings_.grayscale, static_cast<uint32_t>(pages.size()));
+  return pdf.Begin() && RunBands(pages, NULL, &pdf) && pdf.Finish();
+}
+
+PP_PrintOutputFormat_Dev* PrintPipeline_Dev::QuerySupportedPrintOutputFormats(
+    uint32_t* format_count) {
+  const uint32_t kFormatCount = 2;
+  PP_PrintOutputFormat_Dev* formats = static_cast<PP_PrintOutputFormat_Dev*>(
+      Module::Get()->core()->MemAlloc(
+          kFormatCount * sizeof(PP_PrintOutputFormat_Dev)));
+  if (!formats) {
+    *format_count = 0;
+    return NULL;
+  }
+  formats[0] = PP_PRINTOUTPUTFORMAT_PDF;
+  formats[1] = PP_PRINTOUTPUTFORMAT_RASTER;
+  *format_count = kFormatCount;
+  return formats;
+}
+
+int32_t PrintPipeline_Dev::PrintBegin(
+    const PP_PrintSettings_Dev& print_settings) {
+  page_count_ = 0;
+  if (print_settings.format != PP_PRINTOUTPUTFORMAT_RASTER &&
+      print_settings.format != PP_PRINTOUTPUTFORMAT_PDF)
+    return 0;
+  settings_ = print_settings;
+  if (GetPageSize().IsEmpty())
+    return 0;
+  page_count_ = std::max(BeginPrinting(settings_), 0);
+  return page_count_;
+}
+
+Resource PrintPipeline_Dev::PrintPages(
+    const PP_PrintPageNumberRange_Dev* page_ranges,
+    uint32_t page_range_count) {
+  if (settings_.format == PP_PRINTOUTPUTFORMAT_RASTER)
+    return RasterizePages(page_ranges, page_range_count);
+
+  // The output is a single buffer, so the document is collected before it's
+  // copied in; only the compressed pages are ever held, not their pixels.
+  StringOutput output;
+  if (!WritePdf(page_ranges, page_range_count, &output))
+    return Resource();
+  const std::string& pdf = output.data();
+  Buffer_Dev buffer(static_cast<int32_t>(pdf.size()));
+  if (buffer.is_null())
+    return Resource();
+  memcpy(buffer.data(), pdf.data(), pdf.size());
+  return buffer;
+}
+
+void PrintPipeline_Dev::PrintEnd() {
+  page_count_ = 0;
+  EndPrinting();
+}
+
+void PrintPipeline_Dev::EndPrinting() {
+}
+
+bool PrintPipeline_Dev::GetPages(
+    const PP_PrintPageNumberRange_Dev* page_ranges,
+    uint32_t page_range_count,
+    std::vector<uint32_t>* pages) const {
+  for (uint32_t i = 0; i < page_range_count; i++) {
+    const PP_PrintPageNumberRange_Dev& range = page_ranges[i];
+    if (range.first_page_number > range.last_page_number ||
+        range.last_page_number >= static_cast<uint32_t>(page_count_))
+      return false;
+    for (uint32_t page = range.first_page_number;
+         page <= range.last_page_number; page++)
+      pages->push_back(page);
+  }
+  return !pages->empty();
+}
+
+bool PrintPipeline_Dev::RunBands(const std::vector<uint32_t>& pages,
+                                 const RasterOutput* raster_output,
+                                 PdfWriter* pdf) {
+  Size page_size = GetPageSize();
+  int32_t band_height =
+      std::max(std::min(band_height_, page_size.height()), 1);
+  std::vector<Band> bands;
+  for (uint32_t slot = 0; slot < pages.size(); slot++) {
+    for (int32_t y = 0; y < page_size.height(); y += band_height) {
+      Band band;
+      band.page = pages[slot];
+      band.rect = Rect(0, y, page_size.width(),
+                       std::min(band_height, page_size.height() - y));
+      band.page_slot = slot;
+      bands.push_back(band);
+    }
+  }
+
+  size_t scratch_count = workers_ ? workers_->thread_count() : 1;
+  std::vector<ImageData> scratch;
+  for (size_t i = 0; i < scratch_count; i++) {
+    scratch.push_back(ImageData(ImageData::GetNativeImageDataFormat(),
+                                Size(page_size.width(), band_height), false));
+    if (scratch.back().is_null())
+      return false;
+  }
+
+  if (workers_)
+    return workers_->Run(bands, &scratch, raster_output, pdf);
+
+  std::string compressed;
+  for (size_t i = 0; i < bands.size(); i++) {
+    ProcessBand(bands[i], &scratch[0], raster_output, &compressed);
+    if (pdf && !pdf->WriteBand(bands[i], compressed))
+      return false;
+  }
+  return true;
+}
+
+void PrintPipeline_Dev::ProcessBand(const Band& band,
+                                    ImageData* scratch,
+                                    const RasterOutput* raster_output,
+                                    std::string* compressed) {
+  int32_t width = band.rect.width();
+  int32_t height = band.rect.height();
+  for (int32_t y = 0; y < height; y++)
+    memset(scratch->GetAddr32(Point(0, y)), 0, width * sizeof(uint32_t));
+  RasterizeBand(band.page, band.rect, scratch);
+
+  int red_shift = scratch->format() == PP_IMAGEDATAFORMAT_BGRA_PREMUL ? 16 : 0;
+  int blue_shift = 16 - red_shift;
+  bool grayscale = settings_.grayscale;
+
+  if (raster_output) {
+    int32_t first_row = band.page_slot * GetPageSize().height() +
+        band.rect.y();
+    for (int32_t y = 0; y < height; y++) {
+      const uint32_t* src = scratch->GetAddr32(Point(0, y));
+      uint32_t* dst = reinterpret_cast<uint32_t*>(
+          reinterpret_cast<char*>(raster_output->data) +
+          (first_row + y) * raster_output->stride);
+      if (!grayscale) {
+        memcpy(dst, src, width * sizeof(uint32_t));
+        continue;
+      }
+      for (int32_t x = 0; x < width; x++) {
+        uint32_t pixel = src[x];
+        uint32_t luma = Luma((pixel >> red_shift) & 0xFF,
+                             (pixel >> 8) & 0xFF,
+                             (pixel >> blue_shift) & 0xFF);
+        dst[x] = (pixel & 0xFF000000) | luma << 16 | luma << 8 | luma;
+      }
+    }
+    return;
+  }
+
+  // Printed over white, as the colors are premultiplied.
+  compressed->clear();
+  std::vector<unsigned char> row(width * (grayscale ? 1 : 3));
+  for (int32_t y = 0; y < height; y++) {
+    const uint32_t* src = scratch->GetAddr32(Point(0, y));
+    unsigned char* out = &row[0];
+    for (int32_t x = 0; x < width; x++) {
+      uint32_t pixel = src[x];
+      uint32_t white = 255 - (pixel >> 24);
+      uint32_t red = std::min(((pixel >> red_shift) & 0xFF) + white, 255u);
+      uint32_t green = std::min(((pixel >> 8) & 0xFF) + white, 255u);
+      uint32_t blue = std::min(((pixel >> blue_shift) & 0xFF) + white, 255u);
+      if (grayscale) {
+        *out++ = static_cast<unsigned char>(Luma(red, green, blue));
+      } else {
+        *out++ = static_cast<unsigned char>(red);
+        *out++ = static_cast<unsigned char>(green);
+        *out++ = static_cast<unsigned char>(blue);
+      }
+    }
+    AppendRunLength(&row[0], row.size(), compressed);
+  }
+}
+
+}  // namespace pp
@@ -0,0 +1,177 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_DEV_PRINT_PIPELINE_DEV_H_
+#define PPAPI_CPP_DEV_PRINT_PIPELINE_DEV_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/dev/ppp_printing_dev.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/dev/printing_dev.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/size.h"
+
+namespace pp {
+
+class Instance;
+
+// Implements printing for plugins that can rasterize their pages, such as
+// document viewers.
+//
+// Pages are rasterized at the print dpi in horizontal bands, so that however
+// high the dpi, only a few bands of pixels are being worked on at a time.
+// The bands are rasterized on worker threads if there are any, several at
+// once, and then:
+//
+//  - for PP_PRINTOUTPUTFORMAT_RASTER, copied into the output image, which
+//    has the pages one below the other.
+//  - for PP_PRINTOUTPUTFORMAT_PDF, compressed (RunLengthDecode) and written
+//    out in order as soon as all the bands before them are, each page as an
+//    image. No page is ever held whole in memory. WritePdf can also stream
+//    the document somewhere other than the print output, like a file.
+//
+// Plugins implement BeginPrinting and RasterizeBand instead of the
+// Printing_Dev functions:
+//
+//   class MyInstance : public pp::Instance, public pp::PrintPipeline_Dev {
+//    public:
+//     MyInstance(PP_Instance instance)
+//         : pp::Instance(instance),
+//           pp::PrintPipeline_Dev(this, 2) {
+//     }
+//
+//    protected:
+//     virtual int32_t BeginPrinting(const PP_PrintSettings_Dev& settings) {
+//       return document_->page_count();
+//     }
+//
+//     virtual void RasterizeBand(uint32_t page,
+//                                const pp::Rect& band,
+//                                pp::ImageData* image) {
+//       document_->Render(page, band, settings().dpi, image);
+//     }
+//   };
+class PrintPipeline_Dev : public Printing_Dev {
+ public:
+  // Receives the PDF from WritePdf as it's produced.
+  class Output {
+   public:
+    // Appends |size| bytes to the output. Returns false to stop.
+    virtual bool Write(const void* data, size_t size) = 0;
+
+   protected:
+    virtual ~Output() {}
+  };
+
+  // Rasterizes on |worker_count| threads, or on the main thread if 0.
+  // Worker threads aren't available on all platforms; the main thread is
+  // then used.
+  PrintPipeline_Dev(Instance* instance, int worker_count);
+  virtual ~PrintPipeline_Dev();
+
+  // How many rows of pixels a band has. Defaults to 256.
+  void set_band_height(int32_t band_height) { band_height_ = band_height; }
+
+  // The settings and page count of the print session.
+  const PP_PrintSettings_Dev& settings() const { return settings_; }
+  int32_t page_count() const { return page_count_; }
+
+  // The size of a page in pixels at the print dpi.
+  Size GetPageSize() const;
+
+  // Rasterizes the pages in |page_ranges| into one image with the pages one
+  // below the other. Returns an is_null() image on failure.
+  ImageData RasterizePages(const PP_PrintPageNumberRange_Dev* page_ranges,
+                           uint32_t page_range_count);
+
+  // Writes a PDF document of the pages in |page_ranges| to |output|.
+  // Returns false on failure.
+  bool WritePdf(const PP_PrintPageNumberRange_Dev* page_ranges,
+                uint32_t page_range_count,
+                Output* output);
+
+  // Printing_Dev implementation.
+  virtual PP_PrintOutputFormat_Dev* QuerySupportedPrintOutputFormats(
+      uint32_t* format_count);
+  virtual int32_t PrintBegin(const PP_PrintSettings_Dev& print_settings);
+  virtual Resource PrintPages(const PP_PrintPageNumberRange_Dev* page_ranges,
+                              uint32_t page_range_count);
+  virtual void PrintEnd();
+
+ protected:
+  // Called by PrintBegin. Returns the number of pages, or 0 on failure.
+  virtual int32_t BeginPrinting(const PP_PrintSettings_Dev& settings) = 0;
+
+  // Rasterizes |band| of |page|, in pixels at the print dpi, into |image|,
+  // the top left of |band| going at the top left of |image|. Pixels left
+  // transparent print as white.
+  //
+  // When there are worker threads this is called on them, so it may only
+  // use the pixels of |image| (data(), stride(), GetAddr32()) and data that
+  // is safe to read concurrently, and no PPAPI functions. Several bands may
+  // be rasterized at the same time.
+  virtual void RasterizeBand(uint32_t page,
+                             const Rect& band,
+                             ImageData* image) = 0;
+
+  // Called by PrintEnd. Does nothing by default.
+  virtual void EndPrinting();
+
+ private:
+  class PdfWriter;
+  class Workers;
+  friend class Workers;
+
+  // A band to rasterize, in the order of the output.
+  struct Band {
+    uint32_t page;
+    Rect rect;
+
+    // Where the page goes in the output: its position in the page ranges.
+    uint32_t page_slot;
+  };
+
+  // Where RasterizePages copies the bands.
+  struct RasterOutput {
+    uint32_t* data;
+    int32_t stride;
+  };
+
+  // Appends the pages of |page_ranges| to |pages|. Returns false if there
+  // are none, or some don't exist.
+  bool GetPages(const PP_PrintPageNumberRange_Dev* page_ranges,
+                uint32_t page_range_count,
+                std::vector<uint32_t>* pages) const;
+
+  // Rasterizes the bands of |pages|, copying them into |raster_output| or,
+  // if it's NULL, compressing them and writing them to |pdf| in order.
+  bool RunBands(const std::vector<uint32_t>& pages,
+                const RasterOutput* raster_output,
+                PdfWriter* pdf);
+
+  // Rasterizes |band| into |scratch| and then copies it into
+  // |raster_output|, or compresses it into |compressed|. May run on a worker
+  // thread.
+  void ProcessBand(const Band& band,
+                   ImageData* scratch,
+                   const RasterOutput* raster_output,
+                   std::string* compressed);
+
+  int32_t band_height_;
+  PP_PrintSettings_Dev settings_;
+  int32_t page_count_;
+
+  Workers* workers_;
+
+  // Disallow copy and assign (these are unimplemented).
+  PrintPipeline_Dev(const PrintPipeline_Dev&);
+  PrintPipeline_Dev& operator=(const PrintPipeline_Dev&);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_DEV_PRINT_PIPELINE_DEV_H_
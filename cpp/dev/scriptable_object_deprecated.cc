@@ -34,7 +34,9 @@ class ExceptionConverter {
 };
 
 // Used internally to convert a C-style array of PP_Var to a vector of Var.
-void ArgListToVector(uint32_t argc, PP_Var* argv, std::vector<Var>* output) {
+void ArgListToVector(uint32_t argc,
+                     const PP_Var* argv,
+                     std::vector<Var>* output) {
   output->reserve(argc);
   for (size_t i = 0; i < argc; i++)
     output->push_back(Var(Var::DontManage(), argv[i]));
@@ -99,11 +101,8 @@ PP_Var Call(void* object,
             PP_Var* argv,
             PP_Var* exception) {
   ExceptionConverter e(exception);
-
-  std::vector<Var> args;
-  ArgListToVector(argc, argv, &args);
-  return static_cast<ScriptableObject*>(object)->Call(
-      Var(Var::DontManage(), method_name), args, e.Get()).Detach();
+  return static_cast<ScriptableObject*>(object)->CallWithArgList(
+      Var(Var::DontManage(), method_name), argc, argv, e.Get()).Detach();
 }
 
 PP_Var Construct(void* object,
@@ -172,6 +171,15 @@ Var ScriptableObject::Call(const Var& /*method_name*/,
   return Var();
 }
 
+Var ScriptableObject::CallWithArgList(const Var& method_name,
+                                      uint32_t argc,
+                                      const PP_Var* argv,
+                                      Var* exception) {
+  std::vector<Var> args;
+  ArgListToVector(argc, argv, &args);
+  return Call(method_name, args, exception);
+}
+
 Var ScriptableObject::Construct(const std::vector<Var>& /*args*/,
                                 Var* exception) {
   *exception = Var("Constuct method does not exist in ScriptableObject");
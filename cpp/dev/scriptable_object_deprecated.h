@@ -7,7 +7,10 @@
 
 #include <vector>
 
+#include "ppapi/c/pp_stdint.h"
+
 struct PPP_Class_Deprecated;
+struct PP_Var;
 
 namespace pp {
 class Var;
@@ -70,6 +73,15 @@ class ScriptableObject {
                    const std::vector<Var>& args,
                    Var* exception);
 
+  // Called for calls from the browser with the |argc| arguments at |argv|,
+  // which the browser keeps ownership of. The default implementation copies
+  // them into a vector and calls Call() above; BoundScriptableObject converts
+  // them straight to the parameters of the bound method instead.
+  virtual Var CallWithArgList(const Var& method_name,
+                              uint32_t argc,
+                              const PP_Var* argv,
+                              Var* exception);
+
   // The default implementation sets an exception that the method does not
   // exist.
   virtual Var Construct(const std::vector<Var>& args,
@@ -0,0 +1,266 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/dev/selection_cache_dev.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "ppapi/c/dev/ppb_var_deprecated.h"
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/module_impl.h"
+
+namespace pp {
+
+namespace {
+
+DeviceFuncs<PPB_Var_Deprecated> ppb_var_f(PPB_VAR_DEPRECATED_INTERFACE);
+
+// Copied text goes into chunks of this size; larger appends get a chunk of
+// their own.
+const size_t kChunkSize = 64 * 1024;
+
+// Makes a string Var of |size| bytes at |data|.
+Var MakeStringVar(const char* data, size_t size) {
+  if (!ppb_var_f)
+    return Var(Var::Null());
+  return Var(Var::PassRef(),
+             ppb_var_f->VarFromUtf8(Module::Get()->pp_module(), data,
+                                    static_cast<uint32_t>(size)));
+}
+
+}  // namespace
+
+// SelectionCache_Dev::Builder -------------------------------------------------
+
+SelectionCache_Dev::Builder::Builder()
+    : size_(0),
+      current_chunk_(0),
+      chunk_used_(0) {
+}
+
+SelectionCache_Dev::Builder::~Builder() {
+  for (size_t i = 0; i < chunks_.size(); i++)
+    delete[] chunks_[i];
+}
+
+void SelectionCache_Dev::Builder::Append(const char* data, size_t size) {
+  if (size == 0)
+    return;
+  // Finds a chunk with room, making one if there's none.
+  while (current_chunk_ < chunks_.size() &&
+         chunk_sizes_[current_chunk_] - chunk_used_ < size) {
+    // Chunks are only left partly used for large appends, which get the
+    // next one to themselves below.
+    if (size > kChunkSize)
+      break;
+    current_chunk_++;
+    chunk_used_ = 0;
+  }
+  if (current_chunk_ >= chunks_.size() ||
+      chunk_sizes_[current_chunk_] - chunk_used_ < size) {
+    size_t chunk_size = std::max(size, kChunkSize);
+    current_chunk_ = chunks_.size();
+    chunks_.push_back(new char[chunk_size]);
+    chunk_sizes_.push_back(chunk_size);
+    chunk_used_ = 0;
+  }
+
+  char* dest = chunks_[current_chunk_] + chunk_used_;
+  memcpy(dest, data, size);
+  chunk_used_ += size;
+  // Successive small appends grow the same piece.
+  if (!pieces_.empty() &&
+      pieces_.back().data + pieces_.back().size == dest) {
+    pieces_.back().size += size;
+    size_ += size;
+    return;
+  }
+  AppendReference(dest, size);
+}
+
+void SelectionCache_Dev::Builder::Append(const std::string& text) {
+  Append(text.data(), text.size());
+}
+
+void SelectionCache_Dev::Builder::AppendReference(const char* data,
+                                                  size_t size) {
+  if (size == 0)
+    return;
+  Piece piece;
+  piece.data = data;
+  piece.size = size;
+  pieces_.push_back(piece);
+  size_ += size;
+}
+
+void SelectionCache_Dev::Builder::Clear() {
+  pieces_.clear();
+  size_ = 0;
+  current_chunk_ = 0;
+  chunk_used_ = 0;
+}
+
+void SelectionCache_Dev::Builder::CopyTo(size_t offset,
+                                         size_t size,
+                                         char* dest) const {
+  PP_DCHECK(offset + size <= size_);
+  size_t piece_start = 0;
+  for (size_t i = 0; i < pieces_.size() && size > 0; i++) {
+    const Piece& piece = pieces_[i];
+    size_t piece_end = piece_start + piece.size;
+    if (offset < piece_end) {
+      size_t begin = offset - piece_start;
+      size_t count = std::min(piece.size - begin, size);
+      memcpy(dest, piece.data + begin, count);
+      dest += count;
+      offset += count;
+      size -= count;
+    }
+    piece_start = piece_end;
+  }
+}
+
+std::string SelectionCache_Dev::Builder::ToString() const {
+  std::string result;
+  result.reserve(size_);
+  for (size_t i = 0; i < pieces_.size(); i++)
+    result.append(pieces_[i].data, pieces_[i].size);
+  return result;
+}
+
+Var SelectionCache_Dev::Builder::ToVar() const {
+  if (pieces_.empty())
+    return MakeStringVar("", 0);
+  if (pieces_.size() == 1)
+    return MakeStringVar(pieces_[0].data, pieces_[0].size);
+  std::vector<char> flat(size_);
+  CopyTo(0, size_, &flat[0]);
+  return MakeStringVar(&flat[0], flat.size());
+}
+
+// SelectionCache_Dev ----------------------------------------------------------
+
+SelectionCache_Dev::SelectionCache_Dev(Instance* instance)
+    : Selection_Dev(instance),
+      max_selection_size_(0),
+      stream_slice_size_(1024 * 1024),
+      stream_output_(NULL),
+      stream_callback_(NULL, NULL),
+      stream_id_(0),
+      stream_html_(false),
+      stream_offset_(0),
+      callback_factory_(this) {
+}
+
+SelectionCache_Dev::~SelectionCache_Dev() {
+  // The client's Output may be gone already, so the callback isn't run.
+}
+
+void SelectionCache_Dev::InvalidateSelection() {
+  for (size_t i = 0; i < 2; i++) {
+    Entry& entry = entries_[i];
+    entry.built = false;
+    entry.selected = false;
+    entry.builder.Clear();
+    entry.has_var = false;
+    entry.var = Var();
+  }
+  if (stream_output_)
+    FinishStream(PP_ERROR_ABORTED);
+}
+
+size_t SelectionCache_Dev::GetSelectionSize(bool html) {
+  Entry* entry = GetEntry(html);
+  return entry->selected ? entry->builder.size() : 0;
+}
+
+int32_t SelectionCache_Dev::StreamSelection(
+    bool html,
+    Output* output,
+    const CompletionCallback& callback) {
+  PP_DCHECK(output);
+  if (stream_output_)
+    return PP_ERROR_INPROGRESS;
+  stream_output_ = output;
+  stream_callback_ = callback;
+  stream_id_++;
+  stream_html_ = html;
+  stream_offset_ = 0;
+  // Even the first slice waits for a callback, so that building the
+  // selection isn't added to the caller's time.
+  Module::Get()->core()->CallOnMainThread(
+      0, callback_factory_.NewCallback(&SelectionCache_Dev::StreamNextSlice,
+                                       stream_id_));
+  return PP_ERROR_WOULDBLOCK;
+}
+
+Var SelectionCache_Dev::GetSelectedText(bool html) {
+  Entry* entry = GetEntry(html);
+  if (!entry->selected ||
+      (max_selection_size_ > 0 &&
+       entry->builder.size() > max_selection_size_))
+    return Var();
+  if (!entry->has_var) {
+    entry->var = entry->builder.ToVar();
+    entry->has_var = true;
+  }
+  return entry->var;
+}
+
+SelectionCache_Dev::Entry* SelectionCache_Dev::GetEntry(bool html) {
+  Entry* entry = &entries_[html ? 1 : 0];
+  if (!entry->built) {
+    entry->selected = BuildSelection(html, &entry->builder);
+    entry->built = true;
+  }
+  return entry;
+}
+
+void SelectionCache_Dev::StreamNextSlice(int32_t,
+                                         const uint32_t& stream_id) {
+  // Aborted streams don't cancel their pending callback.
+  if (!stream_output_ || stream_id != stream_id_)
+    return;
+  Entry* entry = GetEntry(stream_html_);
+  if (!entry->selected) {
+    FinishStream(PP_ERROR_FAILED);
+    return;
+  }
+
+  const Builder& builder = entry->builder;
+  size_t count = std::min(stream_slice_size_,
+                          builder.size() - stream_offset_);
+  if (count > 0) {
+    stream_buffer_.resize(count);
+    builder.CopyTo(stream_offset_, count, &stream_buffer_[0]);
+    if (!stream_output_->Write(&stream_buffer_[0], count)) {
+      FinishStream(PP_ERROR_FAILED);
+      return;
+    }
+    stream_offset_ += count;
+  }
+  if (stream_offset_ == builder.size()) {
+    FinishStream(PP_OK);
+    return;
+  }
+  Module::Get()->core()->CallOnMainThread(
+      0, callback_factory_.NewCallback(&SelectionCache_Dev::StreamNextSlice,
+                                       stream_id_));
+}
+
+void SelectionCache_Dev::FinishStream(int32_t result) {
+  stream_output_ = NULL;
+  std::vector<char>().swap(stream_buffer_);
+  // Cleared first, as the callback may start another stream.
+  CompletionCallback callback = stream_callback_;
+  stream_callback_ = CompletionCallback(NULL, NULL);
+  callback.Run(result);
+}
+
+}  // namespace pp
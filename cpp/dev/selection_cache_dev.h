@@ -0,0 +1,201 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_DEV_SELECTION_CACHE_DEV_H_
+#define PPAPI_CPP_DEV_SELECTION_CACHE_DEV_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/dev/selection_dev.h"
+#include "ppapi/cpp/var.h"
+
+namespace pp {
+
+class Instance;
+
+// Implements Selection_Dev for plugins with large documents.
+//
+// The selection is built as a rope (Builder) of the pieces of the document
+// it spans: pieces of the document's own text are referenced rather than
+// copied, and the rest is copied into large chunks. The rope is turned into
+// the string Var with a single copy into an allocation of the final size,
+// or none if it's a single piece. The text and the Var of each format are
+// cached until the selection changes, so the browser asking for the
+// selection again, as it does for each copy or drag, costs nothing.
+//
+// A selection larger than set_max_selection_size() isn't returned by
+// GetSelectedText; StreamSelection hands it out in slices over separate main
+// thread callbacks instead, so that the renderer, blocked on
+// GetSelectedText, isn't kept waiting.
+//
+//   class MyInstance : public pp::Instance, public pp::SelectionCache_Dev {
+//    public:
+//     MyInstance(PP_Instance instance)
+//         : pp::Instance(instance),
+//           pp::SelectionCache_Dev(this) {
+//     }
+//
+//     void SelectionChanged() {
+//       InvalidateSelection();
+//     }
+//
+//    protected:
+//     virtual bool BuildSelection(bool html, Builder* builder) {
+//       if (html)
+//         return false;
+//       for (size_t i = first_line_; i <= last_line_; i++) {
+//         builder->AppendReference(lines_[i].data(), lines_[i].size());
+//         builder->Append("\n", 1);
+//       }
+//       return true;
+//     }
+//   };
+class SelectionCache_Dev : public Selection_Dev {
+ public:
+  // Builds a string out of pieces without moving the text around.
+  class Builder {
+   public:
+    Builder();
+    ~Builder();
+
+    // Appends a copy of |size| bytes at |data|.
+    void Append(const char* data, size_t size);
+    void Append(const std::string& text);
+
+    // Appends the |size| bytes at |data| without copying them. They must
+    // stay valid and unchanged as long as the builder uses them: until it's
+    // cleared or gone.
+    void AppendReference(const char* data, size_t size);
+
+    // The size of the string, in bytes.
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Drops the pieces. The chunks are kept for reuse.
+    void Clear();
+
+    // Copies |size| bytes starting at |offset| of the string to |dest|.
+    void CopyTo(size_t offset, size_t size, char* dest) const;
+
+    std::string ToString() const;
+    Var ToVar() const;
+
+   private:
+    struct Piece {
+      const char* data;
+      size_t size;
+    };
+
+    std::vector<Piece> pieces_;
+    size_t size_;
+
+    // The copied text. Chunks never move, so pieces can point into them.
+    std::vector<char*> chunks_;
+    std::vector<size_t> chunk_sizes_;
+    size_t current_chunk_;
+    size_t chunk_used_;
+
+    // Disallow copy and assign (these are unimplemented).
+    Builder(const Builder&);
+    Builder& operator=(const Builder&);
+  };
+
+  // Receives the selection from StreamSelection.
+  class Output {
+   public:
+    // Appends |size| bytes to the output. Returns false to stop.
+    virtual bool Write(const void* data, size_t size) = 0;
+
+   protected:
+    virtual ~Output() {}
+  };
+
+  explicit SelectionCache_Dev(Instance* instance);
+  virtual ~SelectionCache_Dev();
+
+  // GetSelectedText returns a void Var, as when the format is unavailable,
+  // for selections of more than |size| bytes. 0, the default, means no
+  // limit.
+  void set_max_selection_size(size_t size) { max_selection_size_ = size; }
+
+  // How many bytes StreamSelection writes per callback. Defaults to 1 MB.
+  void set_stream_slice_size(size_t size) { stream_slice_size_ = size; }
+
+  // Drops the cached selection. Must be called when the selection, or the
+  // text it references, changes. A stream in progress is aborted.
+  void InvalidateSelection();
+
+  // The size in bytes of the selection in the given format, building it if
+  // needed. 0 if nothing is selected or the format is unavailable.
+  size_t GetSelectionSize(bool html);
+
+  // Writes the selection in the given format to |output|, a slice per main
+  // thread callback, and then runs |callback| with PP_OK. It's run with
+  // PP_ERROR_FAILED if there's no selection or |output| stops, and with
+  // PP_ERROR_ABORTED if the selection is invalidated before the end.
+  // Returns PP_ERROR_WOULDBLOCK, or PP_ERROR_INPROGRESS if a stream is
+  // already in progress.
+  int32_t StreamSelection(bool html,
+                          Output* output,
+                          const CompletionCallback& callback);
+
+  // Selection_Dev implementation.
+  virtual Var GetSelectedText(bool html);
+
+ protected:
+  // Appends the selection in the given format to |builder|. Returns false
+  // if nothing is selected or the format is unavailable.
+  virtual bool BuildSelection(bool html, Builder* builder) = 0;
+
+ private:
+  // The cached selection in one format.
+  struct Entry {
+    Entry() : built(false), selected(false), has_var(false) {}
+
+    // BuildSelection was called, and returned |selected|.
+    bool built;
+    bool selected;
+    Builder builder;
+
+    // |var| holds the builder's text.
+    bool has_var;
+    Var var;
+  };
+
+  // Returns the entry of the given format, built.
+  Entry* GetEntry(bool html);
+
+  // Writes the next slice of the stream numbered |stream_id|.
+  void StreamNextSlice(int32_t, const uint32_t& stream_id);
+
+  // Ends the stream with |result|.
+  void FinishStream(int32_t result);
+
+  // Plain text and html.
+  Entry entries_[2];
+
+  size_t max_selection_size_;
+  size_t stream_slice_size_;
+
+  // The stream in progress, if |stream_output_| isn't NULL.
+  Output* stream_output_;
+  CompletionCallback stream_callback_;
+  uint32_t stream_id_;
+  bool stream_html_;
+  size_t stream_offset_;
+  std::vector<char> stream_buffer_;
+
+  CompletionCallbackFactory<SelectionCache_Dev> callback_factory_;
+
+  // Disallow copy and assign (these are unimplemented).
+  SelectionCache_Dev(const SelectionCache_Dev&);
+  SelectionCache_Dev& operator=(const SelectionCache_Dev&);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_DEV_SELECTION_CACHE_DEV_H_
@@ -0,0 +1,52 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/dev/tile_zoom_dev.h"
+
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/tile_cache.h"
+
+namespace pp {
+
+TileZoom_Dev::TileZoom_Dev(Instance* instance,
+                           TileCache* tile_cache,
+                           Client* client)
+    : Zoom_Dev(instance),
+      tile_cache_(tile_cache),
+      client_(client),
+      settle_delay_ms_(150),
+      factor_(1.0),
+      zoom_count_(0),
+      callback_factory_(this) {
+  PP_DCHECK(tile_cache && client);
+}
+
+TileZoom_Dev::~TileZoom_Dev() {
+}
+
+void TileZoom_Dev::Zoom(double factor, bool text_only) {
+  if (text_only || factor <= 0) {
+    client_->DidZoom(factor, text_only, true);
+    return;
+  }
+  factor_ = factor;
+  tile_cache_->Zoom(static_cast<float>(factor));
+  zoom_count_++;
+  client_->DidZoom(factor, false, false);
+  Module::Get()->core()->CallOnMainThread(
+      settle_delay_ms_,
+      callback_factory_.NewCallback(&TileZoom_Dev::OnSettleDelay,
+                                    zoom_count_));
+}
+
+void TileZoom_Dev::OnSettleDelay(int32_t, const uint32_t& zoom_count) {
+  if (zoom_count != zoom_count_ || !tile_cache_->is_zooming())
+    return;
+  tile_cache_->EndZoom();
+  client_->DidZoom(factor_, false, true);
+}
+
+}  // namespace pp
@@ -0,0 +1,76 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_DEV_TILE_ZOOM_DEV_H_
+#define PPAPI_CPP_DEV_TILE_ZOOM_DEV_H_
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/dev/zoom_dev.h"
+
+namespace pp {
+
+class Instance;
+class TileCache;
+
+// Handles the browser's zoom requests for a plugin that paints from a
+// TileCache.
+//
+// Zoom factors that come in quick succession, as during a pinch or when
+// the zoom keys are held down, are a zoom gesture: the TileCache paints them
+// by scaling its power of two levels (TileCache::Zoom) rather than
+// rendering the surface again at each. Once no new factor has come for the
+// settle delay the gesture ends, and the tiles are rendered at the final
+// factor (TileCache::EndZoom).
+//
+// Text only zooms don't scale the surface; they're passed on to the client
+// as they are.
+class TileZoom_Dev : public Zoom_Dev {
+ public:
+  class Client {
+   public:
+    // Called when the zoom factor changes during a gesture, with |settled|
+    // false, and when it ends, with |settled| true. The client should lay
+    // out for |factor| and invalidate the whole device. For text only zooms
+    // the tile cache isn't touched and |settled| is always true.
+    virtual void DidZoom(double factor, bool text_only, bool settled) = 0;
+
+   protected:
+    // You shouldn't be doing deleting through this interface.
+    virtual ~Client() {}
+  };
+
+  TileZoom_Dev(Instance* instance, TileCache* tile_cache, Client* client);
+  virtual ~TileZoom_Dev();
+
+  // How long after the last zoom factor the gesture ends. Defaults to 150
+  // ms.
+  void set_settle_delay_ms(int32_t delay) { settle_delay_ms_ = delay; }
+
+  // Zoom_Dev implementation.
+  virtual void Zoom(double factor, bool text_only);
+
+ private:
+  // Ends the gesture if no factor came since the one numbered |zoom_count|.
+  void OnSettleDelay(int32_t result, const uint32_t& zoom_count);
+
+  TileCache* tile_cache_;
+  Client* client_;
+  int32_t settle_delay_ms_;
+
+  double factor_;
+
+  // Counts the zoom factors of gestures, to tell the last one.
+  uint32_t zoom_count_;
+
+  CompletionCallbackFactory<TileZoom_Dev> callback_factory_;
+
+  // Disallow copy and assign (these are unimplemented).
+  TileZoom_Dev(const TileZoom_Dev&);
+  TileZoom_Dev& operator=(const TileZoom_Dev&);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_DEV_TILE_ZOOM_DEV_H_
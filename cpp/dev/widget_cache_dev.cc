@@ -0,0 +1,292 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/dev/widget_cache_dev.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "ppapi/c/pp_input_event.h"
+#include "ppapi/cpp/size.h"
+
+namespace pp {
+
+namespace {
+
+// More dirty rects than this are merged into one.
+const size_t kMaxDirtyRects = 4;
+
+// Copies |src_rect| of |src| into |dst| with its top left at |dst_point|.
+// Both must be within the images.
+void CopyPixels(const ImageData& src,
+                const Rect& src_rect,
+                ImageData* dst,
+                const Point& dst_point) {
+  for (int32_t y = 0; y < src_rect.height(); y++) {
+    memcpy(dst->GetAddr32(Point(dst_point.x(), dst_point.y() + y)),
+           src.GetAddr32(Point(src_rect.x(), src_rect.y() + y)),
+           src_rect.width() * sizeof(uint32_t));
+  }
+}
+
+// Whether all of |location|, in plugin coordinates, can be rasterized.
+bool IsRasterizable(const Rect& location) {
+  return location.x() >= 0 && location.y() >= 0;
+}
+
+}  // namespace
+
+WidgetCache_Dev::WidgetCache_Dev()
+    : max_saved_states_(4),
+      use_count_(0),
+      rasterized_pixels_(0) {
+}
+
+WidgetCache_Dev::~WidgetCache_Dev() {
+  for (EntryMap::iterator it = entries_.begin(); it != entries_.end(); ++it)
+    delete it->second;
+}
+
+void WidgetCache_Dev::SetLocation(Widget_Dev widget, const Rect& location) {
+  widget.SetLocation(location);
+  Entry*& entry = entries_[widget.pp_resource()];
+  if (!entry) {
+    entry = new Entry;
+    entry->widget = widget;
+  } else if (entry->location.size() != location.size() ||
+             (entry->location.point() != location.point() &&
+              !IsRasterizable(entry->location))) {
+    // Parts left of or above the plugin weren't rasterized, and might now
+    // be seen.
+    entry->has_image = false;
+    entry->image = ImageData();
+    entry->saved.clear();
+  }
+  entry->location = location;
+}
+
+void WidgetCache_Dev::RemoveWidget(const Widget_Dev& widget) {
+  EntryMap::iterator found = entries_.find(widget.pp_resource());
+  if (found == entries_.end())
+    return;
+  delete found->second;
+  entries_.erase(found);
+}
+
+bool WidgetCache_Dev::HandleEvent(Widget_Dev widget,
+                                  const PP_InputEvent& event) {
+  bool handled = widget.HandleEvent(event);
+  Entry* entry = GetEntry(widget);
+  if (!entry)
+    return handled;
+
+  // The browser changes the widget's look from the same events.
+  const Rect& location = entry->location;
+  switch (event.type) {
+    case PP_INPUTEVENT_TYPE_MOUSEDOWN:
+      if (location.Contains(static_cast<int32_t>(event.u.mouse.x),
+                            static_cast<int32_t>(event.u.mouse.y)))
+        entry->state.pressed = true;
+      break;
+    case PP_INPUTEVENT_TYPE_MOUSEUP:
+      entry->state.pressed = false;
+      // Fall through.
+    case PP_INPUTEVENT_TYPE_MOUSEMOVE:
+    case PP_INPUTEVENT_TYPE_MOUSEENTER:
+      entry->state.hovered =
+          location.Contains(static_cast<int32_t>(event.u.mouse.x),
+                            static_cast<int32_t>(event.u.mouse.y));
+      break;
+    case PP_INPUTEVENT_TYPE_MOUSELEAVE:
+      entry->state.hovered = false;
+      break;
+    default:
+      break;
+  }
+  return handled;
+}
+
+void WidgetCache_Dev::SetValue(const Widget_Dev& widget, uint32_t value) {
+  Entry* entry = GetEntry(widget);
+  if (entry)
+    entry->state.value = value;
+}
+
+void WidgetCache_Dev::Invalidate(const Widget_Dev& widget,
+                                 const Rect& dirty_rect) {
+  Entry* entry = GetEntry(widget);
+  if (!entry)
+    return;
+  Rect dirty = dirty_rect.Intersect(entry->location);
+  if (dirty.IsEmpty())
+    return;
+  dirty.Offset(-entry->location.x(), -entry->location.y());
+  AddDirtyRect(entry, dirty);
+}
+
+void WidgetCache_Dev::InvalidateAll(const Widget_Dev& widget) {
+  Entry* entry = GetEntry(widget);
+  if (!entry)
+    return;
+  entry->dirty.clear();
+  entry->dirty.push_back(Rect(entry->location.size()));
+  entry->saved.clear();
+}
+
+bool WidgetCache_Dev::Paint(const Widget_Dev& widget,
+                            const Rect& rect,
+                            ImageData* image,
+                            const Point& image_origin) {
+  Entry* entry = GetEntry(widget);
+  if (!entry || !UpdateImage(entry))
+    return false;
+
+  Rect area = rect.Intersect(entry->location).Intersect(
+      Rect(image_origin, image->size()));
+  if (area.IsEmpty())
+    return true;
+  CopyPixels(entry->image,
+             Rect(area.point() - entry->location.point(), area.size()),
+             image, area.point() - image_origin);
+  return true;
+}
+
+bool WidgetCache_Dev::RasterizeWidget(Widget_Dev* widget,
+                                      const Rect& rect,
+                                      ImageData* image) {
+  return widget->Paint(rect, image);
+}
+
+WidgetCache_Dev::Entry* WidgetCache_Dev::GetEntry(const Widget_Dev& widget) {
+  EntryMap::iterator found = entries_.find(widget.pp_resource());
+  return found == entries_.end() ? NULL : found->second;
+}
+
+void WidgetCache_Dev::AddDirtyRect(Entry* entry, const Rect& rect) {
+  // Merges with the rects it touches, which may then touch others.
+  Rect merged = rect;
+  bool merging = true;
+  while (merging) {
+    merging = false;
+    for (size_t i = 0; i < entry->dirty.size(); i++) {
+      if (merged.Intersects(entry->dirty[i]) ||
+          merged.SharesEdgeWith(entry->dirty[i])) {
+        merged = merged.Union(entry->dirty[i]);
+        entry->dirty.erase(entry->dirty.begin() + i);
+        merging = true;
+        break;
+      }
+    }
+  }
+  entry->dirty.push_back(merged);
+
+  if (entry->dirty.size() > kMaxDirtyRects) {
+    for (size_t i = 1; i < entry->dirty.size(); i++)
+      entry->dirty[0] = entry->dirty[0].Union(entry->dirty[i]);
+    entry->dirty.resize(1);
+  }
+}
+
+bool WidgetCache_Dev::UpdateImage(Entry* entry) {
+  if (entry->location.IsEmpty())
+    return false;
+
+  if (!entry->has_image) {
+    entry->image = ImageData(ImageData::GetNativeImageDataFormat(),
+                             entry->location.size(), true);
+    if (entry->image.is_null())
+      return false;
+    entry->has_image = true;
+    entry->image_state = entry->state;
+    entry->dirty.clear();
+    entry->dirty.push_back(Rect(entry->location.size()));
+  }
+
+  if (!(entry->state == entry->image_state)) {
+    std::vector<SavedImage>::iterator saved = entry->saved.begin();
+    while (saved != entry->saved.end() && !(saved->state == entry->state))
+      ++saved;
+    if (saved != entry->saved.end()) {
+      // Been here before: swap the images so the current one is saved in
+      // its place. What was invalidated since came with the state change.
+      entry->image.swap(saved->image);
+      saved->state = entry->image_state;
+      saved->last_used = ++use_count_;
+      entry->dirty.clear();
+    } else if (max_saved_states_ > 0) {
+      SaveImage(entry);
+    }
+    entry->image_state = entry->state;
+  }
+
+  while (!entry->dirty.empty()) {
+    if (!Rasterize(entry, entry->dirty.back()))
+      return false;
+    entry->dirty.pop_back();
+  }
+  return true;
+}
+
+void WidgetCache_Dev::SaveImage(Entry* entry) {
+  SavedImage* slot = NULL;
+  if (entry->saved.size() < max_saved_states_) {
+    entry->saved.push_back(SavedImage());
+    slot = &entry->saved.back();
+  } else {
+    slot = &entry->saved[0];
+    for (size_t i = 1; i < entry->saved.size(); i++) {
+      if (entry->saved[i].last_used < slot->last_used)
+        slot = &entry->saved[i];
+    }
+  }
+
+  if (slot->image.is_null()) {
+    slot->image = ImageData(entry->image.format(), entry->image.size(),
+                            false);
+    if (slot->image.is_null()) {
+      entry->saved.pop_back();
+      return;
+    }
+  }
+  CopyPixels(entry->image, Rect(entry->image.size()), &slot->image,
+             Point(0, 0));
+  slot->state = entry->image_state;
+  slot->last_used = ++use_count_;
+}
+
+bool WidgetCache_Dev::Rasterize(Entry* entry, const Rect& rect) {
+  // Widget_Dev::Paint draws in plugin coordinates, and |staging_| starts at
+  // the plugin's origin, so what's left of or above it can't be rasterized.
+  // It can't be seen there either.
+  Rect plugin_rect = rect;
+  plugin_rect.Offset(entry->location.point());
+  plugin_rect = plugin_rect.Intersect(
+      Rect(0, 0, std::max(plugin_rect.right(), 0),
+           std::max(plugin_rect.bottom(), 0)));
+  if (plugin_rect.IsEmpty())
+    return true;
+
+  Size staging_size = staging_.size();
+  if (staging_size.width() < plugin_rect.right() ||
+      staging_size.height() < plugin_rect.bottom()) {
+    staging_ = ImageData(
+        ImageData::GetNativeImageDataFormat(),
+        Size(std::max(staging_size.width(), plugin_rect.right()),
+             std::max(staging_size.height(), plugin_rect.bottom())),
+        true);
+    if (staging_.is_null())
+      return false;
+  }
+
+  if (!RasterizeWidget(&entry->widget, plugin_rect, &staging_))
+    return false;
+  CopyPixels(staging_, plugin_rect, &entry->image,
+             plugin_rect.point() - entry->location.point());
+  rasterized_pixels_ +=
+      static_cast<int64_t>(plugin_rect.width()) * plugin_rect.height();
+  return true;
+}
+
+}  // namespace pp
@@ -0,0 +1,183 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_DEV_WIDGET_CACHE_DEV_H_
+#define PPAPI_CPP_DEV_WIDGET_CACHE_DEV_H_
+
+#include <map>
+#include <vector>
+
+#include "ppapi/c/pp_resource.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/dev/widget_dev.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+
+struct PP_InputEvent;
+
+namespace pp {
+
+// Keeps the rendering of widgets, such as scrollbars, so that painting them
+// doesn't make the browser rasterize them each time.
+//
+// Each widget's current look is kept in an image of its size. When the
+// widget is invalidated only the dirty part is rasterized again, so a
+// scrollbar whose value changes only has the area of the old and new thumb
+// redone. The images of the last few states a widget was in (its value,
+// whether the mouse is over it and whether it is pressed) are kept too, so
+// going back to one of them, like the mouse leaving a scrollbar again, costs
+// a swap instead of a rasterization.
+//
+// The cache has to be told about everything that changes a widget's look:
+// route the widget's location, input events, value changes and
+// invalidations through it, and call InvalidateAll for other changes like
+// the document size or tick marks of a scrollbar:
+//
+//   virtual void InvalidateWidget(pp::Widget_Dev widget,
+//                                 const pp::Rect& dirty_rect) {
+//     widget_cache_.Invalidate(widget, dirty_rect);
+//     paint_manager_.InvalidateRect(dirty_rect);
+//   }
+//
+//   virtual void ScrollbarValueChanged(pp::Scrollbar_Dev scrollbar,
+//                                      uint32_t value) {
+//     widget_cache_.SetValue(scrollbar, value);
+//     ...
+//   }
+//
+// Invalidations that come with a state change are assumed to be caused by
+// it, and are dropped when the widget goes back to a state it was in before.
+class WidgetCache_Dev {
+ public:
+  WidgetCache_Dev();
+  virtual ~WidgetCache_Dev();
+
+  // How many previous states are kept per widget. Defaults to 4.
+  void set_max_saved_states(size_t max_saved_states) {
+    max_saved_states_ = max_saved_states;
+  }
+
+  // Sets the location of |widget| in plugin coordinates and starts caching
+  // it if it isn't cached yet. A change of size drops its images. Only the
+  // part of a widget right of and below the plugin's origin is cached, so
+  // moving a widget that sticks out left or above drops them too.
+  void SetLocation(Widget_Dev widget, const Rect& location);
+
+  // Stops caching |widget|.
+  void RemoveWidget(const Widget_Dev& widget);
+
+  // Passes |event| to |widget| and notes whether the mouse is over or
+  // pressing it. Returns what the widget returned.
+  bool HandleEvent(Widget_Dev widget, const PP_InputEvent& event);
+
+  // Notes the value of a scrollbar, normally from ScrollbarValueChanged.
+  void SetValue(const Widget_Dev& widget, uint32_t value);
+
+  // Marks |dirty_rect|, in plugin coordinates, of |widget| as changed,
+  // normally from InvalidateWidget.
+  void Invalidate(const Widget_Dev& widget, const Rect& dirty_rect);
+
+  // Drops all the images of |widget|, for changes the cache doesn't track.
+  void InvalidateAll(const Widget_Dev& widget);
+
+  // Paints |rect|, in plugin coordinates, of |widget| into |image|, whose top
+  // left is at |image_origin| in plugin coordinates. Rasterizes whatever is
+  // out of date first. Returns false if the widget isn't cached or couldn't
+  // be rasterized.
+  bool Paint(const Widget_Dev& widget,
+             const Rect& rect,
+             ImageData* image,
+             const Point& image_origin);
+
+  // The number of pixels rasterized by the browser since creation.
+  int64_t rasterized_pixels() const { return rasterized_pixels_; }
+
+ protected:
+  // Rasterizes |rect| of |widget| into |image|, both in plugin coordinates.
+  // Calls Widget_Dev::Paint by default.
+  virtual bool RasterizeWidget(Widget_Dev* widget,
+                               const Rect& rect,
+                               ImageData* image);
+
+ private:
+  // What a widget's look depends on, besides the things that InvalidateAll
+  // is for.
+  struct State {
+    State() : value(0), hovered(false), pressed(false) {}
+
+    bool operator==(const State& other) const {
+      return value == other.value && hovered == other.hovered &&
+          pressed == other.pressed;
+    }
+
+    uint32_t value;
+    bool hovered;
+    bool pressed;
+  };
+
+  struct SavedImage {
+    State state;
+    ImageData image;
+    uint32_t last_used;
+  };
+
+  struct Entry {
+    Entry() : has_image(false) {}
+
+    Widget_Dev widget;
+    Rect location;
+
+    // The state the widget is in now.
+    State state;
+
+    // The state |image| shows, apart from |dirty|, if |has_image|.
+    State image_state;
+    bool has_image;
+    ImageData image;
+
+    // The out of date parts of |image|, in widget coordinates. Kept apart
+    // so that the old and new thumb of a scrollbar don't take the track in
+    // between with them.
+    std::vector<Rect> dirty;
+
+    std::vector<SavedImage> saved;
+  };
+  typedef std::map<PP_Resource, Entry*> EntryMap;
+
+  Entry* GetEntry(const Widget_Dev& widget);
+
+  // Adds |rect|, in widget coordinates, to the dirty rects of |entry|.
+  void AddDirtyRect(Entry* entry, const Rect& rect);
+
+  // Brings the image of |entry| up to date with its state.
+  bool UpdateImage(Entry* entry);
+
+  // Saves a copy of the image of |entry| for its |image_state|, replacing the
+  // least recently used saved image if there are too many.
+  void SaveImage(Entry* entry);
+
+  // Rasterizes |rect|, in widget coordinates, into the image of |entry|.
+  bool Rasterize(Entry* entry, const Rect& rect);
+
+  size_t max_saved_states_;
+  EntryMap entries_;
+
+  // A plugin sized image for Widget_Dev::Paint, which rasterizes in plugin
+  // coordinates. Its top left is the plugin's origin. Grows as needed.
+  ImageData staging_;
+
+  // Orders the saved images for least recently used replacement.
+  uint32_t use_count_;
+
+  int64_t rasterized_pixels_;
+
+  // Disallow copy and assign (these are unimplemented).
+  WidgetCache_Dev(const WidgetCache_Dev&);
+  WidgetCache_Dev& operator=(const WidgetCache_Dev&);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_DEV_WIDGET_CACHE_DEV_H_
@@ -0,0 +1,297 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/layer_compositor.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "ppapi/cpp/graphics_2d.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/cpp/rect_array.h"
+
+namespace pp {
+
+namespace {
+
+// x / 255 rounded, for x in [0, 255 * 255]. The SSE2 kernel computes the
+// same thing so both give identical pixels.
+inline uint32_t Div255(uint32_t x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+// Blends |count| premultiplied pixels of |src|, scaled by |opacity|, over
+// |dst| one at a time.
+void BlendRowScalar(uint32_t* dst,
+                    const uint32_t* src,
+                    int32_t count,
+                    uint32_t opacity) {
+  for (int32_t i = 0; i < count; i++) {
+    uint32_t s = src[i];
+    if (opacity != 255) {
+      s = (Div255(((s >> 24) & 0xFF) * opacity) << 24) |
+          (Div255(((s >> 16) & 0xFF) * opacity) << 16) |
+          (Div255(((s >> 8) & 0xFF) * opacity) << 8) |
+          Div255((s & 0xFF) * opacity);
+    }
+    if (s == 0)
+      continue;
+    uint32_t inverse_alpha = 255 - (s >> 24);
+    uint32_t d = dst[i];
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      uint32_t channel = ((s >> shift) & 0xFF) +
+          Div255(((d >> shift) & 0xFF) * inverse_alpha);
+      // Only reachable with pixels that aren't validly premultiplied; the
+      // SSE2 kernel saturates as well.
+      result |= std::min(channel, 255u) << shift;
+    }
+    dst[i] = result;
+  }
+}
+
+#if defined(__SSE2__)
+
+// Div255 on eight 16-bit lanes.
+inline __m128i Div255x8(__m128i x) {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Blends two pixels, unpacked to 16 bits per channel.
+inline __m128i BlendPixels(__m128i src, __m128i dst, __m128i opacity) {
+  src = Div255x8(_mm_mullo_epi16(src, opacity));
+  // Each pixel's alpha in all four of its lanes.
+  __m128i alpha = _mm_shufflehi_epi16(
+      _mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)),
+      _MM_SHUFFLE(3, 3, 3, 3));
+  __m128i inverse_alpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+  return _mm_add_epi16(src, Div255x8(_mm_mullo_epi16(dst, inverse_alpha)));
+}
+
+// Blends four pixels at a time; the few left over go through the scalar
+// kernel.
+void BlendRow(uint32_t* dst,
+              const uint32_t* src,
+              int32_t count,
+              uint32_t opacity) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i opacity8 = _mm_set1_epi16(static_cast<int16_t>(opacity));
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    // Four fully transparent source pixels leave |dst| as it is, which is
+    // common around the content of overlays.
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xFFFF)
+      continue;
+    __m128i* d_addr = reinterpret_cast<__m128i*>(dst + i);
+    __m128i d = _mm_loadu_si128(d_addr);
+    __m128i low = BlendPixels(_mm_unpacklo_epi8(s, zero),
+                              _mm_unpacklo_epi8(d, zero), opacity8);
+    __m128i high = BlendPixels(_mm_unpackhi_epi8(s, zero),
+                               _mm_unpackhi_epi8(d, zero), opacity8);
+    _mm_storeu_si128(d_addr, _mm_packus_epi16(low, high));
+  }
+  BlendRowScalar(dst + i, src + i, count - i, opacity);
+}
+
+#else
+
+void BlendRow(uint32_t* dst,
+              const uint32_t* src,
+              int32_t count,
+              uint32_t opacity) {
+  BlendRowScalar(dst, src, count, opacity);
+}
+
+#endif  // defined(__SSE2__)
+
+}  // namespace
+
+// LayerCompositor::Layer ------------------------------------------------------
+
+LayerCompositor::Layer::Layer(LayerCompositor* compositor,
+                              const Size& size,
+                              bool is_opaque)
+    : compositor_(compositor),
+      image_(ImageData::GetNativeImageDataFormat(), size, true),
+      is_opaque_(is_opaque),
+      opacity_(255),
+      visible_(true) {
+}
+
+void LayerCompositor::Layer::SetPosition(const Point& position) {
+  if (position == position_)
+    return;
+  InvalidateAll();
+  position_ = position;
+  InvalidateAll();
+}
+
+void LayerCompositor::Layer::SetOpacity(uint8_t opacity) {
+  if (opacity == opacity_)
+    return;
+  opacity_ = opacity;
+  InvalidateAll();
+}
+
+void LayerCompositor::Layer::SetVisible(bool visible) {
+  if (visible == visible_)
+    return;
+  // Invalidates while visible so that the damage isn't dropped as the
+  // damage of a hidden layer.
+  if (visible)
+    visible_ = true;
+  InvalidateAll();
+  visible_ = visible;
+}
+
+void LayerCompositor::Layer::Invalidate(const Rect& rect) {
+  Rect device_rect = rect.Intersect(Rect(image_.size()));
+  device_rect.Offset(position_);
+  compositor_->InvalidateLayerRect(this, device_rect);
+}
+
+void LayerCompositor::Layer::InvalidateAll() {
+  compositor_->InvalidateLayerRect(this, bounds());
+}
+
+// LayerCompositor -------------------------------------------------------------
+
+LayerCompositor::LayerCompositor(Instance* instance,
+                                 uint32_t background_color)
+    : background_color_(background_color),
+      composited_pixels_(0) {
+  paint_manager_.Initialize(instance, this, (background_color >> 24) == 0xFF);
+}
+
+LayerCompositor::~LayerCompositor() {
+  for (size_t i = 0; i < layers_.size(); i++)
+    delete layers_[i];
+}
+
+LayerCompositor::Layer* LayerCompositor::AddLayer(const Size& size,
+                                                  bool is_opaque) {
+  Layer* layer = new Layer(this, size, is_opaque);
+  if (layer->image_.is_null()) {
+    delete layer;
+    return NULL;
+  }
+  layers_.push_back(layer);
+  layer->InvalidateAll();
+  return layer;
+}
+
+void LayerCompositor::RemoveLayer(Layer* layer) {
+  std::vector<Layer*>::iterator found =
+      std::find(layers_.begin(), layers_.end(), layer);
+  PP_DCHECK(found != layers_.end());
+  if (found == layers_.end())
+    return;
+  layer->InvalidateAll();
+  layers_.erase(found);
+  delete layer;
+}
+
+void LayerCompositor::SetSize(const Size& size) {
+  if (size == paint_manager_.graphics().size() && !frame_.is_null())
+    return;
+  frame_ = ImageData(ImageData::GetNativeImageDataFormat(), size, false);
+  // Invalidates everything.
+  paint_manager_.SetSize(size);
+}
+
+void LayerCompositor::SetBackgroundColor(uint32_t color) {
+  if (color == background_color_)
+    return;
+  background_color_ = color;
+  paint_manager_.Invalidate();
+}
+
+void LayerCompositor::InvalidateRect(const Rect& rect) {
+  paint_manager_.InvalidateRect(rect);
+}
+
+bool LayerCompositor::OnPaint(Graphics2D& graphics,
+                              const std::vector<Rect>& paint_rects,
+                              const Rect&) {
+  if (frame_.is_null())
+    return false;
+  RectArray rects;
+  rects.Append(paint_rects);
+  rects.IntersectAll(Rect(frame_.size()));
+  for (size_t i = 0; i < rects.size(); i++) {
+    Rect rect = rects[i];
+    if (rect.IsEmpty())
+      continue;
+    Composite(rect);
+    graphics.PaintImageData(frame_, Point(0, 0), rect);
+  }
+  return true;
+}
+
+void LayerCompositor::InvalidateLayerRect(const Layer* layer,
+                                          const Rect& rect) {
+  if (!layer->visible_ || rect.IsEmpty())
+    return;
+  std::vector<Layer*>::const_iterator it =
+      std::find(layers_.begin(), layers_.end(), layer);
+  if (it == layers_.end())
+    return;
+  for (++it; it != layers_.end(); ++it) {
+    if ((*it)->IsOccluding() && (*it)->bounds().Contains(rect))
+      return;
+  }
+  paint_manager_.InvalidateRect(rect);
+}
+
+void LayerCompositor::Composite(const Rect& rect) {
+  // Layers below the topmost opaque layer that covers all of |rect| can't
+  // show, so compositing starts there.
+  size_t first = 0;
+  bool first_covers = false;
+  for (size_t i = layers_.size(); i > 0; i--) {
+    const Layer* layer = layers_[i - 1];
+    if (layer->IsOccluding() && layer->bounds().Contains(rect)) {
+      first = i - 1;
+      first_covers = true;
+      break;
+    }
+  }
+
+  if (!first_covers) {
+    for (int32_t y = rect.y(); y < rect.bottom(); y++) {
+      uint32_t* row = frame_.GetAddr32(Point(rect.x(), y));
+      std::fill(row, row + rect.width(), background_color_);
+    }
+  }
+
+  for (size_t i = first; i < layers_.size(); i++) {
+    const Layer* layer = layers_[i];
+    if (!layer->visible_ || layer->opacity_ == 0)
+      continue;
+    Rect area = rect.Intersect(layer->bounds());
+    if (area.IsEmpty())
+      continue;
+    Point src_origin = area.point() - layer->position_;
+    for (int32_t y = 0; y < area.height(); y++) {
+      uint32_t* dst = frame_.GetAddr32(Point(area.x(), area.y() + y));
+      const uint32_t* src = layer->image_.GetAddr32(
+          Point(src_origin.x(), src_origin.y() + y));
+      if (layer->IsOccluding())
+        memcpy(dst, src, area.width() * sizeof(uint32_t));
+      else
+        BlendRow(dst, src, area.width(), layer->opacity_);
+    }
+    composited_pixels_ += static_cast<uint64_t>(area.width()) * area.height();
+  }
+}
+
+}  // namespace pp
@@ -0,0 +1,157 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_LAYER_COMPOSITOR_H_
+#define PPAPI_CPP_LAYER_COMPOSITOR_H_
+
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/paint_manager.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/size.h"
+
+namespace pp {
+
+class Graphics2D;
+class Instance;
+
+// Composites a stack of layers, such as a background, content, overlays and a
+// cursor, each drawn into its own ImageData, onto the plugin's device.
+//
+// Each layer has a position on the device and an opacity. The plugin draws
+// into a layer's image() and then invalidates the part it changed; changing
+// the position, opacity or visibility of a layer invalidates the areas it
+// covered and now covers. Damage that is entirely hidden behind an opaque
+// layer is dropped. The compositor uses a PaintManager, so all the damage
+// of a frame is aggregated into a few rects, and only those rects are blended
+// again (source over, premultiplied) into the frame and painted to the
+// device. Layers that are marked opaque also stop the layers below them from
+// being blended at all where they cover them.
+//
+// Layers are stacked in the order they're added, the last one on top.
+class LayerCompositor : public PaintManager::Client {
+ public:
+  class Layer {
+   public:
+    // The pixels of the layer, BGRA premultiplied. Call Invalidate for the
+    // parts that you change.
+    ImageData& image() { return image_; }
+    const ImageData& image() const { return image_; }
+
+    Size size() const { return image_.size(); }
+    bool is_opaque() const { return is_opaque_; }
+
+    // Where the top left of the layer is on the device.
+    const Point& position() const { return position_; }
+    void SetPosition(const Point& position);
+
+    // Applied to the whole layer on top of its per-pixel alpha, 0 to 255.
+    uint8_t opacity() const { return opacity_; }
+    void SetOpacity(uint8_t opacity);
+
+    bool visible() const { return visible_; }
+    void SetVisible(bool visible);
+
+    // The area covered by the layer, in device coordinates.
+    Rect bounds() const { return Rect(position_, image_.size()); }
+
+    // Marks |rect|, in layer coordinates, as changed.
+    void Invalidate(const Rect& rect);
+    void InvalidateAll();
+
+   private:
+    friend class LayerCompositor;
+
+    Layer(LayerCompositor* compositor, const Size& size, bool is_opaque);
+
+    // True if the layer hides whatever is below it within its bounds.
+    bool IsOccluding() const {
+      return visible_ && is_opaque_ && opacity_ == 255;
+    }
+
+    LayerCompositor* compositor_;
+    ImageData image_;
+    bool is_opaque_;
+    Point position_;
+    uint8_t opacity_;
+    bool visible_;
+
+    // Disallow copy and assign (these are unimplemented).
+    Layer(const Layer&);
+    Layer& operator=(const Layer&);
+  };
+
+  // |background_color| (BGRA premultiplied) is shown where no layer is. If it
+  // is opaque the device is created opaque.
+  LayerCompositor(Instance* instance, uint32_t background_color);
+  virtual ~LayerCompositor();
+
+  // Adds a layer on top of the others, at 0,0, fully opaque and visible. Its
+  // pixels start out transparent. Set |is_opaque| only if every pixel of the
+  // layer will have an alpha of 0xFF; the layers below are then skipped where
+  // it covers them. Returns NULL if the image couldn't be allocated. The
+  // layer is owned by the compositor.
+  Layer* AddLayer(const Size& size, bool is_opaque);
+
+  // Removes and deletes |layer|.
+  void RemoveLayer(Layer* layer);
+
+  const std::vector<Layer*>& layers() const { return layers_; }
+
+  // Sets the size of the device. Normally called from ViewChanged.
+  void SetSize(const Size& size);
+
+  // Whether the device is opaque is decided at creation, so the color should
+  // stay opaque if it started out opaque.
+  void SetBackgroundColor(uint32_t color);
+  uint32_t background_color() const { return background_color_; }
+
+  // Invalidates |rect| of the device, in device coordinates.
+  void InvalidateRect(const Rect& rect);
+
+  // For the aggregator settings and the device. Don't call ScrollRect on it:
+  // the composited frame wouldn't scroll with the device.
+  const PaintManager& paint_manager() const { return paint_manager_; }
+  PaintManager& paint_manager() { return paint_manager_; }
+
+  // The number of layer pixels blended or copied into the frame since
+  // creation.
+  uint64_t composited_pixels() const { return composited_pixels_; }
+
+  // PaintManager::Client implementation.
+  virtual bool OnPaint(Graphics2D& graphics,
+                       const std::vector<Rect>& paint_rects,
+                       const Rect& paint_bounds);
+
+ private:
+  // Invalidates |rect| of the device as damage of |layer|, unless an opaque
+  // layer above it hides all of |rect|.
+  void InvalidateLayerRect(const Layer* layer, const Rect& rect);
+
+  // Recomposites |rect| of the device into |frame_|.
+  void Composite(const Rect& rect);
+
+  PaintManager paint_manager_;
+  uint32_t background_color_;
+
+  // Bottom to top.
+  std::vector<Layer*> layers_;
+
+  // The composited device contents. Only the damaged rects are composited
+  // again each frame, then painted from here.
+  ImageData frame_;
+
+  uint64_t composited_pixels_;
+
+  // Disallow copy and assign (these are unimplemented).
+  LayerCompositor(const LayerCompositor&);
+  LayerCompositor& operator=(const LayerCompositor&);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_LAYER_COMPOSITOR_H_
@@ -23,11 +23,15 @@
 
 #include "ppapi/cpp/module.h"
 
+#if defined(PPAPI_ENABLE_INSTANCE_RECORDING)
+#include <stdlib.h>
+#endif
 #include <string.h>
 
 #include "ppapi/c/pp_instance.h"
 #include "ppapi/c/pp_var.h"
 #include "ppapi/c/ppp_instance.h"
+#include "ppapi/cpp/dev/instance_recorder_dev.h"
 #include "ppapi/cpp/dev/url_loader_dev.h"
 #include "ppapi/cpp/instance.h"
 #include "ppapi/cpp/rect.h"
@@ -45,6 +49,8 @@ bool Instance_DidCreate(PP_Instance pp_instance,
   Module* module_singleton = Module::Get();
   if (!module_singleton)
     return false;
+  if (InstanceRecorder_Dev::IsRecording())
+    InstanceRecorder_Dev::RecordDidCreate(pp_instance, argc, argn, argv);
 
   Instance* instance = module_singleton->CreateInstance(pp_instance);
   if (!instance)
@@ -61,6 +67,8 @@ void Instance_DidDestroy(PP_Instance instance) {
       module_singleton->current_instances_.find(instance);
   if (found == module_singleton->current_instances_.end())
     return;
+  if (InstanceRecorder_Dev::IsRecording())
+    InstanceRecorder_Dev::RecordDidDestroy(instance);
 
   // Remove it from the map before deleting to try to catch reentrancy.
   Instance* obj = found->second;
@@ -77,6 +85,8 @@ void Instance_DidChangeView(PP_Instance pp_instance,
   Instance* instance = module_singleton->InstanceForPPInstance(pp_instance);
   if (!instance)
     return;
+  if (InstanceRecorder_Dev::IsRecording())
+    InstanceRecorder_Dev::RecordDidChangeView(pp_instance, *position, *clip);
   instance->DidChangeView(*position, *clip);
 }
 
@@ -87,6 +97,8 @@ void Instance_DidChangeFocus(PP_Instance pp_instance, bool has_focus) {
   Instance* instance = module_singleton->InstanceForPPInstance(pp_instance);
   if (!instance)
     return;
+  if (InstanceRecorder_Dev::IsRecording())
+    InstanceRecorder_Dev::RecordDidChangeFocus(pp_instance, has_focus);
   instance->DidChangeFocus(has_focus);
 }
 
@@ -98,6 +110,8 @@ bool Instance_HandleInputEvent(PP_Instance pp_instance,
   Instance* instance = module_singleton->InstanceForPPInstance(pp_instance);
   if (!instance)
     return false;
+  if (InstanceRecorder_Dev::IsRecording())
+    InstanceRecorder_Dev::RecordHandleInputEvent(pp_instance, *event);
   return instance->HandleInputEvent(*event);
 }
 
@@ -109,7 +123,10 @@ bool Instance_HandleDocumentLoad(PP_Instance pp_instance,
   Instance* instance = module_singleton->InstanceForPPInstance(pp_instance);
   if (!instance)
     return false;
-  return instance->HandleDocumentLoad(URLLoader_Dev(pp_url_loader));
+  URLLoader_Dev url_loader(pp_url_loader);
+  if (InstanceRecorder_Dev::IsRecording())
+    InstanceRecorder_Dev::RecordHandleDocumentLoad(pp_instance, url_loader);
+  return instance->HandleDocumentLoad(url_loader);
 }
 
 PP_Var Instance_GetInstanceObject(PP_Instance pp_instance) {
@@ -138,6 +155,10 @@ Module::Module() : pp_module_(0), get_browser_interface_(NULL), core_(NULL) {
 }
 
 Module::~Module() {
+#if defined(PPAPI_ENABLE_INSTANCE_RECORDING)
+  // Flushes the recording, if any, while core_ is still around.
+  InstanceRecorder_Dev::Stop();
+#endif
   delete core_;
   core_ = NULL;
 }
@@ -192,6 +213,13 @@ bool Module::InternalInit(PP_Module mod,
     return false;
   core_ = new Core(core);
 
+#if defined(PPAPI_ENABLE_INSTANCE_RECORDING)
+  // See InstanceRecorder_Dev.
+  const char* recording_path = getenv("PPAPI_INSTANCE_RECORDING");
+  if (recording_path && *recording_path)
+    InstanceRecorder_Dev::Start(this, recording_path);
+#endif
+
   return Init();
 }
 
@@ -25,6 +25,13 @@
 
 namespace pp {
 
+namespace {
+
+// The number of paint rects from which they're indexed.
+const size_t kMinIndexedPaintRects = 64;
+
+}  // namespace
+
 PaintAggregator::InternalPaintUpdate::InternalPaintUpdate() {
 }
 
@@ -65,14 +72,12 @@ Rect PaintAggregator::InternalPaintUpdate::GetScrollDamage() const {
 }
 
 Rect PaintAggregator::InternalPaintUpdate::GetPaintBounds() const {
-  Rect bounds;
-  for (size_t i = 0; i < paint_rects.size(); ++i)
-    bounds = bounds.Union(paint_rects[i]);
-  return bounds;
+  return paint_rects.UnionAll();
 }
 
 PaintAggregator::PaintAggregator()
-    : max_redundant_paint_to_scroll_area_(0.8f),
+    : paint_rects_indexed_(false),
+      max_redundant_paint_to_scroll_area_(0.8f),
       max_paint_rects_(10) {
 }
 
@@ -81,6 +86,7 @@ bool PaintAggregator::HasPendingUpdate() const {
 }
 
 void PaintAggregator::ClearPendingUpdate() {
+  ClearPaintRects();
   update_ = InternalPaintUpdate();
 }
 
@@ -93,8 +99,7 @@ PaintAggregator::PaintUpdate PaintAggregator::GetPendingUpdate() const {
   ret.has_scroll = ret.scroll_delta.x() != 0 || ret.scroll_delta.y() != 0;
 
   ret.paint_rects.reserve(update_.paint_rects.size() + 1);
-  for (size_t i = 0; i < update_.paint_rects.size(); i++)
-    ret.paint_rects.push_back(update_.paint_rects[i]);
+  update_.paint_rects.CopyTo(&ret.paint_rects);
 
   ret.paint_bounds = update_.GetPaintBounds();
 
@@ -110,21 +115,20 @@ PaintAggregator::PaintUpdate PaintAggregator::GetPendingUpdate() const {
 
 void PaintAggregator::InvalidateRect(const Rect& rect) {
   // Combine overlapping paints using smallest bounding box.
-  for (size_t i = 0; i < update_.paint_rects.size(); ++i) {
-    const Rect& existing_rect = update_.paint_rects[i];
+  size_t i = FindTouchingPaintRect(rect);
+  if (i < update_.paint_rects.size()) {
+    Rect existing_rect = update_.paint_rects[i];
     if (existing_rect.Contains(rect))  // Optimize out redundancy.
       return;
-    if (rect.Intersects(existing_rect) || rect.SharesEdgeWith(existing_rect)) {
-      // Re-invalidate in case the union intersects other paint rects.
-      Rect combined_rect = existing_rect.Union(rect);
-      update_.paint_rects.erase(update_.paint_rects.begin() + i);
-      InvalidateRect(combined_rect);
-      return;
-    }
+    // Re-invalidate in case the union intersects other paint rects.
+    Rect combined_rect = existing_rect.Union(rect);
+    ErasePaintRect(i);
+    InvalidateRect(combined_rect);
+    return;
   }
 
   // Add a non-overlapping paint.
-  update_.paint_rects.push_back(rect);
+  AppendPaintRect(rect);
 
   // If the new paint overlaps with a scroll, then it forces an invalidation of
   // the scroll.  If the new paint is contained by a scroll, then trim off the
@@ -133,10 +137,11 @@ void PaintAggregator::InvalidateRect(const Rect& rect) {
     if (ShouldInvalidateScrollRect(rect)) {
       InvalidateScrollRect();
     } else if (update_.scroll_rect.Contains(rect)) {
-      update_.paint_rects[update_.paint_rects.size() - 1] =
-          rect.Subtract(update_.GetScrollDamage());
-      if (update_.paint_rects[update_.paint_rects.size() - 1].IsEmpty())
-        update_.paint_rects.erase(update_.paint_rects.end() - 1);
+      Rect trimmed = rect.Subtract(update_.GetScrollDamage());
+      if (trimmed.IsEmpty())
+        ErasePaintRect(update_.paint_rects.size() - 1);
+      else
+        SetPaintRect(update_.paint_rects.size() - 1, trimmed);
     }
   }
 
@@ -178,14 +183,17 @@ void PaintAggregator::ScrollRect(const Rect& clip_rect, const Point& amount) {
 
   // Adjust any contained paint rects and check for any overlapping paints.
   for (size_t i = 0; i < update_.paint_rects.size(); ++i) {
-    if (update_.scroll_rect.Contains(update_.paint_rects[i])) {
-      update_.paint_rects[i] = ScrollPaintRect(update_.paint_rects[i], amount);
+    Rect paint_rect = update_.paint_rects[i];
+    if (update_.scroll_rect.Contains(paint_rect)) {
+      paint_rect = ScrollPaintRect(paint_rect, amount);
       // The rect may have been scrolled out of view.
-      if (update_.paint_rects[i].IsEmpty()) {
-        update_.paint_rects.erase(update_.paint_rects.begin() + i);
+      if (paint_rect.IsEmpty()) {
+        ErasePaintRect(i);
         i--;
+      } else {
+        SetPaintRect(i, paint_rect);
       }
-    } else if (update_.scroll_rect.Intersects(update_.paint_rects[i])) {
+    } else if (update_.scroll_rect.Intersects(paint_rect)) {
       InvalidateScrollRect();
       return;
     }
@@ -197,6 +205,71 @@ void PaintAggregator::ScrollRect(const Rect& clip_rect, const Point& amount) {
     InvalidateScrollRect();
 }
 
+void PaintAggregator::AppendPaintRect(const Rect& rect) {
+  update_.paint_rects.Append(rect);
+  if (paint_rects_indexed_) {
+    paint_rect_ids_.push_back(paint_rect_index_.Insert(rect));
+  } else if (update_.paint_rects.size() >= kMinIndexedPaintRects) {
+    for (size_t i = 0; i < update_.paint_rects.size(); i++)
+      paint_rect_ids_.push_back(
+          paint_rect_index_.Insert(update_.paint_rects[i]));
+    paint_rects_indexed_ = true;
+  }
+}
+
+void PaintAggregator::SetPaintRect(size_t index, const Rect& rect) {
+  update_.paint_rects.Set(index, rect);
+  if (paint_rects_indexed_)
+    paint_rect_index_.Move(paint_rect_ids_[index], rect);
+}
+
+void PaintAggregator::ErasePaintRect(size_t index) {
+  update_.paint_rects.Erase(index);
+  if (paint_rects_indexed_) {
+    paint_rect_index_.Remove(paint_rect_ids_[index]);
+    paint_rect_ids_.erase(paint_rect_ids_.begin() + index);
+  }
+}
+
+void PaintAggregator::ClearPaintRects() {
+  update_.paint_rects.Clear();
+  if (paint_rects_indexed_) {
+    paint_rect_index_.Clear();
+    paint_rect_ids_.clear();
+    paint_rects_indexed_ = false;
+  }
+}
+
+size_t PaintAggregator::FindTouchingPaintRect(const Rect& rect) const {
+  if (!paint_rects_indexed_)
+    return update_.paint_rects.FindTouching(rect);
+
+  // A rect touching |rect| intersects it grown by a pixel on each side. Of
+  // those, the first in |paint_rects| is the one to merge with: the paint
+  // rects are only ever appended, so it's the lowest in the index too.
+  candidate_ids_.clear();
+  paint_rect_index_.QueryRect(Rect(rect.x() - 1, rect.y() - 1,
+                                   rect.width() + 2, rect.height() + 2),
+                              &candidate_ids_);
+  bool found = false;
+  RectIndex::Id first = 0;
+  for (size_t i = 0; i < candidate_ids_.size(); i++) {
+    RectIndex::Id id = candidate_ids_[i];
+    const Rect& candidate = paint_rect_index_.GetRect(id);
+    if (!candidate.Contains(rect) && !rect.Intersects(candidate) &&
+        !rect.SharesEdgeWith(candidate))
+      continue;
+    if (!found || paint_rect_index_.IsBelow(id, first)) {
+      first = id;
+      found = true;
+    }
+  }
+  if (!found)
+    return update_.paint_rects.size();
+  return std::find(paint_rect_ids_.begin(), paint_rect_ids_.end(), first) -
+      paint_rect_ids_.begin();
+}
+
 Rect PaintAggregator::ScrollPaintRect(const Rect& paint_rect,
                                       const Point& amount) const {
   Rect result = paint_rect;
@@ -221,12 +294,8 @@ bool PaintAggregator::ShouldInvalidateScrollRect(const Rect& rect) const {
   // rect comes too close to the area of the scroll_rect.  If so, then we
   // might as well invalidate the scroll rect.
 
-  int paint_area = rect.size().GetArea();
-  for (size_t i = 0; i < update_.paint_rects.size(); ++i) {
-    const Rect& existing_rect = update_.paint_rects[i];
-    if (update_.scroll_rect.Contains(existing_rect))
-      paint_area += existing_rect.size().GetArea();
-  }
+  int64_t paint_area = rect.size().GetArea() +
+      update_.paint_rects.AreaSumContainedIn(update_.scroll_rect);
   int scroll_area = update_.scroll_rect.size().GetArea();
   if (float(paint_area) / float(scroll_area) > max_redundant_paint_to_scroll_area_)
     return true;
@@ -253,21 +322,21 @@ void PaintAggregator::CombinePaintRects() {
   //
   if (update_.scroll_rect.IsEmpty()) {
     Rect bounds = update_.GetPaintBounds();
-    update_.paint_rects.clear();
-    update_.paint_rects.push_back(bounds);
+    ClearPaintRects();
+    AppendPaintRect(bounds);
   } else {
     Rect inner, outer;
     for (size_t i = 0; i < update_.paint_rects.size(); ++i) {
-      const Rect& existing_rect = update_.paint_rects[i];
+      Rect existing_rect = update_.paint_rects[i];
       if (update_.scroll_rect.Contains(existing_rect)) {
         inner = inner.Union(existing_rect);
       } else {
         outer = outer.Union(existing_rect);
       }
     }
-    update_.paint_rects.clear();
-    update_.paint_rects.push_back(inner);
-    update_.paint_rects.push_back(outer);
+    ClearPaintRects();
+    AppendPaintRect(inner);
+    AppendPaintRect(outer);
   }
 }
 
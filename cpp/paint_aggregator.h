@@ -9,6 +9,8 @@
 
 #include "ppapi/cpp/point.h"
 #include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/rect_array.h"
+#include "ppapi/cpp/rect_index.h"
 
 namespace pp {
 
@@ -100,9 +102,19 @@ class PaintAggregator {
     Rect scroll_rect;
 
     // Does not include the scroll damage rect.
-    std::vector<Rect> paint_rects;
+    RectArray paint_rects;
   };
 
+  // Edit update_.paint_rects, keeping the index in step.
+  void AppendPaintRect(const Rect& rect);
+  void SetPaintRect(size_t index, const Rect& rect);
+  void ErasePaintRect(size_t index);
+  void ClearPaintRects();
+
+  // Returns the index of the first paint rect that contains, intersects or
+  // shares an edge with |rect|, or the number of paint rects if none does.
+  size_t FindTouchingPaintRect(const Rect& rect) const;
+
   Rect ScrollPaintRect(const Rect& paint_rect, const Point& amount) const;
   bool ShouldInvalidateScrollRect(const Rect& rect) const;
   void InvalidateScrollRect();
@@ -110,6 +122,16 @@ class PaintAggregator {
 
   InternalPaintUpdate update_;
 
+  // With max_paint_rects raised, there can be enough paint rects for a
+  // spatial index to find the one a new invalidation merges with faster than
+  // going through them all. It's built when there are that many, and then
+  // lists each paint rect under the id at the same index of
+  // |paint_rect_ids_|.
+  bool paint_rects_indexed_;
+  RectIndex paint_rect_index_;
+  std::vector<RectIndex::Id> paint_rect_ids_;
+  mutable std::vector<RectIndex::Id> candidate_ids_;
+
   // If the combined area of paint rects contained within the scroll rect grows
   // too large, then we might as well just treat the scroll rect as a paint
   // rect. This constant sets the max ratio of paint rect area to scroll rect
@@ -4,18 +4,50 @@
 
 #include "ppapi/cpp/paint_manager.h"
 
+#include <math.h>
+
+#include <algorithm>
+
 #include "ppapi/c/pp_errors.h"
+#include "ppapi/cpp/core.h"
 #include "ppapi/cpp/instance.h"
 #include "ppapi/cpp/logging.h"
 #include "ppapi/cpp/module.h"
 
 namespace pp {
 
+namespace {
+
+const int32_t kDefaultUnfocusedPaintIntervalMs = 250;
+
+// How often requested frames that don't paint are started.
+const int32_t kFrameIntervalMs = 16;
+
+// A buffer that's behind by more rects than this is repainted over their
+// bounds instead.
+const size_t kMaxBufferPaintRects = 16;
+
+}  // namespace
+
 PaintManager::PaintManager()
     : instance_(NULL),
       client_(NULL),
       is_always_opaque_(false),
-      callback_factory_(NULL) {
+      callback_factory_(NULL),
+      manual_callback_pending_(false),
+      flush_pending_(false),
+      delayed_callback_pending_(false),
+      has_clip_(false),
+      has_focus_(true),
+      unfocused_paint_interval_(kDefaultUnfocusedPaintIntervalMs),
+      last_paint_time_(0),
+      frame_listener_(NULL),
+      frame_requested_(false),
+      in_will_paint_frame_(false),
+      last_frame_time_(0),
+      fullscreen_mode_(false),
+      buffer_count_(2),
+      frame_number_(0) {
   // Set the callback object outside of the initializer list to avoid a
   // compiler warning about using "this" in an initializer list.
   callback_factory_.Initialize(this);
@@ -27,7 +59,21 @@ PaintManager::PaintManager(Instance* instance,
     : instance_(instance),
       client_(client),
       is_always_opaque_(is_always_opaque),
-      callback_factory_(NULL) {
+      callback_factory_(NULL),
+      manual_callback_pending_(false),
+      flush_pending_(false),
+      delayed_callback_pending_(false),
+      has_clip_(false),
+      has_focus_(true),
+      unfocused_paint_interval_(kDefaultUnfocusedPaintIntervalMs),
+      last_paint_time_(0),
+      frame_listener_(NULL),
+      frame_requested_(false),
+      in_will_paint_frame_(false),
+      last_frame_time_(0),
+      fullscreen_mode_(false),
+      buffer_count_(2),
+      frame_number_(0) {
   // Set the callback object outside of the initializer list to avoid a
   // compiler warning about using "this" in an initializer list.
   callback_factory_.Initialize(this);
@@ -59,17 +105,75 @@ void PaintManager::SetSize(const Size& new_size) {
 
   manual_callback_pending_ = false;
   flush_pending_ = false;
+  delayed_callback_pending_ = false;
   callback_factory_.CancelAll();
+  hidden_damage_ = Rect();
+  ResetBuffers();
 
   Invalidate();
 }
 
+void PaintManager::RequestFrame() {
+  frame_requested_ = true;
+  // From the listener, the frame in progress schedules the next one.
+  if (graphics_.is_null() || in_will_paint_frame_ || flush_pending_)
+    return;
+  ScheduleFrame();
+}
+
+void PaintManager::SetClip(const Rect& clip) {
+  if (has_clip_ && clip == clip_)
+    return;
+  has_clip_ = true;
+  clip_ = clip;
+  if (!graphics_.is_null())
+    ExposeHiddenDamage();
+}
+
+void PaintManager::SetView(const Rect& position, const Rect& clip) {
+  SetSize(position.size());
+  SetClip(clip);
+}
+
+void PaintManager::SetFocus(bool has_focus) {
+  has_focus_ = has_focus;
+  if (!has_focus_ || graphics_.is_null())
+    return;
+  // Gaining focus ends throttling, so a pending paint or requested frame
+  // can happen now.
+  if (aggregator_.HasPendingUpdate())
+    EnsureCallbackPending();
+  if (frame_requested_ && !in_will_paint_frame_ && !flush_pending_)
+    ScheduleFrame();
+}
+
+void PaintManager::SetFullscreenMode(bool fullscreen) {
+  if (fullscreen == fullscreen_mode_)
+    return;
+  fullscreen_mode_ = fullscreen;
+  ResetBuffers();
+  if (!graphics_.is_null())
+    Invalidate();
+}
+
+void PaintManager::set_buffer_count(int count) {
+  count = std::min(std::max(count, 2), 3);
+  if (count == buffer_count_)
+    return;
+  buffer_count_ = count;
+  ResetBuffers();
+}
+
+Rect PaintManager::GetVisibleRect() const {
+  Rect device(graphics_.size());
+  return has_clip_ ? device.Intersect(clip_) : device;
+}
+
 void PaintManager::Invalidate() {
   // You must call SetDevice before using.
   PP_DCHECK(!graphics_.is_null());
 
-  EnsureCallbackPending();
-  aggregator_.InvalidateRect(Rect(graphics_.size()));
+  AddDamage(Rect(graphics_.size()));
 }
 
 void PaintManager::InvalidateRect(const Rect& rect) {
@@ -81,23 +185,38 @@ void PaintManager::InvalidateRect(const Rect& rect) {
   if (clipped_rect.IsEmpty())
     return;  // Nothing to do.
 
-  EnsureCallbackPending();
-  aggregator_.InvalidateRect(clipped_rect);
+  AddDamage(clipped_rect);
 }
 
 void PaintManager::ScrollRect(const Rect& clip_rect, const Point& amount) {
   // You must call SetDevice before using.
   PP_DCHECK(!graphics_.is_null());
 
+  // Scrolling what can't be seen is the same as repainting it once it can.
+  if (!clip_rect.Intersects(GetVisibleRect())) {
+    AddDamage(clip_rect.Intersect(Rect(graphics_.size())));
+    return;
+  }
+
   EnsureCallbackPending();
   aggregator_.ScrollRect(clip_rect, amount);
+
+  // Damage that wasn't painted moves with the pixels, possibly into view.
+  Rect scrolled_damage = hidden_damage_.Intersect(clip_rect);
+  if (!scrolled_damage.IsEmpty()) {
+    scrolled_damage.Offset(amount);
+    hidden_damage_ =
+        hidden_damage_.Union(scrolled_damage.Intersect(clip_rect));
+    ExposeHiddenDamage();
+  }
 }
 
 void PaintManager::EnsureCallbackPending() {
   // The best way for us to do the next update is to get a notification that
   // a previous one has completed. So if we're already waiting for one, we
-  // don't have to do anything differently now.
-  if (flush_pending_)
+  // don't have to do anything differently now. The same goes for damage
+  // added by the frame listener, which is painted right after it returns.
+  if (flush_pending_ || in_will_paint_frame_)
     return;
 
   // If no flush is pending, we need to do a manual call to get back to the
@@ -105,6 +224,16 @@ void PaintManager::EnsureCallbackPending() {
   if (manual_callback_pending_)
     return;
 
+  // Without focus the paint may have to wait, or not happen until focus
+  // comes back.
+  int32_t delay = GetThrottleDelay();
+  if (delay < 0)
+    return;
+  if (delay > 0) {
+    ScheduleDelayedCallback(delay);
+    return;
+  }
+
   Module::Get()->core()->CallOnMainThread(
       0,
       callback_factory_.NewCallback(&PaintManager::OnManualCallbackComplete),
@@ -112,6 +241,101 @@ void PaintManager::EnsureCallbackPending() {
   manual_callback_pending_ = true;
 }
 
+void PaintManager::AddDamage(const Rect& rect) {
+  Rect visible_rect = GetVisibleRect();
+  Rect visible_damage = rect.Intersect(visible_rect);
+  // Subtract() only removes what it can while keeping a rect, so this may
+  // keep some visible damage too; that just gets painted again later.
+  hidden_damage_ = hidden_damage_.Union(rect.Subtract(visible_rect));
+  if (visible_damage.IsEmpty())
+    return;
+
+  EnsureCallbackPending();
+  aggregator_.InvalidateRect(visible_damage);
+}
+
+void PaintManager::ExposeHiddenDamage() {
+  Rect exposed = hidden_damage_.Intersect(GetVisibleRect());
+  if (exposed.IsEmpty())
+    return;
+  hidden_damage_ = hidden_damage_.Subtract(exposed);
+
+  EnsureCallbackPending();
+  aggregator_.InvalidateRect(exposed);
+}
+
+int32_t PaintManager::GetThrottleDelay() const {
+  if (has_focus_ || unfocused_paint_interval_ == 0)
+    return 0;
+  if (unfocused_paint_interval_ < 0)
+    return -1;
+  PP_TimeTicks elapsed_ms =
+      (Module::Get()->core()->GetTimeTicks() - last_paint_time_) * 1000;
+  if (elapsed_ms >= unfocused_paint_interval_)
+    return 0;
+  return static_cast<int32_t>(ceil(unfocused_paint_interval_ - elapsed_ms));
+}
+
+void PaintManager::ScheduleDelayedCallback(int32_t delay) {
+  if (delayed_callback_pending_)
+    return;
+  Module::Get()->core()->CallOnMainThread(
+      delay,
+      callback_factory_.NewCallback(&PaintManager::OnDelayedCallbackComplete),
+      0);
+  delayed_callback_pending_ = true;
+}
+
+void PaintManager::ScheduleFrame() {
+  if (manual_callback_pending_)
+    return;
+  int32_t delay = GetThrottleDelay();
+  if (delay < 0)
+    return;
+  // Without a flush to wait for, frames that only animate would otherwise
+  // follow each other as fast as the message loop goes.
+  PP_TimeTicks elapsed_ms =
+      (Module::Get()->core()->GetTimeTicks() - last_frame_time_) * 1000;
+  if (elapsed_ms < kFrameIntervalMs) {
+    delay = std::max(delay,
+                     static_cast<int32_t>(ceil(kFrameIntervalMs - elapsed_ms)));
+  }
+  if (delay > 0)
+    ScheduleDelayedCallback(delay);
+  else
+    EnsureCallbackPending();
+}
+
+void PaintManager::PaintIfPending() {
+  // A pending flush will get here again when it completes.
+  if ((!aggregator_.HasPendingUpdate() && !frame_requested_) || flush_pending_)
+    return;
+  if (GetThrottleDelay() != 0) {
+    EnsureCallbackPending();
+    return;
+  }
+  DoFrame();
+}
+
+void PaintManager::DoFrame() {
+  PP_TimeTicks now = Module::Get()->core()->GetTimeTicks();
+  last_frame_time_ = now;
+  frame_requested_ = false;
+  if (frame_listener_) {
+    in_will_paint_frame_ = true;
+    frame_listener_->WillPaintFrame(now);
+    in_will_paint_frame_ = false;
+  }
+
+  if (aggregator_.HasPendingUpdate())
+    DoPaint();
+
+  // A frame the listener requested starts when the flush completes, or
+  // needs a callback of its own if nothing was flushed.
+  if (frame_requested_ && !flush_pending_)
+    ScheduleFrame();
+}
+
 void PaintManager::DoPaint() {
   PP_DCHECK(aggregator_.HasPendingUpdate());
 
@@ -121,12 +345,42 @@ void PaintManager::DoPaint() {
   PaintAggregator::PaintUpdate update = aggregator_.GetPendingUpdate();
   aggregator_.ClearPendingUpdate();
 
-  // Apply any scroll before asking the client to paint.
-  if (update.has_scroll)
+  // Apply any scroll before asking the client to paint. The buffers of
+  // fullscreen mode don't scroll; the area is painted again instead.
+  if (update.has_scroll && !fullscreen_mode_)
     graphics_.Scroll(update.scroll_rect, update.scroll_delta);
 
-  if (!client_->OnPaint(graphics_, update.paint_rects, update.paint_bounds))
+  // Only paint what can be seen. The clip may have shrunk since the damage
+  // was added, and the area exposed by a scroll isn't clipped by the
+  // aggregator.
+  Rect visible_rect = GetVisibleRect();
+  std::vector<Rect> paint_rects;
+  Rect paint_bounds;
+  for (size_t i = 0; i < update.paint_rects.size(); i++) {
+    const Rect& rect = update.paint_rects[i];
+    hidden_damage_ = hidden_damage_.Union(rect.Subtract(visible_rect));
+    Rect visible_damage = rect.Intersect(visible_rect);
+    if (!visible_damage.IsEmpty()) {
+      paint_rects.push_back(visible_damage);
+      paint_bounds = paint_bounds.Union(visible_damage);
+    }
+  }
+
+  if (fullscreen_mode_) {
+    if (update.has_scroll) {
+      Rect scrolled = update.scroll_rect.Intersect(visible_rect);
+      if (!scrolled.IsEmpty())
+        paint_rects.push_back(scrolled);
+    }
+    if (!PaintBuffer(paint_rects))
+      return;
+  } else if (paint_rects.empty()) {
+    // A scroll still has to be flushed to show.
+    if (!update.has_scroll)
+      return;
+  } else if (!client_->OnPaint(graphics_, paint_rects, paint_bounds)) {
     return;  // Nothing was painted, don't schedule a flush.
+  }
 
   int32_t result = graphics_.Flush(
       callback_factory_.NewCallback(&PaintManager::OnFlushComplete));
@@ -142,6 +396,7 @@ void PaintManager::DoPaint() {
   // re-use devices in this way.
   PP_DCHECK(result != PP_ERROR_INPROGRESS);
 
+  last_paint_time_ = Module::Get()->core()->GetTimeTicks();
   if (result == PP_ERROR_WOULDBLOCK) {
     flush_pending_ = true;
   } else {
@@ -149,14 +404,75 @@ void PaintManager::DoPaint() {
   }
 }
 
+bool PaintManager::PaintBuffer(const std::vector<Rect>& damage) {
+  if (damage.empty())
+    return false;
+
+  // Buffers are added until there are enough, and then the one presented
+  // longest ago is reused.
+  if (static_cast<int>(buffers_.size()) < buffer_count_) {
+    Buffer buffer;
+    buffer.image = ImageData(ImageData::GetNativeImageDataFormat(),
+                             graphics_.size(), false);
+    if (buffer.image.is_null())
+      return false;
+    buffer.presented_frame = 0;
+    buffers_.push_back(buffer);
+  }
+  Buffer* buffer = &buffers_[0];
+  for (size_t i = 1; i < buffers_.size(); i++) {
+    if (buffers_[i].presented_frame < buffer->presented_frame)
+      buffer = &buffers_[i];
+  }
+
+  // The buffer misses the damage of the frames presented since it was, on
+  // top of this frame's.
+  std::vector<Rect> paint_rects;
+  size_t behind = frame_number_ - buffer->presented_frame;
+  if (buffer->presented_frame == 0 || behind > damage_history_.size()) {
+    paint_rects.push_back(Rect(graphics_.size()));
+  } else {
+    paint_rects = damage;
+    for (size_t i = damage_history_.size() - behind;
+         i < damage_history_.size(); i++) {
+      paint_rects.insert(paint_rects.end(), damage_history_[i].begin(),
+                         damage_history_[i].end());
+    }
+  }
+  Rect paint_bounds;
+  for (size_t i = 0; i < paint_rects.size(); i++)
+    paint_bounds = paint_bounds.Union(paint_rects[i]);
+  if (paint_rects.size() > kMaxBufferPaintRects)
+    paint_rects.assign(1, paint_bounds);
+
+  if (!client_->OnPaintBuffer(buffer->image, paint_rects, paint_bounds))
+    return false;
+  // ReplaceContents clears the ImageData it's given; the buffer keeps its
+  // own reference to paint into again once the device has moved on to the
+  // next one.
+  ImageData presented(buffer->image);
+  graphics_.ReplaceContents(&presented);
+
+  buffer->presented_frame = ++frame_number_;
+  damage_history_.push_back(damage);
+  while (damage_history_.size() > static_cast<size_t>(buffer_count_ - 1))
+    damage_history_.pop_front();
+  return true;
+}
+
+void PaintManager::ResetBuffers() {
+  buffers_.clear();
+  damage_history_.clear();
+  frame_number_ = 0;
+}
+
 void PaintManager::OnFlushComplete(int32_t) {
   PP_DCHECK(flush_pending_);
   flush_pending_ = false;
 
   // If more paints were enqueued while we were waiting for the flush to
   // complete, execute them now.
-  if (aggregator_.HasPendingUpdate())
-    DoPaint();
+  PaintIfPending();
 }
 
 void PaintManager::OnManualCallbackComplete(int32_t) {
@@ -167,8 +483,13 @@ void PaintManager::OnManualCallbackComplete(int32_t) {
   // invalid regions. Even though we only schedule this callback when something
   // is pending, a Flush callback could have come in before this callback was
   // executed and that could have cleared the queue.
-  if (aggregator_.HasPendingUpdate())
-    DoPaint();
+  PaintIfPending();
+}
+
+void PaintManager::OnDelayedCallbackComplete(int32_t) {
+  PP_DCHECK(delayed_callback_pending_);
+  delayed_callback_pending_ = false;
+  PaintIfPending();
 }
 
 }  // namespace pp
@@ -5,18 +5,21 @@
 #ifndef PPAPI_CPP_PAINT_MANAGER_H_
 #define PPAPI_CPP_PAINT_MANAGER_H_
 
+#include <deque>
 #include <vector>
 
+#include "ppapi/c/pp_time.h"
 #include "ppapi/cpp/completion_callback.h"
 #include "ppapi/cpp/graphics_2d.h"
+#include "ppapi/cpp/image_data.h"
 #include "ppapi/cpp/paint_aggregator.h"
+#include "ppapi/cpp/rect.h"
 
 namespace pp {
 
 class Graphics2D;
 class Instance;
 class Point;
-class Rect;
 
 // This class converts the "plugin push" model of painting in PPAPI to a paint
 // request at a later time. Usage is that you call Invalidate and Scroll, and
@@ -26,6 +29,21 @@ class Rect;
 // This class is basically a PaintAggregator that groups updates, plus
 // management of callbacks for scheduling paints.
 //
+// If you tell it which part of the plugin is visible, with SetView or
+// SetClip, only that part is painted. Damage to the rest is kept until it
+// scrolls into view, and nothing is painted at all while the plugin is
+// completely hidden. If you tell it about focus changes with SetFocus,
+// painting is also slowed down while the plugin doesn't have focus; see
+// set_unfocused_paint_interval.
+//
+// In fullscreen mode (SetFullscreenMode), the client paints whole frames into
+// a few full size ImageData buffers that are handed to the device with
+// ReplaceContents, rather than copying the damage into the device with
+// PaintImageData, which at fullscreen sizes costs as much as painting it.
+// The buffers are reused in turn, and each is only repainted where it's out
+// of date: the damage of this frame and of the frames presented since it
+// was last.
+//
 // Typical usage:
 //
 //  class MyClass : public pp::Instance, public PaintManager::Client {
@@ -34,8 +52,12 @@ class Rect;
 //      paint_manager_.Initialize(this, this, false);
 //    }
 //
-//    void ViewChanged(const pp::Rect& position, const pp::Rect& clip) {
-//      paint_manager_.SetSize(position.size());
+//    void DidChangeView(const pp::Rect& position, const pp::Rect& clip) {
+//      paint_manager_.SetView(position, clip);
+//    }
+//
+//    void DidChangeFocus(bool has_focus) {
+//      paint_manager_.SetFocus(has_focus);
 //    }
 //
 //    void DoSomething() {
@@ -85,11 +107,39 @@ class PaintManager {
                          const std::vector<Rect>& paint_rects,
                          const Rect& paint_bounds) = 0;
 
+    // Paints the given area into |buffer|, the size of the device, in
+    // fullscreen mode. Returns true if anything was painted. Called instead
+    // of OnPaint; clients that use fullscreen mode must override it.
+    //
+    // |buffer| holds the frame presented some frames ago, and the rects
+    // bring it up to date: they can be more than was invalidated, up to the
+    // whole device for a new buffer. Scrolls aren't applied to the buffers,
+    // so the area of a scroll is part of the rects too. Don't keep |buffer|
+    // around; the browser uses it once presented.
+    virtual bool OnPaintBuffer(ImageData& /* buffer */,
+                               const std::vector<Rect>& /* paint_rects */,
+                               const Rect& /* paint_bounds */) {
+      return false;
+    }
+
    protected:
     // You shouldn't be doing deleting through this interface.
     virtual ~Client() {}
   };
 
+  // Gets told when a frame starts, to drive animations like smooth
+  // scrolling off the same schedule as the painting.
+  class FrameListener {
+   public:
+    // Called at the start of each frame, before the pending damage is taken.
+    // Scrolls and invalidations made from here are painted in this frame.
+    // Call RequestFrame to be called again for the next one.
+    virtual void WillPaintFrame(PP_TimeTicks frame_time) = 0;
+
+   protected:
+    virtual ~FrameListener() {}
+  };
+
   // If you use this version of the constructor, you must call Initialize()
   // below.
   PaintManager();
@@ -135,6 +185,26 @@ class PaintManager {
     aggregator_.set_max_paint_rects(max_rects);
   }
 
+  // The least time between the starts of two paints while the plugin doesn't
+  // have focus, in milliseconds. Damage is aggregated in between. 0 paints
+  // as fast as when focused, and a negative value doesn't paint at all until
+  // the plugin gets focus back. Defaults to 250.
+  void set_unfocused_paint_interval(int32_t milliseconds) {
+    unfocused_paint_interval_ = milliseconds;
+  }
+
+  // Sets the frame listener, or NULL for none. The listener is a non-owning
+  // pointer and must remain valid while set.
+  void set_frame_listener(FrameListener* listener) {
+    frame_listener_ = listener;
+  }
+  FrameListener* frame_listener() const { return frame_listener_; }
+
+  // Asks for a frame even if nothing is invalid, so that the frame listener
+  // is called. Frames follow each other as Flush completes, or about 60
+  // times a second when nothing was painted.
+  void RequestFrame();
+
   // Sets the size of the plugin. If the size is the same as the previous call,
   // this will be a NOP. If the size has changed, a new device will be
   // allocated to the given size and a paint to that device will be scheduled.
@@ -146,6 +216,36 @@ class PaintManager {
   // position changed).
   void SetSize(const Size& new_size);
 
+  // Sets the visible part of the plugin, in plugin coordinates: the |clip|
+  // given to DidChangeView. Painting is limited to it, and damage outside it
+  // is painted when it becomes visible. An empty clip, as for a plugin that
+  // is scrolled out of view, stops painting. Until this is called the whole
+  // plugin is taken to be visible.
+  void SetClip(const Rect& clip);
+
+  // Calls SetSize and SetClip. This is intended to be called from
+  // DidChangeView with its arguments.
+  void SetView(const Rect& position, const Rect& clip);
+
+  // Tells the paint manager whether the plugin has focus, normally from
+  // DidChangeFocus. Until this is called the plugin is taken to have focus,
+  // so that plugins that don't report it paint at full rate.
+  void SetFocus(bool has_focus);
+
+  // Switches fullscreen mode on or off; see the class comment. Normally
+  // called along with Fullscreen_Dev::SetFullscreen. Switching repaints the
+  // whole plugin.
+  void SetFullscreenMode(bool fullscreen);
+  bool is_fullscreen_mode() const { return fullscreen_mode_; }
+
+  // How many buffers fullscreen mode uses, 2 or 3. Defaults to 2. With 3,
+  // the client paints into a buffer the browser is least likely to still
+  // hold, at the cost of repainting more of it each frame.
+  void set_buffer_count(int count);
+
+  // The part of the device that is painted: all of it, limited to the clip.
+  Rect GetVisibleRect() const;
+
   // Provides access to the underlying device in case you need it. Note: if
   // you call Flush on this device the paint manager will get very confused,
   // don't do this!
@@ -155,7 +255,7 @@ class PaintManager {
   // Invalidate the entire plugin.
   void Invalidate();
 
-  // Invalidate the given rect.
+  // Invalidate the given rect. Only the visible part of it is painted now.
   void InvalidateRect(const Rect& rect);
 
   // The given rect should be scrolled by the given amounts.
@@ -172,9 +272,44 @@ class PaintManager {
   // to the message loop via ExecuteOnMainThread.
   void EnsureCallbackPending();
 
+  // Adds |rect| of the device to the damage: the visible part to the
+  // aggregator, the rest to |hidden_damage_|.
+  void AddDamage(const Rect& rect);
+
+  // Moves the part of |hidden_damage_| that is now visible to the aggregator.
+  void ExposeHiddenDamage();
+
+  // Returns how long until painting is allowed again, in milliseconds, if the
+  // plugin doesn't have focus. Returns a negative number if painting is
+  // paused.
+  int32_t GetThrottleDelay() const;
+
+  // Schedules OnDelayedCallbackComplete in |delay| milliseconds, unless it's
+  // already pending.
+  void ScheduleDelayedCallback(int32_t delay);
+
+  // Schedules a requested frame that no flush will start, no sooner than a
+  // frame interval after the last one.
+  void ScheduleFrame();
+
+  // Starts a frame now if there is something to paint or a frame was
+  // requested, and painting isn't throttled; otherwise schedules it.
+  void PaintIfPending();
+
+  // Calls the frame listener, then paints.
+  void DoFrame();
+
   // Does the client paint and executes a Flush if necessary.
   void DoPaint();
 
+  // Does the client paint into a buffer and presents it with
+  // ReplaceContents, in fullscreen mode. |damage| is the visible damage of
+  // this frame. Returns false if nothing was painted.
+  bool PaintBuffer(const std::vector<Rect>& damage);
+
+  // Drops the buffers and what they were painted with.
+  void ResetBuffers();
+
   // Callback for asynchronous completion of Flush.
   void OnFlushComplete(int32_t);
 
@@ -182,6 +317,10 @@ class PaintManager {
   // pending.
   void OnManualCallbackComplete(int32_t);
 
+  // Callback for a paint that was delayed because the plugin doesn't have
+  // focus, or for a requested frame.
+  void OnDelayedCallbackComplete(int32_t);
+
   Instance* instance_;
 
   // Non-owning pointer. See the constructor.
@@ -200,6 +339,51 @@ class PaintManager {
   // See comment for EnsureCallbackPending for more on how these work.
   bool manual_callback_pending_;
   bool flush_pending_;
+  bool delayed_callback_pending_;
+
+  // The clip from SetClip, if it was called.
+  bool has_clip_;
+  Rect clip_;
+
+  // Covers the damage that wasn't painted because it wasn't visible.
+  Rect hidden_damage_;
+
+  bool has_focus_;
+  int32_t unfocused_paint_interval_;
+
+  // When the last Flush was started, in time ticks.
+  PP_TimeTicks last_paint_time_;
+
+  // Non-owning pointer, may be NULL. See set_frame_listener.
+  FrameListener* frame_listener_;
+
+  // RequestFrame was called since the last frame started.
+  bool frame_requested_;
+
+  // The frame listener is being called.
+  bool in_will_paint_frame_;
+
+  // When the last frame started, in time ticks.
+  PP_TimeTicks last_frame_time_;
+
+  // A buffer of fullscreen mode.
+  struct Buffer {
+    ImageData image;
+
+    // The number of the frame it was last presented in, or 0 if never.
+    uint32_t presented_frame;
+  };
+
+  bool fullscreen_mode_;
+  int buffer_count_;
+  std::vector<Buffer> buffers_;
+
+  // The number of the last frame presented in fullscreen mode.
+  uint32_t frame_number_;
+
+  // The damage of the last frames presented, the most recent last, one
+  // fewer than the buffers: what a buffer can be behind by.
+  std::deque<std::vector<Rect> > damage_history_;
 };
 
 }  // namespace pp
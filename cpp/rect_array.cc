@@ -0,0 +1,427 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/rect_array.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace pp {
+
+namespace {
+
+const int32_t kMinInt32 = std::numeric_limits<int32_t>::min();
+const int32_t kMaxInt32 = std::numeric_limits<int32_t>::max();
+
+// The edges of the rects, as passed to the kernels below. Each kernel has a
+// scalar version for a range of the rects, which does the whole job without
+// SSE2 and the few rects left over with it.
+struct Edges {
+  const int32_t* left;
+  const int32_t* top;
+  const int32_t* right;
+  const int32_t* bottom;
+};
+
+// Grows |bounds| (left, top, right, bottom) to take in the rects of
+// [begin, end) that aren't empty. Empty means Rect::IsEmpty: no width and no
+// height.
+void UnionRange(const Edges& e, size_t begin, size_t end, int32_t* bounds) {
+  for (size_t i = begin; i < end; i++) {
+    if (e.left[i] == e.right[i] && e.top[i] == e.bottom[i])
+      continue;
+    bounds[0] = std::min(bounds[0], e.left[i]);
+    bounds[1] = std::min(bounds[1], e.top[i]);
+    bounds[2] = std::max(bounds[2], e.right[i]);
+    bounds[3] = std::max(bounds[3], e.bottom[i]);
+  }
+}
+
+void IntersectRange(int32_t* left, int32_t* top, int32_t* right,
+                    int32_t* bottom, size_t begin, size_t end,
+                    const Rect& clip) {
+  for (size_t i = begin; i < end; i++) {
+    int32_t l = std::max(left[i], clip.x());
+    int32_t t = std::max(top[i], clip.y());
+    int32_t r = std::min(right[i], clip.right());
+    int32_t b = std::min(bottom[i], clip.bottom());
+    if (l >= r || t >= b)
+      l = t = r = b = 0;
+    left[i] = l;
+    top[i] = t;
+    right[i] = r;
+    bottom[i] = b;
+  }
+}
+
+size_t FindContainingInRange(const Edges& e, size_t begin, size_t end,
+                             const Point& point) {
+  for (size_t i = begin; i < end; i++) {
+    if (point.x() >= e.left[i] && point.x() < e.right[i] &&
+        point.y() >= e.top[i] && point.y() < e.bottom[i])
+      return i;
+  }
+  return end;
+}
+
+// Rect::Contains, Rect::Intersects or Rect::SharesEdgeWith, written in terms
+// of the edges.
+size_t FindTouchingInRange(const Edges& e, size_t begin, size_t end,
+                           const Rect& rect) {
+  int32_t rl = rect.x();
+  int32_t rt = rect.y();
+  int32_t rr = rect.right();
+  int32_t rb = rect.bottom();
+  for (size_t i = begin; i < end; i++) {
+    int32_t l = e.left[i];
+    int32_t t = e.top[i];
+    int32_t r = e.right[i];
+    int32_t b = e.bottom[i];
+    bool contains = l <= rl && r >= rr && t <= rt && b >= rb;
+    bool intersects = r > rl && rr > l && b > rt && rb > t;
+    bool shares_edge =
+        (t == rt && b == rb && (l == rr || r == rl)) ||
+        (l == rl && r == rr && (t == rb || b == rt));
+    if (contains || intersects || shares_edge)
+      return i;
+  }
+  return end;
+}
+
+// The sum of the areas of the rects of [begin, end) that |outer| contains,
+// or of all of them if |outer| is NULL.
+int64_t AreaSumRange(const Edges& e, size_t begin, size_t end,
+                     const Rect* outer) {
+  int64_t sum = 0;
+  for (size_t i = begin; i < end; i++) {
+    if (outer &&
+        !(e.left[i] >= outer->x() && e.right[i] <= outer->right() &&
+          e.top[i] >= outer->y() && e.bottom[i] <= outer->bottom()))
+      continue;
+    sum += static_cast<int64_t>(e.right[i] - e.left[i]) *
+        (e.bottom[i] - e.top[i]);
+  }
+  return sum;
+}
+
+#if defined(__SSE2__)
+
+inline __m128i Load(const int32_t* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void Store(int32_t* p, __m128i v) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+// Picks |a| where |mask| is set and |b| elsewhere.
+inline __m128i Select(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// SSE2 has no 32-bit min and max.
+inline __m128i Min32(__m128i a, __m128i b) {
+  return Select(_mm_cmplt_epi32(a, b), a, b);
+}
+
+inline __m128i Max32(__m128i a, __m128i b) {
+  return Select(_mm_cmpgt_epi32(a, b), a, b);
+}
+
+inline int32_t MinLane(__m128i v) {
+  int32_t lanes[4];
+  Store(lanes, v);
+  return std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+}
+
+inline int32_t MaxLane(__m128i v) {
+  int32_t lanes[4];
+  Store(lanes, v);
+  return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+}
+
+// The first of four lanes set in |mask|, or 4.
+inline size_t FirstLane(__m128i mask) {
+  int bits = _mm_movemask_ps(_mm_castsi128_ps(mask));
+  for (size_t lane = 0; lane < 4; lane++) {
+    if (bits & (1 << lane))
+      return lane;
+  }
+  return 4;
+}
+
+// Sums the products of the lanes of |a| and |b|, which must not be
+// negative, into the two 64-bit lanes of |sum|.
+inline __m128i AddProducts(__m128i sum, __m128i a, __m128i b) {
+  sum = _mm_add_epi64(sum, _mm_mul_epu32(a, b));
+  return _mm_add_epi64(sum, _mm_mul_epu32(_mm_srli_epi64(a, 32),
+                                          _mm_srli_epi64(b, 32)));
+}
+
+inline int64_t SumLanes64(__m128i sum) {
+  int64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+  return lanes[0] + lanes[1];
+}
+
+void UnionRects(const Edges& e, size_t count, int32_t* bounds) {
+  __m128i min_left = _mm_set1_epi32(kMaxInt32);
+  __m128i min_top = min_left;
+  __m128i max_right = _mm_set1_epi32(kMinInt32);
+  __m128i max_bottom = max_right;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i l = Load(e.left + i);
+    __m128i t = Load(e.top + i);
+    __m128i r = Load(e.right + i);
+    __m128i b = Load(e.bottom + i);
+    __m128i empty = _mm_and_si128(_mm_cmpeq_epi32(l, r),
+                                  _mm_cmpeq_epi32(t, b));
+    // Empty rects are replaced by ones that change nothing.
+    min_left = Min32(min_left, Select(empty, _mm_set1_epi32(kMaxInt32), l));
+    min_top = Min32(min_top, Select(empty, _mm_set1_epi32(kMaxInt32), t));
+    max_right = Max32(max_right, Select(empty, _mm_set1_epi32(kMinInt32), r));
+    max_bottom = Max32(max_bottom,
+                       Select(empty, _mm_set1_epi32(kMinInt32), b));
+  }
+  bounds[0] = std::min(bounds[0], MinLane(min_left));
+  bounds[1] = std::min(bounds[1], MinLane(min_top));
+  bounds[2] = std::max(bounds[2], MaxLane(max_right));
+  bounds[3] = std::max(bounds[3], MaxLane(max_bottom));
+  UnionRange(e, i, count, bounds);
+}
+
+void IntersectRects(int32_t* left, int32_t* top, int32_t* right,
+                    int32_t* bottom, size_t count, const Rect& clip) {
+  const __m128i clip_left = _mm_set1_epi32(clip.x());
+  const __m128i clip_top = _mm_set1_epi32(clip.y());
+  const __m128i clip_right = _mm_set1_epi32(clip.right());
+  const __m128i clip_bottom = _mm_set1_epi32(clip.bottom());
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i l = Max32(Load(left + i), clip_left);
+    __m128i t = Max32(Load(top + i), clip_top);
+    __m128i r = Min32(Load(right + i), clip_right);
+    __m128i b = Min32(Load(bottom + i), clip_bottom);
+    // Zeroes the rects that don't intersect |clip|.
+    __m128i keep = _mm_and_si128(_mm_cmplt_epi32(l, r),
+                                 _mm_cmplt_epi32(t, b));
+    Store(left + i, _mm_and_si128(keep, l));
+    Store(top + i, _mm_and_si128(keep, t));
+    Store(right + i, _mm_and_si128(keep, r));
+    Store(bottom + i, _mm_and_si128(keep, b));
+  }
+  IntersectRange(left, top, right, bottom, i, count, clip);
+}
+
+size_t FindRectContaining(const Edges& e,
+                          size_t count,
+                          const Point& point) {
+  const __m128i x = _mm_set1_epi32(point.x());
+  const __m128i y = _mm_set1_epi32(point.y());
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    // left <= x < right and top <= y < bottom.
+    __m128i inside_x = _mm_andnot_si128(_mm_cmpgt_epi32(Load(e.left + i), x),
+                                        _mm_cmpgt_epi32(Load(e.right + i), x));
+    __m128i inside_y = _mm_andnot_si128(_mm_cmpgt_epi32(Load(e.top + i), y),
+                                        _mm_cmpgt_epi32(Load(e.bottom + i), y));
+    size_t lane = FirstLane(_mm_and_si128(inside_x, inside_y));
+    if (lane < 4)
+      return i + lane;
+  }
+  return FindContainingInRange(e, i, count, point);
+}
+
+size_t FindRectTouching(const Edges& e, size_t count, const Rect& rect) {
+  const __m128i rl = _mm_set1_epi32(rect.x());
+  const __m128i rt = _mm_set1_epi32(rect.y());
+  const __m128i rr = _mm_set1_epi32(rect.right());
+  const __m128i rb = _mm_set1_epi32(rect.bottom());
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i l = Load(e.left + i);
+    __m128i t = Load(e.top + i);
+    __m128i r = Load(e.right + i);
+    __m128i b = Load(e.bottom + i);
+    // Nothing of |rect| is outside: !(l > rl || rr > r || t > rt || rb > b).
+    __m128i outside = _mm_or_si128(
+        _mm_or_si128(_mm_cmpgt_epi32(l, rl), _mm_cmpgt_epi32(rr, r)),
+        _mm_or_si128(_mm_cmpgt_epi32(t, rt), _mm_cmpgt_epi32(rb, b)));
+    __m128i contains = _mm_andnot_si128(outside, _mm_set1_epi32(-1));
+    __m128i intersects = _mm_and_si128(
+        _mm_and_si128(_mm_cmpgt_epi32(r, rl), _mm_cmpgt_epi32(rr, l)),
+        _mm_and_si128(_mm_cmpgt_epi32(b, rt), _mm_cmpgt_epi32(rb, t)));
+    __m128i side_by_side = _mm_and_si128(
+        _mm_and_si128(_mm_cmpeq_epi32(t, rt), _mm_cmpeq_epi32(b, rb)),
+        _mm_or_si128(_mm_cmpeq_epi32(l, rr), _mm_cmpeq_epi32(r, rl)));
+    __m128i stacked = _mm_and_si128(
+        _mm_and_si128(_mm_cmpeq_epi32(l, rl), _mm_cmpeq_epi32(r, rr)),
+        _mm_or_si128(_mm_cmpeq_epi32(t, rb), _mm_cmpeq_epi32(b, rt)));
+    size_t lane = FirstLane(_mm_or_si128(
+        _mm_or_si128(contains, intersects),
+        _mm_or_si128(side_by_side, stacked)));
+    if (lane < 4)
+      return i + lane;
+  }
+  return FindTouchingInRange(e, i, count, rect);
+}
+
+int64_t SumAreas(const Edges& e, size_t count, const Rect* outer) {
+  __m128i outer_left = _mm_set1_epi32(outer ? outer->x() : kMinInt32);
+  __m128i outer_top = _mm_set1_epi32(outer ? outer->y() : kMinInt32);
+  __m128i outer_right = _mm_set1_epi32(outer ? outer->right() : kMaxInt32);
+  __m128i outer_bottom = _mm_set1_epi32(outer ? outer->bottom() : kMaxInt32);
+  __m128i sum = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i l = Load(e.left + i);
+    __m128i t = Load(e.top + i);
+    __m128i r = Load(e.right + i);
+    __m128i b = Load(e.bottom + i);
+    __m128i outside = _mm_or_si128(
+        _mm_or_si128(_mm_cmpgt_epi32(outer_left, l),
+                     _mm_cmpgt_epi32(r, outer_right)),
+        _mm_or_si128(_mm_cmpgt_epi32(outer_top, t),
+                     _mm_cmpgt_epi32(b, outer_bottom)));
+    // Rects that aren't contained count as having no width.
+    __m128i width = _mm_andnot_si128(outside, _mm_sub_epi32(r, l));
+    sum = AddProducts(sum, width, _mm_sub_epi32(b, t));
+  }
+  return SumLanes64(sum) + AreaSumRange(e, i, count, outer);
+}
+
+#else
+
+void UnionRects(const Edges& e, size_t count, int32_t* bounds) {
+  UnionRange(e, 0, count, bounds);
+}
+
+void IntersectRects(int32_t* left, int32_t* top, int32_t* right,
+                    int32_t* bottom, size_t count, const Rect& clip) {
+  IntersectRange(left, top, right, bottom, 0, count, clip);
+}
+
+size_t FindRectContaining(const Edges& e,
+                          size_t count,
+                          const Point& point) {
+  return FindContainingInRange(e, 0, count, point);
+}
+
+size_t FindRectTouching(const Edges& e, size_t count, const Rect& rect) {
+  return FindTouchingInRange(e, 0, count, rect);
+}
+
+int64_t SumAreas(const Edges& e, size_t count, const Rect* outer) {
+  return AreaSumRange(e, 0, count, outer);
+}
+
+#endif  // defined(__SSE2__)
+
+}  // namespace
+
+RectArray::RectArray() {
+}
+
+RectArray::~RectArray() {
+}
+
+void RectArray::Set(size_t index, const Rect& rect) {
+  left_[index] = rect.x();
+  top_[index] = rect.y();
+  right_[index] = rect.right();
+  bottom_[index] = rect.bottom();
+}
+
+void RectArray::Append(const Rect& rect) {
+  left_.push_back(rect.x());
+  top_.push_back(rect.y());
+  right_.push_back(rect.right());
+  bottom_.push_back(rect.bottom());
+}
+
+void RectArray::Append(const std::vector<Rect>& rects) {
+  Reserve(size() + rects.size());
+  for (size_t i = 0; i < rects.size(); i++)
+    Append(rects[i]);
+}
+
+void RectArray::Erase(size_t index) {
+  left_.erase(left_.begin() + index);
+  top_.erase(top_.begin() + index);
+  right_.erase(right_.begin() + index);
+  bottom_.erase(bottom_.begin() + index);
+}
+
+void RectArray::Clear() {
+  left_.clear();
+  top_.clear();
+  right_.clear();
+  bottom_.clear();
+}
+
+void RectArray::Reserve(size_t count) {
+  left_.reserve(count);
+  top_.reserve(count);
+  right_.reserve(count);
+  bottom_.reserve(count);
+}
+
+void RectArray::CopyTo(std::vector<Rect>* rects) const {
+  rects->reserve(rects->size() + size());
+  for (size_t i = 0; i < size(); i++)
+    rects->push_back((*this)[i]);
+}
+
+Rect RectArray::UnionAll() const {
+  if (empty())
+    return Rect();
+  int32_t bounds[4] = { kMaxInt32, kMaxInt32, kMinInt32, kMinInt32 };
+  Edges edges = { &left_[0], &top_[0], &right_[0], &bottom_[0] };
+  UnionRects(edges, size(), bounds);
+  if (bounds[0] > bounds[2])
+    return Rect();  // All empty.
+  return Rect(bounds[0], bounds[1], bounds[2] - bounds[0],
+              bounds[3] - bounds[1]);
+}
+
+void RectArray::IntersectAll(const Rect& clip) {
+  if (empty())
+    return;
+  IntersectRects(&left_[0], &top_[0], &right_[0], &bottom_[0], size(), clip);
+}
+
+size_t RectArray::FindContaining(const Point& point) const {
+  if (empty())
+    return 0;
+  Edges edges = { &left_[0], &top_[0], &right_[0], &bottom_[0] };
+  return FindRectContaining(edges, size(), point);
+}
+
+size_t RectArray::FindTouching(const Rect& rect) const {
+  if (empty())
+    return 0;
+  Edges edges = { &left_[0], &top_[0], &right_[0], &bottom_[0] };
+  return FindRectTouching(edges, size(), rect);
+}
+
+int64_t RectArray::AreaSum() const {
+  if (empty())
+    return 0;
+  Edges edges = { &left_[0], &top_[0], &right_[0], &bottom_[0] };
+  return SumAreas(edges, size(), NULL);
+}
+
+int64_t RectArray::AreaSumContainedIn(const Rect& outer) const {
+  if (empty())
+    return 0;
+  Edges edges = { &left_[0], &top_[0], &right_[0], &bottom_[0] };
+  return SumAreas(edges, size(), &outer);
+}
+
+}  // namespace pp
@@ -0,0 +1,79 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_RECT_ARRAY_H_
+#define PPAPI_CPP_RECT_ARRAY_H_
+
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+
+namespace pp {
+
+// A list of rects stored as separate arrays of left, top, right and bottom
+// edges, for the loops that test one rect or point against many: the
+// batch operations below handle four rects at a time with SSE2 where it's
+// available, and give the same results as the Rect methods they're named
+// after applied one rect at a time.
+class RectArray {
+ public:
+  RectArray();
+  ~RectArray();
+
+  size_t size() const { return left_.size(); }
+  bool empty() const { return left_.empty(); }
+
+  Rect operator[](size_t index) const {
+    return Rect(left_[index], top_[index],
+                right_[index] - left_[index], bottom_[index] - top_[index]);
+  }
+  void Set(size_t index, const Rect& rect);
+
+  void Append(const Rect& rect);
+  void Append(const std::vector<Rect>& rects);
+
+  // Removes the rect at |index|, keeping the others in order.
+  void Erase(size_t index);
+
+  void Clear();
+  void Reserve(size_t count);
+
+  // Appends the rects to |rects|.
+  void CopyTo(std::vector<Rect>* rects) const;
+
+  // The Rect::Union of all the rects: the smallest rect containing all the
+  // ones that aren't empty.
+  Rect UnionAll() const;
+
+  // Replaces each rect with its Rect::Intersect with |clip|.
+  void IntersectAll(const Rect& clip);
+
+  // Returns the index of the first rect that contains |point|, or size() if
+  // none does.
+  size_t FindContaining(const Point& point) const;
+  bool ContainsAny(const Point& point) const {
+    return FindContaining(point) != size();
+  }
+
+  // Returns the index of the first rect that contains, intersects or shares
+  // an edge with |rect|, or size() if there's none: the first one that |rect|
+  // can be merged into.
+  size_t FindTouching(const Rect& rect) const;
+
+  // The sum of the areas of the rects, or of those that |outer| contains.
+  int64_t AreaSum() const;
+  int64_t AreaSumContainedIn(const Rect& outer) const;
+
+ private:
+  std::vector<int32_t> left_;
+  std::vector<int32_t> top_;
+  std::vector<int32_t> right_;
+  std::vector<int32_t> bottom_;
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_RECT_ARRAY_H_
@@ -0,0 +1,271 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/rect_index.h"
+
+#include <algorithm>
+
+#include "ppapi/cpp/logging.h"
+
+namespace pp {
+
+namespace {
+
+const int32_t kDefaultCellSize = 64;
+
+// Rects that would be listed in more cells than this are unbucketed.
+const int64_t kMaxCellsPerRect = 16;
+
+// A power of two.
+const size_t kInitialBucketCount = 64;
+
+// Removes |id| from |ids|, which don't keep an order.
+void RemoveId(std::vector<RectIndex::Id>* ids, RectIndex::Id id) {
+  std::vector<RectIndex::Id>::iterator found =
+      std::find(ids->begin(), ids->end(), id);
+  if (found == ids->end())
+    return;
+  *found = ids->back();
+  ids->pop_back();
+}
+
+}  // namespace
+
+RectIndex::RectIndex()
+    : cell_shift_(0),
+      count_(0),
+      next_order_(0),
+      buckets_(kInitialBucketCount),
+      query_mark_(0) {
+  while ((1 << cell_shift_) < kDefaultCellSize)
+    cell_shift_++;
+}
+
+RectIndex::RectIndex(int32_t cell_size)
+    : cell_shift_(0),
+      count_(0),
+      next_order_(0),
+      buckets_(kInitialBucketCount),
+      query_mark_(0) {
+  while (cell_shift_ < 30 && (1 << cell_shift_) < cell_size)
+    cell_shift_++;
+}
+
+RectIndex::~RectIndex() {
+}
+
+RectIndex::Id RectIndex::Insert(const Rect& rect) {
+  Id id;
+  if (free_ids_.empty()) {
+    id = static_cast<Id>(entries_.size());
+    entries_.push_back(Entry());
+  } else {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  }
+  Entry& entry = entries_[id];
+  entry.rect = rect;
+  entry.order = next_order_++;
+  entry.live = true;
+  entry.unbucketed = false;
+  entry.query_mark = 0;
+  count_++;
+  Link(id);
+  if (count_ > buckets_.size())
+    Grow();
+  return id;
+}
+
+void RectIndex::Move(Id id, const Rect& rect) {
+  PP_DCHECK(Contains(id));
+  Entry& entry = entries_[id];
+  int32_t old_cells[4];
+  int32_t new_cells[4];
+  if (!entry.unbucketed &&
+      GetCells(rect, &new_cells[0], &new_cells[1], &new_cells[2],
+               &new_cells[3]) &&
+      GetCells(entry.rect, &old_cells[0], &old_cells[1], &old_cells[2],
+               &old_cells[3]) &&
+      std::equal(old_cells, old_cells + 4, new_cells)) {
+    // Small moves within the same cells.
+    entry.rect = rect;
+    return;
+  }
+  Unlink(id);
+  entry.rect = rect;
+  Link(id);
+}
+
+void RectIndex::Remove(Id id) {
+  PP_DCHECK(Contains(id));
+  if (!Contains(id))
+    return;
+  Unlink(id);
+  entries_[id].live = false;
+  free_ids_.push_back(id);
+  count_--;
+}
+
+void RectIndex::Clear() {
+  entries_.clear();
+  free_ids_.clear();
+  count_ = 0;
+  next_order_ = 0;
+  std::vector<std::vector<Id> >(kInitialBucketCount).swap(buckets_);
+  unbucketed_.clear();
+}
+
+bool RectIndex::Contains(Id id) const {
+  return id < entries_.size() && entries_[id].live;
+}
+
+void RectIndex::QueryPoint(const Point& point, std::vector<Id>* ids) const {
+  // A point is in a single cell, where each rect is listed once.
+  const std::vector<Id>& bucket =
+      GetBucket(point.x() >> cell_shift_, point.y() >> cell_shift_);
+  for (size_t i = 0; i < bucket.size(); i++) {
+    if (entries_[bucket[i]].rect.Contains(point))
+      ids->push_back(bucket[i]);
+  }
+  for (size_t i = 0; i < unbucketed_.size(); i++) {
+    if (entries_[unbucketed_[i]].rect.Contains(point))
+      ids->push_back(unbucketed_[i]);
+  }
+}
+
+void RectIndex::QueryRect(const Rect& rect, std::vector<Id>* ids) const {
+  int32_t left, top, right, bottom;
+  if (!GetCells(rect, &left, &top, &right, &bottom) ||
+      static_cast<int64_t>(right - left + 1) * (bottom - top + 1) >
+          static_cast<int64_t>(buckets_.size())) {
+    // Rects without area can intersect rects they don't share a cell with,
+    // and large ones cover more cells than there are buckets; both look at
+    // every rect instead.
+    for (Id id = 0; id < entries_.size(); id++) {
+      if (entries_[id].live && entries_[id].rect.Intersects(rect))
+        ids->push_back(id);
+    }
+    return;
+  }
+
+  query_mark_++;
+  if (query_mark_ == 0) {
+    for (size_t i = 0; i < entries_.size(); i++)
+      entries_[i].query_mark = 0;
+    query_mark_ = 1;
+  }
+  for (int32_t cell_y = top; cell_y <= bottom; cell_y++) {
+    for (int32_t cell_x = left; cell_x <= right; cell_x++) {
+      const std::vector<Id>& bucket = GetBucket(cell_x, cell_y);
+      for (size_t i = 0; i < bucket.size(); i++) {
+        Id id = bucket[i];
+        if (entries_[id].rect.Intersects(rect) && Mark(id))
+          ids->push_back(id);
+      }
+    }
+  }
+  for (size_t i = 0; i < unbucketed_.size(); i++) {
+    if (entries_[unbucketed_[i]].rect.Intersects(rect))
+      ids->push_back(unbucketed_[i]);
+  }
+}
+
+bool RectIndex::HitTest(const Point& point, Id* id) const {
+  bool found = false;
+  const std::vector<Id>* lists[2] = {
+    &GetBucket(point.x() >> cell_shift_, point.y() >> cell_shift_),
+    &unbucketed_
+  };
+  for (size_t list = 0; list < 2; list++) {
+    const std::vector<Id>& ids = *lists[list];
+    for (size_t i = 0; i < ids.size(); i++) {
+      const Entry& entry = entries_[ids[i]];
+      if (entry.rect.Contains(point) &&
+          (!found || entry.order > entries_[*id].order)) {
+        *id = ids[i];
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+bool RectIndex::GetCells(const Rect& rect,
+                         int32_t* left,
+                         int32_t* top,
+                         int32_t* right,
+                         int32_t* bottom) const {
+  if (rect.width() <= 0 || rect.height() <= 0)
+    return false;
+  *left = rect.x() >> cell_shift_;
+  *top = rect.y() >> cell_shift_;
+  *right = (rect.right() - 1) >> cell_shift_;
+  *bottom = (rect.bottom() - 1) >> cell_shift_;
+  return true;
+}
+
+std::vector<RectIndex::Id>& RectIndex::GetBucket(int32_t cell_x,
+                                                 int32_t cell_y) {
+  uint32_t hash = static_cast<uint32_t>(cell_x) * 73856093u ^
+      static_cast<uint32_t>(cell_y) * 19349663u;
+  return buckets_[hash & (buckets_.size() - 1)];
+}
+
+const std::vector<RectIndex::Id>& RectIndex::GetBucket(int32_t cell_x,
+                                                       int32_t cell_y) const {
+  return const_cast<RectIndex*>(this)->GetBucket(cell_x, cell_y);
+}
+
+void RectIndex::Link(Id id) {
+  Entry& entry = entries_[id];
+  int32_t left, top, right, bottom;
+  if (!GetCells(entry.rect, &left, &top, &right, &bottom) ||
+      static_cast<int64_t>(right - left + 1) * (bottom - top + 1) >
+          kMaxCellsPerRect) {
+    entry.unbucketed = true;
+    unbucketed_.push_back(id);
+    return;
+  }
+  entry.unbucketed = false;
+  for (int32_t cell_y = top; cell_y <= bottom; cell_y++) {
+    for (int32_t cell_x = left; cell_x <= right; cell_x++) {
+      // Cells of the same rect can share a bucket.
+      std::vector<Id>& bucket = GetBucket(cell_x, cell_y);
+      if (std::find(bucket.begin(), bucket.end(), id) == bucket.end())
+        bucket.push_back(id);
+    }
+  }
+}
+
+void RectIndex::Unlink(Id id) {
+  Entry& entry = entries_[id];
+  if (entry.unbucketed) {
+    RemoveId(&unbucketed_, id);
+    return;
+  }
+  int32_t left, top, right, bottom;
+  GetCells(entry.rect, &left, &top, &right, &bottom);
+  for (int32_t cell_y = top; cell_y <= bottom; cell_y++) {
+    for (int32_t cell_x = left; cell_x <= right; cell_x++)
+      RemoveId(&GetBucket(cell_x, cell_y), id);
+  }
+}
+
+void RectIndex::Grow() {
+  std::vector<std::vector<Id> >(buckets_.size() * 2).swap(buckets_);
+  unbucketed_.clear();
+  for (Id id = 0; id < entries_.size(); id++) {
+    if (entries_[id].live)
+      Link(id);
+  }
+}
+
+bool RectIndex::Mark(Id id) const {
+  if (entries_[id].query_mark == query_mark_)
+    return false;
+  entries_[id].query_mark = query_mark_;
+  return true;
+}
+
+}  // namespace pp
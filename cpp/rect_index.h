@@ -0,0 +1,132 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_RECT_INDEX_H_
+#define PPAPI_CPP_RECT_INDEX_H_
+
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+
+namespace pp {
+
+// A spatial index of rects, for finding the few rects at a point or in an
+// area among many, such as the UI element under the mouse or the damage
+// next to a new invalidation.
+//
+// The plane is divided into square cells (64 pixels by default) and each
+// rect is listed in the cells it covers; the cells are hashed into a table
+// that grows with the number of rects. A query only looks at the rects of
+// the cells it covers. Rects that would be listed in many cells, and rects
+// without area, are kept in a list that every query goes through instead.
+//
+// Rects are identified by the id Insert returns. They're stacked in the
+// order they're inserted, the last one on top; Move doesn't change that.
+//
+//   pp::RectIndex::Id id = index.Insert(button->bounds());
+//   ...
+//   pp::RectIndex::Id hit;
+//   if (index.HitTest(event_position, &hit))
+//     widgets_by_id[hit]->HandleInputEvent(event);
+class RectIndex {
+ public:
+  typedef uint32_t Id;
+
+  RectIndex();
+
+  // |cell_size| is rounded up to a power of two.
+  explicit RectIndex(int32_t cell_size);
+
+  ~RectIndex();
+
+  // The number of rects.
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  // Adds |rect| on top of the others and returns its id. Ids of removed
+  // rects are reused.
+  Id Insert(const Rect& rect);
+
+  // Changes the rect of |id|.
+  void Move(Id id, const Rect& rect);
+
+  void Remove(Id id);
+  void Clear();
+
+  // Returns true if |id| is a rect of the index.
+  bool Contains(Id id) const;
+  const Rect& GetRect(Id id) const { return entries_[id].rect; }
+
+  // Returns true if |a| is stacked below |b|.
+  bool IsBelow(Id a, Id b) const {
+    return entries_[a].order < entries_[b].order;
+  }
+
+  // Appends the ids of the rects that contain |point| (Rect::Contains), or
+  // that intersect |rect| (Rect::Intersects), to |ids|. The ids come in no
+  // particular order.
+  void QueryPoint(const Point& point, std::vector<Id>* ids) const;
+  void QueryRect(const Rect& rect, std::vector<Id>* ids) const;
+
+  // Finds the topmost rect containing |point|. Returns false if there's
+  // none.
+  bool HitTest(const Point& point, Id* id) const;
+
+ private:
+  struct Entry {
+    Rect rect;
+
+    // Stacking order: higher is on top.
+    uint32_t order;
+
+    bool live;
+
+    // In |unbucketed_| rather than in the cells.
+    bool unbucketed;
+
+    // The query that last found the rect, so that a rect listed in several
+    // cells is only reported once.
+    mutable uint32_t query_mark;
+  };
+
+  // The cells |rect| covers, inclusive. Returns false if it should be
+  // unbucketed.
+  bool GetCells(const Rect& rect,
+                int32_t* left,
+                int32_t* top,
+                int32_t* right,
+                int32_t* bottom) const;
+
+  std::vector<Id>& GetBucket(int32_t cell_x, int32_t cell_y);
+  const std::vector<Id>& GetBucket(int32_t cell_x, int32_t cell_y) const;
+
+  // Lists |id| where its rect is, or takes it out.
+  void Link(Id id);
+  void Unlink(Id id);
+
+  // Doubles the hash table.
+  void Grow();
+
+  // Reports |id| to a query once. Returns false if it was reported already.
+  bool Mark(Id id) const;
+
+  int32_t cell_shift_;
+
+  std::vector<Entry> entries_;
+  std::vector<Id> free_ids_;
+  size_t count_;
+  uint32_t next_order_;
+
+  // Indexed by the hash of a cell; more than one cell can share a bucket.
+  std::vector<std::vector<Id> > buckets_;
+  std::vector<Id> unbucketed_;
+
+  mutable uint32_t query_mark_;
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_RECT_INDEX_H_
@@ -0,0 +1,252 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/scroll_controller.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "ppapi/c/pp_input_event.h"
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/module.h"
+
+namespace pp {
+
+namespace {
+
+// A fling slower than this, in pixels per second, stops.
+const float kMinFlingVelocity = 20.0f;
+
+// A drag that was let go of after holding still this long doesn't fling.
+const PP_TimeTicks kMaxFlingReleaseDelay = 0.1;
+
+// How much a new mouse move counts towards the drag velocity.
+const float kDragVelocityWeight = 0.8f;
+
+int32_t Round(float value) {
+  return static_cast<int32_t>(floorf(value + 0.5f));
+}
+
+PP_TimeTicks Now() {
+  return Module::Get()->core()->GetTimeTicks();
+}
+
+}  // namespace
+
+ScrollController::ScrollController(PaintManager* paint_manager,
+                                   Client* client)
+    : paint_manager_(paint_manager),
+      client_(client),
+      smooth_scroll_duration_ms_(120),
+      fling_time_constant_ms_(325),
+      drag_to_scroll_(false),
+      x_(0),
+      y_(0),
+      mode_(MODE_IDLE),
+      start_time_(0),
+      start_x_(0),
+      start_y_(0),
+      target_x_(0),
+      target_y_(0),
+      velocity_x_(0),
+      velocity_y_(0),
+      dragging_(false),
+      drag_x_(0),
+      drag_y_(0),
+      drag_time_(0) {
+  paint_manager_->set_frame_listener(this);
+}
+
+ScrollController::~ScrollController() {
+  if (paint_manager_->frame_listener() == this)
+    paint_manager_->set_frame_listener(NULL);
+}
+
+void ScrollController::SetContentSize(const Size& size) {
+  content_size_ = size;
+  Clamp(&x_, &y_);
+  Clamp(&target_x_, &target_y_);
+  paint_manager_->RequestFrame();
+}
+
+void ScrollController::SetViewRect(const Rect& rect) {
+  view_rect_ = rect;
+  Clamp(&x_, &y_);
+  Clamp(&target_x_, &target_y_);
+  paint_manager_->RequestFrame();
+}
+
+bool ScrollController::HandleInputEvent(const PP_InputEvent& event) {
+  switch (event.type) {
+    case PP_INPUTEVENT_TYPE_MOUSEWHEEL: {
+      const PP_InputEvent_Wheel& wheel = event.u.wheel;
+      if (wheel.scroll_by_page) {
+        ScrollBy(-wheel.wheel_ticks_x * view_rect_.width(),
+                 -wheel.wheel_ticks_y * view_rect_.height(), true);
+      } else {
+        ScrollBy(-wheel.delta_x, -wheel.delta_y, true);
+      }
+      return true;
+    }
+    case PP_INPUTEVENT_TYPE_MOUSEDOWN: {
+      const PP_InputEvent_Mouse& mouse = event.u.mouse;
+      if (!drag_to_scroll_ ||
+          mouse.button != PP_INPUTEVENT_MOUSEBUTTON_LEFT ||
+          !view_rect_.Contains(static_cast<int32_t>(mouse.x),
+                               static_cast<int32_t>(mouse.y)))
+        return false;
+      StopAnimation();
+      dragging_ = true;
+      drag_x_ = mouse.x;
+      drag_y_ = mouse.y;
+      drag_time_ = event.time_stamp;
+      velocity_x_ = 0;
+      velocity_y_ = 0;
+      return true;
+    }
+    case PP_INPUTEVENT_TYPE_MOUSEMOVE: {
+      if (!dragging_)
+        return false;
+      const PP_InputEvent_Mouse& mouse = event.u.mouse;
+      float dx = drag_x_ - mouse.x;
+      float dy = drag_y_ - mouse.y;
+      PP_TimeTicks dt = event.time_stamp - drag_time_;
+      if (dt > 0) {
+        // Smoothed, so that one uneven move doesn't decide the fling.
+        velocity_x_ = kDragVelocityWeight * static_cast<float>(dx / dt) +
+            (1 - kDragVelocityWeight) * velocity_x_;
+        velocity_y_ = kDragVelocityWeight * static_cast<float>(dy / dt) +
+            (1 - kDragVelocityWeight) * velocity_y_;
+      }
+      drag_x_ = mouse.x;
+      drag_y_ = mouse.y;
+      drag_time_ = event.time_stamp;
+      x_ += dx;
+      y_ += dy;
+      Clamp(&x_, &y_);
+      paint_manager_->RequestFrame();
+      return true;
+    }
+    case PP_INPUTEVENT_TYPE_MOUSEUP: {
+      if (!dragging_)
+        return false;
+      dragging_ = false;
+      float speed = sqrtf(velocity_x_ * velocity_x_ +
+                          velocity_y_ * velocity_y_);
+      if (speed >= kMinFlingVelocity &&
+          event.time_stamp - drag_time_ <= kMaxFlingReleaseDelay)
+        StartAnimation(MODE_FLING);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+void ScrollController::ScrollBy(float dx, float dy, bool animate) {
+  // Successive wheel events add to where the animation is going, not to
+  // where it has got to.
+  if (mode_ == MODE_SMOOTH)
+    ScrollTo(target_x_ + dx, target_y_ + dy, animate);
+  else
+    ScrollTo(x_ + dx, y_ + dy, animate);
+}
+
+void ScrollController::ScrollTo(float x, float y, bool animate) {
+  target_x_ = x;
+  target_y_ = y;
+  Clamp(&target_x_, &target_y_);
+  if (animate && smooth_scroll_duration_ms_ > 0) {
+    StartAnimation(MODE_SMOOTH);
+    return;
+  }
+  mode_ = MODE_IDLE;
+  x_ = target_x_;
+  y_ = target_y_;
+  paint_manager_->RequestFrame();
+}
+
+void ScrollController::StopAnimation() {
+  mode_ = MODE_IDLE;
+  target_x_ = x_;
+  target_y_ = y_;
+}
+
+void ScrollController::WillPaintFrame(PP_TimeTicks frame_time) {
+  if (mode_ != MODE_IDLE)
+    Animate(frame_time);
+
+  Point offset(Round(x_), Round(y_));
+  if (offset != offset_) {
+    // Everything that moved since the last frame is one scroll.
+    paint_manager_->ScrollRect(view_rect_, offset_ - offset);
+    offset_ = offset;
+    client_->ScrollOffsetChanged(offset_);
+  }
+
+  if (mode_ != MODE_IDLE)
+    paint_manager_->RequestFrame();
+}
+
+void ScrollController::StartAnimation(Mode mode) {
+  mode_ = mode;
+  start_time_ = Now();
+  start_x_ = x_;
+  start_y_ = y_;
+  paint_manager_->RequestFrame();
+}
+
+void ScrollController::Clamp(float* x, float* y) const {
+  float max_x = static_cast<float>(
+      std::max(content_size_.width() - view_rect_.width(), 0));
+  float max_y = static_cast<float>(
+      std::max(content_size_.height() - view_rect_.height(), 0));
+  *x = std::min(std::max(*x, 0.0f), max_x);
+  *y = std::min(std::max(*y, 0.0f), max_y);
+}
+
+void ScrollController::Animate(PP_TimeTicks time) {
+  float elapsed_ms =
+      std::max(static_cast<float>((time - start_time_) * 1000), 0.0f);
+
+  if (mode_ == MODE_SMOOTH) {
+    float progress = elapsed_ms / smooth_scroll_duration_ms_;
+    if (progress >= 1) {
+      x_ = target_x_;
+      y_ = target_y_;
+      mode_ = MODE_IDLE;
+      return;
+    }
+    // Ease out (cubic): fast at first, settling into the target.
+    float remaining = 1 - progress;
+    float eased = 1 - remaining * remaining * remaining;
+    x_ = start_x_ + (target_x_ - start_x_) * eased;
+    y_ = start_y_ + (target_y_ - start_y_) * eased;
+    return;
+  }
+
+  // A fling's velocity decays exponentially, so it travels velocity * tau
+  // in all.
+  float tau = fling_time_constant_ms_ / 1000.0f;
+  float decay = tau > 0 ? expf(-elapsed_ms / 1000.0f / tau) : 0;
+  float x = start_x_ + velocity_x_ * tau * (1 - decay);
+  float y = start_y_ + velocity_y_ * tau * (1 - decay);
+  float clamped_x = x;
+  float clamped_y = y;
+  Clamp(&clamped_x, &clamped_y);
+  x_ = clamped_x;
+  y_ = clamped_y;
+
+  // Stops once it's slow, or has run into the edges in every direction it
+  // was going.
+  bool x_stuck = velocity_x_ == 0 || clamped_x != x;
+  bool y_stuck = velocity_y_ == 0 || clamped_y != y;
+  float speed = sqrtf(velocity_x_ * velocity_x_ +
+                      velocity_y_ * velocity_y_) * decay;
+  if (speed < kMinFlingVelocity || (x_stuck && y_stuck))
+    StopAnimation();
+}
+
+}  // namespace pp
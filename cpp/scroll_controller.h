@@ -0,0 +1,163 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_SCROLL_CONTROLLER_H_
+#define PPAPI_CPP_SCROLL_CONTROLLER_H_
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/pp_time.h"
+#include "ppapi/cpp/paint_manager.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/size.h"
+
+struct PP_InputEvent;
+
+namespace pp {
+
+// Turns mouse wheel and drag input into smooth, animated scrolling of a view
+// onto a larger content area.
+//
+// Input doesn't scroll right away. It moves a target offset, which the
+// controller approaches over the next frames of a PaintManager: wheel input
+// eases towards the target, and letting go of a drag keeps it moving with a
+// decaying velocity (a fling). The position is kept with sub-pixel precision,
+// so that small wheel deltas, like those of touchpads, add up instead of
+// being rounded away.
+//
+// The controller is the frame listener of the paint manager. At the start of
+// each frame it moves to where the animation is at that time, and if that
+// changes the whole pixel offset shown, it issues a single ScrollRect of the
+// view for the difference and tells its client. The plugin then paints the
+// exposed area in the same frame, using offset():
+//
+//   virtual bool OnPaint(pp::Graphics2D& graphics,
+//                        const std::vector<pp::Rect>& paint_rects,
+//                        const pp::Rect& paint_bounds) {
+//     ... draw content at scroll_controller_.offset() ...
+//   }
+//
+//   virtual bool HandleInputEvent(const PP_InputEvent& event) {
+//     return scroll_controller_.HandleInputEvent(event);
+//   }
+class ScrollController : public PaintManager::FrameListener {
+ public:
+  class Client {
+   public:
+    // Called from a frame when the offset shown changed. The view has
+    // already been scrolled by the difference, and the exposed area is
+    // invalid.
+    virtual void ScrollOffsetChanged(const Point& offset) = 0;
+
+   protected:
+    virtual ~Client() {}
+  };
+
+  // Becomes the frame listener of |paint_manager|. Both pointers are
+  // non-owning and must outlive the controller.
+  ScrollController(PaintManager* paint_manager, Client* client);
+  virtual ~ScrollController();
+
+  // Sets the size of the content being scrolled. The offset is kept within
+  // it.
+  void SetContentSize(const Size& size);
+
+  // Sets the part of the device that shows the content.
+  void SetViewRect(const Rect& rect);
+
+  // How long wheel scrolling takes to reach its target. Defaults to 120 ms.
+  void set_smooth_scroll_duration(int32_t ms) {
+    smooth_scroll_duration_ms_ = ms;
+  }
+
+  // How quickly a fling slows down: its velocity drops to about a third in
+  // this time. Defaults to 325 ms.
+  void set_fling_time_constant(int32_t ms) { fling_time_constant_ms_ = ms; }
+
+  // Whether dragging with the left mouse button scrolls, like a touch
+  // screen. Defaults to false.
+  void set_drag_to_scroll(bool drag_to_scroll) {
+    drag_to_scroll_ = drag_to_scroll;
+  }
+
+  // Handles wheel events, and mouse events if dragging scrolls. Returns true
+  // if the event was used.
+  bool HandleInputEvent(const PP_InputEvent& event);
+
+  // Scrolls by or to the given offset, which may be fractional. If |animate|
+  // is false the view jumps there in the next frame.
+  void ScrollBy(float dx, float dy, bool animate);
+  void ScrollTo(float x, float y, bool animate);
+
+  // Stops where it is now.
+  void StopAnimation();
+
+  // The whole pixel offset shown, the top left of the content in the view.
+  const Point& offset() const { return offset_; }
+
+  bool IsAnimating() const { return mode_ != MODE_IDLE; }
+  bool is_dragging() const { return dragging_; }
+
+  // PaintManager::FrameListener implementation.
+  virtual void WillPaintFrame(PP_TimeTicks frame_time);
+
+ private:
+  enum Mode {
+    MODE_IDLE,
+    MODE_SMOOTH,
+    MODE_FLING
+  };
+
+  // Starts animating from the current position.
+  void StartAnimation(Mode mode);
+
+  // Keeps |*x| and |*y| within the content.
+  void Clamp(float* x, float* y) const;
+
+  // Moves the position to where the animation is at |time|.
+  void Animate(PP_TimeTicks time);
+
+  // Non-owning pointers.
+  PaintManager* paint_manager_;
+  Client* client_;
+
+  Size content_size_;
+  Rect view_rect_;
+
+  int32_t smooth_scroll_duration_ms_;
+  int32_t fling_time_constant_ms_;
+  bool drag_to_scroll_;
+
+  // The exact position.
+  float x_;
+  float y_;
+
+  // The position rounded to whole pixels, as shown on the device.
+  Point offset_;
+
+  // The animation: from |start_x_|, |start_y_| at |start_time_| towards the
+  // target if smooth, or with the velocity in pixels per second if a fling.
+  Mode mode_;
+  PP_TimeTicks start_time_;
+  float start_x_;
+  float start_y_;
+  float target_x_;
+  float target_y_;
+  float velocity_x_;
+  float velocity_y_;
+
+  // The last mouse position and time while dragging.
+  bool dragging_;
+  float drag_x_;
+  float drag_y_;
+  PP_TimeTicks drag_time_;
+
+  // Disallow copy and assign (these are unimplemented).
+  ScrollController(const ScrollController&);
+  ScrollController& operator=(const ScrollController&);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_SCROLL_CONTROLLER_H_
@@ -0,0 +1,771 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/tile_cache.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/graphics_2d.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/cpp/module.h"
+
+namespace pp {
+
+namespace {
+
+int32_t ScaleKey(float scale) {
+  return static_cast<int32_t>(scale * 1000 + 0.5f);
+}
+
+int32_t ScaleDown(int32_t value, float scale) {
+  return static_cast<int32_t>(floor(value * scale));
+}
+
+int32_t ScaleUp(int32_t value, float scale) {
+  return static_cast<int32_t>(ceil(value * scale));
+}
+
+// Bilinear weights are in 256ths.
+const uint32_t kWeightOne = 256;
+
+// (a * (256 - weight) + b * weight) / 256 rounded, per channel. The SSE2
+// kernels compute the same thing so both give identical pixels.
+inline uint32_t LerpPixel(uint32_t a, uint32_t b, uint32_t weight) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    uint32_t channel = ((a >> shift) & 0xFF) * (kWeightOne - weight) +
+        ((b >> shift) & 0xFF) * weight + kWeightOne / 2;
+    result |= (channel >> 8) << shift;
+  }
+  return result;
+}
+
+void LerpRowsScalar(uint32_t* dst,
+                    const uint32_t* a,
+                    const uint32_t* b,
+                    int32_t count,
+                    uint32_t weight) {
+  for (int32_t i = 0; i < count; i++)
+    dst[i] = LerpPixel(a[i], b[i], weight);
+}
+
+void LerpColumnsScalar(uint32_t* dst,
+                       const uint32_t* src,
+                       const int32_t* columns,
+                       const uint32_t* weights,
+                       int32_t count) {
+  for (int32_t i = 0; i < count; i++)
+    dst[i] = LerpPixel(src[columns[i]], src[columns[i] + 1], weights[i]);
+}
+
+#if defined(__SSE2__)
+
+// The lerp on eight 16-bit lanes. The products and their sum stay under
+// 65536, so the unsigned results are exact.
+inline __m128i Lerp8(__m128i a, __m128i b, __m128i weight) {
+  __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(kWeightOne), weight);
+  __m128i sum = _mm_add_epi16(_mm_mullo_epi16(a, inverse),
+                              _mm_mullo_epi16(b, weight));
+  sum = _mm_add_epi16(sum, _mm_set1_epi16(kWeightOne / 2));
+  return _mm_srli_epi16(sum, 8);
+}
+
+// Blends |count| pixels of rows |a| and |b|, four at a time.
+void LerpRows(uint32_t* dst,
+              const uint32_t* a,
+              const uint32_t* b,
+              int32_t count,
+              uint32_t weight) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weight8 = _mm_set1_epi16(static_cast<int16_t>(weight));
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i pa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    __m128i pb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    __m128i low = Lerp8(_mm_unpacklo_epi8(pa, zero),
+                        _mm_unpacklo_epi8(pb, zero), weight8);
+    __m128i high = Lerp8(_mm_unpackhi_epi8(pa, zero),
+                         _mm_unpackhi_epi8(pb, zero), weight8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packus_epi16(low, high));
+  }
+  LerpRowsScalar(dst + i, a + i, b + i, count - i, weight);
+}
+
+// Samples |count| pixels of |src| between |columns| and the next column,
+// two at a time.
+void LerpColumns(uint32_t* dst,
+                 const uint32_t* src,
+                 const int32_t* columns,
+                 const uint32_t* weights,
+                 int32_t count) {
+  const __m128i zero = _mm_setzero_si128();
+  int32_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    // Both pixels to the left in |a| and to the right in |b|.
+    __m128i a = _mm_unpacklo_epi32(_mm_cvtsi32_si128(src[columns[i]]),
+                                   _mm_cvtsi32_si128(src[columns[i + 1]]));
+    __m128i b = _mm_unpacklo_epi32(
+        _mm_cvtsi32_si128(src[columns[i] + 1]),
+        _mm_cvtsi32_si128(src[columns[i + 1] + 1]));
+    __m128i weight = _mm_set_epi16(
+        weights[i + 1], weights[i + 1], weights[i + 1], weights[i + 1],
+        weights[i], weights[i], weights[i], weights[i]);
+    __m128i result = Lerp8(_mm_unpacklo_epi8(a, zero),
+                           _mm_unpacklo_epi8(b, zero), weight);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packus_epi16(result, result));
+  }
+  LerpColumnsScalar(dst + i, src, columns + i, weights + i, count - i);
+}
+
+#else
+
+void LerpRows(uint32_t* dst,
+              const uint32_t* a,
+              const uint32_t* b,
+              int32_t count,
+              uint32_t weight) {
+  LerpRowsScalar(dst, a, b, count, weight);
+}
+
+void LerpColumns(uint32_t* dst,
+                 const uint32_t* src,
+                 const int32_t* columns,
+                 const uint32_t* weights,
+                 int32_t count) {
+  LerpColumnsScalar(dst, src, columns, weights, count);
+}
+
+#endif  // defined(__SSE2__)
+
+// Finds the pixel before |position| and how far past it |position| is, in
+// a row of |size| pixels. The pixel after it is |*index| + 1; positions past
+// the edges are clamped so that both are in the row.
+void GetSample(float position, int32_t size, int32_t* index,
+               uint32_t* weight) {
+  if (size < 2 || position <= 0) {
+    *index = 0;
+    *weight = 0;
+    return;
+  }
+  if (position >= size - 1) {
+    *index = size - 2;
+    *weight = kWeightOne;
+    return;
+  }
+  float base = floorf(position);
+  *index = static_cast<int32_t>(base);
+  *weight = static_cast<uint32_t>((position - base) * kWeightOne + 0.5f);
+}
+
+// Scales |src|, of |src_size| and |src_stride| pixels per row, into the top
+// left |dst_size| of |dst|: pixel (x, y) of |dst| is the bilinear sample of
+// |src| at (x * ratio + offset_x, y * ratio + offset_y).
+void ScaleBilinear(const uint32_t* src,
+                   int32_t src_stride,
+                   const Size& src_size,
+                   float ratio,
+                   float offset_x,
+                   float offset_y,
+                   ImageData* dst,
+                   const Size& dst_size) {
+  // A one pixel wide source is sampled as if it were two alike.
+  std::vector<uint32_t> padded;
+  if (src_size.width() < 2) {
+    padded.resize(src_size.height() * 2);
+    for (int32_t y = 0; y < src_size.height(); y++)
+      padded[y * 2] = padded[y * 2 + 1] = src[y * src_stride];
+    src = &padded[0];
+    src_stride = 2;
+  }
+
+  std::vector<int32_t> columns(dst_size.width());
+  std::vector<uint32_t> weights(dst_size.width());
+  for (int32_t x = 0; x < dst_size.width(); x++) {
+    GetSample(x * ratio + offset_x, std::max(src_size.width(), 2),
+              &columns[x], &weights[x]);
+  }
+
+  // Each row of |dst| samples a blend of two rows of |src|.
+  std::vector<uint32_t> blended(std::max(src_size.width(), 2));
+  for (int32_t y = 0; y < dst_size.height(); y++) {
+    int32_t row;
+    uint32_t weight;
+    GetSample(y * ratio + offset_y, src_size.height(), &row, &weight);
+    const uint32_t* a = src + row * src_stride;
+    const uint32_t* b = src_size.height() < 2 ? a : a + src_stride;
+    LerpRows(&blended[0], a, b, static_cast<int32_t>(blended.size()),
+             weight);
+    LerpColumns(dst->GetAddr32(Point(0, y)), &blended[0], &columns[0],
+                &weights[0], dst_size.width());
+  }
+}
+
+}  // namespace
+
+// Worker threads --------------------------------------------------------------
+
+#if defined(_WIN32)
+
+// No threads; the tiles are rendered synchronously.
+class TileCache::Workers {
+ public:
+  Workers(TileCache*, Client*, int) {}
+
+  bool started() const { return false; }
+
+  void Post(Tile*, uint32_t) {
+    PP_NOTREACHED();
+  }
+};
+
+#else
+
+// Renders tiles on a fixed set of threads. Finished tiles are collected and
+// handed back to the cache in one main thread callback.
+class TileCache::Workers {
+ public:
+  Workers(TileCache* cache, Client* client, int count);
+  ~Workers();
+
+  bool started() const { return !threads_.empty(); }
+
+  // Renders |tile| as it is now, for |generation|.
+  void Post(Tile* tile, uint32_t generation);
+
+ private:
+  struct Job {
+    Tile* tile;
+    ImageData* image;
+    Rect rect;
+    float scale;
+    uint32_t generation;
+  };
+
+  // The state shared with the threads and with the main thread callback,
+  // which can still be pending after the cache is gone.
+  struct Shared {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    Client* client;
+    std::deque<Job> queue;
+    std::vector<Job> done;
+
+    // NULL once the cache is gone.
+    TileCache* cache;
+
+    // One for the Workers, one for a pending callback.
+    int ref_count;
+    bool callback_pending;
+    bool quit;
+  };
+
+  static void* ThreadMain(void* data);
+  static void OnJobsDone(void* user_data, int32_t result);
+
+  // Drops a reference to |shared|, which must be locked, and unlocks it.
+  static void ReleaseAndUnlock(Shared* shared);
+
+  Shared* shared_;
+  std::vector<pthread_t> threads_;
+};
+
+TileCache::Workers::Workers(TileCache* cache, Client* client, int count)
+    : shared_(new Shared) {
+  pthread_mutex_init(&shared_->lock, NULL);
+  pthread_cond_init(&shared_->cond, NULL);
+  shared_->client = client;
+  shared_->cache = cache;
+  shared_->ref_count = 1;
+  shared_->callback_pending = false;
+  shared_->quit = false;
+  for (int i = 0; i < count; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &ThreadMain, shared_) != 0)
+      break;
+    threads_.push_back(thread);
+  }
+}
+
+TileCache::Workers::~Workers() {
+  pthread_mutex_lock(&shared_->lock);
+  shared_->quit = true;
+  shared_->queue.clear();
+  pthread_cond_broadcast(&shared_->cond);
+  pthread_mutex_unlock(&shared_->lock);
+  for (size_t i = 0; i < threads_.size(); i++)
+    pthread_join(threads_[i], NULL);
+
+  pthread_mutex_lock(&shared_->lock);
+  shared_->cache = NULL;
+  shared_->done.clear();
+  ReleaseAndUnlock(shared_);
+}
+
+void TileCache::Workers::Post(Tile* tile, uint32_t generation) {
+  Job job;
+  job.tile = tile;
+  job.image = &tile->image;
+  job.rect = tile->rect;
+  job.scale = tile->scale;
+  job.generation = generation;
+  pthread_mutex_lock(&shared_->lock);
+  shared_->queue.push_back(job);
+  pthread_cond_signal(&shared_->cond);
+  pthread_mutex_unlock(&shared_->lock);
+}
+
+// static
+void* TileCache::Workers::ThreadMain(void* data) {
+  Shared* shared = static_cast<Shared*>(data);
+  pthread_mutex_lock(&shared->lock);
+  for (;;) {
+    while (!shared->quit && shared->queue.empty())
+      pthread_cond_wait(&shared->cond, &shared->lock);
+    if (shared->quit)
+      break;
+    Job job = shared->queue.front();
+    shared->queue.pop_front();
+    pthread_mutex_unlock(&shared->lock);
+
+    shared->client->RasterizeTile(job.image, job.rect, job.scale);
+
+    pthread_mutex_lock(&shared->lock);
+    shared->done.push_back(job);
+    if (!shared->callback_pending && !shared->quit) {
+      shared->callback_pending = true;
+      shared->ref_count++;
+      Module::Get()->core()->CallOnMainThread(
+          0, CompletionCallback(&OnJobsDone, shared));
+    }
+  }
+  pthread_mutex_unlock(&shared->lock);
+  return NULL;
+}
+
+// static
+void TileCache::Workers::OnJobsDone(void* user_data, int32_t) {
+  Shared* shared = static_cast<Shared*>(user_data);
+  pthread_mutex_lock(&shared->lock);
+  shared->callback_pending = false;
+  std::vector<Job> done;
+  done.swap(shared->done);
+  // The cache can only go away on this thread, so it stays valid after
+  // unlocking.
+  TileCache* cache = shared->cache;
+  ReleaseAndUnlock(shared);
+
+  if (cache) {
+    for (size_t i = 0; i < done.size(); i++)
+      cache->DidRasterizeTile(done[i].tile, done[i].generation);
+  }
+}
+
+// static
+void TileCache::Workers::ReleaseAndUnlock(Shared* shared) {
+  bool last = --shared->ref_count == 0;
+  pthread_mutex_unlock(&shared->lock);
+  if (last) {
+    pthread_cond_destroy(&shared->cond);
+    pthread_mutex_destroy(&shared->lock);
+    delete shared;
+  }
+}
+
+#endif  // defined(_WIN32)
+
+// TileCache -------------------------------------------------------------------
+
+TileCache::TileCache(Client* client, const Size& tile_size, int worker_count)
+    : client_(client),
+      tile_size_(tile_size),
+      scale_(1.0f),
+      zooming_(false),
+      fallback_scale_(0),
+      max_tiles_(64),
+      placeholder_color_(0xFFFFFFFF),
+      placeholder_image_color_(0),
+      scaled_images_used_(0),
+      paint_count_(0),
+      rasterized_count_(0),
+      workers_(NULL) {
+  PP_DCHECK(client && !tile_size.IsEmpty());
+  if (worker_count > 0) {
+    workers_ = new Workers(this, client, worker_count);
+    if (!workers_->started()) {
+      delete workers_;
+      workers_ = NULL;
+    }
+  }
+}
+
+TileCache::~TileCache() {
+  // Stop the threads before the tiles they render into go away.
+  delete workers_;
+  DeleteTiles();
+  for (size_t i = 0; i < orphaned_tiles_.size(); i++)
+    delete orphaned_tiles_[i];
+}
+
+void TileCache::SetSurfaceSize(const Size& size) {
+  if (size == surface_size_)
+    return;
+  surface_size_ = size;
+  DeleteTiles();
+}
+
+void TileCache::SetScale(float scale) {
+  PP_DCHECK(scale > 0);
+  scale_ = scale;
+  zooming_ = false;
+  fallback_scale_ = 0;
+}
+
+void TileCache::Zoom(float scale) {
+  PP_DCHECK(scale > 0);
+  // Until the tiles of the first level are ready, those of the scale the
+  // gesture started from are scaled instead.
+  if (!zooming_)
+    fallback_scale_ = scale_;
+  scale_ = scale;
+  zooming_ = true;
+}
+
+void TileCache::EndZoom() {
+  if (!zooming_)
+    return;
+  zooming_ = false;
+  fallback_scale_ = GetLevelScale(scale_);
+  if (ScaleKey(fallback_scale_) == ScaleKey(scale_))
+    fallback_scale_ = 0;
+}
+
+// static
+float TileCache::GetLevelScale(float scale) {
+  PP_DCHECK(scale > 0);
+  float level = 1.0f;
+  while (level < scale)
+    level *= 2;
+  while (level / 2 >= scale)
+    level /= 2;
+  return level;
+}
+
+Size TileCache::GetScaledSurfaceSize() const {
+  return Size(ScaleUp(surface_size_.width(), scale_),
+              ScaleUp(surface_size_.height(), scale_));
+}
+
+void TileCache::Invalidate(const Rect& rect) {
+  for (TileMap::iterator it = tiles_.begin(); it != tiles_.end(); ++it) {
+    Tile* tile = it->second;
+    int32_t left = ScaleDown(rect.x(), tile->scale);
+    int32_t top = ScaleDown(rect.y(), tile->scale);
+    Rect scaled(left, top,
+                ScaleUp(rect.right(), tile->scale) - left,
+                ScaleUp(rect.bottom(), tile->scale) - top);
+    if (scaled.Intersects(tile->rect)) {
+      tile->ready = false;
+      tile->generation++;
+    }
+  }
+}
+
+void TileCache::InvalidateAll() {
+  for (TileMap::iterator it = tiles_.begin(); it != tiles_.end(); ++it) {
+    it->second->ready = false;
+    it->second->generation++;
+  }
+}
+
+bool TileCache::Paint(Graphics2D* graphics,
+                      const std::vector<Rect>& device_rects,
+                      const Point& scroll_offset) {
+  paint_count_++;
+  scaled_images_used_ = 0;
+  Rect surface_bounds(GetScaledSurfaceSize());
+  float level_scale = zooming_ ? GetLevelScale(scale_) : scale_;
+  bool scaling = ScaleKey(level_scale) != ScaleKey(scale_);
+  bool painted = false;
+  for (size_t i = 0; i < device_rects.size(); i++) {
+    Rect rect(device_rects[i].point() + scroll_offset,
+              device_rects[i].size());
+    rect = rect.Intersect(surface_bounds);
+    if (rect.IsEmpty())
+      continue;
+
+    int32_t first_column = rect.x() / tile_size_.width();
+    int32_t last_column = (rect.right() - 1) / tile_size_.width();
+    int32_t first_row = rect.y() / tile_size_.height();
+    int32_t last_row = (rect.bottom() - 1) / tile_size_.height();
+    for (int32_t row = first_row; row <= last_row; row++) {
+      for (int32_t column = first_column; column <= last_column; column++) {
+        Rect cell(column * tile_size_.width(), row * tile_size_.height(),
+                  tile_size_.width(), tile_size_.height());
+        cell = cell.Intersect(surface_bounds);
+        Rect part = cell.Intersect(rect);
+        Point top_left = cell.point() - scroll_offset;
+        Rect src_rect(part.point() - cell.point(), part.size());
+
+        if (scaling) {
+          if (PaintScaled(graphics, cell, part, level_scale, true,
+                          scroll_offset)) {
+            painted = true;
+            continue;
+          }
+        } else {
+          Tile* tile = GetTile(scale_, column, row, true);
+          tile->last_used = paint_count_;
+          if (tile->ready || RasterizeTile(tile)) {
+            graphics->PaintImageData(tile->image, top_left, src_rect);
+            painted = true;
+            continue;
+          }
+        }
+
+        if (fallback_scale_ > 0 &&
+            PaintScaled(graphics, cell, part, fallback_scale_, false,
+                        scroll_offset)) {
+          painted = true;
+          continue;
+        }
+        const ImageData& placeholder = GetPlaceholder();
+        if (placeholder.is_null())
+          continue;
+        graphics->PaintImageData(placeholder, top_left, src_rect);
+        painted = true;
+      }
+    }
+  }
+  return painted;
+}
+
+TileCache::Tile* TileCache::GetTile(float scale,
+                                    int32_t column,
+                                    int32_t row,
+                                    bool create) {
+  TileKey key(ScaleKey(scale), column, row);
+  TileMap::iterator found = tiles_.find(key);
+  if (found != tiles_.end())
+    return found->second;
+  if (!create)
+    return NULL;
+
+  EvictTiles();
+  Tile* tile = new Tile;
+  tile->rect = Rect(column * tile_size_.width(), row * tile_size_.height(),
+                    tile_size_.width(), tile_size_.height());
+  tile->rect = tile->rect.Intersect(
+      Rect(Size(ScaleUp(surface_size_.width(), scale),
+                ScaleUp(surface_size_.height(), scale))));
+  tile->scale = scale;
+  tiles_[key] = tile;
+  return tile;
+}
+
+bool TileCache::PaintScaled(Graphics2D* graphics,
+                            const Rect& cell,
+                            const Rect& part,
+                            float source_scale,
+                            bool rasterize_missing,
+                            const Point& scroll_offset) {
+  // The area of the tiles at |source_scale| that the samples of |cell| come
+  // from, with a pixel to spare on each side for the bilinear filter.
+  float ratio = source_scale / scale_;
+  Rect source_bounds(Size(ScaleUp(surface_size_.width(), source_scale),
+                          ScaleUp(surface_size_.height(), source_scale)));
+  int32_t left = ScaleDown(cell.x(), ratio) - 1;
+  int32_t top = ScaleDown(cell.y(), ratio) - 1;
+  Rect source(left, top, ScaleUp(cell.right(), ratio) + 1 - left,
+              ScaleUp(cell.bottom(), ratio) + 1 - top);
+  source = source.Intersect(source_bounds);
+  if (source.IsEmpty())
+    return false;
+
+  patch_.resize(source.width() * source.height());
+  bool any_ready = false;
+  int32_t first_column = source.x() / tile_size_.width();
+  int32_t last_column = (source.right() - 1) / tile_size_.width();
+  int32_t first_row = source.y() / tile_size_.height();
+  int32_t last_row = (source.bottom() - 1) / tile_size_.height();
+  for (int32_t row = first_row; row <= last_row; row++) {
+    for (int32_t column = first_column; column <= last_column; column++) {
+      Tile* tile = GetTile(source_scale, column, row, rasterize_missing);
+      if (tile)
+        tile->last_used = paint_count_;
+      bool ready = tile &&
+          (tile->ready || (rasterize_missing && RasterizeTile(tile)));
+      any_ready |= ready;
+
+      Rect area(column * tile_size_.width(), row * tile_size_.height(),
+                tile_size_.width(), tile_size_.height());
+      area = area.Intersect(source);
+      for (int32_t y = area.y(); y < area.bottom(); y++) {
+        uint32_t* dst = &patch_[(y - source.y()) * source.width() +
+                                area.x() - source.x()];
+        if (ready) {
+          memcpy(dst, tile->image.GetAddr32(Point(area.x() - tile->rect.x(),
+                                                  y - tile->rect.y())),
+                 area.width() * sizeof(uint32_t));
+        } else {
+          std::fill(dst, dst + area.width(), placeholder_color_);
+        }
+      }
+    }
+  }
+  if (!any_ready)
+    return false;
+
+  ImageData* image = GetScaledImage();
+  if (!image)
+    return false;
+  // Pixel centers map to pixel centers.
+  ScaleBilinear(&patch_[0], source.width(), source.size(), ratio,
+                (cell.x() + 0.5f) * ratio - 0.5f - source.x(),
+                (cell.y() + 0.5f) * ratio - 0.5f - source.y(),
+                image, cell.size());
+  graphics->PaintImageData(*image, cell.point() - scroll_offset,
+                           Rect(part.point() - cell.point(), part.size()));
+  return true;
+}
+
+void TileCache::EvictTiles() {
+  while (tiles_.size() >= max_tiles_) {
+    TileMap::iterator oldest = tiles_.end();
+    for (TileMap::iterator it = tiles_.begin(); it != tiles_.end(); ++it) {
+      const Tile* tile = it->second;
+      // Tiles of the paint in progress are needed and pending ones are in use.
+      if (tile->pending || tile->last_used == paint_count_)
+        continue;
+      if (oldest == tiles_.end() ||
+          tile->last_used < oldest->second->last_used)
+        oldest = it;
+    }
+    if (oldest == tiles_.end())
+      return;
+    if (!oldest->second->image.is_null())
+      free_images_.push_back(oldest->second->image);
+    delete oldest->second;
+    tiles_.erase(oldest);
+  }
+}
+
+bool TileCache::RasterizeTile(Tile* tile) {
+  if (tile->pending)
+    return false;
+  if (tile->image.is_null()) {
+    if (!free_images_.empty()) {
+      tile->image = free_images_.back();
+      free_images_.pop_back();
+    } else {
+      tile->image = ImageData(ImageData::GetNativeImageDataFormat(),
+                              tile_size_, false);
+      if (tile->image.is_null())
+        return false;
+    }
+  }
+
+  if (workers_) {
+    tile->pending = true;
+    workers_->Post(tile, tile->generation);
+    return false;
+  }
+  client_->RasterizeTile(&tile->image, tile->rect, tile->scale);
+  rasterized_count_++;
+  tile->ready = true;
+  return true;
+}
+
+void TileCache::DidRasterizeTile(Tile* tile, uint32_t generation) {
+  for (size_t i = 0; i < orphaned_tiles_.size(); i++) {
+    if (orphaned_tiles_[i] == tile) {
+      // The surface changed size while it was being rendered.
+      delete tile;
+      orphaned_tiles_.erase(orphaned_tiles_.begin() + i);
+      return;
+    }
+  }
+
+  tile->pending = false;
+  rasterized_count_++;
+  // A tile invalidated while it was rendered is out of date already; it's
+  // rendered again when painted.
+  if (generation == tile->generation)
+    tile->ready = true;
+  int32_t scale_key = ScaleKey(tile->scale);
+  if (scale_key == ScaleKey(scale_)) {
+    client_->DidRasterizeTile(tile->rect);
+    return;
+  }
+  // Tiles of other scales are shown scaled during and after zooming; the
+  // area they're sampled for is a pixel wider.
+  if ((zooming_ && scale_key == ScaleKey(GetLevelScale(scale_))) ||
+      (fallback_scale_ > 0 && scale_key == ScaleKey(fallback_scale_))) {
+    float ratio = scale_ / tile->scale;
+    int32_t left = ScaleDown(tile->rect.x() - 1, ratio);
+    int32_t top = ScaleDown(tile->rect.y() - 1, ratio);
+    Rect rect(left, top, ScaleUp(tile->rect.right() + 1, ratio) - left,
+              ScaleUp(tile->rect.bottom() + 1, ratio) - top);
+    client_->DidRasterizeTile(rect.Intersect(Rect(GetScaledSurfaceSize())));
+  }
+}
+
+const ImageData& TileCache::GetPlaceholder() {
+  if (placeholder_.is_null() ||
+      placeholder_image_color_ != placeholder_color_) {
+    placeholder_ = ImageData(ImageData::GetNativeImageDataFormat(),
+                             tile_size_, false);
+    if (!placeholder_.is_null()) {
+      for (int32_t y = 0; y < tile_size_.height(); y++) {
+        uint32_t* row = placeholder_.GetAddr32(Point(0, y));
+        for (int32_t x = 0; x < tile_size_.width(); x++)
+          row[x] = placeholder_color_;
+      }
+      placeholder_image_color_ = placeholder_color_;
+    }
+  }
+  return placeholder_;
+}
+
+ImageData* TileCache::GetScaledImage() {
+  if (scaled_images_used_ == scaled_images_.size()) {
+    ImageData image(ImageData::GetNativeImageDataFormat(), tile_size_, false);
+    if (image.is_null())
+      return NULL;
+    scaled_images_.push_back(image);
+  }
+  return &scaled_images_[scaled_images_used_++];
+}
+
+void TileCache::DeleteTiles() {
+  for (TileMap::iterator it = tiles_.begin(); it != tiles_.end(); ++it) {
+    Tile* tile = it->second;
+    if (tile->pending) {
+      // A worker is using it; DidRasterizeTile() deletes it.
+      orphaned_tiles_.push_back(tile);
+      continue;
+    }
+    if (!tile->image.is_null())
+      free_images_.push_back(tile->image);
+    delete tile;
+  }
+  tiles_.clear();
+}
+
+}  // namespace pp
@@ -0,0 +1,269 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_TILE_CACHE_H_
+#define PPAPI_CPP_TILE_CACHE_H_
+
+#include <map>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/size.h"
+
+namespace pp {
+
+class Graphics2D;
+
+// Caches the rendering of a large logical surface, such as a map or a
+// document, in fixed-size tiles so that content that only moves doesn't have
+// to be rendered again. Painting the visible part of the surface is then
+// mostly a matter of copying tiles to the device with PaintImageData.
+//
+// The surface is rendered by the client one tile at a time. Tiles that are
+// needed but missing are rendered synchronously, or, if the cache was
+// created with worker threads, on those threads while a placeholder color is
+// painted in their place; the client is told when they're done so it can
+// repaint that area. Tiles are kept per zoom scale, so going back to a
+// previous scale is as cheap as panning. Tiles beyond the budget are evicted
+// least recently used first, and their ImageData is recycled for new tiles.
+//
+// During a zoom gesture (Zoom() until EndZoom()) tiles are only rendered at
+// power of two scales, and the intermediate scales are painted by scaling
+// them, so that each step of a pinch doesn't render the surface again. Once
+// the gesture ends the tiles are rendered at its final scale, and with
+// worker threads the scaled ones are painted until those are ready.
+//
+// The TileCache is meant to be used from the OnPaint of a
+// PaintManager::Client:
+//
+//   virtual bool OnPaint(pp::Graphics2D& graphics,
+//                        const std::vector<pp::Rect>& paint_rects,
+//                        const pp::Rect& paint_bounds) {
+//     return tile_cache_.Paint(&graphics, paint_rects, scroll_offset_);
+//   }
+//
+// Scrolling by calling PaintManager::ScrollRect makes the browser move the
+// pixels, and the cache fills in the exposed area.
+class TileCache {
+ public:
+  class Client {
+   public:
+    // Renders |rect| of the surface at |scale| into |tile|, the top left of
+    // |rect| going at the top left of |tile|. |rect| is in surface pixels at
+    // |scale|.
+    //
+    // When the cache has worker threads this is called on them, so it may
+    // only use the pixels of |tile| (data(), stride(), GetAddr32()) and data
+    // of the client that is safe to read concurrently, and no PPAPI
+    // functions. Several tiles may be rendered at the same time.
+    virtual void RasterizeTile(ImageData* tile,
+                               const Rect& rect,
+                               float scale) = 0;
+
+    // Called on the main thread when a tile that was rendered by a worker
+    // thread is ready. |rect| is in surface pixels at the current scale; it
+    // should be invalidated so that Paint() is called for it again.
+    virtual void DidRasterizeTile(const Rect& rect) = 0;
+
+   protected:
+    // You shouldn't be doing deleting through this interface.
+    virtual ~Client() {}
+  };
+
+  // Creates a cache for |client| with tiles of |tile_size|, rendered on
+  // |worker_count| threads, or synchronously on the main thread if 0.
+  // Worker threads aren't available on all platforms; the tiles are then
+  // rendered synchronously.
+  TileCache(Client* client, const Size& tile_size, int worker_count);
+  ~TileCache();
+
+  // How many tiles are kept, over all scales. Tiles that are needed to paint
+  // are kept even if that means going over. Defaults to 64.
+  void set_max_tiles(size_t max_tiles) { max_tiles_ = max_tiles; }
+
+  // The color painted where a tile is still being rendered. BGRA
+  // premultiplied; defaults to opaque white.
+  void set_placeholder_color(uint32_t color) { placeholder_color_ = color; }
+
+  const Size& tile_size() const { return tile_size_; }
+  const Size& surface_size() const { return surface_size_; }
+  float scale() const { return scale_; }
+
+  // The size of the surface at scale 1. Changing it drops all the tiles.
+  void SetSurfaceSize(const Size& size);
+
+  // Sets the zoom scale the surface is painted at. The tiles of other scales
+  // are kept, up to the budget.
+  void SetScale(float scale);
+
+  // Starts or continues a zoom gesture at |scale|. Until EndZoom(), tiles
+  // are rendered at GetLevelScale(scale) and scaled down to |scale| as
+  // they're painted. The client must invalidate the whole device.
+  void Zoom(float scale);
+
+  // Ends the zoom gesture at the current scale, from which tiles are
+  // rendered again. The client must invalidate the whole device.
+  void EndZoom();
+  bool is_zooming() const { return zooming_; }
+
+  // The power of two scale that tiles are rendered at while zooming to
+  // |scale|: the smallest one at or above it, so they're only ever scaled
+  // down, by less than half.
+  static float GetLevelScale(float scale);
+
+  // The size of the surface at the current scale.
+  Size GetScaledSurfaceSize() const;
+
+  // Marks the tiles touching |rect|, in surface pixels at scale 1, as out of
+  // date at all scales. They're rendered again when next painted. The client
+  // must also invalidate the area of the device showing them.
+  void Invalidate(const Rect& rect);
+  void InvalidateAll();
+
+  // Paints |device_rects| of |graphics| from the tiles. |scroll_offset| is
+  // where the top left of the device is in the surface at the current scale.
+  // Parts of the rects outside the surface aren't painted. Returns true if
+  // anything was painted.
+  bool Paint(Graphics2D* graphics,
+             const std::vector<Rect>& device_rects,
+             const Point& scroll_offset);
+
+  // Number of tiles in the cache, and number rendered since creation.
+  size_t tile_count() const { return tiles_.size(); }
+  int rasterized_count() const { return rasterized_count_; }
+
+ private:
+  struct TileKey {
+    TileKey(int32_t in_scale_key, int32_t in_column, int32_t in_row)
+        : scale_key(in_scale_key), column(in_column), row(in_row) {}
+
+    bool operator<(const TileKey& other) const {
+      if (scale_key != other.scale_key)
+        return scale_key < other.scale_key;
+      if (row != other.row)
+        return row < other.row;
+      return column < other.column;
+    }
+
+    // The scale in thousandths.
+    int32_t scale_key;
+    int32_t column;
+    int32_t row;
+  };
+
+  struct Tile {
+    Tile() : ready(false), pending(false), generation(0), last_used(0) {}
+
+    ImageData image;
+
+    // The tile's area of the surface at its scale.
+    Rect rect;
+    float scale;
+
+    // |image| holds the current rendering.
+    bool ready;
+
+    // A worker thread is rendering into |image|. The tile can't be evicted
+    // or be given another image until it's done.
+    bool pending;
+
+    // Incremented when the tile is invalidated, so that renderings started
+    // before can be told apart.
+    uint32_t generation;
+
+    // The paint the tile was last used for.
+    uint32_t last_used;
+  };
+  typedef std::map<TileKey, Tile*> TileMap;
+
+  class Workers;
+  friend class Workers;
+
+  // Returns the tile at |column|, |row| at |scale|, creating it if needed
+  // and |create| is true. Returns NULL otherwise.
+  Tile* GetTile(float scale, int32_t column, int32_t row, bool create);
+
+  // Paints |part| of |cell|, both in surface pixels at the current scale, by
+  // scaling the tiles at |source_scale|. Tiles that aren't ready are
+  // rendered if |rasterize_missing| is true, and the placeholder color used
+  // in their place meanwhile. Returns false, painting nothing, if none of
+  // the tiles are ready.
+  bool PaintScaled(Graphics2D* graphics,
+                   const Rect& cell,
+                   const Rect& part,
+                   float source_scale,
+                   bool rasterize_missing,
+                   const Point& scroll_offset);
+
+  // Evicts least recently used tiles until there is room for a new one.
+  void EvictTiles();
+
+  // Renders |tile| synchronously or hands it to the workers. Returns true if
+  // it's ready now.
+  bool RasterizeTile(Tile* tile);
+
+  // Called by the workers on the main thread when |tile| was rendered for
+  // |generation|.
+  void DidRasterizeTile(Tile* tile, uint32_t generation);
+
+  // A tile sized image of the placeholder color.
+  const ImageData& GetPlaceholder();
+
+  // A tile sized image not yet used by the paint in progress, for scaled
+  // tiles. The browser only reads the images on Flush(), so each scaled
+  // tile of a paint needs its own.
+  ImageData* GetScaledImage();
+
+  void DeleteTiles();
+
+  Client* client_;
+  Size tile_size_;
+  Size surface_size_;
+  float scale_;
+  bool zooming_;
+
+  // The scale whose tiles are scaled in place of those that aren't ready,
+  // or 0: the scale before a zoom gesture and, after it, its level.
+  float fallback_scale_;
+
+  size_t max_tiles_;
+  uint32_t placeholder_color_;
+
+  TileMap tiles_;
+
+  // Tiles dropped while a worker was rendering them, deleted when it's done.
+  std::vector<Tile*> orphaned_tiles_;
+
+  // Images of evicted tiles, for reuse.
+  std::vector<ImageData> free_images_;
+
+  ImageData placeholder_;
+  uint32_t placeholder_image_color_;
+
+  // The images for scaled tiles, the first |scaled_images_used_| of which
+  // are used by the paint in progress.
+  std::vector<ImageData> scaled_images_;
+  size_t scaled_images_used_;
+
+  // The pixels of the tiles being scaled, copied together.
+  std::vector<uint32_t> patch_;
+
+  // Counts calls to Paint() for the least recently used eviction.
+  uint32_t paint_count_;
+  int rasterized_count_;
+
+  // NULL if rendering synchronously.
+  Workers* workers_;
+
+  // Disallow copy and assign (these are unimplemented).
+  TileCache(const TileCache&);
+  TileCache& operator=(const TileCache&);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_TILE_CACHE_H_
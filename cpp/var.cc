@@ -29,7 +29,17 @@ DeviceFuncs<PPB_Var_Deprecated> ppb_var_f(PPB_VAR_DEPRECATED_INTERFACE);
 // cross-process calls depending on the plugin. This is an optimization so we
 // only do refcounting on the necessary objects.
 inline bool NeedsRefcounting(const PP_Var& var) {
-  return var.type == PP_VARTYPE_STRING || var.type == PP_VARTYPE_OBJECT;
+  return var.type == PP_VARTYPE_STRING || var.type == PP_VARTYPE_OBJECT ||
+         var.type == PP_VARTYPE_BINARY_ARRAY;
+}
+
+// FNV-1a over the UTF-8 of a string. Never returns 0, which Var uses for a
+// hash that hasn't been computed.
+uint32_t HashUtf8(const char* data, uint32_t len) {
+  uint32_t hash = 2166136261u;
+  for (uint32_t i = 0; i < len; i++)
+    hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+  return hash ? hash : 1;
 }
 
 }  // namespace
@@ -41,29 +51,34 @@ using namespace deprecated;
 Var::Var() {
   var_.type = PP_VARTYPE_UNDEFINED;
   needs_release_ = false;
+  string_hash_ = 0;
 }
 
 Var::Var(Null) {
   var_.type = PP_VARTYPE_NULL;
   needs_release_ = false;
+  string_hash_ = 0;
 }
 
 Var::Var(bool b) {
   var_.type = PP_VARTYPE_BOOL;
   var_.value.as_bool = b;
   needs_release_ = false;
+  string_hash_ = 0;
 }
 
 Var::Var(int32_t i) {
   var_.type = PP_VARTYPE_INT32;
   var_.value.as_int = i;
   needs_release_ = false;
+  string_hash_ = 0;
 }
 
 Var::Var(double d) {
   var_.type = PP_VARTYPE_DOUBLE;
   var_.value.as_double = d;
   needs_release_ = false;
+  string_hash_ = 0;
 }
 
 Var::Var(const char* utf8_str) {
@@ -74,6 +89,7 @@ Var::Var(const char* utf8_str) {
     var_.type = PP_VARTYPE_NULL;
   }
   needs_release_ = (var_.type == PP_VARTYPE_STRING);
+  string_hash_ = 0;
 }
 
 Var::Var(const std::string& utf8_str) {
@@ -85,6 +101,28 @@ Var::Var(const std::string& utf8_str) {
     var_.type = PP_VARTYPE_NULL;
   }
   needs_release_ = (var_.type == PP_VARTYPE_STRING);
+  string_hash_ = 0;
+}
+
+Var::Var(const char* utf8_str, uint32_t len) {
+  if (ppb_var_f) {
+    var_ = ppb_var_f->VarFromUtf8(Module::Get()->pp_module(), utf8_str, len);
+  } else {
+    var_.type = PP_VARTYPE_NULL;
+  }
+  needs_release_ = (var_.type == PP_VARTYPE_STRING);
+  string_hash_ = 0;
+}
+
+Var::Var(PP_BinaryArrayType type, uint32_t count, const void* data) {
+  if (ppb_var_f) {
+    var_ = ppb_var_f->CreateBinaryArray(Module::Get()->pp_module(), type,
+                                        count, data);
+  } else {
+    var_.type = PP_VARTYPE_NULL;
+  }
+  needs_release_ = (var_.type == PP_VARTYPE_BINARY_ARRAY);
+  string_hash_ = 0;
 }
 
 Var::Var(ScriptableObject* object) {
@@ -96,10 +134,12 @@ Var::Var(ScriptableObject* object) {
     var_.type = PP_VARTYPE_NULL;
     needs_release_ = false;
   }
+  string_hash_ = 0;
 }
 
 Var::Var(const Var& other) {
   var_ = other.var_;
+  string_hash_ = other.string_hash_;
   if (NeedsRefcounting(var_)) {
     if (ppb_var_f) {
       needs_release_ = true;
@@ -122,6 +162,7 @@ Var& Var::operator=(const Var& other) {
   if (needs_release_ && ppb_var_f)
     ppb_var_f->Release(var_);
   var_ = other.var_;
+  string_hash_ = other.string_hash_;
   if (NeedsRefcounting(var_)) {
     if (ppb_var_f) {
       needs_release_ = true;
@@ -149,12 +190,20 @@ bool Var::operator==(const Var& other) const {
       return AsInt() == other.AsInt();
     case PP_VARTYPE_DOUBLE:
       return AsDouble() == other.AsDouble();
-    case PP_VARTYPE_STRING:
+    case PP_VARTYPE_STRING: {
       if (var_.value.as_id == other.var_.value.as_id)
         return true;
-      return AsString() == other.AsString();
+      if (string_hash_ && other.string_hash_ &&
+          string_hash_ != other.string_hash_)
+        return false;
+      uint32_t len, other_len;
+      const char* str = AsUtf8(&len);
+      const char* other_str = other.AsUtf8(&other_len);
+      return len == other_len && (len == 0 || memcmp(str, other_str, len) == 0);
+    }
     // TODO(neb): Document that this is === and not ==, unlike strings.
     case PP_VARTYPE_OBJECT:
+    case PP_VARTYPE_BINARY_ARRAY:
       return var_.value.as_id == other.var_.value.as_id;
     default:
       return false;
@@ -200,6 +249,83 @@ std::string Var::AsString() const {
   return std::string(str, len);
 }
 
+const char* Var::AsUtf8(uint32_t* len) const {
+  if (!is_string()) {
+    PP_NOTREACHED();
+    *len = 0;
+    return NULL;
+  }
+
+  if (!ppb_var_f) {
+    *len = 0;
+    return NULL;
+  }
+  return ppb_var_f->VarToUtf8(var_, len);
+}
+
+uint32_t Var::Hash() const {
+  switch (var_.type) {
+    case PP_VARTYPE_BOOL:
+      return var_.value.as_bool ? 1 : 0;
+    case PP_VARTYPE_INT32:
+      return static_cast<uint32_t>(var_.value.as_int);
+    case PP_VARTYPE_DOUBLE: {
+      // Both zeros compare equal, so they have to hash the same.
+      if (var_.value.as_double == 0.0)
+        return 0;
+      uint32_t words[2];
+      memcpy(words, &var_.value.as_double, sizeof(words));
+      return words[0] ^ words[1];
+    }
+    case PP_VARTYPE_STRING:
+      if (!string_hash_) {
+        uint32_t len;
+        const char* str = AsUtf8(&len);
+        string_hash_ = HashUtf8(str, len);
+      }
+      return string_hash_;
+    case PP_VARTYPE_OBJECT:
+    case PP_VARTYPE_BINARY_ARRAY:
+      return static_cast<uint32_t>(var_.value.as_id);
+    default:
+      return 0;
+  }
+}
+
+void* Var::AsBinaryArray(PP_BinaryArrayType* type, uint32_t* count) const {
+  if (!is_binary_array()) {
+    PP_NOTREACHED();
+    *count = 0;
+    return NULL;
+  }
+
+  if (!ppb_var_f) {
+    *count = 0;
+    return NULL;
+  }
+  return ppb_var_f->BinaryArrayData(var_, type, count);
+}
+
+uint8_t* Var::AsUint8Array(uint32_t* count) const {
+  return static_cast<uint8_t*>(
+      GetBinaryArrayOfType(PP_BINARYARRAYTYPE_UINT8, count));
+}
+
+int32_t* Var::AsInt32Array(uint32_t* count) const {
+  return static_cast<int32_t*>(
+      GetBinaryArrayOfType(PP_BINARYARRAYTYPE_INT32, count));
+}
+
+float* Var::AsFloat32Array(uint32_t* count) const {
+  return static_cast<float*>(
+      GetBinaryArrayOfType(PP_BINARYARRAYTYPE_FLOAT32, count));
+}
+
+double* Var::AsFloat64Array(uint32_t* count) const {
+  return static_cast<double*>(
+      GetBinaryArrayOfType(PP_BINARYARRAYTYPE_FLOAT64, count));
+}
+
 ScriptableObject* Var::AsScriptableObject() const {
   if (!is_object()) {
     PP_NOTREACHED();
@@ -242,13 +368,65 @@ void Var::GetAllPropertyNames(std::vector<Var>* properties,
   if (!prop_count)
     return;
   properties->resize(prop_count);
-  for (uint32_t i = 0; i < prop_count; ++i) {
-    Var temp(PassRef(), props[i]);
-    (*properties)[i] = temp;
-  }
+  for (uint32_t i = 0; i < prop_count; ++i)
+    (*properties)[i].Adopt(props[i]);
   Module::Get()->core()->MemFree(props);
 }
 
+void Var::GetProperties(const std::vector<Var>& names,
+                        std::vector<Var>* values,
+                        Var* exception) const {
+  values->clear();
+  if (!ppb_var_f || names.empty())
+    return;
+  uint32_t count = static_cast<uint32_t>(names.size());
+  std::vector<PP_Var> pp_names(count);
+  for (uint32_t i = 0; i < count; ++i)
+    pp_names[i] = names[i].var_;
+  std::vector<PP_Var> pp_values(count);
+  ppb_var_f->GetProperties(var_, count, &pp_names[0], &pp_values[0],
+                           OutException(exception).get());
+  values->resize(count);
+  for (uint32_t i = 0; i < count; ++i)
+    (*values)[i].Adopt(pp_values[i]);
+}
+
+void Var::SetProperties(const std::vector<std::pair<Var, Var> >& properties,
+                        Var* exception) {
+  if (!ppb_var_f || properties.empty())
+    return;
+  uint32_t count = static_cast<uint32_t>(properties.size());
+  std::vector<PP_Var> pp_names(count);
+  std::vector<PP_Var> pp_values(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    pp_names[i] = properties[i].first.var_;
+    pp_values[i] = properties[i].second.var_;
+  }
+  ppb_var_f->SetProperties(var_, count, &pp_names[0], &pp_values[0],
+                           OutException(exception).get());
+}
+
+void Var::GetAllProperties(std::vector<std::pair<Var, Var> >* properties,
+                           Var* exception) const {
+  properties->clear();
+  if (!ppb_var_f)
+    return;
+  PP_Var* names = NULL;
+  PP_Var* values = NULL;
+  uint32_t count = 0;
+  ppb_var_f->GetAllProperties(var_, &count, &names, &values,
+                              OutException(exception).get());
+  if (!count)
+    return;
+  properties->resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    (*properties)[i].first.Adopt(names[i]);
+    (*properties)[i].second.Adopt(values[i]);
+  }
+  Module::Get()->core()->MemFree(names);
+  Module::Get()->core()->MemFree(values);
+}
+
 void Var::SetProperty(const Var& name, const Var& value, Var* exception) {
   if (!ppb_var_f)
     return;
@@ -340,25 +518,52 @@ Var Var::Call(const Var& method_name, const Var& arg1, const Var& arg2,
                                         OutException(exception).get()));
 }
 
+void Var::Adopt(PP_Var var) {
+  if (needs_release_ && ppb_var_f)
+    ppb_var_f->Release(var_);
+  var_ = var;
+  needs_release_ = true;
+  string_hash_ = 0;
+}
+
+void* Var::GetBinaryArrayOfType(PP_BinaryArrayType type,
+                                 uint32_t* count) const {
+  PP_BinaryArrayType actual_type;
+  void* data = NULL;
+  if (is_binary_array() && ppb_var_f)
+    data = ppb_var_f->BinaryArrayData(var_, &actual_type, count);
+  if (!data || actual_type != type) {
+    *count = 0;
+    return NULL;
+  }
+  return data;
+}
+
 std::string Var::DebugString() const {
   char buf[256];
-  if (is_undefined())
+  if (is_undefined()) {
     snprintf(buf, sizeof(buf), "Var<UNDEFINED>");
-  else if (is_null())
+  } else if (is_null()) {
     snprintf(buf, sizeof(buf), "Var<NULL>");
-  else if (is_bool())
+  } else if (is_bool()) {
     snprintf(buf, sizeof(buf), AsBool() ? "Var<true>" : "Var<false>");
-  else if (is_int())
+  } else if (is_int()) {
     // Note that the following static_cast is necessary because
     // NativeClient's int32_t is actually "long".
     // TODO(sehr,polina): remove this after newlib is changed.
     snprintf(buf, sizeof(buf), "Var<%d>", static_cast<int>(AsInt()));
-  else if (is_double())
+  } else if (is_double()) {
     snprintf(buf, sizeof(buf), "Var<%f>", AsDouble());
-  else if (is_string())
-    snprintf(buf, sizeof(buf), "Var<'%s'>", AsString().c_str());
-  else if (is_object())
+  } else if (is_string()) {
+    uint32_t len;
+    const char* str = AsUtf8(&len);
+    snprintf(buf, sizeof(buf), "Var<'%.*s'>", static_cast<int>(len),
+             str ? str : "");
+  } else if (is_object()) {
     snprintf(buf, sizeof(buf), "Var<OBJECT>");
+  } else if (is_binary_array()) {
+    snprintf(buf, sizeof(buf), "Var<BINARY_ARRAY>");
+  }
   return buf;
 }
 
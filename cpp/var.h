@@ -6,8 +6,10 @@
 #define PPAPI_CPP_VAR_H_
 
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "ppapi/c/dev/ppb_var_deprecated.h"
 #include "ppapi/c/pp_var.h"
 
 namespace pp {
@@ -27,6 +29,13 @@ class Var {
   Var(double d);
   Var(const char* utf8_str);  // Must be encoded in UTF-8.
   Var(const std::string& utf8_str);  // Must be encoded in UTF-8.
+  // Makes a string of the |len| bytes of UTF-8 at |utf8_str|, which needn't
+  // be null-terminated.
+  Var(const char* utf8_str, uint32_t len);
+
+  // Makes a binary array of |count| elements of |type|, copied from |data|,
+  // or zeroed if |data| is NULL.
+  Var(PP_BinaryArrayType type, uint32_t count, const void* data);
 
   // This magic constructor is used when we've gotten a PP_Var as a return
   // value that has already been addref'ed for us.
@@ -34,6 +43,7 @@ class Var {
   Var(PassRef, PP_Var var) {
     var_ = var;
     needs_release_ = true;
+    string_hash_ = 0;
   }
 
   // TODO(brettw): remove DontManage when this bug is fixed
@@ -46,6 +56,7 @@ class Var {
   Var(DontManage, PP_Var var) {
     var_ = var;
     needs_release_ = false;
+    string_hash_ = 0;
   }
 
   // Takes ownership of the given pointer.
@@ -64,6 +75,9 @@ class Var {
   bool is_bool() const { return var_.type == PP_VARTYPE_BOOL; }
   bool is_string() const { return var_.type == PP_VARTYPE_STRING; }
   bool is_object() const { return var_.type == PP_VARTYPE_OBJECT; }
+  bool is_binary_array() const {
+    return var_.type == PP_VARTYPE_BINARY_ARRAY;
+  }
 
   // IsInt and IsDouble return the internal representation. The JavaScript
   // runtime may convert between the two as needed, so the distinction may
@@ -96,6 +110,32 @@ class Var {
   // in debug mode, and return an empty string.
   std::string AsString() const;
 
+  // Returns the UTF-8 contents of a string var and puts their length in
+  // |*len|, without copying them. The data belongs to the string, so it's
+  // only valid while this Var holds its reference, and may contain nulls.
+  // Returns NULL with a length of 0 if the var isn't a string.
+  const char* AsUtf8(uint32_t* len) const;
+
+  // Returns a hash that is the same for Vars that compare equal. For
+  // strings it's computed from the contents the first time it's asked for,
+  // and kept with the Var and its copies.
+  uint32_t Hash() const;
+
+  // This assumes the object is of type binary array. If it's not, it will
+  // assert in debug mode, and return NULL with a |*count| of 0. Otherwise
+  // returns the elements, which can be read and written in place, and puts
+  // their type in |*type| and their number in |*count|. Like AsUtf8, the
+  // pointer is only valid while this Var holds its reference.
+  void* AsBinaryArray(PP_BinaryArrayType* type, uint32_t* count) const;
+
+  // Typed views of the elements of a binary array. These return NULL with a
+  // |*count| of 0 if the var isn't a binary array of that element type, so
+  // they can also be used to check the type.
+  uint8_t* AsUint8Array(uint32_t* count) const;
+  int32_t* AsInt32Array(uint32_t* count) const;
+  float* AsFloat32Array(uint32_t* count) const;
+  double* AsFloat64Array(uint32_t* count) const;
+
   // This assumes the object is of type object. If it's not, it will assert in
   // debug mode. If it is not an object or not a ScriptableObject type, returns
   // NULL.
@@ -107,6 +147,20 @@ class Var {
   void GetAllPropertyNames(std::vector<Var>* properties,
                            Var* exception = NULL) const;
   void SetProperty(const Var& name, const Var& value, Var* exception = NULL);
+
+  // Gets or sets many properties at once. For an object in another process
+  // each of these is one round trip, however many properties there are.
+  // |values| gets one value per name; if a property throws, it and the ones
+  // after it are undefined.
+  void GetProperties(const std::vector<Var>& names,
+                     std::vector<Var>* values,
+                     Var* exception = NULL) const;
+  void SetProperties(const std::vector<std::pair<Var, Var> >& properties,
+                     Var* exception = NULL);
+  // Gets the names GetAllPropertyNames would, each with its value.
+  void GetAllProperties(std::vector<std::pair<Var, Var> >* properties,
+                        Var* exception = NULL) const;
+
   void RemoveProperty(const Var& name, Var* exception = NULL);
   Var Call(const Var& method_name, uint32_t argc, Var* argv,
            Var* exception = NULL);
@@ -134,6 +188,7 @@ class Var {
     PP_Var ret = var_;
     var_ = PP_MakeUndefined();
     needs_release_ = false;
+    string_hash_ = 0;
     return ret;
   }
 
@@ -196,8 +251,18 @@ class Var {
   // get a compilation error.
   Var(void* non_scriptable_object_pointer);
 
+  // Replaces the value with |var|, taking over the reference that was
+  // AddRef'ed for the caller, like the PassRef constructor.
+  void Adopt(PP_Var var);
+
+  // Backs the typed views: the elements if this is a binary array of |type|.
+  void* GetBinaryArrayOfType(PP_BinaryArrayType type, uint32_t* count) const;
+
   PP_Var var_;
   bool needs_release_;
+
+  // Hash of the contents of a string var, or 0 when it hasn't been computed.
+  mutable uint32_t string_hash_;
 };
 
 }  // namespace pp
@@ -0,0 +1,1034 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/cpp/var_json.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <limits>
+#include <utility>
+
+#include "ppapi/cpp/dev/scriptable_object_deprecated.h"
+#include "ppapi/cpp/logging.h"
+
+// Defining snprintf
+#include <stdio.h>
+#if defined(_MSC_VER)
+#  define snprintf _snprintf_s
+#endif
+
+namespace {
+
+using pp::Var;
+using pp::VarJSON;
+using pp::deprecated::ScriptableObject;
+
+// Strings are scanned a word at a time, looking for the bytes that end a run
+// of plain characters: a quote, a backslash or a control character. These
+// find whether a word has any, from the borrows out of each byte when 1 or
+// 0x20 is taken from all of them. They're built up without long long
+// literals, which -pedantic rejects in C++98.
+const uint64_t kLowBits = ~static_cast<uint64_t>(0) / 255;  // 0x0101...01
+const uint64_t kHighBits = kLowBits * 0x80;  // 0x8080...80
+
+inline bool HasSpecialByte(uint64_t word) {
+  uint64_t quote = word ^ (kLowBits * '"');
+  uint64_t backslash = word ^ (kLowBits * '\\');
+  return (((quote - kLowBits) & ~quote) |
+          ((backslash - kLowBits) & ~backslash) |
+          ((word - kLowBits * 0x20) & ~word)) & kHighBits;
+}
+
+inline bool IsSpecialByte(unsigned char c) {
+  return c == '"' || c == '\\' || c < 0x20;
+}
+
+// Returns how many of the |len| bytes at |data| come before the first
+// special byte.
+uint32_t PlainRun(const char* data, uint32_t len) {
+  uint32_t i = 0;
+  while (len - i >= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    if (HasSpecialByte(word))
+      break;
+    i += sizeof(word);
+  }
+  while (i < len && !IsSpecialByte(static_cast<unsigned char>(data[i])))
+    i++;
+  return i;
+}
+
+inline bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// FNV-1a, for the key cache of TreeBuilder.
+uint32_t HashBytes(const char* data, uint32_t len) {
+  uint32_t hash = 2166136261u;
+  for (uint32_t i = 0; i < len; i++)
+    hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+  return hash;
+}
+
+// Script may name a property with an integer; this makes it a string.
+Var PropertyName(const Var& name) {
+  if (!name.is_int())
+    return name;
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%d", static_cast<int>(name.AsInt()));
+  return Var(buffer);
+}
+
+// Gets the array index a property name stands for: a non-negative integer,
+// or a string of up to 9 digits without leading zeros.
+bool IndexFromName(const Var& name, uint32_t* index) {
+  if (name.is_int()) {
+    if (name.AsInt() < 0)
+      return false;
+    *index = static_cast<uint32_t>(name.AsInt());
+    return true;
+  }
+  if (!name.is_string())
+    return false;
+  uint32_t len;
+  const char* data = name.AsUtf8(&len);
+  if (!data || len == 0 || len > 9 || (data[0] == '0' && len > 1))
+    return false;
+  uint32_t value = 0;
+  for (uint32_t i = 0; i < len; i++) {
+    if (!IsDigit(data[i]))
+      return false;
+    value = value * 10 + (data[i] - '0');
+  }
+  *index = value;
+  return true;
+}
+
+bool IsLength(const Var& name) {
+  if (!name.is_string())
+    return false;
+  uint32_t len;
+  const char* data = name.AsUtf8(&len);
+  return len == 6 && memcmp(data, "length", 6) == 0;
+}
+
+// An object made by Parse. The properties are kept in the order they were
+// added, and found through a table of their indices hashed by name.
+class ParsedObject : public ScriptableObject {
+ public:
+  ParsedObject() {}
+
+  // Sets the property named by the string |name|, adding it if it's new.
+  void Put(const Var& name, const Var& value) {
+    int32_t index = Find(name);
+    if (index >= 0) {
+      values_[index] = value;
+      return;
+    }
+    names_.push_back(name);
+    values_.push_back(value);
+    if (names_.size() * 2 > slots_.size())
+      Rebuild();
+    else
+      Insert(names_.size() - 1);
+  }
+
+  // ScriptableObject implementation.
+  virtual bool HasProperty(const Var& name, Var* /*exception*/) {
+    return Find(PropertyName(name)) >= 0;
+  }
+  virtual Var GetProperty(const Var& name, Var* /*exception*/) {
+    int32_t index = Find(PropertyName(name));
+    return index < 0 ? Var() : values_[index];
+  }
+  virtual void GetAllPropertyNames(std::vector<Var>* properties,
+                                   Var* /*exception*/) {
+    properties->insert(properties->end(), names_.begin(), names_.end());
+  }
+  virtual void SetProperty(const Var& name,
+                           const Var& value,
+                           Var* exception) {
+    Var key = PropertyName(name);
+    if (!key.is_string()) {
+      *exception = Var("Property names must be strings or integers");
+      return;
+    }
+    Put(key, value);
+  }
+  virtual void RemoveProperty(const Var& name, Var* /*exception*/) {
+    int32_t index = Find(PropertyName(name));
+    if (index < 0)
+      return;
+    names_.erase(names_.begin() + index);
+    values_.erase(values_.begin() + index);
+    Rebuild();
+  }
+
+ private:
+  // Returns the index of the property |name|, or -1.
+  int32_t Find(const Var& name) const {
+    if (slots_.empty() || !name.is_string())
+      return -1;
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = name.Hash() & mask; slots_[slot] >= 0;
+         slot = (slot + 1) & mask) {
+      if (names_[slots_[slot]] == name)
+        return slots_[slot];
+    }
+    return -1;
+  }
+
+  void Insert(size_t index) {
+    size_t mask = slots_.size() - 1;
+    size_t slot = names_[index].Hash() & mask;
+    while (slots_[slot] >= 0)
+      slot = (slot + 1) & mask;
+    slots_[slot] = static_cast<int32_t>(index);
+  }
+
+  // Sizes the table to at least twice the number of properties and refills
+  // it.
+  void Rebuild() {
+    size_t size = 8;
+    while (size < names_.size() * 2)
+      size *= 2;
+    slots_.assign(size, -1);
+    for (size_t i = 0; i < names_.size(); i++)
+      Insert(i);
+  }
+
+  std::vector<Var> names_;
+  std::vector<Var> values_;
+
+  // Indices into |names_|, open addressed; -1 for empty slots. The size is
+  // a power of two.
+  std::vector<int32_t> slots_;
+};
+
+// An array made by Parse. It has the elements as properties named by their
+// indices, and a length. Elements can be set up to one past the last.
+class ParsedArray : public ScriptableObject {
+ public:
+  ParsedArray() {}
+
+  void Push(const Var& value) { elements_.push_back(value); }
+
+  // ScriptableObject implementation.
+  virtual bool HasProperty(const Var& name, Var* /*exception*/) {
+    uint32_t index;
+    if (IndexFromName(name, &index))
+      return index < elements_.size();
+    return IsLength(name);
+  }
+  virtual Var GetProperty(const Var& name, Var* /*exception*/) {
+    uint32_t index;
+    if (IndexFromName(name, &index))
+      return index < elements_.size() ? elements_[index] : Var();
+    if (IsLength(name))
+      return Var(static_cast<int32_t>(elements_.size()));
+    return Var();
+  }
+  virtual void GetAllPropertyNames(std::vector<Var>* properties,
+                                   Var* /*exception*/) {
+    for (size_t i = 0; i < elements_.size(); i++)
+      properties->push_back(Var(static_cast<int32_t>(i)));
+  }
+  virtual void SetProperty(const Var& name,
+                           const Var& value,
+                           Var* exception) {
+    uint32_t index;
+    if (!IndexFromName(name, &index) || index > elements_.size()) {
+      *exception = Var("Only the elements of an array up to one past the "
+                       "last can be set");
+      return;
+    }
+    if (index == elements_.size())
+      elements_.push_back(value);
+    else
+      elements_[index] = value;
+  }
+  virtual void RemoveProperty(const Var& name, Var* /*exception*/) {
+    uint32_t index;
+    if (IndexFromName(name, &index) && index < elements_.size())
+      elements_[index] = Var();
+  }
+
+ private:
+  std::vector<Var> elements_;
+};
+
+// Builds the tree of Vars for Parse.
+class TreeBuilder : public VarJSON::Handler {
+ public:
+  TreeBuilder() {}
+
+  const Var& result() const { return result_; }
+
+  // VarJSON::Handler implementation.
+  virtual bool OnNull() { return Add(Var(Var::Null())); }
+  virtual bool OnBool(bool value) { return Add(Var(value)); }
+  virtual bool OnInt(int32_t value) { return Add(Var(value)); }
+  virtual bool OnDouble(double value) { return Add(Var(value)); }
+  virtual bool OnString(const char* data, uint32_t len) {
+    // The string is null if it isn't valid UTF-8.
+    Var string(data, len);
+    return string.is_string() && Add(string);
+  }
+  virtual bool OnBeginObject() {
+    Container container = { new ParsedObject, NULL };
+    // The parent, or |result_|, owns the new object from here.
+    Var object(container.object);
+    if (!object.is_object() || !Add(object))
+      return false;
+    stack_.push_back(container);
+    return true;
+  }
+  virtual bool OnKey(const char* data, uint32_t len) {
+    key_ = CachedKey(data, len);
+    return key_.is_string();
+  }
+  virtual bool OnEndObject() {
+    stack_.pop_back();
+    return true;
+  }
+  virtual bool OnBeginArray() {
+    Container container = { NULL, new ParsedArray };
+    Var array(container.array);
+    if (!array.is_object() || !Add(array))
+      return false;
+    stack_.push_back(container);
+    return true;
+  }
+  virtual bool OnEndArray() {
+    stack_.pop_back();
+    return true;
+  }
+
+ private:
+  // Objects and arrays that are still being filled in. Exactly one of the
+  // pointers is set.
+  struct Container {
+    ParsedObject* object;
+    ParsedArray* array;
+  };
+
+  // The number of keys kept by CachedKey; a power of two.
+  static const uint32_t kKeyCacheSize = 64;
+
+  // Adds |value| to the innermost container, under |key_| if it's an
+  // object.
+  bool Add(const Var& value) {
+    if (stack_.empty())
+      result_ = value;
+    else if (stack_.back().array)
+      stack_.back().array->Push(value);
+    else
+      stack_.back().object->Put(key_, value);
+    return true;
+  }
+
+  // Returns a string var of the key, reusing the one made for an earlier
+  // key with the same bytes if it's still in the cache. Arrays of objects
+  // repeat the same few keys many times.
+  const Var& CachedKey(const char* data, uint32_t len) {
+    Var& cached = key_cache_[HashBytes(data, len) & (kKeyCacheSize - 1)];
+    if (cached.is_string()) {
+      uint32_t cached_len;
+      const char* cached_data = cached.AsUtf8(&cached_len);
+      if (cached_len == len &&
+          (len == 0 || memcmp(cached_data, data, len) == 0))
+        return cached;
+    }
+    cached = Var(data, len);
+    // Copies of the key keep the hash, which ParsedObject needs.
+    if (cached.is_string())
+      cached.Hash();
+    return cached;
+  }
+
+  Var result_;
+  Var key_;
+  std::vector<Container> stack_;
+  Var key_cache_[kKeyCacheSize];
+
+  // Disallow copy and assign (these are unimplemented).
+  TreeBuilder(const TreeBuilder&);
+  TreeBuilder& operator=(const TreeBuilder&);
+};
+
+// A recursive descent parser of RFC 4627 JSON, with any value allowed at the
+// top, feeding a VarJSON::Handler.
+class Parser {
+ public:
+  Parser(const char* json, uint32_t len, VarJSON::Handler* handler)
+      : p_(json), end_(json + len), handler_(handler) {}
+
+  bool Parse() {
+    SkipWhitespace();
+    if (!ParseValue(0))
+      return false;
+    SkipWhitespace();
+    return p_ == end_;
+  }
+
+ private:
+  void SkipWhitespace() {
+    while (p_ < end_ &&
+           (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t'))
+      p_++;
+  }
+
+  // Parses a value in a container |depth| deep.
+  bool ParseValue(uint32_t depth) {
+    if (p_ == end_)
+      return false;
+    switch (*p_) {
+      case '{':
+        return ParseObject(depth + 1);
+      case '[':
+        return ParseArray(depth + 1);
+      case '"': {
+        const char* data;
+        uint32_t len;
+        return ParseString(&data, &len) && handler_->OnString(data, len);
+      }
+      case 't':
+        return ParseLiteral("true", 4) && handler_->OnBool(true);
+      case 'f':
+        return ParseLiteral("false", 5) && handler_->OnBool(false);
+      case 'n':
+        return ParseLiteral("null", 4) && handler_->OnNull();
+      default:
+        return ParseNumber();
+    }
+  }
+
+  bool ParseObject(uint32_t depth) {
+    if (depth > VarJSON::kMaxDepth)
+      return false;
+    p_++;  // '{'
+    if (!handler_->OnBeginObject())
+      return false;
+    SkipWhitespace();
+    if (p_ < end_ && *p_ == '}') {
+      p_++;
+      return handler_->OnEndObject();
+    }
+    for (;;) {
+      if (p_ == end_ || *p_ != '"')
+        return false;
+      const char* key;
+      uint32_t key_len;
+      if (!ParseString(&key, &key_len) || !handler_->OnKey(key, key_len))
+        return false;
+      SkipWhitespace();
+      if (p_ == end_ || *p_ != ':')
+        return false;
+      p_++;
+      SkipWhitespace();
+      if (!ParseValue(depth))
+        return false;
+      SkipWhitespace();
+      if (p_ == end_)
+        return false;
+      if (*p_ == '}') {
+        p_++;
+        return handler_->OnEndObject();
+      }
+      if (*p_ != ',')
+        return false;
+      p_++;
+      SkipWhitespace();
+    }
+  }
+
+  bool ParseArray(uint32_t depth) {
+    if (depth > VarJSON::kMaxDepth)
+      return false;
+    p_++;  // '['
+    if (!handler_->OnBeginArray())
+      return false;
+    SkipWhitespace();
+    if (p_ < end_ && *p_ == ']') {
+      p_++;
+      return handler_->OnEndArray();
+    }
+    for (;;) {
+      if (!ParseValue(depth))
+        return false;
+      SkipWhitespace();
+      if (p_ == end_)
+        return false;
+      if (*p_ == ']') {
+        p_++;
+        return handler_->OnEndArray();
+      }
+      if (*p_ != ',')
+        return false;
+      p_++;
+      SkipWhitespace();
+    }
+  }
+
+  // Parses the string at |p_| and points |*data| at its |*len| bytes: the
+  // text itself if there are no escapes, otherwise |scratch_| with them
+  // decoded.
+  bool ParseString(const char** data, uint32_t* len) {
+    const char* start = ++p_;
+    uint32_t run = PlainRun(p_, static_cast<uint32_t>(end_ - p_));
+    p_ += run;
+    if (p_ < end_ && *p_ == '"') {
+      p_++;
+      *data = start;
+      *len = run;
+      return true;
+    }
+    scratch_.assign(start, run);
+    while (p_ < end_) {
+      if (*p_ == '"') {
+        p_++;
+        *data = scratch_.data();
+        *len = static_cast<uint32_t>(scratch_.size());
+        return true;
+      }
+      // Control characters have to be escaped.
+      if (*p_ != '\\')
+        return false;
+      p_++;
+      if (!ParseEscape())
+        return false;
+      run = PlainRun(p_, static_cast<uint32_t>(end_ - p_));
+      scratch_.append(p_, run);
+      p_ += run;
+    }
+    return false;
+  }
+
+  // Decodes the escape after a backslash onto |scratch_|.
+  bool ParseEscape() {
+    if (p_ == end_)
+      return false;
+    char c = *p_++;
+    switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        scratch_.push_back(c);
+        return true;
+      case 'b':
+        scratch_.push_back('\b');
+        return true;
+      case 'f':
+        scratch_.push_back('\f');
+        return true;
+      case 'n':
+        scratch_.push_back('\n');
+        return true;
+      case 'r':
+        scratch_.push_back('\r');
+        return true;
+      case 't':
+        scratch_.push_back('\t');
+        return true;
+      case 'u':
+        break;
+      default:
+        return false;
+    }
+    uint32_t code_point;
+    if (!ParseHex4(&code_point))
+      return false;
+    // Characters past the BMP are escaped as a surrogate pair. A surrogate
+    // on its own can't be UTF-8.
+    if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+      return false;
+    if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+      uint32_t low;
+      if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u')
+        return false;
+      p_ += 2;
+      if (!ParseHex4(&low) || low < 0xDC00 || low > 0xDFFF)
+        return false;
+      code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+    }
+    AppendUtf8(code_point);
+    return true;
+  }
+
+  bool ParseHex4(uint32_t* value) {
+    if (end_ - p_ < 4)
+      return false;
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+      char c = *p_++;
+      uint32_t digit;
+      if (c >= '0' && c <= '9')
+        digit = c - '0';
+      else if (c >= 'a' && c <= 'f')
+        digit = c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+        digit = c - 'A' + 10;
+      else
+        return false;
+      *value = *value * 16 + digit;
+    }
+    return true;
+  }
+
+  void AppendUtf8(uint32_t code_point) {
+    if (code_point < 0x80) {
+      scratch_.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+      scratch_.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+      scratch_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+      scratch_.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+      scratch_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+      scratch_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+      scratch_.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+      scratch_.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+      scratch_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+      scratch_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+  }
+
+  bool ParseNumber() {
+    const char* start = p_;
+    bool negative = false;
+    if (p_ < end_ && *p_ == '-') {
+      negative = true;
+      p_++;
+    }
+    const char* digits = p_;
+    if (p_ == end_ || !IsDigit(*p_))
+      return false;
+    if (*p_ == '0') {
+      p_++;
+    } else {
+      while (p_ < end_ && IsDigit(*p_))
+        p_++;
+    }
+    const char* digits_end = p_;
+    bool integral = true;
+    if (p_ < end_ && *p_ == '.') {
+      p_++;
+      if (p_ == end_ || !IsDigit(*p_))
+        return false;
+      while (p_ < end_ && IsDigit(*p_))
+        p_++;
+      integral = false;
+    }
+    if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+      p_++;
+      if (p_ < end_ && (*p_ == '+' || *p_ == '-'))
+        p_++;
+      if (p_ == end_ || !IsDigit(*p_))
+        return false;
+      while (p_ < end_ && IsDigit(*p_))
+        p_++;
+      integral = false;
+    }
+    // Integers of up to 10 digits are added up here; the ones that fit, but
+    // for -0, are ints.
+    if (integral && digits_end - digits <= 10) {
+      int64_t value = 0;
+      for (const char* d = digits; d < digits_end; d++)
+        value = value * 10 + (*d - '0');
+      if (negative)
+        value = -value;
+      if (value >= std::numeric_limits<int32_t>::min() &&
+          value <= std::numeric_limits<int32_t>::max() &&
+          !(negative && value == 0))
+        return handler_->OnInt(static_cast<int32_t>(value));
+    }
+    // strtod needs the number on its own.
+    size_t len = p_ - start;
+    char buffer[64];
+    double number;
+    if (len < sizeof(buffer)) {
+      memcpy(buffer, start, len);
+      buffer[len] = '\0';
+      number = strtod(buffer, NULL);
+    } else {
+      number = strtod(std::string(start, len).c_str(), NULL);
+    }
+    return handler_->OnDouble(number);
+  }
+
+  bool ParseLiteral(const char* literal, uint32_t len) {
+    if (static_cast<size_t>(end_ - p_) < len || memcmp(p_, literal, len) != 0)
+      return false;
+    p_ += len;
+    return true;
+  }
+
+  const char* p_;
+  const char* end_;
+  VarJSON::Handler* handler_;
+
+  // Strings with escapes are decoded here.
+  std::string scratch_;
+
+  // Disallow copy and assign (these are unimplemented).
+  Parser(const Parser&);
+  Parser& operator=(const Parser&);
+};
+
+// Whether an object with |properties| is an array: the properties are the
+// indices from 0, in order, and it has a length that isn't enumerated.
+bool IsArray(const Var& object,
+             const std::vector<std::pair<Var, Var> >& properties) {
+  for (size_t i = 0; i < properties.size(); i++) {
+    uint32_t index;
+    if (!IndexFromName(properties[i].first, &index) || index != i)
+      return false;
+  }
+  return object.HasProperty(Var("length"));
+}
+
+}  // namespace
+
+namespace pp {
+
+const uint32_t VarJSON::kMaxDepth;
+
+VarJSON::Writer::Writer(std::string* out) : out_(out), after_key_(false) {
+}
+
+VarJSON::Writer::~Writer() {
+}
+
+void VarJSON::Writer::BeginObject() {
+  Separate();
+  out_->push_back('{');
+  empty_.push_back(true);
+}
+
+void VarJSON::Writer::EndObject() {
+  PP_DCHECK(!empty_.empty() && !after_key_);
+  empty_.pop_back();
+  out_->push_back('}');
+}
+
+void VarJSON::Writer::BeginArray() {
+  Separate();
+  out_->push_back('[');
+  empty_.push_back(true);
+}
+
+void VarJSON::Writer::EndArray() {
+  PP_DCHECK(!empty_.empty());
+  empty_.pop_back();
+  out_->push_back(']');
+}
+
+void VarJSON::Writer::Key(const char* utf8, uint32_t len) {
+  Separate();
+  WriteString(utf8, len);
+  out_->push_back(':');
+  after_key_ = true;
+}
+
+void VarJSON::Writer::Key(const char* utf8) {
+  Key(utf8, static_cast<uint32_t>(strlen(utf8)));
+}
+
+void VarJSON::Writer::Null() {
+  Separate();
+  out_->append("null", 4);
+}
+
+void VarJSON::Writer::Bool(bool value) {
+  Separate();
+  if (value)
+    out_->append("true", 4);
+  else
+    out_->append("false", 5);
+}
+
+void VarJSON::Writer::Int(int32_t value) {
+  Separate();
+  char buffer[16];
+  char* end = buffer + sizeof(buffer);
+  char* p = end;
+  uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value) :
+                                   static_cast<uint32_t>(value);
+  do {
+    *--p = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude);
+  if (value < 0)
+    *--p = '-';
+  out_->append(p, end - p);
+}
+
+void VarJSON::Writer::Double(double value) {
+  // NaN and the infinities aren't finite differences from themselves.
+  if (value - value != 0) {
+    Null();
+    return;
+  }
+  // Whole numbers within the range of int64_t are written as integers, as
+  // JSON.stringify does.
+  if (value == floor(value) && fabs(value) < 1e18) {
+    Separate();
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    uint64_t magnitude = static_cast<uint64_t>(fabs(value));
+    do {
+      *--p = static_cast<char>('0' + magnitude % 10);
+      magnitude /= 10;
+    } while (magnitude);
+    if (value < 0)
+      *--p = '-';
+    out_->append(p, end - p);
+    return;
+  }
+  // Most numbers have a short decimal form, n / 10^k for a small k. When
+  // the division gives |value| back, that's the number strtod reads from
+  // the decimal, as the division is rounded correctly and n and 10^k are
+  // exact.
+  static const double kPowersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8
+  };
+  double magnitude = fabs(value);
+  for (int k = 1; k <= 8 && magnitude * kPowersOf10[k] < 9007199254740992.0;
+       k++) {
+    double scaled = floor(magnitude * kPowersOf10[k] + 0.5);
+    if (scaled / kPowersOf10[k] != magnitude)
+      continue;
+    Separate();
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    uint64_t digits = static_cast<uint64_t>(scaled);
+    for (int i = 0; i < k; i++) {
+      *--p = static_cast<char>('0' + digits % 10);
+      digits /= 10;
+    }
+    *--p = '.';
+    do {
+      *--p = static_cast<char>('0' + digits % 10);
+      digits /= 10;
+    } while (digits);
+    if (value < 0)
+      *--p = '-';
+    out_->append(p, end - p);
+    return;
+  }
+  // Otherwise the shorter of the two forms that read back the same.
+  Separate();
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.15g", value);
+  if (strtod(buffer, NULL) != value)
+    snprintf(buffer, sizeof(buffer), "%.17g", value);
+  out_->append(buffer);
+}
+
+void VarJSON::Writer::String(const char* utf8, uint32_t len) {
+  Separate();
+  WriteString(utf8, len);
+}
+
+void VarJSON::Writer::String(const char* utf8) {
+  String(utf8, static_cast<uint32_t>(strlen(utf8)));
+}
+
+bool VarJSON::Writer::Value(const Var& value) {
+  return WriteValue(value, 0);
+}
+
+void VarJSON::Writer::Separate() {
+  if (after_key_) {
+    after_key_ = false;
+    return;
+  }
+  if (empty_.empty())
+    return;
+  if (!empty_.back())
+    out_->push_back(',');
+  empty_.back() = false;
+}
+
+void VarJSON::Writer::WriteString(const char* utf8, uint32_t len) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  out_->push_back('"');
+  uint32_t i = 0;
+  for (;;) {
+    uint32_t run = PlainRun(utf8 + i, len - i);
+    out_->append(utf8 + i, run);
+    i += run;
+    if (i == len)
+      break;
+    unsigned char c = static_cast<unsigned char>(utf8[i++]);
+    switch (c) {
+      case '"':
+        out_->append("\\\"", 2);
+        break;
+      case '\\':
+        out_->append("\\\\", 2);
+        break;
+      case '\b':
+        out_->append("\\b", 2);
+        break;
+      case '\f':
+        out_->append("\\f", 2);
+        break;
+      case '\n':
+        out_->append("\\n", 2);
+        break;
+      case '\r':
+        out_->append("\\r", 2);
+        break;
+      case '\t':
+        out_->append("\\t", 2);
+        break;
+      default: {
+        char escape[6] = { '\\', 'u', '0', '0',
+                           kHexDigits[c >> 4], kHexDigits[c & 0xF] };
+        out_->append(escape, sizeof(escape));
+        break;
+      }
+    }
+  }
+  out_->push_back('"');
+}
+
+bool VarJSON::Writer::WriteValue(const Var& value, uint32_t depth) {
+  switch (value.pp_var().type) {
+    case PP_VARTYPE_BOOL:
+      Bool(value.AsBool());
+      return true;
+    case PP_VARTYPE_INT32:
+      Int(value.AsInt());
+      return true;
+    case PP_VARTYPE_DOUBLE:
+      Double(value.AsDouble());
+      return true;
+    case PP_VARTYPE_STRING: {
+      uint32_t len;
+      const char* data = value.AsUtf8(&len);
+      String(data ? data : "", len);
+      return true;
+    }
+    case PP_VARTYPE_BINARY_ARRAY: {
+      PP_BinaryArrayType type;
+      uint32_t count;
+      const void* data = value.AsBinaryArray(&type, &count);
+      BeginArray();
+      switch (type) {
+        case PP_BINARYARRAYTYPE_UINT8:
+          for (uint32_t i = 0; i < count; i++)
+            Int(static_cast<const uint8_t*>(data)[i]);
+          break;
+        case PP_BINARYARRAYTYPE_INT32:
+          for (uint32_t i = 0; i < count; i++)
+            Int(static_cast<const int32_t*>(data)[i]);
+          break;
+        case PP_BINARYARRAYTYPE_FLOAT32:
+          for (uint32_t i = 0; i < count; i++)
+            Double(static_cast<const float*>(data)[i]);
+          break;
+        case PP_BINARYARRAYTYPE_FLOAT64:
+          for (uint32_t i = 0; i < count; i++)
+            Double(static_cast<const double*>(data)[i]);
+          break;
+      }
+      EndArray();
+      return true;
+    }
+    case PP_VARTYPE_OBJECT:
+      return WriteObject(value, depth + 1);
+    default:
+      Null();
+      return true;
+  }
+}
+
+bool VarJSON::Writer::WriteObject(const Var& object, uint32_t depth) {
+  if (depth > kMaxDepth)
+    return false;
+  // One call for all the properties, which is one round trip for an object
+  // of the page.
+  std::vector<std::pair<Var, Var> > properties;
+  Var exception;
+  object.GetAllProperties(&properties, &exception);
+  if (!exception.is_undefined())
+    return false;
+  if (IsArray(object, properties)) {
+    BeginArray();
+    for (size_t i = 0; i < properties.size(); i++) {
+      if (!WriteValue(properties[i].second, depth))
+        return false;
+    }
+    EndArray();
+    return true;
+  }
+  BeginObject();
+  for (size_t i = 0; i < properties.size(); i++) {
+    if (properties[i].second.is_undefined())
+      continue;
+    Var name = PropertyName(properties[i].first);
+    if (!name.is_string())
+      continue;
+    uint32_t len;
+    const char* data = name.AsUtf8(&len);
+    Key(data ? data : "", len);
+    if (!WriteValue(properties[i].second, depth))
+      return false;
+  }
+  EndObject();
+  return true;
+}
+
+// static
+bool VarJSON::Parse(const char* json, uint32_t len, Var* result) {
+  TreeBuilder builder;
+  if (!Parser(json, len, &builder).Parse())
+    return false;
+  *result = builder.result();
+  return true;
+}
+
+// static
+bool VarJSON::Parse(const Var& json, Var* result) {
+  if (!json.is_string())
+    return false;
+  uint32_t len;
+  const char* data = json.AsUtf8(&len);
+  if (!data)
+    return false;
+  return Parse(data, len, result);
+}
+
+// static
+bool VarJSON::Parse(const char* json, uint32_t len, Handler* handler) {
+  return Parser(json, len, handler).Parse();
+}
+
+// static
+bool VarJSON::Stringify(const Var& value, std::string* json) {
+  json->clear();
+  Writer writer(json);
+  if (!writer.Value(value)) {
+    json->clear();
+    return false;
+  }
+  return true;
+}
+
+// static
+Var VarJSON::Stringify(const Var& value) {
+  std::string json;
+  if (!Stringify(value, &json))
+    return Var(Var::Null());
+  return Var(json);
+}
+
+}  // namespace pp
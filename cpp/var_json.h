@@ -0,0 +1,150 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_CPP_VAR_JSON_H_
+#define PPAPI_CPP_VAR_JSON_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/var.h"
+
+namespace pp {
+
+// Converts between JSON text and Vars, so that structured data can cross to
+// and from the page as one string instead of a scripting call per property.
+//
+// Parse builds a tree of Vars: objects and arrays become objects owned by
+// the plugin, which support the usual property calls (GetProperty,
+// GetAllProperties, ...) without going back to the browser, and strings are
+// made straight from the bytes of the text. Parse can instead hand the
+// values to a Handler, which can fill the plugin's own structures without
+// making any Vars.
+//
+// Stringify goes the other way for any Var tree, and Writer writes JSON from
+// the plugin's own structures.
+//
+//   pp::Var message;
+//   if (pp::VarJSON::Parse(json_var, &message))
+//     HandleMessage(message.GetProperty("type"), message);
+//   ...
+//   std::string json;
+//   json.reserve(4096);
+//   pp::VarJSON::Writer writer(&json);
+//   writer.BeginObject();
+//   writer.Key("width");
+//   writer.Int(size.width());
+//   writer.EndObject();
+//   page.Call("update", pp::Var(json));
+class VarJSON {
+ public:
+  // Objects and arrays may nest this deep.
+  static const uint32_t kMaxDepth = 256;
+
+  // Receives the values of a document from Parse, in order. An object is
+  // OnBeginObject, then OnKey and the value for each member, then
+  // OnEndObject; an array is the same without the keys. Returning false
+  // stops the parse, which then fails. The default implementations ignore
+  // the value.
+  //
+  // Strings and keys are UTF-8 with the escapes decoded, and are only valid
+  // during the call. Unlike Vars made by Parse, they aren't checked for
+  // valid UTF-8.
+  class Handler {
+   public:
+    virtual ~Handler() {}
+
+    virtual bool OnNull() { return true; }
+    virtual bool OnBool(bool /*value*/) { return true; }
+    // Numbers written as integers that fit come here, others to OnDouble.
+    virtual bool OnInt(int32_t /*value*/) { return true; }
+    virtual bool OnDouble(double /*value*/) { return true; }
+    virtual bool OnString(const char* /*data*/, uint32_t /*len*/) {
+      return true;
+    }
+    virtual bool OnBeginObject() { return true; }
+    virtual bool OnKey(const char* /*data*/, uint32_t /*len*/) {
+      return true;
+    }
+    virtual bool OnEndObject() { return true; }
+    virtual bool OnBeginArray() { return true; }
+    virtual bool OnEndArray() { return true; }
+  };
+
+  // Appends JSON to a string. Reserving the string ahead of time makes the
+  // whole document one allocation. Values in an object must each follow a
+  // Key; the commas are written for you.
+  class Writer {
+   public:
+    explicit Writer(std::string* out);
+    ~Writer();
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    void Key(const char* utf8, uint32_t len);
+    void Key(const char* utf8);
+
+    void Null();
+    void Bool(bool value);
+    void Int(int32_t value);
+    // Infinities and NaN, which JSON doesn't have, are written as null.
+    void Double(double value);
+    void String(const char* utf8, uint32_t len);
+    void String(const char* utf8);
+
+    // Writes |value| and everything under it, as Stringify does. Returns
+    // false, having written part of it, if Stringify would fail.
+    bool Value(const Var& value);
+
+   private:
+    // Writes the comma before a value, if it needs one.
+    void Separate();
+    void WriteString(const char* utf8, uint32_t len);
+    bool WriteValue(const Var& value, uint32_t depth);
+    bool WriteObject(const Var& object, uint32_t depth);
+
+    std::string* out_;
+    // For each open object or array, whether nothing's been written to it.
+    std::vector<bool> empty_;
+    // Whether a key was just written, so the value goes without a comma.
+    bool after_key_;
+
+    // Disallow copy and assign (these are unimplemented).
+    Writer(const Writer&);
+    Writer& operator=(const Writer&);
+  };
+
+  // Parses the |len| bytes of JSON at |json| into |*result|. Returns false,
+  // leaving |*result| alone, if the text isn't JSON, nests deeper than
+  // kMaxDepth, or has a string that isn't valid UTF-8.
+  static bool Parse(const char* json, uint32_t len, Var* result);
+
+  // Parses the string var |json|, which isn't copied.
+  static bool Parse(const Var& json, Var* result);
+
+  // Parses the |len| bytes of JSON at |json| into |handler|. Returns false
+  // if the text isn't JSON, nests deeper than kMaxDepth, or |handler|
+  // stopped it.
+  static bool Parse(const char* json, uint32_t len, Handler* handler);
+
+  // Sets |*json| to |value| as JSON. Like JSON.stringify, a property whose
+  // value is undefined is left out, and other undefined values, infinities
+  // and NaN are written as null. Binary arrays are written as arrays of
+  // numbers. An object is an array if its properties are "0" up to "n-1",
+  // in order, and it has a length. Returns false, emptying |*json|, if
+  // getting the properties of an object throws or objects nest deeper than
+  // kMaxDepth, as they do when they refer back to themselves.
+  static bool Stringify(const Var& value, std::string* json);
+
+  // Returns |value| as a JSON string var, or a null var if Stringify fails.
+  static Var Stringify(const Var& value);
+};
+
+}  // namespace pp
+
+#endif  // PPAPI_CPP_VAR_JSON_H_
@@ -6,6 +6,8 @@
 {
   'variables': {
     'chromium_code': 1,  # Use higher warning level.
+    # Compiles in pp::InstanceRecorder_Dev; see instance_recorder_dev.h.
+    'ppapi_instance_recording%': 0,
   },
   'target_defaults': {
     'conditions': [
@@ -38,6 +40,7 @@
         'c/pp_errors.h',
         'c/pp_input_event.h',
         'c/pp_instance.h',
+        'c/pp_macros.h',
         'c/pp_module.h',
         'c/pp_point.h',
         'c/pp_rect.h',
@@ -76,6 +79,7 @@
         'c/dev/ppb_font_dev.h',
         'c/dev/ppb_fullscreen_dev.h',
         'c/dev/ppb_graphics_3d_dev.h',
+        'c/dev/ppb_memory_stats_dev.h',
         'c/dev/ppb_opengles_dev.h',
         'c/dev/ppb_scrollbar_dev.h',
         'c/dev/ppb_testing_dev.h',
@@ -120,6 +124,8 @@
         'cpp/image_data.h',
         'cpp/instance.cc',
         'cpp/instance.h',
+        'cpp/layer_compositor.cc',
+        'cpp/layer_compositor.h',
         'cpp/logging.h',
         'cpp/module.cc',
         'cpp/module.h',
@@ -131,11 +137,21 @@
         'cpp/point.h',
         'cpp/rect.cc',
         'cpp/rect.h',
+        'cpp/rect_array.cc',
+        'cpp/rect_array.h',
+        'cpp/rect_index.cc',
+        'cpp/rect_index.h',
         'cpp/resource.cc',
         'cpp/resource.h',
+        'cpp/scroll_controller.cc',
+        'cpp/scroll_controller.h',
         'cpp/size.h',
+        'cpp/tile_cache.cc',
+        'cpp/tile_cache.h',
         'cpp/var.cc',
         'cpp/var.h',
+        'cpp/var_json.cc',
+        'cpp/var_json.h',
 
         # Dev interfaces.
         'cpp/dev/audio_config_dev.cc',
@@ -144,6 +160,10 @@
         'cpp/dev/audio_dev.h',
         'cpp/dev/buffer_dev.cc',
         'cpp/dev/buffer_dev.h',
+        'cpp/dev/cursor_cache_dev.cc',
+        'cpp/dev/cursor_cache_dev.h',
+        'cpp/dev/cursor_control_dev.cc',
+        'cpp/dev/cursor_control_dev.h',
         'cpp/dev/directory_entry_dev.cc',
         'cpp/dev/directory_entry_dev.h',
         'cpp/dev/directory_reader_dev.cc',
@@ -158,6 +178,8 @@
         'cpp/dev/file_system_dev.h',
         'cpp/dev/find_dev.cc',
         'cpp/dev/find_dev.h',
+        'cpp/dev/find_engine_dev.cc',
+        'cpp/dev/find_engine_dev.h',
         'cpp/dev/font_dev.cc',
         'cpp/dev/font_dev.h',
         'cpp/dev/fullscreen_dev.cc',
@@ -166,12 +188,22 @@
         'cpp/dev/graphics_3d_client_dev.h',
         'cpp/dev/graphics_3d_dev.cc',
         'cpp/dev/graphics_3d_dev.h',
+        'cpp/dev/instance_recorder_dev.cc',
+        'cpp/dev/instance_recorder_dev.h',
+        'cpp/dev/instance_recording_dev.cc',
+        'cpp/dev/instance_recording_dev.h',
+        'cpp/dev/print_pipeline_dev.cc',
+        'cpp/dev/print_pipeline_dev.h',
         'cpp/dev/printing_dev.cc',
         'cpp/dev/printing_dev.h',
         'cpp/dev/scrollbar_dev.cc',
         'cpp/dev/scrollbar_dev.h',
+        'cpp/dev/selection_cache_dev.cc',
+        'cpp/dev/selection_cache_dev.h',
         'cpp/dev/selection_dev.cc',
         'cpp/dev/selection_dev.h',
+        'cpp/dev/tile_zoom_dev.cc',
+        'cpp/dev/tile_zoom_dev.h',
         'cpp/dev/transport_dev.cc',
         'cpp/dev/transport_dev.h',
         'cpp/dev/url_loader_dev.cc',
@@ -184,6 +216,8 @@
         'cpp/dev/url_util_dev.h',
         'cpp/dev/video_decoder_dev.cc',
         'cpp/dev/video_decoder_dev.h',
+        'cpp/dev/widget_cache_dev.cc',
+        'cpp/dev/widget_cache_dev.h',
         'cpp/dev/widget_client_dev.cc',
         'cpp/dev/widget_client_dev.h',
         'cpp/dev/widget_dev.cc',
@@ -192,10 +226,18 @@
         'cpp/dev/zoom_dev.h',
 
         # Deprecated interfaces.
+        'cpp/dev/bound_scriptable_object_deprecated.h',
+        'cpp/dev/bound_scriptable_object_deprecated.cc',
         'cpp/dev/scriptable_object_deprecated.h',
         'cpp/dev/scriptable_object_deprecated.cc',
       ],
       'conditions': [
+        ['ppapi_instance_recording==1', {
+          'defines': ['PPAPI_ENABLE_INSTANCE_RECORDING'],
+          'direct_dependent_settings': {
+            'defines': ['PPAPI_ENABLE_INSTANCE_RECORDING'],
+          },
+        }],
         ['OS=="win"', {
           'msvs_guid': 'AD371A1D-3459-4E2D-8E8A-881F4B83B908',
           'msvs_settings': {
@@ -206,6 +248,12 @@
         }],
         ['OS=="linux"', {
           'cflags': ['-Wextra', '-pedantic'],
+          # The worker threads of TileCache.
+          'link_settings': {
+            'libraries': [
+              '-lpthread',
+            ],
+          },
         }],
         ['OS=="mac"', {
           'xcode_settings': {
@@ -277,7 +325,11 @@
         'proxy/object_serialize.cc',
         'proxy/object_serialize.h',
         'proxy/objectstub_rpc_impl.cc',
+        'proxy/rpc_trace.cc',
+        'proxy/rpc_trace.h',
         'proxy/utility.h',
+        'proxy/var_transfer_region.cc',
+        'proxy/var_transfer_region.h',
       ],
       'conditions': [
         ['OS=="win"', {
@@ -345,6 +397,8 @@
         'proxy/plugin_image_data.h',
         'proxy/plugin_instance.cc',
         'proxy/plugin_instance.h',
+        'proxy/plugin_memory_stats.cc',
+        'proxy/plugin_memory_stats.h',
         #'proxy/plugin_main.cc',
         'proxy/plugin_ppp_impl.cc',
         'proxy/plugin_ppp_instance_impl.cc',
@@ -356,7 +410,11 @@
         'proxy/plugin_url_response_info.h',
         'proxy/plugin_var.cc',
         'proxy/plugin_var.h',
+        'proxy/rpc_trace.cc',
+        'proxy/rpc_trace.h',
         'proxy/utility.h',
+        'proxy/var_transfer_region.cc',
+        'proxy/var_transfer_region.h',
       ],
       'defines': [
         'NACL_LINUX',
@@ -548,22 +606,46 @@
         'tests/testing_instance.h',
 
         # Test cases.
+        'tests/test_bound_scriptable_object.cc',
+        'tests/test_bound_scriptable_object.h',
         'tests/test_buffer.cc',
         'tests/test_buffer.h',
         'tests/test_char_set.cc',
         'tests/test_char_set.h',
+        'tests/test_cursor_cache.cc',
+        'tests/test_cursor_cache.h',
         'tests/test_file_io.cc',
         'tests/test_file_io.h',
         'tests/test_file_ref.cc',
         'tests/test_file_ref.h',
+        'tests/test_find_engine.cc',
+        'tests/test_find_engine.h',
         'tests/test_graphics_2d.cc',
         'tests/test_graphics_2d.h',
         'tests/test_image_data.cc',
         'tests/test_image_data.h',
+        'tests/test_layer_compositor.cc',
+        'tests/test_layer_compositor.h',
+        'tests/test_memory_stats.cc',
+        'tests/test_memory_stats.h',
         'tests/test_paint_aggregator.cc',
         'tests/test_paint_aggregator.h',
+        'tests/test_paint_manager.cc',
+        'tests/test_paint_manager.h',
+        'tests/test_print_pipeline.cc',
+        'tests/test_print_pipeline.h',
+        'tests/test_rect_array.cc',
+        'tests/test_rect_array.h',
+        'tests/test_rect_index.cc',
+        'tests/test_rect_index.h',
+        'tests/test_scroll_controller.cc',
+        'tests/test_scroll_controller.h',
         'tests/test_scrollbar.cc',
         'tests/test_scrollbar.h',
+        'tests/test_selection_cache.cc',
+        'tests/test_selection_cache.h',
+        'tests/test_tile_cache.cc',
+        'tests/test_tile_cache.h',
         'tests/test_transport.cc',
         'tests/test_transport.h',
         'tests/test_url_loader.cc',
@@ -572,6 +654,10 @@
         'tests/test_url_util.h',
         'tests/test_var.cc',
         'tests/test_var.h',
+        'tests/test_var_json.cc',
+        'tests/test_var_json.h',
+        'tests/test_widget_cache.cc',
+        'tests/test_widget_cache.h',
 
         # Deprecated test cases.
         'tests/test_instance_deprecated.cc',
@@ -598,5 +684,179 @@
         }],
       ],
     },
+    {
+      'target_name': 'ppapi_benchmarks',
+      'type': 'loadable_module',
+      'sources': [
+        # Common test files.
+        'tests/benchmark_case.cc',
+        'tests/benchmark_case.h',
+        'tests/test_case.cc',
+        'tests/test_case.h',
+        'tests/testing_instance.cc',
+        'tests/testing_instance.h',
+
+        # Benchmark cases.
+        'tests/benchmark_bound_scriptable_object.cc',
+        'tests/benchmark_bound_scriptable_object.h',
+        'tests/benchmark_completion_callback.cc',
+        'tests/benchmark_completion_callback.h',
+        'tests/benchmark_image_data.cc',
+        'tests/benchmark_image_data.h',
+        'tests/benchmark_paint_aggregator.cc',
+        'tests/benchmark_paint_aggregator.h',
+        'tests/benchmark_rect_array.cc',
+        'tests/benchmark_rect_array.h',
+        'tests/benchmark_rect_index.cc',
+        'tests/benchmark_rect_index.h',
+        'tests/benchmark_var.cc',
+        'tests/benchmark_var.h',
+        'tests/benchmark_var_json.cc',
+        'tests/benchmark_var_json.h',
+      ],
+      'dependencies': [
+        'ppapi_cpp'
+      ],
+      'conditions': [
+        ['OS=="win"', {
+          'defines': [
+            '_CRT_SECURE_NO_DEPRECATE',
+            '_CRT_NONSTDC_NO_WARNINGS',
+            '_CRT_NONSTDC_NO_DEPRECATE',
+            '_SCL_SECURE_NO_DEPRECATE',
+          ],
+        }],
+        ['OS=="mac"', {
+          'mac_bundle': 1,
+          'product_name': 'ppapi_benchmarks',
+          'product_extension': 'plugin',
+        }],
+      ],
+    },
+    {
+      # Benchmarks of the browser side of the NaCl proxy. Like the embedders
+      # of ppapi_browser_proxy, this has to be linked against the NaCl SRPC
+      # libraries, so it's kept out of ppapi_benchmarks.
+      'target_name': 'ppapi_proxy_benchmarks',
+      'type': 'loadable_module',
+      'sources': [
+        'tests/benchmark_case.cc',
+        'tests/benchmark_case.h',
+        'tests/test_case.cc',
+        'tests/test_case.h',
+        'tests/testing_instance.cc',
+        'tests/testing_instance.h',
+
+        'tests/benchmark_object_serialize.cc',
+        'tests/benchmark_object_serialize.h',
+      ],
+      'dependencies': [
+        'ppapi_browser_proxy',
+        'ppapi_cpp',
+      ],
+    },
+    {
+      # Tests of the browser side of the NaCl proxy, kept out of ppapi_tests
+      # for the same reason as ppapi_proxy_benchmarks.
+      'target_name': 'ppapi_proxy_tests',
+      'type': 'loadable_module',
+      'sources': [
+        'tests/test_case.cc',
+        'tests/test_case.h',
+        'tests/testing_instance.cc',
+        'tests/testing_instance.h',
+
+        'tests/test_object_serialize.cc',
+        'tests/test_object_serialize.h',
+      ],
+      'dependencies': [
+        'ppapi_browser_proxy',
+        'ppapi_cpp',
+      ],
+    },
+  ],
+  'conditions': [
+    ['OS=="linux"', {
+      'targets': [
+        {
+          # In-process implementation of the browser side of the API, used to
+          # run test modules without a browser.
+          'target_name': 'ppapi_headless_host',
+          'type': 'static_library',
+          'dependencies': [
+            'ppapi_c',
+          ],
+          'include_dirs': [
+            '..',
+          ],
+          'sources': [
+            # The log format shared with the recorder in the C++ wrappers.
+            'cpp/dev/instance_recording_dev.cc',
+            'cpp/dev/instance_recording_dev.h',
+            'tests/headless/host_core.cc',
+            'tests/headless/host_core.h',
+            'tests/headless/host_file_io.cc',
+            'tests/headless/host_file_io.h',
+            'tests/headless/host_file_ref.cc',
+            'tests/headless/host_file_ref.h',
+            'tests/headless/host_file_system.cc',
+            'tests/headless/host_file_system.h',
+            'tests/headless/host_golden_images.cc',
+            'tests/headless/host_golden_images.h',
+            'tests/headless/host_graphics_2d.cc',
+            'tests/headless/host_graphics_2d.h',
+            'tests/headless/host_image_data.cc',
+            'tests/headless/host_image_data.h',
+            'tests/headless/host_instance.cc',
+            'tests/headless/host_instance.h',
+            'tests/headless/host_memory_stats.cc',
+            'tests/headless/host_memory_stats.h',
+            'tests/headless/host_message_loop.cc',
+            'tests/headless/host_message_loop.h',
+            'tests/headless/host_module.cc',
+            'tests/headless/host_module.h',
+            'tests/headless/host_page.cc',
+            'tests/headless/host_page.h',
+            'tests/headless/host_parallel_runner.cc',
+            'tests/headless/host_parallel_runner.h',
+            'tests/headless/host_png.cc',
+            'tests/headless/host_png.h',
+            'tests/headless/host_replay.cc',
+            'tests/headless/host_replay.h',
+            'tests/headless/host_resource.cc',
+            'tests/headless/host_resource.h',
+            'tests/headless/host_resource_tracker.cc',
+            'tests/headless/host_resource_tracker.h',
+            'tests/headless/host_script_object.cc',
+            'tests/headless/host_script_object.h',
+            'tests/headless/host_test_runner.cc',
+            'tests/headless/host_test_runner.h',
+            'tests/headless/host_testing.cc',
+            'tests/headless/host_testing.h',
+            'tests/headless/host_var.cc',
+            'tests/headless/host_var.h',
+          ],
+          'link_settings': {
+            'libraries': [
+              '-ldl',
+              '-lpthread',
+            ],
+          },
+        },
+        {
+          'target_name': 'ppapi_headless_runner',
+          'type': 'executable',
+          'dependencies': [
+            'ppapi_headless_host',
+            # Not linked; built so there's something to run.
+            'ppapi_benchmarks',
+            'ppapi_tests',
+          ],
+          'sources': [
+            'tests/headless/headless_main.cc',
+          ],
+        },
+      ],
+    }],
   ],
 }
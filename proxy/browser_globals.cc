@@ -18,6 +18,7 @@ namespace {
 
 std::map<PP_Instance, BrowserPpp*>* instance_to_ppp_map = NULL;
 std::map<NaClSrpcChannel*, PP_Module>* channel_to_module_id_map = NULL;
+std::map<NaClSrpcChannel*, VarTransferRegion*>* channel_to_region_map = NULL;
 
 // The GetInterface pointer from the browser.
 PPB_GetInterface get_interface;
@@ -91,6 +92,45 @@ PP_Module LookupModuleIdForSrpcChannel(NaClSrpcChannel* channel) {
   return (*channel_to_module_id_map)[channel];
 }
 
+void SetVarTransferRegionForSrpcChannel(NaClSrpcChannel* channel,
+                                        VarTransferRegion* region) {
+  // If there was no map, create one.
+  if (channel_to_region_map == NULL) {
+    channel_to_region_map = new std::map<NaClSrpcChannel*, VarTransferRegion*>;
+  }
+  // Add the channel to the map.
+  (*channel_to_region_map)[channel] = region;
+}
+
+void UnsetVarTransferRegionForSrpcChannel(NaClSrpcChannel* channel) {
+  if (channel_to_region_map == NULL) {
+    // Something major is wrong here.  We are deleting a map entry
+    // when there is no map.
+    NACL_NOTREACHED();
+    return;
+  }
+  // Erase the channel from the map.
+  channel_to_region_map->erase(channel);
+  // If there are no more channels alive, remove the map.
+  if (channel_to_region_map->size() == 0) {
+    delete channel_to_region_map;
+    channel_to_region_map = NULL;
+  }
+}
+
+VarTransferRegion* LookupVarTransferRegionForSrpcChannel(
+    NaClSrpcChannel* channel) {
+  if (channel_to_region_map == NULL) {
+    return NULL;
+  }
+  std::map<NaClSrpcChannel*, VarTransferRegion*>::const_iterator it =
+      channel_to_region_map->find(channel);
+  if (it == channel_to_region_map->end()) {
+    return NULL;
+  }
+  return it->second;
+}
+
 void SetBrowserGetInterface(PPB_GetInterface get_interface_function) {
   get_interface = get_interface_function;
   const void* core = (*get_interface_function)(PPB_CORE_INTERFACE);
@@ -24,6 +24,7 @@ namespace ppapi_proxy {
 // BrowserPpp keeps browser side PPP_Instance specific information, such as the
 // channel used to talk to the instance.
 class BrowserPpp;
+class VarTransferRegion;
 
 // Associate a particular BrowserPpp with a PP_Instance value.  This allows the
 // browser side to look up information it needs to communicate with the stub.
@@ -43,6 +44,18 @@ void UnsetModuleIdForSrpcChannel(NaClSrpcChannel* channel);
 // Looks up the association with a given channel.
 PP_Module LookupModuleIdForSrpcChannel(NaClSrpcChannel* channel);
 
+// Large var payloads go through a region of shared memory, one per module,
+// that the serializer finds by channel.  The caller keeps ownership of the
+// region.
+void SetVarTransferRegionForSrpcChannel(NaClSrpcChannel* channel,
+                                        VarTransferRegion* region);
+// Removes the association with a given channel.
+void UnsetVarTransferRegionForSrpcChannel(NaClSrpcChannel* channel);
+// Looks up the association with a given channel.  Returns NULL if there is
+// none.
+VarTransferRegion* LookupVarTransferRegionForSrpcChannel(
+    NaClSrpcChannel* channel);
+
 // We need to keep the browser GetInterface function pointer, as parts of the
 // proxy will need to invoke interfaces such as the 2D and 3D APIs.
 void SetBrowserGetInterface(PPB_GetInterface get_interface_function);
@@ -54,6 +54,19 @@ int32_t BrowserPpp::InitializeModule(
   // Export the service on the channel.
   channel_->server = service;
   char* service_string = const_cast<char*>(service->service_string);
+  // Set up the shared memory that large binary arrays are passed in.
+  nacl::DescWrapperFactory factory;
+  var_transfer_shm_.reset(factory.MakeShm(VarTransferRegion::kDefaultSize));
+  if (var_transfer_shm_.get() == NULL ||
+      var_transfer_shm_->Map(&var_transfer_base_, &var_transfer_size_) != 0) {
+    DebugPrintf("Couldn't map the var transfer region.\n");
+    return PP_ERROR_FAILED;
+  }
+  var_transfer_region_.reset(
+      new VarTransferRegion(var_transfer_base_,
+                            VarTransferRegion::kDefaultSize,
+                            VarTransferRegion::kBrowserSide));
+  SetVarTransferRegionForSrpcChannel(channel_, var_transfer_region_.get());
   SetModuleIdForSrpcChannel(channel_, module_id);
   // Do the RPC.
   int32_t browser_pid = static_cast<int32_t>(GETPID());
@@ -63,6 +76,7 @@ int32_t BrowserPpp::InitializeModule(
                                          browser_pid,
                                          module_id,
                                          wrapper->desc(),
+                                         var_transfer_shm_->desc(),
                                          service_string,
                                          &plugin_pid_,
                                          &success);
@@ -79,6 +93,12 @@ void BrowserPpp::ShutdownModule() {
   PppRpcClient::PPP_ShutdownModule(channel_);
   NaClThreadJoin(&upcall_thread_);
   UnsetModuleIdForSrpcChannel(channel_);
+  if (var_transfer_region_.get() != NULL) {
+    UnsetVarTransferRegionForSrpcChannel(channel_);
+    var_transfer_region_.reset(NULL);
+    var_transfer_shm_->Unmap(var_transfer_base_, var_transfer_size_);
+    var_transfer_shm_.reset(NULL);
+  }
 }
 
 const void* BrowserPpp::GetInterface(const char* interface_name) {
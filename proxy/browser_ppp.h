@@ -7,18 +7,24 @@
 
 #include <stdarg.h>
 
+#include "native_client/src/include/nacl_scoped_ptr.h"
 #include "native_client/src/shared/srpc/nacl_srpc.h"
 #include "native_client/src/shared/platform/nacl_threads.h"
 #include "native_client/src/trusted/desc/nacl_desc_invalid.h"
+#include "native_client/src/trusted/desc/nacl_desc_wrapper.h"
 #include "ppapi/c/pp_instance.h"
 #include "ppapi/c/ppp.h"
+#include "ppapi/proxy/var_transfer_region.h"
 
 namespace ppapi_proxy {
 
 class BrowserPpp {
  public:
   explicit BrowserPpp(NaClSrpcChannel* channel)
-      : channel_(channel), plugin_pid_(0) {}
+      : channel_(channel),
+        plugin_pid_(0),
+        var_transfer_base_(NULL),
+        var_transfer_size_(0) {}
   ~BrowserPpp() {}
 
   int32_t InitializeModule(PP_Module module_id,
@@ -37,6 +43,11 @@ class BrowserPpp {
   int plugin_pid_;
   // The thread used to handle CallOnMainThread, etc.
   struct NaClThread upcall_thread_;
+  // The shared memory used to pass large vars, and our mapping of it.
+  nacl::scoped_ptr<nacl::DescWrapper> var_transfer_shm_;
+  void* var_transfer_base_;
+  size_t var_transfer_size_;
+  nacl::scoped_ptr<VarTransferRegion> var_transfer_region_;
 };
 
 }  // namespace ppapi_proxy
@@ -0,0 +1,124 @@
+#!/usr/bin/python
+# Copyright (c) 2010 The Native Client Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Adds RpcTraceScope instrumentation to srpcgen generated client stubs.
+
+srpcgen.py lives in native_client, so rather than teaching it about the
+proxy's tracing (see ../rpc_trace.h) generate.sh runs this over each client
+file it generates. Each stub gets a scope named after the method, with the
+payload sizes of its inputs and, if the call succeeded, its outputs (stubs
+without outputs leave out the set_bytes_out() block):
+
+  NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "HasProperty",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + exception_in_bytes);
+  retval = NaClSrpcInvokeBySignature(
+  ...
+  );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*success) + *exception_bytes);
+  }
+  return retval;
+
+Running it again over an instrumented file changes nothing.
+
+Usage: add_rpc_trace.py <client.cc>...
+"""
+
+import re
+import sys
+
+INCLUDE = '#include "ppapi/proxy/rpc_trace.h"\n'
+
+STUB_RE = re.compile(
+    r'(NaClSrpcError \w+::\w+\(\n'
+    r'    NaClSrpcChannel\* channel,?\n'
+    r'(?P<params>(?:    .*\n)*?)'
+    r'\)  \{\n'
+    r'  NaClSrpcError retval;\n)'
+    r'(?P<invoke>  retval = NaClSrpcInvokeBySignature\(\n'
+    r'      channel,\n'
+    r'      "(?P<method>\w+):(?P<ins>\w*):(?P<outs>\w*)",?\n'
+    r'(?:.*\n)*?'
+    r'  \);\n)'
+    r'(  return retval;\n)')
+
+
+def PayloadSize(param, is_output):
+  """Returns a C++ expression for the size in bytes of one parameter."""
+  param = param.strip().rstrip(',')
+  array = re.match(r'nacl_abi_size_t(\*?) (\w+), (\w+)\* (\w+)$', param)
+  if array:
+    count = array.group(2)
+    if is_output:
+      count = '*' + count
+    if array.group(3) == 'char':
+      return count
+    return '%s * sizeof(%s)' % (count, array.group(3))
+  if is_output:
+    return 'sizeof(*%s)' % param.split()[-1].lstrip('*')
+  if param.startswith('char* '):
+    return 'strlen(%s) + 1' % param.split()[-1]
+  return 'sizeof(%s)' % param.split()[-1]
+
+
+def SumExpression(params, is_output, indent):
+  """Sums the sizes of |params|, wrapped to 80 columns."""
+  if not params:
+    return '0'
+  lines = [indent]
+  for param in params:
+    term = PayloadSize(param, is_output)
+    if lines[-1] == indent:
+      lines[-1] += term
+    elif len(lines[-1]) + len(term) + 4 <= 80:
+      lines[-1] += ' + ' + term
+    else:
+      lines[-1] += ' +'
+      lines.append(indent + term)
+  return '\n'.join(lines)[len(indent):]
+
+
+def Instrument(match):
+  params = [line for line in match.group('params').split('\n') if line]
+  ins = len(match.group('ins'))
+  bytes_in = SumExpression(params[:ins], False, '      ')
+  method = match.group('method')
+  source = (match.group(1) +
+            '  ppapi_proxy::RpcTraceScope trace(\n'
+            '      "%s",\n'
+            '      ppapi_proxy::kRpcTraceClient,\n'
+            '      %s);\n' % (method, bytes_in) +
+            match.group('invoke') +
+            '  trace.set_result(retval);\n')
+  if params[ins:]:
+    bytes_out = SumExpression(params[ins:], True, '        ')
+    source += ('  if (retval == NACL_SRPC_RESULT_OK) {\n'
+               '    trace.set_bytes_out(\n'
+               '        %s);\n'
+               '  }\n' % bytes_out)
+  return source + match.group(7)
+
+
+def main(argv):
+  for path in argv[1:]:
+    source = open(path).read()
+    if INCLUDE in source:
+      continue
+    source = STUB_RE.sub(Instrument, source)
+    # The header goes after the nacl_srpc.h block that every stub file has.
+    source = source.replace('#endif  // __native_client__\n',
+                            '#endif  // __native_client__\n\n'
+                            '#include <string.h>\n\n' + INCLUDE, 1)
+    open(path, 'w').write(source)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main(sys.argv))
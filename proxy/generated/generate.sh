@@ -11,3 +11,6 @@ python $srpcgen -s PpbUpcalls PPAPI_PROXY_GENERATED_UPCALL_SERVER_H_ upcall_serv
 python $srpcgen -c PpbRpcs PPAPI_PROXY_GENERATED_PPB_RPC_CLIENT_H_ ppb_rpc_client.h ppb_rpc_client.cc ../objectstub.srpc ../ppb_core.srpc
 python $srpcgen -s PppRpcs PPAPI_PROXY_GENERATED_PPP_RPC_SERVER_H_ ppp_rpc_server.h ppp_rpc_server.cc ../objectstub.srpc ../ppp.srpc ../ppp_instance.srpc
 python $srpcgen -c PpbUpcalls PPAPI_PROXY_GENERATED_UPCALL_CLIENT_H_ upcall_client.h upcall_client.cc ../upcall.srpc
+
+# RPC tracing (see ../rpc_trace.h)
+python add_rpc_trace.py ppp_rpc_client.cc ppb_rpc_client.cc upcall_client.cc
@@ -15,6 +15,10 @@
 #include "native_client/src/shared/srpc/nacl_srpc.h"
 #endif  // __native_client__
 
+#include <string.h>
+
+#include "ppapi/proxy/rpc_trace.h"
+
 NaClSrpcError ObjectStubRpcClient::HasProperty(
     NaClSrpcChannel* channel,
     nacl_abi_size_t capability_bytes, char* capability,
@@ -24,6 +28,10 @@ NaClSrpcError ObjectStubRpcClient::HasProperty(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "HasProperty",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "HasProperty:CCC:iC",
@@ -33,6 +41,11 @@ NaClSrpcError ObjectStubRpcClient::HasProperty(
       success,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*success) + *exception_bytes);
+  }
   return retval;
 }
 
@@ -45,6 +58,10 @@ NaClSrpcError ObjectStubRpcClient::HasMethod(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "HasMethod",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "HasMethod:CCC:iC",
@@ -54,6 +71,11 @@ NaClSrpcError ObjectStubRpcClient::HasMethod(
       success,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*success) + *exception_bytes);
+  }
   return retval;
 }
 
@@ -66,6 +88,10 @@ NaClSrpcError ObjectStubRpcClient::GetProperty(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "GetProperty",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "GetProperty:CCC:CC",
@@ -75,6 +101,11 @@ NaClSrpcError ObjectStubRpcClient::GetProperty(
       value_bytes, value,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *value_bytes + *exception_bytes);
+  }
   return retval;
 }
 
@@ -87,6 +118,10 @@ NaClSrpcError ObjectStubRpcClient::GetAllPropertyNames(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "GetAllPropertyNames",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "GetAllPropertyNames:CC:iCC",
@@ -96,6 +131,11 @@ NaClSrpcError ObjectStubRpcClient::GetAllPropertyNames(
       properties_bytes, properties,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*property_count) + *properties_bytes + *exception_bytes);
+  }
   return retval;
 }
 
@@ -108,6 +148,10 @@ NaClSrpcError ObjectStubRpcClient::SetProperty(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "SetProperty",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + value_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "SetProperty:CCCC:C",
@@ -117,6 +161,11 @@ NaClSrpcError ObjectStubRpcClient::SetProperty(
       exception_in_bytes, exception_in,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *exception_bytes);
+  }
   return retval;
 }
 
@@ -128,6 +177,10 @@ NaClSrpcError ObjectStubRpcClient::RemoveProperty(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "RemoveProperty",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "RemoveProperty:CCC:C",
@@ -136,6 +189,11 @@ NaClSrpcError ObjectStubRpcClient::RemoveProperty(
       exception_in_bytes, exception_in,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *exception_bytes);
+  }
   return retval;
 }
 
@@ -150,6 +208,11 @@ NaClSrpcError ObjectStubRpcClient::Call(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "Call",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + sizeof(argc) + argv_bytes +
+      exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "Call:CCiCC:CC",
@@ -161,6 +224,11 @@ NaClSrpcError ObjectStubRpcClient::Call(
       ret_bytes, ret,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *ret_bytes + *exception_bytes);
+  }
   return retval;
 }
 
@@ -174,6 +242,10 @@ NaClSrpcError ObjectStubRpcClient::Construct(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "Construct",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + sizeof(argc) + argv_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "Construct:CiCC:CC",
@@ -184,6 +256,11 @@ NaClSrpcError ObjectStubRpcClient::Construct(
       ret_bytes, ret,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *ret_bytes + *exception_bytes);
+  }
   return retval;
 }
 
@@ -192,11 +269,114 @@ NaClSrpcError ObjectStubRpcClient::Deallocate(
     nacl_abi_size_t capability_bytes, char* capability
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "Deallocate",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "Deallocate:C:",
       capability_bytes, capability
   );
+  trace.set_result(retval);
+  return retval;
+}
+
+NaClSrpcError ObjectStubRpcClient::GetProperties(
+    NaClSrpcChannel* channel,
+    nacl_abi_size_t capability_bytes, char* capability,
+    int32_t count,
+    nacl_abi_size_t names_bytes, char* names,
+    nacl_abi_size_t exception_in_bytes, char* exception_in,
+    nacl_abi_size_t* values_bytes, char* values,
+    nacl_abi_size_t* exception_bytes, char* exception
+)  {
+  NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "GetProperties",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + sizeof(count) + names_bytes + exception_in_bytes);
+  retval = NaClSrpcInvokeBySignature(
+      channel,
+      "GetProperties:CiCC:CC",
+      capability_bytes, capability,
+      count,
+      names_bytes, names,
+      exception_in_bytes, exception_in,
+      values_bytes, values,
+      exception_bytes, exception
+  );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *values_bytes + *exception_bytes);
+  }
+  return retval;
+}
+
+NaClSrpcError ObjectStubRpcClient::SetProperties(
+    NaClSrpcChannel* channel,
+    nacl_abi_size_t capability_bytes, char* capability,
+    int32_t count,
+    nacl_abi_size_t names_bytes, char* names,
+    nacl_abi_size_t values_bytes, char* values,
+    nacl_abi_size_t exception_in_bytes, char* exception_in,
+    nacl_abi_size_t* exception_bytes, char* exception
+)  {
+  NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "SetProperties",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + sizeof(count) + names_bytes + values_bytes +
+      exception_in_bytes);
+  retval = NaClSrpcInvokeBySignature(
+      channel,
+      "SetProperties:CiCCC:C",
+      capability_bytes, capability,
+      count,
+      names_bytes, names,
+      values_bytes, values,
+      exception_in_bytes, exception_in,
+      exception_bytes, exception
+  );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *exception_bytes);
+  }
+  return retval;
+}
+
+NaClSrpcError ObjectStubRpcClient::GetAllProperties(
+    NaClSrpcChannel* channel,
+    nacl_abi_size_t capability_bytes, char* capability,
+    nacl_abi_size_t exception_in_bytes, char* exception_in,
+    int32_t* property_count,
+    nacl_abi_size_t* names_bytes, char* names,
+    nacl_abi_size_t* values_bytes, char* values,
+    nacl_abi_size_t* exception_bytes, char* exception
+)  {
+  NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "GetAllProperties",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + exception_in_bytes);
+  retval = NaClSrpcInvokeBySignature(
+      channel,
+      "GetAllProperties:CC:iCCC",
+      capability_bytes, capability,
+      exception_in_bytes, exception_in,
+      property_count,
+      names_bytes, names,
+      values_bytes, values,
+      exception_bytes, exception
+  );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*property_count) + *names_bytes + *values_bytes +
+        *exception_bytes);
+  }
   return retval;
 }
 
@@ -205,11 +385,16 @@ NaClSrpcError PpbCoreRpcClient::PPB_Core_AddRefResource(
     int64_t resource
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPB_Core_AddRefResource",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(resource));
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPB_Core_AddRefResource:l:",
       resource
   );
+  trace.set_result(retval);
   return retval;
 }
 
@@ -218,11 +403,16 @@ NaClSrpcError PpbCoreRpcClient::PPB_Core_ReleaseResource(
     int64_t resource
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPB_Core_ReleaseResource",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(resource));
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPB_Core_ReleaseResource:l:",
       resource
   );
+  trace.set_result(retval);
   return retval;
 }
 
@@ -231,11 +421,20 @@ NaClSrpcError PpbCoreRpcClient::PPB_Core_GetTime(
     double* time
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPB_Core_GetTime",
+      ppapi_proxy::kRpcTraceClient,
+      0);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPB_Core_GetTime::d",
       time
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*time));
+  }
   return retval;
 }
 
@@ -169,6 +169,60 @@ static NaClSrpcError DeallocateDispatcher(
   return retval;
 }
 
+static NaClSrpcError GetPropertiesDispatcher(
+    NaClSrpcChannel* channel,
+    NaClSrpcArg** inputs,
+    NaClSrpcArg** outputs
+) {
+  NaClSrpcError retval;
+  retval = ObjectStubRpcServer::GetProperties(
+      channel,
+      inputs[0]->u.caval.count, inputs[0]->u.caval.carr,
+      inputs[1]->u.ival,
+      inputs[2]->u.caval.count, inputs[2]->u.caval.carr,
+      inputs[3]->u.caval.count, inputs[3]->u.caval.carr,
+      &(outputs[0]->u.caval.count), outputs[0]->u.caval.carr,
+      &(outputs[1]->u.caval.count), outputs[1]->u.caval.carr
+  );
+  return retval;
+}
+
+static NaClSrpcError SetPropertiesDispatcher(
+    NaClSrpcChannel* channel,
+    NaClSrpcArg** inputs,
+    NaClSrpcArg** outputs
+) {
+  NaClSrpcError retval;
+  retval = ObjectStubRpcServer::SetProperties(
+      channel,
+      inputs[0]->u.caval.count, inputs[0]->u.caval.carr,
+      inputs[1]->u.ival,
+      inputs[2]->u.caval.count, inputs[2]->u.caval.carr,
+      inputs[3]->u.caval.count, inputs[3]->u.caval.carr,
+      inputs[4]->u.caval.count, inputs[4]->u.caval.carr,
+      &(outputs[0]->u.caval.count), outputs[0]->u.caval.carr
+  );
+  return retval;
+}
+
+static NaClSrpcError GetAllPropertiesDispatcher(
+    NaClSrpcChannel* channel,
+    NaClSrpcArg** inputs,
+    NaClSrpcArg** outputs
+) {
+  NaClSrpcError retval;
+  retval = ObjectStubRpcServer::GetAllProperties(
+      channel,
+      inputs[0]->u.caval.count, inputs[0]->u.caval.carr,
+      inputs[1]->u.caval.count, inputs[1]->u.caval.carr,
+      &(outputs[0]->u.ival),
+      &(outputs[1]->u.caval.count), outputs[1]->u.caval.carr,
+      &(outputs[2]->u.caval.count), outputs[2]->u.caval.carr,
+      &(outputs[3]->u.caval.count), outputs[3]->u.caval.carr
+  );
+  return retval;
+}
+
 static NaClSrpcError PPB_Core_AddRefResourceDispatcher(
     NaClSrpcChannel* channel,
     NaClSrpcArg** inputs,
@@ -223,6 +277,9 @@ NACL_SRPC_METHOD_ARRAY(PpbRpcs::srpc_methods) = {
   { "Call:CCiCC:CC", CallDispatcher },
   { "Construct:CiCC:CC", ConstructDispatcher },
   { "Deallocate:C:", DeallocateDispatcher },
+  { "GetProperties:CiCC:CC", GetPropertiesDispatcher },
+  { "SetProperties:CiCCC:C", SetPropertiesDispatcher },
+  { "GetAllProperties:CC:iCCC", GetAllPropertiesDispatcher },
   { "PPB_Core_AddRefResource:l:", PPB_Core_AddRefResourceDispatcher },
   { "PPB_Core_ReleaseResource:l:", PPB_Core_ReleaseResourceDispatcher },
   { "PPB_Core_GetTime::d", PPB_Core_GetTimeDispatcher },
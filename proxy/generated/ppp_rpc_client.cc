@@ -15,6 +15,10 @@
 #include "native_client/src/shared/srpc/nacl_srpc.h"
 #endif  // __native_client__
 
+#include <string.h>
+
+#include "ppapi/proxy/rpc_trace.h"
+
 NaClSrpcError ObjectStubRpcClient::HasProperty(
     NaClSrpcChannel* channel,
     nacl_abi_size_t capability_bytes, char* capability,
@@ -24,6 +28,10 @@ NaClSrpcError ObjectStubRpcClient::HasProperty(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "HasProperty",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "HasProperty:CCC:iC",
@@ -33,6 +41,11 @@ NaClSrpcError ObjectStubRpcClient::HasProperty(
       success,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*success) + *exception_bytes);
+  }
   return retval;
 }
 
@@ -45,6 +58,10 @@ NaClSrpcError ObjectStubRpcClient::HasMethod(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "HasMethod",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "HasMethod:CCC:iC",
@@ -54,6 +71,11 @@ NaClSrpcError ObjectStubRpcClient::HasMethod(
       success,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*success) + *exception_bytes);
+  }
   return retval;
 }
 
@@ -66,6 +88,10 @@ NaClSrpcError ObjectStubRpcClient::GetProperty(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "GetProperty",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "GetProperty:CCC:CC",
@@ -75,6 +101,11 @@ NaClSrpcError ObjectStubRpcClient::GetProperty(
       value_bytes, value,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *value_bytes + *exception_bytes);
+  }
   return retval;
 }
 
@@ -87,6 +118,10 @@ NaClSrpcError ObjectStubRpcClient::GetAllPropertyNames(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "GetAllPropertyNames",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "GetAllPropertyNames:CC:iCC",
@@ -96,6 +131,11 @@ NaClSrpcError ObjectStubRpcClient::GetAllPropertyNames(
       properties_bytes, properties,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*property_count) + *properties_bytes + *exception_bytes);
+  }
   return retval;
 }
 
@@ -108,6 +148,10 @@ NaClSrpcError ObjectStubRpcClient::SetProperty(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "SetProperty",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + value_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "SetProperty:CCCC:C",
@@ -117,6 +161,11 @@ NaClSrpcError ObjectStubRpcClient::SetProperty(
       exception_in_bytes, exception_in,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *exception_bytes);
+  }
   return retval;
 }
 
@@ -128,6 +177,10 @@ NaClSrpcError ObjectStubRpcClient::RemoveProperty(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "RemoveProperty",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "RemoveProperty:CCC:C",
@@ -136,6 +189,11 @@ NaClSrpcError ObjectStubRpcClient::RemoveProperty(
       exception_in_bytes, exception_in,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *exception_bytes);
+  }
   return retval;
 }
 
@@ -150,6 +208,11 @@ NaClSrpcError ObjectStubRpcClient::Call(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "Call",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + name_bytes + sizeof(argc) + argv_bytes +
+      exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "Call:CCiCC:CC",
@@ -161,6 +224,11 @@ NaClSrpcError ObjectStubRpcClient::Call(
       ret_bytes, ret,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *ret_bytes + *exception_bytes);
+  }
   return retval;
 }
 
@@ -174,6 +242,10 @@ NaClSrpcError ObjectStubRpcClient::Construct(
     nacl_abi_size_t* exception_bytes, char* exception
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "Construct",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + sizeof(argc) + argv_bytes + exception_in_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "Construct:CiCC:CC",
@@ -184,6 +256,11 @@ NaClSrpcError ObjectStubRpcClient::Construct(
       ret_bytes, ret,
       exception_bytes, exception
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *ret_bytes + *exception_bytes);
+  }
   return retval;
 }
 
@@ -192,11 +269,114 @@ NaClSrpcError ObjectStubRpcClient::Deallocate(
     nacl_abi_size_t capability_bytes, char* capability
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "Deallocate",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "Deallocate:C:",
       capability_bytes, capability
   );
+  trace.set_result(retval);
+  return retval;
+}
+
+NaClSrpcError ObjectStubRpcClient::GetProperties(
+    NaClSrpcChannel* channel,
+    nacl_abi_size_t capability_bytes, char* capability,
+    int32_t count,
+    nacl_abi_size_t names_bytes, char* names,
+    nacl_abi_size_t exception_in_bytes, char* exception_in,
+    nacl_abi_size_t* values_bytes, char* values,
+    nacl_abi_size_t* exception_bytes, char* exception
+)  {
+  NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "GetProperties",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + sizeof(count) + names_bytes + exception_in_bytes);
+  retval = NaClSrpcInvokeBySignature(
+      channel,
+      "GetProperties:CiCC:CC",
+      capability_bytes, capability,
+      count,
+      names_bytes, names,
+      exception_in_bytes, exception_in,
+      values_bytes, values,
+      exception_bytes, exception
+  );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *values_bytes + *exception_bytes);
+  }
+  return retval;
+}
+
+NaClSrpcError ObjectStubRpcClient::SetProperties(
+    NaClSrpcChannel* channel,
+    nacl_abi_size_t capability_bytes, char* capability,
+    int32_t count,
+    nacl_abi_size_t names_bytes, char* names,
+    nacl_abi_size_t values_bytes, char* values,
+    nacl_abi_size_t exception_in_bytes, char* exception_in,
+    nacl_abi_size_t* exception_bytes, char* exception
+)  {
+  NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "SetProperties",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + sizeof(count) + names_bytes + values_bytes +
+      exception_in_bytes);
+  retval = NaClSrpcInvokeBySignature(
+      channel,
+      "SetProperties:CiCCC:C",
+      capability_bytes, capability,
+      count,
+      names_bytes, names,
+      values_bytes, values,
+      exception_in_bytes, exception_in,
+      exception_bytes, exception
+  );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *exception_bytes);
+  }
+  return retval;
+}
+
+NaClSrpcError ObjectStubRpcClient::GetAllProperties(
+    NaClSrpcChannel* channel,
+    nacl_abi_size_t capability_bytes, char* capability,
+    nacl_abi_size_t exception_in_bytes, char* exception_in,
+    int32_t* property_count,
+    nacl_abi_size_t* names_bytes, char* names,
+    nacl_abi_size_t* values_bytes, char* values,
+    nacl_abi_size_t* exception_bytes, char* exception
+)  {
+  NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "GetAllProperties",
+      ppapi_proxy::kRpcTraceClient,
+      capability_bytes + exception_in_bytes);
+  retval = NaClSrpcInvokeBySignature(
+      channel,
+      "GetAllProperties:CC:iCCC",
+      capability_bytes, capability,
+      exception_in_bytes, exception_in,
+      property_count,
+      names_bytes, names,
+      values_bytes, values,
+      exception_bytes, exception
+  );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*property_count) + *names_bytes + *values_bytes +
+        *exception_bytes);
+  }
   return retval;
 }
 
@@ -205,21 +385,33 @@ NaClSrpcError PppRpcClient::PPP_InitializeModule(
     int32_t pid,
     int64_t module,
     NaClSrpcImcDescType upcall_channel_desc,
+    NaClSrpcImcDescType var_transfer_desc,
     char* service_description,
     int32_t* nacl_pid,
     int32_t* success
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_InitializeModule",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(pid) + sizeof(module) + sizeof(upcall_channel_desc) +
+      sizeof(var_transfer_desc) + strlen(service_description) + 1);
   retval = NaClSrpcInvokeBySignature(
       channel,
-      "PPP_InitializeModule:ilhs:ii",
+      "PPP_InitializeModule:ilhhs:ii",
       pid,
       module,
       upcall_channel_desc,
+      var_transfer_desc,
       service_description,
       nacl_pid,
       success
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*nacl_pid) + sizeof(*success));
+  }
   return retval;
 }
 
@@ -227,10 +419,15 @@ NaClSrpcError PppRpcClient::PPP_ShutdownModule(
     NaClSrpcChannel* channel
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_ShutdownModule",
+      ppapi_proxy::kRpcTraceClient,
+      0);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPP_ShutdownModule::"
   );
+  trace.set_result(retval);
   return retval;
 }
 
@@ -240,12 +437,21 @@ NaClSrpcError PppRpcClient::PPP_GetInterface(
     int32_t* exports_interface_name
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_GetInterface",
+      ppapi_proxy::kRpcTraceClient,
+      strlen(interface_name) + 1);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPP_GetInterface:s:i",
       interface_name,
       exports_interface_name
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*exports_interface_name));
+  }
   return retval;
 }
 
@@ -258,6 +464,10 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_DidCreate(
     int32_t* success
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_Instance_DidCreate",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(instance) + sizeof(argc) + argn_bytes + argv_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPP_Instance_DidCreate:liCC:i",
@@ -267,6 +477,11 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_DidCreate(
       argv_bytes, argv,
       success
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*success));
+  }
   return retval;
 }
 
@@ -275,11 +490,16 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_DidDestroy(
     int64_t instance
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_Instance_DidDestroy",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(instance));
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPP_Instance_DidDestroy:l:",
       instance
   );
+  trace.set_result(retval);
   return retval;
 }
 
@@ -290,6 +510,11 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_DidChangeView(
     nacl_abi_size_t clip_bytes, int32_t* clip
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_Instance_DidChangeView",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(instance) + position_bytes * sizeof(int32_t) +
+      clip_bytes * sizeof(int32_t));
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPP_Instance_DidChangeView:lII:",
@@ -297,6 +522,7 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_DidChangeView(
       position_bytes, position,
       clip_bytes, clip
   );
+  trace.set_result(retval);
   return retval;
 }
 
@@ -306,12 +532,17 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_DidChangeFocus(
     bool has_focus
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_Instance_DidChangeFocus",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(instance) + sizeof(has_focus));
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPP_Instance_DidChangeFocus:lb:",
       instance,
       has_focus
   );
+  trace.set_result(retval);
   return retval;
 }
 
@@ -322,6 +553,10 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_HandleDocumentLoad(
     int32_t* success
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_Instance_HandleDocumentLoad",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(instance) + sizeof(url_loader));
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPP_Instance_HandleDocumentLoad:ll:i",
@@ -329,6 +564,11 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_HandleDocumentLoad(
       url_loader,
       success
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*success));
+  }
   return retval;
 }
 
@@ -339,6 +579,10 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_HandleInputEvent(
     int32_t* success
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_Instance_HandleInputEvent",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(instance) + event_data_bytes);
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPP_Instance_HandleInputEvent:lC:i",
@@ -346,6 +590,11 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_HandleInputEvent(
       event_data_bytes, event_data,
       success
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        sizeof(*success));
+  }
   return retval;
 }
 
@@ -355,11 +604,20 @@ NaClSrpcError PppInstanceRpcClient::PPP_Instance_GetInstanceObject(
     nacl_abi_size_t* capability_bytes, char* capability
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_Instance_GetInstanceObject",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(instance));
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPP_Instance_GetInstanceObject:l:C",
       instance,
       capability_bytes, capability
   );
+  trace.set_result(retval);
+  if (retval == NACL_SRPC_RESULT_OK) {
+    trace.set_bytes_out(
+        *capability_bytes);
+  }
   return retval;
 }
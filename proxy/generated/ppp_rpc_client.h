@@ -85,6 +85,33 @@ class ObjectStubRpcClient {
       NaClSrpcChannel* channel,
       nacl_abi_size_t capability_bytes, char* capability
   );
+  static NaClSrpcError GetProperties(
+      NaClSrpcChannel* channel,
+      nacl_abi_size_t capability_bytes, char* capability,
+      int32_t count,
+      nacl_abi_size_t names_bytes, char* names,
+      nacl_abi_size_t exception_in_bytes, char* exception_in,
+      nacl_abi_size_t* values_bytes, char* values,
+      nacl_abi_size_t* exception_bytes, char* exception
+  );
+  static NaClSrpcError SetProperties(
+      NaClSrpcChannel* channel,
+      nacl_abi_size_t capability_bytes, char* capability,
+      int32_t count,
+      nacl_abi_size_t names_bytes, char* names,
+      nacl_abi_size_t values_bytes, char* values,
+      nacl_abi_size_t exception_in_bytes, char* exception_in,
+      nacl_abi_size_t* exception_bytes, char* exception
+  );
+  static NaClSrpcError GetAllProperties(
+      NaClSrpcChannel* channel,
+      nacl_abi_size_t capability_bytes, char* capability,
+      nacl_abi_size_t exception_in_bytes, char* exception_in,
+      int32_t* property_count,
+      nacl_abi_size_t* names_bytes, char* names,
+      nacl_abi_size_t* values_bytes, char* values,
+      nacl_abi_size_t* exception_bytes, char* exception
+  );
 
  private:
   ObjectStubRpcClient();
@@ -100,6 +127,7 @@ class PppRpcClient {
       int32_t pid,
       int64_t module,
       NaClSrpcImcDescType upcall_channel_desc,
+      NaClSrpcImcDescType var_transfer_desc,
       char* service_description,
       int32_t* nacl_pid,
       int32_t* success
@@ -169,6 +169,60 @@ static NaClSrpcError DeallocateDispatcher(
   return retval;
 }
 
+static NaClSrpcError GetPropertiesDispatcher(
+    NaClSrpcChannel* channel,
+    NaClSrpcArg** inputs,
+    NaClSrpcArg** outputs
+) {
+  NaClSrpcError retval;
+  retval = ObjectStubRpcServer::GetProperties(
+      channel,
+      inputs[0]->u.caval.count, inputs[0]->u.caval.carr,
+      inputs[1]->u.ival,
+      inputs[2]->u.caval.count, inputs[2]->u.caval.carr,
+      inputs[3]->u.caval.count, inputs[3]->u.caval.carr,
+      &(outputs[0]->u.caval.count), outputs[0]->u.caval.carr,
+      &(outputs[1]->u.caval.count), outputs[1]->u.caval.carr
+  );
+  return retval;
+}
+
+static NaClSrpcError SetPropertiesDispatcher(
+    NaClSrpcChannel* channel,
+    NaClSrpcArg** inputs,
+    NaClSrpcArg** outputs
+) {
+  NaClSrpcError retval;
+  retval = ObjectStubRpcServer::SetProperties(
+      channel,
+      inputs[0]->u.caval.count, inputs[0]->u.caval.carr,
+      inputs[1]->u.ival,
+      inputs[2]->u.caval.count, inputs[2]->u.caval.carr,
+      inputs[3]->u.caval.count, inputs[3]->u.caval.carr,
+      inputs[4]->u.caval.count, inputs[4]->u.caval.carr,
+      &(outputs[0]->u.caval.count), outputs[0]->u.caval.carr
+  );
+  return retval;
+}
+
+static NaClSrpcError GetAllPropertiesDispatcher(
+    NaClSrpcChannel* channel,
+    NaClSrpcArg** inputs,
+    NaClSrpcArg** outputs
+) {
+  NaClSrpcError retval;
+  retval = ObjectStubRpcServer::GetAllProperties(
+      channel,
+      inputs[0]->u.caval.count, inputs[0]->u.caval.carr,
+      inputs[1]->u.caval.count, inputs[1]->u.caval.carr,
+      &(outputs[0]->u.ival),
+      &(outputs[1]->u.caval.count), outputs[1]->u.caval.carr,
+      &(outputs[2]->u.caval.count), outputs[2]->u.caval.carr,
+      &(outputs[3]->u.caval.count), outputs[3]->u.caval.carr
+  );
+  return retval;
+}
+
 static NaClSrpcError PPP_InitializeModuleDispatcher(
     NaClSrpcChannel* channel,
     NaClSrpcArg** inputs,
@@ -180,7 +234,8 @@ static NaClSrpcError PPP_InitializeModuleDispatcher(
       inputs[0]->u.ival,
       inputs[1]->u.lval,
       inputs[2]->u.hval,
-      inputs[3]->u.sval,
+      inputs[3]->u.hval,
+      inputs[4]->u.sval,
       &(outputs[0]->u.ival),
       &(outputs[1]->u.ival)
   );
@@ -333,7 +388,10 @@ NACL_SRPC_METHOD_ARRAY(PppRpcs::srpc_methods) = {
   { "Call:CCiCC:CC", CallDispatcher },
   { "Construct:CiCC:CC", ConstructDispatcher },
   { "Deallocate:C:", DeallocateDispatcher },
-  { "PPP_InitializeModule:ilhs:ii", PPP_InitializeModuleDispatcher },
+  { "GetProperties:CiCC:CC", GetPropertiesDispatcher },
+  { "SetProperties:CiCCC:C", SetPropertiesDispatcher },
+  { "GetAllProperties:CC:iCCC", GetAllPropertiesDispatcher },
+  { "PPP_InitializeModule:ilhhs:ii", PPP_InitializeModuleDispatcher },
   { "PPP_ShutdownModule::", PPP_ShutdownModuleDispatcher },
   { "PPP_GetInterface:s:i", PPP_GetInterfaceDispatcher },
   { "PPP_Instance_DidCreate:liCC:i", PPP_Instance_DidCreateDispatcher },
@@ -15,18 +15,27 @@
 #include "native_client/src/shared/srpc/nacl_srpc.h"
 #endif  // __native_client__
 
+#include <string.h>
+
+#include "ppapi/proxy/rpc_trace.h"
+
 NaClSrpcError PppUpcallRpcClient::PPP_Core_CallOnMainThread(
     NaClSrpcChannel* channel,
     int32_t closure_number,
     int32_t delay_in_milliseconds
 )  {
   NaClSrpcError retval;
+  ppapi_proxy::RpcTraceScope trace(
+      "PPP_Core_CallOnMainThread",
+      ppapi_proxy::kRpcTraceClient,
+      sizeof(closure_number) + sizeof(delay_in_milliseconds));
   retval = NaClSrpcInvokeBySignature(
       channel,
       "PPP_Core_CallOnMainThread:ii:",
       closure_number,
       delay_in_milliseconds
   );
+  trace.set_result(retval);
   return retval;
 }
 
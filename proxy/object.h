@@ -47,6 +47,21 @@ class Object {
                            PP_Var* exception) = 0;
   virtual void Deallocate() = 0;
 
+  // Bulk property access, which PPP_Class_Deprecated has no entry for.
+  // PluginVar calls these directly on objects of this class.
+  virtual void GetProperties(uint32_t count,
+                             const PP_Var* names,
+                             PP_Var* values,
+                             PP_Var* exception) = 0;
+  virtual void SetProperties(uint32_t count,
+                             const PP_Var* names,
+                             const PP_Var* values,
+                             PP_Var* exception) = 0;
+  virtual void GetAllProperties(uint32_t* property_count,
+                                PP_Var** names,
+                                PP_Var** values,
+                                PP_Var* exception) = 0;
+
   // For use by derived classes in constructing ObjectProxies.
   static const PPP_Class_Deprecated object_class;
 
@@ -4,6 +4,7 @@
 
 #include "ppapi/proxy/object_proxy.h"
 
+#include <string.h>
 #include <map>
 #include <string>
 
@@ -31,19 +32,60 @@ std::map<ObjectCapability, PP_Var*>* capability_proxy_map = NULL;
 
 const uint32_t kMaxVarSize = 64 * 1024;
 
+// The vars serialized for one RPC.  The other side is done with them once
+// the RPC returns, whether or not it succeeded, so the transfer region
+// chunks they were given are handed back when this goes out of scope.  That
+// also covers the RPCs given up on before they're made.
+class SerializedVars {
+ public:
+  SerializedVars(NaClSrpcChannel* channel, const PP_Var* vars, uint32_t argc)
+      : channel_(channel),
+        argc_(argc),
+        length_(kMaxVarSize),
+        bytes_(Serialize(channel, vars, argc, &length_)) {
+  }
+  ~SerializedVars() {
+    DiscardSerialized(channel_, bytes_.get(), length_, argc_);
+  }
+
+  // NULL if serialization failed, or there were no vars.
+  char* get() const { return bytes_.get(); }
+  uint32_t length() const { return length_; }
+
+ private:
+  NaClSrpcChannel* channel_;
+  uint32_t argc_;
+  uint32_t length_;
+  nacl::scoped_array<char> bytes_;
+  NACL_DISALLOW_COPY_AND_ASSIGN(SerializedVars);
+};
+
+// Reports a bulk call the proxy couldn't complete by setting |*exception|,
+// unless the object has thrown one, so that the caller can tell an empty
+// result from a failure.
+void SetFailureException(NaClSrpcChannel* channel,
+                         PP_Var* exception,
+                         const char* message) {
+  if (exception == NULL || exception->type != PP_VARTYPE_UNDEFINED) {
+    return;
+  }
+  *exception = VarInterface()->VarFromUtf8(
+      LookupModuleIdForSrpcChannel(channel),
+      message,
+      static_cast<uint32_t>(strlen(message)));
+}
+
 }  // namespace
 
 bool ObjectProxy::HasProperty(PP_Var name,
                               PP_Var* exception) {
   DebugPrintf("ObjectProxy::HasProperty\n");
-  uint32_t name_length = kMaxVarSize;
-  nacl::scoped_array<char> name_chars(Serialize(&name, 1, &name_length));
-  if (name_chars == NULL) {
+  SerializedVars name_chars(channel_, &name, 1);
+  if (name_chars.get() == NULL) {
     return false;
   }
-  uint32_t ex_in_length = kMaxVarSize;
-  nacl::scoped_array<char> ex_in_chars(Serialize(exception, 1, &ex_in_length));
-  if (ex_in_chars == NULL) {
+  SerializedVars ex_in_chars(channel_, exception, 1);
+  if (ex_in_chars.get() == NULL) {
     return false;
   }
   uint32_t ex_length = kMaxVarSize;
@@ -54,9 +96,9 @@ bool ObjectProxy::HasProperty(PP_Var name,
           channel_,
           sizeof(ObjectCapability),
           reinterpret_cast<char*>(&capability_),
-          name_length,
+          name_chars.length(),
           name_chars.get(),
-          ex_in_length,
+          ex_in_chars.length(),
           ex_in_chars.get(),
           &success,
           &ex_length,
@@ -74,14 +116,12 @@ bool ObjectProxy::HasProperty(PP_Var name,
 bool ObjectProxy::HasMethod(PP_Var name,
                             PP_Var* exception) {
   DebugPrintf("ObjectProxy::HasMethod\n");
-  uint32_t name_length = kMaxVarSize;
-  nacl::scoped_array<char> name_chars(Serialize(&name, 1, &name_length));
-  if (name_chars == NULL) {
+  SerializedVars name_chars(channel_, &name, 1);
+  if (name_chars.get() == NULL) {
     return false;
   }
-  uint32_t ex_in_length = kMaxVarSize;
-  nacl::scoped_array<char> ex_in_chars(Serialize(exception, 1, &ex_in_length));
-  if (ex_in_chars == NULL) {
+  SerializedVars ex_in_chars(channel_, exception, 1);
+  if (ex_in_chars.get() == NULL) {
     return false;
   }
   uint32_t ex_length = kMaxVarSize;
@@ -92,9 +132,9 @@ bool ObjectProxy::HasMethod(PP_Var name,
           channel_,
           sizeof(ObjectCapability),
           reinterpret_cast<char*>(&capability_),
-          name_length,
+          name_chars.length(),
           name_chars.get(),
-          ex_in_length,
+          ex_in_chars.length(),
           ex_in_chars.get(),
           &success,
           &ex_length,
@@ -113,14 +153,12 @@ PP_Var ObjectProxy::GetProperty(PP_Var name,
                                 PP_Var* exception) {
   DebugPrintf("ObjectProxy::GetProperty\n");
   PP_Var value = PP_MakeUndefined();
-  uint32_t name_length = kMaxVarSize;
-  nacl::scoped_array<char> name_chars(Serialize(&name, 1, &name_length));
-  if (name_chars == NULL) {
+  SerializedVars name_chars(channel_, &name, 1);
+  if (name_chars.get() == NULL) {
     return value;
   }
-  uint32_t ex_in_length = kMaxVarSize;
-  nacl::scoped_array<char> ex_in_chars(Serialize(exception, 1, &ex_in_length));
-  if (ex_in_chars == NULL) {
+  SerializedVars ex_in_chars(channel_, exception, 1);
+  if (ex_in_chars.get() == NULL) {
     return value;
   }
   uint32_t value_length = kMaxVarSize;
@@ -132,9 +170,9 @@ PP_Var ObjectProxy::GetProperty(PP_Var name,
           channel_,
           sizeof(ObjectCapability),
           reinterpret_cast<char*>(&capability_),
-          name_length,
+          name_chars.length(),
           name_chars.get(),
-          ex_in_length,
+          ex_in_chars.length(),
           ex_in_chars.get(),
           &value_length,
           value_chars.get(),
@@ -168,19 +206,16 @@ void ObjectProxy::SetProperty(PP_Var name,
                               PP_Var value,
                               PP_Var* exception) {
   DebugPrintf("ObjectProxy::SetProperty\n");
-  uint32_t name_length = kMaxVarSize;
-  nacl::scoped_array<char> name_chars(Serialize(&name, 1, &name_length));
-  if (name_chars == NULL) {
+  SerializedVars name_chars(channel_, &name, 1);
+  if (name_chars.get() == NULL) {
     return;
   }
-  uint32_t value_length = kMaxVarSize;
-  nacl::scoped_array<char> value_chars(Serialize(&value, 1, &value_length));
-  if (value_chars == NULL) {
+  SerializedVars value_chars(channel_, &value, 1);
+  if (value_chars.get() == NULL) {
     return;
   }
-  uint32_t ex_in_length = kMaxVarSize;
-  nacl::scoped_array<char> ex_in_chars(Serialize(exception, 1, &ex_in_length));
-  if (ex_in_chars == NULL) {
+  SerializedVars ex_in_chars(channel_, exception, 1);
+  if (ex_in_chars.get() == NULL) {
     return;
   }
   uint32_t ex_length = kMaxVarSize;
@@ -190,11 +225,11 @@ void ObjectProxy::SetProperty(PP_Var name,
           channel_,
           sizeof(ObjectCapability),
           reinterpret_cast<char*>(&capability_),
-          name_length,
+          name_chars.length(),
           name_chars.get(),
-          value_length,
+          value_chars.length(),
           value_chars.get(),
-          ex_in_length,
+          ex_in_chars.length(),
           ex_in_chars.get(),
           &ex_length,
           ex_chars.get());
@@ -210,14 +245,12 @@ void ObjectProxy::SetProperty(PP_Var name,
 void ObjectProxy::RemoveProperty(PP_Var name,
                                  PP_Var* exception) {
   DebugPrintf("ObjectProxy::RemoveProperty\n");
-  uint32_t name_length = kMaxVarSize;
-  nacl::scoped_array<char> name_chars(Serialize(&name, 1, &name_length));
-  if (name_chars == NULL) {
+  SerializedVars name_chars(channel_, &name, 1);
+  if (name_chars.get() == NULL) {
     return;
   }
-  uint32_t ex_in_length = kMaxVarSize;
-  nacl::scoped_array<char> ex_in_chars(Serialize(exception, 1, &ex_in_length));
-  if (ex_in_chars == NULL) {
+  SerializedVars ex_in_chars(channel_, exception, 1);
+  if (ex_in_chars.get() == NULL) {
     return;
   }
   uint32_t ex_length = kMaxVarSize;
@@ -227,9 +260,9 @@ void ObjectProxy::RemoveProperty(PP_Var name,
           channel_,
           sizeof(ObjectCapability),
           reinterpret_cast<char*>(&capability_),
-          name_length,
+          name_chars.length(),
           name_chars.get(),
-          ex_in_length,
+          ex_in_chars.length(),
           ex_in_chars.get(),
           &ex_length,
           ex_chars.get());
@@ -248,20 +281,17 @@ PP_Var ObjectProxy::Call(PP_Var method_name,
                          PP_Var* exception) {
   DebugPrintf("ObjectProxy::Call\n");
   PP_Var ret = PP_MakeUndefined();
-  uint32_t name_length = kMaxVarSize;
-  nacl::scoped_array<char> name_chars(Serialize(&method_name, 1, &name_length));
-  if (name_chars == NULL) {
+  SerializedVars name_chars(channel_, &method_name, 1);
+  if (name_chars.get() == NULL) {
     return ret;
   }
-  uint32_t argv_length = kMaxVarSize;
-  nacl::scoped_array<char> argv_chars(Serialize(argv, argc, &argv_length));
+  SerializedVars argv_chars(channel_, argv, argc);
   // |argv_chars| can be NULL only if |argc| is 0, otherwise an error occurred.
-  if (argv_chars == NULL && argc > 0) {
+  if (argv_chars.get() == NULL && argc > 0) {
     return ret;
   }
-  uint32_t ex_in_length = kMaxVarSize;
-  nacl::scoped_array<char> ex_in_chars(Serialize(exception, 1, &ex_in_length));
-  if (ex_in_chars == NULL && exception != NULL) {
+  SerializedVars ex_in_chars(channel_, exception, 1);
+  if (ex_in_chars.get() == NULL && exception != NULL) {
     return ret;
   }
   uint32_t ex_length = kMaxVarSize;
@@ -273,12 +303,12 @@ PP_Var ObjectProxy::Call(PP_Var method_name,
           channel_,
           sizeof(ObjectCapability),
           reinterpret_cast<char*>(&capability_),
-          name_length,
+          name_chars.length(),
           name_chars.get(),
           static_cast<int32_t>(argc),
-          argv_length,
+          argv_chars.length(),
           argv_chars.get(),
-          ex_in_length,
+          ex_in_chars.length(),
           ex_in_chars.get(),
           &ret_length,
           ret_chars.get(),
@@ -302,14 +332,12 @@ PP_Var ObjectProxy::Construct(uint32_t argc,
                               PP_Var* exception) {
   DebugPrintf("ObjectProxy::Construct\n");
   PP_Var ret = PP_MakeUndefined();
-  uint32_t argv_length = kMaxVarSize;
-  nacl::scoped_array<char> argv_chars(Serialize(argv, argc, &argv_length));
-  if (argv_chars == NULL) {
+  SerializedVars argv_chars(channel_, argv, argc);
+  if (argv_chars.get() == NULL) {
     return ret;
   }
-  uint32_t ex_in_length = kMaxVarSize;
-  nacl::scoped_array<char> ex_in_chars(Serialize(exception, 1, &ex_in_length));
-  if (ex_in_chars == NULL) {
+  SerializedVars ex_in_chars(channel_, exception, 1);
+  if (ex_in_chars.get() == NULL) {
     return ret;
   }
   uint32_t ex_length = kMaxVarSize;
@@ -322,9 +350,9 @@ PP_Var ObjectProxy::Construct(uint32_t argc,
           sizeof(ObjectCapability),
           reinterpret_cast<char*>(&capability_),
           static_cast<int32_t>(argc),
-          argv_length,
+          argv_chars.length(),
           argv_chars.get(),
-          ex_in_length,
+          ex_in_chars.length(),
           ex_in_chars.get(),
           &ret_length,
           ret_chars.get(),
@@ -343,6 +371,197 @@ PP_Var ObjectProxy::Construct(uint32_t argc,
 }
 
 
+void ObjectProxy::GetProperties(uint32_t count,
+                                const PP_Var* names,
+                                PP_Var* values,
+                                PP_Var* exception) {
+  DebugPrintf("ObjectProxy::GetProperties\n");
+  for (uint32_t i = 0; i < count; ++i) {
+    values[i] = PP_MakeUndefined();
+  }
+  if (count == 0) {
+    return;
+  }
+  SerializedVars names_chars(channel_, names, count);
+  if (names_chars.get() == NULL) {
+    SetFailureException(channel_, exception, "Couldn't send the names.");
+    return;
+  }
+  PP_Var no_exception = PP_MakeUndefined();
+  SerializedVars ex_in_chars(
+      channel_, exception != NULL ? exception : &no_exception, 1);
+  if (ex_in_chars.get() == NULL) {
+    return;
+  }
+  uint32_t ex_length = kMaxVarSize;
+  nacl::scoped_array<char> ex_chars(new char[kMaxVarSize]);
+  uint32_t values_length = kMaxVarSize;
+  nacl::scoped_array<char> values_chars(new char[kMaxVarSize]);
+  NaClSrpcError retval =
+      ObjectStubRpcClient::GetProperties(
+          channel_,
+          sizeof(ObjectCapability),
+          reinterpret_cast<char*>(&capability_),
+          static_cast<int32_t>(count),
+          names_chars.length(),
+          names_chars.get(),
+          ex_in_chars.length(),
+          ex_in_chars.get(),
+          &values_length,
+          values_chars.get(),
+          &ex_length,
+          ex_chars.get());
+  if (retval != NACL_SRPC_RESULT_OK) {
+    SetFailureException(channel_, exception, "Couldn't get the properties.");
+    return;
+  }
+  if (!DeserializeTo(channel_, values_chars.get(), values_length, count,
+                     values)) {
+    // DeserializeTo released the values it got, and left them undefined.
+    SetFailureException(channel_, exception, "Couldn't get the properties.");
+    return;
+  }
+  if (exception != NULL) {
+    (void) DeserializeTo(channel_, ex_chars.get(), ex_length, 1, exception);
+  }
+}
+
+
+void ObjectProxy::SetProperties(uint32_t count,
+                                const PP_Var* names,
+                                const PP_Var* values,
+                                PP_Var* exception) {
+  DebugPrintf("ObjectProxy::SetProperties\n");
+  if (count == 0) {
+    return;
+  }
+  SerializedVars names_chars(channel_, names, count);
+  if (names_chars.get() == NULL) {
+    SetFailureException(channel_, exception, "Couldn't send the names.");
+    return;
+  }
+  SerializedVars values_chars(channel_, values, count);
+  if (values_chars.get() == NULL) {
+    SetFailureException(channel_, exception, "Couldn't send the values.");
+    return;
+  }
+  PP_Var no_exception = PP_MakeUndefined();
+  SerializedVars ex_in_chars(
+      channel_, exception != NULL ? exception : &no_exception, 1);
+  if (ex_in_chars.get() == NULL) {
+    return;
+  }
+  uint32_t ex_length = kMaxVarSize;
+  nacl::scoped_array<char> ex_chars(new char[kMaxVarSize]);
+  NaClSrpcError retval =
+      ObjectStubRpcClient::SetProperties(
+          channel_,
+          sizeof(ObjectCapability),
+          reinterpret_cast<char*>(&capability_),
+          static_cast<int32_t>(count),
+          names_chars.length(),
+          names_chars.get(),
+          values_chars.length(),
+          values_chars.get(),
+          ex_in_chars.length(),
+          ex_in_chars.get(),
+          &ex_length,
+          ex_chars.get());
+  if (retval != NACL_SRPC_RESULT_OK) {
+    SetFailureException(channel_, exception, "Couldn't set the properties.");
+    return;
+  }
+  if (exception != NULL) {
+    (void) DeserializeTo(channel_, ex_chars.get(), ex_length, 1, exception);
+  }
+}
+
+
+void ObjectProxy::GetAllProperties(uint32_t* property_count,
+                                   PP_Var** names,
+                                   PP_Var** values,
+                                   PP_Var* exception) {
+  DebugPrintf("ObjectProxy::GetAllProperties\n");
+  *property_count = 0;
+  *names = NULL;
+  *values = NULL;
+  PP_Var no_exception = PP_MakeUndefined();
+  SerializedVars ex_in_chars(
+      channel_, exception != NULL ? exception : &no_exception, 1);
+  if (ex_in_chars.get() == NULL) {
+    return;
+  }
+  uint32_t ex_length = kMaxVarSize;
+  nacl::scoped_array<char> ex_chars(new char[kMaxVarSize]);
+  uint32_t names_length = kMaxVarSize;
+  nacl::scoped_array<char> names_chars(new char[kMaxVarSize]);
+  uint32_t values_length = kMaxVarSize;
+  nacl::scoped_array<char> values_chars(new char[kMaxVarSize]);
+  int32_t count;
+  NaClSrpcError retval =
+      ObjectStubRpcClient::GetAllProperties(
+          channel_,
+          sizeof(ObjectCapability),
+          reinterpret_cast<char*>(&capability_),
+          ex_in_chars.length(),
+          ex_in_chars.get(),
+          &count,
+          &names_length,
+          names_chars.get(),
+          &values_length,
+          values_chars.get(),
+          &ex_length,
+          ex_chars.get());
+  if (retval != NACL_SRPC_RESULT_OK) {
+    SetFailureException(channel_, exception, "Couldn't get the properties.");
+    return;
+  }
+  if (exception != NULL) {
+    (void) DeserializeTo(channel_, ex_chars.get(), ex_length, 1, exception);
+  }
+  if (count == 0) {
+    return;
+  }
+  // Every serialized var takes at least 8 bytes, which bounds |count|.
+  if (count < 0 ||
+      static_cast<uint32_t>(count) >
+          MaxSerializedVars(names_chars.get(), names_length)) {
+    SetFailureException(channel_, exception, "Couldn't get the properties.");
+    return;
+  }
+  const PPB_Core* core = CoreInterface();
+  uint32_t bytes = static_cast<uint32_t>(count) * sizeof(PP_Var);
+  PP_Var* names_array = reinterpret_cast<PP_Var*>(core->MemAlloc(bytes));
+  PP_Var* values_array = reinterpret_cast<PP_Var*>(core->MemAlloc(bytes));
+  if (names_array == NULL || values_array == NULL) {
+    core->MemFree(names_array);
+    core->MemFree(values_array);
+    SetFailureException(channel_, exception, "Couldn't get the properties.");
+    return;
+  }
+  // Both are read even if the names fail, so that the values are taken out
+  // of the transfer region if they were passed in it.
+  bool got_names = DeserializeTo(channel_, names_chars.get(), names_length,
+                                 count, names_array);
+  bool got_values = DeserializeTo(channel_, values_chars.get(), values_length,
+                                  count, values_array);
+  if (!got_names || !got_values) {
+    // DeserializeTo released what it got of the vector that failed, but
+    // the other is ours.
+    for (int32_t i = 0; i < count; ++i) {
+      VarInterface()->Release(got_names ? names_array[i] : values_array[i]);
+    }
+    core->MemFree(names_array);
+    core->MemFree(values_array);
+    SetFailureException(channel_, exception, "Couldn't get the properties.");
+    return;
+  }
+  *property_count = static_cast<uint32_t>(count);
+  *names = names_array;
+  *values = values_array;
+}
+
+
 void ObjectProxy::Deallocate() {
   DebugPrintf("ObjectProxy::Deallocate\n");
 }
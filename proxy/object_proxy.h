@@ -48,6 +48,18 @@ class ObjectProxy : public Object {
                            PP_Var* argv,
                            PP_Var* exception);
   virtual void Deallocate();
+  virtual void GetProperties(uint32_t count,
+                             const PP_Var* names,
+                             PP_Var* values,
+                             PP_Var* exception);
+  virtual void SetProperties(uint32_t count,
+                             const PP_Var* names,
+                             const PP_Var* values,
+                             PP_Var* exception);
+  virtual void GetAllProperties(uint32_t* property_count,
+                                PP_Var** names,
+                                PP_Var** values,
+                                PP_Var* exception);
 
   static PP_Var New(const ObjectCapability& capability,
                     NaClSrpcChannel* channel);
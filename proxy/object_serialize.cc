@@ -14,11 +14,14 @@
 #else
 #include "ppapi/proxy/browser_globals.h"
 #endif  // __native_client__
+#include "ppapi/c/dev/ppb_var_deprecated.h"
 #include "ppapi/c/pp_var.h"
 #include "ppapi/proxy/object.h"
 #include "ppapi/proxy/object_capability.h"
 #include "ppapi/proxy/object_proxy.h"
+#include "ppapi/proxy/rpc_trace.h"
 #include "ppapi/proxy/utility.h"
+#include "ppapi/proxy/var_transfer_region.h"
 
 namespace ppapi_proxy {
 
@@ -28,6 +31,11 @@ namespace {
 static const int kStringFixedBytes = 8;
 // Followed by a varying number of bytes rounded up to the nearest 8 bytes.
 static const uint32_t kStringRoundBase = 8;
+// Binary array elements are padded the same way.  This offset says they
+// follow the SerializedBinaryArray rather than being in the region.
+static const uint32_t kInlineElements = 0xffffffff;
+// The type of a SerializedRegionVector, which no PP_VarType has.
+static const uint32_t kRegionVectorType = 0xffffffff;
 
 }  // namespace
 
@@ -42,6 +50,8 @@ struct SerializedFixed {
     int32_t int32_value;
     // PP_VARTYPE_STRING uses this.
     uint32_t string_length;
+    // PP_VARTYPE_BINARY_ARRAY uses this.
+    uint32_t binary_array_type;
   } u;
   // The size of this structure should be 8 bytes on all platforms.
 };
@@ -67,6 +77,27 @@ struct SerializedObject {
   ObjectCapability capability;
 };
 
+// The structure used for PP_VARTYPE_BINARY_ARRAY.
+struct SerializedBinaryArray {
+  struct SerializedFixed fixed;
+  uint32_t count;
+  // The offset of the elements in the channel's VarTransferRegion, or
+  // kInlineElements if they immediately follow, padded out to the nearest
+  // multiple of kStringRoundBase bytes.  Arrays larger than
+  // VarTransferRegion::kMaxInlineBytes always use the region.
+  uint32_t region_offset;
+};
+
+// Stands in for a whole vector of PP_Vars too large for the SRPC message it
+// was to go in.  The vector is passed in the channel's VarTransferRegion
+// instead, with all its binary arrays inline.
+struct SerializedRegionVector {
+  struct SerializedFixed fixed;
+  // The offset and size of the serialized vector in the region.
+  uint32_t region_offset;
+  uint32_t length;
+};
+
 // TODO(sehr): Add a more general compile time assertion package elsewhere.
 #define ASSERT_TYPE_SIZE(struct_name, struct_size) \
     int struct_name##_size_should_be_##struct_size[ \
@@ -77,6 +108,8 @@ ASSERT_TYPE_SIZE(SerializedFixed, 8);
 ASSERT_TYPE_SIZE(SerializedDouble, 16);
 ASSERT_TYPE_SIZE(SerializedString, 16);
 ASSERT_TYPE_SIZE(SerializedObject, 24);
+ASSERT_TYPE_SIZE(SerializedBinaryArray, 16);
+ASSERT_TYPE_SIZE(SerializedRegionVector, 16);
 
 namespace {
 
@@ -93,7 +126,25 @@ uint32_t RoundedStringBytes(uint32_t string_length) {
   return (string_length + (kStringRoundBase - 1)) & ~(kStringRoundBase - 1);
 }
 
-uint32_t PpVarSize(const PP_Var& var) {
+// Gets the elements of a binary array and their size in bytes.  Returns NULL
+// if the var is not a binary array or the size would overflow.
+const void* BinaryArrayElements(const PP_Var& var,
+                                PP_BinaryArrayType* type,
+                                uint32_t* count,
+                                uint32_t* byte_count) {
+  const void* elements = VarInterface()->BinaryArrayData(var, type, count);
+  uint32_t element_size = PP_BinaryArrayElementSize(*type);
+  if (NULL == elements || 0 == element_size ||
+      *count > std::numeric_limits<uint32_t>::max() / element_size) {
+    return NULL;
+  }
+  *byte_count = *count * element_size;
+  return elements;
+}
+
+// |inline_arrays| says binary arrays are copied into the message however
+// large they are, for a message that itself goes in the region.
+uint32_t PpVarSize(const PP_Var& var, bool inline_arrays) {
   switch (var.type) {
     case PP_VARTYPE_UNDEFINED:
     case PP_VARTYPE_NULL:
@@ -116,16 +167,32 @@ uint32_t PpVarSize(const PP_Var& var) {
     }
     case PP_VARTYPE_OBJECT:
       return sizeof(SerializedObject);
+    case PP_VARTYPE_BINARY_ARRAY: {
+      PP_BinaryArrayType type;
+      uint32_t count;
+      uint32_t byte_count;
+      if (NULL == BinaryArrayElements(var, &type, &count, &byte_count)) {
+        return 0;
+      }
+      if (!inline_arrays && byte_count > VarTransferRegion::kMaxInlineBytes) {
+        // Only the offset of the elements in the region is sent.
+        return sizeof(SerializedBinaryArray);
+      }
+      return static_cast<uint32_t>(sizeof(SerializedBinaryArray) +
+                                   RoundedStringBytes(byte_count));
+    }
   }
   // Unrecognized type.
   return 0;
 }
 
-uint32_t PpVarVectorSize(const PP_Var* vars, uint32_t argc) {
+uint32_t PpVarVectorSize(const PP_Var* vars,
+                         uint32_t argc,
+                         bool inline_arrays) {
   size_t size = 0;
 
   for (uint32_t i = 0; i < argc; ++i) {
-    size_t element_size = PpVarSize(vars[i]);
+    size_t element_size = PpVarSize(vars[i], inline_arrays);
 
     if (0 == element_size || AddWouldOverflow(size, element_size)) {
       // Overflow.
@@ -136,79 +203,128 @@ uint32_t PpVarVectorSize(const PP_Var* vars, uint32_t argc) {
   return static_cast<uint32_t>(size);
 }
 
+// Serializes |var| to |p|, which has room for PpVarSize(var, inline_arrays)
+// bytes.  Returns the number of bytes written, or 0 if it fails.
+uint32_t SerializeOnePpVar(NaClSrpcChannel* channel,
+                           const PP_Var& var,
+                           bool inline_arrays,
+                           char* p) {
+  uint32_t element_size;
+  SerializedFixed* s = reinterpret_cast<SerializedFixed*>(p);
+  s->type = static_cast<uint32_t>(var.type);
+  // Set the rest of SerializedFixed to 0, in case the following serialization
+  // leaves some of it unchanged.
+  s->u.int32_value = 0;
+
+  switch (var.type) {
+    case PP_VARTYPE_UNDEFINED:
+    case PP_VARTYPE_NULL:
+      element_size = sizeof(SerializedFixed);
+      break;
+    case PP_VARTYPE_BOOL:
+      s->u.boolean_value = var.value.as_bool;
+      element_size = sizeof(SerializedFixed);
+      break;
+    case PP_VARTYPE_INT32:
+      s->u.int32_value = var.value.as_int;
+      element_size = sizeof(SerializedFixed);
+      break;
+    case PP_VARTYPE_DOUBLE: {
+      SerializedDouble* sd = reinterpret_cast<SerializedDouble*>(p);
+      sd->double_value = var.value.as_double;
+      element_size = sizeof(SerializedDouble);
+      break;
+    }
+    case PP_VARTYPE_STRING: {
+      uint32_t string_length;
+      const char* str = VarInterface()->VarToUtf8(var, &string_length);
+      SerializedString* ss = reinterpret_cast<SerializedString*>(p);
+      ss->fixed.u.string_length = string_length;
+      memcpy(reinterpret_cast<void*>(ss->string_bytes),
+             reinterpret_cast<const void*>(str),
+             string_length);
+      // Fill padding bytes with zeros.
+      memset(reinterpret_cast<void*>(ss->string_bytes + string_length), 0,
+      RoundedStringBytes(string_length) - string_length);
+      element_size =
+            sizeof(SerializedFixed) + RoundedStringBytes(string_length);
+      break;
+    }
+    case PP_VARTYPE_OBJECT: {
+      // Passing objects is done by passing a capability.
+      ObjectCapability capability(GETPID(), var.value.as_id);
+      // TODO(sehr): create/lookup a stub here.
+      // NPObjectStub::CreateStub(npp, object, &capability);
+      SerializedObject* so = reinterpret_cast<SerializedObject*>(p);
+      so->capability = capability;
+      element_size = sizeof(SerializedObject);
+      break;
+    }
+    case PP_VARTYPE_BINARY_ARRAY: {
+      PP_BinaryArrayType type;
+      uint32_t count;
+      uint32_t byte_count;
+      const void* elements =
+          BinaryArrayElements(var, &type, &count, &byte_count);
+      if (NULL == elements) {
+        return 0;
+      }
+      SerializedBinaryArray* sb = reinterpret_cast<SerializedBinaryArray*>(p);
+      sb->fixed.u.binary_array_type = static_cast<uint32_t>(type);
+      sb->count = count;
+      if (!inline_arrays && byte_count > VarTransferRegion::kMaxInlineBytes) {
+        // Too large to copy through the message; pass it in the region.
+        VarTransferRegion* region =
+            LookupVarTransferRegionForSrpcChannel(channel);
+        if (NULL == region ||
+            !region->Write(elements, byte_count, &sb->region_offset)) {
+          return 0;
+        }
+        element_size = sizeof(SerializedBinaryArray);
+      } else {
+        char* inline_bytes = p + sizeof(SerializedBinaryArray);
+        sb->region_offset = kInlineElements;
+        memcpy(inline_bytes, elements, byte_count);
+        // Fill padding bytes with zeros.
+        memset(inline_bytes + byte_count, 0,
+               RoundedStringBytes(byte_count) - byte_count);
+        element_size =
+            sizeof(SerializedBinaryArray) + RoundedStringBytes(byte_count);
+      }
+      break;
+    }
+    default:
+      return 0;
+  }
+  return element_size;
+}
+
 }  // namespace
 
-bool SerializePpVar(const PP_Var* vars,
+bool SerializePpVar(NaClSrpcChannel* channel,
+                    const PP_Var* vars,
                     uint32_t argc,
                     char* bytes,
-                    uint32_t length) {
+                    uint32_t length,
+                    bool inline_arrays) {
   size_t offset = 0;
 
   for (uint32_t i = 0; i < argc; ++i) {
-    if (offset >= length) {
-      // Not enough bytes to put the requested number of PP_Vars.
+    size_t element_size = PpVarSize(vars[i], inline_arrays);
+    if (offset >= length ||
+        0 == element_size || AddWouldOverflow(offset, element_size)) {
+      // Not enough bytes to put the requested number of PP_Vars, or
+      // overflow.
+      DiscardSerialized(channel, bytes, offset, i);
       return false;
     }
-    size_t element_size = PpVarSize(vars[i]);
-    if (0 == element_size || AddWouldOverflow(offset, element_size)) {
-      // Overflow.
+    element_size =
+        SerializeOnePpVar(channel, vars[i], inline_arrays, bytes + offset);
+    if (0 == element_size) {
+      // Take back the region chunks of the vars before this one.
+      DiscardSerialized(channel, bytes, offset, i);
       return false;
     }
-
-    char* p = bytes + offset;
-    SerializedFixed* s = reinterpret_cast<SerializedFixed*>(p);
-    s->type = static_cast<uint32_t>(vars[i].type);
-    // Set the rest of SerializedFixed to 0, in case the following serialization
-    // leaves some of it unchanged.
-    s->u.int32_value = 0;
-
-    switch (vars[i].type) {
-      case PP_VARTYPE_UNDEFINED:
-      case PP_VARTYPE_NULL:
-        element_size = sizeof(SerializedFixed);
-        break;
-      case PP_VARTYPE_BOOL:
-        s->u.boolean_value = vars[i].value.as_bool;
-        element_size = sizeof(SerializedFixed);
-        break;
-      case PP_VARTYPE_INT32:
-        s->u.int32_value = vars[i].value.as_int;
-        element_size = sizeof(SerializedFixed);
-        break;
-      case PP_VARTYPE_DOUBLE: {
-        SerializedDouble* sd = reinterpret_cast<SerializedDouble*>(p);
-        sd->double_value = vars[i].value.as_double;
-        element_size = sizeof(SerializedDouble);
-        break;
-      }
-      case PP_VARTYPE_STRING: {
-        uint32_t string_length;
-        const char* str = VarInterface()->VarToUtf8(vars[i], &string_length);
-        SerializedString* ss = reinterpret_cast<SerializedString*>(p);
-        ss->fixed.u.string_length = string_length;
-        memcpy(reinterpret_cast<void*>(ss->string_bytes),
-               reinterpret_cast<const void*>(str),
-               string_length);
-        // Fill padding bytes with zeros.
-        memset(reinterpret_cast<void*>(ss->string_bytes + string_length), 0,
-        RoundedStringBytes(string_length) - string_length);
-        element_size =
-              sizeof(SerializedFixed) + RoundedStringBytes(string_length);
-        break;
-      }
-      case PP_VARTYPE_OBJECT: {
-        // Passing objects is done by passing a capability.
-        ObjectCapability capability(GETPID(), vars[i].value.as_id);
-        // TODO(sehr): create/lookup a stub here.
-        // NPObjectStub::CreateStub(npp, object, &capability);
-        SerializedObject* so = reinterpret_cast<SerializedObject*>(p);
-        so->capability = capability;
-        element_size = sizeof(SerializedObject);
-        break;
-      }
-      default:
-        return false;
-    }
     offset += element_size;
   }
   return true;
@@ -253,6 +369,81 @@ bool DeserializeString(char* p,
   return true;
 }
 
+bool DeserializeBinaryArray(char* p,
+                            uint32_t available,
+                            PP_Var* var,
+                            uint32_t* element_size,
+                            NaClSrpcChannel* channel) {
+  if (available < sizeof(SerializedBinaryArray)) {
+    return false;
+  }
+  SerializedBinaryArray* sb = reinterpret_cast<SerializedBinaryArray*>(p);
+  PP_BinaryArrayType type =
+      static_cast<PP_BinaryArrayType>(sb->fixed.u.binary_array_type);
+  uint32_t count = sb->count;
+  uint32_t region_offset = sb->region_offset;
+  uint32_t type_size = PP_BinaryArrayElementSize(type);
+  if (0 == type_size) {
+    return false;
+  }
+  // Bound |count| before multiplying, so that the byte count can't wrap.
+  // Inline elements must fit in what's left of the buffer; the region checks
+  // the length of its chunks itself.
+  uint32_t max_count = std::numeric_limits<uint32_t>::max() / type_size;
+  if (kInlineElements == region_offset) {
+    max_count = (available - sizeof(SerializedBinaryArray)) / type_size;
+  }
+  if (count > max_count) {
+    return false;
+  }
+  uint32_t byte_count = count * type_size;
+  PP_Module module_id = LookupModuleIdForSrpcChannel(channel);
+  if (kInlineElements == region_offset) {
+    if (AddWouldOverflow(byte_count, kStringRoundBase - 1)) {
+      // Rounding to the next 8 would overflow.
+      return false;
+    }
+    uint32_t rounded_length = RoundedStringBytes(byte_count);
+    if (rounded_length > available - sizeof(SerializedBinaryArray)) {
+      // The elements run past the end of the buffer.
+      return false;
+    }
+    *var = VarInterface()->CreateBinaryArray(module_id, type, count,
+                                             p + sizeof(SerializedBinaryArray));
+    *element_size = sizeof(SerializedBinaryArray) + rounded_length;
+  } else {
+    VarTransferRegion* region = LookupVarTransferRegionForSrpcChannel(channel);
+    if (NULL == region) {
+      return false;
+    }
+    const void* elements = region->Read(region_offset, byte_count);
+    if (NULL == elements) {
+      return false;
+    }
+    // CreateBinaryArray copies the elements, so the chunk can be handed back
+    // right away.
+    *var = VarInterface()->CreateBinaryArray(module_id, type, count, elements);
+    region->Consume(region_offset);
+    *element_size = sizeof(SerializedBinaryArray);
+  }
+  return PP_VARTYPE_BINARY_ARRAY == var->type;
+}
+
+namespace {
+
+// Releases the first "count" of the "argc" vars being deserialized when a
+// later one can't be, and sets them all to undefined.
+void ReleaseDeserialized(PP_Var* vars, uint32_t count, uint32_t argc) {
+  for (uint32_t i = 0; i < argc; ++i) {
+    if (i < count) {
+      VarInterface()->Release(vars[i]);
+    }
+    vars[i] = PP_MakeUndefined();
+  }
+}
+
+}  // namespace
+
 bool DeserializePpVar(NaClSrpcChannel* channel,
                       char* bytes,
                       uint32_t length,
@@ -264,6 +455,7 @@ bool DeserializePpVar(NaClSrpcChannel* channel,
   for (uint32_t i = 0; i < argc; ++i) {
     if (p >= bytes + length) {
       // Not enough bytes to get the requested number of PP_Vars.
+      ReleaseDeserialized(vars, i, argc);
       return false;
     }
     SerializedFixed* s = reinterpret_cast<SerializedFixed*>(p);
@@ -290,6 +482,7 @@ bool DeserializePpVar(NaClSrpcChannel* channel,
       }
       case PP_VARTYPE_STRING:
         if (!DeserializeString(p, &vars[i], &element_size, channel)) {
+          ReleaseDeserialized(vars, i, argc);
           return false;
         }
         break;
@@ -300,7 +493,18 @@ bool DeserializePpVar(NaClSrpcChannel* channel,
         element_size = sizeof(SerializedObject);
         break;
       }
+      case PP_VARTYPE_BINARY_ARRAY:
+        if (!DeserializeBinaryArray(p,
+                                    static_cast<uint32_t>(bytes + length - p),
+                                    &vars[i],
+                                    &element_size,
+                                    channel)) {
+          ReleaseDeserialized(vars, i, argc);
+          return false;
+        }
+        break;
       default:
+        ReleaseDeserialized(vars, i, argc);
         return false;
     }
     p += element_size;
@@ -308,26 +512,151 @@ bool DeserializePpVar(NaClSrpcChannel* channel,
   return true;
 }
 
-bool SerializeTo(const PP_Var* var, char* bytes, uint32_t* length) {
+namespace {
+
+// Serializes "argc" PP_Vars into a chunk of the VarTransferRegion of
+// "channel", and a SerializedRegionVector for it to "bytes", which has room
+// for "*length" bytes.
+bool SerializeVectorToRegion(NaClSrpcChannel* channel,
+                             const PP_Var* vars,
+                             uint32_t argc,
+                             char* bytes,
+                             uint32_t* length) {
+  VarTransferRegion* region = LookupVarTransferRegionForSrpcChannel(channel);
+  if (NULL == region || *length < sizeof(SerializedRegionVector)) {
+    return false;
+  }
+  uint32_t vector_length = PpVarVectorSize(vars, argc, true);
+  if (0 == vector_length) {
+    return false;
+  }
+  char* vector_bytes = new(std::nothrow) char[vector_length];
+  if (NULL == vector_bytes) {
+    return false;
+  }
+  SerializedRegionVector* sv = reinterpret_cast<SerializedRegionVector*>(bytes);
+  bool written =
+      SerializePpVar(channel, vars, argc, vector_bytes, vector_length, true) &&
+      region->Write(vector_bytes, vector_length, &sv->region_offset);
+  delete[] vector_bytes;
+  if (!written) {
+    return false;
+  }
+  sv->fixed.type = kRegionVectorType;
+  sv->fixed.u.int32_value = 0;
+  sv->length = vector_length;
+  *length = sizeof(SerializedRegionVector);
+  return true;
+}
+
+// Deserializes "argc" PP_Vars from the region chunk of the
+// SerializedRegionVector at "bytes".
+bool DeserializeRegionVector(NaClSrpcChannel* channel,
+                             char* bytes,
+                             uint32_t argc,
+                             PP_Var* vars) {
+  VarTransferRegion* region = LookupVarTransferRegionForSrpcChannel(channel);
+  if (NULL == region) {
+    return false;
+  }
+  SerializedRegionVector* sv = reinterpret_cast<SerializedRegionVector*>(bytes);
+  uint32_t region_offset = sv->region_offset;
+  uint32_t vector_length = sv->length;
+  const void* chunk = region->Read(region_offset, vector_length);
+  if (NULL == chunk || 0 == vector_length) {
+    return false;
+  }
+  // The other side can still write to the region, so the vector is copied
+  // out before it's checked.
+  char* vector_bytes = new(std::nothrow) char[vector_length];
+  if (NULL == vector_bytes) {
+    return false;
+  }
+  memcpy(vector_bytes, chunk, vector_length);
+  region->Consume(region_offset);
+  bool deserialized =
+      DeserializePpVar(channel, vector_bytes, vector_length, vars, argc);
+  delete[] vector_bytes;
+  return deserialized;
+}
+
+bool IsRegionVector(const char* bytes, uint32_t length) {
+  return length == sizeof(SerializedRegionVector) &&
+      reinterpret_cast<const SerializedFixed*>(bytes)->type ==
+          kRegionVectorType;
+}
+
+}  // namespace
+
+bool SerializeTo(NaClSrpcChannel* channel,
+                 const PP_Var* var,
+                 char* bytes,
+                 uint32_t* length) {
+  RpcTraceScope trace("SerializeTo", kRpcTraceSerialize, 0);
   if (bytes == NULL || length == NULL) {
     return false;
   }
   // Compute the size of the serialized form.  Zero indicates error.
-  uint32_t tmp_length = PpVarVectorSize(var, 1);
+  uint32_t tmp_length = PpVarVectorSize(var, 1, false);
   if (0 == tmp_length || tmp_length > *length) {
     return false;
   }
   // Serialize the var.
-  if (!SerializePpVar(var, 1, bytes, tmp_length)) {
+  if (!SerializePpVar(channel, var, 1, bytes, tmp_length, false)) {
     return false;
   }
   // Return success.
   *length = tmp_length;
+  trace.set_bytes_out(tmp_length);
   return true;
 
 }
 
-char* Serialize(const PP_Var* vars, uint32_t argc, uint32_t* length) {
+bool SerializeVectorTo(NaClSrpcChannel* channel,
+                       const PP_Var* vars,
+                       uint32_t argc,
+                       char* bytes,
+                       uint32_t* length) {
+  RpcTraceScope trace("SerializeVectorTo", kRpcTraceSerialize, 0);
+  if (bytes == NULL || length == NULL) {
+    return false;
+  }
+  // An empty vector serializes to nothing.
+  if (0 == argc) {
+    *length = 0;
+    return true;
+  }
+  if (NULL == vars) {
+    return false;
+  }
+  // Compute the size of the serialized form.  Zero indicates error.
+  uint32_t tmp_length = PpVarVectorSize(vars, argc, false);
+  if (0 == tmp_length) {
+    return false;
+  }
+  if (tmp_length > *length) {
+    // Too large for the message; pass the whole vector in the region.
+    if (!SerializeVectorToRegion(channel, vars, argc, bytes, length)) {
+      return false;
+    }
+    trace.set_bytes_out(*length);
+    return true;
+  }
+  // Serialize the vars.
+  if (!SerializePpVar(channel, vars, argc, bytes, tmp_length, false)) {
+    return false;
+  }
+  // Return success.
+  *length = tmp_length;
+  trace.set_bytes_out(tmp_length);
+  return true;
+}
+
+char* Serialize(NaClSrpcChannel* channel,
+                const PP_Var* vars,
+                uint32_t argc,
+                uint32_t* length) {
+  RpcTraceScope trace("Serialize", kRpcTraceSerialize, 0);
   // Length needs to be set.
   if (NULL == length) {
     return NULL;
@@ -342,7 +671,7 @@ char* Serialize(const PP_Var* vars, uint32_t argc, uint32_t* length) {
     return NULL;
   }
   // Compute the size of the buffer.  Zero indicates error.
-  uint32_t tmp_length = PpVarVectorSize(vars, argc);
+  uint32_t tmp_length = PpVarVectorSize(vars, argc, false);
   if (0 == tmp_length || tmp_length > *length) {
     return NULL;
   }
@@ -352,20 +681,84 @@ char* Serialize(const PP_Var* vars, uint32_t argc, uint32_t* length) {
     return NULL;
   }
   // Serialize the vars.
-  if (!SerializePpVar(vars, argc, bytes, tmp_length)) {
+  if (!SerializePpVar(channel, vars, argc, bytes, tmp_length, false)) {
     delete[] bytes;
     return NULL;
   }
   // Return success.
   *length = tmp_length;
+  trace.set_bytes_out(tmp_length);
   return bytes;
 }
 
+void DiscardSerialized(NaClSrpcChannel* channel,
+                       const char* bytes,
+                       uint32_t length,
+                       uint32_t argc) {
+  if (NULL == bytes) {
+    return;
+  }
+  VarTransferRegion* region = LookupVarTransferRegionForSrpcChannel(channel);
+  if (NULL == region) {
+    // Nothing can have been written to a region.
+    return;
+  }
+  if (IsRegionVector(bytes, length)) {
+    // The vector's binary arrays are inline, so it's the only chunk.
+    region->Free(
+        reinterpret_cast<const SerializedRegionVector*>(bytes)->region_offset);
+    return;
+  }
+  // These bytes were written by SerializePpVar, so they can be trusted.
+  const char* p = bytes;
+  for (uint32_t i = 0; i < argc && p < bytes + length; ++i) {
+    const SerializedFixed* s = reinterpret_cast<const SerializedFixed*>(p);
+    switch (s->type) {
+      case PP_VARTYPE_DOUBLE:
+        p += sizeof(SerializedDouble);
+        break;
+      case PP_VARTYPE_STRING:
+        p += sizeof(SerializedFixed) + RoundedStringBytes(s->u.string_length);
+        break;
+      case PP_VARTYPE_OBJECT:
+        p += sizeof(SerializedObject);
+        break;
+      case PP_VARTYPE_BINARY_ARRAY: {
+        const SerializedBinaryArray* sb =
+            reinterpret_cast<const SerializedBinaryArray*>(p);
+        p += sizeof(SerializedBinaryArray);
+        if (kInlineElements == sb->region_offset) {
+          p += RoundedStringBytes(
+              sb->count * PP_BinaryArrayElementSize(
+                  static_cast<PP_BinaryArrayType>(
+                      sb->fixed.u.binary_array_type)));
+        } else {
+          region->Free(sb->region_offset);
+        }
+        break;
+      }
+      default:
+        p += sizeof(SerializedFixed);
+        break;
+    }
+  }
+}
+
+uint32_t MaxSerializedVars(const char* bytes, uint32_t length) {
+  // Every serialized var takes at least 8 bytes.
+  if (NULL != bytes && IsRegionVector(bytes, length)) {
+    return reinterpret_cast<const SerializedRegionVector*>(bytes)->length /
+        sizeof(SerializedFixed);
+  }
+  return length / sizeof(SerializedFixed);
+}
+
 bool DeserializeTo(NaClSrpcChannel* channel,
                    char* bytes,
                    uint32_t length,
                    uint32_t argc,
                    PP_Var* vars) {
+  RpcTraceScope trace("DeserializeTo", kRpcTraceDeserialize, length);
   // Deserializing a zero-length vector is trivially done.
   if (0 == argc) {
     return true;
@@ -378,6 +771,10 @@ bool DeserializeTo(NaClSrpcChannel* channel,
   if (NULL == vars) {
     return false;
   }
+  // A vector too large for the message is in the region.
+  if (IsRegionVector(bytes, length)) {
+    return DeserializeRegionVector(channel, bytes, argc, vars);
+  }
   // Read the serialized PP_Vars into the allocated memory.
   if (!DeserializePpVar(channel, bytes, length, vars, argc)) {
     return false;
@@ -13,17 +13,46 @@ namespace ppapi_proxy {
 
 // Serialize one PP_Var to the location given in "bytes", using no more
 // than "*length" bytes .  If successful, "*length" reflects the number of
-// bytes written and true is returned.  Otherwise returns false.
-bool SerializeTo(const PP_Var* var, char* bytes, uint32_t* length);
+// bytes written and true is returned.  Otherwise returns false.  Large binary
+// arrays are passed in the VarTransferRegion of "channel".
+bool SerializeTo(NaClSrpcChannel* channel,
+                 const PP_Var* var,
+                 char* bytes,
+                 uint32_t* length);
+
+// Serialize a vector of "argc" PP_Vars to "bytes", like SerializeTo.  A
+// vector that doesn't fit in "*length" bytes is passed in the
+// VarTransferRegion of "channel", if there's room for it there.
+bool SerializeVectorTo(NaClSrpcChannel* channel,
+                       const PP_Var* vars,
+                       uint32_t argc,
+                       char* bytes,
+                       uint32_t* length);
 
 // Serialize a vector of "argc" PP_Vars to a buffer to be allocated by new[].
 // If successful, the address of a buffer is returned and "*length" is set
 // to the number of bytes allocated.  Otherwise, NULL is returned.
-char* Serialize(const PP_Var* vars, uint32_t argc, uint32_t* length);
+char* Serialize(NaClSrpcChannel* channel,
+                const PP_Var* vars,
+                uint32_t argc,
+                uint32_t* length);
+
+// Hands back the VarTransferRegion chunks of the "argc" PP_Vars serialized to
+// "bytes" on "channel", for a message that won't be sent, or whose RPC has
+// returned so that the other side is done with it.
+void DiscardSerialized(NaClSrpcChannel* channel,
+                       const char* bytes,
+                       uint32_t length,
+                       uint32_t argc);
+
+// Returns the most PP_Vars that the "length" bytes at "bytes" can hold, to
+// check a count sent with them before allocating for it.
+uint32_t MaxSerializedVars(const char* bytes, uint32_t length);
 
 // Deserialize a vector "bytes" of "length" bytes containing "argc" PP_Vars
 // into the vector of PP_Vars pointed to by "vars".  Returns true if
-// successful, or false otherwise.
+// successful, or false otherwise.  If it fails part way, the vars already
+// deserialized are released and all of "vars" are set to undefined.
 bool DeserializeTo(NaClSrpcChannel* channel,
                    char* bytes,
                    uint32_t length,
@@ -11,6 +11,7 @@
 //#include "ppapi/proxy/generated/ppp_rpc_server.h"
 #include "ppapi/proxy/object_capability.h"
 #include "ppapi/proxy/object_serialize.h"
+#include "ppapi/proxy/rpc_trace.h"
 #include "ppapi/proxy/utility.h"
 
 #ifdef __native_client__
@@ -23,10 +24,14 @@
 // These methods provide dispatching to the implementation of the object stubs.
 //
 
+using ppapi_proxy::CoreInterface;
 using ppapi_proxy::DebugPrintf;
 using ppapi_proxy::ObjectCapability;
 using ppapi_proxy::DeserializeTo;
+using ppapi_proxy::DiscardSerialized;
+using ppapi_proxy::RpcTraceScope;
 using ppapi_proxy::SerializeTo;
+using ppapi_proxy::SerializeVectorTo;
 using ppapi_proxy::VarInterface;
 
 namespace {
@@ -41,6 +46,13 @@ PP_Var LookupCapability(const ObjectCapability* capability) {
   return var;
 }
 
+// Releases the vars deserialized for a bulk call that's given up on.
+void ReleaseVars(const PP_Var* vars, int32_t count) {
+  for (int32_t i = 0; i < count; ++i) {
+    VarInterface()->Release(vars[i]);
+  }
+}
+
 }  // namespace
 
 NaClSrpcError ObjectStubRpcServer::HasProperty(NaClSrpcChannel* channel,
@@ -55,6 +67,10 @@ NaClSrpcError ObjectStubRpcServer::HasProperty(NaClSrpcChannel* channel,
                                                char* exception_bytes) {
   UNREFERENCED_PARAMETER(channel);
   DebugPrintf("ObjectStubRpcServer::HasProperty\n");
+  RpcTraceScope trace("HasProperty",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + name_length + ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
   // Get the receiver object.
   if (capability_length != sizeof(ObjectCapability)) {
     return NACL_SRPC_RESULT_APP_ERROR;
@@ -76,10 +92,12 @@ NaClSrpcError ObjectStubRpcServer::HasProperty(NaClSrpcChannel* channel,
   // Invoke the method.
   *success = VarInterface()->HasProperty(var, name, &exception);
   // Return the final value of the exception PP_Var.
-  if (!SerializeTo(&exception, exception_bytes, exception_length)) {
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
     // Serialization of exception failed.
     return NACL_SRPC_RESULT_APP_ERROR;
   }
+  trace.set_bytes_out(sizeof(*success) + *exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
   return NACL_SRPC_RESULT_OK;
 }
 
@@ -96,6 +114,10 @@ NaClSrpcError ObjectStubRpcServer::HasMethod(NaClSrpcChannel* channel,
                                              char* exception_bytes) {
   UNREFERENCED_PARAMETER(channel);
   DebugPrintf("ObjectStubRpcServer::HasMethod\n");
+  RpcTraceScope trace("HasMethod",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + name_length + ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
   // Get the receiver object.
   if (capability_length != sizeof(ObjectCapability)) {
     return NACL_SRPC_RESULT_APP_ERROR;
@@ -117,10 +139,12 @@ NaClSrpcError ObjectStubRpcServer::HasMethod(NaClSrpcChannel* channel,
   // Invoke the method.
   *success = VarInterface()->HasMethod(var, name, &exception);
   // Return the final value of the exception PP_Var.
-  if (!SerializeTo(&exception, exception_bytes, exception_length)) {
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
     // Serialization of exception failed.
     return NACL_SRPC_RESULT_APP_ERROR;
   }
+  trace.set_bytes_out(sizeof(*success) + *exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
   return NACL_SRPC_RESULT_OK;
 }
 
@@ -138,6 +162,10 @@ NaClSrpcError ObjectStubRpcServer::GetProperty(NaClSrpcChannel* channel,
                                                char* exception_bytes) {
   UNREFERENCED_PARAMETER(channel);
   DebugPrintf("ObjectStubRpcServer::GetProperty\n");
+  RpcTraceScope trace("GetProperty",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + name_length + ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
   // Get the receiver object.
   if (capability_length != sizeof(ObjectCapability)) {
     return NACL_SRPC_RESULT_APP_ERROR;
@@ -159,15 +187,18 @@ NaClSrpcError ObjectStubRpcServer::GetProperty(NaClSrpcChannel* channel,
   // Invoke the method.
   PP_Var value = VarInterface()->GetProperty(var, name, &exception);
   // Return the value PP_Var.
-  if (!SerializeTo(&value, value_bytes, value_length)) {
+  if (!SerializeTo(channel, &value, value_bytes, value_length)) {
     // Serialization of value failed.
     return NACL_SRPC_RESULT_APP_ERROR;
   }
   // Return the final value of the exception PP_Var.
-  if (!SerializeTo(&exception, exception_bytes, exception_length)) {
-    // Serialization of exception failed.
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
+    // Serialization of exception failed.  The value won't be sent.
+    DiscardSerialized(channel, value_bytes, *value_length, 1);
     return NACL_SRPC_RESULT_APP_ERROR;
   }
+  trace.set_bytes_out(*value_length + *exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
   return NACL_SRPC_RESULT_OK;
 }
 
@@ -185,6 +216,10 @@ NaClSrpcError ObjectStubRpcServer::GetAllPropertyNames(
     char* exception_bytes) {
   UNREFERENCED_PARAMETER(channel);
   DebugPrintf("ObjectStubRpcServer::GetAllPropertyNames\n");
+  RpcTraceScope trace("GetAllPropertyNames",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
   // Get the receiver object.
   if (capability_length != sizeof(ObjectCapability)) {
     return NACL_SRPC_RESULT_APP_ERROR;
@@ -203,10 +238,13 @@ NaClSrpcError ObjectStubRpcServer::GetAllPropertyNames(
   // Invoke the method.
   // TODO(sehr): implement GetAllPropertyNames.
   // Return the final value of the exception PP_Var.
-  if (!SerializeTo(&exception, exception_bytes, exception_length)) {
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
     // Serialization of exception failed.
     return NACL_SRPC_RESULT_APP_ERROR;
   }
+  trace.set_bytes_out(sizeof(*property_count) + *properties_length +
+                        *exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
   return NACL_SRPC_RESULT_OK;
 }
 
@@ -224,6 +262,11 @@ NaClSrpcError ObjectStubRpcServer::SetProperty(NaClSrpcChannel* channel,
                                                char* exception_bytes) {
   UNREFERENCED_PARAMETER(channel);
   DebugPrintf("ObjectStubRpcServer::SetProperty\n");
+  RpcTraceScope trace("SetProperty",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + name_length + value_length +
+                      ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
   // Get the receiver object.
   if (capability_length != sizeof(ObjectCapability)) {
     return NACL_SRPC_RESULT_APP_ERROR;
@@ -251,10 +294,12 @@ NaClSrpcError ObjectStubRpcServer::SetProperty(NaClSrpcChannel* channel,
   // Invoke the method.
   VarInterface()->SetProperty(var, name, value, &exception);
   // Return the final value of the exception PP_Var.
-  if (!SerializeTo(&exception, exception_bytes, exception_length)) {
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
     // Serialization of exception failed.
     return NACL_SRPC_RESULT_APP_ERROR;
   }
+  trace.set_bytes_out(*exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
   return NACL_SRPC_RESULT_OK;
 }
 
@@ -270,6 +315,10 @@ NaClSrpcError ObjectStubRpcServer::RemoveProperty(NaClSrpcChannel* channel,
                                                   char* exception_bytes) {
   UNREFERENCED_PARAMETER(channel);
   DebugPrintf("ObjectStubRpcServer::RemoveProperty\n");
+  RpcTraceScope trace("RemoveProperty",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + name_length + ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
   // Get the receiver object.
   if (capability_length != sizeof(ObjectCapability)) {
     return NACL_SRPC_RESULT_APP_ERROR;
@@ -291,10 +340,12 @@ NaClSrpcError ObjectStubRpcServer::RemoveProperty(NaClSrpcChannel* channel,
   // Invoke the method.
   VarInterface()->RemoveProperty(var, name, &exception);
   // Return the final value of the exception PP_Var.
-  if (!SerializeTo(&exception, exception_bytes, exception_length)) {
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
     // Serialization of exception failed.
     return NACL_SRPC_RESULT_APP_ERROR;
   }
+  trace.set_bytes_out(*exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
   return NACL_SRPC_RESULT_OK;
 }
 
@@ -315,6 +366,11 @@ NaClSrpcError ObjectStubRpcServer::Call(NaClSrpcChannel* channel,
                                         char* exception_bytes) {
   UNREFERENCED_PARAMETER(channel);
   DebugPrintf("ObjectStubRpcServer::Call\n");
+  RpcTraceScope trace("Call",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + name_length + sizeof(argc) +
+                      argv_length + ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
   // Get the receiver object.
   if (capability_length != sizeof(ObjectCapability)) {
     return NACL_SRPC_RESULT_APP_ERROR;
@@ -346,15 +402,18 @@ NaClSrpcError ObjectStubRpcServer::Call(NaClSrpcChannel* channel,
                                     argv.get(),
                                     &exception);
   // Return ret.
-  if (!SerializeTo(&ret, ret_bytes, ret_length)) {
+  if (!SerializeTo(channel, &ret, ret_bytes, ret_length)) {
     // Serialization of ret failed.
     return NACL_SRPC_RESULT_APP_ERROR;
   }
   // Return the final value of the exception PP_Var.
-  if (!SerializeTo(&exception, exception_bytes, exception_length)) {
-    // Serialization of exception failed.
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
+    // Serialization of exception failed.  The ret won't be sent.
+    DiscardSerialized(channel, ret_bytes, *ret_length, 1);
     return NACL_SRPC_RESULT_APP_ERROR;
   }
+  trace.set_bytes_out(*ret_length + *exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
   return NACL_SRPC_RESULT_OK;
 }
 
@@ -372,6 +431,11 @@ NaClSrpcError ObjectStubRpcServer::Construct(NaClSrpcChannel* channel,
                                              char* exception_bytes) {
   UNREFERENCED_PARAMETER(channel);
   DebugPrintf("ObjectStubRpcServer::Construct\n");
+  RpcTraceScope trace("Construct",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + sizeof(argc) + argv_length +
+                      ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
   // Get the receiver object.
   if (capability_length != sizeof(ObjectCapability)) {
     return NACL_SRPC_RESULT_APP_ERROR;
@@ -395,15 +459,18 @@ NaClSrpcError ObjectStubRpcServer::Construct(NaClSrpcChannel* channel,
                                          argv.get(),
                                          &exception);
   // Return ret.
-  if (!SerializeTo(&ret, ret_bytes, ret_length)) {
+  if (!SerializeTo(channel, &ret, ret_bytes, ret_length)) {
     // Serialization of ret failed.
     return NACL_SRPC_RESULT_APP_ERROR;
   }
   // Return the final value of the exception PP_Var.
-  if (!SerializeTo(&exception, exception_bytes, exception_length)) {
-    // Serialization of exception failed.
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
+    // Serialization of exception failed.  The ret won't be sent.
+    DiscardSerialized(channel, ret_bytes, *ret_length, 1);
     return NACL_SRPC_RESULT_APP_ERROR;
   }
+  trace.set_bytes_out(*ret_length + *exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
   return NACL_SRPC_RESULT_OK;
 }
 
@@ -413,6 +480,10 @@ NaClSrpcError ObjectStubRpcServer::Deallocate(NaClSrpcChannel* channel,
                                               char* capability_bytes) {
   UNREFERENCED_PARAMETER(channel);
   DebugPrintf("ObjectStubRpcServer::Deallocate\n");
+  RpcTraceScope trace("Deallocate",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
   // Get the receiver object.
   if (capability_length != sizeof(ObjectCapability)) {
     return NACL_SRPC_RESULT_APP_ERROR;
@@ -420,5 +491,194 @@ NaClSrpcError ObjectStubRpcServer::Deallocate(NaClSrpcChannel* channel,
   // PP_Var var =
   //   LookupCapability(reinterpret_cast<ObjectCapability*>(capability_bytes));
   // Invoke the method.
+  trace.set_result(NACL_SRPC_RESULT_OK);
+  return NACL_SRPC_RESULT_OK;
+}
+
+NaClSrpcError ObjectStubRpcServer::GetProperties(NaClSrpcChannel* channel,
+                                                 uint32_t capability_length,
+                                                 char* capability_bytes,
+                                                 int32_t count,
+                                                 uint32_t names_length,
+                                                 char* names_bytes,
+                                                 uint32_t ex_in_length,
+                                                 char* ex_in_bytes,
+                                                 uint32_t* values_length,
+                                                 char* values_bytes,
+                                                 uint32_t* exception_length,
+                                                 char* exception_bytes) {
+  DebugPrintf("ObjectStubRpcServer::GetProperties\n");
+  RpcTraceScope trace("GetProperties",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + names_length + ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
+  // Get the receiver object.
+  if (capability_length != sizeof(ObjectCapability)) {
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  PP_Var var =
+      LookupCapability(reinterpret_cast<ObjectCapability*>(capability_bytes));
+  // Every serialized var takes at least 8 bytes, which bounds |count|.
+  if (count <= 0 || static_cast<uint32_t>(count) > names_length / 8) {
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  // Get the name PP_Vars.
+  nacl::scoped_array<PP_Var> names(new PP_Var[count]);
+  if (!DeserializeTo(channel, names_bytes, names_length, count, names.get())) {
+    // Deserialization of names failed.
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  // Get the previous value of the exception PP_Var.
+  PP_Var exception;
+  if (!DeserializeTo(channel, ex_in_bytes, ex_in_length, 1, &exception)) {
+    // Deserialization of exception failed.
+    ReleaseVars(names.get(), count);
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  // Invoke the method.
+  nacl::scoped_array<PP_Var> values(new PP_Var[count]);
+  VarInterface()->GetProperties(var, count, names.get(), values.get(),
+                                &exception);
+  // Return the value PP_Vars.
+  if (!SerializeVectorTo(channel, values.get(), count, values_bytes,
+                         values_length)) {
+    // Serialization of values failed.
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  // Return the final value of the exception PP_Var.
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
+    // Serialization of exception failed.  The values won't be sent.
+    DiscardSerialized(channel, values_bytes, *values_length,
+                      static_cast<uint32_t>(count));
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  trace.set_bytes_out(*values_length + *exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
+  return NACL_SRPC_RESULT_OK;
+}
+
+NaClSrpcError ObjectStubRpcServer::SetProperties(NaClSrpcChannel* channel,
+                                                 uint32_t capability_length,
+                                                 char* capability_bytes,
+                                                 int32_t count,
+                                                 uint32_t names_length,
+                                                 char* names_bytes,
+                                                 uint32_t values_length,
+                                                 char* values_bytes,
+                                                 uint32_t ex_in_length,
+                                                 char* ex_in_bytes,
+                                                 uint32_t* exception_length,
+                                                 char* exception_bytes) {
+  DebugPrintf("ObjectStubRpcServer::SetProperties\n");
+  RpcTraceScope trace("SetProperties",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + names_length + values_length +
+                      ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
+  // Get the receiver object.
+  if (capability_length != sizeof(ObjectCapability)) {
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  PP_Var var =
+      LookupCapability(reinterpret_cast<ObjectCapability*>(capability_bytes));
+  // Every serialized var takes at least 8 bytes, which bounds |count|.
+  if (count <= 0 || static_cast<uint32_t>(count) > names_length / 8) {
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  // Get the name and value PP_Vars.
+  nacl::scoped_array<PP_Var> names(new PP_Var[count]);
+  if (!DeserializeTo(channel, names_bytes, names_length, count, names.get())) {
+    // Deserialization of names failed.
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  nacl::scoped_array<PP_Var> values(new PP_Var[count]);
+  if (!DeserializeTo(channel, values_bytes, values_length, count,
+                     values.get())) {
+    // Deserialization of values failed.
+    ReleaseVars(names.get(), count);
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  // Get the previous value of the exception PP_Var.
+  PP_Var exception;
+  if (!DeserializeTo(channel, ex_in_bytes, ex_in_length, 1, &exception)) {
+    // Deserialization of exception failed.
+    ReleaseVars(names.get(), count);
+    ReleaseVars(values.get(), count);
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  // Invoke the method.
+  VarInterface()->SetProperties(var, count, names.get(), values.get(),
+                                &exception);
+  // Return the final value of the exception PP_Var.
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
+    // Serialization of exception failed.
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  trace.set_bytes_out(*exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
+  return NACL_SRPC_RESULT_OK;
+}
+
+NaClSrpcError ObjectStubRpcServer::GetAllProperties(
+    NaClSrpcChannel* channel,
+    uint32_t capability_length,
+    char* capability_bytes,
+    uint32_t ex_in_length,
+    char* ex_in_bytes,
+    int32_t* property_count,
+    uint32_t* names_length,
+    char* names_bytes,
+    uint32_t* values_length,
+    char* values_bytes,
+    uint32_t* exception_length,
+    char* exception_bytes) {
+  DebugPrintf("ObjectStubRpcServer::GetAllProperties\n");
+  RpcTraceScope trace("GetAllProperties",
+                      ppapi_proxy::kRpcTraceServer,
+                      capability_length + ex_in_length);
+  trace.set_result(NACL_SRPC_RESULT_APP_ERROR);
+  // Get the receiver object.
+  if (capability_length != sizeof(ObjectCapability)) {
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  PP_Var var =
+      LookupCapability(reinterpret_cast<ObjectCapability*>(capability_bytes));
+  // Get the previous value of the exception PP_Var.
+  PP_Var exception;
+  if (!DeserializeTo(channel, ex_in_bytes, ex_in_length, 1, &exception)) {
+    // Deserialization of exception failed.
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  // Invoke the method.
+  uint32_t count = 0;
+  PP_Var* names = NULL;
+  PP_Var* values = NULL;
+  VarInterface()->GetAllProperties(var, &count, &names, &values, &exception);
+  // Return the name and value PP_Vars.  The arrays belong to us.
+  bool serialized =
+      SerializeVectorTo(channel, names, count, names_bytes, names_length);
+  if (serialized &&
+      !SerializeVectorTo(channel, values, count, values_bytes,
+                         values_length)) {
+    // The names won't be sent.
+    DiscardSerialized(channel, names_bytes, *names_length, count);
+    serialized = false;
+  }
+  CoreInterface()->MemFree(names);
+  CoreInterface()->MemFree(values);
+  if (!serialized) {
+    // Serialization of names or values failed.
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  *property_count = static_cast<int32_t>(count);
+  // Return the final value of the exception PP_Var.
+  if (!SerializeTo(channel, &exception, exception_bytes, exception_length)) {
+    // Serialization of exception failed.  The names and values won't be sent.
+    DiscardSerialized(channel, names_bytes, *names_length, count);
+    DiscardSerialized(channel, values_bytes, *values_length, count);
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
+  trace.set_bytes_out(*names_length + *values_length + *exception_length);
+  trace.set_result(NACL_SRPC_RESULT_OK);
   return NACL_SRPC_RESULT_OK;
 }
@@ -14,9 +14,11 @@
 #include "ppapi/c/pp_resource.h"
 #include "ppapi/proxy/generated/ppb_rpc_client.h"
 #include "ppapi/proxy/plugin_globals.h"
+#include "ppapi/proxy/plugin_memory_stats.h"
 #include "ppapi/proxy/utility.h"
 
 using ppapi_proxy::DebugPrintf;
+using ppapi_proxy::PluginMemoryStats;
 
 // All of the methods here are invoked from the plugin's main (UI) thread,
 // so no locking is done.
@@ -68,6 +70,7 @@ void ReleaseResource(PP_Resource resource) {
     (void) PpbCoreRpcClient::PPB_Core_ReleaseResource(channel, resource);
     // Then remove the local reference count for the resource.
     local_ref_count->erase(resource);
+    PluginMemoryStats::RemoveResource(resource);
     if (local_ref_count->size() == 0) {
       // There are no locally reference counted objects, free the map.
       delete local_ref_count;
@@ -78,12 +81,12 @@ void ReleaseResource(PP_Resource resource) {
 
 void* MemAlloc(size_t num_bytes) {
   DebugPrintf("PluginCore::MemAlloc: num_bytes=%"NACL_PRIuS"\n", num_bytes);
-  return malloc(num_bytes);
+  return PluginMemoryStats::MemAlloc(num_bytes);
 }
 
 void MemFree(void* ptr) {
   DebugPrintf("PluginCore::MemFree: ptr=%p\n", ptr);
-  free(ptr);
+  PluginMemoryStats::MemFree(ptr);
 }
 
 PP_Time GetTime() {
@@ -14,6 +14,7 @@
 #include "ppapi/proxy/plugin_graphics_2d.h"
 #include "ppapi/proxy/plugin_graphics_3d.h"
 #include "ppapi/proxy/plugin_image_data.h"
+#include "ppapi/proxy/plugin_memory_stats.h"
 #include "ppapi/proxy/plugin_url_loader.h"
 #include "ppapi/proxy/plugin_url_request_info.h"
 #include "ppapi/proxy/plugin_url_response_info.h"
@@ -48,6 +49,8 @@ const InterfaceMapElement interface_map[] = {
     reinterpret_cast<GetInterfacePtr>(PluginGraphics3D::GetInterface) },
   { PPB_IMAGEDATA_INTERFACE,
     reinterpret_cast<GetInterfacePtr>(PluginImageData::GetInterface) },
+  { PPB_MEMORY_STATS_DEV_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(PluginMemoryStats::GetInterface) },
   { PPB_URLLOADER_DEV_INTERFACE,
     reinterpret_cast<GetInterfacePtr>(PluginURLLoader::GetInterface) },
   { PPB_URLREQUESTINFO_DEV_INTERFACE,
@@ -3,6 +3,9 @@
 // found in the LICENSE file.
 
 #include "ppapi/proxy/plugin_globals.h"
+
+#include <stddef.h>
+
 #include "ppapi/proxy/plugin_core.h"
 #include "ppapi/proxy/plugin_var.h"
 
@@ -13,6 +16,7 @@ namespace {
 NaClSrpcChannel* main_srpc_channel;
 NaClSrpcChannel* upcall_srpc_channel;
 PP_Module module_id_for_plugin;
+VarTransferRegion* var_transfer_region_for_plugin;
 
 }  // namespace;
 
@@ -47,6 +51,20 @@ PP_Module LookupModuleIdForSrpcChannel(NaClSrpcChannel* channel) {
   return module_id_for_plugin;
 }
 
+void SetVarTransferRegionForSrpcChannel(NaClSrpcChannel* channel,
+                                        VarTransferRegion* region) {
+  var_transfer_region_for_plugin = region;
+}
+
+void UnsetVarTransferRegionForSrpcChannel(NaClSrpcChannel* channel) {
+  var_transfer_region_for_plugin = NULL;
+}
+
+VarTransferRegion* LookupVarTransferRegionForSrpcChannel(
+    NaClSrpcChannel* channel) {
+  return var_transfer_region_for_plugin;
+}
+
 const PPB_Core* CoreInterface() {
   return reinterpret_cast<const PPB_Core*>(PluginCore::GetInterface());
 }
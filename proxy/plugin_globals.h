@@ -14,6 +14,8 @@ struct NaClSrpcChannel;
 
 namespace ppapi_proxy {
 
+class VarTransferRegion;
+
 // The main SRPC channel is that used to handle foreground (main thread)
 // RPC traffic.
 NaClSrpcChannel* GetMainSrpcChannel();
@@ -30,6 +32,16 @@ void UnsetModuleIdForSrpcChannel(NaClSrpcChannel* channel);
 // Save the plugin's module_id.
 PP_Module LookupModuleIdForSrpcChannel(NaClSrpcChannel* channel);
 
+// Save the region shared with the browser for large var payloads.  The plugin
+// keeps ownership of the region.
+void SetVarTransferRegionForSrpcChannel(NaClSrpcChannel* channel,
+                                        VarTransferRegion* region);
+// Forget the region.
+void UnsetVarTransferRegionForSrpcChannel(NaClSrpcChannel* channel);
+// Get the region, or NULL if the browser didn't provide one.
+VarTransferRegion* LookupVarTransferRegionForSrpcChannel(
+    NaClSrpcChannel* channel);
+
 // Get the PPB_Core interface passed in from the browser.
 const PPB_Core* CoreInterface();
 
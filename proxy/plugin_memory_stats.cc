@@ -0,0 +1,240 @@
+// Copyright (c) 2010 The Native Client Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/proxy/plugin_memory_stats.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+
+#include "native_client/src/include/portability.h"
+#include "ppapi/proxy/utility.h"
+
+namespace ppapi_proxy {
+
+namespace {
+
+// MemAlloc may be called from any thread, so the counts are protected by
+// |stats_lock|. It is only taken while accounting is on.
+pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+PP_MemoryStats_Dev stats[PP_MEMORYSTATSCATEGORY_COUNT];
+uint32_t generation = 0;
+
+// Resources registered with AddResource() while accounting was on.
+typedef std::map<PP_Resource, PluginMemoryStats::Entry*> ResourceEntryMap;
+ResourceEntryMap* resource_entries = NULL;
+
+const char* const kCategoryNames[PP_MEMORYSTATSCATEGORY_COUNT] = {
+  "ImageData",
+  "Buffer",
+  "URLLoader",
+  "FileIO",
+  "StringVar",
+  "ObjectVar",
+  "MemAlloc",
+  "BinaryArrayVar",
+};
+
+// Precedes every block returned by MemAlloc. Two words keep the payload as
+// aligned as malloc's.
+union MemAllocHeader {
+  PluginMemoryStats::Entry* entry;
+  double align[2];
+};
+
+bool IsEnabled() {
+  return PluginMemoryStats::enabled();
+}
+
+}  // namespace
+
+bool PluginMemoryStats::enabled_ = false;
+
+void PluginMemoryStats::Entry::Add(PP_MemoryStatsCategory_Dev category,
+                                   uint64_t bytes) {
+  pthread_mutex_lock(&stats_lock);
+  // Accounting may have been turned off before we got the lock.
+  if (enabled_) {
+    generation_ = generation;
+    category_ = category;
+    bytes_ = bytes;
+
+    PP_MemoryStats_Dev* s = &stats[category];
+    s->live_count++;
+    s->live_bytes += bytes;
+    s->total_count++;
+    if (s->live_count > s->peak_count) {
+      s->peak_count = s->live_count;
+    }
+    if (s->live_bytes > s->peak_bytes) {
+      s->peak_bytes = s->live_bytes;
+    }
+  }
+  pthread_mutex_unlock(&stats_lock);
+}
+
+void PluginMemoryStats::Entry::Remove() {
+  pthread_mutex_lock(&stats_lock);
+  if (enabled_ && generation_ == generation) {
+    stats[category_].live_count--;
+    stats[category_].live_bytes -= bytes_;
+  }
+  generation_ = 0;
+  pthread_mutex_unlock(&stats_lock);
+}
+
+const PPB_MemoryStats_Dev* PluginMemoryStats::GetInterface() {
+  static const PPB_MemoryStats_Dev intf = {
+    SetEnabled,
+    IsEnabled,
+    GetStats,
+    ResetPeaks,
+    Dump
+  };
+  return &intf;
+}
+
+void PluginMemoryStats::SetEnabled(bool enabled) {
+  DebugPrintf("PluginMemoryStats::SetEnabled: enabled=%d\n", enabled);
+  ResourceEntryMap* old_entries = NULL;
+  pthread_mutex_lock(&stats_lock);
+  if (enabled != enabled_) {
+    enabled_ = enabled;
+    memset(stats, 0, sizeof(stats));
+    // Generation 0 means "not recorded", so skip it on wrap-around.
+    if (++generation == 0) {
+      generation = 1;
+    }
+    old_entries = resource_entries;
+    resource_entries = NULL;
+  }
+  pthread_mutex_unlock(&stats_lock);
+
+  // The entries belong to the previous generation; deleting them is a no-op
+  // as far as the counts go.
+  if (old_entries != NULL) {
+    for (ResourceEntryMap::iterator i = old_entries->begin();
+         i != old_entries->end(); ++i) {
+      delete i->second;
+    }
+    delete old_entries;
+  }
+}
+
+bool PluginMemoryStats::GetStats(PP_Module module,
+                                 PP_MemoryStatsCategory_Dev category,
+                                 PP_MemoryStats_Dev* out) {
+  UNREFERENCED_PARAMETER(module);
+  if (category < 0 || category >= PP_MEMORYSTATSCATEGORY_COUNT ||
+      out == NULL) {
+    return false;
+  }
+  pthread_mutex_lock(&stats_lock);
+  bool enabled = enabled_;
+  if (enabled) {
+    *out = stats[category];
+  }
+  pthread_mutex_unlock(&stats_lock);
+  return enabled;
+}
+
+void PluginMemoryStats::ResetPeaks(PP_Module module) {
+  UNREFERENCED_PARAMETER(module);
+  pthread_mutex_lock(&stats_lock);
+  for (int i = 0; i < PP_MEMORYSTATSCATEGORY_COUNT; ++i) {
+    stats[i].peak_count = stats[i].live_count;
+    stats[i].peak_bytes = stats[i].live_bytes;
+  }
+  pthread_mutex_unlock(&stats_lock);
+}
+
+void PluginMemoryStats::Dump(PP_Module module) {
+  UNREFERENCED_PARAMETER(module);
+  pthread_mutex_lock(&stats_lock);
+  if (!enabled_) {
+    fprintf(stderr, "PluginMemoryStats: accounting is off\n");
+  } else {
+    fprintf(stderr, "PluginMemoryStats:\n");
+    fprintf(stderr, "  %-10s %10s %14s %10s %14s %10s\n", "category",
+            "live", "live bytes", "peak", "peak bytes", "total");
+    for (int i = 0; i < PP_MEMORYSTATSCATEGORY_COUNT; ++i) {
+      fprintf(stderr, "  %-10s %10"NACL_PRIu32" %14"NACL_PRIu64
+              " %10"NACL_PRIu32" %14"NACL_PRIu64" %10"NACL_PRIu64"\n",
+              kCategoryNames[i],
+              stats[i].live_count,
+              stats[i].live_bytes,
+              stats[i].peak_count,
+              stats[i].peak_bytes,
+              stats[i].total_count);
+    }
+  }
+  pthread_mutex_unlock(&stats_lock);
+}
+
+void PluginMemoryStats::AddResource(PP_Resource resource,
+                                    PP_MemoryStatsCategory_Dev category,
+                                    uint64_t bytes) {
+  if (!enabled_) {
+    return;
+  }
+  Entry* entry = new Entry;
+  entry->Record(category, bytes);
+  pthread_mutex_lock(&stats_lock);
+  if (resource_entries == NULL) {
+    resource_entries = new ResourceEntryMap;
+  }
+  Entry*& slot = (*resource_entries)[resource];
+  Entry* old_entry = slot;
+  slot = entry;
+  pthread_mutex_unlock(&stats_lock);
+  // A resource id is only registered twice if its removal was missed.
+  delete old_entry;
+}
+
+void PluginMemoryStats::RemoveResource(PP_Resource resource) {
+  if (!enabled_) {
+    return;
+  }
+  Entry* entry = NULL;
+  pthread_mutex_lock(&stats_lock);
+  if (resource_entries != NULL) {
+    ResourceEntryMap::iterator found = resource_entries->find(resource);
+    if (found != resource_entries->end()) {
+      entry = found->second;
+      resource_entries->erase(found);
+    }
+  }
+  pthread_mutex_unlock(&stats_lock);
+  delete entry;
+}
+
+void* PluginMemoryStats::MemAlloc(size_t num_bytes) {
+  if (num_bytes > static_cast<size_t>(-1) - sizeof(MemAllocHeader)) {
+    return NULL;
+  }
+  MemAllocHeader* header = reinterpret_cast<MemAllocHeader*>(
+      malloc(sizeof(MemAllocHeader) + num_bytes));
+  if (header == NULL) {
+    return NULL;
+  }
+  header->entry = NULL;
+  if (enabled_) {
+    header->entry = new Entry;
+    header->entry->Record(PP_MEMORYSTATSCATEGORY_MEMALLOC, num_bytes);
+  }
+  return header + 1;
+}
+
+void PluginMemoryStats::MemFree(void* ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  MemAllocHeader* header = reinterpret_cast<MemAllocHeader*>(ptr) - 1;
+  delete header->entry;
+  free(header);
+}
+
+}  // namespace ppapi_proxy
@@ -0,0 +1,92 @@
+// Copyright (c) 2010 The Native Client Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_PROXY_PLUGIN_MEMORY_STATS_H_
+#define PPAPI_PROXY_PLUGIN_MEMORY_STATS_H_
+
+#include <stddef.h>
+
+#include "native_client/src/include/nacl_macros.h"
+#include "ppapi/c/dev/ppb_memory_stats_dev.h"
+#include "ppapi/c/pp_module.h"
+#include "ppapi/c/pp_resource.h"
+#include "ppapi/c/pp_stdint.h"
+
+namespace ppapi_proxy {
+
+// Implements the plugin side of the PPB_MemoryStats_Dev interface. It counts
+// what lives in the plugin process: PPB_Core.MemAlloc blocks, the string and
+// object vars of PluginVar, and resources registered with AddResource(). A
+// plugin process only ever hosts one module, so the module arguments of the
+// interface are ignored.
+//
+// Accounting is off by default, and while it is off recording costs one load
+// and branch. Each SetEnabled() starts a new generation and objects only
+// update the generation they were recorded in.
+class PluginMemoryStats {
+ public:
+  // Accounts for one object. Embed it in the object and call Record() once
+  // the object is created; the object is removed from the counts when the
+  // Entry is destroyed.
+  class Entry {
+   public:
+    Entry() : generation_(0) {}
+    ~Entry() {
+      if (generation_ != 0) {
+        Remove();
+      }
+    }
+
+    void Record(PP_MemoryStatsCategory_Dev category, uint64_t bytes) {
+      if (enabled_) {
+        Add(category, bytes);
+      }
+    }
+
+   private:
+    void Add(PP_MemoryStatsCategory_Dev category, uint64_t bytes);
+    void Remove();
+
+    // 0 if not recorded.
+    uint32_t generation_;
+    PP_MemoryStatsCategory_Dev category_;
+    uint64_t bytes_;
+    NACL_DISALLOW_COPY_AND_ASSIGN(Entry);
+  };
+
+  // Returns an interface pointer usable by PPAPI plugins.
+  static const PPB_MemoryStats_Dev* GetInterface();
+
+  static bool enabled() { return enabled_; }
+
+  // The functions of the interface. The module is ignored.
+  static void SetEnabled(bool enabled);
+  static bool GetStats(PP_Module module,
+                       PP_MemoryStatsCategory_Dev category,
+                       PP_MemoryStats_Dev* stats);
+  static void ResetPeaks(PP_Module module);
+  static void Dump(PP_Module module);
+
+  // Counts a resource created through the proxy until RemoveResource() is
+  // called for it, which PluginCore does when the last plugin reference is
+  // released.
+  static void AddResource(PP_Resource resource,
+                          PP_MemoryStatsCategory_Dev category,
+                          uint64_t bytes);
+  static void RemoveResource(PP_Resource resource);
+
+  // The PPB_Core.MemAlloc and MemFree of the plugin. Blocks carry a small
+  // header so they can be accounted for even though MemFree isn't given the
+  // size.
+  static void* MemAlloc(size_t num_bytes);
+  static void MemFree(void* ptr);
+
+ private:
+  static bool enabled_;
+  NACL_DISALLOW_COPY_AND_ASSIGN(PluginMemoryStats);
+};
+
+}  // namespace ppapi_proxy
+
+#endif  // PPAPI_PROXY_PLUGIN_MEMORY_STATS_H_
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <stdarg.h>
+#include <sys/mman.h>
 
 #include "native_client/src/include/portability.h"
 #include "native_client/src/include/portability_process.h"
@@ -12,11 +13,17 @@
 #include "ppapi/proxy/plugin_getinterface.h"
 #include "ppapi/proxy/plugin_globals.h"
 #include "ppapi/proxy/utility.h"
+#include "ppapi/proxy/var_transfer_region.h"
 
 using ppapi_proxy::DebugPrintf;
+using ppapi_proxy::VarTransferRegion;
 
 namespace {
 
+// Our mapping of the shared memory the browser passes large vars in.
+void* var_transfer_base = NULL;
+VarTransferRegion* var_transfer_region = NULL;
+
 // The plugin will make synchronous calls back to the browser on the main
 // thread.  The service exported from the browser is specified in
 // service_description.
@@ -73,6 +80,37 @@ void StopUpcallSrpcChannel() {
   ppapi_proxy::SetUpcallSrpcChannel(NULL);
 }
 
+// Large binary arrays are passed in shared memory set up by the browser.
+bool StartVarTransferRegion(NaClSrpcImcDescType var_transfer_desc,
+                            NaClSrpcChannel* channel) {
+  var_transfer_base = mmap(NULL,
+                           VarTransferRegion::kDefaultSize,
+                           PROT_READ | PROT_WRITE,
+                           MAP_SHARED,
+                           var_transfer_desc,
+                           0);
+  if (MAP_FAILED == var_transfer_base) {
+    DebugPrintf("  Bad var_transfer_desc\n");
+    var_transfer_base = NULL;
+    return false;
+  }
+  var_transfer_region =
+      new VarTransferRegion(var_transfer_base,
+                            VarTransferRegion::kDefaultSize,
+                            VarTransferRegion::kPluginSide);
+  ppapi_proxy::SetVarTransferRegionForSrpcChannel(channel,
+                                                  var_transfer_region);
+  return true;
+}
+
+void StopVarTransferRegion(NaClSrpcChannel* channel) {
+  ppapi_proxy::UnsetVarTransferRegionForSrpcChannel(channel);
+  delete var_transfer_region;
+  var_transfer_region = NULL;
+  munmap(var_transfer_base, VarTransferRegion::kDefaultSize);
+  var_transfer_base = NULL;
+}
+
 }  // namespace
 
 //
@@ -84,6 +122,7 @@ NaClSrpcError PppRpcServer::PPP_InitializeModule(
     int32_t pid,
     int64_t module,
     NaClSrpcImcDescType upcall_channel_desc,
+    NaClSrpcImcDescType var_transfer_desc,
     char* service_description,
     int32_t* nacl_pid,
     int32_t* success) {
@@ -100,6 +139,13 @@ NaClSrpcError PppRpcServer::PPP_InitializeModule(
     StopMainSrpcChannel();
     return NACL_SRPC_RESULT_APP_ERROR;
   }
+  // Map the region shared with the browser for passing large vars.
+  if (!StartVarTransferRegion(var_transfer_desc, channel)) {
+    DebugPrintf("  Failed to map var transfer region\n");
+    StopUpcallSrpcChannel();
+    StopMainSrpcChannel();
+    return NACL_SRPC_RESULT_APP_ERROR;
+  }
   ppapi_proxy::SetModuleIdForSrpcChannel(channel, module);
   *success = ::PPP_InitializeModule(module, ppapi_proxy::GetInterfaceProxy);
   *nacl_pid = GETPID();
@@ -110,6 +156,7 @@ NaClSrpcError PppRpcServer::PPP_ShutdownModule(NaClSrpcChannel* channel) {
   DebugPrintf("PPP_ShutdownModule\n");
   ::PPP_ShutdownModule();
   ppapi_proxy::UnsetModuleIdForSrpcChannel(channel);
+  StopVarTransferRegion(channel);
   StopUpcallSrpcChannel();
   StopMainSrpcChannel();
   return NACL_SRPC_RESULT_OK;
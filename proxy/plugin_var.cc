@@ -4,8 +4,11 @@
 
 #include "ppapi/proxy/plugin_var.h"
 
+#include <string.h>
+#include <limits>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "native_client/src/include/nacl_macros.h"
 #include "native_client/src/include/portability.h"
@@ -13,6 +16,8 @@
 #include "ppapi/c/dev/ppb_var_deprecated.h"
 #include "ppapi/c/dev/ppp_class_deprecated.h"
 #include "ppapi/c/pp_var.h"
+#include "ppapi/proxy/object.h"
+#include "ppapi/proxy/plugin_memory_stats.h"
 #include "ppapi/proxy/utility.h"
 
 namespace ppapi_proxy {
@@ -27,6 +32,7 @@ class ObjImpl {
                                ref_count_(1) {
     static uint64_t impl_id = 0;
     id_ = impl_id++;
+    memory_stats_entry_.Record(PP_MEMORYSTATSCATEGORY_OBJECTVAR, 0);
   }
   ~ObjImpl() { }
   void AddRef() { ++ref_count_; }
@@ -41,6 +47,7 @@ class ObjImpl {
   void* object_data_;
   uint64_t ref_count_;
   uint64_t id_;
+  PluginMemoryStats::Entry memory_stats_entry_;
   NACL_DISALLOW_COPY_AND_ASSIGN(ObjImpl);
 };
 
@@ -49,6 +56,7 @@ class StrImpl {
   StrImpl(const char* data, uint32_t len) :
     str_(data, len),
     ref_count_(1) {
+    memory_stats_entry_.Record(PP_MEMORYSTATSCATEGORY_STRINGVAR, len);
   }
   ~StrImpl() { }
   void AddRef() { ++ref_count_; }
@@ -59,9 +67,39 @@ class StrImpl {
  private:
   std::string str_;
   uint64_t ref_count_;
+  PluginMemoryStats::Entry memory_stats_entry_;
   NACL_DISALLOW_COPY_AND_ASSIGN(StrImpl);
 };
 
+class ArrImpl {
+ public:
+  ArrImpl(PP_BinaryArrayType type, uint32_t count, uint32_t byte_count) :
+    type_(type),
+    count_(count),
+    // Doubles keep the elements aligned for every type, and the extra one
+    // gives empty arrays a valid data pointer.
+    storage_(byte_count / sizeof(double) + 1, 0.0),
+    ref_count_(1) {
+    memory_stats_entry_.Record(PP_MEMORYSTATSCATEGORY_BINARYARRAYVAR,
+                               byte_count);
+  }
+  ~ArrImpl() { }
+  void AddRef() { ++ref_count_; }
+  void Release() { --ref_count_; }
+  PP_BinaryArrayType type() const { return type_; }
+  uint32_t count() const { return count_; }
+  void* data() { return &storage_[0]; }
+  uint64_t ref_count() const { return ref_count_; }
+
+ private:
+  PP_BinaryArrayType type_;
+  uint32_t count_;
+  std::vector<double> storage_;
+  uint64_t ref_count_;
+  PluginMemoryStats::Entry memory_stats_entry_;
+  NACL_DISALLOW_COPY_AND_ASSIGN(ArrImpl);
+};
+
 static ObjImpl* VarToObjImpl(PP_Var var) {
   if (var.type == PP_VARTYPE_OBJECT) {
     return reinterpret_cast<ObjImpl*>(var.value.as_id);
@@ -78,6 +116,14 @@ static StrImpl* VarToStrImpl(PP_Var var) {
   }
 }
 
+static ArrImpl* VarToArrImpl(PP_Var var) {
+  if (var.type == PP_VARTYPE_BINARY_ARRAY) {
+    return reinterpret_cast<ArrImpl*>(var.value.as_id);
+  } else {
+    return NULL;
+  }
+}
+
 void AddRef(PP_Var var) {
   ObjImpl* obj_impl = VarToObjImpl(var);
   if (obj_impl != NULL) {
@@ -89,6 +135,12 @@ void AddRef(PP_Var var) {
     DebugPrintf("PluginVar::AddRef: '%s'\n", str_impl->str().c_str());
     str_impl->AddRef();
   }
+  ArrImpl* arr_impl = VarToArrImpl(var);
+  if (arr_impl != NULL) {
+    DebugPrintf("PluginVar::AddRef: binary array(%"NACL_PRIu32")\n",
+                arr_impl->count());
+    arr_impl->AddRef();
+  }
 }
 
 void Release(PP_Var var) {
@@ -113,6 +165,15 @@ void Release(PP_Var var) {
       delete str_impl;
     }
   }
+  ArrImpl* arr_impl = VarToArrImpl(var);
+  if (arr_impl != NULL) {
+    DebugPrintf("PluginVar::Release: binary array(%"NACL_PRIu32")\n",
+                arr_impl->count());
+    arr_impl->Release();
+    if (arr_impl->ref_count() == 0) {
+      delete arr_impl;
+    }
+  }
 }
 
 PP_Var VarFromUtf8(PP_Module module_id, const char* data, uint32_t len) {
@@ -310,6 +371,144 @@ PP_Var CreateObject(PP_Module module_id,
   return result;
 }
 
+PP_Var CreateBinaryArray(PP_Module module_id,
+                         PP_BinaryArrayType type,
+                         uint32_t count,
+                         const void* data) {
+  UNREFERENCED_PARAMETER(module_id);
+  uint32_t element_size = PP_BinaryArrayElementSize(type);
+  if (element_size == 0 ||
+      count > std::numeric_limits<uint32_t>::max() / element_size) {
+    return PP_MakeNull();
+  }
+  uint32_t byte_count = count * element_size;
+  ArrImpl* impl = new ArrImpl(type, count, byte_count);
+  if (data != NULL) {
+    memcpy(impl->data(), data, byte_count);
+  }
+  PP_Var result;
+  result.type = PP_VARTYPE_BINARY_ARRAY;
+  result.value.as_id = reinterpret_cast<int64_t>(impl);
+  return result;
+}
+
+void* BinaryArrayData(PP_Var var, PP_BinaryArrayType* type, uint32_t* count) {
+  ArrImpl* arr_impl = VarToArrImpl(var);
+  if (arr_impl == NULL) {
+    *count = 0;
+    return NULL;
+  }
+  *type = arr_impl->type();
+  *count = arr_impl->count();
+  return arr_impl->data();
+}
+
+void GetProperties(PP_Var object,
+                   uint32_t count,
+                   const PP_Var names[],
+                   PP_Var values[],
+                   PP_Var* exception) {
+  for (uint32_t i = 0; i < count; ++i) {
+    values[i] = PP_MakeUndefined();
+  }
+  ObjImpl* impl = VarToObjImpl(object);
+  if (impl == NULL) {
+    return;
+  }
+  DebugPrintf("PluginVar::GetProperties: %"NACL_PRIu64"\n", impl->id());
+  const PPP_Class_Deprecated* object_class = impl->object_class();
+  if (object_class == &Object::object_class) {
+    // A proxy for a browser object: fetch the whole batch in one RPC.
+    reinterpret_cast<Object*>(impl->object_data())->GetProperties(
+        count, names, values, exception);
+    return;
+  }
+  if (object_class == NULL || object_class->GetProperty == NULL) {
+    return;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    values[i] =
+        object_class->GetProperty(impl->object_data(), names[i], exception);
+    if (exception != NULL && exception->type != PP_VARTYPE_UNDEFINED) {
+      return;
+    }
+  }
+}
+
+void SetProperties(PP_Var object,
+                   uint32_t count,
+                   const PP_Var names[],
+                   const PP_Var values[],
+                   PP_Var* exception) {
+  ObjImpl* impl = VarToObjImpl(object);
+  if (impl == NULL) {
+    return;
+  }
+  DebugPrintf("PluginVar::SetProperties: %"NACL_PRIu64"\n", impl->id());
+  const PPP_Class_Deprecated* object_class = impl->object_class();
+  if (object_class == &Object::object_class) {
+    reinterpret_cast<Object*>(impl->object_data())->SetProperties(
+        count, names, values, exception);
+    return;
+  }
+  if (object_class == NULL || object_class->SetProperty == NULL) {
+    return;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    object_class->SetProperty(impl->object_data(), names[i], values[i],
+                              exception);
+    if (exception != NULL && exception->type != PP_VARTYPE_UNDEFINED) {
+      return;
+    }
+  }
+}
+
+void GetAllProperties(PP_Var object,
+                      uint32_t* property_count,
+                      PP_Var** names,
+                      PP_Var** values,
+                      PP_Var* exception) {
+  *property_count = 0;
+  *names = NULL;
+  *values = NULL;
+  ObjImpl* impl = VarToObjImpl(object);
+  if (impl == NULL) {
+    return;
+  }
+  DebugPrintf("PluginVar::GetAllProperties: %"NACL_PRIu64"\n", impl->id());
+  const PPP_Class_Deprecated* object_class = impl->object_class();
+  if (object_class == &Object::object_class) {
+    reinterpret_cast<Object*>(impl->object_data())->GetAllProperties(
+        property_count, names, values, exception);
+    return;
+  }
+  if (object_class == NULL || object_class->GetAllPropertyNames == NULL) {
+    return;
+  }
+  uint32_t count = 0;
+  PP_Var* name_array = NULL;
+  object_class->GetAllPropertyNames(impl->object_data(),
+                                    &count,
+                                    &name_array,
+                                    exception);
+  if (count == 0 || name_array == NULL) {
+    return;
+  }
+  PP_Var* value_array = reinterpret_cast<PP_Var*>(
+      PluginMemoryStats::MemAlloc(count * sizeof(PP_Var)));
+  if (value_array == NULL) {
+    for (uint32_t i = 0; i < count; ++i) {
+      Release(name_array[i]);
+    }
+    PluginMemoryStats::MemFree(name_array);
+    return;
+  }
+  GetProperties(object, count, name_array, value_array, exception);
+  *property_count = count;
+  *names = name_array;
+  *values = value_array;
+}
+
 }  // namespace
 
 const PPB_Var_Deprecated* PluginVar::GetInterface() {
@@ -327,7 +526,12 @@ const PPB_Var_Deprecated* PluginVar::GetInterface() {
     Call,
     Construct,
     IsInstanceOf,
-    CreateObject
+    CreateObject,
+    CreateBinaryArray,
+    BinaryArrayData,
+    GetProperties,
+    SetProperties,
+    GetAllProperties
   };
   return &intf;
 }
@@ -367,6 +571,16 @@ std::string PluginVar::VarToString(PP_Var var) {
         SNPRINTF(buf, kBufSize, "%"NACL_PRIu64"", GetVarId(var));
         return std::string("##OBJECT##") + buf + "##";
       }
+    case PP_VARTYPE_BINARY_ARRAY:
+      {
+        PP_BinaryArrayType type;
+        uint32_t count;
+        (void) BinaryArrayData(var, &type, &count);
+        char buf[32];
+        const size_t kBufSize = sizeof(buf);
+        SNPRINTF(buf, kBufSize, "%"NACL_PRIu32"", count);
+        return std::string("##BINARY_ARRAY##") + buf + "##";
+      }
   }
   ASSERT_MSG(0, "Unexpected type seen");
   return "##ERROR##";
@@ -399,6 +613,9 @@ void PluginVar::Print(PP_Var var) {
     case PP_VARTYPE_OBJECT:
       DebugPrintf("PP_Var(object: %"NACL_PRIu64")", GetVarId(var));
       break;
+    case PP_VARTYPE_BINARY_ARRAY:
+      DebugPrintf("PP_Var(binary array: %s)", VarToString(var).c_str());
+      break;
   }
 }
 
@@ -0,0 +1,379 @@
+// Copyright (c) 2010 The Native Client Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/proxy/rpc_trace.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#ifndef NACL_WINDOWS
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif  // NACL_WINDOWS
+
+namespace ppapi_proxy {
+
+#ifdef NACL_WINDOWS
+
+void EnableRpcTracing(bool enable) {
+  UNREFERENCED_PARAMETER(enable);
+}
+
+bool IsRpcTracingEnabled() {
+  return false;
+}
+
+void ExportRpcTraceJSON(std::string* json) {
+  UNREFERENCED_PARAMETER(json);
+}
+
+void GetRpcLatencySummary(std::string* summary) {
+  UNREFERENCED_PARAMETER(summary);
+}
+
+void ClearRpcTrace() {
+}
+
+void RpcTraceScope::Begin(const char* name,
+                          RpcTraceKind kind,
+                          uint32_t bytes_in) {
+  UNREFERENCED_PARAMETER(name);
+  UNREFERENCED_PARAMETER(kind);
+  UNREFERENCED_PARAMETER(bytes_in);
+}
+
+void RpcTraceScope::End() {
+}
+
+#else  // NACL_WINDOWS
+
+namespace {
+
+struct RpcTraceEvent {
+  const char* name;
+  RpcTraceKind kind;
+  uint32_t bytes_in;
+  uint32_t bytes_out;
+  int32_t result;
+  int64_t start_us;
+  int64_t duration_us;
+  // Argument marshalling charged to a client RPC.
+  int64_t serialize_us;
+};
+
+// Per thread; a power of two.
+const uint32_t kRingSize = 16384;
+
+// The events of one thread. Only the owning thread writes; readers copy the
+// events out and use |next_| to discard the ones that were overwritten
+// while they were copying.
+class RingBuffer {
+ public:
+  RingBuffer()
+      : next_(0), cleared_at_(0), pending_serialize_us_(0), tid_(0),
+        link_(NULL) {}
+
+  void Append(const RpcTraceEvent& event) {
+    events_[next_ & (kRingSize - 1)] = event;
+    // Publish the event before the new index.
+    __sync_synchronize();
+    next_ = next_ + 1;
+  }
+
+  void CopyTo(std::vector<RpcTraceEvent>* events) const {
+    uint32_t end = next_;
+    __sync_synchronize();
+    uint32_t begin = end > kRingSize ? end - kRingSize : 0;
+    // Skip what was there before the last ClearRpcTrace().
+    begin = std::max(begin, std::min(static_cast<uint32_t>(cleared_at_), end));
+    size_t first = events->size();
+    for (uint32_t i = begin; i < end; ++i) {
+      events->push_back(events_[i & (kRingSize - 1)]);
+    }
+    __sync_synchronize();
+    // The writer may have lapped the oldest entries in the meantime.
+    uint32_t now = next_;
+    uint32_t valid_begin = now > kRingSize ? now - kRingSize : 0;
+    if (valid_begin > begin) {
+      size_t stale = std::min(static_cast<size_t>(valid_begin - begin),
+                              events->size() - first);
+      events->erase(events->begin() + first,
+                    events->begin() + first + stale);
+    }
+  }
+
+  void Clear() { cleared_at_ = next_; }
+
+  volatile uint32_t next_;
+  volatile uint32_t cleared_at_;
+  int64_t pending_serialize_us_;
+  int32_t tid_;
+  RingBuffer* link_;
+
+ private:
+  RpcTraceEvent events_[kRingSize];
+  NACL_DISALLOW_COPY_AND_ASSIGN(RingBuffer);
+};
+
+volatile bool tracing_enabled = false;
+pthread_once_t init_once = PTHREAD_ONCE_INIT;
+pthread_key_t buffer_key;
+
+// All buffers ever created, pushed without locks. Buffers outlive their
+// threads so that their events can still be exported.
+RingBuffer* volatile all_buffers = NULL;
+volatile int32_t next_tid = 0;
+
+const char* trace_file = NULL;
+
+int64_t NowMicroseconds() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+void WriteTraceAtExit() {
+  std::string json;
+  ExportRpcTraceJSON(&json);
+  FILE* file = fopen(trace_file, "w");
+  if (file != NULL) {
+    fwrite(json.data(), 1, json.size(), file);
+    fclose(file);
+  }
+  std::string summary;
+  GetRpcLatencySummary(&summary);
+  fputs(summary.c_str(), stderr);
+}
+
+void Initialize() {
+  pthread_key_create(&buffer_key, NULL);
+  trace_file = getenv("PPAPI_PROXY_RPC_TRACE");
+  if (trace_file != NULL && trace_file[0] != '\0') {
+    tracing_enabled = true;
+    atexit(WriteTraceAtExit);
+  }
+}
+
+RingBuffer* GetThreadBuffer() {
+  RingBuffer* buffer =
+      reinterpret_cast<RingBuffer*>(pthread_getspecific(buffer_key));
+  if (buffer == NULL) {
+    buffer = new RingBuffer;
+    buffer->tid_ = __sync_add_and_fetch(&next_tid, 1);
+    RingBuffer* head;
+    do {
+      head = all_buffers;
+      buffer->link_ = head;
+    } while (!__sync_bool_compare_and_swap(&all_buffers, head, buffer));
+    pthread_setspecific(buffer_key, buffer);
+  }
+  return buffer;
+}
+
+void CollectEvents(std::vector<std::pair<int32_t, RpcTraceEvent> >* out) {
+  for (RingBuffer* buffer = all_buffers;
+       buffer != NULL;
+       buffer = buffer->link_) {
+    std::vector<RpcTraceEvent> events;
+    buffer->CopyTo(&events);
+    for (size_t i = 0; i < events.size(); ++i) {
+      out->push_back(std::make_pair(buffer->tid_, events[i]));
+    }
+  }
+}
+
+const char* KindName(RpcTraceKind kind) {
+  switch (kind) {
+    case kRpcTraceClient: return "rpc_client";
+    case kRpcTraceServer: return "rpc_server";
+    case kRpcTraceSerialize: return "serialize";
+    case kRpcTraceDeserialize: return "deserialize";
+  }
+  return "unknown";
+}
+
+void AppendFormat(std::string* out, const char* format, ...) {
+  char buffer[512];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  out->append(buffer);
+}
+
+// Latencies of one method in one direction.
+struct MethodStats {
+  static const int kBuckets = 32;
+
+  MethodStats() : count(0), total_us(0), max_us(0),
+                  bytes_in(0), bytes_out(0), serialize_us(0) {
+    memset(buckets, 0, sizeof(buckets));
+  }
+
+  void Add(const RpcTraceEvent& event) {
+    count++;
+    total_us += event.duration_us;
+    max_us = std::max(max_us, event.duration_us);
+    bytes_in += event.bytes_in;
+    bytes_out += event.bytes_out;
+    serialize_us += event.serialize_us;
+    // Bucket i holds latencies in [2^(i-1), 2^i) microseconds.
+    int bucket = 0;
+    for (int64_t us = event.duration_us; us > 0 && bucket < kBuckets - 1;
+         us >>= 1) {
+      bucket++;
+    }
+    buckets[bucket]++;
+  }
+
+  // Upper bound of the bucket containing the given percentile.
+  int64_t Percentile(int percent) const {
+    uint64_t rank = (count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+      seen += buckets[i];
+      if (seen >= rank && seen > 0) {
+        return static_cast<int64_t>(1) << i;
+      }
+    }
+    return max_us;
+  }
+
+  uint64_t count;
+  int64_t total_us;
+  int64_t max_us;
+  uint64_t bytes_in;
+  uint64_t bytes_out;
+  int64_t serialize_us;
+  uint64_t buckets[kBuckets];
+};
+
+}  // namespace
+
+void EnableRpcTracing(bool enable) {
+  pthread_once(&init_once, Initialize);
+  tracing_enabled = enable;
+}
+
+bool IsRpcTracingEnabled() {
+  pthread_once(&init_once, Initialize);
+  return tracing_enabled;
+}
+
+void ClearRpcTrace() {
+  for (RingBuffer* buffer = all_buffers;
+       buffer != NULL;
+       buffer = buffer->link_) {
+    buffer->Clear();
+  }
+}
+
+void ExportRpcTraceJSON(std::string* json) {
+  std::vector<std::pair<int32_t, RpcTraceEvent> > events;
+  CollectEvents(&events);
+  int pid = getpid();
+
+  json->append("{\"traceEvents\":[");
+  for (size_t i = 0; i < events.size(); ++i) {
+    const RpcTraceEvent& event = events[i].second;
+    if (i != 0) {
+      json->append(",\n");
+    }
+    AppendFormat(json,
+                 "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+                 "\"ts\":%"NACL_PRId64",\"dur\":%"NACL_PRId64","
+                 "\"pid\":%d,\"tid\":%d,\"args\":{"
+                 "\"bytes_in\":%"NACL_PRIu32",\"bytes_out\":%"NACL_PRIu32","
+                 "\"serialize_us\":%"NACL_PRId64",\"result\":%"NACL_PRId32"}}",
+                 event.name, KindName(event.kind),
+                 event.start_us, event.duration_us,
+                 pid, events[i].first,
+                 event.bytes_in, event.bytes_out,
+                 event.serialize_us, event.result);
+  }
+  json->append("]}\n");
+}
+
+void GetRpcLatencySummary(std::string* summary) {
+  std::vector<std::pair<int32_t, RpcTraceEvent> > events;
+  CollectEvents(&events);
+
+  typedef std::map<std::pair<std::string, int>, MethodStats> StatsMap;
+  StatsMap stats;
+  for (size_t i = 0; i < events.size(); ++i) {
+    const RpcTraceEvent& event = events[i].second;
+    stats[std::make_pair(std::string(event.name), event.kind)].Add(event);
+  }
+
+  AppendFormat(summary, "%-40s %-11s %8s %9s %8s %8s %8s %10s %10s %9s\n",
+               "method", "kind", "count", "total_us", "mean_us", "p50_us",
+               "p99_us", "bytes_in", "bytes_out", "marshal");
+  for (StatsMap::const_iterator i = stats.begin(); i != stats.end(); ++i) {
+    const MethodStats& s = i->second;
+    AppendFormat(summary,
+                 "%-40s %-11s %8"NACL_PRIu64" %9"NACL_PRId64
+                 " %8"NACL_PRId64" %8"NACL_PRId64" %8"NACL_PRId64
+                 " %10"NACL_PRIu64" %10"NACL_PRIu64" %9"NACL_PRId64"\n",
+                 i->first.first.c_str(),
+                 KindName(static_cast<RpcTraceKind>(i->first.second)),
+                 s.count, s.total_us,
+                 s.total_us / static_cast<int64_t>(s.count),
+                 s.Percentile(50), s.Percentile(99),
+                 s.bytes_in, s.bytes_out, s.serialize_us);
+    // The histogram, leaving out empty buckets: "<upper bound>:<count>".
+    summary->append("    us histogram:");
+    for (int b = 0; b < MethodStats::kBuckets; ++b) {
+      if (s.buckets[b] != 0) {
+        AppendFormat(summary, " <%"NACL_PRId64":%"NACL_PRIu64,
+                     static_cast<int64_t>(1) << b, s.buckets[b]);
+      }
+    }
+    summary->append("\n");
+  }
+}
+
+void RpcTraceScope::Begin(const char* name,
+                          RpcTraceKind kind,
+                          uint32_t bytes_in) {
+  name_ = name;
+  kind_ = kind;
+  bytes_in_ = bytes_in;
+  bytes_out_ = 0;
+  result_ = 0;
+  serialize_us_ = 0;
+  if (kind == kRpcTraceClient) {
+    RingBuffer* buffer = GetThreadBuffer();
+    serialize_us_ = buffer->pending_serialize_us_;
+    buffer->pending_serialize_us_ = 0;
+  }
+  start_us_ = NowMicroseconds();
+}
+
+void RpcTraceScope::End() {
+  RpcTraceEvent event;
+  event.name = name_;
+  event.kind = kind_;
+  event.bytes_in = bytes_in_;
+  event.bytes_out = bytes_out_;
+  event.result = result_;
+  event.start_us = start_us_;
+  event.duration_us = NowMicroseconds() - start_us_;
+  event.serialize_us = serialize_us_;
+
+  RingBuffer* buffer = GetThreadBuffer();
+  if (kind_ == kRpcTraceSerialize) {
+    buffer->pending_serialize_us_ += event.duration_us;
+  }
+  buffer->Append(event);
+}
+
+#endif  // NACL_WINDOWS
+
+}  // namespace ppapi_proxy
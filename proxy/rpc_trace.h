@@ -0,0 +1,96 @@
+// Copyright (c) 2010 The Native Client Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_PROXY_RPC_TRACE_H_
+#define PPAPI_PROXY_RPC_TRACE_H_
+
+#include <string>
+
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/include/portability.h"
+
+// Structured tracing of the SRPC traffic of the proxy.
+//
+// Every RPC made through the generated clients (PpbRpcClient, PppRpcClient,
+// PppUpcallRpcClient and ObjectStubRpcClient) and every ObjectStub request
+// handled by ObjectStubRpcServer is recorded with its method name, payload
+// sizes and timings. PP_Var marshalling in object_serialize.cc is recorded
+// too, and the time spent serializing arguments is charged to the next RPC
+// the thread makes.
+//
+// SRPC calls are synchronous, so the client side sees the round trip (the
+// transit both ways plus the handling in the other process) and the server
+// side sees the handling time. Exporting the traces of both processes into
+// one viewer shows the transit as the gap between the two.
+//
+// Events go to a fixed size ring buffer owned by the recording thread, so
+// recording takes no locks; when a buffer is full the oldest events are
+// overwritten. Tracing is off unless EnableRpcTracing() is called or the
+// PPAPI_PROXY_RPC_TRACE environment variable names a file, in which case the
+// trace is written there (and the latency summary to stderr) at exit.
+// Tracing is not available on Windows, where all of this is a no-op.
+
+namespace ppapi_proxy {
+
+enum RpcTraceKind {
+  // An RPC invoked by this process.
+  kRpcTraceClient,
+  // An RPC handled by this process.
+  kRpcTraceServer,
+  // PP_Var marshalling.
+  kRpcTraceSerialize,
+  kRpcTraceDeserialize
+};
+
+void EnableRpcTracing(bool enable);
+bool IsRpcTracingEnabled();
+
+// Appends all buffered events in the Chrome trace-event JSON format
+// (chrome://tracing), one "complete" event per RPC.
+void ExportRpcTraceJSON(std::string* json);
+
+// Appends a table of per-method latency statistics over the buffered events,
+// with a log2 histogram of the latencies in microseconds for each method.
+void GetRpcLatencySummary(std::string* summary);
+
+// Drops all buffered events.
+void ClearRpcTrace();
+
+// Records one event spanning the lifetime of the object. |name| must be a
+// string literal (or otherwise outlive the trace).
+class RpcTraceScope {
+ public:
+  RpcTraceScope(const char* name, RpcTraceKind kind, uint32_t bytes_in)
+      : name_(NULL) {
+    if (IsRpcTracingEnabled()) {
+      Begin(name, kind, bytes_in);
+    }
+  }
+  ~RpcTraceScope() {
+    if (name_ != NULL) {
+      End();
+    }
+  }
+
+  void set_bytes_out(uint32_t bytes_out) { bytes_out_ = bytes_out; }
+  void set_result(int32_t result) { result_ = result; }
+
+ private:
+  void Begin(const char* name, RpcTraceKind kind, uint32_t bytes_in);
+  void End();
+
+  // NULL if tracing was off when the scope was entered.
+  const char* name_;
+  RpcTraceKind kind_;
+  uint32_t bytes_in_;
+  uint32_t bytes_out_;
+  int32_t result_;
+  int64_t start_us_;
+  int64_t serialize_us_;
+  NACL_DISALLOW_COPY_AND_ASSIGN(RpcTraceScope);
+};
+
+}  // namespace ppapi_proxy
+
+#endif  // PPAPI_PROXY_RPC_TRACE_H_
@@ -0,0 +1,107 @@
+// Copyright (c) 2010 The Native Client Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/proxy/var_transfer_region.h"
+
+#include <string.h>
+
+namespace ppapi_proxy {
+
+namespace {
+
+// Chunks start on 8 byte boundaries so that payloads of doubles are aligned.
+const uint32_t kChunkAlignment = 8;
+
+}  // namespace
+
+const uint32_t VarTransferRegion::kDefaultSize;
+const uint32_t VarTransferRegion::kMaxInlineBytes;
+
+VarTransferRegion::VarTransferRegion(void* base, uint32_t size, Side side)
+    : base_(reinterpret_cast<char*>(base)) {
+  uint32_t half = size / 2;
+  if (side == kBrowserSide) {
+    write_begin_ = 0;
+    read_begin_ = half;
+  } else {
+    write_begin_ = half;
+    read_begin_ = 0;
+  }
+  write_end_ = write_begin_ + half;
+  read_end_ = read_begin_ + half;
+}
+
+bool VarTransferRegion::Write(const void* data,
+                              uint32_t length,
+                              uint32_t* offset) {
+  const uint32_t kHeaderSize = sizeof(ChunkHeader);
+  if (length > write_end_ - write_begin_ - kHeaderSize) {
+    return false;
+  }
+  uint32_t size =
+      (kHeaderSize + length + kChunkAlignment - 1) & ~(kChunkAlignment - 1);
+  Reclaim();
+  // First fit.  The reader consumes chunks while handling the message that
+  // carries them, so there are rarely more than a few in flight.
+  uint32_t chunk = write_begin_;
+  std::map<uint32_t, uint32_t>::const_iterator it = in_flight_.begin();
+  for (; it != in_flight_.end(); ++it) {
+    if (it->first - chunk >= size) {
+      break;
+    }
+    chunk = it->first + it->second;
+  }
+  if (write_end_ - chunk < size) {
+    return false;
+  }
+  ChunkHeader* header = HeaderAt(chunk);
+  header->length = length;
+  header->state = kChunkInFlight;
+  memcpy(header + 1, data, length);
+  in_flight_[chunk] = size;
+  *offset = chunk;
+  return true;
+}
+
+void VarTransferRegion::Free(uint32_t offset) {
+  in_flight_.erase(offset);
+}
+
+const void* VarTransferRegion::Read(uint32_t offset, uint32_t length) const {
+  const uint32_t kHeaderSize = sizeof(ChunkHeader);
+  // The other side wrote the header; check it against our own bounds.
+  if (offset < read_begin_ || offset >= read_end_ ||
+      offset % kChunkAlignment != 0 ||
+      read_end_ - offset < kHeaderSize ||
+      read_end_ - offset - kHeaderSize < length) {
+    return NULL;
+  }
+  const ChunkHeader* header = HeaderAt(offset);
+  if (header->state != kChunkInFlight || header->length != length) {
+    return NULL;
+  }
+  return header + 1;
+}
+
+void VarTransferRegion::Consume(uint32_t offset) {
+  if (offset < read_begin_ || offset >= read_end_ ||
+      offset % kChunkAlignment != 0 ||
+      read_end_ - offset < sizeof(ChunkHeader)) {
+    return;
+  }
+  HeaderAt(offset)->state = kChunkConsumed;
+}
+
+void VarTransferRegion::Reclaim() {
+  std::map<uint32_t, uint32_t>::iterator it = in_flight_.begin();
+  while (it != in_flight_.end()) {
+    if (HeaderAt(it->first)->state == kChunkConsumed) {
+      in_flight_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace ppapi_proxy
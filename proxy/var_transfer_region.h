@@ -0,0 +1,101 @@
+// Copyright (c) 2010 The Native Client Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_PROXY_VAR_TRANSFER_REGION_H_
+#define PPAPI_PROXY_VAR_TRANSFER_REGION_H_
+
+#include <stddef.h>
+#include <map>
+
+#include "native_client/src/include/nacl_macros.h"
+#include "ppapi/c/pp_stdint.h"
+
+namespace ppapi_proxy {
+
+// A shared memory region the browser and the plugin use to pass large var
+// payloads (binary arrays) without copying them through the SRPC message.
+// The browser creates it when the module is initialized and both sides map
+// it for the lifetime of the channel.
+//
+// The region is split in two halves, one written by each side.  The writer
+// allocates a chunk in its half, copies the payload in, and sends the
+// chunk's offset in the serialized var.  The reader copies the payload out
+// and marks the chunk consumed, after which the writer reuses the space on
+// its next allocation.  The SRPC message that carries the offset orders the
+// writes to the chunk before the reads.
+//
+// Only the state of each chunk is kept in the shared memory; the writer
+// keeps its allocations to itself, so a misbehaving peer can only spoil the
+// payloads it is sent.  The reader validates every chunk it is given.
+//
+// Not thread-safe: vars are only serialized on the main thread.
+class VarTransferRegion {
+ public:
+  // The size of the region the browser creates.
+  static const uint32_t kDefaultSize = 8 << 20;
+  // Payloads up to this many bytes are sent in the SRPC message itself.
+  static const uint32_t kMaxInlineBytes = 4 << 10;
+
+  // Which half of the region this side writes.
+  enum Side {
+    kBrowserSide = 0,
+    kPluginSide = 1
+  };
+
+  // |base| is a mapping of |size| bytes shared with the other side, with
+  // |size| a multiple of 16.  The mapping is not owned.
+  VarTransferRegion(void* base, uint32_t size, Side side);
+  ~VarTransferRegion() { }
+
+  // Copies |length| bytes from |data| into a new chunk in this side's half
+  // and sets |*offset| to the chunk's offset in the region.  Returns false
+  // if there is no room.
+  bool Write(const void* data, uint32_t length, uint32_t* offset);
+
+  // Takes back the chunk at |offset|, previously returned by Write(), when
+  // the message carrying it won't be sent, or the other side is done with
+  // it.  Its space is reused on the next allocation.
+  void Free(uint32_t offset);
+
+  // Returns the payload of the chunk at |offset| in the other side's half,
+  // which must hold exactly |length| bytes, or NULL if there is no such
+  // chunk.  The payload stays valid until Consume() is called.
+  const void* Read(uint32_t offset, uint32_t length) const;
+
+  // Hands the chunk at |offset|, previously returned by Read(), back to the
+  // other side.
+  void Consume(uint32_t offset);
+
+ private:
+  // Precedes every chunk in the region.
+  struct ChunkHeader {
+    volatile uint32_t state;
+    uint32_t length;
+  };
+
+  enum ChunkState {
+    kChunkInFlight = 1,
+    kChunkConsumed = 2
+  };
+
+  ChunkHeader* HeaderAt(uint32_t offset) const {
+    return reinterpret_cast<ChunkHeader*>(base_ + offset);
+  }
+  // Forgets the chunks the reader has consumed.
+  void Reclaim();
+
+  char* base_;
+  // The half this side writes, and the half it reads.
+  uint32_t write_begin_;
+  uint32_t write_end_;
+  uint32_t read_begin_;
+  uint32_t read_end_;
+  // Chunks in flight in this side's half, offset to rounded size.
+  std::map<uint32_t, uint32_t> in_flight_;
+  NACL_DISALLOW_COPY_AND_ASSIGN(VarTransferRegion);
+};
+
+}  // namespace ppapi_proxy
+
+#endif  // PPAPI_PROXY_VAR_TRANSFER_REGION_H_
@@ -0,0 +1,117 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/benchmark_bound_scriptable_object.h"
+
+#include "ppapi/cpp/dev/bound_scriptable_object_deprecated.h"
+
+REGISTER_BENCHMARK(BoundScriptableObject);
+
+namespace {
+
+const char* const kMethodNames[] = {
+  "getWidth", "getHeight", "setZoom", "getZoom", "scrollBy", "scrollTo",
+  "selectAll", "copy", "find", "findNext", "print", "setValue"
+};
+const size_t kMethodCount = sizeof(kMethodNames) / sizeof(kMethodNames[0]);
+
+// The way plugins implement scripting by hand: compares the name with each
+// method it knows, and gets the arguments as a vector.
+class HandWrittenObject : public pp::deprecated::ScriptableObject {
+ public:
+  HandWrittenObject() : value_(0) {}
+
+  virtual bool HasMethod(const pp::Var& name, pp::Var*) {
+    if (!name.is_string())
+      return false;
+    std::string str = name.AsString();
+    for (size_t i = 0; i < kMethodCount; i++) {
+      if (str == kMethodNames[i])
+        return true;
+    }
+    return false;
+  }
+
+  virtual pp::Var Call(const pp::Var& method_name,
+                       const std::vector<pp::Var>& args,
+                       pp::Var* exception) {
+    if (!method_name.is_string())
+      return pp::Var();
+    std::string name = method_name.AsString();
+    if (name == "getWidth" || name == "getHeight" || name == "getZoom")
+      return pp::Var(value_);
+    if (name == "setZoom" || name == "scrollBy" || name == "scrollTo" ||
+        name == "selectAll" || name == "copy" || name == "find" ||
+        name == "findNext" || name == "print")
+      return pp::Var();
+    if (name == "setValue") {
+      if (args.size() != 1 || !args[0].is_number()) {
+        *exception = pp::Var("Bad argument to setValue(<int>)");
+        return pp::Var();
+      }
+      value_ = args[0].AsInt();
+      return pp::Var(value_);
+    }
+    *exception = pp::Var("Bad function call");
+    return pp::Var();
+  }
+
+ private:
+  int32_t value_;
+};
+
+class BoundObject
+    : public pp::deprecated::BoundScriptableObject<BoundObject> {
+ public:
+  BoundObject() : value_(0) {}
+
+  static void BindMethods(Methods* methods) {
+    for (size_t i = 0; i + 1 < kMethodCount; i++)
+      methods->Add(kMethodNames[i], &BoundObject::GetValue);
+    methods->Add("setValue", &BoundObject::SetValue);
+  }
+
+ private:
+  int32_t GetValue() { return value_; }
+  int32_t SetValue(int32_t value) {
+    value_ = value;
+    return value_;
+  }
+
+  int32_t value_;
+};
+
+}  // namespace
+
+bool BenchmarkBoundScriptableObject::Init() {
+  hand_written_ = pp::Var(new HandWrittenObject);
+  bound_ = pp::Var(new BoundObject);
+  // The last method of the chain.
+  method_name_ = pp::Var("setValue");
+  arg_ = pp::Var(42);
+  return true;
+}
+
+void BenchmarkBoundScriptableObject::RunBenchmarks() {
+  RUN_BENCHMARK(BenchmarkBoundScriptableObject, HandWrittenCall);
+  RUN_BENCHMARK(BenchmarkBoundScriptableObject, BoundCall);
+  RUN_BENCHMARK(BenchmarkBoundScriptableObject, HandWrittenHasMethod);
+  RUN_BENCHMARK(BenchmarkBoundScriptableObject, BoundHasMethod);
+}
+
+void BenchmarkBoundScriptableObject::BenchmarkHandWrittenCall() {
+  hand_written_.Call(method_name_, arg_);
+}
+
+void BenchmarkBoundScriptableObject::BenchmarkBoundCall() {
+  bound_.Call(method_name_, arg_);
+}
+
+void BenchmarkBoundScriptableObject::BenchmarkHandWrittenHasMethod() {
+  hand_written_.HasMethod(method_name_);
+}
+
+void BenchmarkBoundScriptableObject::BenchmarkBoundHasMethod() {
+  bound_.HasMethod(method_name_);
+}
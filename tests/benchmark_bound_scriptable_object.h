@@ -0,0 +1,37 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_BENCHMARK_BOUND_SCRIPTABLE_OBJECT_H_
+#define PPAPI_TESTS_BENCHMARK_BOUND_SCRIPTABLE_OBJECT_H_
+
+#include "ppapi/cpp/var.h"
+#include "ppapi/tests/benchmark_case.h"
+
+// Calls from script into an object with a dozen methods, implemented with a
+// chain of name comparisons and with pp::deprecated::BoundScriptableObject.
+class BenchmarkBoundScriptableObject : public BenchmarkCase {
+ public:
+  BenchmarkBoundScriptableObject(TestingInstance* instance)
+      : BenchmarkCase(instance) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+
+ protected:
+  // BenchmarkCase implementation.
+  virtual void RunBenchmarks();
+
+ private:
+  void BenchmarkHandWrittenCall();
+  void BenchmarkBoundCall();
+  void BenchmarkHandWrittenHasMethod();
+  void BenchmarkBoundHasMethod();
+
+  pp::Var hand_written_;
+  pp::Var bound_;
+  pp::Var method_name_;
+  pp::Var arg_;
+};
+
+#endif  // PPAPI_TESTS_BENCHMARK_BOUND_SCRIPTABLE_OBJECT_H_
@@ -0,0 +1,154 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/benchmark_case.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/var.h"
+#include "ppapi/tests/testing_instance.h"
+
+namespace {
+
+// A sample must take at least this long for the clock to be trustworthy.
+const PP_TimeTicks kMinSampleSeconds = 0.01;
+
+// Calibration stops doubling here even if the body is still too fast to time.
+const int kMaxIterations = 1 << 24;
+
+const int kDefaultWarmupSamples = 3;
+const int kDefaultSamples = 15;
+
+std::string FormatDouble(double value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.1f", value);
+  return buffer;
+}
+
+std::string FormatInt(int value) {
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%d", value);
+  return buffer;
+}
+
+}  // namespace
+
+BenchmarkCase::BenchmarkCase(TestingInstance* instance)
+    : TestCase(instance),
+      warmup_samples_(kDefaultWarmupSamples),
+      samples_(kDefaultSamples) {
+}
+
+void BenchmarkCase::RunTest() {
+  results_.clear();
+  RunBenchmarks();
+
+  // This does:
+  //   window.document.getElementById("benchmark_results").innerHTML = json
+  pp::Var results = instance_->GetWindowObject().GetProperty("document").
+      Call("getElementById", "benchmark_results");
+  results.SetProperty("innerHTML", ResultsToJSON());
+}
+
+void BenchmarkCase::Fail(const std::string& message) {
+  if (failure_.empty())
+    failure_ = message;
+}
+
+void BenchmarkCase::Measure(const char* name, Thunk* thunk) {
+  failure_.clear();
+
+  // Calibrate. The calibration runs double as the first warmup.
+  int iterations = 1;
+  PP_TimeTicks elapsed = TimeIterations(thunk, iterations);
+  while (failure_.empty() && elapsed < kMinSampleSeconds &&
+         iterations < kMaxIterations) {
+    iterations *= 2;
+    elapsed = TimeIterations(thunk, iterations);
+  }
+
+  for (int i = 0; i < warmup_samples_ && failure_.empty(); i++)
+    TimeIterations(thunk, iterations);
+
+  std::vector<double> samples;
+  for (int i = 0; i < samples_ && failure_.empty(); i++) {
+    samples.push_back(
+        TimeIterations(thunk, iterations) * 1e9 / iterations);
+  }
+
+  if (!failure_.empty() || samples.empty()) {
+    instance_->LogTest(name, failure_.empty() ? "No samples" : failure_);
+    return;
+  }
+
+  std::sort(samples.begin(), samples.end());
+  size_t count = samples.size();
+
+  Result result;
+  result.name = name;
+  result.iterations = iterations;
+  result.samples = static_cast<int>(count);
+  result.min = samples[0];
+  if (count % 2)
+    result.median = samples[count / 2];
+  else
+    result.median = (samples[count / 2 - 1] + samples[count / 2]) / 2;
+  // Nearest rank: the smallest sample that at least 99% of the samples don't
+  // exceed. With few samples this is the maximum.
+  size_t rank = (count * 99 + 99) / 100;
+  result.p99 = samples[std::min(rank, count) - 1];
+  double sum = 0;
+  for (size_t i = 0; i < count; i++)
+    sum += samples[i];
+  result.mean = sum / count;
+
+  results_.push_back(result);
+  LogResult(result);
+}
+
+PP_TimeTicks BenchmarkCase::TimeIterations(Thunk* thunk, int iterations) {
+  pp::Core* core = pp::Module::Get()->core();
+  PP_TimeTicks start = core->GetTimeTicks();
+  for (int i = 0; i < iterations; i++)
+    thunk->Run();
+  return core->GetTimeTicks() - start;
+}
+
+void BenchmarkCase::LogResult(const Result& result) {
+  std::string html;
+  html.append("<div class=\"test_line\"><span class=\"test_name\">");
+  html.append(result.name);
+  html.append("</span> ");
+  html.append("median " + FormatDouble(result.median) + " ns, ");
+  html.append("min " + FormatDouble(result.min) + " ns, ");
+  html.append("p99 " + FormatDouble(result.p99) + " ns ");
+  html.append("(" + FormatInt(result.samples) + " x " +
+              FormatInt(result.iterations) + " iterations)");
+  html.append("</div>");
+  instance_->LogHTML(html);
+}
+
+std::string BenchmarkCase::ResultsToJSON() const {
+  // Names are C identifiers, so nothing needs escaping.
+  std::string json;
+  json.append("{\"case\":\"" + name_ + "\",\"unit\":\"ns\",\"benchmarks\":[");
+  for (size_t i = 0; i < results_.size(); i++) {
+    const Result& result = results_[i];
+    if (i)
+      json.append(",");
+    json.append("{\"name\":\"" + result.name + "\"");
+    json.append(",\"iterations\":" + FormatInt(result.iterations));
+    json.append(",\"samples\":" + FormatInt(result.samples));
+    json.append(",\"min\":" + FormatDouble(result.min));
+    json.append(",\"median\":" + FormatDouble(result.median));
+    json.append(",\"p99\":" + FormatDouble(result.p99));
+    json.append(",\"mean\":" + FormatDouble(result.mean));
+    json.append("}");
+  }
+  json.append("]}");
+  return json;
+}
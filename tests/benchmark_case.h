@@ -0,0 +1,153 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_BENCHMARK_CASE_H_
+#define PPAPI_TESTS_BENCHMARK_CASE_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_time.h"
+#include "ppapi/tests/test_case.h"
+
+// Individual classes of benchmarks derive from this. A benchmark case is a
+// TestCase, so TestingInstance creates it from the "testcase" attribute and
+// runs it like any other, but instead of checking results it times each of
+// its benchmarks.
+//
+// Every benchmark is first calibrated: the number of iterations per sample is
+// doubled until one sample takes at least kMinSampleSeconds, so that timer
+// resolution doesn't matter. Then a few warmup samples are thrown away and
+// the remaining samples are summarized as min/median/p99/mean time per
+// iteration.
+//
+// The results are logged to the console and also stored as JSON in the
+// "benchmark_results" element of the page, where a driver such as the
+// headless runner can pick them up:
+//
+//   {"case":"PaintAggregator","unit":"ns","benchmarks":[
+//     {"name":"DisjointInvalidations","iterations":4096,"samples":15,
+//      "min":812.5,"median":820.1,"p99":911.0,"mean":831.7}, ...]}
+class BenchmarkCase : public TestCase {
+ public:
+  BenchmarkCase(TestingInstance* instance);
+
+  // TestCase implementation. Runs RunBenchmarks() and reports the results.
+  // Benchmarks must not override this; override RunBenchmarks() instead.
+  virtual void RunTest();
+
+  // The name the case was registered under, used in the JSON output.
+  void set_name(const char* name) { name_ = name; }
+
+ protected:
+  // Override to call RUN_BENCHMARK for each benchmark in the case.
+  virtual void RunBenchmarks() = 0;
+
+  // Times |method| on |object| and records the result under |name|. Each
+  // call of |method| is one iteration and must leave |object| in a state
+  // where it can be called again.
+  template <class T>
+  void RunBenchmark(const char* name, T* object, void (T::*method)()) {
+    MethodThunk<T> thunk(object, method);
+    Measure(name, &thunk);
+  }
+
+  // Marks the benchmark currently running as failed; its timings are
+  // discarded and the failure is logged instead.
+  void Fail(const std::string& message);
+
+  // Options, to be set from the constructor of the derived class.
+  void set_warmup_samples(int count) { warmup_samples_ = count; }
+  void set_samples(int count) { samples_ = count; }
+
+ private:
+  class Thunk {
+   public:
+    virtual ~Thunk() {}
+    virtual void Run() = 0;
+  };
+
+  template <class T>
+  class MethodThunk : public Thunk {
+   public:
+    MethodThunk(T* object, void (T::*method)())
+        : object_(object), method_(method) {}
+    virtual void Run() { (object_->*method_)(); }
+
+   private:
+    T* object_;
+    void (T::*method_)();
+  };
+
+  struct Result {
+    std::string name;
+    int iterations;
+    int samples;
+    // Nanoseconds per iteration.
+    double min;
+    double median;
+    double p99;
+    double mean;
+  };
+
+  void Measure(const char* name, Thunk* thunk);
+
+  // Runs |iterations| iterations of |thunk| and returns the elapsed time.
+  PP_TimeTicks TimeIterations(Thunk* thunk, int iterations);
+
+  void LogResult(const Result& result);
+  std::string ResultsToJSON() const;
+
+  std::string name_;
+  int warmup_samples_;
+  int samples_;
+
+  // Set by Fail() while a benchmark is being measured.
+  std::string failure_;
+
+  std::vector<Result> results_;
+};
+
+// This class is an implementation detail of REGISTER_BENCHMARK. It registers
+// the benchmark case as a test case and tells it its name on creation.
+template <class T>
+class BenchmarkCaseFactory {
+ public:
+  explicit BenchmarkCaseFactory(const char* name)
+      : test_case_factory_(name, &Create) {
+    name_ = name;
+  }
+
+ private:
+  static TestCase* Create(TestingInstance* instance) {
+    T* benchmark = new T(instance);
+    benchmark->set_name(name_);
+    return benchmark;
+  }
+
+  TestCaseFactory test_case_factory_;
+
+  static const char* name_;
+};
+
+template <class T>
+const char* BenchmarkCaseFactory<T>::name_ = NULL;
+
+// Use the REGISTER_BENCHMARK macro in your BenchmarkCase implementation file
+// to register your benchmarks. If your benchmark case is named BenchmarkFoo,
+// then add the following to benchmark_foo.cc:
+//
+//   REGISTER_BENCHMARK(Foo);
+//
+// and run it by using "Foo" as the test case.
+#define REGISTER_BENCHMARK(name) \
+  static BenchmarkCaseFactory<Benchmark##name> g_Benchmark##name##_factory(#name)
+
+// Helper macro for timing the functions implementing specific benchmarks in
+// RunBenchmarks. This assumes the function is klass::BenchmarkFoo where Foo is
+// the benchmark name.
+#define RUN_BENCHMARK(klass, name) \
+  RunBenchmark(#name, this, &klass::Benchmark##name)
+
+#endif  // PPAPI_TESTS_BENCHMARK_CASE_H_
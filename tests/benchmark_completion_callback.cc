@@ -0,0 +1,56 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/benchmark_completion_callback.h"
+
+#include <vector>
+
+REGISTER_BENCHMARK(CompletionCallback);
+
+BenchmarkCompletionCallback::BenchmarkCompletionCallback(
+    TestingInstance* instance)
+    : BenchmarkCase(instance),
+      sink_(0) {
+  factory_.Initialize(this);
+}
+
+void BenchmarkCompletionCallback::RunBenchmarks() {
+  RUN_BENCHMARK(BenchmarkCompletionCallback, NewAndRun);
+  RUN_BENCHMARK(BenchmarkCompletionCallback, NewAndRunWithArgument);
+  RUN_BENCHMARK(BenchmarkCompletionCallback, CancelAll);
+}
+
+void BenchmarkCompletionCallback::BenchmarkNewAndRun() {
+  // What every asynchronous call costs on the plugin side: allocating the
+  // callback data and dispatching through it once.
+  factory_.NewCallback(&BenchmarkCompletionCallback::OnComplete).Run(1);
+}
+
+void BenchmarkCompletionCallback::BenchmarkNewAndRunWithArgument() {
+  factory_.NewCallback(&BenchmarkCompletionCallback::OnCompleteWithArgument,
+                       2).Run(1);
+}
+
+void BenchmarkCompletionCallback::BenchmarkCancelAll() {
+  // Cancelling invalidates the back pointer shared by outstanding callbacks;
+  // they still have to be run to free their memory.
+  const int kPending = 16;
+  std::vector<pp::CompletionCallback> callbacks;
+  for (int i = 0; i < kPending; i++) {
+    callbacks.push_back(
+        factory_.NewCallback(&BenchmarkCompletionCallback::OnComplete));
+  }
+  factory_.CancelAll();
+  for (int i = 0; i < kPending; i++)
+    callbacks[i].Run(1);
+}
+
+void BenchmarkCompletionCallback::OnComplete(int32_t result) {
+  sink_ += result;
+}
+
+void BenchmarkCompletionCallback::OnCompleteWithArgument(int32_t result,
+                                                         int value) {
+  sink_ += result + value;
+}
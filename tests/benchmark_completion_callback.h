@@ -0,0 +1,33 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_BENCHMARK_COMPLETION_CALLBACK_H_
+#define PPAPI_TESTS_BENCHMARK_COMPLETION_CALLBACK_H_
+
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/tests/benchmark_case.h"
+
+class BenchmarkCompletionCallback : public BenchmarkCase {
+ public:
+  BenchmarkCompletionCallback(TestingInstance* instance);
+
+ protected:
+  // BenchmarkCase implementation.
+  virtual void RunBenchmarks();
+
+ private:
+  void BenchmarkNewAndRun();
+  void BenchmarkNewAndRunWithArgument();
+  void BenchmarkCancelAll();
+
+  void OnComplete(int32_t result);
+  void OnCompleteWithArgument(int32_t result, int value);
+
+  pp::CompletionCallbackFactory<BenchmarkCompletionCallback> factory_;
+
+  // Keeps the compiler from eliding the callbacks.
+  int32_t sink_;
+};
+
+#endif  // PPAPI_TESTS_BENCHMARK_COMPLETION_CALLBACK_H_
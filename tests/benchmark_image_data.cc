@@ -0,0 +1,65 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/benchmark_image_data.h"
+
+#include <string.h>
+
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/size.h"
+
+REGISTER_BENCHMARK(ImageData);
+
+namespace {
+
+// A typical plugin backing store.
+const int kWidth = 512;
+const int kHeight = 512;
+
+const uint32_t kColor = 0xFF336699;
+
+}  // namespace
+
+bool BenchmarkImageData::Init() {
+  image_ = pp::ImageData(pp::ImageData::GetNativeImageDataFormat(),
+                         pp::Size(kWidth, kHeight), false);
+  return !image_.is_null();
+}
+
+void BenchmarkImageData::RunBenchmarks() {
+  RUN_BENCHMARK(BenchmarkImageData, Create);
+  RUN_BENCHMARK(BenchmarkImageData, FillPerPixel);
+  RUN_BENCHMARK(BenchmarkImageData, FillPerRow);
+  RUN_BENCHMARK(BenchmarkImageData, FillMemset);
+}
+
+void BenchmarkImageData::BenchmarkCreate() {
+  pp::ImageData image(pp::ImageData::GetNativeImageDataFormat(),
+                      pp::Size(kWidth, kHeight), true);
+  if (image.is_null())
+    Fail("Couldn't create image");
+}
+
+void BenchmarkImageData::BenchmarkFillPerPixel() {
+  // The naive loop: one address computation per pixel.
+  for (int y = 0; y < kHeight; y++) {
+    for (int x = 0; x < kWidth; x++)
+      *image_.GetAddr32(pp::Point(x, y)) = kColor;
+  }
+}
+
+void BenchmarkImageData::BenchmarkFillPerRow() {
+  for (int y = 0; y < kHeight; y++) {
+    uint32_t* row = image_.GetAddr32(pp::Point(0, y));
+    for (int x = 0; x < kWidth; x++)
+      row[x] = kColor;
+  }
+}
+
+void BenchmarkImageData::BenchmarkFillMemset() {
+  // The lower bound for any fill, even though it can only write one byte
+  // value.
+  char* data = static_cast<char*>(image_.data());
+  memset(data, 0x7F, image_.stride() * kHeight);
+}
@@ -0,0 +1,31 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_BENCHMARK_IMAGE_DATA_H_
+#define PPAPI_TESTS_BENCHMARK_IMAGE_DATA_H_
+
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/tests/benchmark_case.h"
+
+class BenchmarkImageData : public BenchmarkCase {
+ public:
+  BenchmarkImageData(TestingInstance* instance) : BenchmarkCase(instance) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+
+ protected:
+  // BenchmarkCase implementation.
+  virtual void RunBenchmarks();
+
+ private:
+  void BenchmarkCreate();
+  void BenchmarkFillPerPixel();
+  void BenchmarkFillPerRow();
+  void BenchmarkFillMemset();
+
+  pp::ImageData image_;
+};
+
+#endif  // PPAPI_TESTS_BENCHMARK_IMAGE_DATA_H_
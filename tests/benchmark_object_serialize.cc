@@ -0,0 +1,173 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/benchmark_object_serialize.h"
+
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/var.h"
+#include "ppapi/proxy/browser_globals.h"
+#include "ppapi/proxy/object_serialize.h"
+#include "ppapi/proxy/var_transfer_region.h"
+
+REGISTER_BENCHMARK(ObjectSerialize);
+
+namespace {
+
+// Roughly the argument list of a scripting call.
+const uint32_t kVarCount = 8;
+
+// Serialize() takes the maximum acceptable length.
+const uint32_t kMaxLength = 1 << 20;
+
+// Small arrays are copied through the message, large ones go through the
+// transfer region.
+const uint32_t kSmallArrayCount = 256;
+const uint32_t kLargeArrayCount = 64 * 1024;
+
+int g_channel_tag;
+int g_peer_channel_tag;
+
+}  // namespace
+
+BenchmarkObjectSerialize::BenchmarkObjectSerialize(TestingInstance* instance)
+    : BenchmarkCase(instance),
+      channel_(reinterpret_cast<NaClSrpcChannel*>(&g_channel_tag)),
+      peer_channel_(reinterpret_cast<NaClSrpcChannel*>(&g_peer_channel_tag)),
+      region_(NULL),
+      peer_region_(NULL) {
+}
+
+BenchmarkObjectSerialize::~BenchmarkObjectSerialize() {
+  for (size_t i = 0; i < strings_.size(); i++)
+    pp::Var(pp::Var::PassRef(), strings_[i]);
+  ppapi_proxy::UnsetModuleIdForSrpcChannel(channel_);
+  if (region_) {
+    ppapi_proxy::UnsetVarTransferRegionForSrpcChannel(channel_);
+    ppapi_proxy::UnsetVarTransferRegionForSrpcChannel(peer_channel_);
+    ppapi_proxy::UnsetModuleIdForSrpcChannel(peer_channel_);
+    delete region_;
+    delete peer_region_;
+  }
+}
+
+bool BenchmarkObjectSerialize::Init() {
+  pp::Module* module = pp::Module::Get();
+  ppapi_proxy::SetBrowserGetInterface(module->get_browser_interface());
+  ppapi_proxy::SetModuleIdForSrpcChannel(channel_, module->pp_module());
+
+  for (uint32_t i = 0; i < kVarCount; i++) {
+    switch (i % 4) {
+      case 0: scalars_.push_back(PP_MakeInt32(i)); break;
+      case 1: scalars_.push_back(PP_MakeDouble(i + 0.5)); break;
+      case 2: scalars_.push_back(PP_MakeBool(true)); break;
+      default: scalars_.push_back(PP_MakeUndefined()); break;
+    }
+    // Ownership of the string is kept in |strings_|.
+    strings_.push_back(pp::Var("innerHTML").Detach());
+  }
+
+  uint32_t length = kMaxLength;
+  char* bytes = ppapi_proxy::Serialize(channel_, &scalars_[0], kVarCount,
+                                       &length);
+  if (!bytes)
+    return false;
+  serialized_scalars_.assign(bytes, bytes + length);
+  delete[] bytes;
+
+  length = kMaxLength;
+  bytes = ppapi_proxy::Serialize(channel_, &strings_[0], kVarCount, &length);
+  if (!bytes)
+    return false;
+  serialized_strings_.assign(bytes, bytes + length);
+  delete[] bytes;
+
+  const uint32_t kRegionSize = ppapi_proxy::VarTransferRegion::kDefaultSize;
+  region_memory_.resize(kRegionSize / sizeof(double));
+  region_ = new ppapi_proxy::VarTransferRegion(
+      &region_memory_[0], kRegionSize,
+      ppapi_proxy::VarTransferRegion::kBrowserSide);
+  peer_region_ = new ppapi_proxy::VarTransferRegion(
+      &region_memory_[0], kRegionSize,
+      ppapi_proxy::VarTransferRegion::kPluginSide);
+  ppapi_proxy::SetVarTransferRegionForSrpcChannel(channel_, region_);
+  ppapi_proxy::SetVarTransferRegionForSrpcChannel(peer_channel_, peer_region_);
+  ppapi_proxy::SetModuleIdForSrpcChannel(peer_channel_, module->pp_module());
+  small_array_ = pp::Var(PP_BINARYARRAYTYPE_FLOAT32, kSmallArrayCount, NULL);
+  large_array_ = pp::Var(PP_BINARYARRAYTYPE_FLOAT32, kLargeArrayCount, NULL);
+  return small_array_.is_binary_array() && large_array_.is_binary_array();
+}
+
+void BenchmarkObjectSerialize::RunBenchmarks() {
+  RUN_BENCHMARK(BenchmarkObjectSerialize, SerializeScalars);
+  RUN_BENCHMARK(BenchmarkObjectSerialize, SerializeStrings);
+  RUN_BENCHMARK(BenchmarkObjectSerialize, DeserializeScalars);
+  RUN_BENCHMARK(BenchmarkObjectSerialize, DeserializeStrings);
+  RUN_BENCHMARK(BenchmarkObjectSerialize, RoundTripSmallBinaryArray);
+  RUN_BENCHMARK(BenchmarkObjectSerialize, RoundTripLargeBinaryArray);
+}
+
+void BenchmarkObjectSerialize::BenchmarkSerializeScalars() {
+  Serialize(scalars_);
+}
+
+void BenchmarkObjectSerialize::BenchmarkSerializeStrings() {
+  Serialize(strings_);
+}
+
+void BenchmarkObjectSerialize::BenchmarkDeserializeScalars() {
+  Deserialize(&serialized_scalars_, scalars_.size());
+}
+
+void BenchmarkObjectSerialize::BenchmarkDeserializeStrings() {
+  Deserialize(&serialized_strings_, strings_.size());
+}
+
+void BenchmarkObjectSerialize::BenchmarkRoundTripSmallBinaryArray() {
+  RoundTrip(small_array_);
+}
+
+void BenchmarkObjectSerialize::BenchmarkRoundTripLargeBinaryArray() {
+  RoundTrip(large_array_);
+}
+
+void BenchmarkObjectSerialize::Serialize(const std::vector<PP_Var>& vars) {
+  uint32_t length = kMaxLength;
+  char* bytes = ppapi_proxy::Serialize(channel_,
+                                       &vars[0],
+                                       static_cast<uint32_t>(vars.size()),
+                                       &length);
+  if (!bytes)
+    Fail("Serialize failed");
+  delete[] bytes;
+}
+
+void BenchmarkObjectSerialize::Deserialize(std::vector<char>* bytes,
+                                           size_t argc) {
+  PP_Var vars[kVarCount];
+  if (!ppapi_proxy::DeserializeTo(channel_, &(*bytes)[0],
+                                  static_cast<uint32_t>(bytes->size()),
+                                  static_cast<uint32_t>(argc), vars)) {
+    Fail("DeserializeTo failed");
+    return;
+  }
+  // Deserialized strings are new references.
+  for (size_t i = 0; i < argc; i++)
+    pp::Var(pp::Var::PassRef(), vars[i]);
+}
+
+void BenchmarkObjectSerialize::RoundTrip(const pp::Var& var) {
+  uint32_t length = kMaxLength;
+  PP_Var pp_var = var.pp_var();
+  char* bytes = ppapi_proxy::Serialize(channel_, &pp_var, 1, &length);
+  if (!bytes) {
+    Fail("Serialize failed");
+    return;
+  }
+  PP_Var result;
+  if (ppapi_proxy::DeserializeTo(peer_channel_, bytes, length, 1, &result))
+    pp::Var(pp::Var::PassRef(), result);
+  else
+    Fail("DeserializeTo failed");
+  delete[] bytes;
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_BENCHMARK_OBJECT_SERIALIZE_H_
+#define PPAPI_TESTS_BENCHMARK_OBJECT_SERIALIZE_H_
+
+#include <vector>
+
+#include "ppapi/c/pp_var.h"
+#include "ppapi/cpp/var.h"
+#include "ppapi/tests/benchmark_case.h"
+
+struct NaClSrpcChannel;
+
+namespace ppapi_proxy {
+class VarTransferRegion;
+}
+
+// Times the PP_Var wire format of the NaCl proxy. Only vars that don't need
+// an SRPC connection (no objects) are used, so the browser side of the proxy
+// can be driven directly from inside the module.
+class BenchmarkObjectSerialize : public BenchmarkCase {
+ public:
+  BenchmarkObjectSerialize(TestingInstance* instance);
+  virtual ~BenchmarkObjectSerialize();
+
+  // TestCase implementation.
+  virtual bool Init();
+
+ protected:
+  // BenchmarkCase implementation.
+  virtual void RunBenchmarks();
+
+ private:
+  void BenchmarkSerializeScalars();
+  void BenchmarkSerializeStrings();
+  void BenchmarkDeserializeScalars();
+  void BenchmarkDeserializeStrings();
+  void BenchmarkRoundTripSmallBinaryArray();
+  void BenchmarkRoundTripLargeBinaryArray();
+
+  void Serialize(const std::vector<PP_Var>& vars);
+  // |bytes| isn't modified; DeserializeTo just doesn't take a const buffer.
+  void Deserialize(std::vector<char>* bytes, size_t argc);
+  // Serializes |var| on |channel_| and deserializes it on |peer_channel_|.
+  void RoundTrip(const pp::Var& var);
+
+  // Stands in for the channel of a real module; the proxy only uses it to
+  // look up the module that owns deserialized vars and the transfer region.
+  NaClSrpcChannel* channel_;
+  // The other end, for vars that pass through the shared transfer region.
+  // Both regions are views of |region_memory_|.
+  NaClSrpcChannel* peer_channel_;
+  std::vector<double> region_memory_;
+  ppapi_proxy::VarTransferRegion* region_;
+  ppapi_proxy::VarTransferRegion* peer_region_;
+
+  std::vector<PP_Var> scalars_;
+  std::vector<PP_Var> strings_;
+  std::vector<char> serialized_scalars_;
+  std::vector<char> serialized_strings_;
+  pp::Var small_array_;
+  pp::Var large_array_;
+};
+
+#endif  // PPAPI_TESTS_BENCHMARK_OBJECT_SERIALIZE_H_
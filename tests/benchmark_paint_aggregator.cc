@@ -0,0 +1,70 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/benchmark_paint_aggregator.h"
+
+#include "ppapi/cpp/paint_aggregator.h"
+
+REGISTER_BENCHMARK(PaintAggregator);
+
+namespace {
+
+// Each iteration aggregates one frame's worth of updates for a view of this
+// size and then takes the pending update, like a plugin's paint loop does.
+const int kViewWidth = 800;
+const int kViewHeight = 600;
+
+// Forces the aggregator to actually produce the update.
+void Consume(pp::PaintAggregator* greg) {
+  pp::PaintAggregator::PaintUpdate update = greg->GetPendingUpdate();
+  greg->ClearPendingUpdate();
+}
+
+}  // namespace
+
+void BenchmarkPaintAggregator::RunBenchmarks() {
+  RUN_BENCHMARK(BenchmarkPaintAggregator, DisjointInvalidations);
+  RUN_BENCHMARK(BenchmarkPaintAggregator, OverlappingInvalidations);
+  RUN_BENCHMARK(BenchmarkPaintAggregator, InvalidationsAfterScroll);
+  RUN_BENCHMARK(BenchmarkPaintAggregator, RepeatedScrolls);
+}
+
+void BenchmarkPaintAggregator::BenchmarkDisjointInvalidations() {
+  // A grid of small rects, enough to exceed max_paint_rects and make the
+  // aggregator combine them.
+  pp::PaintAggregator greg;
+  for (int y = 0; y < kViewHeight; y += 100) {
+    for (int x = 0; x < kViewWidth; x += 100)
+      greg.InvalidateRect(pp::Rect(x, y, 10, 10));
+  }
+  Consume(&greg);
+}
+
+void BenchmarkPaintAggregator::BenchmarkOverlappingInvalidations() {
+  // Text-caret style updates that keep hitting the same region.
+  pp::PaintAggregator greg;
+  for (int i = 0; i < 50; i++)
+    greg.InvalidateRect(pp::Rect(100 + i, 100, 20, 20));
+  Consume(&greg);
+}
+
+void BenchmarkPaintAggregator::BenchmarkInvalidationsAfterScroll() {
+  pp::PaintAggregator greg;
+  pp::Rect view(0, 0, kViewWidth, kViewHeight);
+  greg.ScrollRect(view, pp::Point(0, -20));
+  for (int y = 0; y < kViewHeight; y += 60)
+    greg.InvalidateRect(pp::Rect(10, y, 200, 15));
+  Consume(&greg);
+}
+
+void BenchmarkPaintAggregator::BenchmarkRepeatedScrolls() {
+  // Scrolling a few lines per event before the plugin gets to paint.
+  pp::PaintAggregator greg;
+  pp::Rect view(0, 0, kViewWidth, kViewHeight);
+  for (int i = 0; i < 10; i++) {
+    greg.ScrollRect(view, pp::Point(0, -15));
+    greg.InvalidateRect(pp::Rect(0, kViewHeight - 15, kViewWidth, 15));
+  }
+  Consume(&greg);
+}
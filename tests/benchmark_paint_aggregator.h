@@ -0,0 +1,26 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_BENCHMARK_PAINT_AGGREGATOR_H_
+#define PPAPI_TESTS_BENCHMARK_PAINT_AGGREGATOR_H_
+
+#include "ppapi/tests/benchmark_case.h"
+
+class BenchmarkPaintAggregator : public BenchmarkCase {
+ public:
+  BenchmarkPaintAggregator(TestingInstance* instance)
+      : BenchmarkCase(instance) {}
+
+ protected:
+  // BenchmarkCase implementation.
+  virtual void RunBenchmarks();
+
+ private:
+  void BenchmarkDisjointInvalidations();
+  void BenchmarkOverlappingInvalidations();
+  void BenchmarkInvalidationsAfterScroll();
+  void BenchmarkRepeatedScrolls();
+};
+
+#endif  // PPAPI_TESTS_BENCHMARK_PAINT_AGGREGATOR_H_
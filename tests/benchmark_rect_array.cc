@@ -0,0 +1,114 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/benchmark_rect_array.h"
+
+#include "ppapi/cpp/point.h"
+
+REGISTER_BENCHMARK(RectArray);
+
+namespace {
+
+const size_t kRectCount = 10000;
+
+// The rects are scattered over a large document, like the damage or the
+// hit test regions of a long page.
+const int32_t kDocumentWidth = 2000;
+const int32_t kDocumentHeight = 20000;
+
+// Contains every rect, so that intersecting with it leaves them as they are
+// and each iteration does the same work.
+const pp::Rect kClip(-100, -100, kDocumentWidth + 200, kDocumentHeight + 200);
+
+// Outside every rect, so that the searches look at all of them.
+const pp::Point kMissPoint(-50, -50);
+const pp::Rect kMissRect(-80, -80, 10, 10);
+
+}  // namespace
+
+bool BenchmarkRectArray::Init() {
+  uint32_t seed = 1;
+  for (size_t i = 0; i < kRectCount; i++) {
+    seed = seed * 1103515245 + 12345;
+    int32_t x = static_cast<int32_t>((seed >> 8) % kDocumentWidth);
+    seed = seed * 1103515245 + 12345;
+    int32_t y = static_cast<int32_t>((seed >> 8) % kDocumentHeight);
+    rects_.push_back(pp::Rect(x, y, 10 + i % 90, 10 + i % 40));
+  }
+  array_.Append(rects_);
+  return true;
+}
+
+void BenchmarkRectArray::RunBenchmarks() {
+  RUN_BENCHMARK(BenchmarkRectArray, UnionLoop);
+  RUN_BENCHMARK(BenchmarkRectArray, UnionAll);
+  RUN_BENCHMARK(BenchmarkRectArray, IntersectLoop);
+  RUN_BENCHMARK(BenchmarkRectArray, IntersectAll);
+  RUN_BENCHMARK(BenchmarkRectArray, ContainsPointLoop);
+  RUN_BENCHMARK(BenchmarkRectArray, ContainsPointAny);
+  RUN_BENCHMARK(BenchmarkRectArray, TouchingLoop);
+  RUN_BENCHMARK(BenchmarkRectArray, FindTouching);
+  RUN_BENCHMARK(BenchmarkRectArray, AreaLoop);
+  RUN_BENCHMARK(BenchmarkRectArray, AreaSum);
+}
+
+void BenchmarkRectArray::BenchmarkUnionLoop() {
+  pp::Rect bounds;
+  for (size_t i = 0; i < rects_.size(); i++)
+    bounds = bounds.Union(rects_[i]);
+  sink_ += bounds.width();
+}
+
+void BenchmarkRectArray::BenchmarkUnionAll() {
+  sink_ += array_.UnionAll().width();
+}
+
+void BenchmarkRectArray::BenchmarkIntersectLoop() {
+  for (size_t i = 0; i < rects_.size(); i++)
+    rects_[i] = rects_[i].Intersect(kClip);
+}
+
+void BenchmarkRectArray::BenchmarkIntersectAll() {
+  array_.IntersectAll(kClip);
+}
+
+void BenchmarkRectArray::BenchmarkContainsPointLoop() {
+  for (size_t i = 0; i < rects_.size(); i++) {
+    if (rects_[i].Contains(kMissPoint)) {
+      sink_++;
+      break;
+    }
+  }
+}
+
+void BenchmarkRectArray::BenchmarkContainsPointAny() {
+  if (array_.ContainsAny(kMissPoint))
+    sink_++;
+}
+
+void BenchmarkRectArray::BenchmarkTouchingLoop() {
+  // The test PaintAggregator::InvalidateRect used to make.
+  for (size_t i = 0; i < rects_.size(); i++) {
+    if (rects_[i].Contains(kMissRect) || kMissRect.Intersects(rects_[i]) ||
+        kMissRect.SharesEdgeWith(rects_[i])) {
+      sink_++;
+      break;
+    }
+  }
+}
+
+void BenchmarkRectArray::BenchmarkFindTouching() {
+  sink_ += array_.FindTouching(kMissRect);
+}
+
+void BenchmarkRectArray::BenchmarkAreaLoop() {
+  int64_t area = 0;
+  for (size_t i = 0; i < rects_.size(); i++)
+    area += rects_[i].size().GetArea();
+  sink_ += area;
+}
+
+void BenchmarkRectArray::BenchmarkAreaSum() {
+  sink_ += array_.AreaSum();
+}
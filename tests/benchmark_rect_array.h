@@ -0,0 +1,48 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_BENCHMARK_RECT_ARRAY_H_
+#define PPAPI_TESTS_BENCHMARK_RECT_ARRAY_H_
+
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/rect_array.h"
+#include "ppapi/tests/benchmark_case.h"
+
+// Times the batch operations of pp::RectArray on 10k rects, each next to the
+// same operation done with a loop over a std::vector<pp::Rect>.
+class BenchmarkRectArray : public BenchmarkCase {
+ public:
+  BenchmarkRectArray(TestingInstance* instance)
+      : BenchmarkCase(instance), sink_(0) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+
+ protected:
+  // BenchmarkCase implementation.
+  virtual void RunBenchmarks();
+
+ private:
+  void BenchmarkUnionLoop();
+  void BenchmarkUnionAll();
+  void BenchmarkIntersectLoop();
+  void BenchmarkIntersectAll();
+  void BenchmarkContainsPointLoop();
+  void BenchmarkContainsPointAny();
+  void BenchmarkTouchingLoop();
+  void BenchmarkFindTouching();
+  void BenchmarkAreaLoop();
+  void BenchmarkAreaSum();
+
+  std::vector<pp::Rect> rects_;
+  pp::RectArray array_;
+
+  // Results go here so that the work isn't optimized away.
+  int64_t sink_;
+};
+
+#endif  // PPAPI_TESTS_BENCHMARK_RECT_ARRAY_H_
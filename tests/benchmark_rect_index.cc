@@ -0,0 +1,68 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/benchmark_rect_index.h"
+
+#include "ppapi/cpp/point.h"
+
+REGISTER_BENCHMARK(RectIndex);
+
+namespace {
+
+const size_t kRectCount = 10000;
+const size_t kProbeCount = 1024;
+
+// A long page of controls.
+const int32_t kDocumentWidth = 2000;
+const int32_t kDocumentHeight = 20000;
+
+}  // namespace
+
+bool BenchmarkRectIndex::Init() {
+  uint32_t seed = 1;
+  for (size_t i = 0; i < kRectCount + kProbeCount; i++) {
+    seed = seed * 1103515245 + 12345;
+    int32_t x = static_cast<int32_t>((seed >> 8) % kDocumentWidth);
+    seed = seed * 1103515245 + 12345;
+    int32_t y = static_cast<int32_t>((seed >> 8) % kDocumentHeight);
+    pp::Rect rect(x, y, 10 + i % 90, 10 + i % 40);
+    if (i < kRectCount)
+      ids_.push_back(index_.Insert(rect));
+    else
+      probes_.push_back(rect);
+  }
+  return true;
+}
+
+void BenchmarkRectIndex::RunBenchmarks() {
+  RUN_BENCHMARK(BenchmarkRectIndex, HitTest);
+  RUN_BENCHMARK(BenchmarkRectIndex, QueryRect);
+  RUN_BENCHMARK(BenchmarkRectIndex, Move);
+  RUN_BENCHMARK(BenchmarkRectIndex, InsertAndRemove);
+}
+
+void BenchmarkRectIndex::BenchmarkHitTest() {
+  pp::RectIndex::Id id;
+  if (index_.HitTest(probes_[probe_++ % kProbeCount].point(), &id))
+    sink_ += id;
+}
+
+void BenchmarkRectIndex::BenchmarkQueryRect() {
+  found_.clear();
+  index_.QueryRect(probes_[probe_++ % kProbeCount], &found_);
+  sink_ += found_.size();
+}
+
+void BenchmarkRectIndex::BenchmarkMove() {
+  // Moves a rect back and forth, as when dragging.
+  size_t i = probe_++ % kRectCount;
+  pp::Rect rect = index_.GetRect(ids_[i]);
+  rect.Offset((probe_ / kRectCount) % 2 ? -3 : 3, 0);
+  index_.Move(ids_[i], rect);
+}
+
+void BenchmarkRectIndex::BenchmarkInsertAndRemove() {
+  pp::RectIndex::Id id = index_.Insert(probes_[probe_++ % kProbeCount]);
+  index_.Remove(id);
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_BENCHMARK_RECT_INDEX_H_
+#define PPAPI_TESTS_BENCHMARK_RECT_INDEX_H_
+
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/rect_index.h"
+#include "ppapi/tests/benchmark_case.h"
+
+// Times pp::RectIndex with 10k UI element sized rects.
+class BenchmarkRectIndex : public BenchmarkCase {
+ public:
+  BenchmarkRectIndex(TestingInstance* instance)
+      : BenchmarkCase(instance), probe_(0), sink_(0) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+
+ protected:
+  // BenchmarkCase implementation.
+  virtual void RunBenchmarks();
+
+ private:
+  void BenchmarkHitTest();
+  void BenchmarkQueryRect();
+  void BenchmarkMove();
+  void BenchmarkInsertAndRemove();
+
+  pp::RectIndex index_;
+  std::vector<pp::RectIndex::Id> ids_;
+  std::vector<pp::Rect> probes_;
+  std::vector<pp::RectIndex::Id> found_;
+
+  // Each iteration uses the next probe.
+  size_t probe_;
+
+  // Results go here so that the work isn't optimized away.
+  int64_t sink_;
+};
+
+#endif  // PPAPI_TESTS_BENCHMARK_RECT_INDEX_H_
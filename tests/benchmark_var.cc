@@ -0,0 +1,136 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/benchmark_var.h"
+
+#include <stdio.h>
+
+#include "ppapi/cpp/dev/scriptable_object_deprecated.h"
+#include "ppapi/cpp/var.h"
+
+REGISTER_BENCHMARK(Var);
+
+namespace {
+
+// A frame's worth of samples, say.
+const uint32_t kBinaryArrayCount = 4096;
+
+// A modest options object.
+const uint32_t kPropertyCount = 16;
+
+// Every property is its own name's length.
+class Lengths : public pp::deprecated::ScriptableObject {
+ public:
+  virtual bool HasProperty(const pp::Var& name, pp::Var* exception) {
+    return name.is_string();
+  }
+  virtual pp::Var GetProperty(const pp::Var& name, pp::Var* exception) {
+    uint32_t len = 0;
+    name.AsUtf8(&len);
+    return pp::Var(static_cast<int32_t>(len));
+  }
+};
+
+}  // namespace
+
+bool BenchmarkVar::Init() {
+  long_string_.assign(4096, 'x');
+  floats_.assign(kBinaryArrayCount, 0.5f);
+  string_var_ = pp::Var("A string of a typical property name length");
+  name_ = pp::Var("getElementsByTagName");
+  equal_name_ = pp::Var("getElementsByTagName");
+  other_name_ = pp::Var("getElementsByTagNamE");
+  object_ = pp::Var(new Lengths);
+  for (uint32_t i = 0; i < kPropertyCount; ++i) {
+    char name[16];
+    snprintf(name, sizeof(name), "option%u", static_cast<unsigned>(i));
+    property_names_.push_back(pp::Var(name));
+  }
+  return true;
+}
+
+void BenchmarkVar::RunBenchmarks() {
+  RUN_BENCHMARK(BenchmarkVar, CreateReleaseInt32);
+  RUN_BENCHMARK(BenchmarkVar, CreateReleaseShortString);
+  RUN_BENCHMARK(BenchmarkVar, CreateReleaseLongString);
+  RUN_BENCHMARK(BenchmarkVar, CopyString);
+  RUN_BENCHMARK(BenchmarkVar, AsString);
+  RUN_BENCHMARK(BenchmarkVar, AsUtf8);
+  RUN_BENCHMARK(BenchmarkVar, CompareSameName);
+  RUN_BENCHMARK(BenchmarkVar, CompareEqualNames);
+  RUN_BENCHMARK(BenchmarkVar, CompareDifferentNames);
+  RUN_BENCHMARK(BenchmarkVar, HashName);
+  RUN_BENCHMARK(BenchmarkVar, CreateReleaseBinaryArray);
+  RUN_BENCHMARK(BenchmarkVar, GetPropertyEach);
+  RUN_BENCHMARK(BenchmarkVar, GetProperties);
+}
+
+void BenchmarkVar::BenchmarkCreateReleaseInt32() {
+  // The baseline: no browser calls at all.
+  pp::Var var(42);
+}
+
+void BenchmarkVar::BenchmarkCreateReleaseShortString() {
+  pp::Var var("innerHTML");
+}
+
+void BenchmarkVar::BenchmarkCreateReleaseLongString() {
+  pp::Var var(long_string_);
+}
+
+void BenchmarkVar::BenchmarkCopyString() {
+  // AddRef and Release of an existing string.
+  pp::Var copy(string_var_);
+}
+
+void BenchmarkVar::BenchmarkAsString() {
+  std::string str = string_var_.AsString();
+}
+
+void BenchmarkVar::BenchmarkAsUtf8() {
+  uint32_t len;
+  string_var_.AsUtf8(&len);
+  sink_ += len;
+}
+
+void BenchmarkVar::BenchmarkCompareSameName() {
+  // Two references to one string.
+  if (name_ == name_)
+    sink_++;
+}
+
+void BenchmarkVar::BenchmarkCompareEqualNames() {
+  if (name_ == equal_name_)
+    sink_++;
+}
+
+void BenchmarkVar::BenchmarkCompareDifferentNames() {
+  if (name_ == other_name_)
+    sink_++;
+}
+
+void BenchmarkVar::BenchmarkHashName() {
+  // A fresh reference each time, as a name from script would be, so the
+  // hash cached by |name_| itself isn't what's measured.
+  pp::Var name(pp::Var::DontManage(), name_.pp_var());
+  sink_ += name.Hash();
+}
+
+void BenchmarkVar::BenchmarkCreateReleaseBinaryArray() {
+  // Compare with CreateReleaseLongString: the same number of elements.
+  pp::Var var(PP_BINARYARRAYTYPE_FLOAT32, kBinaryArrayCount, &floats_[0]);
+}
+
+void BenchmarkVar::BenchmarkGetPropertyEach() {
+  for (uint32_t i = 0; i < kPropertyCount; ++i)
+    sink_ += object_.GetProperty(property_names_[i]).AsInt();
+}
+
+void BenchmarkVar::BenchmarkGetProperties() {
+  // The same reads as GetPropertyEach in one call.  Through the NaCl proxy
+  // this is one round trip instead of kPropertyCount.
+  object_.GetProperties(property_names_, &property_values_);
+  for (uint32_t i = 0; i < kPropertyCount; ++i)
+    sink_ += property_values_[i].AsInt();
+}
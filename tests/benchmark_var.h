@@ -0,0 +1,61 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_BENCHMARK_VAR_H_
+#define PPAPI_TESTS_BENCHMARK_VAR_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/cpp/var.h"
+#include "ppapi/tests/benchmark_case.h"
+
+class BenchmarkVar : public BenchmarkCase {
+ public:
+  BenchmarkVar(TestingInstance* instance)
+      : BenchmarkCase(instance), sink_(0) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+
+ protected:
+  // BenchmarkCase implementation.
+  virtual void RunBenchmarks();
+
+ private:
+  void BenchmarkCreateReleaseInt32();
+  void BenchmarkCreateReleaseShortString();
+  void BenchmarkCreateReleaseLongString();
+  void BenchmarkCopyString();
+  void BenchmarkAsString();
+  void BenchmarkAsUtf8();
+  void BenchmarkCompareSameName();
+  void BenchmarkCompareEqualNames();
+  void BenchmarkCompareDifferentNames();
+  void BenchmarkHashName();
+  void BenchmarkCreateReleaseBinaryArray();
+  void BenchmarkGetPropertyEach();
+  void BenchmarkGetProperties();
+
+  std::string long_string_;
+  std::vector<float> floats_;
+  pp::Var string_var_;
+
+  // Property names as they come from script: |name_| and |equal_name_| are
+  // separate strings with the same contents, and |other_name_| differs from
+  // them in the last character.
+  pp::Var name_;
+  pp::Var equal_name_;
+  pp::Var other_name_;
+
+  // An object and the names of the properties read from it.
+  pp::Var object_;
+  std::vector<pp::Var> property_names_;
+  std::vector<pp::Var> property_values_;
+
+  // Results go here so that the work isn't optimized away.
+  uint32_t sink_;
+};
+
+#endif  // PPAPI_TESTS_BENCHMARK_VAR_H_
@@ -0,0 +1,125 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/benchmark_var_json.h"
+
+#include <stdio.h>
+
+#include "ppapi/cpp/var_json.h"
+
+REGISTER_BENCHMARK(VarJSON);
+
+namespace {
+
+const uint32_t kRecordCount = 100;
+
+// Counts the values without making any vars.
+class CountingHandler : public pp::VarJSON::Handler {
+ public:
+  CountingHandler() : count_(0) {}
+
+  uint32_t count() const { return count_; }
+
+  virtual bool OnInt(int32_t /*value*/) {
+    count_++;
+    return true;
+  }
+  virtual bool OnDouble(double /*value*/) {
+    count_++;
+    return true;
+  }
+  virtual bool OnString(const char* /*data*/, uint32_t /*len*/) {
+    count_++;
+    return true;
+  }
+
+ private:
+  uint32_t count_;
+};
+
+}  // namespace
+
+bool BenchmarkVarJSON::Init() {
+  for (uint32_t i = 0; i < kRecordCount; i++) {
+    Record record;
+    record.id = static_cast<int32_t>(i);
+    record.x = i * 1.25;
+    record.y = i * -0.5 + 0.1;
+    char label[32];
+    snprintf(label, sizeof(label), "record number %u",
+             static_cast<unsigned>(i));
+    record.label = label;
+    records_.push_back(record);
+  }
+  names_.push_back(pp::Var("id"));
+  names_.push_back(pp::Var("x"));
+  names_.push_back(pp::Var("y"));
+  names_.push_back(pp::Var("label"));
+  BenchmarkWriteRecords();
+  json_ = out_;
+  return pp::VarJSON::Parse(json_.data(), static_cast<uint32_t>(json_.size()),
+                            &tree_);
+}
+
+void BenchmarkVarJSON::RunBenchmarks() {
+  RUN_BENCHMARK(BenchmarkVarJSON, Parse);
+  RUN_BENCHMARK(BenchmarkVarJSON, ParseToRecords);
+  RUN_BENCHMARK(BenchmarkVarJSON, GetEachProperty);
+  RUN_BENCHMARK(BenchmarkVarJSON, Stringify);
+  RUN_BENCHMARK(BenchmarkVarJSON, WriteRecords);
+}
+
+void BenchmarkVarJSON::BenchmarkParse() {
+  pp::Var tree;
+  pp::VarJSON::Parse(json_.data(), static_cast<uint32_t>(json_.size()),
+                     &tree);
+}
+
+void BenchmarkVarJSON::BenchmarkParseToRecords() {
+  CountingHandler handler;
+  pp::VarJSON::Parse(json_.data(), static_cast<uint32_t>(json_.size()),
+                     &handler);
+  sink_ += handler.count();
+}
+
+void BenchmarkVarJSON::BenchmarkGetEachProperty() {
+  // What a plugin does without JSON: a call for every value it reads.
+  pp::Var records = tree_.GetProperty("records");
+  int32_t count = records.GetProperty("length").AsInt();
+  for (int32_t i = 0; i < count; i++) {
+    pp::Var record = records.GetProperty(pp::Var(i));
+    for (size_t j = 0; j < names_.size(); j++)
+      sink_ += record.GetProperty(names_[j]).is_undefined() ? 0 : 1;
+  }
+}
+
+void BenchmarkVarJSON::BenchmarkStringify() {
+  pp::VarJSON::Stringify(tree_, &out_);
+  sink_ += static_cast<uint32_t>(out_.size());
+}
+
+void BenchmarkVarJSON::BenchmarkWriteRecords() {
+  // |out_| keeps its capacity from one run to the next.
+  out_.clear();
+  pp::VarJSON::Writer writer(&out_);
+  writer.BeginObject();
+  writer.Key("records");
+  writer.BeginArray();
+  for (size_t i = 0; i < records_.size(); i++) {
+    const Record& record = records_[i];
+    writer.BeginObject();
+    writer.Key("id");
+    writer.Int(record.id);
+    writer.Key("x");
+    writer.Double(record.x);
+    writer.Key("y");
+    writer.Double(record.y);
+    writer.Key("label");
+    writer.String(record.label.data(),
+                  static_cast<uint32_t>(record.label.size()));
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+}
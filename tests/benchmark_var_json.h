@@ -0,0 +1,54 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_BENCHMARK_VAR_JSON_H_
+#define PPAPI_TESTS_BENCHMARK_VAR_JSON_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/cpp/var.h"
+#include "ppapi/tests/benchmark_case.h"
+
+// Reads and writes a message of a hundred small records, as JSON with
+// pp::VarJSON and property by property.
+class BenchmarkVarJSON : public BenchmarkCase {
+ public:
+  BenchmarkVarJSON(TestingInstance* instance)
+      : BenchmarkCase(instance), sink_(0) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+
+ protected:
+  // BenchmarkCase implementation.
+  virtual void RunBenchmarks();
+
+ private:
+  struct Record {
+    int32_t id;
+    double x;
+    double y;
+    std::string label;
+  };
+
+  void BenchmarkParse();
+  void BenchmarkParseToRecords();
+  void BenchmarkGetEachProperty();
+  void BenchmarkStringify();
+  void BenchmarkWriteRecords();
+
+  std::vector<Record> records_;
+  // |records_| as JSON, and parsed.
+  std::string json_;
+  pp::Var tree_;
+  // Names of the properties of a record.
+  std::vector<pp::Var> names_;
+
+  std::string out_;
+  // Results go here so that the work isn't optimized away.
+  uint32_t sink_;
+};
+
+#endif  // PPAPI_TESTS_BENCHMARK_VAR_JSON_H_
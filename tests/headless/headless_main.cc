@@ -0,0 +1,355 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Command line driver for the headless host. Loads a test module such as
+// ppapi_tests and runs the requested test cases without a browser:
+//
+//   ppapi_headless_runner --module=libppapi_tests.so --testcase=ImageData
+//
+// Without --testcase the module's list of test cases is printed. The exit
+// code is 0 only if every test case passed.
+//
+// --all runs every test case the module has. Test cases run in a worker
+// process, so one that crashes fails alone instead of ending the run. With
+// --jobs they are spread over several workers to use several cores, and
+// --results-json collects the results for CI:
+//
+//   ppapi_headless_runner --module=libppapi_tests.so --all --jobs=0
+//       --results-json=results.json
+//
+// Benchmark modules such as ppapi_benchmarks run the same way; their results
+// can be collected as a JSON array with --benchmark-results.
+//
+// With --golden-dir the frames each test case paints are compared with
+// golden PNGs; see host_golden_images.h. The goldens of ppapi_tests are in
+// ppapi/tests/goldens. After an intended change in the rendering, regenerate
+// them with --update-goldens.
+//
+// With --replay the runner instead replays a session recorded with
+// pp::InstanceRecorder_Dev (in a module built with ppapi_instance_recording=1
+// and run with PPAPI_INSTANCE_RECORDING=<file>) into the module and reports
+// how long it took:
+//
+//   ppapi_headless_runner --module=libfoo.so --replay=session.rec
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "ppapi/tests/headless/host_file_system.h"
+#include "ppapi/tests/headless/host_golden_images.h"
+#include "ppapi/tests/headless/host_message_loop.h"
+#include "ppapi/tests/headless/host_module.h"
+#include "ppapi/tests/headless/host_parallel_runner.h"
+#include "ppapi/tests/headless/host_replay.h"
+#include "ppapi/tests/headless/host_test_runner.h"
+
+namespace {
+
+const char kUsage[] =
+    "Usage: %s --module=<path> [options]\n"
+    "\n"
+    "Options:\n"
+    "  --testcase=<name>[,<name>...]  Test cases to run. Lists the available\n"
+    "                                 test cases when omitted.\n"
+    "  --all                          Run all the test cases of the module.\n"
+    "  --jobs=<count>                 Run test cases in <count> worker\n"
+    "                                 processes (default 1, 0 for one per\n"
+    "                                 core).\n"
+    "  --results-json=<file>          Write the results of all test cases\n"
+    "                                 to <file> as a JSON array.\n"
+    "  --timeout=<seconds>            Per test case timeout (default 60).\n"
+    "  --size=<width>x<height>        Size of the plugin (default 300x150).\n"
+    "  --arg=<name>=<value>           Extra attribute for the plugin element.\n"
+    "  --file-system-root=<dir>       Where local file systems are stored.\n"
+    "                                 Defaults to a temporary directory that\n"
+    "                                 is removed on exit.\n"
+    "  --benchmark-results=<file>     Write the results of benchmark cases\n"
+    "                                 to <file> as a JSON array.\n"
+    "  --golden-dir=<dir>             Compare the frames painted by each\n"
+    "                                 test case with <dir>/<testcase>/\n"
+    "                                 frame_NNN.png, where that exists.\n"
+    "  --update-goldens               Write the painted frames to\n"
+    "                                 --golden-dir instead of comparing.\n"
+    "  --golden-tolerance=<channel>[,<pixels>]\n"
+    "                                 Per channel difference to ignore, and\n"
+    "                                 how many pixels may still differ\n"
+    "                                 (default 0,0).\n"
+    "  --golden-output-dir=<dir>      Where the actual and diff images of\n"
+    "                                 failing frames go (default .).\n"
+    "  --replay=<file>                Replay a recorded session instead of\n"
+    "                                 running test cases.\n"
+    "  --replay-speed=original|max    Keep the recorded timing (default) or\n"
+    "                                 replay as fast as possible.\n";
+
+// Returns true and sets |value| if |arg| is "--<name>=<value>".
+bool GetSwitchValue(const char* arg, const char* name, std::string* value) {
+  size_t name_len = strlen(name);
+  if (strncmp(arg, "--", 2) != 0 || strncmp(arg + 2, name, name_len) != 0 ||
+      arg[2 + name_len] != '=')
+    return false;
+  *value = arg + 2 + name_len + 1;
+  return true;
+}
+
+void SplitString(const std::string& str, char separator,
+                 std::vector<std::string>* parts) {
+  size_t start = 0;
+  for (;;) {
+    size_t end = str.find(separator, start);
+    std::string part = str.substr(start, end - start);
+    if (!part.empty())
+      parts->push_back(part);
+    if (end == std::string::npos)
+      break;
+    start = end + 1;
+  }
+}
+
+bool WriteBenchmarkResults(const std::string& path,
+                           const std::vector<std::string>& results) {
+  FILE* file = fopen(path.c_str(), "w");
+  if (!file)
+    return false;
+  fprintf(file, "[");
+  for (size_t i = 0; i < results.size(); i++)
+    fprintf(file, "%s\n%s", i ? "," : "", results[i].c_str());
+  fprintf(file, "\n]\n");
+  return fclose(file) == 0;
+}
+
+bool WriteFile(const std::string& path, const std::string& contents) {
+  FILE* file = fopen(path.c_str(), "w");
+  if (!file)
+    return false;
+  bool ok = fwrite(contents.data(), 1, contents.size(), file) ==
+      contents.size();
+  return fclose(file) == 0 && ok;
+}
+
+void PrintResult(const headless::TestCaseResult& result,
+                 double timeout_seconds) {
+  printf("%s", result.console_text.c_str());
+  if (result.timed_out)
+    printf("Timed out after %g seconds\n", timeout_seconds);
+  printf("[ %s ] %s (%d ms)\n", result.passed ? "      OK" : "  FAILED",
+         result.test_case.c_str(),
+         static_cast<int>(result.elapsed_seconds * 1000));
+  fflush(stdout);
+}
+
+// Prints the results of the parallel runner as they come in.
+class ResultPrinter : public headless::ParallelTestRunner::Delegate {
+ public:
+  explicit ResultPrinter(double timeout_seconds)
+      : timeout_seconds_(timeout_seconds) {}
+
+  virtual void DidFinishTestCase(const headless::TestCaseResult& result) {
+    printf("[ RUN      ] %s\n", result.test_case.c_str());
+    PrintResult(result, timeout_seconds_);
+  }
+
+ private:
+  double timeout_seconds_;
+};
+
+int RemoveEntry(const char* path, const struct stat* sb, int type,
+                struct FTW* ftw) {
+  return remove(path);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string module_path;
+  std::string file_system_root;
+  std::string benchmark_results_path;
+  std::string replay_path;
+  std::string results_json_path;
+  bool all_test_cases = false;
+  int jobs = 1;
+  std::string golden_dir;
+  std::string golden_output_dir;
+  bool update_goldens = false;
+  int golden_channel_tolerance = 0, golden_max_differing_pixels = 0;
+  headless::Replayer::Speed replay_speed = headless::Replayer::SPEED_ORIGINAL;
+  std::vector<std::string> test_cases;
+  double timeout_seconds = 60;
+  int width = 300, height = 150;
+  std::vector<std::pair<std::string, std::string> > extra_args;
+
+  for (int i = 1; i < argc; i++) {
+    std::string value;
+    if (GetSwitchValue(argv[i], "module", &value)) {
+      module_path = value;
+    } else if (GetSwitchValue(argv[i], "testcase", &value)) {
+      SplitString(value, ',', &test_cases);
+    } else if (strcmp(argv[i], "--all") == 0) {
+      all_test_cases = true;
+    } else if (GetSwitchValue(argv[i], "jobs", &value)) {
+      jobs = atoi(value.c_str());
+      if (jobs <= 0)
+        jobs = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+      if (jobs <= 0)
+        jobs = 1;
+    } else if (GetSwitchValue(argv[i], "results-json", &value)) {
+      results_json_path = value;
+    } else if (GetSwitchValue(argv[i], "timeout", &value)) {
+      timeout_seconds = atof(value.c_str());
+    } else if (GetSwitchValue(argv[i], "size", &value)) {
+      if (sscanf(value.c_str(), "%dx%d", &width, &height) != 2) {
+        fprintf(stderr, "Bad --size: %s\n", value.c_str());
+        return EXIT_FAILURE;
+      }
+    } else if (GetSwitchValue(argv[i], "arg", &value)) {
+      size_t equals = value.find('=');
+      extra_args.push_back(std::make_pair(
+          value.substr(0, equals),
+          equals == std::string::npos ? std::string()
+                                      : value.substr(equals + 1)));
+    } else if (GetSwitchValue(argv[i], "file-system-root", &value)) {
+      file_system_root = value;
+    } else if (GetSwitchValue(argv[i], "benchmark-results", &value)) {
+      benchmark_results_path = value;
+    } else if (GetSwitchValue(argv[i], "golden-dir", &value)) {
+      golden_dir = value;
+    } else if (strcmp(argv[i], "--update-goldens") == 0) {
+      update_goldens = true;
+    } else if (GetSwitchValue(argv[i], "golden-tolerance", &value)) {
+      int fields = sscanf(value.c_str(), "%d,%d", &golden_channel_tolerance,
+                          &golden_max_differing_pixels);
+      if (fields < 1 || golden_channel_tolerance < 0 ||
+          golden_max_differing_pixels < 0) {
+        fprintf(stderr, "Bad --golden-tolerance: %s\n", value.c_str());
+        return EXIT_FAILURE;
+      }
+    } else if (GetSwitchValue(argv[i], "golden-output-dir", &value)) {
+      golden_output_dir = value;
+    } else if (GetSwitchValue(argv[i], "replay", &value)) {
+      replay_path = value;
+    } else if (GetSwitchValue(argv[i], "replay-speed", &value)) {
+      if (value == "original") {
+        replay_speed = headless::Replayer::SPEED_ORIGINAL;
+      } else if (value == "max") {
+        replay_speed = headless::Replayer::SPEED_MAXIMUM;
+      } else {
+        fprintf(stderr, "Bad --replay-speed: %s\n", value.c_str());
+        return EXIT_FAILURE;
+      }
+    } else {
+      fprintf(stderr, kUsage, argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (module_path.empty() || (update_goldens && golden_dir.empty())) {
+    fprintf(stderr, kUsage, argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  bool remove_file_system_root = false;
+  if (file_system_root.empty()) {
+    const char* tmpdir = getenv("TMPDIR");
+    std::string templ = std::string(tmpdir ? tmpdir : "/tmp") +
+        "/ppapi_headless_XXXXXX";
+    std::vector<char> buffer(templ.begin(), templ.end());
+    buffer.push_back('\0');
+    if (!mkdtemp(&buffer[0])) {
+      perror("mkdtemp");
+      return EXIT_FAILURE;
+    }
+    file_system_root = &buffer[0];
+    remove_file_system_root = true;
+  }
+  headless::FileSystem::SetRootPath(file_system_root);
+
+  // The loop must exist before the module is initialized since the module
+  // may already post tasks.
+  headless::MessageLoop loop;
+  headless::PluginModule module;
+  std::string error;
+  if (!module.Load(module_path, &error)) {
+    fprintf(stderr, "%s\n", error.c_str());
+    return EXIT_FAILURE;
+  }
+
+  headless::TestRunner runner(&module);
+  runner.set_timeout_seconds(timeout_seconds);
+  runner.set_view_size(width, height);
+  for (size_t i = 0; i < extra_args.size(); i++)
+    runner.AddArgument(extra_args[i].first, extra_args[i].second);
+  headless::GoldenImageChecker golden_image_checker(golden_dir,
+                                                    golden_output_dir);
+  golden_image_checker.set_update(update_goldens);
+  golden_image_checker.set_tolerance(golden_channel_tolerance,
+                                     golden_max_differing_pixels);
+  if (!golden_dir.empty())
+    runner.set_golden_image_checker(&golden_image_checker);
+
+  int exit_code = EXIT_SUCCESS;
+  std::vector<std::string> benchmark_results;
+  if (!replay_path.empty()) {
+    headless::Replayer replayer(&module);
+    replayer.set_speed(replay_speed);
+    headless::ReplayResult result;
+    if (!replayer.Replay(replay_path, &result, &error)) {
+      fprintf(stderr, "%s\n", error.c_str());
+      exit_code = EXIT_FAILURE;
+    }
+    printf("Replayed %d calls (%d input events, %d handled, %d skipped) "
+           "in %d ms\n",
+           result.records, result.input_events, result.input_events_handled,
+           result.skipped, static_cast<int>(result.elapsed_seconds * 1000));
+  } else if (test_cases.empty() && !all_test_cases) {
+    headless::TestCaseResult result;
+    runner.RunTestCase(std::string(), &result);
+    printf("%s", result.console_text.c_str());
+  } else {
+    if (all_test_cases && !runner.ListTestCases(&test_cases)) {
+      fprintf(stderr, "The module didn't list any test cases.\n");
+      exit_code = EXIT_FAILURE;
+    }
+    // Even one job gets a worker, so that a test case that crashes or
+    // leaves the module in a bad state doesn't take the others with it.
+    std::vector<headless::TestCaseResult> results;
+    headless::ParallelTestRunner parallel_runner(
+        &runner, jobs, timeout_seconds, file_system_root);
+    ResultPrinter printer(timeout_seconds);
+    parallel_runner.Run(test_cases, &printer, &results);
+
+    int failed = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+      if (!results[i].benchmark_results.empty())
+        benchmark_results.push_back(results[i].benchmark_results);
+      if (!results[i].passed) {
+        failed++;
+        exit_code = EXIT_FAILURE;
+      }
+    }
+    printf("%d of %d test cases passed.\n",
+           static_cast<int>(results.size()) - failed,
+           static_cast<int>(results.size()));
+    if (!results_json_path.empty() &&
+        !WriteFile(results_json_path,
+                   headless::TestCaseResultsToJSON(results))) {
+      perror(results_json_path.c_str());
+      exit_code = EXIT_FAILURE;
+    }
+  }
+
+  if (!benchmark_results_path.empty() &&
+      !WriteBenchmarkResults(benchmark_results_path, benchmark_results)) {
+    perror(benchmark_results_path.c_str());
+    exit_code = EXIT_FAILURE;
+  }
+
+  module.Shutdown();
+  if (remove_file_system_root)
+    nftw(file_system_root.c_str(), &RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+  return exit_code;
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_core.h"
+
+#include <sys/time.h>
+
+#include "ppapi/c/pp_completion_callback.h"
+#include "ppapi/c/ppb_core.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/tests/headless/host_memory_stats.h"
+#include "ppapi/tests/headless/host_message_loop.h"
+#include "ppapi/tests/headless/host_resource_tracker.h"
+
+namespace headless {
+
+namespace {
+
+void AddRefResource(PP_Resource resource) {
+  ResourceTracker::Get()->AddRefResource(resource);
+}
+
+void ReleaseResource(PP_Resource resource) {
+  ResourceTracker::Get()->UnrefResource(resource);
+}
+
+void* MemAlloc(size_t num_bytes) {
+  return MemoryStats::MemAlloc(num_bytes);
+}
+
+void MemFree(void* ptr) {
+  MemoryStats::MemFree(ptr);
+}
+
+PP_Time GetTime() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+PP_TimeTicks GetTimeTicks() {
+  return MessageLoop::Now();
+}
+
+void CallOnMainThread(int32_t delay_in_milliseconds,
+                      PP_CompletionCallback callback,
+                      int32_t result) {
+  MessageLoop* loop = MessageLoop::current();
+  PP_DCHECK(loop);
+  if (loop)
+    loop->PostDelayedTask(callback, result, delay_in_milliseconds);
+}
+
+bool IsMainThread() {
+  MessageLoop* loop = MessageLoop::current();
+  return loop && loop->IsMainThread();
+}
+
+const PPB_Core core_interface = {
+  &AddRefResource,
+  &ReleaseResource,
+  &MemAlloc,
+  &MemFree,
+  &GetTime,
+  &GetTimeTicks,
+  &CallOnMainThread,
+  &IsMainThread
+};
+
+}  // namespace
+
+// static
+const PPB_Core* Core::GetInterface() {
+  return &core_interface;
+}
+
+}  // namespace headless
@@ -0,0 +1,21 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_CORE_H_
+#define PPAPI_TESTS_HEADLESS_HOST_CORE_H_
+
+struct PPB_Core;
+
+namespace headless {
+
+// Implements PPB_Core on top of the ResourceTracker and the main thread
+// MessageLoop.
+class Core {
+ public:
+  static const PPB_Core* GetInterface();
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_CORE_H_
@@ -0,0 +1,223 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_file_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ppapi/c/dev/ppb_file_io_dev.h"
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/tests/headless/host_file_ref.h"
+#include "ppapi/tests/headless/host_file_system.h"
+#include "ppapi/tests/headless/host_message_loop.h"
+#include "ppapi/tests/headless/host_resource_tracker.h"
+
+namespace headless {
+
+namespace {
+
+// Returns the file if it has been opened, or NULL and sets |*error|.
+FileIO* GetOpenedFileIO(PP_Resource file_io, int32_t* error) {
+  FileIO* object = GetResourceAs<FileIO>(file_io);
+  if (!object) {
+    *error = PP_ERROR_BADRESOURCE;
+    return NULL;
+  }
+  if (!object->is_open()) {
+    *error = PP_ERROR_FAILED;
+    return NULL;
+  }
+  return object;
+}
+
+PP_Resource Create(PP_Module module) {
+  return (new FileIO(module))->GetReference();
+}
+
+bool IsFileIO(PP_Resource resource) {
+  return !!GetResourceAs<FileIO>(resource);
+}
+
+int32_t Open(PP_Resource file_io,
+             PP_Resource file_ref,
+             int32_t open_flags,
+             PP_CompletionCallback callback) {
+  FileIO* object = GetResourceAs<FileIO>(file_io);
+  if (!object)
+    return PP_ERROR_BADRESOURCE;
+  FileRef* file_ref_object = GetResourceAs<FileRef>(file_ref);
+  if (!file_ref_object)
+    return PP_ERROR_BADRESOURCE;
+  return CompleteAsync(callback, object->Open(file_ref_object, open_flags));
+}
+
+int32_t Query(PP_Resource file_io,
+              PP_FileInfo_Dev* info,
+              PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileIO* object = GetOpenedFileIO(file_io, &result);
+  if (!object)
+    return result;
+
+  struct stat st;
+  if (fstat(object->fd(), &st) != 0)
+    result = ErrnoToPPError(errno);
+  else
+    StatToFileInfo(st, object->system_type(), info);
+  return CompleteAsync(callback, result);
+}
+
+int32_t Touch(PP_Resource file_io,
+              PP_Time last_access_time,
+              PP_Time last_modified_time,
+              PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileIO* object = GetOpenedFileIO(file_io, &result);
+  if (!object)
+    return result;
+
+  struct timespec times[2];
+  TimeToTimespec(last_access_time, &times[0]);
+  TimeToTimespec(last_modified_time, &times[1]);
+  if (futimens(object->fd(), times) != 0)
+    result = ErrnoToPPError(errno);
+  return CompleteAsync(callback, result);
+}
+
+int32_t Read(PP_Resource file_io,
+             int64_t offset,
+             char* buffer,
+             int32_t bytes_to_read,
+             PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileIO* object = GetOpenedFileIO(file_io, &result);
+  if (!object)
+    return result;
+  if (offset < 0 || bytes_to_read < 0)
+    return PP_ERROR_BADARGUMENT;
+
+  ssize_t rv = pread(object->fd(), buffer, bytes_to_read, offset);
+  result = rv < 0 ? ErrnoToPPError(errno) : static_cast<int32_t>(rv);
+  return CompleteAsync(callback, result);
+}
+
+int32_t Write(PP_Resource file_io,
+              int64_t offset,
+              const char* buffer,
+              int32_t bytes_to_write,
+              PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileIO* object = GetOpenedFileIO(file_io, &result);
+  if (!object)
+    return result;
+  if (offset < 0 || bytes_to_write < 0)
+    return PP_ERROR_BADARGUMENT;
+
+  ssize_t rv = pwrite(object->fd(), buffer, bytes_to_write, offset);
+  result = rv < 0 ? ErrnoToPPError(errno) : static_cast<int32_t>(rv);
+  return CompleteAsync(callback, result);
+}
+
+int32_t SetLength(PP_Resource file_io,
+                  int64_t length,
+                  PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileIO* object = GetOpenedFileIO(file_io, &result);
+  if (!object)
+    return result;
+  if (length < 0)
+    return PP_ERROR_BADARGUMENT;
+
+  if (ftruncate(object->fd(), length) != 0)
+    result = ErrnoToPPError(errno);
+  return CompleteAsync(callback, result);
+}
+
+int32_t Flush(PP_Resource file_io, PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileIO* object = GetOpenedFileIO(file_io, &result);
+  if (!object)
+    return result;
+
+  if (fsync(object->fd()) != 0)
+    result = ErrnoToPPError(errno);
+  return CompleteAsync(callback, result);
+}
+
+void Close(PP_Resource file_io) {
+  FileIO* object = GetResourceAs<FileIO>(file_io);
+  if (object)
+    object->Close();
+}
+
+const PPB_FileIO_Dev file_io_interface = {
+  &Create,
+  &IsFileIO,
+  &Open,
+  &Query,
+  &Touch,
+  &Read,
+  &Write,
+  &SetLength,
+  &Flush,
+  &Close
+};
+
+}  // namespace
+
+FileIO::FileIO(PP_Module module)
+    : Resource(module),
+      fd_(-1),
+      system_type_(PP_FILESYSTEMTYPE_EXTERNAL) {
+  memory_stats_entry_.Record(module, PP_MEMORYSTATSCATEGORY_FILEIO, 0);
+}
+
+FileIO::~FileIO() {
+  Close();
+}
+
+// static
+const PPB_FileIO_Dev* FileIO::GetInterface() {
+  return &file_io_interface;
+}
+
+int32_t FileIO::Open(FileRef* file_ref, int32_t open_flags) {
+  if (is_open() || !file_ref->file_system()->opened())
+    return PP_ERROR_FAILED;
+
+  bool read = !!(open_flags & PP_FILEOPENFLAG_READ);
+  bool write = !!(open_flags & PP_FILEOPENFLAG_WRITE);
+  int flags = read && write ? O_RDWR : (write ? O_WRONLY : O_RDONLY);
+  if (open_flags & PP_FILEOPENFLAG_CREATE)
+    flags |= O_CREAT;
+  if (open_flags & PP_FILEOPENFLAG_TRUNCATE) {
+    if (!write)
+      return PP_ERROR_BADARGUMENT;
+    flags |= O_TRUNC;
+  }
+  if (open_flags & PP_FILEOPENFLAG_EXCLUSIVE) {
+    if (!(open_flags & PP_FILEOPENFLAG_CREATE))
+      return PP_ERROR_BADARGUMENT;
+    flags |= O_EXCL;
+  }
+
+  int fd = open(file_ref->GetHostPath().c_str(), flags | O_CLOEXEC, 0600);
+  if (fd < 0)
+    return ErrnoToPPError(errno);
+  fd_ = fd;
+  system_type_ = file_ref->file_system()->type();
+  return PP_OK;
+}
+
+void FileIO::Close() {
+  if (fd_ >= 0)
+    close(fd_);
+  fd_ = -1;
+}
+
+}  // namespace headless
@@ -0,0 +1,46 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_FILE_IO_H_
+#define PPAPI_TESTS_HEADLESS_HOST_FILE_IO_H_
+
+#include "ppapi/c/dev/pp_file_info_dev.h"
+#include "ppapi/tests/headless/host_memory_stats.h"
+#include "ppapi/tests/headless/host_resource.h"
+
+struct PPB_FileIO_Dev;
+
+namespace headless {
+
+// A PPB_FileIO_Dev wrapping a POSIX file descriptor. The system calls are
+// made synchronously and their results delivered through the message loop.
+class FileIO : public Resource {
+ public:
+  explicit FileIO(PP_Module module);
+  virtual ~FileIO();
+
+  static const PPB_FileIO_Dev* GetInterface();
+
+  // Resource override.
+  virtual FileIO* AsFileIO() { return this; }
+
+  bool is_open() const { return fd_ >= 0; }
+  int fd() const { return fd_; }
+  PP_FileSystemType_Dev system_type() const { return system_type_; }
+
+  // Opens the file named by |file_ref| with the given PP_FileOpenFlags_Dev.
+  // Returns a PP_Error code.
+  int32_t Open(FileRef* file_ref, int32_t open_flags);
+  void Close();
+
+ private:
+  int fd_;
+  PP_FileSystemType_Dev system_type_;
+
+  MemoryStats::Entry memory_stats_entry_;
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_FILE_IO_H_
@@ -0,0 +1,242 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_file_ref.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ppapi/c/dev/ppb_file_ref_dev.h"
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/tests/headless/host_file_system.h"
+#include "ppapi/tests/headless/host_message_loop.h"
+#include "ppapi/tests/headless/host_resource_tracker.h"
+#include "ppapi/tests/headless/host_var.h"
+
+namespace headless {
+
+namespace {
+
+// Returns the file ref if its file system is open, or NULL and sets
+// |*error| otherwise.
+FileRef* GetOpenedFileRef(PP_Resource file_ref, int32_t* error) {
+  FileRef* object = GetResourceAs<FileRef>(file_ref);
+  if (!object) {
+    *error = PP_ERROR_BADRESOURCE;
+    return NULL;
+  }
+  if (!object->file_system()->opened()) {
+    *error = PP_ERROR_FAILED;
+    return NULL;
+  }
+  return object;
+}
+
+PP_Resource Create(PP_Resource file_system, const char* path) {
+  FileSystem* object = GetResourceAs<FileSystem>(file_system);
+  if (!object || object->type() == PP_FILESYSTEMTYPE_EXTERNAL || !path)
+    return 0;
+  if (!FileRef::IsValidPath(path))
+    return 0;
+  return (new FileRef(object, path))->GetReference();
+}
+
+bool IsFileRef(PP_Resource resource) {
+  return !!GetResourceAs<FileRef>(resource);
+}
+
+PP_FileSystemType_Dev GetFileSystemType(PP_Resource file_ref) {
+  FileRef* object = GetResourceAs<FileRef>(file_ref);
+  if (!object)
+    return PP_FILESYSTEMTYPE_EXTERNAL;
+  return object->file_system()->type();
+}
+
+PP_Var GetName(PP_Resource file_ref) {
+  FileRef* object = GetResourceAs<FileRef>(file_ref);
+  if (!object)
+    return PP_MakeUndefined();
+  return Var::StringToPPVar(object->module(), object->GetName());
+}
+
+PP_Var GetPath(PP_Resource file_ref) {
+  FileRef* object = GetResourceAs<FileRef>(file_ref);
+  if (!object)
+    return PP_MakeUndefined();
+  return Var::StringToPPVar(object->module(), object->path());
+}
+
+PP_Resource GetParent(PP_Resource file_ref) {
+  FileRef* object = GetResourceAs<FileRef>(file_ref);
+  if (!object)
+    return 0;
+  const std::string& path = object->path();
+  size_t slash = path.rfind('/');
+  std::string parent = slash == 0 ? "/" : path.substr(0, slash);
+  return (new FileRef(object->file_system(), parent))->GetReference();
+}
+
+int32_t MakeDirectory(PP_Resource directory_ref,
+                      bool make_ancestors,
+                      PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileRef* object = GetOpenedFileRef(directory_ref, &result);
+  if (!object)
+    return result;
+
+  std::string path = object->GetHostPath();
+  if (make_ancestors) {
+    // Create each missing directory below the file system root.
+    std::string root = object->file_system()->GetHostPath("/");
+    for (size_t slash = path.find('/', root.size()); ;
+         slash = path.find('/', slash + 1)) {
+      std::string prefix = path.substr(0, slash);
+      if (mkdir(prefix.c_str(), 0700) != 0 && errno != EEXIST) {
+        result = ErrnoToPPError(errno);
+        break;
+      }
+      if (slash == std::string::npos)
+        break;
+    }
+  } else if (mkdir(path.c_str(), 0700) != 0) {
+    result = ErrnoToPPError(errno);
+  }
+  return CompleteAsync(callback, result);
+}
+
+int32_t Query(PP_Resource file_ref,
+              PP_FileInfo_Dev* info,
+              PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileRef* object = GetOpenedFileRef(file_ref, &result);
+  if (!object)
+    return result;
+
+  struct stat st;
+  if (stat(object->GetHostPath().c_str(), &st) != 0)
+    result = ErrnoToPPError(errno);
+  else
+    StatToFileInfo(st, object->file_system()->type(), info);
+  return CompleteAsync(callback, result);
+}
+
+int32_t Touch(PP_Resource file_ref,
+              PP_Time last_access_time,
+              PP_Time last_modified_time,
+              PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileRef* object = GetOpenedFileRef(file_ref, &result);
+  if (!object)
+    return result;
+
+  struct timespec times[2];
+  TimeToTimespec(last_access_time, &times[0]);
+  TimeToTimespec(last_modified_time, &times[1]);
+  if (utimensat(AT_FDCWD, object->GetHostPath().c_str(), times, 0) != 0)
+    result = ErrnoToPPError(errno);
+  return CompleteAsync(callback, result);
+}
+
+int32_t Delete(PP_Resource file_ref, PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileRef* object = GetOpenedFileRef(file_ref, &result);
+  if (!object)
+    return result;
+
+  std::string path = object->GetHostPath();
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0)
+    result = ErrnoToPPError(errno);
+  else if (S_ISDIR(st.st_mode) ? rmdir(path.c_str()) : unlink(path.c_str()))
+    result = ErrnoToPPError(errno);
+  return CompleteAsync(callback, result);
+}
+
+int32_t Rename(PP_Resource file_ref,
+               PP_Resource new_file_ref,
+               PP_CompletionCallback callback) {
+  int32_t result = PP_OK;
+  FileRef* object = GetOpenedFileRef(file_ref, &result);
+  if (!object)
+    return result;
+  FileRef* new_object = GetOpenedFileRef(new_file_ref, &result);
+  if (!new_object)
+    return result;
+  if (new_object->file_system() != object->file_system())
+    return PP_ERROR_BADARGUMENT;
+
+  if (rename(object->GetHostPath().c_str(),
+             new_object->GetHostPath().c_str()) != 0)
+    result = ErrnoToPPError(errno);
+  return CompleteAsync(callback, result);
+}
+
+const PPB_FileRef_Dev file_ref_interface = {
+  &Create,
+  &IsFileRef,
+  &GetFileSystemType,
+  &GetName,
+  &GetPath,
+  &GetParent,
+  &MakeDirectory,
+  &Query,
+  &Touch,
+  &Delete,
+  &Rename
+};
+
+}  // namespace
+
+FileRef::FileRef(FileSystem* file_system, const std::string& path)
+    : Resource(file_system->module()),
+      file_system_(file_system),
+      path_(path) {
+  file_system_->AddRef();
+}
+
+FileRef::~FileRef() {
+  file_system_->Release();
+}
+
+// static
+const PPB_FileRef_Dev* FileRef::GetInterface() {
+  return &file_ref_interface;
+}
+
+// static
+bool FileRef::IsValidPath(const std::string& path) {
+  if (path.empty() || path[0] != '/')
+    return false;
+  if (path == "/")
+    return true;
+  if (path[path.size() - 1] == '/')
+    return false;
+  // Check every component.
+  size_t start = 1;
+  for (;;) {
+    size_t end = path.find('/', start);
+    std::string component = path.substr(start, end - start);
+    if (component.empty() || component == "." || component == "..")
+      return false;
+    if (end == std::string::npos)
+      return true;
+    start = end + 1;
+  }
+}
+
+std::string FileRef::GetName() const {
+  if (path_ == "/")
+    return path_;
+  return path_.substr(path_.rfind('/') + 1);
+}
+
+std::string FileRef::GetHostPath() const {
+  return file_system_->GetHostPath(path_);
+}
+
+}  // namespace headless
@@ -0,0 +1,50 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_FILE_REF_H_
+#define PPAPI_TESTS_HEADLESS_HOST_FILE_REF_H_
+
+#include <string>
+
+#include "ppapi/tests/headless/host_resource.h"
+
+struct PPB_FileRef_Dev;
+
+namespace headless {
+
+// A PPB_FileRef_Dev naming a path inside a FileSystem.
+class FileRef : public Resource {
+ public:
+  // Takes a reference to |file_system|. |path| must be absolute and
+  // normalized (see IsValidPath()).
+  FileRef(FileSystem* file_system, const std::string& path);
+  virtual ~FileRef();
+
+  static const PPB_FileRef_Dev* GetInterface();
+
+  // Returns true if |path| is absolute, has no "." or ".." components and
+  // no trailing slash (other than the root itself).
+  static bool IsValidPath(const std::string& path);
+
+  // Resource override.
+  virtual FileRef* AsFileRef() { return this; }
+
+  FileSystem* file_system() const { return file_system_; }
+  const std::string& path() const { return path_; }
+
+  // The last component of the path, or "/" for the root.
+  std::string GetName() const;
+
+  // Returns the path in the real file system. The file system must have
+  // been opened.
+  std::string GetHostPath() const;
+
+ private:
+  FileSystem* file_system_;
+  std::string path_;
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_FILE_REF_H_
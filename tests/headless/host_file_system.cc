@@ -0,0 +1,149 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_file_system.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "ppapi/c/dev/ppb_file_system_dev.h"
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/tests/headless/host_instance.h"
+#include "ppapi/tests/headless/host_message_loop.h"
+#include "ppapi/tests/headless/host_module.h"
+#include "ppapi/tests/headless/host_resource_tracker.h"
+
+namespace headless {
+
+namespace {
+
+std::string g_root_path;
+
+PP_Resource Create(PP_Instance pp_instance, PP_FileSystemType_Dev type) {
+  Instance* instance = Instance::FromPPInstance(pp_instance);
+  if (!instance)
+    return 0;
+  if (type != PP_FILESYSTEMTYPE_EXTERNAL &&
+      type != PP_FILESYSTEMTYPE_LOCALPERSISTENT &&
+      type != PP_FILESYSTEMTYPE_LOCALTEMPORARY)
+    return 0;
+  FileSystem* file_system =
+      new FileSystem(instance->module()->pp_module(), type);
+  return file_system->GetReference();
+}
+
+int32_t Open(PP_Resource file_system,
+             int64_t expected_size,
+             PP_CompletionCallback callback) {
+  FileSystem* object = GetResourceAs<FileSystem>(file_system);
+  if (!object)
+    return PP_ERROR_BADRESOURCE;
+  // Quota isn't enforced, so |expected_size| is ignored.
+  return CompleteAsync(callback, object->Open());
+}
+
+const PPB_FileSystem_Dev file_system_interface = {
+  &Create,
+  &Open
+};
+
+// Creates |path| and any missing parent directories.
+bool MakeDirectories(const std::string& path) {
+  for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+    std::string prefix = path.substr(0, slash);
+    if (mkdir(prefix.c_str(), 0700) != 0 && errno != EEXIST)
+      return false;
+    if (slash == std::string::npos)
+      return true;
+  }
+}
+
+}  // namespace
+
+FileSystem::FileSystem(PP_Module module, PP_FileSystemType_Dev type)
+    : Resource(module),
+      type_(type),
+      opened_(false) {
+}
+
+FileSystem::~FileSystem() {
+}
+
+// static
+const PPB_FileSystem_Dev* FileSystem::GetInterface() {
+  return &file_system_interface;
+}
+
+// static
+void FileSystem::SetRootPath(const std::string& path) {
+  g_root_path = path;
+}
+
+int32_t FileSystem::Open() {
+  if (opened_ || type_ == PP_FILESYSTEMTYPE_EXTERNAL || g_root_path.empty())
+    return PP_ERROR_FAILED;
+
+  host_root_ = g_root_path +
+      (type_ == PP_FILESYSTEMTYPE_LOCALPERSISTENT ? "/persistent"
+                                                  : "/temporary");
+  if (!MakeDirectories(host_root_))
+    return ErrnoToPPError(errno);
+  opened_ = true;
+  return PP_OK;
+}
+
+std::string FileSystem::GetHostPath(const std::string& virtual_path) const {
+  PP_DCHECK(opened_);
+  PP_DCHECK(!virtual_path.empty() && virtual_path[0] == '/');
+  return host_root_ + virtual_path;
+}
+
+void StatToFileInfo(const struct stat& st,
+                    PP_FileSystemType_Dev system_type,
+                    PP_FileInfo_Dev* info) {
+  info->size = st.st_size;
+  if (S_ISREG(st.st_mode))
+    info->type = PP_FILETYPE_REGULAR;
+  else if (S_ISDIR(st.st_mode))
+    info->type = PP_FILETYPE_DIRECTORY;
+  else
+    info->type = PP_FILETYPE_OTHER;
+  info->system_type = system_type;
+  // POSIX has no creation time; the status change time is the closest.
+  info->creation_time = st.st_ctim.tv_sec + st.st_ctim.tv_nsec / 1e9;
+  info->last_access_time = st.st_atim.tv_sec + st.st_atim.tv_nsec / 1e9;
+  info->last_modified_time = st.st_mtim.tv_sec + st.st_mtim.tv_nsec / 1e9;
+}
+
+void TimeToTimespec(PP_Time time, struct timespec* ts) {
+  ts->tv_sec = static_cast<time_t>(time);
+  ts->tv_nsec = static_cast<long>((time - ts->tv_sec) * 1e9);
+}
+
+int32_t ErrnoToPPError(int error) {
+  switch (error) {
+    case ENOENT:
+    case ENOTDIR:
+      return PP_ERROR_FILENOTFOUND;
+    case EEXIST:
+      return PP_ERROR_FILEEXISTS;
+    case EACCES:
+    case EPERM:
+    case EISDIR:
+      return PP_ERROR_NOACCESS;
+    case ENOSPC:
+      return PP_ERROR_NOSPACE;
+    case EFBIG:
+      return PP_ERROR_FILETOOBIG;
+    case ENOMEM:
+      return PP_ERROR_NOMEMORY;
+    default:
+      return PP_ERROR_FAILED;
+  }
+}
+
+}  // namespace headless
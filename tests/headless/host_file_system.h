@@ -0,0 +1,64 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_FILE_SYSTEM_H_
+#define PPAPI_TESTS_HEADLESS_HOST_FILE_SYSTEM_H_
+
+#include <string>
+
+#include "ppapi/c/dev/pp_file_info_dev.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/tests/headless/host_resource.h"
+
+struct PPB_FileSystem_Dev;
+struct stat;
+struct timespec;
+
+namespace headless {
+
+// A PPB_FileSystem_Dev backed by a directory of the real file system. Local
+// file systems of every type live in their own subdirectory of the root set
+// with SetRootPath(); external file systems can't be opened.
+class FileSystem : public Resource {
+ public:
+  FileSystem(PP_Module module, PP_FileSystemType_Dev type);
+  virtual ~FileSystem();
+
+  static const PPB_FileSystem_Dev* GetInterface();
+
+  // Sets the directory holding the local file systems. Must be called
+  // before any file system is opened.
+  static void SetRootPath(const std::string& path);
+
+  // Resource override.
+  virtual FileSystem* AsFileSystem() { return this; }
+
+  PP_FileSystemType_Dev type() const { return type_; }
+  bool opened() const { return opened_; }
+
+  // Creates the backing directory. Returns a PP_Error code.
+  int32_t Open();
+
+  // Returns the host path for |virtual_path|, which must start with '/'.
+  std::string GetHostPath(const std::string& virtual_path) const;
+
+ private:
+  PP_FileSystemType_Dev type_;
+  bool opened_;
+  std::string host_root_;
+};
+
+// Maps the errno of a failed system call to a PP_Error code.
+int32_t ErrnoToPPError(int error);
+
+// Helpers shared by FileRef and FileIO to convert between stat() results
+// and PP_FileInfo_Dev.
+void StatToFileInfo(const struct stat& st,
+                    PP_FileSystemType_Dev system_type,
+                    PP_FileInfo_Dev* info);
+void TimeToTimespec(PP_Time time, struct timespec* ts);
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_FILE_SYSTEM_H_
@@ -0,0 +1,267 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_golden_images.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "ppapi/tests/headless/host_image_data.h"
+#include "ppapi/tests/headless/host_instance.h"
+#include "ppapi/tests/headless/host_png.h"
+
+namespace headless {
+
+namespace {
+
+bool ReadFile(const std::string& path, std::vector<unsigned char>* contents) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  unsigned char buffer[16384];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    contents->insert(contents->end(), buffer, buffer + read);
+  bool ok = !ferror(file);
+  fclose(file);
+  return ok;
+}
+
+bool WriteFile(const std::string& path,
+               const std::vector<unsigned char>& contents) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file)
+    return false;
+  bool ok = fwrite(&contents[0], 1, contents.size(), file) == contents.size();
+  return fclose(file) == 0 && ok;
+}
+
+bool WritePNG(const std::string& path,
+              const uint32_t* pixels,
+              int32_t width,
+              int32_t height) {
+  std::vector<unsigned char> png;
+  EncodePNG(pixels, width, height, width * 4, &png);
+  return WriteFile(path, png);
+}
+
+bool IsDirectory(const std::string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool FileExists(const std::string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0;
+}
+
+inline bool PixelDiffers(uint32_t a, uint32_t b, int channel_tolerance) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    int diff = static_cast<int>((a >> shift) & 0xff) -
+               static_cast<int>((b >> shift) & 0xff);
+    if (diff > channel_tolerance || -diff > channel_tolerance)
+      return true;
+  }
+  return false;
+}
+
+// Returns how many of the |count| pixels of |a| and |b| have a channel that
+// differs by more than |channel_tolerance|. This runs on every frame of
+// every checked test, so SSE2 is used to compare four pixels at a time.
+size_t CountDifferingPixels(const uint32_t* a,
+                            const uint32_t* b,
+                            size_t count,
+                            int channel_tolerance) {
+  size_t differing = 0;
+  size_t i = 0;
+#if defined(__SSE2__)
+  // Number of zero bits in a 4-bit mask: the pixels that are out of
+  // tolerance.
+  static const unsigned char kZeroBits[16] = {
+    4, 3, 3, 2, 3, 2, 2, 1, 3, 2, 2, 1, 2, 1, 1, 0
+  };
+  const __m128i tolerance = _mm_set1_epi8(static_cast<char>(
+      channel_tolerance > 255 ? 255 : channel_tolerance));
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 4 <= count; i += 4) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    // |a - b| per channel, then what's left above the tolerance.
+    __m128i diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+    __m128i excess = _mm_subs_epu8(diff, tolerance);
+    // All ones for the pixels that are within tolerance.
+    __m128i within = _mm_cmpeq_epi32(excess, zero);
+    differing += kZeroBits[_mm_movemask_ps(_mm_castsi128_ps(within))];
+  }
+#endif
+  for (; i < count; i++) {
+    if (PixelDiffers(a[i], b[i], channel_tolerance))
+      differing++;
+  }
+  return differing;
+}
+
+// Marks the pixels of |actual| that differ from |expected| in red over a
+// faded copy of |expected|.
+void MakeDiffImage(const uint32_t* actual,
+                   const uint32_t* expected,
+                   size_t count,
+                   int channel_tolerance,
+                   std::vector<uint32_t>* diff) {
+  diff->resize(count);
+  for (size_t i = 0; i < count; i++) {
+    if (PixelDiffers(actual[i], expected[i], channel_tolerance)) {
+      (*diff)[i] = 0xffff0000;
+    } else {
+      uint32_t p = expected[i];
+      uint32_t gray =
+          (((p >> 16) & 0xff) + ((p >> 8) & 0xff) + (p & 0xff)) / 3;
+      gray = 0xc0 + gray / 4;
+      (*diff)[i] = 0xff000000 | (gray << 16) | (gray << 8) | gray;
+    }
+  }
+}
+
+}  // namespace
+
+GoldenImageChecker::GoldenImageChecker(const std::string& golden_dir,
+                                       const std::string& output_dir)
+    : golden_dir_(golden_dir),
+      output_dir_(output_dir.empty() ? std::string(".") : output_dir),
+      update_(false),
+      channel_tolerance_(0),
+      max_differing_pixels_(0),
+      instance_(NULL),
+      frame_count_(0) {
+  Graphics2D::SetFlushObserver(this);
+}
+
+GoldenImageChecker::~GoldenImageChecker() {
+  Graphics2D::SetFlushObserver(NULL);
+}
+
+void GoldenImageChecker::StartTestCase(const std::string& test_case,
+                                       Instance* instance) {
+  test_case_ = test_case;
+  instance_ = NULL;
+  frame_count_ = 0;
+  failures_.clear();
+
+  if (update_ || IsDirectory(golden_dir_ + "/" + test_case))
+    instance_ = instance;
+}
+
+void GoldenImageChecker::FinishTestCase(std::vector<std::string>* failures) {
+  if (instance_) {
+    if (update_) {
+      // Drop the goldens of frames that are no longer painted.
+      for (int frame = frame_count_ + 1; FileExists(GoldenPath(frame));
+           frame++)
+        unlink(GoldenPath(frame).c_str());
+    } else if (FileExists(GoldenPath(frame_count_ + 1))) {
+      char message[128];
+      sprintf(message, "Only %d frames were painted; there are more goldens",
+              frame_count_);
+      failures_.push_back(message);
+    }
+  }
+  failures->insert(failures->end(), failures_.begin(), failures_.end());
+  failures_.clear();
+  instance_ = NULL;
+}
+
+void GoldenImageChecker::DidFlush(Graphics2D* context) {
+  if (!instance_ || instance_->bound_graphics() != context)
+    return;
+  frame_count_++;
+  CheckFrame(*context->backing_store());
+}
+
+std::string GoldenImageChecker::GoldenPath(int frame) const {
+  char name[32];
+  sprintf(name, "/frame_%03d.png", frame);
+  return golden_dir_ + "/" + test_case_ + name;
+}
+
+std::string GoldenImageChecker::OutputPath(int frame,
+                                           const char* suffix) const {
+  char name[48];
+  sprintf(name, "_frame_%03d_%s.png", frame, suffix);
+  return output_dir_ + "/" + test_case_ + name;
+}
+
+void GoldenImageChecker::CheckFrame(const ImageData& frame) {
+  const uint32_t* pixels = frame.data();
+  int32_t width = frame.width();
+  int32_t height = frame.height();
+  std::string golden_path = GoldenPath(frame_count_);
+
+  if (update_) {
+    // Only test cases that paint get a directory.
+    std::string dir = golden_dir_ + "/" + test_case_;
+    if (frame_count_ == 1 && mkdir(dir.c_str(), 0755) != 0 &&
+        errno != EEXIST) {
+      failures_.push_back("Can't create " + dir);
+      return;
+    }
+    if (!WritePNG(golden_path, pixels, width, height))
+      failures_.push_back("Can't write " + golden_path);
+    return;
+  }
+
+  std::vector<unsigned char> png;
+  if (!ReadFile(golden_path, &png)) {
+    failures_.push_back("Frame painted without a golden: " + golden_path);
+    return;
+  }
+  std::vector<uint32_t> golden;
+  int32_t golden_width, golden_height;
+  std::string error;
+  if (!DecodePNG(png.empty() ? NULL : &png[0], png.size(), &golden,
+                 &golden_width, &golden_height, &error)) {
+    failures_.push_back(golden_path + ": " + error);
+    return;
+  }
+
+  char message[256];
+  std::string actual_path = OutputPath(frame_count_, "actual");
+  if (golden_width != width || golden_height != height) {
+    sprintf(message, "Frame %d is %dx%d, the golden is %dx%d",
+            frame_count_, width, height, golden_width, golden_height);
+    WritePNG(actual_path, pixels, width, height);
+    failures_.push_back(std::string(message) + "; wrote " + actual_path);
+    return;
+  }
+
+  size_t count = static_cast<size_t>(width) * height;
+  // A 0x0 frame matches a 0x0 golden; there are no pixels to compare.
+  if (count == 0)
+    return;
+  size_t differing = CountDifferingPixels(pixels, &golden[0], count,
+                                          channel_tolerance_);
+  if (differing <= static_cast<size_t>(max_differing_pixels_))
+    return;
+
+  std::vector<uint32_t> diff;
+  MakeDiffImage(pixels, &golden[0], count, channel_tolerance_, &diff);
+  std::string diff_path = OutputPath(frame_count_, "diff");
+  WritePNG(actual_path, pixels, width, height);
+  WritePNG(diff_path, &diff[0], width, height);
+  // The paths come from --golden-dir and can be any length, so only the
+  // numbers are formatted into |message|.
+  char pixel_count[32];
+  sprintf(message, "Frame %d differs from ", frame_count_);
+  sprintf(pixel_count, " in %d pixels", static_cast<int>(differing));
+  failures_.push_back(std::string(message) + golden_path + pixel_count +
+                      "; wrote " + actual_path + " and " + diff_path);
+}
+
+}  // namespace headless
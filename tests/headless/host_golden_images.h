@@ -0,0 +1,82 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_GOLDEN_IMAGES_H_
+#define PPAPI_TESTS_HEADLESS_HOST_GOLDEN_IMAGES_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/tests/headless/host_graphics_2d.h"
+
+namespace headless {
+
+class ImageData;
+class Instance;
+
+// Compares every frame a test case paints against golden PNGs, so that
+// painting code can be changed with confidence that the output stays the
+// same pixel for pixel.
+//
+// A frame is the backing store of the device bound to the test's instance
+// right after a flush completes. The goldens of a test case live in
+// <golden dir>/<test case>/frame_NNN.png, numbered from 1; test cases
+// without such a directory aren't checked. When a frame doesn't match, the
+// actual frame and a diff image (differing pixels in red over a faded copy
+// of the golden) are written to the output directory as
+// <test case>_frame_NNN_actual.png and <test case>_frame_NNN_diff.png.
+class GoldenImageChecker : public Graphics2D::FlushObserver {
+ public:
+  // Becomes the flush observer of Graphics2D until destroyed.
+  GoldenImageChecker(const std::string& golden_dir,
+                     const std::string& output_dir);
+  virtual ~GoldenImageChecker();
+
+  // Writes the frames as the new goldens instead of comparing them.
+  void set_update(bool update) { update_ = update; }
+
+  // A pixel differs when one of its channels differs by more than
+  // |channel_tolerance|; a frame matches if at most |max_differing_pixels|
+  // pixels differ. Both default to 0.
+  void set_tolerance(int channel_tolerance, int max_differing_pixels) {
+    channel_tolerance_ = channel_tolerance;
+    max_differing_pixels_ = max_differing_pixels;
+  }
+
+  // Starts checking the frames |instance| paints for |test_case|.
+  void StartTestCase(const std::string& test_case, Instance* instance);
+
+  // Stops checking and appends one message per failure to |failures|,
+  // including a frame count that doesn't match the goldens.
+  void FinishTestCase(std::vector<std::string>* failures);
+
+  // Graphics2D::FlushObserver implementation.
+  virtual void DidFlush(Graphics2D* context);
+
+ private:
+  std::string GoldenPath(int frame) const;
+  std::string OutputPath(int frame, const char* suffix) const;
+
+  void CheckFrame(const ImageData& frame);
+
+  std::string golden_dir_;
+  std::string output_dir_;
+  bool update_;
+  int channel_tolerance_;
+  int max_differing_pixels_;
+
+  // The test case being checked; NULL |instance_| if none.
+  std::string test_case_;
+  Instance* instance_;
+  int frame_count_;
+  std::vector<std::string> failures_;
+
+  // Disallow copy and assign (these are unimplemented).
+  GoldenImageChecker(const GoldenImageChecker&);
+  GoldenImageChecker& operator=(const GoldenImageChecker&);
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_GOLDEN_IMAGES_H_
@@ -0,0 +1,321 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_graphics_2d.h"
+
+#include <algorithm>
+
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/c/pp_size.h"
+#include "ppapi/c/ppb_graphics_2d.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/tests/headless/host_image_data.h"
+#include "ppapi/tests/headless/host_message_loop.h"
+#include "ppapi/tests/headless/host_resource_tracker.h"
+
+namespace headless {
+
+namespace {
+
+PP_Rect MakeRect(int32_t x, int32_t y, int32_t w, int32_t h) {
+  PP_Rect rect;
+  rect.point.x = x;
+  rect.point.y = y;
+  rect.size.width = w;
+  rect.size.height = h;
+  return rect;
+}
+
+bool IsRectEmpty(const PP_Rect& rect) {
+  return rect.size.width <= 0 || rect.size.height <= 0;
+}
+
+PP_Rect IntersectRects(const PP_Rect& a, const PP_Rect& b) {
+  int32_t x = std::max(a.point.x, b.point.x);
+  int32_t y = std::max(a.point.y, b.point.y);
+  int32_t right = std::min(a.point.x + a.size.width,
+                           b.point.x + b.size.width);
+  int32_t bottom = std::min(a.point.y + a.size.height,
+                            b.point.y + b.size.height);
+  if (x >= right || y >= bottom)
+    return MakeRect(0, 0, 0, 0);
+  return MakeRect(x, y, right - x, bottom - y);
+}
+
+PP_Resource Create(PP_Module module,
+                   const PP_Size* size,
+                   bool is_always_opaque) {
+  if (!size)
+    return 0;
+  Graphics2D* graphics_2d = new Graphics2D(module);
+  if (!graphics_2d->Init(size->width, size->height, is_always_opaque)) {
+    delete graphics_2d;
+    return 0;
+  }
+  return graphics_2d->GetReference();
+}
+
+bool IsGraphics2D(PP_Resource resource) {
+  return !!GetResourceAs<Graphics2D>(resource);
+}
+
+bool Describe(PP_Resource graphics_2d,
+              PP_Size* size,
+              bool* is_always_opaque) {
+  Graphics2D* context = GetResourceAs<Graphics2D>(graphics_2d);
+  if (!context) {
+    size->width = 0;
+    size->height = 0;
+    *is_always_opaque = false;
+    return false;
+  }
+  size->width = context->backing_store()->width();
+  size->height = context->backing_store()->height();
+  *is_always_opaque = context->is_always_opaque();
+  return true;
+}
+
+void PaintImageData(PP_Resource graphics_2d,
+                    PP_Resource image_data,
+                    const PP_Point* top_left,
+                    const PP_Rect* src_rect) {
+  Graphics2D* context = GetResourceAs<Graphics2D>(graphics_2d);
+  if (context)
+    context->PaintImageData(image_data, top_left, src_rect);
+}
+
+void Scroll(PP_Resource graphics_2d,
+            const PP_Rect* clip_rect,
+            const PP_Point* amount) {
+  Graphics2D* context = GetResourceAs<Graphics2D>(graphics_2d);
+  if (context)
+    context->Scroll(clip_rect, amount);
+}
+
+void ReplaceContents(PP_Resource graphics_2d, PP_Resource image_data) {
+  Graphics2D* context = GetResourceAs<Graphics2D>(graphics_2d);
+  if (context)
+    context->ReplaceContents(image_data);
+}
+
+int32_t Flush(PP_Resource graphics_2d, PP_CompletionCallback callback) {
+  Graphics2D* context = GetResourceAs<Graphics2D>(graphics_2d);
+  if (!context)
+    return PP_ERROR_BADRESOURCE;
+  return context->Flush(callback);
+}
+
+const PPB_Graphics2D graphics_2d_interface = {
+  &Create,
+  &IsGraphics2D,
+  &Describe,
+  &PaintImageData,
+  &Scroll,
+  &ReplaceContents,
+  &Flush
+};
+
+Graphics2D::FlushObserver* g_flush_observer = NULL;
+
+}  // namespace
+
+Graphics2D::Graphics2D(PP_Module module)
+    : Resource(module),
+      backing_store_(NULL),
+      is_always_opaque_(false),
+      flush_pending_(false) {
+}
+
+Graphics2D::~Graphics2D() {
+  for (size_t i = 0; i < queued_operations_.size(); i++) {
+    if (queued_operations_[i].image)
+      queued_operations_[i].image->Release();
+  }
+  if (backing_store_)
+    backing_store_->Release();
+}
+
+// static
+const PPB_Graphics2D* Graphics2D::GetInterface() {
+  return &graphics_2d_interface;
+}
+
+// static
+void Graphics2D::SetFlushObserver(FlushObserver* observer) {
+  g_flush_observer = observer;
+}
+
+bool Graphics2D::Init(int32_t width, int32_t height, bool is_always_opaque) {
+  // The backing store is never handed to the plugin, so it's not tracked.
+  ImageData* backing_store = new ImageData(module());
+  if (!backing_store->Init(ImageData::GetNativeImageDataFormat(),
+                           width, height, true)) {
+    delete backing_store;
+    return false;
+  }
+  backing_store->AddRef();
+  backing_store_ = backing_store;
+  is_always_opaque_ = is_always_opaque;
+  return true;
+}
+
+void Graphics2D::PaintImageData(PP_Resource image_data,
+                                const PP_Point* top_left,
+                                const PP_Rect* src_rect) {
+  ImageData* image = GetResourceAs<ImageData>(image_data);
+  if (!image || !top_left)
+    return;
+
+  QueuedOperation op;
+  op.type = QueuedOperation::PAINT;
+  op.image = image;
+  op.point = *top_left;
+
+  PP_Rect image_bounds = MakeRect(0, 0, image->width(), image->height());
+  op.rect = src_rect ? IntersectRects(*src_rect, image_bounds) : image_bounds;
+  if (IsRectEmpty(op.rect))
+    return;
+
+  image->AddRef();
+  queued_operations_.push_back(op);
+}
+
+void Graphics2D::Scroll(const PP_Rect* clip_rect, const PP_Point* amount) {
+  if (!amount)
+    return;
+
+  QueuedOperation op;
+  op.type = QueuedOperation::SCROLL;
+  op.image = NULL;
+  op.point = *amount;
+
+  PP_Rect bounds = MakeRect(0, 0, backing_store_->width(),
+                            backing_store_->height());
+  op.rect = clip_rect ? IntersectRects(*clip_rect, bounds) : bounds;
+  if (IsRectEmpty(op.rect))
+    return;
+
+  queued_operations_.push_back(op);
+}
+
+void Graphics2D::ReplaceContents(PP_Resource image_data) {
+  ImageData* image = GetResourceAs<ImageData>(image_data);
+  if (!image)
+    return;
+  if (image->format() != backing_store_->format() ||
+      image->width() != backing_store_->width() ||
+      image->height() != backing_store_->height())
+    return;
+
+  QueuedOperation op;
+  op.type = QueuedOperation::REPLACE;
+  op.image = image;
+  op.rect = MakeRect(0, 0, image->width(), image->height());
+  op.point.x = 0;
+  op.point.y = 0;
+
+  image->AddRef();
+  queued_operations_.push_back(op);
+}
+
+int32_t Graphics2D::Flush(const PP_CompletionCallback& callback) {
+  // Blocking flushes would deadlock the main thread, which is the only
+  // thread plugins may call us on.
+  if (!callback.func)
+    return PP_ERROR_BADARGUMENT;
+  if (flush_pending_)
+    return PP_ERROR_INPROGRESS;
+
+  for (size_t i = 0; i < queued_operations_.size(); i++) {
+    const QueuedOperation& op = queued_operations_[i];
+    switch (op.type) {
+      case QueuedOperation::PAINT:
+        ExecutePaint(op);
+        break;
+      case QueuedOperation::SCROLL:
+        ExecuteScroll(op);
+        break;
+      case QueuedOperation::REPLACE:
+        ExecuteReplace(op);
+        break;
+    }
+    if (op.image)
+      op.image->Release();
+  }
+  queued_operations_.clear();
+  if (g_flush_observer)
+    g_flush_observer->DidFlush(this);
+
+  // The callback runs asynchronously even though the pixels are already in
+  // place, like in the browser. Keep ourselves alive until it does.
+  flush_pending_ = true;
+  flush_callback_ = callback;
+  AddRef();
+  MessageLoop::current()->PostTask(
+      PP_MakeCompletionCallback(&Graphics2D::OnFlushComplete, this), PP_OK);
+  return PP_ERROR_WOULDBLOCK;
+}
+
+bool Graphics2D::ReadImageData(PP_Resource image, const PP_Point* top_left) {
+  ImageData* dest = GetResourceAs<ImageData>(image);
+  if (!dest || !top_left ||
+      dest->format() != ImageData::GetNativeImageDataFormat())
+    return false;
+
+  // The whole image must fit inside the device.
+  PP_Rect src_rect = MakeRect(top_left->x, top_left->y,
+                              dest->width(), dest->height());
+  if (src_rect.point.x < 0 || src_rect.point.y < 0 ||
+      src_rect.point.x + src_rect.size.width > backing_store_->width() ||
+      src_rect.point.y + src_rect.size.height > backing_store_->height())
+    return false;
+
+  dest->CopyFrom(*backing_store_, src_rect, 0, 0);
+  return true;
+}
+
+void Graphics2D::ExecutePaint(const QueuedOperation& op) {
+  // Clip the destination to the device, then adjust the source to match.
+  PP_Rect dest = MakeRect(op.point.x + op.rect.point.x,
+                          op.point.y + op.rect.point.y,
+                          op.rect.size.width, op.rect.size.height);
+  PP_Rect bounds = MakeRect(0, 0, backing_store_->width(),
+                            backing_store_->height());
+  PP_Rect clipped = IntersectRects(dest, bounds);
+  if (IsRectEmpty(clipped))
+    return;
+
+  PP_Rect src = MakeRect(clipped.point.x - op.point.x,
+                         clipped.point.y - op.point.y,
+                         clipped.size.width, clipped.size.height);
+  backing_store_->CopyFrom(*op.image, src, clipped.point.x, clipped.point.y);
+}
+
+void Graphics2D::ExecuteScroll(const QueuedOperation& op) {
+  // Pixels that would come from outside the clip stay as they were.
+  PP_Rect src = MakeRect(op.rect.point.x - op.point.x,
+                         op.rect.point.y - op.point.y,
+                         op.rect.size.width, op.rect.size.height);
+  src = IntersectRects(src, op.rect);
+  if (IsRectEmpty(src))
+    return;
+  backing_store_->CopyFrom(*backing_store_, src,
+                           src.point.x + op.point.x,
+                           src.point.y + op.point.y);
+}
+
+void Graphics2D::ExecuteReplace(const QueuedOperation& op) {
+  backing_store_->CopyFrom(*op.image, op.rect, 0, 0);
+}
+
+// static
+void Graphics2D::OnFlushComplete(void* user_data, int32_t result) {
+  Graphics2D* context = static_cast<Graphics2D*>(user_data);
+  PP_CompletionCallback callback = context->flush_callback_;
+  context->flush_pending_ = false;
+  context->Release();
+  PP_RunCompletionCallback(&callback, result);
+}
+
+}  // namespace headless
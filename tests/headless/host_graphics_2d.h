@@ -0,0 +1,106 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_GRAPHICS_2D_H_
+#define PPAPI_TESTS_HEADLESS_HOST_GRAPHICS_2D_H_
+
+#include <vector>
+
+#include "ppapi/c/pp_completion_callback.h"
+#include "ppapi/c/pp_point.h"
+#include "ppapi/c/pp_rect.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/tests/headless/host_resource.h"
+
+struct PPB_Graphics2D;
+
+namespace headless {
+
+class ImageData;
+
+// A PPB_Graphics2D that renders into an in-memory backing store. Paint,
+// scroll and replace operations are queued and only applied to the backing
+// store when the plugin flushes, after which the flush callback is posted to
+// the main thread message loop.
+class Graphics2D : public Resource {
+ public:
+  // Told about every flush once its operations are in the backing store.
+  // That happens inside Flush(), before the plugin's callback is posted.
+  class FlushObserver {
+   public:
+    virtual ~FlushObserver() {}
+    virtual void DidFlush(Graphics2D* context) = 0;
+  };
+
+  explicit Graphics2D(PP_Module module);
+  virtual ~Graphics2D();
+
+  static const PPB_Graphics2D* GetInterface();
+
+  // There is at most one observer; NULL removes it.
+  static void SetFlushObserver(FlushObserver* observer);
+
+  // Allocates the backing store. Returns false for sizes an ImageData
+  // couldn't be created with.
+  bool Init(int32_t width, int32_t height, bool is_always_opaque);
+
+  // Resource override.
+  virtual Graphics2D* AsGraphics2D() { return this; }
+
+  bool is_always_opaque() const { return is_always_opaque_; }
+
+  // The flushed contents of the device.
+  ImageData* backing_store() const { return backing_store_; }
+
+  // PPB_Graphics2D functions.
+  void PaintImageData(PP_Resource image_data,
+                      const PP_Point* top_left,
+                      const PP_Rect* src_rect);
+  void Scroll(const PP_Rect* clip_rect, const PP_Point* amount);
+  void ReplaceContents(PP_Resource image_data);
+  int32_t Flush(const PP_CompletionCallback& callback);
+
+  // Copies the backing store into |image| starting at |top_left| in the
+  // device, for PPB_Testing_Dev.ReadImageData.
+  bool ReadImageData(PP_Resource image, const PP_Point* top_left);
+
+ private:
+  struct QueuedOperation {
+    enum Type {
+      PAINT,
+      SCROLL,
+      REPLACE
+    };
+
+    Type type;
+
+    // PAINT and REPLACE; holds a reference.
+    ImageData* image;
+
+    // PAINT: the source rect in |image|. SCROLL: the clip rect.
+    PP_Rect rect;
+
+    // PAINT: the top left of |image| in the device. SCROLL: the amount.
+    PP_Point point;
+  };
+
+  void ExecutePaint(const QueuedOperation& op);
+  void ExecuteScroll(const QueuedOperation& op);
+  void ExecuteReplace(const QueuedOperation& op);
+
+  static void OnFlushComplete(void* user_data, int32_t result);
+
+  ImageData* backing_store_;
+  bool is_always_opaque_;
+
+  std::vector<QueuedOperation> queued_operations_;
+
+  // True between a Flush() and the run of its callback.
+  bool flush_pending_;
+  PP_CompletionCallback flush_callback_;
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_GRAPHICS_2D_H_
@@ -0,0 +1,154 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_image_data.h"
+
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "ppapi/c/pp_rect.h"
+#include "ppapi/c/pp_size.h"
+#include "ppapi/tests/headless/host_resource_tracker.h"
+
+namespace headless {
+
+namespace {
+
+PP_ImageDataFormat GetNativeImageDataFormat() {
+  return ImageData::GetNativeImageDataFormat();
+}
+
+bool IsImageDataFormatSupported(PP_ImageDataFormat format) {
+  return ImageData::IsImageDataFormatSupported(format);
+}
+
+PP_Resource Create(PP_Module module,
+                   PP_ImageDataFormat format,
+                   const PP_Size* size,
+                   bool init_to_zero) {
+  if (!size)
+    return 0;
+  ImageData* image_data = new ImageData(module);
+  if (!image_data->Init(format, size->width, size->height, init_to_zero)) {
+    delete image_data;
+    return 0;
+  }
+  return image_data->GetReference();
+}
+
+bool IsImageData(PP_Resource resource) {
+  return !!GetResourceAs<ImageData>(resource);
+}
+
+bool Describe(PP_Resource resource, PP_ImageDataDesc* desc) {
+  ImageData* image_data = GetResourceAs<ImageData>(resource);
+  if (!image_data) {
+    memset(desc, 0, sizeof(*desc));
+    return false;
+  }
+  desc->format = image_data->format();
+  desc->size.width = image_data->width();
+  desc->size.height = image_data->height();
+  desc->stride = image_data->stride();
+  return true;
+}
+
+void* Map(PP_Resource resource) {
+  ImageData* image_data = GetResourceAs<ImageData>(resource);
+  return image_data ? image_data->data() : NULL;
+}
+
+void Unmap(PP_Resource resource) {
+  // The memory stays mapped for the lifetime of the resource.
+}
+
+const PPB_ImageData image_data_interface = {
+  &GetNativeImageDataFormat,
+  &IsImageDataFormatSupported,
+  &Create,
+  &IsImageData,
+  &Describe,
+  &Map,
+  &Unmap
+};
+
+}  // namespace
+
+ImageData::ImageData(PP_Module module)
+    : Resource(module),
+      format_(PP_IMAGEDATAFORMAT_BGRA_PREMUL),
+      width_(0),
+      height_(0),
+      data_(NULL) {
+}
+
+ImageData::~ImageData() {
+  if (data_)
+    munmap(data_, static_cast<size_t>(stride()) * height_);
+}
+
+// static
+const PPB_ImageData* ImageData::GetInterface() {
+  return &image_data_interface;
+}
+
+// static
+PP_ImageDataFormat ImageData::GetNativeImageDataFormat() {
+  return PP_IMAGEDATAFORMAT_BGRA_PREMUL;
+}
+
+// static
+bool ImageData::IsImageDataFormatSupported(PP_ImageDataFormat format) {
+  return format == GetNativeImageDataFormat();
+}
+
+bool ImageData::Init(PP_ImageDataFormat format,
+                     int32_t width,
+                     int32_t height,
+                     bool init_to_zero) {
+  if (!IsImageDataFormatSupported(format))
+    return false;
+  if (width <= 0 || height <= 0)
+    return false;
+  if (static_cast<int64_t>(width) * height * 4 > INT_MAX)
+    return false;
+
+  // Like the browser's shared memory, the mapping is rounded up to whole
+  // pages and always comes back zeroed, so |init_to_zero| is free.
+  size_t num_bytes = static_cast<size_t>(width) * height * 4;
+  void* data = mmap(NULL, num_bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED)
+    return false;
+
+  format_ = format;
+  width_ = width;
+  height_ = height;
+  data_ = static_cast<uint32_t*>(data);
+  memory_stats_entry_.Record(module(), PP_MEMORYSTATSCATEGORY_IMAGEDATA,
+                             num_bytes);
+  return true;
+}
+
+void ImageData::CopyFrom(const ImageData& src,
+                         const PP_Rect& src_rect,
+                         int32_t dest_x,
+                         int32_t dest_y) {
+  size_t row_bytes = static_cast<size_t>(src_rect.size.width) * 4;
+  int32_t rows = src_rect.size.height;
+
+  // |src| may be this image (scrolling), in which case rows must be copied
+  // away from the direction of movement, and within a row memmove handles
+  // horizontal overlap.
+  bool bottom_up = &src == this && dest_y > src_rect.point.y;
+  for (int32_t i = 0; i < rows; i++) {
+    int32_t y = bottom_up ? rows - 1 - i : i;
+    memmove(GetAddr32(dest_x, dest_y + y),
+            src.GetAddr32(src_rect.point.x, src_rect.point.y + y),
+            row_bytes);
+  }
+}
+
+}  // namespace headless
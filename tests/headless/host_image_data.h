@@ -0,0 +1,68 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_IMAGE_DATA_H_
+#define PPAPI_TESTS_HEADLESS_HOST_IMAGE_DATA_H_
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/ppb_image_data.h"
+#include "ppapi/tests/headless/host_memory_stats.h"
+#include "ppapi/tests/headless/host_resource.h"
+
+struct PP_Rect;
+
+namespace headless {
+
+// A PPB_ImageData backed by an anonymous memory mapping. Only the native
+// format (BGRA premultiplied) is supported, with rows packed with no padding.
+class ImageData : public Resource {
+ public:
+  explicit ImageData(PP_Module module);
+  virtual ~ImageData();
+
+  static const PPB_ImageData* GetInterface();
+
+  static PP_ImageDataFormat GetNativeImageDataFormat();
+  static bool IsImageDataFormatSupported(PP_ImageDataFormat format);
+
+  // Allocates the pixels. Returns false if the format isn't supported or the
+  // size is empty or too big to be addressed with 32-bit signed offsets.
+  bool Init(PP_ImageDataFormat format,
+            int32_t width,
+            int32_t height,
+            bool init_to_zero);
+
+  // Resource override.
+  virtual ImageData* AsImageData() { return this; }
+
+  PP_ImageDataFormat format() const { return format_; }
+  int32_t width() const { return width_; }
+  int32_t height() const { return height_; }
+  int32_t stride() const { return width_ * 4; }
+
+  uint32_t* data() const { return data_; }
+  uint32_t* GetAddr32(int32_t x, int32_t y) const {
+    return data_ + y * width_ + x;
+  }
+
+  // Copies |src_rect| of |src| into this image with its top left corner
+  // ending up at (|dest_x|, |dest_y|). Both rectangles must already be
+  // clipped to their images.
+  void CopyFrom(const ImageData& src,
+                const PP_Rect& src_rect,
+                int32_t dest_x,
+                int32_t dest_y);
+
+ private:
+  PP_ImageDataFormat format_;
+  int32_t width_;
+  int32_t height_;
+  uint32_t* data_;
+
+  MemoryStats::Entry memory_stats_entry_;
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_IMAGE_DATA_H_
@@ -0,0 +1,157 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_instance.h"
+
+#include <map>
+
+#include "ppapi/c/ppb_instance.h"
+#include "ppapi/c/ppp_instance.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/tests/headless/host_graphics_2d.h"
+#include "ppapi/tests/headless/host_module.h"
+#include "ppapi/tests/headless/host_resource_tracker.h"
+#include "ppapi/tests/headless/host_var.h"
+
+namespace headless {
+
+namespace {
+
+typedef std::map<PP_Instance, Instance*> InstanceMap;
+InstanceMap g_live_instances;
+PP_Instance g_last_instance_id = 0;
+
+PP_Var GetWindowObject(PP_Instance pp_instance) {
+  Instance* instance = Instance::FromPPInstance(pp_instance);
+  if (!instance)
+    return PP_MakeUndefined();
+  return instance->GetWindowObject();
+}
+
+PP_Var GetOwnerElementObject(PP_Instance pp_instance) {
+  // The emulated page has no DOM node for the plugin.
+  return PP_MakeUndefined();
+}
+
+bool BindGraphics(PP_Instance pp_instance, PP_Resource device) {
+  Instance* instance = Instance::FromPPInstance(pp_instance);
+  if (!instance)
+    return false;
+  return instance->BindGraphics(device);
+}
+
+bool IsFullFrame(PP_Instance pp_instance) {
+  return false;
+}
+
+PP_Var ExecuteScript(PP_Instance pp_instance,
+                     PP_Var script,
+                     PP_Var* exception) {
+  // There is no script engine. Report it like a script error would be.
+  Instance* instance = Instance::FromPPInstance(pp_instance);
+  if (instance && exception && exception->type == PP_VARTYPE_UNDEFINED) {
+    *exception = Var::StringToPPVar(
+        instance->module()->pp_module(),
+        "Error: ExecuteScript is not supported by the headless host");
+  }
+  return PP_MakeUndefined();
+}
+
+const PPB_Instance instance_interface = {
+  &GetWindowObject,
+  &GetOwnerElementObject,
+  &BindGraphics,
+  &IsFullFrame,
+  &ExecuteScript
+};
+
+}  // namespace
+
+Instance::Instance(PluginModule* module,
+                   const std::string& url,
+                   Page::Delegate* page_delegate)
+    : module_(module),
+      pp_instance_(++g_last_instance_id),
+      created_(false),
+      page_(module->pp_module(), page_delegate, url),
+      bound_graphics_(NULL) {
+  g_live_instances[pp_instance_] = this;
+}
+
+Instance::~Instance() {
+  if (created_)
+    module_->ppp_instance()->DidDestroy(pp_instance_);
+  if (bound_graphics_)
+    bound_graphics_->Release();
+  g_live_instances.erase(pp_instance_);
+}
+
+// static
+const PPB_Instance* Instance::GetInterface() {
+  return &instance_interface;
+}
+
+// static
+Instance* Instance::FromPPInstance(PP_Instance instance) {
+  InstanceMap::iterator found = g_live_instances.find(instance);
+  if (found == g_live_instances.end())
+    return NULL;
+  return found->second;
+}
+
+bool Instance::Initialize(const std::vector<std::string>& arg_names,
+                          const std::vector<std::string>& arg_values) {
+  PP_DCHECK(!created_);
+  PP_DCHECK(arg_names.size() == arg_values.size());
+  std::vector<const char*> argn;
+  std::vector<const char*> argv;
+  for (size_t i = 0; i < arg_names.size(); i++) {
+    argn.push_back(arg_names[i].c_str());
+    argv.push_back(arg_values[i].c_str());
+  }
+  // DidDestroy must be called even if DidCreate fails.
+  created_ = true;
+  return module_->ppp_instance()->DidCreate(
+      pp_instance_,
+      static_cast<uint32_t>(argn.size()),
+      argn.empty() ? NULL : &argn[0],
+      argv.empty() ? NULL : &argv[0]);
+}
+
+void Instance::SetPosition(const PP_Rect& position, const PP_Rect& clip) {
+  module_->ppp_instance()->DidChangeView(pp_instance_, &position, &clip);
+}
+
+void Instance::SetFocus(bool has_focus) {
+  module_->ppp_instance()->DidChangeFocus(pp_instance_, has_focus);
+}
+
+bool Instance::HandleInputEvent(const PP_InputEvent& event) {
+  return module_->ppp_instance()->HandleInputEvent(pp_instance_, &event);
+}
+
+PP_Var Instance::GetWindowObject() {
+  return page_.GetWindowObject();
+}
+
+bool Instance::BindGraphics(PP_Resource device) {
+  if (!device) {
+    // Unbinding.
+    if (bound_graphics_)
+      bound_graphics_->Release();
+    bound_graphics_ = NULL;
+    return true;
+  }
+
+  Graphics2D* graphics = GetResourceAs<Graphics2D>(device);
+  if (!graphics || graphics->module() != module_->pp_module())
+    return false;
+  graphics->AddRef();
+  if (bound_graphics_)
+    bound_graphics_->Release();
+  bound_graphics_ = graphics;
+  return true;
+}
+
+}  // namespace headless
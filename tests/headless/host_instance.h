@@ -0,0 +1,80 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_INSTANCE_H_
+#define PPAPI_TESTS_HEADLESS_HOST_INSTANCE_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_instance.h"
+#include "ppapi/c/pp_rect.h"
+#include "ppapi/c/pp_resource.h"
+#include "ppapi/c/pp_var.h"
+#include "ppapi/tests/headless/host_page.h"
+
+struct PP_InputEvent;
+struct PPB_Instance;
+
+namespace headless {
+
+class Graphics2D;
+class PluginModule;
+
+// One plugin instance embedded in an emulated page. The host drives the
+// plugin through the PPP_Instance functions below; the plugin reaches back
+// through PPB_Instance.
+class Instance {
+ public:
+  // |url| is the address of the emulated page, |page_delegate| (which may
+  // be NULL) is told when the page's script hooks are called.
+  Instance(PluginModule* module,
+           const std::string& url,
+           Page::Delegate* page_delegate);
+
+  // Calls PPP_Instance.DidDestroy if the instance was created.
+  ~Instance();
+
+  static const PPB_Instance* GetInterface();
+
+  // Returns the live instance with the given id, or NULL.
+  static Instance* FromPPInstance(PP_Instance instance);
+
+  PP_Instance pp_instance() const { return pp_instance_; }
+  PluginModule* module() const { return module_; }
+  Page* page() { return &page_; }
+
+  // The device bound with PPB_Instance.BindGraphics, or NULL.
+  Graphics2D* bound_graphics() const { return bound_graphics_; }
+
+  // PPP_Instance wrappers. Initialize() passes the given attributes of the
+  // embed element and must succeed before calling anything else.
+  bool Initialize(const std::vector<std::string>& arg_names,
+                  const std::vector<std::string>& arg_values);
+  void SetPosition(const PP_Rect& position, const PP_Rect& clip);
+  void SetFocus(bool has_focus);
+  bool HandleInputEvent(const PP_InputEvent& event);
+
+  // PPB_Instance implementation.
+  PP_Var GetWindowObject();
+  bool BindGraphics(PP_Resource device);
+
+ private:
+  PluginModule* module_;
+  PP_Instance pp_instance_;
+  bool created_;
+
+  Page page_;
+
+  // Holds a reference.
+  Graphics2D* bound_graphics_;
+
+  // Disallow copy and assign (these are unimplemented).
+  Instance(const Instance&);
+  Instance& operator=(const Instance&);
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_INSTANCE_H_
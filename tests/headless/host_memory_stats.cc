@@ -0,0 +1,211 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_memory_stats.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+
+namespace headless {
+
+namespace {
+
+struct ModuleStats {
+  ModuleStats() {
+    memset(categories, 0, sizeof(categories));
+  }
+  PP_MemoryStats_Dev categories[PP_MEMORYSTATSCATEGORY_COUNT];
+};
+
+typedef std::map<PP_Module, ModuleStats> StatsMap;
+
+// MemAlloc may be called from any thread, so all counts are protected by
+// |g_lock|. It is only taken while accounting is on.
+pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+StatsMap g_stats;
+uint32_t g_generation = 0;
+
+const char* const kCategoryNames[PP_MEMORYSTATSCATEGORY_COUNT] = {
+  "ImageData",
+  "Buffer",
+  "URLLoader",
+  "FileIO",
+  "StringVar",
+  "ObjectVar",
+  "MemAlloc",
+  "BinaryArrayVar",
+};
+
+// MemAlloc isn't per module; its blocks are all counted under this one.
+const PP_Module kMemAllocModule = 0;
+
+// Precedes every block returned by MemAlloc. Two words keep the payload
+// as aligned as malloc's.
+union MemAllocHeader {
+  MemoryStats::Entry* entry;
+  double align[2];
+};
+
+PP_MemoryStats_Dev* StatsFor(PP_Module module,
+                             PP_MemoryStatsCategory_Dev category) {
+  if (category == PP_MEMORYSTATSCATEGORY_MEMALLOC)
+    module = kMemAllocModule;
+  return &g_stats[module].categories[category];
+}
+
+bool IsValidCategory(PP_MemoryStatsCategory_Dev category) {
+  return category >= 0 && category < PP_MEMORYSTATSCATEGORY_COUNT;
+}
+
+bool IsEnabled() {
+  return MemoryStats::enabled();
+}
+
+const PPB_MemoryStats_Dev memory_stats_interface = {
+  &MemoryStats::SetEnabled,
+  &IsEnabled,
+  &MemoryStats::GetStats,
+  &MemoryStats::ResetPeaks,
+  &MemoryStats::Dump
+};
+
+}  // namespace
+
+bool MemoryStats::enabled_ = false;
+
+void MemoryStats::Entry::Add(PP_Module module,
+                             PP_MemoryStatsCategory_Dev category,
+                             uint64_t bytes) {
+  pthread_mutex_lock(&g_lock);
+  // Check again now that we hold the lock, accounting may just have been
+  // turned off.
+  if (enabled_) {
+    generation_ = g_generation;
+    module_ = module;
+    category_ = category;
+    bytes_ = bytes;
+
+    PP_MemoryStats_Dev* stats = StatsFor(module, category);
+    stats->live_count++;
+    stats->live_bytes += bytes;
+    stats->total_count++;
+    if (stats->live_count > stats->peak_count)
+      stats->peak_count = stats->live_count;
+    if (stats->live_bytes > stats->peak_bytes)
+      stats->peak_bytes = stats->live_bytes;
+  }
+  pthread_mutex_unlock(&g_lock);
+}
+
+void MemoryStats::Entry::Remove() {
+  pthread_mutex_lock(&g_lock);
+  if (enabled_ && generation_ == g_generation) {
+    PP_MemoryStats_Dev* stats = StatsFor(module_, category_);
+    stats->live_count--;
+    stats->live_bytes -= bytes_;
+  }
+  generation_ = 0;
+  pthread_mutex_unlock(&g_lock);
+}
+
+// static
+const PPB_MemoryStats_Dev* MemoryStats::GetInterface() {
+  return &memory_stats_interface;
+}
+
+// static
+void MemoryStats::SetEnabled(bool enabled) {
+  pthread_mutex_lock(&g_lock);
+  if (enabled != enabled_) {
+    enabled_ = enabled;
+    g_stats.clear();
+    // Generation 0 means "not recorded", so skip it on wrap-around.
+    if (++g_generation == 0)
+      g_generation = 1;
+  }
+  pthread_mutex_unlock(&g_lock);
+}
+
+// static
+bool MemoryStats::GetStats(PP_Module module,
+                           PP_MemoryStatsCategory_Dev category,
+                           PP_MemoryStats_Dev* stats) {
+  if (!IsValidCategory(category) || !stats)
+    return false;
+  pthread_mutex_lock(&g_lock);
+  bool enabled = enabled_;
+  if (enabled)
+    *stats = *StatsFor(module, category);
+  pthread_mutex_unlock(&g_lock);
+  return enabled;
+}
+
+// static
+void MemoryStats::ResetPeaks(PP_Module module) {
+  pthread_mutex_lock(&g_lock);
+  for (int i = 0; i < PP_MEMORYSTATSCATEGORY_COUNT; i++) {
+    PP_MemoryStats_Dev* stats =
+        StatsFor(module, static_cast<PP_MemoryStatsCategory_Dev>(i));
+    stats->peak_count = stats->live_count;
+    stats->peak_bytes = stats->live_bytes;
+  }
+  pthread_mutex_unlock(&g_lock);
+}
+
+// static
+void MemoryStats::Dump(PP_Module module) {
+  pthread_mutex_lock(&g_lock);
+  if (!enabled_) {
+    fprintf(stderr, "Memory stats for module %d: accounting is off\n",
+            static_cast<int>(module));
+  } else {
+    fprintf(stderr, "Memory stats for module %d:\n", static_cast<int>(module));
+    fprintf(stderr, "  %-10s %10s %14s %10s %14s %10s\n", "category",
+            "live", "live bytes", "peak", "peak bytes", "total");
+    for (int i = 0; i < PP_MEMORYSTATSCATEGORY_COUNT; i++) {
+      const PP_MemoryStats_Dev* stats =
+          StatsFor(module, static_cast<PP_MemoryStatsCategory_Dev>(i));
+      fprintf(stderr, "  %-10s %10u %14llu %10u %14llu %10llu\n",
+              kCategoryNames[i],
+              stats->live_count,
+              static_cast<unsigned long long>(stats->live_bytes),
+              stats->peak_count,
+              static_cast<unsigned long long>(stats->peak_bytes),
+              static_cast<unsigned long long>(stats->total_count));
+    }
+  }
+  pthread_mutex_unlock(&g_lock);
+}
+
+// static
+void* MemoryStats::MemAlloc(size_t num_bytes) {
+  if (num_bytes > static_cast<size_t>(-1) - sizeof(MemAllocHeader))
+    return NULL;
+  MemAllocHeader* header =
+      static_cast<MemAllocHeader*>(malloc(sizeof(MemAllocHeader) + num_bytes));
+  if (!header)
+    return NULL;
+  header->entry = NULL;
+  if (enabled_) {
+    header->entry = new Entry;
+    header->entry->Record(kMemAllocModule, PP_MEMORYSTATSCATEGORY_MEMALLOC,
+                          num_bytes);
+  }
+  return header + 1;
+}
+
+// static
+void MemoryStats::MemFree(void* ptr) {
+  if (!ptr)
+    return;
+  MemAllocHeader* header = static_cast<MemAllocHeader*>(ptr) - 1;
+  delete header->entry;
+  free(header);
+}
+
+}  // namespace headless
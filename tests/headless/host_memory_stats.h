@@ -0,0 +1,86 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_MEMORY_STATS_H_
+#define PPAPI_TESTS_HEADLESS_HOST_MEMORY_STATS_H_
+
+#include <stddef.h>
+
+#include "ppapi/c/dev/ppb_memory_stats_dev.h"
+#include "ppapi/c/pp_module.h"
+#include "ppapi/c/pp_stdint.h"
+
+namespace headless {
+
+// Implements PPB_MemoryStats_Dev: per-module counts and high-water marks of
+// the objects the host creates for a plugin, plus PPB_Core.MemAlloc usage.
+//
+// Accounting is off by default. While it is off, recording an object costs
+// one load and branch. Every SetEnabled() call starts a new generation, and
+// objects only ever update the generation they were recorded in, so toggling
+// accounting while objects are alive never skews the counts.
+class MemoryStats {
+ public:
+  // Accounts for one object. Embed it in the object and call Record() once
+  // the object has been successfully created; the object is removed from
+  // the counts when the Entry is destroyed.
+  class Entry {
+   public:
+    Entry() : generation_(0) {}
+    ~Entry() {
+      if (generation_)
+        Remove();
+    }
+
+    void Record(PP_Module module,
+                PP_MemoryStatsCategory_Dev category,
+                uint64_t bytes) {
+      if (enabled_)
+        Add(module, category, bytes);
+    }
+
+   private:
+    void Add(PP_Module module,
+             PP_MemoryStatsCategory_Dev category,
+             uint64_t bytes);
+    void Remove();
+
+    // 0 if not recorded.
+    uint32_t generation_;
+    PP_Module module_;
+    PP_MemoryStatsCategory_Dev category_;
+    uint64_t bytes_;
+
+    // Disallow copy and assign (these are unimplemented).
+    Entry(const Entry&);
+    Entry& operator=(const Entry&);
+  };
+
+  static const PPB_MemoryStats_Dev* GetInterface();
+
+  static bool enabled() { return enabled_; }
+  static void SetEnabled(bool enabled);
+
+  // Returns false if accounting is off or |category| is invalid.
+  static bool GetStats(PP_Module module,
+                       PP_MemoryStatsCategory_Dev category,
+                       PP_MemoryStats_Dev* stats);
+
+  static void ResetPeaks(PP_Module module);
+
+  // Writes the counts of |module| to stderr.
+  static void Dump(PP_Module module);
+
+  // PPB_Core.MemAlloc and MemFree. Blocks carry a small header so they can
+  // be accounted for even though MemFree isn't given the size.
+  static void* MemAlloc(size_t num_bytes);
+  static void MemFree(void* ptr);
+
+ private:
+  static bool enabled_;
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_MEMORY_STATS_H_
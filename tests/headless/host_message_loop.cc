@@ -0,0 +1,159 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_message_loop.h"
+
+#include <errno.h>
+#include <time.h>
+
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/cpp/logging.h"
+
+namespace headless {
+
+namespace {
+
+MessageLoop* g_main_loop = NULL;
+
+struct timespec TicksToTimespec(PP_TimeTicks ticks) {
+  struct timespec ts;
+  ts.tv_sec = static_cast<time_t>(ticks);
+  ts.tv_nsec = static_cast<long>((ticks - ts.tv_sec) * 1e9);
+  if (ts.tv_nsec >= 1000000000L) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000L;
+  }
+  return ts;
+}
+
+}  // namespace
+
+bool MessageLoop::Task::operator<(const Task& other) const {
+  // std::priority_queue puts the "largest" element on top, so invert.
+  if (run_time != other.run_time)
+    return run_time > other.run_time;
+  return sequence_num > other.sequence_num;
+}
+
+MessageLoop::MessageLoop()
+    : thread_(pthread_self()),
+      next_sequence_num_(0),
+      quit_requested_(false),
+      run_depth_(0) {
+  pthread_mutex_init(&lock_, NULL);
+
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&cond_, &attr);
+  pthread_condattr_destroy(&attr);
+
+  PP_DCHECK(!g_main_loop);
+  g_main_loop = this;
+}
+
+MessageLoop::~MessageLoop() {
+  PP_DCHECK(run_depth_ == 0);
+  g_main_loop = NULL;
+  pthread_cond_destroy(&cond_);
+  pthread_mutex_destroy(&lock_);
+}
+
+// static
+MessageLoop* MessageLoop::current() {
+  return g_main_loop;
+}
+
+bool MessageLoop::IsMainThread() const {
+  return pthread_equal(thread_, pthread_self()) != 0;
+}
+
+void MessageLoop::PostDelayedTask(const PP_CompletionCallback& callback,
+                                  int32_t result,
+                                  int32_t delay_ms) {
+  PP_DCHECK(callback.func);
+  Task task;
+  task.callback = callback;
+  task.result = result;
+  task.run_time = Now() + (delay_ms > 0 ? delay_ms / 1000.0 : 0.0);
+
+  pthread_mutex_lock(&lock_);
+  task.sequence_num = next_sequence_num_++;
+  queue_.push(task);
+  pthread_cond_signal(&cond_);
+  pthread_mutex_unlock(&lock_);
+}
+
+void MessageLoop::Run() {
+  PP_DCHECK(IsMainThread());
+  run_depth_++;
+  Task task;
+  while (NextTask(true, &task))
+    PP_RunCompletionCallback(&task.callback, task.result);
+  run_depth_--;
+}
+
+void MessageLoop::Quit() {
+  PP_DCHECK(run_depth_ > 0);
+  pthread_mutex_lock(&lock_);
+  quit_requested_ = true;
+  pthread_cond_signal(&cond_);
+  pthread_mutex_unlock(&lock_);
+}
+
+int MessageLoop::RunUntilIdle() {
+  PP_DCHECK(IsMainThread());
+  int count = 0;
+  Task task;
+  while (NextTask(false, &task)) {
+    PP_RunCompletionCallback(&task.callback, task.result);
+    count++;
+  }
+  return count;
+}
+
+// static
+PP_TimeTicks MessageLoop::Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+bool MessageLoop::NextTask(bool wait, Task* task) {
+  pthread_mutex_lock(&lock_);
+  for (;;) {
+    if (wait && quit_requested_) {
+      // Each Quit() consumes exactly one level of Run().
+      quit_requested_ = false;
+      break;
+    }
+    if (!queue_.empty() && queue_.top().run_time <= Now()) {
+      *task = queue_.top();
+      queue_.pop();
+      pthread_mutex_unlock(&lock_);
+      return true;
+    }
+    if (!wait)
+      break;
+    if (queue_.empty()) {
+      pthread_cond_wait(&cond_, &lock_);
+    } else {
+      struct timespec deadline = TicksToTimespec(queue_.top().run_time);
+      int rv = pthread_cond_timedwait(&cond_, &lock_, &deadline);
+      PP_DCHECK(rv == 0 || rv == ETIMEDOUT);
+      (void)rv;
+    }
+  }
+  pthread_mutex_unlock(&lock_);
+  return false;
+}
+
+int32_t CompleteAsync(const PP_CompletionCallback& callback, int32_t result) {
+  if (!callback.func)
+    return PP_ERROR_BADARGUMENT;
+  MessageLoop::current()->PostTask(callback, result);
+  return PP_ERROR_WOULDBLOCK;
+}
+
+}  // namespace headless
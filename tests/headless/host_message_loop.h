@@ -0,0 +1,104 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_MESSAGE_LOOP_H_
+#define PPAPI_TESTS_HEADLESS_HOST_MESSAGE_LOOP_H_
+
+#include <pthread.h>
+
+#include <queue>
+#include <vector>
+
+#include "ppapi/c/pp_completion_callback.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/pp_time.h"
+
+namespace headless {
+
+// The main thread message loop of the headless host. Every asynchronous
+// PPB operation completes by posting its PP_CompletionCallback here, and
+// PPB_Testing_Dev.RunMessageLoop nests Run() calls, exactly like the message
+// loop a renderer would spin.
+//
+// Posting is thread-safe (PPB_Core.CallOnMainThread may be called from any
+// thread), everything else must happen on the thread that created the loop.
+class MessageLoop {
+ public:
+  MessageLoop();
+  ~MessageLoop();
+
+  // Returns the loop created on the main thread, or NULL if there is none.
+  static MessageLoop* current();
+
+  // Returns true if the calling thread is the one that created the loop.
+  bool IsMainThread() const;
+
+  // Schedules |callback| to be run with |result| after |delay_ms|
+  // milliseconds. Tasks with the same due time run in posting order.
+  void PostDelayedTask(const PP_CompletionCallback& callback,
+                       int32_t result,
+                       int32_t delay_ms);
+  void PostTask(const PP_CompletionCallback& callback, int32_t result) {
+    PostDelayedTask(callback, result, 0);
+  }
+
+  // Runs tasks until Quit() is called. May be called recursively from inside
+  // a task, in which case Quit() only exits the innermost invocation.
+  void Run();
+
+  // Makes the innermost Run() return after the currently running task.
+  void Quit();
+
+  // Runs every task that is already due, without waiting for delayed ones.
+  // Returns the number of tasks that were run.
+  int RunUntilIdle();
+
+  // Nesting depth of Run(); 0 when the loop is not running.
+  int run_depth() const { return run_depth_; }
+
+  // Monotonic clock used for delayed tasks, in seconds.
+  static PP_TimeTicks Now();
+
+ private:
+  struct Task {
+    PP_CompletionCallback callback;
+    int32_t result;
+    PP_TimeTicks run_time;
+    uint64_t sequence_num;
+
+    // Orders the priority queue so that the earliest task is on top.
+    bool operator<(const Task& other) const;
+  };
+
+  // Pops the next due task into |task|. When |wait| is true, blocks until a
+  // task is due or Quit() is called. Returns false if there is nothing to
+  // run.
+  bool NextTask(bool wait, Task* task);
+
+  pthread_t thread_;
+
+  // Protects |queue_|, |next_sequence_num_| and |quit_requested_|.
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+  std::priority_queue<Task> queue_;
+  uint64_t next_sequence_num_;
+  bool quit_requested_;
+
+  int run_depth_;
+
+  // Disallow copy and assign (these are unimplemented).
+  MessageLoop(const MessageLoop&);
+  MessageLoop& operator=(const MessageLoop&);
+};
+
+// Finishes an asynchronous PPB operation whose outcome is already known:
+// posts |callback| with |result| to the main loop and returns
+// PP_ERROR_WOULDBLOCK, so the plugin sees the same sequencing as in the
+// browser. Blocking callbacks can't be honored on the main thread and get
+// PP_ERROR_BADARGUMENT.
+int32_t CompleteAsync(const PP_CompletionCallback& callback, int32_t result);
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_MESSAGE_LOOP_H_
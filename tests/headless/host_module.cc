@@ -0,0 +1,171 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_module.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ppapi/c/dev/ppb_file_io_dev.h"
+#include "ppapi/c/dev/ppb_file_ref_dev.h"
+#include "ppapi/c/dev/ppb_file_system_dev.h"
+#include "ppapi/c/dev/ppb_memory_stats_dev.h"
+#include "ppapi/c/dev/ppb_testing_dev.h"
+#include "ppapi/c/dev/ppb_var_deprecated.h"
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/c/ppb_core.h"
+#include "ppapi/c/ppb_graphics_2d.h"
+#include "ppapi/c/ppb_image_data.h"
+#include "ppapi/c/ppb_instance.h"
+#include "ppapi/c/ppp_instance.h"
+#include "ppapi/tests/headless/host_core.h"
+#include "ppapi/tests/headless/host_file_io.h"
+#include "ppapi/tests/headless/host_file_ref.h"
+#include "ppapi/tests/headless/host_file_system.h"
+#include "ppapi/tests/headless/host_graphics_2d.h"
+#include "ppapi/tests/headless/host_image_data.h"
+#include "ppapi/tests/headless/host_instance.h"
+#include "ppapi/tests/headless/host_memory_stats.h"
+#include "ppapi/tests/headless/host_testing.h"
+#include "ppapi/tests/headless/host_var.h"
+
+namespace headless {
+
+namespace {
+
+typedef const void* (*GetInterfacePtr)();
+struct InterfaceMapElement {
+  const char* name;
+  GetInterfacePtr func;
+};
+
+const InterfaceMapElement interface_map[] = {
+  { PPB_CORE_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(Core::GetInterface) },
+  { PPB_FILEIO_DEV_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(FileIO::GetInterface) },
+  { PPB_FILEREF_DEV_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(FileRef::GetInterface) },
+  { PPB_FILESYSTEM_DEV_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(FileSystem::GetInterface) },
+  { PPB_GRAPHICS_2D_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(Graphics2D::GetInterface) },
+  { PPB_IMAGEDATA_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(ImageData::GetInterface) },
+  { PPB_INSTANCE_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(Instance::GetInterface) },
+  { PPB_MEMORY_STATS_DEV_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(MemoryStats::GetInterface) },
+  { PPB_TESTING_DEV_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(Testing::GetInterface) },
+  { PPB_VAR_DEPRECATED_INTERFACE,
+    reinterpret_cast<GetInterfacePtr>(Var::GetDeprecatedInterface) },
+};
+
+PP_Module g_last_module_id = 0;
+
+}  // namespace
+
+const void* GetBrowserInterface(const char* name) {
+  if (!name)
+    return NULL;
+  for (size_t i = 0; i < sizeof(interface_map) / sizeof(interface_map[0]);
+       ++i) {
+    if (strcmp(name, interface_map[i].name) == 0)
+      return interface_map[i].func();
+  }
+  return NULL;
+}
+
+PluginModule::PluginModule()
+    : pp_module_(0),
+      library_(NULL),
+      shutdown_module_(NULL),
+      get_interface_(NULL),
+      ppp_instance_(NULL) {
+}
+
+PluginModule::~PluginModule() {
+  Shutdown();
+}
+
+bool PluginModule::Load(const std::string& path, std::string* error) {
+  void* library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!library) {
+    *error = std::string("Could not load module: ") + dlerror();
+    return false;
+  }
+
+  InitializeModuleFunc initialize_module =
+      reinterpret_cast<InitializeModuleFunc>(
+          dlsym(library, "PPP_InitializeModule"));
+  ShutdownModuleFunc shutdown_module =
+      reinterpret_cast<ShutdownModuleFunc>(
+          dlsym(library, "PPP_ShutdownModule"));
+  GetInterfaceFunc get_interface =
+      reinterpret_cast<GetInterfaceFunc>(dlsym(library, "PPP_GetInterface"));
+  if (!initialize_module || !shutdown_module || !get_interface) {
+    *error = "Module is missing a PPP entry point: " + path;
+    dlclose(library);
+    return false;
+  }
+
+  library_ = library;
+  if (!InitFromEntryPoints(initialize_module, shutdown_module, get_interface,
+                           error)) {
+    // Shutdown() may already have unloaded it.
+    if (library_)
+      dlclose(library_);
+    library_ = NULL;
+    return false;
+  }
+  return true;
+}
+
+bool PluginModule::InitFromEntryPoints(InitializeModuleFunc initialize_module,
+                                       ShutdownModuleFunc shutdown_module,
+                                       GetInterfaceFunc get_interface,
+                                       std::string* error) {
+  PP_Module pp_module = ++g_last_module_id;
+  int32_t rv = initialize_module(pp_module, &GetBrowserInterface);
+  if (rv != PP_OK) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "PPP_InitializeModule failed: %d", rv);
+    *error = buf;
+    return false;
+  }
+
+  pp_module_ = pp_module;
+  shutdown_module_ = shutdown_module;
+  get_interface_ = get_interface;
+  ppp_instance_ = static_cast<const PPP_Instance*>(
+      get_interface(PPP_INSTANCE_INTERFACE));
+  if (!ppp_instance_) {
+    *error = "Module does not implement " PPP_INSTANCE_INTERFACE;
+    Shutdown();
+    return false;
+  }
+  return true;
+}
+
+void PluginModule::Shutdown() {
+  if (shutdown_module_)
+    shutdown_module_();
+  shutdown_module_ = NULL;
+  get_interface_ = NULL;
+  ppp_instance_ = NULL;
+  pp_module_ = 0;
+  if (library_)
+    dlclose(library_);
+  library_ = NULL;
+}
+
+const void* PluginModule::GetPluginInterface(const char* name) const {
+  if (!get_interface_)
+    return NULL;
+  return get_interface_(name);
+}
+
+}  // namespace headless
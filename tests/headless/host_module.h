@@ -0,0 +1,72 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_MODULE_H_
+#define PPAPI_TESTS_HEADLESS_HOST_MODULE_H_
+
+#include <string>
+
+#include "ppapi/c/pp_module.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/ppb.h"
+
+struct PPP_Instance;
+
+namespace headless {
+
+// A plugin module loaded into the host process. The module is a shared
+// library exporting the standard PPP_InitializeModule, PPP_ShutdownModule
+// and PPP_GetInterface entry points, exactly as a browser would load it.
+class PluginModule {
+ public:
+  typedef int32_t (*InitializeModuleFunc)(PP_Module, PPB_GetInterface);
+  typedef void (*ShutdownModuleFunc)();
+  typedef const void* (*GetInterfaceFunc)(const char*);
+
+  PluginModule();
+
+  // Shuts the module down if it's still loaded.
+  ~PluginModule();
+
+  // Loads the library at |path| and calls PPP_InitializeModule. On failure,
+  // returns false and fills |error|.
+  bool Load(const std::string& path, std::string* error);
+
+  // Initializes a module whose entry points are linked into the host
+  // binary instead of loaded from a library.
+  bool InitFromEntryPoints(InitializeModuleFunc initialize_module,
+                           ShutdownModuleFunc shutdown_module,
+                           GetInterfaceFunc get_interface,
+                           std::string* error);
+
+  // Calls PPP_ShutdownModule and unloads the library.
+  void Shutdown();
+
+  PP_Module pp_module() const { return pp_module_; }
+
+  // Returns the plugin's implementation of the given interface, or NULL.
+  const void* GetPluginInterface(const char* name) const;
+
+  // The module's PPP_Instance, valid after a successful Load().
+  const PPP_Instance* ppp_instance() const { return ppp_instance_; }
+
+ private:
+  PP_Module pp_module_;
+  void* library_;
+  ShutdownModuleFunc shutdown_module_;
+  GetInterfaceFunc get_interface_;
+  const PPP_Instance* ppp_instance_;
+
+  // Disallow copy and assign (these are unimplemented).
+  PluginModule(const PluginModule&);
+  PluginModule& operator=(const PluginModule&);
+};
+
+// The PPB_GetInterface handed to modules: returns the host implementation
+// of the given browser interface, or NULL if the host doesn't provide it.
+const void* GetBrowserInterface(const char* name);
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_MODULE_H_
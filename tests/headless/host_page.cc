@@ -0,0 +1,269 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_page.h"
+
+#include <map>
+
+#include "ppapi/tests/headless/host_script_object.h"
+#include "ppapi/tests/headless/host_var.h"
+
+namespace headless {
+
+// An element only remembers its innerHTML.
+class Page::Element : public ScriptObject {
+ public:
+  explicit Element(PP_Module module) : ScriptObject(module) {}
+
+  const std::string& inner_html() const { return inner_html_; }
+
+  virtual bool HasProperty(const std::string& name) {
+    return name == "innerHTML";
+  }
+
+  virtual PP_Var GetProperty(const std::string& name, PP_Var* exception) {
+    if (name == "innerHTML")
+      return StringVar(inner_html_);
+    return PP_MakeUndefined();
+  }
+
+  virtual void SetProperty(const std::string& name,
+                           PP_Var value,
+                           PP_Var* exception) {
+    if (name != "innerHTML") {
+      ScriptObject::SetProperty(name, value, exception);
+      return;
+    }
+    if (!Var::PPVarToString(value, &inner_html_))
+      SetException(exception, "Error: innerHTML must be a string");
+  }
+
+ private:
+  std::string inner_html_;
+};
+
+class Page::Document : public ScriptObject {
+ public:
+  explicit Document(PP_Module module) : ScriptObject(module) {}
+
+  virtual ~Document() {
+    for (ElementMap::iterator i = elements_.begin(); i != elements_.end(); ++i)
+      i->second->Release();
+  }
+
+  Element* FindElement(const std::string& id) const {
+    ElementMap::const_iterator found = elements_.find(id);
+    return found == elements_.end() ? NULL : found->second;
+  }
+
+  bool GetCookie(const std::string& name, std::string* value) const {
+    CookieMap::const_iterator found = cookies_.find(name);
+    if (found == cookies_.end())
+      return false;
+    *value = found->second;
+    return true;
+  }
+
+  virtual bool HasProperty(const std::string& name) {
+    return name == "cookie" || HasMethod(name);
+  }
+
+  virtual bool HasMethod(const std::string& name) {
+    return name == "getElementById";
+  }
+
+  virtual PP_Var GetProperty(const std::string& name, PP_Var* exception) {
+    if (name != "cookie")
+      return PP_MakeUndefined();
+    std::string cookies;
+    for (CookieMap::const_iterator i = cookies_.begin();
+         i != cookies_.end(); ++i) {
+      if (!cookies.empty())
+        cookies.append("; ");
+      cookies.append(i->first + "=" + i->second);
+    }
+    return StringVar(cookies);
+  }
+
+  virtual void SetProperty(const std::string& name,
+                           PP_Var value,
+                           PP_Var* exception) {
+    if (name != "cookie") {
+      ScriptObject::SetProperty(name, value, exception);
+      return;
+    }
+    // "<name>=<value>; path=/": attributes after the first ';' are ignored.
+    std::string cookie;
+    if (!Var::PPVarToString(value, &cookie))
+      return;
+    cookie = cookie.substr(0, cookie.find(';'));
+    size_t equals = cookie.find('=');
+    if (equals == std::string::npos)
+      cookies_[std::string()] = cookie;
+    else
+      cookies_[cookie.substr(0, equals)] = cookie.substr(equals + 1);
+  }
+
+  virtual PP_Var Call(const std::string& name,
+                      uint32_t argc,
+                      PP_Var* argv,
+                      PP_Var* exception) {
+    std::string id;
+    if (name != "getElementById")
+      return ScriptObject::Call(name, argc, argv, exception);
+    if (argc != 1 || !Var::PPVarToString(argv[0], &id)) {
+      SetException(exception, "Error: getElementById takes one string");
+      return PP_MakeUndefined();
+    }
+    // Elements spring into existence on first lookup.
+    Element* element = FindElement(id);
+    if (!element) {
+      element = new Element(module());
+      element->AddRef();
+      elements_[id] = element;
+    }
+    return element->CreateVar();
+  }
+
+ private:
+  typedef std::map<std::string, Element*> ElementMap;
+  ElementMap elements_;
+
+  typedef std::map<std::string, std::string> CookieMap;
+  CookieMap cookies_;
+};
+
+class Page::Location : public ScriptObject {
+ public:
+  Location(PP_Module module, const std::string& url)
+      : ScriptObject(module) {
+    href_ = url;
+    std::string rest = url;
+    size_t colon = rest.find(':');
+    if (colon != std::string::npos) {
+      protocol_ = rest.substr(0, colon + 1);
+      rest = rest.substr(colon + 1);
+    }
+    if (rest.compare(0, 2, "//") == 0) {
+      size_t slash = rest.find('/', 2);
+      host_ = rest.substr(2, slash == std::string::npos ? slash : slash - 2);
+      rest = slash == std::string::npos ? "/" : rest.substr(slash);
+    }
+    size_t query = rest.find('?');
+    pathname_ = rest.substr(0, query);
+    if (query != std::string::npos)
+      search_ = rest.substr(query);
+  }
+
+  virtual bool HasProperty(const std::string& name) {
+    return name == "href" || name == "protocol" || name == "host" ||
+           name == "pathname" || name == "search";
+  }
+
+  virtual PP_Var GetProperty(const std::string& name, PP_Var* exception) {
+    if (name == "href")
+      return StringVar(href_);
+    if (name == "protocol")
+      return StringVar(protocol_);
+    if (name == "host")
+      return StringVar(host_);
+    if (name == "pathname")
+      return StringVar(pathname_);
+    if (name == "search")
+      return StringVar(search_);
+    return PP_MakeUndefined();
+  }
+
+ private:
+  std::string href_;
+  std::string protocol_;
+  std::string host_;
+  std::string pathname_;
+  std::string search_;
+};
+
+class Page::Window : public ScriptObject {
+ public:
+  Window(PP_Module module, Delegate* delegate, const std::string& url)
+      : ScriptObject(module),
+        delegate_(delegate),
+        document_(new Document(module)),
+        location_(new Location(module, url)) {
+    document_->AddRef();
+    location_->AddRef();
+  }
+
+  virtual ~Window() {
+    document_->Release();
+    location_->Release();
+  }
+
+  Document* document() const { return document_; }
+
+  // The page is going away; the plugin may still hold references to us.
+  void Detach() { delegate_ = NULL; }
+
+  virtual bool HasProperty(const std::string& name) {
+    return name == "document" || name == "location" ||
+           name == "scrollX" || name == "scrollY" || HasMethod(name);
+  }
+
+  virtual bool HasMethod(const std::string& name) {
+    return name == "DidExecuteTests" || name == "find";
+  }
+
+  virtual PP_Var GetProperty(const std::string& name, PP_Var* exception) {
+    if (name == "document")
+      return document_->CreateVar();
+    if (name == "location")
+      return location_->CreateVar();
+    if (name == "scrollX" || name == "scrollY")
+      return PP_MakeInt32(0);
+    return PP_MakeUndefined();
+  }
+
+  virtual PP_Var Call(const std::string& name,
+                      uint32_t argc,
+                      PP_Var* argv,
+                      PP_Var* exception) {
+    if (name == "DidExecuteTests") {
+      if (delegate_)
+        delegate_->DidExecuteTests();
+      return PP_MakeUndefined();
+    }
+    if (name == "find")
+      return PP_MakeBool(false);  // There is no text to find.
+    return ScriptObject::Call(name, argc, argv, exception);
+  }
+
+ private:
+  Delegate* delegate_;
+  Document* document_;
+  Location* location_;
+};
+
+Page::Page(PP_Module module, Delegate* delegate, const std::string& url)
+    : window_(new Window(module, delegate, url)) {
+  window_->AddRef();
+}
+
+Page::~Page() {
+  window_->Detach();
+  window_->Release();
+}
+
+PP_Var Page::GetWindowObject() {
+  return window_->CreateVar();
+}
+
+std::string Page::GetElementHTML(const std::string& id) const {
+  Element* element = window_->document()->FindElement(id);
+  return element ? element->inner_html() : std::string();
+}
+
+bool Page::GetCookie(const std::string& name, std::string* value) const {
+  return window_->document()->GetCookie(name, value);
+}
+
+}  // namespace headless
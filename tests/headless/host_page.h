@@ -0,0 +1,69 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_PAGE_H_
+#define PPAPI_TESTS_HEADLESS_HOST_PAGE_H_
+
+#include <string>
+
+#include "ppapi/c/pp_module.h"
+#include "ppapi/c/pp_var.h"
+
+namespace headless {
+
+// Emulates the parts of the embedding page that test plugins touch through
+// PPB_Instance.GetWindowObject(), the way tests/test_case.html provides
+// them in a browser:
+//
+//   window.location.{href,protocol,host,pathname,search}
+//   window.document.getElementById(id).innerHTML    (get and set)
+//   window.document.cookie                          (get and set)
+//   window.DidExecuteTests()                        (reported to Delegate)
+//   window.scrollX, window.scrollY, window.find()
+//
+// Element contents and cookies are kept as strings so the host can read back
+// what the plugin logged.
+class Page {
+ public:
+  class Delegate {
+   public:
+    virtual ~Delegate() {}
+
+    // Called when the plugin calls window.DidExecuteTests().
+    virtual void DidExecuteTests() = 0;
+  };
+
+  // |url| is what window.location reports, for example
+  // "http://localhost/test_case.html?Graphics2D".
+  Page(PP_Module module, Delegate* delegate, const std::string& url);
+  ~Page();
+
+  // Returns a new reference to the window object.
+  PP_Var GetWindowObject();
+
+  // Returns the innerHTML of the element with the given id, or an empty
+  // string if the plugin never looked the element up.
+  std::string GetElementHTML(const std::string& id) const;
+
+  // Retrieves a cookie set through document.cookie. Returns false if no
+  // cookie with that name was set.
+  bool GetCookie(const std::string& name, std::string* value) const;
+
+ private:
+  class Document;
+  class Element;
+  class Location;
+  class Window;
+
+  // Owned by us through one reference; the plugin may hold more.
+  Window* window_;
+
+  // Disallow copy and assign (these are unimplemented).
+  Page(const Page&);
+  Page& operator=(const Page&);
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_PAGE_H_
@@ -0,0 +1,359 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_parallel_runner.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ppapi/tests/headless/host_file_system.h"
+#include "ppapi/tests/headless/host_message_loop.h"
+
+namespace headless {
+
+namespace {
+
+// How long past the timeout a worker gets before it's killed. The worker's
+// own TestRunner normally reports the timeout first.
+const double kGraceSeconds = 5;
+
+bool WriteAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(fd, data, size);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return false;
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+bool ReadAll(int fd, char* data, size_t size) {
+  while (size > 0) {
+    ssize_t read_size = read(fd, data, size);
+    if (read_size < 0 && errno == EINTR)
+      continue;
+    if (read_size <= 0)
+      return false;
+    data += read_size;
+    size -= read_size;
+  }
+  return true;
+}
+
+// Messages on the pipes are a 32-bit size followed by the bytes.
+bool WriteMessage(int fd, const std::string& message) {
+  uint32_t size = static_cast<uint32_t>(message.size());
+  return WriteAll(fd, reinterpret_cast<const char*>(&size), sizeof(size)) &&
+         WriteAll(fd, message.data(), message.size());
+}
+
+bool ReadMessage(int fd, std::string* message) {
+  uint32_t size;
+  if (!ReadAll(fd, reinterpret_cast<char*>(&size), sizeof(size)))
+    return false;
+  message->resize(size);
+  return size == 0 || ReadAll(fd, &(*message)[0], size);
+}
+
+template <class T>
+void Append(std::string* buffer, const T& value) {
+  buffer->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(std::string* buffer, const std::string& str) {
+  Append(buffer, static_cast<uint32_t>(str.size()));
+  buffer->append(str);
+}
+
+// Reads what Append and AppendString wrote, checking bounds.
+class MessageReader {
+ public:
+  explicit MessageReader(const std::string& message)
+      : message_(message), offset_(0) {}
+
+  template <class T>
+  bool Read(T* value) {
+    if (message_.size() - offset_ < sizeof(T))
+      return false;
+    memcpy(value, message_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool ReadString(std::string* str) {
+    uint32_t size;
+    if (!Read(&size) || message_.size() - offset_ < size)
+      return false;
+    str->assign(message_, offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+ private:
+  const std::string& message_;
+  size_t offset_;
+};
+
+std::string SerializeResult(const TestCaseResult& result) {
+  std::string message;
+  AppendString(&message, result.test_case);
+  Append(&message, static_cast<uint8_t>(result.passed));
+  Append(&message, static_cast<uint8_t>(result.timed_out));
+  AppendString(&message, result.completion_cookie);
+  AppendString(&message, result.console_text);
+  AppendString(&message, result.benchmark_results);
+  Append(&message, static_cast<uint32_t>(result.golden_failures.size()));
+  for (size_t i = 0; i < result.golden_failures.size(); i++)
+    AppendString(&message, result.golden_failures[i]);
+  Append(&message, result.elapsed_seconds);
+  return message;
+}
+
+bool DeserializeResult(const std::string& message, TestCaseResult* result) {
+  MessageReader reader(message);
+  uint8_t passed, timed_out;
+  uint32_t golden_failure_count;
+  if (!reader.ReadString(&result->test_case) ||
+      !reader.Read(&passed) ||
+      !reader.Read(&timed_out) ||
+      !reader.ReadString(&result->completion_cookie) ||
+      !reader.ReadString(&result->console_text) ||
+      !reader.ReadString(&result->benchmark_results) ||
+      !reader.Read(&golden_failure_count))
+    return false;
+  for (uint32_t i = 0; i < golden_failure_count; i++) {
+    std::string failure;
+    if (!reader.ReadString(&failure))
+      return false;
+    result->golden_failures.push_back(failure);
+  }
+  result->passed = passed != 0;
+  result->timed_out = timed_out != 0;
+  return reader.Read(&result->elapsed_seconds);
+}
+
+void SetFailure(const std::string& message, TestCaseResult* result) {
+  result->passed = false;
+  result->completion_cookie = message;
+  result->console_text = message + "\n";
+}
+
+}  // namespace
+
+ParallelTestRunner::ParallelTestRunner(TestRunner* runner,
+                                       int jobs,
+                                       double timeout_seconds,
+                                       const std::string& file_system_root)
+    : runner_(runner),
+      jobs_(jobs),
+      timeout_seconds_(timeout_seconds),
+      file_system_root_(file_system_root) {
+}
+
+ParallelTestRunner::~ParallelTestRunner() {
+}
+
+void ParallelTestRunner::Run(const std::vector<std::string>& test_cases,
+                             Delegate* delegate,
+                             std::vector<TestCaseResult>* results) {
+  results->clear();
+  results->resize(test_cases.size());
+  if (test_cases.empty())
+    return;
+
+  // A worker dying must show up as a failed write, not kill the runner.
+  signal(SIGPIPE, SIG_IGN);
+
+  int worker_count = jobs_ < static_cast<int>(test_cases.size()) ?
+      jobs_ : static_cast<int>(test_cases.size());
+  workers_.clear();
+  workers_.resize(worker_count);
+  for (int i = 0; i < worker_count; i++)
+    StartWorker(i);
+
+  size_t next_test = 0;
+  size_t finished = 0;
+  while (finished < test_cases.size()) {
+    // Hand out test cases to the idle workers.
+    for (size_t i = 0; i < workers_.size() && next_test < test_cases.size();
+         i++) {
+      Worker& worker = workers_[i];
+      if (worker.pid < 0 || worker.test_index >= 0)
+        continue;
+      if (!WriteMessage(worker.command_fd, test_cases[next_test])) {
+        // It died while idle; try again with a new one on the next round.
+        StopWorker(&worker, false);
+        StartWorker(static_cast<int>(i));
+        continue;
+      }
+      worker.test_index = static_cast<int>(next_test++);
+      worker.start_time = MessageLoop::Now();
+    }
+
+    std::vector<struct pollfd> poll_fds;
+    std::vector<size_t> poll_workers;
+    double now = MessageLoop::Now();
+    double wait_seconds = timeout_seconds_ + kGraceSeconds;
+    for (size_t i = 0; i < workers_.size(); i++) {
+      const Worker& worker = workers_[i];
+      if (worker.test_index < 0)
+        continue;
+      struct pollfd poll_fd;
+      poll_fd.fd = worker.result_fd;
+      poll_fd.events = POLLIN;
+      poll_fd.revents = 0;
+      poll_fds.push_back(poll_fd);
+      poll_workers.push_back(i);
+      double left = worker.start_time + timeout_seconds_ + kGraceSeconds - now;
+      if (left < wait_seconds)
+        wait_seconds = left;
+    }
+    if (poll_fds.empty()) {
+      // No worker could be started; run the rest in this process.
+      for (; next_test < test_cases.size(); next_test++, finished++) {
+        TestCaseResult* result = &(*results)[next_test];
+        runner_->RunTestCase(test_cases[next_test], result);
+        delegate->DidFinishTestCase(*result);
+      }
+      break;
+    }
+    if (wait_seconds < 0)
+      wait_seconds = 0;
+    if (poll(&poll_fds[0], poll_fds.size(),
+             static_cast<int>(wait_seconds * 1000) + 1) < 0 &&
+        errno != EINTR) {
+      perror("poll");
+      break;
+    }
+
+    now = MessageLoop::Now();
+    for (size_t i = 0; i < poll_fds.size(); i++) {
+      size_t number = poll_workers[i];
+      Worker& worker = workers_[number];
+      TestCaseResult* result = &(*results)[worker.test_index];
+      if (poll_fds[i].revents) {
+        std::string message;
+        if (ReadMessage(worker.result_fd, &message) &&
+            DeserializeResult(message, result)) {
+          worker.test_index = -1;
+        } else {
+          result->test_case = test_cases[worker.test_index];
+          result->elapsed_seconds = now - worker.start_time;
+          SetFailure("Worker " + StopWorker(&worker, false) +
+                     " while running the test", result);
+          StartWorker(static_cast<int>(number));
+        }
+      } else if (now - worker.start_time >=
+                 timeout_seconds_ + kGraceSeconds) {
+        result->test_case = test_cases[worker.test_index];
+        result->elapsed_seconds = now - worker.start_time;
+        result->timed_out = true;
+        StopWorker(&worker, true);
+        SetFailure("Worker killed after the test didn't finish in time",
+                   result);
+        StartWorker(static_cast<int>(number));
+      } else {
+        continue;
+      }
+      finished++;
+      delegate->DidFinishTestCase(*result);
+    }
+  }
+
+  for (size_t i = 0; i < workers_.size(); i++) {
+    if (workers_[i].pid >= 0)
+      StopWorker(&workers_[i], false);
+  }
+  workers_.clear();
+}
+
+bool ParallelTestRunner::StartWorker(int number) {
+  Worker& worker = workers_[number];
+  worker = Worker();
+
+  int command_pipe[2], result_pipe[2];
+  if (pipe(command_pipe) != 0)
+    return false;
+  if (pipe(result_pipe) != 0) {
+    close(command_pipe[0]);
+    close(command_pipe[1]);
+    return false;
+  }
+
+  // Whatever is buffered would otherwise be printed by the worker too.
+  fflush(stdout);
+  fflush(stderr);
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    close(command_pipe[0]);
+    close(command_pipe[1]);
+    close(result_pipe[0]);
+    close(result_pipe[1]);
+    return false;
+  }
+  if (pid == 0) {
+    // The other workers' pipes must be closed here, or the parent wouldn't
+    // see them close when those workers die.
+    for (size_t i = 0; i < workers_.size(); i++) {
+      if (workers_[i].pid >= 0) {
+        close(workers_[i].command_fd);
+        close(workers_[i].result_fd);
+      }
+    }
+    close(command_pipe[1]);
+    close(result_pipe[0]);
+    char name[32];
+    sprintf(name, "/worker_%d", number);
+    FileSystem::SetRootPath(file_system_root_ + name);
+    RunWorker(command_pipe[0], result_pipe[1]);
+  }
+
+  close(command_pipe[0]);
+  close(result_pipe[1]);
+  worker.pid = pid;
+  worker.command_fd = command_pipe[1];
+  worker.result_fd = result_pipe[0];
+  return true;
+}
+
+std::string ParallelTestRunner::StopWorker(Worker* worker, bool kill_worker) {
+  close(worker->command_fd);
+  close(worker->result_fd);
+  if (kill_worker)
+    kill(worker->pid, SIGKILL);
+  int status = 0;
+  while (waitpid(worker->pid, &status, 0) < 0 && errno == EINTR) {
+  }
+  *worker = Worker();
+
+  char description[64];
+  if (WIFSIGNALED(status))
+    sprintf(description, "was killed by signal %d", WTERMSIG(status));
+  else
+    sprintf(description, "exited with status %d", WEXITSTATUS(status));
+  return description;
+}
+
+void ParallelTestRunner::RunWorker(int command_fd, int result_fd) {
+  std::string test_case;
+  while (ReadMessage(command_fd, &test_case)) {
+    TestCaseResult result;
+    runner_->RunTestCase(test_case, &result);
+    if (!WriteMessage(result_fd, SerializeResult(result)))
+      break;
+  }
+  // Skip the exit handlers; the parent still owns the module's state.
+  _exit(0);
+}
+
+}  // namespace headless
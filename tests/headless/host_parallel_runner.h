@@ -0,0 +1,93 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_PARALLEL_RUNNER_H_
+#define PPAPI_TESTS_HEADLESS_HOST_PARALLEL_RUNNER_H_
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "ppapi/tests/headless/host_test_runner.h"
+
+namespace headless {
+
+// Runs test cases in worker processes, so that one that crashes only fails
+// itself, and on several cores when there's more than one worker. The
+// workers are forked from the current process once the module is loaded, so
+// each has its own copy of the module and its own main thread; plugins can't
+// be run on several threads of one process, and instances of one module
+// can't interleave their nested message loops.
+//
+// Each worker runs one test case at a time through the TestRunner, in a
+// fresh instance, and reports the result back over a pipe. The test cases
+// are handed out as workers become idle so that a few slow ones don't hold
+// up a whole shard. A worker that doesn't report within the timeout plus a
+// grace period, or that dies, is replaced and its test case fails.
+class ParallelTestRunner {
+ public:
+  class Delegate {
+   public:
+    virtual ~Delegate() {}
+
+    // Called in the parent process as each test case finishes, in the order
+    // they finish.
+    virtual void DidFinishTestCase(const TestCaseResult& result) = 0;
+  };
+
+  // |runner| must outlive this object. Every worker gets a subdirectory of
+  // |file_system_root| so that tests using files don't collide.
+  ParallelTestRunner(TestRunner* runner,
+                     int jobs,
+                     double timeout_seconds,
+                     const std::string& file_system_root);
+  ~ParallelTestRunner();
+
+  // Runs |test_cases| and fills |results| in the same order.
+  void Run(const std::vector<std::string>& test_cases,
+           Delegate* delegate,
+           std::vector<TestCaseResult>* results);
+
+ private:
+  struct Worker {
+    Worker() : pid(-1), command_fd(-1), result_fd(-1), test_index(-1),
+               start_time(0) {}
+
+    pid_t pid;
+    int command_fd;
+    int result_fd;
+
+    // The test case being run, or -1 if idle.
+    int test_index;
+    double start_time;
+  };
+
+  // Forks the worker in slot |number| of |workers_|. Returns false if that
+  // fails, leaving the slot empty.
+  bool StartWorker(int number);
+
+  // Closes the pipes to |worker| and reaps it, killing it first if
+  // |kill_worker|. Returns a description of how it exited.
+  std::string StopWorker(Worker* worker, bool kill_worker);
+
+  // The loop run by the worker processes; never returns.
+  void RunWorker(int command_fd, int result_fd);
+
+  TestRunner* runner_;
+  int jobs_;
+  double timeout_seconds_;
+  std::string file_system_root_;
+
+  // The workers of the current Run(); a pid of -1 marks an empty slot.
+  std::vector<Worker> workers_;
+
+  // Disallow copy and assign (these are unimplemented).
+  ParallelTestRunner(const ParallelTestRunner&);
+  ParallelTestRunner& operator=(const ParallelTestRunner&);
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_PARALLEL_RUNNER_H_
@@ -0,0 +1,702 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_png.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace headless {
+
+namespace {
+
+const unsigned char kSignature[8] = {
+  137, 'P', 'N', 'G', '\r', '\n', 26, '\n'
+};
+
+const int kColorTypeRGB = 2;
+const int kColorTypeRGBA = 6;
+
+// Larger images are rejected as corrupt rather than allocated.
+const int32_t kMaxPixels = 1 << 26;
+
+// Length and distance codes of deflate (RFC 1951, section 3.2.5).
+const int kLengthBase[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const int kLengthExtra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+const int kDistanceBase[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577
+};
+const int kDistanceExtra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+const int kMinMatch = 3;
+const int kMaxMatch = 258;
+const int kWindowSize = 32768;
+const int kHashBits = 15;
+// How many earlier positions with the same hash are tried per match.
+const int kMaxChain = 64;
+
+uint32_t ComputeCRC(const unsigned char* data, size_t size) {
+  static uint32_t table[256];
+  static bool table_ready = false;
+  if (!table_ready) {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++)
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      table[n] = c;
+    }
+    table_ready = true;
+  }
+  uint32_t crc = 0xffffffffu;
+  for (size_t i = 0; i < size; i++)
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  return crc ^ 0xffffffffu;
+}
+
+uint32_t ComputeAdler32(const unsigned char* data, size_t size) {
+  uint32_t a = 1, b = 0;
+  for (size_t i = 0; i < size; i++) {
+    a = (a + data[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  return (b << 16) | a;
+}
+
+void AppendBigEndian32(std::vector<unsigned char>* out, uint32_t value) {
+  out->push_back(static_cast<unsigned char>(value >> 24));
+  out->push_back(static_cast<unsigned char>(value >> 16));
+  out->push_back(static_cast<unsigned char>(value >> 8));
+  out->push_back(static_cast<unsigned char>(value));
+}
+
+uint32_t ReadBigEndian32(const unsigned char* p) {
+  return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) |
+         p[3];
+}
+
+void AppendChunk(std::vector<unsigned char>* png,
+                 const char* type,
+                 const std::vector<unsigned char>& data) {
+  AppendBigEndian32(png, static_cast<uint32_t>(data.size()));
+  size_t start = png->size();
+  png->insert(png->end(), type, type + 4);
+  png->insert(png->end(), data.begin(), data.end());
+  AppendBigEndian32(png, ComputeCRC(&(*png)[start], png->size() - start));
+}
+
+// Deflate ---------------------------------------------------------------------
+
+// Writes the bit stream of a deflate block, least significant bit first.
+class BitWriter {
+ public:
+  explicit BitWriter(std::vector<unsigned char>* out)
+      : out_(out), bits_(0), count_(0) {}
+
+  void WriteBits(uint32_t value, int count) {
+    bits_ |= value << count_;
+    count_ += count;
+    while (count_ >= 8) {
+      out_->push_back(static_cast<unsigned char>(bits_));
+      bits_ >>= 8;
+      count_ -= 8;
+    }
+  }
+
+  // Huffman codes are defined most significant bit first.
+  void WriteCode(uint32_t code, int length) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < length; i++) {
+      reversed = (reversed << 1) | (code & 1);
+      code >>= 1;
+    }
+    WriteBits(reversed, length);
+  }
+
+  void Flush() {
+    if (count_ > 0)
+      out_->push_back(static_cast<unsigned char>(bits_));
+    bits_ = 0;
+    count_ = 0;
+  }
+
+ private:
+  std::vector<unsigned char>* out_;
+  uint32_t bits_;
+  int count_;
+};
+
+// Writes a literal/length symbol with the fixed Huffman code.
+void WriteFixedSymbol(BitWriter* writer, int symbol) {
+  if (symbol < 144)
+    writer->WriteCode(0x30 + symbol, 8);
+  else if (symbol < 256)
+    writer->WriteCode(0x190 + symbol - 144, 9);
+  else if (symbol < 280)
+    writer->WriteCode(symbol - 256, 7);
+  else
+    writer->WriteCode(0xc0 + symbol - 280, 8);
+}
+
+void WriteMatch(BitWriter* writer, int length, int distance) {
+  int code = 28;
+  while (kLengthBase[code] > length)
+    code--;
+  WriteFixedSymbol(writer, 257 + code);
+  writer->WriteBits(length - kLengthBase[code], kLengthExtra[code]);
+
+  code = 29;
+  while (kDistanceBase[code] > distance)
+    code--;
+  writer->WriteCode(code, 5);
+  writer->WriteBits(distance - kDistanceBase[code], kDistanceExtra[code]);
+}
+
+uint32_t Hash(const unsigned char* p) {
+  uint32_t value = (p[0] << 16) | (p[1] << 8) | p[2];
+  return (value * 2654435761u) >> (32 - kHashBits);
+}
+
+// Compresses |data| into a single deflate block with the fixed Huffman code.
+// Golden images are mostly flat colors, which LZ77 alone handles well.
+void Deflate(const std::vector<unsigned char>& data,
+             std::vector<unsigned char>* out) {
+  BitWriter writer(out);
+  writer.WriteBits(1, 1);  // Final block.
+  writer.WriteBits(1, 2);  // Fixed Huffman code.
+
+  const unsigned char* p = data.empty() ? NULL : &data[0];
+  int size = static_cast<int>(data.size());
+  std::vector<int> head(1 << kHashBits, -1);
+  std::vector<int> prev(size);
+
+  int pos = 0;
+  while (pos < size) {
+    int best_length = 0;
+    int best_distance = 0;
+    if (pos + kMinMatch <= size) {
+      int max_length = std::min(kMaxMatch, size - pos);
+      int candidate = head[Hash(p + pos)];
+      for (int chain = 0;
+           candidate >= 0 && pos - candidate <= kWindowSize &&
+               chain < kMaxChain;
+           chain++) {
+        int length = 0;
+        while (length < max_length && p[candidate + length] == p[pos + length])
+          length++;
+        if (length > best_length) {
+          best_length = length;
+          best_distance = pos - candidate;
+          if (length == max_length)
+            break;
+        }
+        candidate = prev[candidate];
+      }
+    }
+
+    int advance = 1;
+    if (best_length >= kMinMatch) {
+      WriteMatch(&writer, best_length, best_distance);
+      advance = best_length;
+    } else {
+      WriteFixedSymbol(&writer, p[pos]);
+    }
+    for (int end = pos + advance; pos < end; pos++) {
+      if (pos + kMinMatch <= size) {
+        uint32_t hash = Hash(p + pos);
+        prev[pos] = head[hash];
+        head[hash] = pos;
+      }
+    }
+  }
+
+  WriteFixedSymbol(&writer, 256);  // End of block.
+  writer.Flush();
+}
+
+// Inflate ---------------------------------------------------------------------
+
+// A canonical Huffman code: the number of codes of each length and the
+// symbols ordered by code.
+struct HuffmanCode {
+  short count[16];
+  short symbol[288];
+};
+
+// Returns 0 for a complete code, a positive number for an incomplete one
+// and a negative number for an over-subscribed one.
+int BuildHuffmanCode(HuffmanCode* code, const short* lengths, int n) {
+  memset(code->count, 0, sizeof(code->count));
+  for (int i = 0; i < n; i++)
+    code->count[lengths[i]]++;
+  if (code->count[0] == n)
+    return 0;
+
+  int left = 1;
+  for (int length = 1; length < 16; length++) {
+    left <<= 1;
+    left -= code->count[length];
+    if (left < 0)
+      return left;
+  }
+
+  short offsets[16];
+  offsets[1] = 0;
+  for (int length = 1; length < 15; length++)
+    offsets[length + 1] = offsets[length] + code->count[length];
+  for (int i = 0; i < n; i++) {
+    if (lengths[i] != 0)
+      code->symbol[offsets[lengths[i]]++] = static_cast<short>(i);
+  }
+  return left;
+}
+
+class Inflater {
+ public:
+  Inflater(const unsigned char* data, size_t size)
+      : data_(data), size_(size), pos_(0), bits_(0), count_(0),
+        error_(false) {}
+
+  bool Inflate(std::vector<unsigned char>* out) {
+    bool last;
+    do {
+      last = ReadBits(1) != 0;
+      switch (ReadBits(2)) {
+        case 0:
+          if (!Stored(out))
+            return false;
+          break;
+        case 1:
+          if (!Fixed(out))
+            return false;
+          break;
+        case 2:
+          if (!Dynamic(out))
+            return false;
+          break;
+        default:
+          return false;
+      }
+    } while (!last && !error_);
+    return !error_;
+  }
+
+  // Bytes consumed so far.
+  size_t position() const { return pos_; }
+
+ private:
+  int ReadBits(int count) {
+    uint32_t value = bits_;
+    while (count_ < count) {
+      if (pos_ == size_) {
+        error_ = true;
+        return 0;
+      }
+      value |= static_cast<uint32_t>(data_[pos_++]) << count_;
+      count_ += 8;
+    }
+    bits_ = value >> count;
+    count_ -= count;
+    return static_cast<int>(value & ((1u << count) - 1));
+  }
+
+  int Decode(const HuffmanCode& code) {
+    int value = 0, first = 0, index = 0;
+    for (int length = 1; length < 16; length++) {
+      value |= ReadBits(1);
+      int count = code.count[length];
+      if (value - count < first)
+        return code.symbol[index + (value - first)];
+      index += count;
+      first += count;
+      first <<= 1;
+      value <<= 1;
+    }
+    error_ = true;
+    return -1;
+  }
+
+  bool Stored(std::vector<unsigned char>* out) {
+    // Stored blocks start at a byte boundary.
+    bits_ = 0;
+    count_ = 0;
+    if (size_ - pos_ < 4)
+      return false;
+    unsigned length = data_[pos_] | (data_[pos_ + 1] << 8);
+    unsigned complement = data_[pos_ + 2] | (data_[pos_ + 3] << 8);
+    pos_ += 4;
+    if (length != (~complement & 0xffff) || size_ - pos_ < length)
+      return false;
+    out->insert(out->end(), data_ + pos_, data_ + pos_ + length);
+    pos_ += length;
+    return true;
+  }
+
+  bool Fixed(std::vector<unsigned char>* out) {
+    static HuffmanCode length_code, distance_code;
+    static bool ready = false;
+    if (!ready) {
+      short lengths[288];
+      int i = 0;
+      for (; i < 144; i++)
+        lengths[i] = 8;
+      for (; i < 256; i++)
+        lengths[i] = 9;
+      for (; i < 280; i++)
+        lengths[i] = 7;
+      for (; i < 288; i++)
+        lengths[i] = 8;
+      BuildHuffmanCode(&length_code, lengths, 288);
+      for (i = 0; i < 30; i++)
+        lengths[i] = 5;
+      BuildHuffmanCode(&distance_code, lengths, 30);
+      ready = true;
+    }
+    return Codes(length_code, distance_code, out);
+  }
+
+  bool Dynamic(std::vector<unsigned char>* out) {
+    static const int kOrder[19] = {
+      16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+    };
+    int length_count = ReadBits(5) + 257;
+    int distance_count = ReadBits(5) + 1;
+    int code_count = ReadBits(4) + 4;
+    if (error_ || length_count > 286 || distance_count > 30)
+      return false;
+
+    short lengths[320];
+    int index = 0;
+    for (; index < code_count; index++)
+      lengths[kOrder[index]] = static_cast<short>(ReadBits(3));
+    for (; index < 19; index++)
+      lengths[kOrder[index]] = 0;
+    HuffmanCode length_code, distance_code;
+    if (BuildHuffmanCode(&length_code, lengths, 19) != 0)
+      return false;
+
+    index = 0;
+    while (index < length_count + distance_count) {
+      int symbol = Decode(length_code);
+      if (symbol < 0)
+        return false;
+      if (symbol < 16) {
+        lengths[index++] = static_cast<short>(symbol);
+        continue;
+      }
+      short length = 0;
+      int repeat;
+      if (symbol == 16) {
+        if (index == 0)
+          return false;
+        length = lengths[index - 1];
+        repeat = 3 + ReadBits(2);
+      } else if (symbol == 17) {
+        repeat = 3 + ReadBits(3);
+      } else {
+        repeat = 11 + ReadBits(7);
+      }
+      if (index + repeat > length_count + distance_count)
+        return false;
+      while (repeat--)
+        lengths[index++] = length;
+    }
+    if (error_ || lengths[256] == 0)
+      return false;
+
+    // Incomplete codes are only allowed if they have a single code.
+    int left = BuildHuffmanCode(&length_code, lengths, length_count);
+    if (left < 0 ||
+        (left > 0 &&
+         length_count - length_code.count[0] != 1))
+      return false;
+    left = BuildHuffmanCode(&distance_code, lengths + length_count,
+                            distance_count);
+    if (left < 0 ||
+        (left > 0 &&
+         distance_count - distance_code.count[0] != 1))
+      return false;
+    return Codes(length_code, distance_code, out);
+  }
+
+  bool Codes(const HuffmanCode& length_code,
+             const HuffmanCode& distance_code,
+             std::vector<unsigned char>* out) {
+    for (;;) {
+      int symbol = Decode(length_code);
+      if (symbol < 0 || error_)
+        return false;
+      if (symbol < 256) {
+        out->push_back(static_cast<unsigned char>(symbol));
+        continue;
+      }
+      if (symbol == 256)
+        return true;
+      symbol -= 257;
+      if (symbol >= 29)
+        return false;
+      int length = kLengthBase[symbol] + ReadBits(kLengthExtra[symbol]);
+      symbol = Decode(distance_code);
+      if (symbol < 0 || symbol >= 30)
+        return false;
+      size_t distance = kDistanceBase[symbol] +
+          ReadBits(kDistanceExtra[symbol]);
+      if (error_ || distance > out->size())
+        return false;
+      size_t from = out->size() - distance;
+      for (int i = 0; i < length; i++)
+        out->push_back((*out)[from + i]);
+    }
+  }
+
+  const unsigned char* data_;
+  size_t size_;
+  size_t pos_;
+  uint32_t bits_;
+  int count_;
+  bool error_;
+};
+
+// Filters ---------------------------------------------------------------------
+
+int PaethPredictor(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = abs(p - a);
+  int pb = abs(p - b);
+  int pc = abs(p - c);
+  if (pa <= pb && pa <= pc)
+    return a;
+  return pb <= pc ? b : c;
+}
+
+// Undoes the filter of |row| given the previous, already unfiltered, row.
+bool Unfilter(int type,
+              unsigned char* row,
+              const unsigned char* previous,
+              size_t row_bytes,
+              int bpp) {
+  for (size_t i = 0; i < row_bytes; i++) {
+    int left = i >= static_cast<size_t>(bpp) ? row[i - bpp] : 0;
+    int up = previous[i];
+    int up_left = i >= static_cast<size_t>(bpp) ? previous[i - bpp] : 0;
+    int prediction;
+    switch (type) {
+      case 0:
+        prediction = 0;
+        break;
+      case 1:
+        prediction = left;
+        break;
+      case 2:
+        prediction = up;
+        break;
+      case 3:
+        prediction = (left + up) / 2;
+        break;
+      case 4:
+        prediction = PaethPredictor(left, up, up_left);
+        break;
+      default:
+        return false;
+    }
+    row[i] = static_cast<unsigned char>(row[i] + prediction);
+  }
+  return true;
+}
+
+int SumOfAbsolute(const unsigned char* row, size_t size) {
+  int sum = 0;
+  for (size_t i = 0; i < size; i++)
+    sum += abs(static_cast<signed char>(row[i]));
+  return sum;
+}
+
+}  // namespace
+
+void EncodePNG(const uint32_t* pixels,
+               int32_t width,
+               int32_t height,
+               int32_t stride,
+               std::vector<unsigned char>* png) {
+  const int kBpp = 4;
+  size_t row_bytes = static_cast<size_t>(width) * kBpp;
+
+  // Each row gets the filter, among none, sub and up, that leaves the
+  // smallest values, which is the usual heuristic.
+  std::vector<unsigned char> raw;
+  raw.reserve((row_bytes + 1) * height);
+  std::vector<unsigned char> current(row_bytes), previous(row_bytes, 0);
+  std::vector<unsigned char> sub(row_bytes), up(row_bytes);
+  for (int32_t y = 0; y < height; y++) {
+    const uint32_t* src = reinterpret_cast<const uint32_t*>(
+        reinterpret_cast<const char*>(pixels) + y * stride);
+    for (int32_t x = 0; x < width; x++) {
+      uint32_t pixel = src[x];
+      current[x * kBpp + 0] = static_cast<unsigned char>(pixel >> 16);
+      current[x * kBpp + 1] = static_cast<unsigned char>(pixel >> 8);
+      current[x * kBpp + 2] = static_cast<unsigned char>(pixel);
+      current[x * kBpp + 3] = static_cast<unsigned char>(pixel >> 24);
+    }
+    for (size_t i = 0; i < row_bytes; i++) {
+      sub[i] = static_cast<unsigned char>(
+          current[i] - (i >= kBpp ? current[i - kBpp] : 0));
+      up[i] = static_cast<unsigned char>(current[i] - previous[i]);
+    }
+    int none_sum = SumOfAbsolute(&current[0], row_bytes);
+    int sub_sum = SumOfAbsolute(&sub[0], row_bytes);
+    int up_sum = SumOfAbsolute(&up[0], row_bytes);
+    if (none_sum <= sub_sum && none_sum <= up_sum) {
+      raw.push_back(0);
+      raw.insert(raw.end(), current.begin(), current.end());
+    } else if (sub_sum <= up_sum) {
+      raw.push_back(1);
+      raw.insert(raw.end(), sub.begin(), sub.end());
+    } else {
+      raw.push_back(2);
+      raw.insert(raw.end(), up.begin(), up.end());
+    }
+    previous.swap(current);
+  }
+
+  std::vector<unsigned char> zlib;
+  zlib.push_back(0x78);
+  zlib.push_back(0x01);
+  Deflate(raw, &zlib);
+  AppendBigEndian32(&zlib, ComputeAdler32(raw.empty() ? NULL : &raw[0],
+                                          raw.size()));
+
+  std::vector<unsigned char> header;
+  AppendBigEndian32(&header, width);
+  AppendBigEndian32(&header, height);
+  header.push_back(8);  // Bit depth.
+  header.push_back(kColorTypeRGBA);
+  header.push_back(0);  // Compression.
+  header.push_back(0);  // Filter method.
+  header.push_back(0);  // No interlacing.
+
+  png->assign(kSignature, kSignature + sizeof(kSignature));
+  AppendChunk(png, "IHDR", header);
+  AppendChunk(png, "IDAT", zlib);
+  AppendChunk(png, "IEND", std::vector<unsigned char>());
+}
+
+bool DecodePNG(const unsigned char* data,
+               size_t size,
+               std::vector<uint32_t>* pixels,
+               int32_t* width,
+               int32_t* height,
+               std::string* error) {
+  if (size < sizeof(kSignature) ||
+      memcmp(data, kSignature, sizeof(kSignature)) != 0) {
+    *error = "Not a PNG file";
+    return false;
+  }
+
+  int32_t w = 0, h = 0;
+  int color_type = -1;
+  std::vector<unsigned char> zlib;
+  size_t pos = sizeof(kSignature);
+  bool seen_end = false;
+  while (!seen_end) {
+    if (size - pos < 12) {
+      *error = "Truncated PNG";
+      return false;
+    }
+    uint32_t length = ReadBigEndian32(data + pos);
+    if (length > size - pos - 12) {
+      *error = "Truncated PNG";
+      return false;
+    }
+    const unsigned char* type = data + pos + 4;
+    const unsigned char* chunk = data + pos + 8;
+    if (ComputeCRC(type, length + 4) != ReadBigEndian32(chunk + length)) {
+      *error = "Bad PNG chunk checksum";
+      return false;
+    }
+    if (memcmp(type, "IHDR", 4) == 0) {
+      if (length != 13) {
+        *error = "Bad PNG header";
+        return false;
+      }
+      w = static_cast<int32_t>(ReadBigEndian32(chunk));
+      h = static_cast<int32_t>(ReadBigEndian32(chunk + 4));
+      color_type = chunk[9];
+      if (w <= 0 || h <= 0 || w > kMaxPixels / h) {
+        *error = "Bad PNG size";
+        return false;
+      }
+      if (chunk[8] != 8 ||
+          (color_type != kColorTypeRGB && color_type != kColorTypeRGBA) ||
+          chunk[10] != 0 || chunk[11] != 0 || chunk[12] != 0) {
+        *error = "Unsupported PNG format; only 8-bit non-interlaced RGB "
+                 "and RGBA images are supported";
+        return false;
+      }
+    } else if (memcmp(type, "IDAT", 4) == 0) {
+      zlib.insert(zlib.end(), chunk, chunk + length);
+    } else if (memcmp(type, "IEND", 4) == 0) {
+      seen_end = true;
+    } else if (!(type[0] & 0x20)) {
+      // An unknown critical chunk.
+      *error = "Unsupported PNG chunk";
+      return false;
+    }
+    pos += length + 12;
+  }
+  if (color_type < 0) {
+    *error = "PNG has no header";
+    return false;
+  }
+
+  // The zlib stream: no preset dictionary, deflate, valid check bits.
+  if (zlib.size() < 6 || (zlib[0] & 0x0f) != 8 || (zlib[1] & 0x20) ||
+      ((zlib[0] << 8) | zlib[1]) % 31 != 0) {
+    *error = "Bad PNG image data";
+    return false;
+  }
+  int bpp = color_type == kColorTypeRGBA ? 4 : 3;
+  size_t row_bytes = static_cast<size_t>(w) * bpp;
+  std::vector<unsigned char> raw;
+  raw.reserve((row_bytes + 1) * h);
+  Inflater inflater(&zlib[2], zlib.size() - 2);
+  if (!inflater.Inflate(&raw) || raw.size() != (row_bytes + 1) * h) {
+    *error = "Bad PNG image data";
+    return false;
+  }
+
+  pixels->resize(static_cast<size_t>(w) * h);
+  std::vector<unsigned char> zero_row(row_bytes, 0);
+  const unsigned char* previous = &zero_row[0];
+  for (int32_t y = 0; y < h; y++) {
+    unsigned char* row = &raw[y * (row_bytes + 1)];
+    if (!Unfilter(row[0], row + 1, previous, row_bytes, bpp)) {
+      *error = "Bad PNG filter";
+      return false;
+    }
+    row++;
+    for (int32_t x = 0; x < w; x++) {
+      const unsigned char* p = row + x * bpp;
+      uint32_t alpha = bpp == 4 ? p[3] : 0xff;
+      (*pixels)[y * w + x] = (alpha << 24) | (p[0] << 16) | (p[1] << 8) | p[2];
+    }
+    previous = row;
+  }
+  *width = w;
+  *height = h;
+  return true;
+}
+
+}  // namespace headless
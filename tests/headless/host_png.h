@@ -0,0 +1,46 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_PNG_H_
+#define PPAPI_TESTS_HEADLESS_HOST_PNG_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+
+namespace headless {
+
+// A minimal PNG codec for golden images, so that the host doesn't need zlib
+// or libpng.
+//
+// Pixels are 32-bit words laid out like the native image data format of the
+// host (BGRA in memory, premultiplied). They are stored in the PNG as RGBA
+// without unpremultiplying, so that they round-trip exactly; viewers show
+// translucent pixels darker than they are.
+
+// Encodes a |width| x |height| image, |stride| bytes per row, as an 8-bit
+// RGBA PNG.
+void EncodePNG(const uint32_t* pixels,
+               int32_t width,
+               int32_t height,
+               int32_t stride,
+               std::vector<unsigned char>* png);
+
+// Decodes a non-interlaced 8-bit RGB or RGBA PNG into |pixels|, tightly
+// packed. RGB images get an opaque alpha channel. Returns false and sets
+// |error| if the data is corrupt or uses features the decoder doesn't
+// support.
+bool DecodePNG(const unsigned char* data,
+               size_t size,
+               std::vector<uint32_t>* pixels,
+               int32_t* width,
+               int32_t* height,
+               std::string* error);
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_PNG_H_
@@ -0,0 +1,138 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_replay.h"
+
+#include <vector>
+
+#include "ppapi/c/pp_completion_callback.h"
+#include "ppapi/cpp/dev/instance_recording_dev.h"
+#include "ppapi/tests/headless/host_instance.h"
+#include "ppapi/tests/headless/host_message_loop.h"
+
+namespace headless {
+
+namespace {
+
+const char kPageURL[] = "http://localhost/replay.html";
+
+}  // namespace
+
+Replayer::Replayer(PluginModule* module)
+    : module_(module),
+      speed_(SPEED_ORIGINAL) {
+}
+
+Replayer::~Replayer() {
+  DestroyInstances();
+}
+
+bool Replayer::Replay(const std::string& path,
+                      ReplayResult* result,
+                      std::string* error) {
+  pp::InstanceRecordReader_Dev reader;
+  if (!reader.Open(path.c_str(), error))
+    return false;
+
+  PP_TimeTicks start = MessageLoop::Now();
+  pp::InstanceRecord_Dev record;
+  while (reader.Read(&record)) {
+    if (speed_ == SPEED_ORIGINAL)
+      RunUntil(start + record.time);
+    else
+      MessageLoop::current()->RunUntilIdle();
+
+    result->records++;
+    switch (record.type) {
+      case pp::InstanceRecord_Dev::TYPE_DID_CREATE: {
+        InstanceMap::iterator found = instances_.find(record.instance);
+        if (found != instances_.end()) {
+          // Shouldn't happen; don't create a second instance.
+          result->skipped++;
+          break;
+        }
+        Instance* instance = new Instance(module_, kPageURL, NULL);
+        instances_[record.instance] = instance;
+        instance->Initialize(record.arg_names, record.arg_values);
+        break;
+      }
+      case pp::InstanceRecord_Dev::TYPE_DID_DESTROY: {
+        InstanceMap::iterator found = instances_.find(record.instance);
+        if (found != instances_.end()) {
+          delete found->second;
+          instances_.erase(found);
+        }
+        break;
+      }
+      case pp::InstanceRecord_Dev::TYPE_DID_CHANGE_VIEW:
+        GetInstance(record.instance)->SetPosition(record.position,
+                                                  record.clip);
+        break;
+      case pp::InstanceRecord_Dev::TYPE_DID_CHANGE_FOCUS:
+        GetInstance(record.instance)->SetFocus(record.has_focus);
+        break;
+      case pp::InstanceRecord_Dev::TYPE_HANDLE_INPUT_EVENT: {
+        // Keep the intervals between the events' own time stamps but move
+        // them to the clock of this run.
+        PP_InputEvent event = record.event;
+        event.time_stamp = event.time_stamp - reader.start_time() + start;
+        result->input_events++;
+        if (GetInstance(record.instance)->HandleInputEvent(event))
+          result->input_events_handled++;
+        break;
+      }
+      case pp::InstanceRecord_Dev::TYPE_HANDLE_DOCUMENT_LOAD:
+        result->skipped++;
+        break;
+    }
+  }
+
+  DestroyInstances();
+  MessageLoop::current()->RunUntilIdle();
+  result->elapsed_seconds = MessageLoop::Now() - start;
+
+  if (!reader.error().empty()) {
+    *error = path + ": " + reader.error();
+    return false;
+  }
+  return true;
+}
+
+Instance* Replayer::GetInstance(uint32_t number) {
+  InstanceMap::iterator found = instances_.find(number);
+  if (found != instances_.end())
+    return found->second;
+  Instance* instance = new Instance(module_, kPageURL, NULL);
+  instances_[number] = instance;
+  instance->Initialize(std::vector<std::string>(), std::vector<std::string>());
+  return instance;
+}
+
+void Replayer::RunUntil(PP_TimeTicks time) {
+  MessageLoop* loop = MessageLoop::current();
+  PP_TimeTicks delay = time - MessageLoop::Now();
+  if (delay <= 0) {
+    loop->RunUntilIdle();
+    return;
+  }
+  loop->PostDelayedTask(
+      PP_MakeCompletionCallback(&Replayer::OnRunUntilDone, loop),
+      0,
+      static_cast<int32_t>(delay * 1000));
+  loop->Run();
+}
+
+// static
+void Replayer::OnRunUntilDone(void* user_data, int32_t result) {
+  static_cast<MessageLoop*>(user_data)->Quit();
+}
+
+void Replayer::DestroyInstances() {
+  for (InstanceMap::iterator i = instances_.begin(); i != instances_.end();
+       ++i)
+    delete i->second;
+  instances_.clear();
+}
+
+}  // namespace headless
@@ -0,0 +1,91 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_REPLAY_H_
+#define PPAPI_TESTS_HEADLESS_HOST_REPLAY_H_
+
+#include <map>
+#include <string>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/pp_time.h"
+
+namespace headless {
+
+class Instance;
+class PluginModule;
+
+struct ReplayResult {
+  ReplayResult()
+      : records(0),
+        input_events(0),
+        input_events_handled(0),
+        skipped(0),
+        elapsed_seconds(0) {}
+
+  int records;
+  int input_events;
+  // How many of the input events the plugin reported as handled.
+  int input_events_handled;
+  // Records that can't be replayed by the headless host (document loads).
+  int skipped;
+  double elapsed_seconds;
+};
+
+// Feeds a log written by pp::InstanceRecorder_Dev back into a module. Each
+// recorded instance is replaced by a headless instance which gets the same
+// PPP_Instance calls in the same order, either with the recorded timing or
+// as fast as possible. The message loop runs between calls in both cases,
+// so paints and other callbacks the plugin posts are interleaved with the
+// calls much like they were in the browser.
+//
+// Instances that already existed when the recording started are created
+// with no attributes when they first appear. HandleDocumentLoad can't be
+// replayed since the headless host has no URL loader; those records are
+// counted as skipped.
+class Replayer {
+ public:
+  enum Speed {
+    // Waits between calls as long as the recording did.
+    SPEED_ORIGINAL,
+    // Only runs the tasks that are already due between calls.
+    SPEED_MAXIMUM
+  };
+
+  explicit Replayer(PluginModule* module);
+  ~Replayer();
+
+  void set_speed(Speed speed) { speed_ = speed; }
+
+  // Replays the log at |path|. Returns false and sets |error| if the log
+  // can't be read; the calls replayed up to that point are kept in |result|.
+  bool Replay(const std::string& path,
+              ReplayResult* result,
+              std::string* error);
+
+ private:
+  typedef std::map<uint32_t, Instance*> InstanceMap;
+
+  // Returns the headless instance standing in for the recorded one, creating
+  // it if it hasn't been seen yet.
+  Instance* GetInstance(uint32_t number);
+
+  // Runs the message loop until |time| (MessageLoop::Now() clock).
+  void RunUntil(PP_TimeTicks time);
+  static void OnRunUntilDone(void* user_data, int32_t result);
+
+  void DestroyInstances();
+
+  PluginModule* module_;
+  Speed speed_;
+  InstanceMap instances_;
+
+  // Disallow copy and assign (these are unimplemented).
+  Replayer(const Replayer&);
+  Replayer& operator=(const Replayer&);
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_REPLAY_H_
@@ -0,0 +1,42 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_resource.h"
+
+#include "ppapi/cpp/logging.h"
+#include "ppapi/tests/headless/host_resource_tracker.h"
+
+namespace headless {
+
+Resource::Resource(PP_Module module)
+    : ref_count_(0),
+      module_(module),
+      resource_id_(0) {
+}
+
+Resource::~Resource() {
+  PP_DCHECK(ref_count_ == 0);
+  PP_DCHECK(resource_id_ == 0);
+}
+
+void Resource::AddRef() {
+  ref_count_++;
+}
+
+void Resource::Release() {
+  PP_DCHECK(ref_count_ > 0);
+  if (--ref_count_ == 0)
+    delete this;
+}
+
+PP_Resource Resource::GetReference() {
+  ResourceTracker* tracker = ResourceTracker::Get();
+  if (resource_id_)
+    tracker->AddRefResource(resource_id_);
+  else
+    resource_id_ = tracker->AddResource(this);
+  return resource_id_;
+}
+
+}  // namespace headless
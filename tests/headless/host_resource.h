@@ -0,0 +1,88 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_RESOURCE_H_
+#define PPAPI_TESTS_HEADLESS_HOST_RESOURCE_H_
+
+#include "ppapi/c/pp_module.h"
+#include "ppapi/c/pp_resource.h"
+
+namespace headless {
+
+class FileIO;
+class FileRef;
+class FileSystem;
+class Graphics2D;
+class ImageData;
+
+// Base class for every resource implemented by the headless host.
+//
+// A resource has two kinds of references. Host code holds "internal"
+// references with AddRef()/Release() (for example a Graphics2D keeping a
+// queued ImageData alive). The plugin holds references through its
+// PP_Resource, which the ResourceTracker maps back to this object; all
+// plugin references together own exactly one internal reference.
+class Resource {
+ public:
+  explicit Resource(PP_Module module);
+  virtual ~Resource();
+
+  void AddRef();
+  void Release();
+
+  PP_Module module() const { return module_; }
+
+  // Returns the PP_Resource identifying this object and adds one plugin
+  // reference to it. The resource is registered with the tracker the first
+  // time this is called.
+  PP_Resource GetReference();
+
+  // Returns the PP_Resource identifying this object without adding a
+  // reference, or 0 if the plugin was never given one.
+  PP_Resource pp_resource() const { return resource_id_; }
+
+  // Returns the resource as the given type, or NULL if it's a different one.
+  template <typename T> T* GetAs() { return NULL; }
+
+  // Type-specific downcasts used by GetAs<>().
+  virtual FileIO* AsFileIO() { return NULL; }
+  virtual FileRef* AsFileRef() { return NULL; }
+  virtual FileSystem* AsFileSystem() { return NULL; }
+  virtual Graphics2D* AsGraphics2D() { return NULL; }
+  virtual ImageData* AsImageData() { return NULL; }
+
+ private:
+  friend class ResourceTracker;
+
+  // Called by the tracker when the last plugin reference goes away.
+  void ClearResourceId() { resource_id_ = 0; }
+
+  int ref_count_;
+  PP_Module module_;
+  PP_Resource resource_id_;
+
+  // Disallow copy and assign (these are unimplemented).
+  Resource(const Resource&);
+  Resource& operator=(const Resource&);
+};
+
+template <> inline FileIO* Resource::GetAs<FileIO>() {
+  return AsFileIO();
+}
+template <> inline FileRef* Resource::GetAs<FileRef>() {
+  return AsFileRef();
+}
+template <> inline FileSystem* Resource::GetAs<FileSystem>() {
+  return AsFileSystem();
+}
+template <> inline Graphics2D* Resource::GetAs<Graphics2D>() {
+  return AsGraphics2D();
+}
+template <> inline ImageData* Resource::GetAs<ImageData>() {
+  return AsImageData();
+}
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_RESOURCE_H_
@@ -0,0 +1,72 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_resource_tracker.h"
+
+#include "ppapi/cpp/logging.h"
+
+namespace headless {
+
+ResourceTracker::ResourceTracker() : last_id_(0) {
+}
+
+ResourceTracker::~ResourceTracker() {
+}
+
+// static
+ResourceTracker* ResourceTracker::Get() {
+  // Leaked on purpose: plugins may release resources during shutdown.
+  static ResourceTracker* tracker = new ResourceTracker;
+  return tracker;
+}
+
+Resource* ResourceTracker::GetResource(PP_Resource res) const {
+  ResourceMap::const_iterator found = live_resources_.find(res);
+  if (found == live_resources_.end())
+    return NULL;
+  return found->second.first;
+}
+
+bool ResourceTracker::AddRefResource(PP_Resource res) {
+  ResourceMap::iterator found = live_resources_.find(res);
+  if (found == live_resources_.end())
+    return false;
+  found->second.second++;
+  return true;
+}
+
+bool ResourceTracker::UnrefResource(PP_Resource res) {
+  ResourceMap::iterator found = live_resources_.find(res);
+  if (found == live_resources_.end())
+    return false;
+  if (--found->second.second == 0) {
+    Resource* resource = found->second.first;
+    live_resources_.erase(found);
+    resource->ClearResourceId();
+    // May delete the resource if the host holds no other reference.
+    resource->Release();
+  }
+  return true;
+}
+
+uint32_t ResourceTracker::GetLiveObjectsForModule(PP_Module module) const {
+  uint32_t count = 0;
+  for (ResourceMap::const_iterator i = live_resources_.begin();
+       i != live_resources_.end(); ++i) {
+    if (i->second.first->module() == module)
+      count++;
+  }
+  return count;
+}
+
+PP_Resource ResourceTracker::AddResource(Resource* resource) {
+  PP_DCHECK(resource);
+  PP_Resource res = ++last_id_;
+  // The plugin references together own one internal reference.
+  resource->AddRef();
+  live_resources_[res] = ResourceAndRefCount(resource, 1);
+  return res;
+}
+
+}  // namespace headless
@@ -0,0 +1,68 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_RESOURCE_TRACKER_H_
+#define PPAPI_TESTS_HEADLESS_HOST_RESOURCE_TRACKER_H_
+
+#include <map>
+#include <utility>
+
+#include "ppapi/c/pp_module.h"
+#include "ppapi/c/pp_resource.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/tests/headless/host_resource.h"
+
+namespace headless {
+
+// Maps PP_Resource handles given to plugins to the Resource objects backing
+// them, and counts the plugin references on each. All functions must be
+// called on the main thread.
+class ResourceTracker {
+ public:
+  static ResourceTracker* Get();
+
+  // Returns the resource for the given handle without adding a reference,
+  // or NULL if the handle is not live.
+  Resource* GetResource(PP_Resource res) const;
+
+  // PPB_Core.AddRefResource/ReleaseResource. Return false for bad handles.
+  bool AddRefResource(PP_Resource res);
+  bool UnrefResource(PP_Resource res);
+
+  // Number of live resources owned by the given module, as reported by
+  // PPB_Testing_Dev.GetLiveObjectCount.
+  uint32_t GetLiveObjectsForModule(PP_Module module) const;
+
+ private:
+  friend class Resource;
+
+  ResourceTracker();
+  ~ResourceTracker();
+
+  // Registers a new resource and returns its handle with one plugin
+  // reference. Called by Resource::GetReference().
+  PP_Resource AddResource(Resource* resource);
+
+  typedef std::pair<Resource*, int> ResourceAndRefCount;
+  typedef std::map<PP_Resource, ResourceAndRefCount> ResourceMap;
+  ResourceMap live_resources_;
+
+  PP_Resource last_id_;
+
+  // Disallow copy and assign (these are unimplemented).
+  ResourceTracker(const ResourceTracker&);
+  ResourceTracker& operator=(const ResourceTracker&);
+};
+
+// Convenience function for the PPB implementations: looks up the handle and
+// returns it as the given type, or NULL if it's missing or a different type.
+template <typename T>
+T* GetResourceAs(PP_Resource res) {
+  Resource* resource = ResourceTracker::Get()->GetResource(res);
+  return resource ? resource->GetAs<T>() : NULL;
+}
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_RESOURCE_TRACKER_H_
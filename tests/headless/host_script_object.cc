@@ -0,0 +1,156 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_script_object.h"
+
+#include <stdio.h>
+
+#include "ppapi/c/dev/ppp_class_deprecated.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/tests/headless/host_var.h"
+
+namespace headless {
+
+namespace {
+
+ScriptObject* ToObject(void* object) {
+  return static_cast<ScriptObject*>(object);
+}
+
+// Converts a string or integer property name. Anything else was rejected by
+// the var layer before reaching the class.
+std::string NameToString(PP_Var name) {
+  if (name.type == PP_VARTYPE_INT32) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d", name.value.as_int);
+    return buf;
+  }
+  std::string result;
+  Var::PPVarToString(name, &result);
+  return result;
+}
+
+bool HasProperty(void* object, PP_Var name, PP_Var* exception) {
+  return ToObject(object)->HasProperty(NameToString(name));
+}
+
+bool HasMethod(void* object, PP_Var name, PP_Var* exception) {
+  return ToObject(object)->HasMethod(NameToString(name));
+}
+
+PP_Var GetProperty(void* object, PP_Var name, PP_Var* exception) {
+  return ToObject(object)->GetProperty(NameToString(name), exception);
+}
+
+void GetAllPropertyNames(void* object,
+                         uint32_t* property_count,
+                         PP_Var** properties,
+                         PP_Var* exception) {
+  // Enumeration isn't needed by anything the host emulates.
+  *property_count = 0;
+  *properties = NULL;
+}
+
+void SetProperty(void* object, PP_Var name, PP_Var value, PP_Var* exception) {
+  ToObject(object)->SetProperty(NameToString(name), value, exception);
+}
+
+void RemoveProperty(void* object, PP_Var name, PP_Var* exception) {
+}
+
+PP_Var Call(void* object,
+            PP_Var method_name,
+            uint32_t argc,
+            PP_Var* argv,
+            PP_Var* exception) {
+  return ToObject(object)->Call(NameToString(method_name), argc, argv,
+                                exception);
+}
+
+PP_Var Construct(void* object,
+                 uint32_t argc,
+                 PP_Var* argv,
+                 PP_Var* exception) {
+  return PP_MakeUndefined();
+}
+
+void Deallocate(void* object) {
+  ToObject(object)->Release();
+}
+
+const PPP_Class_Deprecated script_object_class = {
+  &HasProperty,
+  &HasMethod,
+  &GetProperty,
+  &GetAllPropertyNames,
+  &SetProperty,
+  &RemoveProperty,
+  &Call,
+  &Construct,
+  &Deallocate
+};
+
+}  // namespace
+
+ScriptObject::ScriptObject(PP_Module module)
+    : ref_count_(0),
+      module_(module) {
+}
+
+ScriptObject::~ScriptObject() {
+  PP_DCHECK(ref_count_ == 0);
+}
+
+void ScriptObject::AddRef() {
+  ref_count_++;
+}
+
+void ScriptObject::Release() {
+  PP_DCHECK(ref_count_ > 0);
+  if (--ref_count_ == 0)
+    delete this;
+}
+
+PP_Var ScriptObject::CreateVar() {
+  AddRef();  // Released by Deallocate().
+  return Var::CreateObject(module_, &script_object_class, this);
+}
+
+bool ScriptObject::HasProperty(const std::string& name) {
+  return false;
+}
+
+bool ScriptObject::HasMethod(const std::string& name) {
+  return false;
+}
+
+PP_Var ScriptObject::GetProperty(const std::string& name, PP_Var* exception) {
+  return PP_MakeUndefined();
+}
+
+void ScriptObject::SetProperty(const std::string& name,
+                               PP_Var value,
+                               PP_Var* exception) {
+  SetException(exception, "Error: Property " + name + " is read-only");
+}
+
+PP_Var ScriptObject::Call(const std::string& name,
+                          uint32_t argc,
+                          PP_Var* argv,
+                          PP_Var* exception) {
+  SetException(exception, "Error: " + name + " is not a function");
+  return PP_MakeUndefined();
+}
+
+PP_Var ScriptObject::StringVar(const std::string& str) const {
+  return Var::StringToPPVar(module_, str);
+}
+
+void ScriptObject::SetException(PP_Var* exception,
+                                const std::string& message) const {
+  if (exception)
+    *exception = StringVar(message);
+}
+
+}  // namespace headless
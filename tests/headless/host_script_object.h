@@ -0,0 +1,68 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_SCRIPT_OBJECT_H_
+#define PPAPI_TESTS_HEADLESS_HOST_SCRIPT_OBJECT_H_
+
+#include <string>
+
+#include "ppapi/c/pp_module.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/pp_var.h"
+
+namespace headless {
+
+// Base class for scriptable objects implemented by the host, which stand in
+// for the DOM objects a page would expose to the plugin. They are handed to
+// the plugin as regular object vars through a host-side
+// PPP_Class_Deprecated, so the plugin can't tell them apart from real ones.
+//
+// Objects are reference counted; each var created by CreateVar() holds one
+// reference until the plugin releases it.
+class ScriptObject {
+ public:
+  // Vars returned by this object (property values, exceptions) are charged
+  // to |module|.
+  explicit ScriptObject(PP_Module module);
+  virtual ~ScriptObject();
+
+  void AddRef();
+  void Release();
+
+  // Returns a new object var for this object with one reference.
+  PP_Var CreateVar();
+
+  PP_Module module() const { return module_; }
+
+  // Overridden by subclasses. Property and method names are always passed as
+  // strings (integer names are converted). The default implementations
+  // describe an object with no properties and no methods.
+  virtual bool HasProperty(const std::string& name);
+  virtual bool HasMethod(const std::string& name);
+  virtual PP_Var GetProperty(const std::string& name, PP_Var* exception);
+  virtual void SetProperty(const std::string& name,
+                           PP_Var value,
+                           PP_Var* exception);
+  virtual PP_Var Call(const std::string& name,
+                      uint32_t argc,
+                      PP_Var* argv,
+                      PP_Var* exception);
+
+ protected:
+  // Helpers for subclasses.
+  PP_Var StringVar(const std::string& str) const;
+  void SetException(PP_Var* exception, const std::string& message) const;
+
+ private:
+  int ref_count_;
+  PP_Module module_;
+
+  // Disallow copy and assign (these are unimplemented).
+  ScriptObject(const ScriptObject&);
+  ScriptObject& operator=(const ScriptObject&);
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_SCRIPT_OBJECT_H_
@@ -0,0 +1,229 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_test_runner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ppapi/c/pp_completion_callback.h"
+#include "ppapi/tests/headless/host_golden_images.h"
+#include "ppapi/tests/headless/host_instance.h"
+#include "ppapi/tests/headless/host_message_loop.h"
+#include "ppapi/tests/headless/host_module.h"
+
+namespace headless {
+
+namespace {
+
+const char kPageURL[] = "http://localhost/test_case.html?";
+
+// The lines around the names in the listing TestingInstance logs.
+const char kListingHeader[] = "Available test cases:";
+const char kListingFooter[] = "Run All Tests";
+
+std::string EscapeJSONString(const std::string& str) {
+  std::string escaped("\"");
+  for (size_t i = 0; i < str.size(); i++) {
+    unsigned char c = static_cast<unsigned char>(str[i]);
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (c == '\n') {
+      escaped.append("\\n");
+    } else if (c < 0x20) {
+      char buffer[8];
+      sprintf(buffer, "\\u%04x", c);
+      escaped.append(buffer);
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  escaped.push_back('"');
+  return escaped;
+}
+
+}  // namespace
+
+TestRunner::TestRunner(PluginModule* module)
+    : module_(module),
+      timeout_seconds_(60),
+      view_width_(300),
+      view_height_(150),
+      golden_image_checker_(NULL),
+      generation_(0),
+      done_(false),
+      timed_out_(false) {
+}
+
+TestRunner::~TestRunner() {
+}
+
+void TestRunner::AddArgument(const std::string& name,
+                             const std::string& value) {
+  arg_names_.push_back(name);
+  arg_values_.push_back(value);
+}
+
+void TestRunner::RunTestCase(const std::string& test_case,
+                             TestCaseResult* result) {
+  MessageLoop* loop = MessageLoop::current();
+  result->test_case = test_case;
+  generation_++;
+  done_ = false;
+  timed_out_ = false;
+  PP_TimeTicks start = MessageLoop::Now();
+
+  {
+    Instance instance(module_, kPageURL + test_case, this);
+    bool check_goldens = golden_image_checker_ && !test_case.empty();
+    if (check_goldens)
+      golden_image_checker_->StartTestCase(test_case, &instance);
+    std::vector<std::string> arg_names(arg_names_);
+    std::vector<std::string> arg_values(arg_values_);
+    arg_names.push_back("testcase");
+    arg_values.push_back(test_case);
+    if (instance.Initialize(arg_names, arg_values)) {
+      PP_Rect position;
+      position.point.x = 0;
+      position.point.y = 0;
+      position.size.width = view_width_;
+      position.size.height = view_height_;
+      instance.SetPosition(position, position);
+
+      loop->PostDelayedTask(
+          PP_MakeCompletionCallback(&TestRunner::OnTimeout, this),
+          generation_,
+          static_cast<int32_t>(timeout_seconds_ * 1000));
+      loop->Run();
+    }
+
+    Page* page = instance.page();
+    result->console_text = HTMLToText(page->GetElementHTML("console"));
+    result->benchmark_results = page->GetElementHTML("benchmark_results");
+    if (!page->GetCookie("COMPLETION_COOKIE", &result->completion_cookie))
+      result->completion_cookie = "Instance did not report completion";
+    if (check_goldens) {
+      golden_image_checker_->FinishTestCase(&result->golden_failures);
+      for (size_t i = 0; i < result->golden_failures.size(); i++)
+        result->console_text += result->golden_failures[i] + "\n";
+    }
+  }
+
+  result->timed_out = timed_out_;
+  result->passed = done_ && result->completion_cookie == "PASS" &&
+      result->golden_failures.empty();
+  result->elapsed_seconds = MessageLoop::Now() - start;
+}
+
+bool TestRunner::ListTestCases(std::vector<std::string>* test_cases) {
+  TestCaseResult result;
+  RunTestCase(std::string(), &result);
+  const std::string& text = result.console_text;
+  size_t start = text.find(kListingHeader);
+  if (start == std::string::npos)
+    return false;
+  start = text.find('\n', start);
+  while (start != std::string::npos && start + 1 < text.size()) {
+    size_t end = text.find('\n', start + 1);
+    std::string line = text.substr(start + 1, end - start - 1);
+    if (line == kListingFooter)
+      break;
+    if (!line.empty())
+      test_cases->push_back(line);
+    start = end;
+  }
+  return !test_cases->empty();
+}
+
+void TestRunner::DidExecuteTests() {
+  done_ = true;
+  MessageLoop::current()->Quit();
+}
+
+// static
+void TestRunner::OnTimeout(void* user_data, int32_t generation) {
+  TestRunner* runner = static_cast<TestRunner*>(user_data);
+  if (generation != runner->generation_ || runner->done_)
+    return;
+
+  runner->timed_out_ = true;
+  MessageLoop* loop = MessageLoop::current();
+  if (loop->run_depth() > 1) {
+    // The test is waiting in PPB_Testing_Dev.RunMessageLoop; quitting would
+    // just resume it with bogus state.
+    fprintf(stderr, "Test timed out inside a nested message loop.\n");
+    exit(EXIT_FAILURE);
+  }
+  loop->Quit();
+}
+
+std::string HTMLToText(const std::string& html) {
+  std::string text;
+  size_t i = 0;
+  while (i < html.size()) {
+    if (html[i] == '<') {
+      size_t end = html.find('>', i);
+      if (end == std::string::npos)
+        break;
+      std::string tag = html.substr(i + 1, end - i - 1);
+      if ((tag == "/div" || tag == "/dd" || tag == "dl" || tag == "br") &&
+          !text.empty() && text[text.size() - 1] != '\n')
+        text.push_back('\n');
+      i = end + 1;
+    } else if (html[i] == '&') {
+      static const struct {
+        const char* entity;
+        char c;
+      } kEntities[] = {
+        { "&lt;", '<' }, { "&gt;", '>' }, { "&amp;", '&' }, { "&quot;", '"' }
+      };
+      size_t j = 0;
+      for (; j < sizeof(kEntities) / sizeof(kEntities[0]); j++) {
+        std::string entity(kEntities[j].entity);
+        if (html.compare(i, entity.size(), entity) == 0) {
+          text.push_back(kEntities[j].c);
+          i += entity.size();
+          break;
+        }
+      }
+      if (j == sizeof(kEntities) / sizeof(kEntities[0]))
+        text.push_back(html[i++]);
+    } else {
+      text.push_back(html[i++]);
+    }
+  }
+  if (!text.empty() && text[text.size() - 1] != '\n')
+    text.push_back('\n');
+  return text;
+}
+
+std::string TestCaseResultsToJSON(const std::vector<TestCaseResult>& results) {
+  std::string json("[");
+  for (size_t i = 0; i < results.size(); i++) {
+    const TestCaseResult& result = results[i];
+    char numbers[128];
+    sprintf(numbers,
+            "\"elapsed_ms\": %d, \"passed\": %s, \"timed_out\": %s",
+            static_cast<int>(result.elapsed_seconds * 1000),
+            result.passed ? "true" : "false",
+            result.timed_out ? "true" : "false");
+    json.append(i ? ",\n" : "\n");
+    json.append("  {\"test_case\": " + EscapeJSONString(result.test_case) +
+                ", " + numbers +
+                ", \"completion_cookie\": " +
+                EscapeJSONString(result.completion_cookie) +
+                ", \"console\": " + EscapeJSONString(result.console_text) +
+                ", \"golden_failures\": [");
+    for (size_t j = 0; j < result.golden_failures.size(); j++) {
+      json.append(j ? ", " : "");
+      json.append(EscapeJSONString(result.golden_failures[j]));
+    }
+    json.append("]}");
+  }
+  json.append("\n]\n");
+  return json;
+}
+
+}  // namespace headless
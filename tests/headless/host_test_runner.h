@@ -0,0 +1,111 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_TEST_RUNNER_H_
+#define PPAPI_TESTS_HEADLESS_HOST_TEST_RUNNER_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/tests/headless/host_page.h"
+
+namespace headless {
+
+class GoldenImageChecker;
+class PluginModule;
+
+struct TestCaseResult {
+  TestCaseResult() : passed(false), timed_out(false), elapsed_seconds(0) {}
+
+  std::string test_case;
+  bool passed;
+  bool timed_out;
+
+  // The COMPLETION_COOKIE set by TestingInstance: "PASS" or the errors.
+  std::string completion_cookie;
+
+  // What the plugin logged to the "console" element, as plain text.
+  std::string console_text;
+
+  // The JSON a BenchmarkCase stores in the "benchmark_results" element, or
+  // empty for ordinary test cases.
+  std::string benchmark_results;
+
+  // Frames that didn't match their golden images, if a GoldenImageChecker
+  // is set.
+  std::vector<std::string> golden_failures;
+
+  double elapsed_seconds;
+};
+
+// Runs the test cases of a ppapi_tests style module the way test_case.html
+// does in a browser: one instance per test case with a "testcase"
+// attribute, driven until it calls window.DidExecuteTests().
+class TestRunner : public Page::Delegate {
+ public:
+  explicit TestRunner(PluginModule* module);
+  virtual ~TestRunner();
+
+  // Defaults to 60 seconds. A test that times out while blocked in a nested
+  // message loop can't be unwound; the process is terminated in that case.
+  void set_timeout_seconds(double seconds) { timeout_seconds_ = seconds; }
+
+  // Size of the plugin element. Defaults to 300x150 like an <object>.
+  void set_view_size(int32_t width, int32_t height) {
+    view_width_ = width;
+    view_height_ = height;
+  }
+
+  // Checks the frames of every test case against golden images; the
+  // checker isn't owned. A test case with failing frames fails.
+  void set_golden_image_checker(GoldenImageChecker* checker) {
+    golden_image_checker_ = checker;
+  }
+
+  // Adds an extra attribute to the embed element of every instance.
+  void AddArgument(const std::string& name, const std::string& value);
+
+  // Runs one test case in a fresh instance. An empty name makes the plugin
+  // list the test cases it has.
+  void RunTestCase(const std::string& test_case, TestCaseResult* result);
+
+  // Asks the plugin for the test cases it has. Returns false if it didn't
+  // list any.
+  bool ListTestCases(std::vector<std::string>* test_cases);
+
+  // Page::Delegate implementation.
+  virtual void DidExecuteTests();
+
+ private:
+  static void OnTimeout(void* user_data, int32_t generation);
+
+  PluginModule* module_;
+  double timeout_seconds_;
+  int32_t view_width_;
+  int32_t view_height_;
+  std::vector<std::string> arg_names_;
+  std::vector<std::string> arg_values_;
+  GoldenImageChecker* golden_image_checker_;
+
+  // Identifies the current run so stale timeouts are ignored.
+  int32_t generation_;
+  bool done_;
+  bool timed_out_;
+
+  // Disallow copy and assign (these are unimplemented).
+  TestRunner(const TestRunner&);
+  TestRunner& operator=(const TestRunner&);
+};
+
+// Converts the HTML logged by TestingInstance into plain text, one line per
+// block element.
+std::string HTMLToText(const std::string& html);
+
+// Converts |results| into a JSON array with one object per test case.
+std::string TestCaseResultsToJSON(const std::vector<TestCaseResult>& results);
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_TEST_RUNNER_H_
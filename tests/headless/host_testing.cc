@@ -0,0 +1,53 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_testing.h"
+
+#include "ppapi/c/dev/ppb_testing_dev.h"
+#include "ppapi/tests/headless/host_graphics_2d.h"
+#include "ppapi/tests/headless/host_message_loop.h"
+#include "ppapi/tests/headless/host_resource_tracker.h"
+#include "ppapi/tests/headless/host_var.h"
+
+namespace headless {
+
+namespace {
+
+bool ReadImageData(PP_Resource device_context_2d,
+                   PP_Resource image,
+                   const PP_Point* top_left) {
+  Graphics2D* context = GetResourceAs<Graphics2D>(device_context_2d);
+  if (!context)
+    return false;
+  return context->ReadImageData(image, top_left);
+}
+
+void RunMessageLoop() {
+  MessageLoop::current()->Run();
+}
+
+void QuitMessageLoop() {
+  MessageLoop::current()->Quit();
+}
+
+uint32_t GetLiveObjectCount(PP_Module module) {
+  return ResourceTracker::Get()->GetLiveObjectsForModule(module) +
+         Var::GetLiveObjectsForModule(module);
+}
+
+const PPB_Testing_Dev testing_interface = {
+  &ReadImageData,
+  &RunMessageLoop,
+  &QuitMessageLoop,
+  &GetLiveObjectCount
+};
+
+}  // namespace
+
+// static
+const PPB_Testing_Dev* Testing::GetInterface() {
+  return &testing_interface;
+}
+
+}  // namespace headless
@@ -0,0 +1,20 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_TESTING_H_
+#define PPAPI_TESTS_HEADLESS_HOST_TESTING_H_
+
+struct PPB_Testing_Dev;
+
+namespace headless {
+
+// Implements PPB_Testing_Dev. Unlike in the browser it is always available.
+class Testing {
+ public:
+  static const PPB_Testing_Dev* GetInterface();
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_TESTING_H_
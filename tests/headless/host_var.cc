@@ -0,0 +1,474 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/headless/host_var.h"
+
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+#include "ppapi/c/dev/ppb_var_deprecated.h"
+#include "ppapi/c/dev/ppp_class_deprecated.h"
+#include "ppapi/cpp/logging.h"
+#include "ppapi/tests/headless/host_memory_stats.h"
+
+namespace headless {
+
+namespace {
+
+const char kInvalidObjectException[] = "Error: Invalid object";
+const char kInvalidPropertyException[] = "Error: Invalid property";
+
+struct VarData {
+  PP_Module module;
+  int ref_count;
+  PP_VarType type;
+
+  // PP_VARTYPE_STRING.
+  std::string str;
+
+  // PP_VARTYPE_OBJECT.
+  const PPP_Class_Deprecated* object_class;
+  void* object_data;
+
+  // PP_VARTYPE_BINARY_ARRAY. Kept in doubles so the elements are aligned for
+  // any of the types.
+  PP_BinaryArrayType binary_array_type;
+  uint32_t binary_array_count;
+  std::vector<double> binary_array_storage;
+
+  MemoryStats::Entry memory_stats_entry;
+};
+
+typedef std::map<int64_t, VarData*> VarMap;
+VarMap g_live_vars;
+int64_t g_last_var_id = 0;
+
+VarData* GetVarData(PP_Var var) {
+  if (var.type != PP_VARTYPE_STRING && var.type != PP_VARTYPE_OBJECT &&
+      var.type != PP_VARTYPE_BINARY_ARRAY)
+    return NULL;
+  VarMap::iterator found = g_live_vars.find(var.value.as_id);
+  if (found == g_live_vars.end() || found->second->type != var.type)
+    return NULL;
+  return found->second;
+}
+
+PP_Var AddVarData(VarData* data) {
+  int64_t id = ++g_last_var_id;
+  g_live_vars[id] = data;
+  PP_Var result;
+  result.type = data->type;
+  result.value.as_id = id;
+  return result;
+}
+
+// Returns true if the |len| bytes at |data| form a valid UTF-8 sequence.
+// Embedded nulls are allowed, overlong forms and surrogates are not.
+bool IsStringUTF8(const char* data, uint32_t len) {
+  const unsigned char* s = reinterpret_cast<const unsigned char*>(data);
+  uint32_t i = 0;
+  while (i < len) {
+    unsigned char c = s[i++];
+    if (c < 0x80)
+      continue;
+    int extra;
+    uint32_t code_point;
+    uint32_t min_code_point;
+    if ((c & 0xE0) == 0xC0) {
+      extra = 1;
+      code_point = c & 0x1F;
+      min_code_point = 0x80;
+    } else if ((c & 0xF0) == 0xE0) {
+      extra = 2;
+      code_point = c & 0x0F;
+      min_code_point = 0x800;
+    } else if ((c & 0xF8) == 0xF0) {
+      extra = 3;
+      code_point = c & 0x07;
+      min_code_point = 0x10000;
+    } else {
+      return false;
+    }
+    if (len - i < static_cast<uint32_t>(extra))
+      return false;
+    for (int j = 0; j < extra; j++) {
+      unsigned char cc = s[i++];
+      if ((cc & 0xC0) != 0x80)
+        return false;
+      code_point = (code_point << 6) | (cc & 0x3F);
+    }
+    if (code_point < min_code_point || code_point > 0x10FFFF ||
+        (code_point >= 0xD800 && code_point <= 0xDFFF))
+      return false;
+  }
+  return true;
+}
+
+// Sets |*exception| to a string var unless the caller didn't ask for one.
+void SetException(PP_Module module, PP_Var* exception, const char* message) {
+  if (exception)
+    *exception = Var::StringToPPVar(module, message);
+}
+
+// Common prologue of all object operations: refuses to run if an exception
+// is already pending, and resolves |object| (and |name| when given).
+// Returns NULL and sets |*exception| on failure.
+VarData* GetObjectForCall(PP_Var object, const PP_Var* name,
+                          PP_Var* exception) {
+  if (exception && exception->type != PP_VARTYPE_UNDEFINED)
+    return NULL;
+  VarData* data = GetVarData(object);
+  if (!data || data->type != PP_VARTYPE_OBJECT) {
+    // There is no module to charge the exception to; use the name's.
+    VarData* name_data = name ? GetVarData(*name) : NULL;
+    SetException(name_data ? name_data->module : 0, exception,
+                 kInvalidObjectException);
+    return NULL;
+  }
+  if (name && name->type != PP_VARTYPE_STRING &&
+      name->type != PP_VARTYPE_INT32) {
+    SetException(data->module, exception, kInvalidPropertyException);
+    return NULL;
+  }
+  return data;
+}
+
+// PPB_Var_Deprecated ----------------------------------------------------------
+
+void AddRefVar(PP_Var var) {
+  Var::AddRef(var);
+}
+
+void ReleaseVar(PP_Var var) {
+  Var::Release(var);
+}
+
+PP_Var VarFromUtf8(PP_Module module, const char* data, uint32_t len) {
+  if (len == 0)
+    return Var::StringToPPVar(module, std::string());
+  if (!data || !IsStringUTF8(data, len))
+    return PP_MakeNull();
+  return Var::StringToPPVar(module, std::string(data, len));
+}
+
+const char* VarToUtf8(PP_Var var, uint32_t* len) {
+  VarData* data = GetVarData(var);
+  if (!data || data->type != PP_VARTYPE_STRING) {
+    *len = 0;
+    return NULL;
+  }
+  *len = static_cast<uint32_t>(data->str.size());
+  return data->str.c_str();
+}
+
+bool HasProperty(PP_Var object, PP_Var name, PP_Var* exception) {
+  VarData* data = GetObjectForCall(object, &name, exception);
+  if (!data || !data->object_class->HasProperty)
+    return false;
+  return data->object_class->HasProperty(data->object_data, name, exception);
+}
+
+bool HasMethod(PP_Var object, PP_Var name, PP_Var* exception) {
+  VarData* data = GetObjectForCall(object, &name, exception);
+  if (!data || !data->object_class->HasMethod)
+    return false;
+  return data->object_class->HasMethod(data->object_data, name, exception);
+}
+
+PP_Var GetProperty(PP_Var object, PP_Var name, PP_Var* exception) {
+  VarData* data = GetObjectForCall(object, &name, exception);
+  if (!data || !data->object_class->GetProperty)
+    return PP_MakeUndefined();
+  return data->object_class->GetProperty(data->object_data, name, exception);
+}
+
+void GetAllPropertyNames(PP_Var object,
+                         uint32_t* property_count,
+                         PP_Var** properties,
+                         PP_Var* exception) {
+  *property_count = 0;
+  *properties = NULL;
+  VarData* data = GetObjectForCall(object, NULL, exception);
+  if (!data || !data->object_class->GetAllPropertyNames)
+    return;
+  data->object_class->GetAllPropertyNames(data->object_data, property_count,
+                                          properties, exception);
+}
+
+void SetProperty(PP_Var object, PP_Var name, PP_Var value,
+                 PP_Var* exception) {
+  VarData* data = GetObjectForCall(object, &name, exception);
+  if (!data || !data->object_class->SetProperty)
+    return;
+  data->object_class->SetProperty(data->object_data, name, value, exception);
+}
+
+void RemoveProperty(PP_Var object, PP_Var name, PP_Var* exception) {
+  VarData* data = GetObjectForCall(object, &name, exception);
+  if (!data || !data->object_class->RemoveProperty)
+    return;
+  data->object_class->RemoveProperty(data->object_data, name, exception);
+}
+
+PP_Var Call(PP_Var object,
+            PP_Var method_name,
+            uint32_t argc,
+            PP_Var* argv,
+            PP_Var* exception) {
+  // An undefined method name means "call the object itself".
+  const PP_Var* name =
+      method_name.type == PP_VARTYPE_UNDEFINED ? NULL : &method_name;
+  VarData* data = GetObjectForCall(object, name, exception);
+  if (!data || !data->object_class->Call)
+    return PP_MakeUndefined();
+  return data->object_class->Call(data->object_data, method_name,
+                                  argc, argv, exception);
+}
+
+PP_Var Construct(PP_Var object,
+                 uint32_t argc,
+                 PP_Var* argv,
+                 PP_Var* exception) {
+  VarData* data = GetObjectForCall(object, NULL, exception);
+  if (!data || !data->object_class->Construct)
+    return PP_MakeUndefined();
+  return data->object_class->Construct(data->object_data, argc, argv,
+                                       exception);
+}
+
+bool IsInstanceOfDeprecated(PP_Var var,
+                            const PPP_Class_Deprecated* object_class,
+                            void** object_data) {
+  return Var::IsInstanceOf(var, object_class, object_data);
+}
+
+PP_Var CreateObjectDeprecated(PP_Module module,
+                              const PPP_Class_Deprecated* object_class,
+                              void* object_data) {
+  return Var::CreateObject(module, object_class, object_data);
+}
+
+PP_Var CreateBinaryArray(PP_Module module,
+                         PP_BinaryArrayType type,
+                         uint32_t count,
+                         const void* data) {
+  return Var::CreateBinaryArray(module, type, count, data);
+}
+
+void* BinaryArrayData(PP_Var var, PP_BinaryArrayType* type, uint32_t* count) {
+  return Var::GetBinaryArrayData(var, type, count);
+}
+
+// The object is in process, so there's nothing to batch; these just save
+// the plugin the calls.
+void GetProperties(PP_Var object,
+                   uint32_t count,
+                   const PP_Var names[],
+                   PP_Var values[],
+                   PP_Var* exception) {
+  // GetProperty returns Undefined once the exception is set.
+  for (uint32_t i = 0; i < count; i++)
+    values[i] = GetProperty(object, names[i], exception);
+}
+
+void SetProperties(PP_Var object,
+                   uint32_t count,
+                   const PP_Var names[],
+                   const PP_Var values[],
+                   PP_Var* exception) {
+  for (uint32_t i = 0; i < count; i++) {
+    if (exception && exception->type != PP_VARTYPE_UNDEFINED)
+      return;
+    SetProperty(object, names[i], values[i], exception);
+  }
+}
+
+void GetAllProperties(PP_Var object,
+                      uint32_t* property_count,
+                      PP_Var** names,
+                      PP_Var** values,
+                      PP_Var* exception) {
+  *values = NULL;
+  GetAllPropertyNames(object, property_count, names, exception);
+  if (*property_count == 0)
+    return;
+  *values = static_cast<PP_Var*>(
+      MemoryStats::MemAlloc(*property_count * sizeof(PP_Var)));
+  if (!*values) {
+    for (uint32_t i = 0; i < *property_count; i++)
+      Var::Release((*names)[i]);
+    MemoryStats::MemFree(*names);
+    *names = NULL;
+    *property_count = 0;
+    return;
+  }
+  GetProperties(object, *property_count, *names, *values, exception);
+}
+
+const PPB_Var_Deprecated var_deprecated_interface = {
+  &AddRefVar,
+  &ReleaseVar,
+  &VarFromUtf8,
+  &VarToUtf8,
+  &HasProperty,
+  &HasMethod,
+  &GetProperty,
+  &GetAllPropertyNames,
+  &SetProperty,
+  &RemoveProperty,
+  &Call,
+  &Construct,
+  &IsInstanceOfDeprecated,
+  &CreateObjectDeprecated,
+  &CreateBinaryArray,
+  &BinaryArrayData,
+  &GetProperties,
+  &SetProperties,
+  &GetAllProperties
+};
+
+}  // namespace
+
+// static
+const PPB_Var_Deprecated* Var::GetDeprecatedInterface() {
+  return &var_deprecated_interface;
+}
+
+// static
+PP_Var Var::StringToPPVar(PP_Module module, const std::string& str) {
+  VarData* data = new VarData;
+  data->module = module;
+  data->ref_count = 1;
+  data->type = PP_VARTYPE_STRING;
+  data->str = str;
+  data->object_class = NULL;
+  data->object_data = NULL;
+  data->binary_array_type = PP_BINARYARRAYTYPE_UINT8;
+  data->binary_array_count = 0;
+  data->memory_stats_entry.Record(module, PP_MEMORYSTATSCATEGORY_STRINGVAR,
+                                  str.size());
+  return AddVarData(data);
+}
+
+// static
+bool Var::PPVarToString(PP_Var var, std::string* str) {
+  VarData* data = GetVarData(var);
+  if (!data || data->type != PP_VARTYPE_STRING)
+    return false;
+  *str = data->str;
+  return true;
+}
+
+// static
+PP_Var Var::CreateObject(PP_Module module,
+                         const PPP_Class_Deprecated* object_class,
+                         void* object_data) {
+  PP_DCHECK(object_class);
+  VarData* data = new VarData;
+  data->module = module;
+  data->ref_count = 1;
+  data->type = PP_VARTYPE_OBJECT;
+  data->object_class = object_class;
+  data->object_data = object_data;
+  data->binary_array_type = PP_BINARYARRAYTYPE_UINT8;
+  data->binary_array_count = 0;
+  data->memory_stats_entry.Record(module, PP_MEMORYSTATSCATEGORY_OBJECTVAR, 0);
+  return AddVarData(data);
+}
+
+// static
+PP_Var Var::CreateBinaryArray(PP_Module module,
+                              PP_BinaryArrayType type,
+                              uint32_t count,
+                              const void* elements) {
+  uint32_t element_size = PP_BinaryArrayElementSize(type);
+  if (!element_size)
+    return PP_MakeNull();
+  uint64_t bytes = static_cast<uint64_t>(count) * element_size;
+  if (bytes > static_cast<uint64_t>(static_cast<size_t>(-1)) / 2)
+    return PP_MakeNull();
+  VarData* data = new VarData;
+  data->module = module;
+  data->ref_count = 1;
+  data->type = PP_VARTYPE_BINARY_ARRAY;
+  data->object_class = NULL;
+  data->object_data = NULL;
+  data->binary_array_type = type;
+  data->binary_array_count = count;
+  data->binary_array_storage.resize(
+      static_cast<size_t>((bytes + sizeof(double) - 1) / sizeof(double)));
+  if (elements && bytes)
+    memcpy(&data->binary_array_storage[0], elements,
+           static_cast<size_t>(bytes));
+  data->memory_stats_entry.Record(module,
+                                  PP_MEMORYSTATSCATEGORY_BINARYARRAYVAR,
+                                  bytes);
+  return AddVarData(data);
+}
+
+// static
+void* Var::GetBinaryArrayData(PP_Var var,
+                              PP_BinaryArrayType* type,
+                              uint32_t* count) {
+  VarData* data = GetVarData(var);
+  if (!data || data->type != PP_VARTYPE_BINARY_ARRAY) {
+    *count = 0;
+    return NULL;
+  }
+  *type = data->binary_array_type;
+  *count = data->binary_array_count;
+  // An empty array still gets a non-NULL pointer, like an empty string.
+  static double empty;
+  if (data->binary_array_storage.empty())
+    return &empty;
+  return &data->binary_array_storage[0];
+}
+
+// static
+bool Var::IsInstanceOf(PP_Var var,
+                       const PPP_Class_Deprecated* object_class,
+                       void** object_data) {
+  VarData* data = GetVarData(var);
+  if (!data || data->type != PP_VARTYPE_OBJECT ||
+      data->object_class != object_class)
+    return false;
+  if (object_data)
+    *object_data = data->object_data;
+  return true;
+}
+
+// static
+void Var::AddRef(PP_Var var) {
+  VarData* data = GetVarData(var);
+  if (data)
+    data->ref_count++;
+}
+
+// static
+void Var::Release(PP_Var var) {
+  VarData* data = GetVarData(var);
+  if (!data || --data->ref_count > 0)
+    return;
+
+  // Unregister before deallocating, since Deallocate may release other vars.
+  g_live_vars.erase(var.value.as_id);
+  if (data->type == PP_VARTYPE_OBJECT && data->object_class->Deallocate)
+    data->object_class->Deallocate(data->object_data);
+  delete data;
+}
+
+// static
+uint32_t Var::GetLiveObjectsForModule(PP_Module module) {
+  uint32_t count = 0;
+  for (VarMap::const_iterator i = g_live_vars.begin();
+       i != g_live_vars.end(); ++i) {
+    if (i->second->module == module)
+      count++;
+  }
+  return count;
+}
+
+}  // namespace headless
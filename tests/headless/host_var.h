@@ -0,0 +1,71 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_HEADLESS_HOST_VAR_H_
+#define PPAPI_TESTS_HEADLESS_HOST_VAR_H_
+
+#include <string>
+
+#include "ppapi/c/dev/ppb_var_deprecated.h"
+#include "ppapi/c/pp_module.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/pp_var.h"
+
+struct PPP_Class_Deprecated;
+
+namespace headless {
+
+// Implements PPB_Var_Deprecated and owns every string, object and binary
+// array var handed to plugins. Objects are always PPP_Class_Deprecated based: plugin objects
+// come in through CreateObject, and host objects (the emulated page, see
+// ScriptObject) use a class implemented by the host itself. All functions
+// must be called on the main thread.
+class Var {
+ public:
+  static const PPB_Var_Deprecated* GetDeprecatedInterface();
+
+  // Returns a new string var with one reference, or a null var if |str| is
+  // not valid UTF-8.
+  static PP_Var StringToPPVar(PP_Module module, const std::string& str);
+
+  // Copies the contents of a string var into |str|. Returns false if |var|
+  // is not a live string.
+  static bool PPVarToString(PP_Var var, std::string* str);
+
+  // Returns a new object var with one reference.
+  static PP_Var CreateObject(PP_Module module,
+                             const PPP_Class_Deprecated* object_class,
+                             void* object_data);
+
+  // Returns a new binary array var with one reference, holding a copy of
+  // |count| elements at |elements| (zeros if it's NULL), or a null var if
+  // |type| is unknown.
+  static PP_Var CreateBinaryArray(PP_Module module,
+                                  PP_BinaryArrayType type,
+                                  uint32_t count,
+                                  const void* elements);
+
+  // Returns the elements of a binary array var and fills |type| and |count|,
+  // or returns NULL with a |count| of 0 if |var| is not a live binary array.
+  static void* GetBinaryArrayData(PP_Var var,
+                                  PP_BinaryArrayType* type,
+                                  uint32_t* count);
+
+  // Returns true and fills |object_data| if |var| is a live object of the
+  // given class.
+  static bool IsInstanceOf(PP_Var var,
+                           const PPP_Class_Deprecated* object_class,
+                           void** object_data);
+
+  static void AddRef(PP_Var var);
+  static void Release(PP_Var var);
+
+  // Number of live string, object and binary array vars owned by the given
+  // module.
+  static uint32_t GetLiveObjectsForModule(PP_Module module);
+};
+
+}  // namespace headless
+
+#endif  // PPAPI_TESTS_HEADLESS_HOST_VAR_H_
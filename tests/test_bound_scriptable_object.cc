@@ -0,0 +1,190 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_bound_scriptable_object.h"
+
+#include <stdio.h>
+
+#include "ppapi/cpp/dev/bound_scriptable_object_deprecated.h"
+#include "ppapi/cpp/var.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(BoundScriptableObject);
+
+namespace {
+
+class Counter : public pp::deprecated::BoundScriptableObject<Counter> {
+ public:
+  Counter() : count_(0), reset_count_(0) {}
+
+  static void BindMethods(Methods* methods) {
+    methods->Add("add", &Counter::Add);
+    methods->Add("reset", &Counter::Reset);
+    methods->Add("scale", &Counter::Scale);
+    methods->Add("label", &Counter::Label);
+    methods->Add("pick", &Counter::Pick);
+    methods->Add("sum4", &Counter::Sum4);
+    methods->Add("count", &Counter::count);
+  }
+
+  int32_t count() { return count_; }
+  int reset_count() const { return reset_count_; }
+
+ private:
+  int32_t Add(int32_t amount) {
+    count_ += amount;
+    return count_;
+  }
+  void Reset() {
+    count_ = 0;
+    reset_count_++;
+  }
+  double Scale(double factor) { return count_ * factor; }
+  std::string Label(const std::string& prefix, bool with_count) {
+    if (!with_count)
+      return prefix;
+    char count[16];
+    sprintf(count, "%d", count_);
+    return prefix + count;
+  }
+  pp::Var Pick(bool first, const pp::Var& a, pp::Var b) {
+    return first ? a : b;
+  }
+  int32_t Sum4(int32_t a, int32_t b, int32_t c, int32_t d) {
+    return a + b + c + d;
+  }
+
+  int32_t count_;
+  int reset_count_;
+};
+
+}  // namespace
+
+bool TestBoundScriptableObject::Init() {
+  return true;
+}
+
+void TestBoundScriptableObject::RunTest() {
+  RUN_TEST(HasMethod);
+  RUN_TEST(Call);
+  RUN_TEST(BadArguments);
+  RUN_TEST(ManyNames);
+}
+
+std::string TestBoundScriptableObject::TestHasMethod() {
+  pp::Var object(new Counter);
+  pp::Var exception;
+  ASSERT_TRUE(object.HasMethod("add", &exception));
+  ASSERT_TRUE(object.HasMethod("reset", &exception));
+  ASSERT_TRUE(object.HasMethod("count", &exception));
+  ASSERT_FALSE(object.HasMethod("ad", &exception));
+  ASSERT_FALSE(object.HasMethod("addd", &exception));
+  ASSERT_FALSE(object.HasMethod("", &exception));
+  ASSERT_FALSE(object.HasMethod(pp::Var(1), &exception));
+  ASSERT_TRUE(exception.is_undefined());
+  PASS();
+}
+
+std::string TestBoundScriptableObject::TestCall() {
+  Counter* counter = new Counter;
+  pp::Var object(counter);
+  pp::Var exception;
+
+  pp::Var result = object.Call("add", pp::Var(5), &exception);
+  ASSERT_TRUE(exception.is_undefined());
+  ASSERT_TRUE(result.is_int() && result.AsInt() == 5);
+  // Integral doubles are ints to script.
+  result = object.Call("add", pp::Var(2.0), &exception);
+  ASSERT_TRUE(exception.is_undefined());
+  ASSERT_EQ(7, result.AsInt());
+  ASSERT_EQ(7, counter->count());
+
+  result = object.Call("scale", pp::Var(3), &exception);
+  ASSERT_TRUE(exception.is_undefined());
+  ASSERT_TRUE(result.is_double() && result.AsDouble() == 21.0);
+
+  result = object.Call("label", pp::Var("count "), pp::Var(true), &exception);
+  ASSERT_TRUE(exception.is_undefined());
+  ASSERT_TRUE(result.is_string() && result.AsString() == "count 7");
+  result = object.Call("label", pp::Var("none"), pp::Var(false), &exception);
+  ASSERT_TRUE(result.is_string() && result.AsString() == "none");
+
+  pp::Var a("first");
+  pp::Var b = pp::Var(pp::Var::Null());
+  result = object.Call("pick", pp::Var(true), a, b, &exception);
+  ASSERT_TRUE(exception.is_undefined());
+  ASSERT_TRUE(result == a);
+  result = object.Call("pick", pp::Var(false), a, b, &exception);
+  ASSERT_TRUE(result.is_null());
+
+  result = object.Call("sum4", pp::Var(1), pp::Var(2), pp::Var(3),
+                       pp::Var(4), &exception);
+  ASSERT_TRUE(exception.is_undefined());
+  ASSERT_EQ(10, result.AsInt());
+
+  result = object.Call("reset", &exception);
+  ASSERT_TRUE(exception.is_undefined());
+  ASSERT_TRUE(result.is_undefined());
+  ASSERT_EQ(0, counter->count());
+  ASSERT_EQ(1, counter->reset_count());
+  result = object.Call("count", &exception);
+  ASSERT_TRUE(result.is_int() && result.AsInt() == 0);
+  PASS();
+}
+
+std::string TestBoundScriptableObject::TestBadArguments() {
+  Counter* counter = new Counter;
+  pp::Var object(counter);
+
+  // None of these call the method.
+  pp::Var exception;
+  object.Call("add", &exception);
+  ASSERT_TRUE(exception.is_string());
+  exception = pp::Var();
+  object.Call("add", pp::Var(1), pp::Var(2), &exception);
+  ASSERT_TRUE(exception.is_string());
+  exception = pp::Var();
+  object.Call("add", pp::Var(1.5), &exception);
+  ASSERT_TRUE(exception.is_string());
+  exception = pp::Var();
+  object.Call("add", pp::Var(4294967296.0), &exception);
+  ASSERT_TRUE(exception.is_string());
+  exception = pp::Var();
+  object.Call("add", pp::Var("1"), &exception);
+  ASSERT_TRUE(exception.is_string());
+  exception = pp::Var();
+  object.Call("label", pp::Var("x"), pp::Var(1), &exception);
+  ASSERT_TRUE(exception.is_string());
+  exception = pp::Var();
+  object.Call("reset", pp::Var(0), &exception);
+  ASSERT_TRUE(exception.is_string());
+  ASSERT_EQ(0, counter->count());
+  ASSERT_EQ(0, counter->reset_count());
+
+  exception = pp::Var();
+  object.Call("missing", &exception);
+  ASSERT_TRUE(exception.is_string());
+  PASS();
+}
+
+std::string TestBoundScriptableObject::TestManyNames() {
+  // Enough names for the table to need several sizes and seeds.
+  pp::deprecated::internal::BoundMethodNames names;
+  char name[32];
+  for (int i = 0; i < 500; i++) {
+    sprintf(name, "method%d", i);
+    ASSERT_EQ(static_cast<size_t>(i), names.Add(name));
+  }
+  ASSERT_EQ(7u, names.Add("method7"));
+  ASSERT_EQ(500u, names.size());
+  for (int i = 0; i < 500; i++) {
+    sprintf(name, "method%d", i);
+    ASSERT_EQ(i, names.Find(pp::Var(name).pp_var()));
+    sprintf(name, "method%d", i + 500);
+    ASSERT_EQ(-1, names.Find(pp::Var(name).pp_var()));
+  }
+  ASSERT_EQ(-1, names.Find(pp::Var("method").pp_var()));
+  ASSERT_EQ(-1, names.Find(pp::Var(7).pp_var()));
+  PASS();
+}
@@ -0,0 +1,29 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_BOUND_SCRIPTABLE_OBJECT_H_
+#define PPAPI_TESTS_TEST_BOUND_SCRIPTABLE_OBJECT_H_
+
+#include <string>
+
+#include "ppapi/tests/test_case.h"
+
+// Calls the methods of a pp::deprecated::BoundScriptableObject through the
+// browser, with arguments of the right and wrong types.
+class TestBoundScriptableObject : public TestCase {
+ public:
+  TestBoundScriptableObject(TestingInstance* instance) : TestCase(instance) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+ private:
+  std::string TestHasMethod();
+  std::string TestCall();
+  std::string TestBadArguments();
+  std::string TestManyNames();
+};
+
+#endif  // PPAPI_TESTS_TEST_BOUND_SCRIPTABLE_OBJECT_H_
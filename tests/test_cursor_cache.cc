@@ -0,0 +1,217 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_cursor_cache.h"
+
+#include <vector>
+
+#include "ppapi/c/dev/ppb_testing_dev.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/dev/cursor_cache_dev.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(CursorCache);
+
+// Records the cursors sent instead of sending them.
+class TestCursorCache::Cache : public pp::CursorCache_Dev {
+ public:
+  struct Sent {
+    PP_CursorType_Dev type;
+    PP_Resource image;
+    pp::Point hot_spot;
+  };
+
+  explicit Cache(pp::Instance* instance) : pp::CursorCache_Dev(instance) {}
+
+  const std::vector<Sent>& sent() const { return sent_; }
+
+ protected:
+  virtual void SendCursor(PP_CursorType_Dev type,
+                          const pp::ImageData& image,
+                          const pp::Point& hot_spot) {
+    Sent sent;
+    sent.type = type;
+    sent.image = image.pp_resource();
+    sent.hot_spot = hot_spot;
+    sent_.push_back(sent);
+  }
+
+ private:
+  std::vector<Sent> sent_;
+};
+
+TestCursorCache::TestCursorCache(TestingInstance* instance)
+    : TestCase(instance),
+      testing_interface_(NULL) {
+}
+
+bool TestCursorCache::Init() {
+  testing_interface_ = reinterpret_cast<PPB_Testing_Dev const*>(
+      pp::Module::Get()->GetBrowserInterface(PPB_TESTING_DEV_INTERFACE));
+  if (!testing_interface_) {
+    // Give a more helpful error message for the testing interface being gone
+    // since that needs special enabling in Chrome.
+    instance_->AppendError("This test needs the testing interface, which is "
+        "not currently available. In Chrome, use --enable-pepper-testing when "
+        "launching.");
+  }
+  return !!testing_interface_;
+}
+
+void TestCursorCache::RunTest() {
+  RUN_TEST(SuppressRedundant);
+  RUN_TEST(CoalesceBatch);
+  RUN_TEST(Flush);
+  RUN_TEST(CustomImages);
+  RUN_TEST(ImageEviction);
+}
+
+// static
+void TestCursorCache::QuitMessageLoop(void* user_data, int32_t result) {
+  TestCursorCache* test = static_cast<TestCursorCache*>(user_data);
+  test->testing_interface_->QuitMessageLoop();
+}
+
+void TestCursorCache::EndBatch() {
+  pp::Module::Get()->core()->CallOnMainThread(
+      0, pp::CompletionCallback(&QuitMessageLoop, this));
+  testing_interface_->RunMessageLoop();
+}
+
+// static
+pp::ImageData TestCursorCache::MakeImage(uint32_t color) {
+  pp::ImageData image(PP_IMAGEDATAFORMAT_BGRA_PREMUL, pp::Size(16, 16), false);
+  for (int32_t y = 0; y < 16; y++) {
+    for (int32_t x = 0; x < 16; x++)
+      *image.GetAddr32(pp::Point(x, y)) = color;
+  }
+  return image;
+}
+
+std::string TestCursorCache::TestSuppressRedundant() {
+  Cache cache(instance_);
+  cache.SetCursor(PP_CURSORTYPE_HAND);
+  ASSERT_TRUE(cache.sent().empty());
+  EndBatch();
+  ASSERT_EQ(1u, cache.sent().size());
+  ASSERT_EQ(PP_CURSORTYPE_HAND, cache.sent()[0].type);
+
+  // The same cursor, a mouse move at a time.
+  for (int i = 0; i < 5; i++) {
+    cache.SetCursor(PP_CURSORTYPE_HAND);
+    EndBatch();
+  }
+  ASSERT_EQ(1u, cache.sent().size());
+  ASSERT_EQ(6, cache.request_count());
+  ASSERT_EQ(1, cache.issued_count());
+  ASSERT_EQ(5, cache.suppressed_count());
+
+  // Unless the browser may have changed it.
+  cache.InvalidateSentCursor();
+  cache.SetCursor(PP_CURSORTYPE_HAND);
+  EndBatch();
+  ASSERT_EQ(2u, cache.sent().size());
+  PASS();
+}
+
+std::string TestCursorCache::TestCoalesceBatch() {
+  Cache cache(instance_);
+  cache.SetCursor(PP_CURSORTYPE_POINTER);
+  EndBatch();
+  ASSERT_EQ(1u, cache.sent().size());
+
+  // Over a link and off it again within one batch: nothing to send.
+  cache.SetCursor(PP_CURSORTYPE_HAND);
+  cache.SetCursor(PP_CURSORTYPE_IBEAM);
+  cache.SetCursor(PP_CURSORTYPE_POINTER);
+  EndBatch();
+  ASSERT_EQ(1u, cache.sent().size());
+
+  // Only the last of a batch is sent.
+  cache.SetCursor(PP_CURSORTYPE_HAND);
+  cache.SetCursor(PP_CURSORTYPE_IBEAM);
+  EndBatch();
+  ASSERT_EQ(2u, cache.sent().size());
+  ASSERT_EQ(PP_CURSORTYPE_IBEAM, cache.sent()[1].type);
+  ASSERT_EQ(2, cache.issued_count());
+  ASSERT_EQ(4, cache.suppressed_count());
+  PASS();
+}
+
+std::string TestCursorCache::TestFlush() {
+  Cache cache(instance_);
+  cache.SetCursor(PP_CURSORTYPE_WAIT);
+  cache.Flush();
+  ASSERT_EQ(1u, cache.sent().size());
+
+  // The end of the batch has nothing left to do.
+  EndBatch();
+  ASSERT_EQ(1u, cache.sent().size());
+  PASS();
+}
+
+std::string TestCursorCache::TestCustomImages() {
+  Cache cache(instance_);
+  pp::ImageData red = MakeImage(0xFFFF0000);
+  ASSERT_FALSE(red.is_null());
+  cache.SetCustomCursor(red, pp::Point(1, 2));
+  EndBatch();
+  ASSERT_EQ(1u, cache.sent().size());
+  ASSERT_EQ(PP_CURSORTYPE_CUSTOM, cache.sent()[0].type);
+  ASSERT_TRUE(cache.sent()[0].hot_spot == pp::Point(1, 2));
+  // What's sent is a copy.
+  PP_Resource sent_red = cache.sent()[0].image;
+  ASSERT_NE(red.pp_resource(), sent_red);
+
+  // An image drawn again the same is the same cursor.
+  pp::ImageData red_again = MakeImage(0xFFFF0000);
+  cache.SetCustomCursor(red_again, pp::Point(1, 2));
+  EndBatch();
+  ASSERT_EQ(1u, cache.sent().size());
+  ASSERT_EQ(1u, cache.image_count());
+
+  // But not with another hot spot.
+  cache.SetCustomCursor(red_again, pp::Point(3, 3));
+  EndBatch();
+  ASSERT_EQ(2u, cache.sent().size());
+  ASSERT_EQ(sent_red, cache.sent()[1].image);
+
+  // Changing the pixels of an image that was set makes a new cursor.
+  *red.GetAddr32(pp::Point(0, 0)) = 0xFF0000FF;
+  cache.SetCustomCursor(red, pp::Point(3, 3));
+  EndBatch();
+  ASSERT_EQ(3u, cache.sent().size());
+  ASSERT_NE(sent_red, cache.sent()[2].image);
+  ASSERT_EQ(2u, cache.image_count());
+
+  // Back to the first, already cached.
+  cache.SetCustomCursor(MakeImage(0xFFFF0000), pp::Point(3, 3));
+  EndBatch();
+  ASSERT_EQ(4u, cache.sent().size());
+  ASSERT_EQ(sent_red, cache.sent()[3].image);
+  ASSERT_EQ(2u, cache.image_count());
+  PASS();
+}
+
+std::string TestCursorCache::TestImageEviction() {
+  Cache cache(instance_);
+  cache.set_max_images(2);
+  cache.SetCustomCursor(MakeImage(0xFF000001), pp::Point());
+  cache.SetCustomCursor(MakeImage(0xFF000002), pp::Point());
+  EndBatch();
+  ASSERT_EQ(1u, cache.sent().size());
+  PP_Resource second = cache.sent()[0].image;
+
+  // The third replaces the first, not the one shown.
+  cache.SetCustomCursor(MakeImage(0xFF000003), pp::Point());
+  ASSERT_EQ(2u, cache.image_count());
+  cache.SetCustomCursor(MakeImage(0xFF000002), pp::Point());
+  EndBatch();
+  ASSERT_EQ(1u, cache.sent().size());
+  ASSERT_EQ(second, cache.sent()[0].image);
+  PASS();
+}
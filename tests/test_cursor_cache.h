@@ -0,0 +1,49 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_CURSOR_CACHE_H_
+#define PPAPI_TESTS_TEST_CURSOR_CACHE_H_
+
+#include <string>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/tests/test_case.h"
+
+struct PPB_Testing_Dev;
+
+namespace pp {
+class ImageData;
+}
+
+// Sets cursors through pp::CursorCache_Dev and checks which reach the
+// browser.
+class TestCursorCache : public TestCase {
+ public:
+  explicit TestCursorCache(TestingInstance* instance);
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+ private:
+  class Cache;
+
+  static void QuitMessageLoop(void* user_data, int32_t result);
+
+  // Runs the main thread callbacks posted so far, ending the input batch.
+  void EndBatch();
+
+  // A cursor image of one |color|.
+  static pp::ImageData MakeImage(uint32_t color);
+
+  std::string TestSuppressRedundant();
+  std::string TestCoalesceBatch();
+  std::string TestFlush();
+  std::string TestCustomImages();
+  std::string TestImageEviction();
+
+  const PPB_Testing_Dev* testing_interface_;
+};
+
+#endif  // PPAPI_TESTS_TEST_CURSOR_CACHE_H_
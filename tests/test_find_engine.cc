@@ -0,0 +1,280 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_find_engine.h"
+
+#include <ctype.h>
+
+#include "ppapi/c/dev/ppb_testing_dev.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/dev/find_engine_dev.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(FindEngine);
+
+namespace {
+
+// Small enough that the text is many slices, and not a multiple of 16.
+const size_t kSliceSize = 4099;
+
+// How often and how long WaitForFind polls.
+const int32_t kCheckIntervalMs = 10;
+const int kMaxChecks = 500;
+
+}  // namespace
+
+// Records what it selects.
+class TestFindEngine::Engine : public pp::FindEngine_Dev {
+ public:
+  Engine(pp::Instance* instance, int worker_count)
+      : pp::FindEngine_Dev(instance, worker_count),
+        selected_offset_(0),
+        selected_count_(0) {
+    set_slice_size(kSliceSize);
+  }
+
+  size_t selected_offset() const { return selected_offset_; }
+  int selected_count() const { return selected_count_; }
+
+ protected:
+  virtual void FindResultSelected(size_t offset, size_t) {
+    selected_offset_ = offset;
+    selected_count_++;
+  }
+
+ private:
+  size_t selected_offset_;
+  int selected_count_;
+};
+
+TestFindEngine::TestFindEngine(TestingInstance* instance)
+    : TestCase(instance),
+      testing_interface_(NULL),
+      waiting_engine_(NULL),
+      checks_left_(0) {
+}
+
+bool TestFindEngine::Init() {
+  testing_interface_ = reinterpret_cast<PPB_Testing_Dev const*>(
+      pp::Module::Get()->GetBrowserInterface(PPB_TESTING_DEV_INTERFACE));
+  if (!testing_interface_) {
+    // Give a more helpful error message for the testing interface being gone
+    // since that needs special enabling in Chrome.
+    instance_->AppendError("This test needs the testing interface, which is "
+        "not currently available. In Chrome, use --enable-pepper-testing when "
+        "launching.");
+    return false;
+  }
+
+  // About a megabyte of words from a small alphabet, so that there are many
+  // partial matches.
+  const char kLetters[] = "abcABC xyz\n";
+  uint32_t seed = 12345;
+  text_.reserve(1 << 20);
+  while (text_.size() < (1 << 20)) {
+    seed = seed * 1103515245 + 12345;
+    text_ += kLetters[(seed >> 16) % (sizeof(kLetters) - 1)];
+  }
+  return true;
+}
+
+void TestFindEngine::RunTest() {
+  RUN_TEST(MainThread);
+  RUN_TEST(Workers);
+  RUN_TEST(CaseInsensitive);
+  RUN_TEST(SliceBoundaries);
+  RUN_TEST(Cancel);
+  RUN_TEST(SelectResult);
+}
+
+// static
+void TestFindEngine::CheckFindDone(void* user_data, int32_t result) {
+  TestFindEngine* test = static_cast<TestFindEngine*>(user_data);
+  if (!test->waiting_engine_->is_finding() || --test->checks_left_ <= 0) {
+    test->testing_interface_->QuitMessageLoop();
+    return;
+  }
+  pp::Module::Get()->core()->CallOnMainThread(
+      kCheckIntervalMs, pp::CompletionCallback(&CheckFindDone, test), 0);
+}
+
+// static
+void TestFindEngine::QuitMessageLoop(void* user_data, int32_t result) {
+  static_cast<TestFindEngine*>(user_data)->testing_interface_->
+      QuitMessageLoop();
+}
+
+// static
+std::vector<size_t> TestFindEngine::FindAll(const std::string& text,
+                                            const std::string& query,
+                                            bool case_sensitive) {
+  std::vector<size_t> matches;
+  size_t pos = 0;
+  while (pos + query.size() <= text.size()) {
+    size_t i = 0;
+    while (i < query.size() &&
+           (case_sensitive ? text[pos + i] == query[i] :
+            tolower(text[pos + i]) == tolower(query[i])))
+      i++;
+    if (i == query.size()) {
+      matches.push_back(pos);
+      pos += query.size();
+    } else {
+      pos++;
+    }
+  }
+  return matches;
+}
+
+bool TestFindEngine::WaitForFind(Engine* engine) {
+  waiting_engine_ = engine;
+  checks_left_ = kMaxChecks;
+  pp::Module::Get()->core()->CallOnMainThread(
+      0, pp::CompletionCallback(&CheckFindDone, this), 0);
+  testing_interface_->RunMessageLoop();
+  waiting_engine_ = NULL;
+  return !engine->is_finding();
+}
+
+void TestFindEngine::RunMessageLoopFor(int32_t ms) {
+  pp::Module::Get()->core()->CallOnMainThread(
+      ms, pp::CompletionCallback(&QuitMessageLoop, this), 0);
+  testing_interface_->RunMessageLoop();
+}
+
+std::string TestFindEngine::TestMainThread() {
+  Engine engine(instance_, 0);
+  engine.SetText(text_);
+  ASSERT_TRUE(engine.StartFind("abcA", true));
+  // Nothing is searched before returning to the message loop.
+  ASSERT_TRUE(engine.is_finding());
+  ASSERT_TRUE(engine.results().empty());
+
+  ASSERT_TRUE(WaitForFind(&engine));
+  std::vector<size_t> expected = FindAll(text_, "abcA", true);
+  ASSERT_FALSE(expected.empty());
+  ASSERT_TRUE(engine.results() == expected);
+  ASSERT_EQ(engine.result_length(), 4u);
+
+  // The first result was selected as it was found.
+  ASSERT_EQ(engine.selected_index(), 0);
+  ASSERT_EQ(engine.selected_count(), 1);
+  ASSERT_EQ(engine.selected_offset(), expected[0]);
+
+  // A single byte is found with memchr.
+  ASSERT_TRUE(engine.StartFind("\n", true));
+  ASSERT_TRUE(WaitForFind(&engine));
+  ASSERT_TRUE(engine.results() == FindAll(text_, "\n", true));
+  PASS();
+}
+
+std::string TestFindEngine::TestWorkers() {
+  Engine engine(instance_, 3);
+  engine.SetText(text_);
+  ASSERT_TRUE(engine.StartFind("c xy", true));
+  ASSERT_TRUE(WaitForFind(&engine));
+  std::vector<size_t> expected = FindAll(text_, "c xy", true);
+  ASSERT_FALSE(expected.empty());
+  ASSERT_TRUE(engine.results() == expected);
+  ASSERT_EQ(engine.selected_offset(), expected[0]);
+  PASS();
+}
+
+std::string TestFindEngine::TestCaseInsensitive() {
+  Engine engine(instance_, 2);
+  engine.SetText(text_);
+  const char* queries[] = { "AbC", "bA", "C\nX", "a", "zZz" };
+  for (size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); i++) {
+    ASSERT_TRUE(engine.StartFind(queries[i], false));
+    ASSERT_TRUE(WaitForFind(&engine));
+    std::vector<size_t> expected = FindAll(text_, queries[i], false);
+    ASSERT_FALSE(expected.empty());
+    ASSERT_TRUE(engine.results() == expected);
+  }
+  PASS();
+}
+
+std::string TestFindEngine::TestSliceBoundaries() {
+  // Every position matches, so where the slices end decides which matches
+  // overlap; the results must be as if it was one slice.
+  std::string text(10001, 'a');
+  Engine engine(instance_, 2);
+  engine.set_slice_size(7);
+  engine.SetText(text);
+  ASSERT_TRUE(engine.StartFind("aa", true));
+  ASSERT_TRUE(WaitForFind(&engine));
+  ASSERT_EQ(engine.results().size(), 5000u);
+  ASSERT_TRUE(engine.results() == FindAll(text, "aa", true));
+
+  // Queries longer than a slice.
+  ASSERT_TRUE(engine.StartFind("aaaaaaaaaaaaaaaaaaaaaaa", true));
+  ASSERT_TRUE(WaitForFind(&engine));
+  ASSERT_TRUE(engine.results() ==
+              FindAll(text, "aaaaaaaaaaaaaaaaaaaaaaa", true));
+
+  // A query longer than the text.
+  engine.SetText("aaa");
+  ASSERT_TRUE(engine.StartFind("aaaa", true));
+  ASSERT_TRUE(WaitForFind(&engine));
+  ASSERT_TRUE(engine.results().empty());
+  PASS();
+}
+
+std::string TestFindEngine::TestCancel() {
+  Engine engine(instance_, 2);
+  std::string text;
+  for (int i = 0; i < 4; i++)
+    text += text_;
+  engine.SetText(text);
+
+  ASSERT_TRUE(engine.StartFind("a", false));
+  engine.StopFind();
+  ASSERT_FALSE(engine.is_finding());
+  ASSERT_TRUE(engine.results().empty());
+  // Slices searched before the stop don't come back.
+  RunMessageLoopFor(50);
+  ASSERT_TRUE(engine.results().empty());
+  ASSERT_EQ(engine.selected_count(), 0);
+
+  // A new query replaces the one in progress.
+  ASSERT_TRUE(engine.StartFind("x", true));
+  ASSERT_TRUE(engine.StartFind("Cab", true));
+  ASSERT_TRUE(WaitForFind(&engine));
+  ASSERT_TRUE(engine.results() == FindAll(text, "Cab", true));
+
+  // So does new text.
+  ASSERT_TRUE(engine.StartFind("b", true));
+  engine.SetText("no results");
+  ASSERT_FALSE(engine.is_finding());
+  RunMessageLoopFor(50);
+  ASSERT_TRUE(engine.results().empty());
+  PASS();
+}
+
+std::string TestFindEngine::TestSelectResult() {
+  Engine engine(instance_, 0);
+  engine.SetText("one two one three one");
+  ASSERT_TRUE(engine.StartFind("one", true));
+  ASSERT_TRUE(WaitForFind(&engine));
+  ASSERT_EQ(engine.results().size(), 3u);
+  ASSERT_EQ(engine.selected_index(), 0);
+
+  engine.SelectFindResult(true);
+  ASSERT_EQ(engine.selected_index(), 1);
+  ASSERT_EQ(engine.selected_offset(), 8u);
+  engine.SelectFindResult(true);
+  engine.SelectFindResult(true);
+  ASSERT_EQ(engine.selected_index(), 0);
+  engine.SelectFindResult(false);
+  ASSERT_EQ(engine.selected_index(), 2);
+  ASSERT_EQ(engine.selected_offset(), 18u);
+
+  engine.StopFind();
+  ASSERT_EQ(engine.selected_index(), -1);
+  engine.SelectFindResult(true);
+  ASSERT_EQ(engine.selected_index(), -1);
+  PASS();
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_FIND_ENGINE_H_
+#define PPAPI_TESTS_TEST_FIND_ENGINE_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/tests/test_case.h"
+
+struct PPB_Testing_Dev;
+
+// Finds in generated text with pp::FindEngine_Dev, on the main thread and on
+// worker threads, and checks the results against a straightforward search.
+class TestFindEngine : public TestCase {
+ public:
+  explicit TestFindEngine(TestingInstance* instance);
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+ private:
+  class Engine;
+
+  static void CheckFindDone(void* user_data, int32_t result);
+  static void QuitMessageLoop(void* user_data, int32_t result);
+
+  // The non-overlapping matches of |query| in |text|, first to last.
+  static std::vector<size_t> FindAll(const std::string& text,
+                                     const std::string& query,
+                                     bool case_sensitive);
+
+  // Runs the message loop until |engine| is done finding, or gives up after
+  // five seconds. Returns true if it's done.
+  bool WaitForFind(Engine* engine);
+
+  // Runs the message loop for |ms| milliseconds.
+  void RunMessageLoopFor(int32_t ms);
+
+  std::string TestMainThread();
+  std::string TestWorkers();
+  std::string TestCaseInsensitive();
+  std::string TestSliceBoundaries();
+  std::string TestCancel();
+  std::string TestSelectResult();
+
+  const PPB_Testing_Dev* testing_interface_;
+  std::string text_;
+
+  // WaitForFind state.
+  Engine* waiting_engine_;
+  int checks_left_;
+};
+
+#endif  // PPAPI_TESTS_TEST_FIND_ENGINE_H_
@@ -0,0 +1,286 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_layer_compositor.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "ppapi/c/dev/ppb_testing_dev.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/graphics_2d.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/size.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(LayerCompositor);
+
+namespace {
+
+const int32_t kViewWidth = 64;
+const int32_t kViewHeight = 48;
+const uint32_t kBackgroundColor = 0xFF203040;
+
+// How often and how long WaitForPaint polls the device.
+const int32_t kCheckIntervalMs = 10;
+const int kMaxChecks = 100;
+
+// |value| / 255, rounded half up.
+uint32_t DivideBy255(uint32_t value) {
+  return (value * 2 + 255) / 510;
+}
+
+// Premultiplied source over, with |src| scaled by |opacity| first.
+uint32_t SourceOver(uint32_t dst, uint32_t src, uint32_t opacity) {
+  uint32_t scaled = 0;
+  for (int shift = 0; shift < 32; shift += 8)
+    scaled |= DivideBy255(((src >> shift) & 0xFF) * opacity) << shift;
+  uint32_t inverse_alpha = 255 - (scaled >> 24);
+  uint32_t result = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    uint32_t channel = ((scaled >> shift) & 0xFF) +
+        DivideBy255(((dst >> shift) & 0xFF) * inverse_alpha);
+    result |= std::min(channel, 255u) << shift;
+  }
+  return result;
+}
+
+int64_t Area(const pp::Rect& rect) {
+  return static_cast<int64_t>(rect.width()) * rect.height();
+}
+
+}  // namespace
+
+TestLayerCompositor::TestLayerCompositor(TestingInstance* instance)
+    : TestCase(instance),
+      testing_interface_(NULL),
+      compositor_(instance, kBackgroundColor),
+      content_(NULL),
+      overlay_(NULL),
+      cursor_(NULL),
+      checks_left_(0),
+      view_correct_(false) {
+}
+
+bool TestLayerCompositor::Init() {
+  testing_interface_ = reinterpret_cast<PPB_Testing_Dev const*>(
+      pp::Module::Get()->GetBrowserInterface(PPB_TESTING_DEV_INTERFACE));
+  if (!testing_interface_) {
+    // Give a more helpful error message for the testing interface being gone
+    // since that needs special enabling in Chrome.
+    instance_->AppendError("This test needs the testing interface, which is "
+        "not currently available. In Chrome, use --enable-pepper-testing when "
+        "launching.");
+    return false;
+  }
+  return true;
+}
+
+void TestLayerCompositor::RunTest() {
+  // The steps build on each other and must run in order.
+  RUN_TEST(Background);
+  RUN_TEST(Blend);
+  RUN_TEST(LayerDamage);
+  RUN_TEST(Move);
+  RUN_TEST(OccludedDamage);
+  RUN_TEST(OpacityAndVisibility);
+  RUN_TEST(RemoveLayer);
+}
+
+// static
+void TestLayerCompositor::CheckPaintDone(void* user_data, int32_t result) {
+  TestLayerCompositor* test = static_cast<TestLayerCompositor*>(user_data);
+  test->view_correct_ = test->IsViewCorrect();
+  if (test->view_correct_ || --test->checks_left_ <= 0) {
+    test->testing_interface_->QuitMessageLoop();
+    return;
+  }
+  pp::Module::Get()->core()->CallOnMainThread(
+      kCheckIntervalMs, pp::CompletionCallback(&CheckPaintDone, test), 0);
+}
+
+// static
+void TestLayerCompositor::FillLayer(pp::LayerCompositor::Layer* layer,
+                                    const pp::Rect& rect,
+                                    uint32_t seed,
+                                    uint32_t alpha) {
+  for (int32_t y = rect.y(); y < rect.bottom(); y++) {
+    for (int32_t x = rect.x(); x < rect.right(); x++) {
+      uint32_t red = DivideBy255(((x * 37 + seed) & 0xFF) * alpha);
+      uint32_t green = DivideBy255(((y * 53 + seed) & 0xFF) * alpha);
+      uint32_t blue = DivideBy255(((x * y + seed) & 0xFF) * alpha);
+      *layer->image().GetAddr32(pp::Point(x, y)) =
+          (alpha << 24) | (red << 16) | (green << 8) | blue;
+    }
+  }
+  layer->Invalidate(rect);
+}
+
+uint32_t TestLayerCompositor::ExpectedColor(int32_t x, int32_t y) const {
+  uint32_t color = kBackgroundColor;
+  const std::vector<pp::LayerCompositor::Layer*>& layers =
+      compositor_.layers();
+  for (size_t i = 0; i < layers.size(); i++) {
+    const pp::LayerCompositor::Layer* layer = layers[i];
+    if (!layer->visible() || !layer->bounds().Contains(x, y))
+      continue;
+    uint32_t src = *layer->image().GetAddr32(
+        pp::Point(x - layer->position().x(), y - layer->position().y()));
+    color = SourceOver(color, src, layer->opacity());
+  }
+  return color;
+}
+
+bool TestLayerCompositor::IsViewCorrect() const {
+  const pp::Graphics2D& graphics = compositor_.paint_manager().graphics();
+  pp::ImageData readback(pp::ImageData::GetNativeImageDataFormat(),
+                         graphics.size(), false);
+  if (readback.is_null())
+    return false;
+  pp::Point origin(0, 0);
+  if (!testing_interface_->ReadImageData(graphics.pp_resource(),
+                                         readback.pp_resource(),
+                                         &origin.pp_point()))
+    return false;
+  for (int32_t y = 0; y < readback.size().height(); y++) {
+    for (int32_t x = 0; x < readback.size().width(); x++) {
+      if (*readback.GetAddr32(pp::Point(x, y)) != ExpectedColor(x, y))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool TestLayerCompositor::WaitForPaint() {
+  checks_left_ = kMaxChecks;
+  view_correct_ = false;
+  pp::Module::Get()->core()->CallOnMainThread(
+      0, pp::CompletionCallback(&CheckPaintDone, this), 0);
+  testing_interface_->RunMessageLoop();
+  return view_correct_;
+}
+
+std::string TestLayerCompositor::TestBackground() {
+  compositor_.SetSize(pp::Size(kViewWidth, kViewHeight));
+  ASSERT_FALSE(compositor_.paint_manager().graphics().is_null());
+  ASSERT_TRUE(WaitForPaint());
+  // Nothing but the background.
+  ASSERT_TRUE(compositor_.composited_pixels() == 0);
+  PASS();
+}
+
+std::string TestLayerCompositor::TestBlend() {
+  content_ = compositor_.AddLayer(pp::Size(40, 30), true);
+  ASSERT_TRUE(content_ != NULL);
+  content_->SetPosition(pp::Point(4, 6));
+  FillLayer(content_, pp::Rect(content_->size()), 11, 0xFF);
+
+  // An odd width so that rows end in pixels the SIMD kernel doesn't cover.
+  overlay_ = compositor_.AddLayer(pp::Size(19, 13), false);
+  ASSERT_TRUE(overlay_ != NULL);
+  overlay_->SetPosition(pp::Point(30, 20));
+  overlay_->SetOpacity(200);
+  FillLayer(overlay_, pp::Rect(0, 0, 19, 6), 90, 0x80);
+  FillLayer(overlay_, pp::Rect(0, 6, 19, 7), 7, 0x33);
+  // A transparent hole.
+  FillLayer(overlay_, pp::Rect(3, 2, 9, 4), 0, 0);
+
+  cursor_ = compositor_.AddLayer(pp::Size(6, 6), true);
+  ASSERT_TRUE(cursor_ != NULL);
+  cursor_->SetPosition(pp::Point(10, 10));
+  FillLayer(cursor_, pp::Rect(cursor_->size()), 200, 0xFF);
+
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestLayerCompositor::TestLayerDamage() {
+  // Only the changed part is composited again, through the two layers that
+  // cover it.
+  uint64_t before = compositor_.composited_pixels();
+  pp::Rect changed(26, 14, 10, 8);
+  FillLayer(content_, changed, 140, 0xFF);
+  ASSERT_TRUE(WaitForPaint());
+  pp::Rect device_changed = changed;
+  device_changed.Offset(content_->position());
+  int64_t most = Area(device_changed) +
+      Area(device_changed.Intersect(overlay_->bounds()));
+  ASSERT_TRUE(compositor_.composited_pixels() - before > 0);
+  ASSERT_TRUE(static_cast<int64_t>(compositor_.composited_pixels() - before) <=
+              most);
+  PASS();
+}
+
+std::string TestLayerCompositor::TestMove() {
+  uint64_t before = compositor_.composited_pixels();
+  pp::Rect old_bounds = overlay_->bounds();
+  overlay_->SetPosition(pp::Point(36, 28));
+  ASSERT_TRUE(WaitForPaint());
+  // The old and new bounds, through the content layer and the overlay.
+  pp::Rect damage = old_bounds.Union(overlay_->bounds());
+  ASSERT_TRUE(static_cast<int64_t>(compositor_.composited_pixels() - before) <=
+              Area(damage) * 2);
+  PASS();
+}
+
+std::string TestLayerCompositor::TestOccludedDamage() {
+  // Damage to the content under the opaque cursor is dropped, so only the
+  // visible change is composited: the content layer alone covers it.
+  uint64_t before = compositor_.composited_pixels();
+  pp::Rect hidden(7, 5, 4, 4);
+  FillLayer(content_, hidden, 60, 0xFF);
+  pp::Rect shown(1, 20, 5, 3);
+  FillLayer(content_, shown, 61, 0xFF);
+
+  // The device still shows the old pixels under the cursor; the expected
+  // colors only come from the top layer there, so it matches either way.
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_TRUE(compositor_.composited_pixels() - before ==
+              static_cast<uint64_t>(Area(shown)));
+
+  // Moving the cursor away shows the new content.
+  cursor_->SetPosition(pp::Point(50, 4));
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestLayerCompositor::TestOpacityAndVisibility() {
+  overlay_->SetOpacity(255);
+  ASSERT_TRUE(WaitForPaint());
+  overlay_->SetOpacity(17);
+  ASSERT_TRUE(WaitForPaint());
+  overlay_->SetVisible(false);
+  ASSERT_TRUE(WaitForPaint());
+
+  // Damage to a hidden layer isn't painted...
+  uint64_t before = compositor_.composited_pixels();
+  FillLayer(overlay_, pp::Rect(overlay_->size()), 33, 0xC0);
+  FillLayer(content_, pp::Rect(0, 0, 2, 2), 99, 0xFF);
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_TRUE(compositor_.composited_pixels() - before == 4);
+
+  // ...but shows once it's visible again.
+  overlay_->SetVisible(true);
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestLayerCompositor::TestRemoveLayer() {
+  compositor_.RemoveLayer(content_);
+  content_ = NULL;
+  ASSERT_TRUE(compositor_.layers().size() == 2);
+  ASSERT_TRUE(WaitForPaint());
+
+  compositor_.RemoveLayer(overlay_);
+  overlay_ = NULL;
+  compositor_.RemoveLayer(cursor_);
+  cursor_ = NULL;
+  ASSERT_TRUE(compositor_.layers().empty());
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_LAYER_COMPOSITOR_H_
+#define PPAPI_TESTS_TEST_LAYER_COMPOSITOR_H_
+
+#include <string>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/layer_compositor.h"
+#include "ppapi/tests/test_case.h"
+
+struct PPB_Testing_Dev;
+
+namespace pp {
+class Rect;
+}
+
+// Composites a few layers through pp::LayerCompositor and checks the device
+// against a straightforward per-pixel compositing of the same layers after
+// every change.
+class TestLayerCompositor : public TestCase {
+ public:
+  explicit TestLayerCompositor(TestingInstance* instance);
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+ private:
+  static void CheckPaintDone(void* user_data, int32_t result);
+
+  // Fills |rect| of |layer|, in layer coordinates, with a pattern of |seed|
+  // with an alpha of |alpha|, and invalidates it.
+  static void FillLayer(pp::LayerCompositor::Layer* layer,
+                        const pp::Rect& rect,
+                        uint32_t seed,
+                        uint32_t alpha);
+
+  // The expected color of the device at |x|, |y|.
+  uint32_t ExpectedColor(int32_t x, int32_t y) const;
+
+  // Returns true if the device shows the layers.
+  bool IsViewCorrect() const;
+
+  // Runs the message loop until the device shows the layers, or gives up
+  // after a second. Returns true if it does.
+  bool WaitForPaint();
+
+  std::string TestBackground();
+  std::string TestBlend();
+  std::string TestLayerDamage();
+  std::string TestMove();
+  std::string TestOccludedDamage();
+  std::string TestOpacityAndVisibility();
+  std::string TestRemoveLayer();
+
+  const PPB_Testing_Dev* testing_interface_;
+  pp::LayerCompositor compositor_;
+
+  // Bottom to top.
+  pp::LayerCompositor::Layer* content_;
+  pp::LayerCompositor::Layer* overlay_;
+  pp::LayerCompositor::Layer* cursor_;
+
+  // WaitForPaint state.
+  int checks_left_;
+  bool view_correct_;
+};
+
+#endif  // PPAPI_TESTS_TEST_LAYER_COMPOSITOR_H_
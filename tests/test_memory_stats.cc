@@ -0,0 +1,156 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_memory_stats.h"
+
+#include <string.h>
+
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/size.h"
+#include "ppapi/cpp/var.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(MemoryStats);
+
+bool TestMemoryStats::Init() {
+  memory_stats_interface_ = reinterpret_cast<PPB_MemoryStats_Dev const*>(
+      pp::Module::Get()->GetBrowserInterface(PPB_MEMORY_STATS_DEV_INTERFACE));
+  return !!memory_stats_interface_;
+}
+
+void TestMemoryStats::RunTest() {
+  RUN_TEST(Disabled);
+  RUN_TEST(ImageData);
+  RUN_TEST(StringVar);
+  RUN_TEST(MemAlloc);
+  RUN_TEST(ResetPeaks);
+  RUN_TEST(Reenable);
+  memory_stats_interface_->SetEnabled(false);
+}
+
+PP_MemoryStats_Dev TestMemoryStats::GetStats(
+    PP_MemoryStatsCategory_Dev category) {
+  PP_MemoryStats_Dev stats;
+  if (!memory_stats_interface_->GetStats(pp::Module::Get()->pp_module(),
+                                         category, &stats))
+    memset(&stats, 0, sizeof(stats));
+  return stats;
+}
+
+std::string TestMemoryStats::TestDisabled() {
+  memory_stats_interface_->SetEnabled(false);
+  ASSERT_FALSE(memory_stats_interface_->IsEnabled());
+
+  PP_MemoryStats_Dev stats;
+  ASSERT_FALSE(memory_stats_interface_->GetStats(
+      pp::Module::Get()->pp_module(), PP_MEMORYSTATSCATEGORY_IMAGEDATA,
+      &stats));
+
+  memory_stats_interface_->SetEnabled(true);
+  ASSERT_TRUE(memory_stats_interface_->IsEnabled());
+  ASSERT_FALSE(memory_stats_interface_->GetStats(
+      pp::Module::Get()->pp_module(), PP_MEMORYSTATSCATEGORY_COUNT, &stats));
+  PASS();
+}
+
+std::string TestMemoryStats::TestImageData() {
+  memory_stats_interface_->SetEnabled(true);
+  PP_MemoryStats_Dev before = GetStats(PP_MEMORYSTATSCATEGORY_IMAGEDATA);
+  {
+    pp::ImageData image(PP_IMAGEDATAFORMAT_BGRA_PREMUL, pp::Size(16, 8), true);
+    ASSERT_FALSE(image.is_null());
+
+    PP_MemoryStats_Dev during = GetStats(PP_MEMORYSTATSCATEGORY_IMAGEDATA);
+    ASSERT_EQ(before.live_count + 1, during.live_count);
+    ASSERT_EQ(before.live_bytes + 16 * 8 * 4, during.live_bytes);
+    ASSERT_EQ(before.total_count + 1, during.total_count);
+    ASSERT_TRUE(during.peak_count >= during.live_count);
+    ASSERT_TRUE(during.peak_bytes >= during.live_bytes);
+  }
+  PP_MemoryStats_Dev after = GetStats(PP_MEMORYSTATSCATEGORY_IMAGEDATA);
+  ASSERT_EQ(before.live_count, after.live_count);
+  ASSERT_EQ(before.live_bytes, after.live_bytes);
+  ASSERT_EQ(before.total_count + 1, after.total_count);
+  ASSERT_TRUE(after.peak_bytes >= before.live_bytes + 16 * 8 * 4);
+  PASS();
+}
+
+std::string TestMemoryStats::TestStringVar() {
+  memory_stats_interface_->SetEnabled(true);
+  PP_MemoryStats_Dev before = GetStats(PP_MEMORYSTATSCATEGORY_STRINGVAR);
+  {
+    pp::Var str("0123456789");
+    PP_MemoryStats_Dev during = GetStats(PP_MEMORYSTATSCATEGORY_STRINGVAR);
+    ASSERT_EQ(before.live_count + 1, during.live_count);
+    ASSERT_EQ(before.live_bytes + 10, during.live_bytes);
+
+    // Copies share the string.
+    pp::Var copy(str);
+    during = GetStats(PP_MEMORYSTATSCATEGORY_STRINGVAR);
+    ASSERT_EQ(before.live_count + 1, during.live_count);
+  }
+  PP_MemoryStats_Dev after = GetStats(PP_MEMORYSTATSCATEGORY_STRINGVAR);
+  ASSERT_EQ(before.live_count, after.live_count);
+  ASSERT_EQ(before.live_bytes, after.live_bytes);
+  PASS();
+}
+
+std::string TestMemoryStats::TestMemAlloc() {
+  pp::Core* core = pp::Module::Get()->core();
+
+  // Blocks allocated while accounting is off are never counted, even when
+  // they are freed after it was turned on.
+  memory_stats_interface_->SetEnabled(false);
+  void* uncounted = core->MemAlloc(1000);
+  ASSERT_TRUE(uncounted);
+  memory_stats_interface_->SetEnabled(true);
+
+  PP_MemoryStats_Dev before = GetStats(PP_MEMORYSTATSCATEGORY_MEMALLOC);
+  void* counted = core->MemAlloc(100);
+  ASSERT_TRUE(counted);
+  memset(counted, 0, 100);
+  PP_MemoryStats_Dev during = GetStats(PP_MEMORYSTATSCATEGORY_MEMALLOC);
+  ASSERT_EQ(before.live_count + 1, during.live_count);
+  ASSERT_EQ(before.live_bytes + 100, during.live_bytes);
+
+  core->MemFree(uncounted);
+  core->MemFree(counted);
+  PP_MemoryStats_Dev after = GetStats(PP_MEMORYSTATSCATEGORY_MEMALLOC);
+  ASSERT_EQ(before.live_count, after.live_count);
+  ASSERT_EQ(before.live_bytes, after.live_bytes);
+  PASS();
+}
+
+std::string TestMemoryStats::TestResetPeaks() {
+  memory_stats_interface_->SetEnabled(true);
+  pp::Core* core = pp::Module::Get()->core();
+  core->MemFree(core->MemAlloc(1 << 16));
+
+  PP_MemoryStats_Dev stats = GetStats(PP_MEMORYSTATSCATEGORY_MEMALLOC);
+  ASSERT_TRUE(stats.peak_bytes >= stats.live_bytes + (1 << 16));
+
+  memory_stats_interface_->ResetPeaks(pp::Module::Get()->pp_module());
+  stats = GetStats(PP_MEMORYSTATSCATEGORY_MEMALLOC);
+  ASSERT_EQ(stats.live_count, stats.peak_count);
+  ASSERT_EQ(stats.live_bytes, stats.peak_bytes);
+  PASS();
+}
+
+std::string TestMemoryStats::TestReenable() {
+  // Objects from before accounting was turned off again don't skew the new
+  // counts when they go away.
+  memory_stats_interface_->SetEnabled(true);
+  pp::Var* str = new pp::Var("counted in the first generation");
+  memory_stats_interface_->SetEnabled(false);
+  memory_stats_interface_->SetEnabled(true);
+
+  PP_MemoryStats_Dev before = GetStats(PP_MEMORYSTATSCATEGORY_STRINGVAR);
+  ASSERT_EQ(0U, before.live_count);
+  delete str;
+  PP_MemoryStats_Dev after = GetStats(PP_MEMORYSTATSCATEGORY_STRINGVAR);
+  ASSERT_EQ(0U, after.live_count);
+  ASSERT_EQ(0U, after.live_bytes);
+  PASS();
+}
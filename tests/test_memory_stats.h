@@ -0,0 +1,35 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_MEMORY_STATS_H_
+#define PPAPI_TESTS_TEST_MEMORY_STATS_H_
+
+#include <string>
+
+#include "ppapi/c/dev/ppb_memory_stats_dev.h"
+#include "ppapi/tests/test_case.h"
+
+class TestMemoryStats : public TestCase {
+ public:
+  TestMemoryStats(TestingInstance* instance) : TestCase(instance) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+ private:
+  std::string TestDisabled();
+  std::string TestImageData();
+  std::string TestStringVar();
+  std::string TestMemAlloc();
+  std::string TestResetPeaks();
+  std::string TestReenable();
+
+  // Returns the current stats of the category, all zero if unavailable.
+  PP_MemoryStats_Dev GetStats(PP_MemoryStatsCategory_Dev category);
+
+  const PPB_MemoryStats_Dev* memory_stats_interface_;
+};
+
+#endif  // PPAPI_TESTS_TEST_MEMORY_STATS_H_
@@ -0,0 +1,285 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_object_serialize.h"
+
+#include <string.h>
+
+#include "ppapi/c/dev/ppb_testing_dev.h"
+#include "ppapi/c/dev/ppb_var_deprecated.h"
+#include "ppapi/c/pp_var.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/var.h"
+#include "ppapi/proxy/browser_globals.h"
+#include "ppapi/proxy/object_serialize.h"
+#include "ppapi/proxy/var_transfer_region.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(ObjectSerialize);
+
+namespace {
+
+// Serialize() takes the maximum acceptable length.
+const uint32_t kMaxLength = 1 << 20;
+
+// The region_offset of a binary array whose elements are in the message.
+const uint32_t kInlineElements = 0xffffffff;
+
+// Elements of a binary array that goes through the transfer region, and
+// takes up a quarter of the half of it that one side writes.
+const uint32_t kRegionArrayCount =
+    ppapi_proxy::VarTransferRegion::kDefaultSize / 8 / sizeof(double);
+
+int g_channel_tag;
+int g_peer_channel_tag;
+
+}  // namespace
+
+TestObjectSerialize::TestObjectSerialize(TestingInstance* instance)
+    : TestCase(instance),
+      channel_(reinterpret_cast<NaClSrpcChannel*>(&g_channel_tag)),
+      peer_channel_(reinterpret_cast<NaClSrpcChannel*>(&g_peer_channel_tag)),
+      region_(NULL),
+      peer_region_(NULL),
+      testing_interface_(NULL) {
+}
+
+TestObjectSerialize::~TestObjectSerialize() {
+  ppapi_proxy::UnsetModuleIdForSrpcChannel(channel_);
+  if (region_) {
+    ppapi_proxy::UnsetVarTransferRegionForSrpcChannel(channel_);
+    ppapi_proxy::UnsetVarTransferRegionForSrpcChannel(peer_channel_);
+    ppapi_proxy::UnsetModuleIdForSrpcChannel(peer_channel_);
+    delete region_;
+    delete peer_region_;
+  }
+}
+
+bool TestObjectSerialize::Init() {
+  pp::Module* module = pp::Module::Get();
+  ppapi_proxy::SetBrowserGetInterface(module->get_browser_interface());
+  ppapi_proxy::SetModuleIdForSrpcChannel(channel_, module->pp_module());
+  const uint32_t kRegionSize = ppapi_proxy::VarTransferRegion::kDefaultSize;
+  region_memory_.resize(kRegionSize / sizeof(double));
+  region_ = new ppapi_proxy::VarTransferRegion(
+      &region_memory_[0], kRegionSize,
+      ppapi_proxy::VarTransferRegion::kBrowserSide);
+  peer_region_ = new ppapi_proxy::VarTransferRegion(
+      &region_memory_[0], kRegionSize,
+      ppapi_proxy::VarTransferRegion::kPluginSide);
+  ppapi_proxy::SetVarTransferRegionForSrpcChannel(channel_, region_);
+  ppapi_proxy::SetVarTransferRegionForSrpcChannel(peer_channel_, peer_region_);
+  ppapi_proxy::SetModuleIdForSrpcChannel(peer_channel_, module->pp_module());
+  testing_interface_ = reinterpret_cast<const PPB_Testing_Dev*>(
+      module->GetBrowserInterface(PPB_TESTING_DEV_INTERFACE));
+  return testing_interface_ != NULL;
+}
+
+void TestObjectSerialize::RunTest() {
+  RUN_TEST(BinaryArrayRoundTrip);
+  RUN_TEST(BinaryArrayCountWraps);
+  RUN_TEST(BinaryArrayPastEnd);
+  RUN_TEST(DiscardFreesRegion);
+  RUN_TEST(FailureReleasesVars);
+  RUN_TEST(LargeVectorInRegion);
+}
+
+std::vector<char> TestObjectSerialize::SerializedBinaryArray(
+    uint32_t type,
+    uint32_t count,
+    uint32_t region_offset,
+    uint32_t inline_bytes) {
+  // The var type, the array type, the count and the region offset.
+  uint32_t header[4] = {
+    PP_VARTYPE_BINARY_ARRAY, type, count, region_offset
+  };
+  std::vector<char> bytes(sizeof(header) + inline_bytes, 0);
+  memcpy(&bytes[0], header, sizeof(header));
+  return bytes;
+}
+
+bool TestObjectSerialize::Deserializes(std::vector<char>* bytes) {
+  PP_Var var;
+  if (!ppapi_proxy::DeserializeTo(channel_, &(*bytes)[0],
+                                  static_cast<uint32_t>(bytes->size()),
+                                  1, &var)) {
+    return false;
+  }
+  pp::Var(pp::Var::PassRef(), var);
+  return true;
+}
+
+std::string TestObjectSerialize::TestBinaryArrayRoundTrip() {
+  const uint32_t kCount = 5;
+  double elements[kCount] = { 0.5, 1.5, 2.5, 3.5, 4.5 };
+  pp::Var array(PP_BINARYARRAYTYPE_FLOAT64, kCount, elements);
+  PP_Var pp_var = array.pp_var();
+  uint32_t length = kMaxLength;
+  char* bytes = ppapi_proxy::Serialize(channel_, &pp_var, 1, &length);
+  ASSERT_TRUE(bytes != NULL);
+  PP_Var result;
+  bool deserialized =
+      ppapi_proxy::DeserializeTo(channel_, bytes, length, 1, &result);
+  delete[] bytes;
+  ASSERT_TRUE(deserialized);
+  pp::Var copy(pp::Var::PassRef(), result);
+  ASSERT_TRUE(copy.is_binary_array());
+  uint32_t count;
+  double* copied = copy.AsFloat64Array(&count);
+  ASSERT_TRUE(copied != NULL);
+  ASSERT_EQ(count, kCount);
+  ASSERT_EQ(memcmp(copied, elements, sizeof(elements)), 0);
+  PASS();
+}
+
+std::string TestObjectSerialize::TestBinaryArrayCountWraps() {
+  // 0x20000001 doubles is 8 bytes once the byte count wraps, which the 8
+  // bytes after the header would hold.
+  std::vector<char> bytes = SerializedBinaryArray(
+      PP_BINARYARRAYTYPE_FLOAT64, 0x20000001, kInlineElements, 8);
+  ASSERT_FALSE(Deserializes(&bytes));
+  bytes = SerializedBinaryArray(
+      PP_BINARYARRAYTYPE_INT32, 0x40000002, kInlineElements, 8);
+  ASSERT_FALSE(Deserializes(&bytes));
+  // A byte count just short of 4 GB, which rounding up would wrap.
+  bytes = SerializedBinaryArray(
+      PP_BINARYARRAYTYPE_UINT8, 0xfffffffd, kInlineElements, 8);
+  ASSERT_FALSE(Deserializes(&bytes));
+  // Elements in the region are checked against the chunk instead.
+  bytes = SerializedBinaryArray(
+      PP_BINARYARRAYTYPE_FLOAT64, 0x20000001,
+      ppapi_proxy::VarTransferRegion::kDefaultSize / 2, 0);
+  ASSERT_FALSE(Deserializes(&bytes));
+  PASS();
+}
+
+std::string TestObjectSerialize::TestBinaryArrayPastEnd() {
+  // Exactly the 16 bytes that are there is fine...
+  std::vector<char> bytes = SerializedBinaryArray(
+      PP_BINARYARRAYTYPE_INT32, 4, kInlineElements, 16);
+  ASSERT_TRUE(Deserializes(&bytes));
+  // ...but one more element isn't, nor is a header with nothing after it.
+  bytes = SerializedBinaryArray(
+      PP_BINARYARRAYTYPE_INT32, 5, kInlineElements, 16);
+  ASSERT_FALSE(Deserializes(&bytes));
+  bytes = SerializedBinaryArray(
+      PP_BINARYARRAYTYPE_UINT8, 1, kInlineElements, 0);
+  ASSERT_FALSE(Deserializes(&bytes));
+  PASS();
+}
+
+std::string TestObjectSerialize::TestDiscardFreesRegion() {
+  pp::Var array(PP_BINARYARRAYTYPE_FLOAT64, kRegionArrayCount, NULL);
+  ASSERT_TRUE(array.is_binary_array());
+  // Nothing reads these, and with the chunk headers only three fit, so
+  // without DiscardSerialized the region would be full after three.
+  PP_Var pp_var = array.pp_var();
+  for (int i = 0; i < 16; i++) {
+    uint32_t length = kMaxLength;
+    char* bytes = ppapi_proxy::Serialize(channel_, &pp_var, 1, &length);
+    ASSERT_TRUE(bytes != NULL);
+    ppapi_proxy::DiscardSerialized(channel_, bytes, length, 1);
+    delete[] bytes;
+  }
+  // Four don't fit, and the three that were written are handed back when
+  // the fourth fails.
+  PP_Var vars[4] = { pp_var, pp_var, pp_var, pp_var };
+  uint32_t length = kMaxLength;
+  ASSERT_TRUE(ppapi_proxy::Serialize(channel_, vars, 4, &length) == NULL);
+  length = kMaxLength;
+  char* bytes = ppapi_proxy::Serialize(channel_, vars, 3, &length);
+  ASSERT_TRUE(bytes != NULL);
+  ppapi_proxy::DiscardSerialized(channel_, bytes, length, 3);
+  delete[] bytes;
+  PASS();
+}
+
+std::string TestObjectSerialize::TestFailureReleasesVars() {
+  PP_Module module = pp::Module::Get()->pp_module();
+  uint32_t before = testing_interface_->GetLiveObjectCount(module);
+  {
+    pp::Var first("first");
+    pp::Var second(PP_BINARYARRAYTYPE_UINT8, 64, NULL);
+    pp::Var third(PP_BINARYARRAYTYPE_FLOAT64, kRegionArrayCount, NULL);
+    PP_Var vars[4] = {
+      first.pp_var(), second.pp_var(), third.pp_var(), PP_MakeInt32(4)
+    };
+    uint32_t length = kMaxLength;
+    char* bytes = ppapi_proxy::Serialize(channel_, vars, 4, &length);
+    ASSERT_TRUE(bytes != NULL);
+    // Spoil the type of the last var, so that only the ones before it can
+    // be deserialized.
+    uint32_t bad_type = 99;
+    memcpy(bytes + length - 8, &bad_type, sizeof(bad_type));
+    PP_Var results[4];
+    bool deserialized =
+        ppapi_proxy::DeserializeTo(peer_channel_, bytes, length, 4, results);
+    ppapi_proxy::DiscardSerialized(channel_, bytes, length, 4);
+    delete[] bytes;
+    ASSERT_FALSE(deserialized);
+    for (int i = 0; i < 4; i++)
+      ASSERT_EQ(results[i].type, PP_VARTYPE_UNDEFINED);
+  }
+  ASSERT_EQ(testing_interface_->GetLiveObjectCount(module), before);
+  PASS();
+}
+
+std::string TestObjectSerialize::TestLargeVectorInRegion() {
+  // Strings too large together for a 64 KB reply, and a binary array that
+  // would go in the region by itself.
+  const uint32_t kReplyLength = 64 * 1024;
+  const uint32_t kCount = 100;
+  std::vector<pp::Var> owned;
+  std::vector<PP_Var> vars;
+  for (uint32_t i = 0; i < kCount; i++) {
+    owned.push_back(pp::Var(std::string(1000, static_cast<char>('a' + i % 26))));
+    vars.push_back(owned.back().pp_var());
+  }
+  std::vector<float> elements(8 * 1024, 0.5f);
+  owned.push_back(pp::Var(PP_BINARYARRAYTYPE_FLOAT32,
+                          static_cast<uint32_t>(elements.size()),
+                          &elements[0]));
+  vars.push_back(owned.back().pp_var());
+  uint32_t argc = static_cast<uint32_t>(vars.size());
+
+  // Without DiscardSerialized, these would fill the region.
+  std::vector<char> reply(kReplyLength);
+  for (int i = 0; i < 64; i++) {
+    uint32_t length = kReplyLength;
+    ASSERT_TRUE(ppapi_proxy::SerializeVectorTo(channel_, &vars[0], argc,
+                                               &reply[0], &length));
+    ASSERT_TRUE(length < 64);
+    ppapi_proxy::DiscardSerialized(channel_, &reply[0], length, argc);
+  }
+
+  uint32_t length = kReplyLength;
+  ASSERT_TRUE(ppapi_proxy::SerializeVectorTo(channel_, &vars[0], argc,
+                                             &reply[0], &length));
+  ASSERT_TRUE(ppapi_proxy::MaxSerializedVars(&reply[0], length) >= argc);
+  std::vector<PP_Var> results(argc);
+  ASSERT_TRUE(ppapi_proxy::DeserializeTo(peer_channel_, &reply[0], length,
+                                         argc, &results[0]));
+  std::vector<pp::Var> copies;
+  for (uint32_t i = 0; i < argc; i++)
+    copies.push_back(pp::Var(pp::Var::PassRef(), results[i]));
+  for (uint32_t i = 0; i < kCount; i++)
+    ASSERT_TRUE(copies[i].AsString() == owned[i].AsString());
+  uint32_t count;
+  float* copied = copies[kCount].AsFloat32Array(&count);
+  ASSERT_TRUE(copied != NULL);
+  ASSERT_EQ(count, elements.size());
+  ASSERT_EQ(memcmp(copied, &elements[0], count * sizeof(float)), 0);
+  // The chunk is consumed once it's read, so it can't be read twice.
+  std::vector<PP_Var> again(argc);
+  ASSERT_FALSE(ppapi_proxy::DeserializeTo(peer_channel_, &reply[0], length,
+                                          argc, &again[0]));
+
+  // A vector too large for the region can't be sent at all.
+  pp::Var huge(PP_BINARYARRAYTYPE_FLOAT64, 3 * kRegionArrayCount, NULL);
+  PP_Var huge_vars[2] = { huge.pp_var(), huge.pp_var() };
+  length = kReplyLength;
+  ASSERT_FALSE(ppapi_proxy::SerializeVectorTo(channel_, huge_vars, 2,
+                                              &reply[0], &length));
+  PASS();
+}
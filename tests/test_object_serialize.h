@@ -0,0 +1,63 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_OBJECT_SERIALIZE_H_
+#define PPAPI_TESTS_TEST_OBJECT_SERIALIZE_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/tests/test_case.h"
+
+struct NaClSrpcChannel;
+struct PPB_Testing_Dev;
+
+namespace ppapi_proxy {
+class VarTransferRegion;
+}
+
+// Checks the PP_Var wire format of the NaCl proxy, and that it rejects
+// malformed messages. Like BenchmarkObjectSerialize, this drives the browser side of
+// the proxy directly from inside the module.
+class TestObjectSerialize : public TestCase {
+ public:
+  TestObjectSerialize(TestingInstance* instance);
+  virtual ~TestObjectSerialize();
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+ private:
+  // Returns a serialized binary array of |count| elements of |type|, at
+  // |region_offset| or, if that's 0xffffffff, followed by |inline_bytes|
+  // bytes of elements.
+  std::vector<char> SerializedBinaryArray(uint32_t type,
+                                          uint32_t count,
+                                          uint32_t region_offset,
+                                          uint32_t inline_bytes);
+  // Returns whether DeserializeTo accepts |bytes| as one var, releasing the
+  // var if it does.
+  bool Deserializes(std::vector<char>* bytes);
+
+  std::string TestBinaryArrayRoundTrip();
+  std::string TestBinaryArrayCountWraps();
+  std::string TestBinaryArrayPastEnd();
+  std::string TestDiscardFreesRegion();
+  std::string TestFailureReleasesVars();
+  std::string TestLargeVectorInRegion();
+
+  // Stands in for the channel of a real module.
+  NaClSrpcChannel* channel_;
+  // The other end, for vars that pass through the shared transfer region.
+  // Both regions are views of |region_memory_|.
+  NaClSrpcChannel* peer_channel_;
+  std::vector<double> region_memory_;
+  ppapi_proxy::VarTransferRegion* region_;
+  ppapi_proxy::VarTransferRegion* peer_region_;
+  const PPB_Testing_Dev* testing_interface_;
+};
+
+#endif  // PPAPI_TESTS_TEST_OBJECT_SERIALIZE_H_
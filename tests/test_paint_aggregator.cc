@@ -34,6 +34,7 @@ void TestPaintAggregator::RunTest() {
   RUN_TEST(ContainedPaintEliminatedByScroll);
   RUN_TEST(ContainedPaintAfterScrollTrimmedByScrollDamage);
   RUN_TEST(ContainedPaintAfterScrollEliminatedByScrollDamage);
+  RUN_TEST(ManyInvalidations);
 }
 
 std::string TestPaintAggregator::TestInitialState() {
@@ -424,3 +425,48 @@ TestPaintAggregator::TestContainedPaintAfterScrollEliminatedByScrollDamage() {
   ASSERT_TRUE(expected_scroll_damage == greg.GetPendingUpdate().paint_rects[0]);
   return std::string();
 }
+
+std::string TestPaintAggregator::TestManyInvalidations() {
+  // Enough disjoint paints for the aggregator to index them.
+  pp::PaintAggregator greg;
+  greg.set_max_paint_rects(1000);
+  const int kColumns = 20;
+  const int kRows = 10;
+  for (int row = 0; row < kRows; row++) {
+    for (int column = 0; column < kColumns; column++)
+      greg.InvalidateRect(pp::Rect(column * 20, row * 20, 10, 10));
+  }
+  ASSERT_EQ(greg.GetPendingUpdate().paint_rects.size(),
+            static_cast<size_t>(kRows * kColumns));
+
+  // Contained in an existing paint: nothing changes.
+  greg.InvalidateRect(pp::Rect(42, 42, 5, 5));
+  ASSERT_EQ(greg.GetPendingUpdate().paint_rects.size(),
+            static_cast<size_t>(kRows * kColumns));
+
+  // Sharing edges with the second and third paints of the third row merges
+  // all three.
+  greg.InvalidateRect(pp::Rect(30, 40, 10, 10));
+  pp::PaintAggregator::PaintUpdate update = greg.GetPendingUpdate();
+  ASSERT_EQ(update.paint_rects.size(),
+            static_cast<size_t>(kRows * kColumns - 1));
+  ASSERT_TRUE(update.paint_rects.back() == pp::Rect(20, 40, 30, 10));
+
+  // Scrolling moves the paints within the scroll rect.
+  pp::Rect scroll_rect(0, 0, kColumns * 20, 100);
+  greg.ScrollRect(scroll_rect, pp::Point(0, 5));
+  greg.InvalidateRect(pp::Rect(0, 105, 10, 10));
+  update = greg.GetPendingUpdate();
+  ASSERT_TRUE(update.has_scroll);
+  ASSERT_TRUE(update.paint_rects[0] == pp::Rect(0, 5, 10, 10));
+  ASSERT_TRUE(update.paint_rects[kColumns] == pp::Rect(0, 25, 10, 10));
+  // Merged with the paint just below the scroll rect, which moves to the
+  // end, before the scroll damage.
+  ASSERT_TRUE(update.paint_rects[update.paint_rects.size() - 2] ==
+              pp::Rect(0, 100, 10, 15));
+
+  greg.ClearPendingUpdate();
+  greg.InvalidateRect(pp::Rect(1, 2, 3, 4));
+  ASSERT_EQ(greg.GetPendingUpdate().paint_rects.size(), 1U);
+  PASS();
+}
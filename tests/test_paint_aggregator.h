@@ -36,6 +36,7 @@ class TestPaintAggregator : public TestCase {
   std::string TestContainedPaintEliminatedByScroll();
   std::string TestContainedPaintAfterScrollTrimmedByScrollDamage();
   std::string TestContainedPaintAfterScrollEliminatedByScrollDamage();
+  std::string TestManyInvalidations();
 };
 
 #endif  // PPAPI_TESTS_TEST_PAINT_AGGREGATOR_H_
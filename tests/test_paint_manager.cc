@@ -0,0 +1,442 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_paint_manager.h"
+
+#include "ppapi/c/dev/ppb_testing_dev.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/graphics_2d.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/size.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(PaintManager);
+
+namespace {
+
+const int32_t kViewWidth = 64;
+const int32_t kViewHeight = 48;
+
+// How often and how long WaitForPaint polls the device.
+const int32_t kCheckIntervalMs = 10;
+const int kMaxChecks = 100;
+
+}  // namespace
+
+TestPaintManager::TestPaintManager(TestingInstance* instance)
+    : TestCase(instance),
+      testing_interface_(NULL),
+      last_buffer_(0),
+      last_paint_time_(0),
+      paint_count_(0),
+      checks_left_(0),
+      view_correct_(false),
+      frame_count_(0) {
+}
+
+bool TestPaintManager::Init() {
+  testing_interface_ = reinterpret_cast<PPB_Testing_Dev const*>(
+      pp::Module::Get()->GetBrowserInterface(PPB_TESTING_DEV_INTERFACE));
+  if (!testing_interface_) {
+    // Give a more helpful error message for the testing interface being gone
+    // since that needs special enabling in Chrome.
+    instance_->AppendError("This test needs the testing interface, which is "
+        "not currently available. In Chrome, use --enable-pepper-testing when "
+        "launching.");
+    return false;
+  }
+  paint_manager_.Initialize(instance_, this, true);
+  return true;
+}
+
+void TestPaintManager::RunTest() {
+  // The steps build on each other and must run in order.
+  RUN_TEST(InitialPaint);
+  RUN_TEST(Scroll);
+  RUN_TEST(ScrollDiagonal);
+  RUN_TEST(Invalidate);
+  RUN_TEST(ScrollAndInvalidate);
+  RUN_TEST(ScrollPastView);
+  RUN_TEST(Clip);
+  RUN_TEST(ExposeClipped);
+  RUN_TEST(FullyClipped);
+  RUN_TEST(ScrollHiddenDamage);
+  RUN_TEST(Unfocused);
+  RUN_TEST(UnfocusedFrame);
+  RUN_TEST(Fullscreen);
+  RUN_TEST(FullscreenBufferAge);
+  RUN_TEST(FullscreenScroll);
+  RUN_TEST(FullscreenTripleBuffer);
+  RUN_TEST(FullscreenExit);
+}
+
+bool TestPaintManager::OnPaint(pp::Graphics2D& graphics,
+                               const std::vector<pp::Rect>& paint_rects,
+                               const pp::Rect& paint_bounds) {
+  pp::ImageData image(PP_IMAGEDATAFORMAT_BGRA_PREMUL, paint_bounds.size(),
+                      false);
+  if (image.is_null())
+    return false;
+  for (size_t i = 0; i < paint_rects.size(); i++) {
+    const pp::Rect& rect = paint_rects[i];
+    for (int32_t y = rect.y(); y < rect.bottom(); y++) {
+      uint32_t* row = image.GetAddr32(
+          pp::Point(rect.x() - paint_bounds.x(), y - paint_bounds.y()));
+      for (int32_t x = rect.x(); x < rect.right(); x++) {
+        *row++ = SceneColor(x + scroll_offset_.x(),
+                            y + scroll_offset_.y());
+      }
+    }
+    graphics.PaintImageData(image, paint_bounds.point(),
+                            pp::Rect(rect.point() - paint_bounds.point(),
+                                     rect.size()));
+    painted_bounds_ = painted_bounds_.Union(rect);
+  }
+  last_paint_time_ = pp::Module::Get()->core()->GetTimeTicks();
+  paint_count_++;
+  return true;
+}
+
+bool TestPaintManager::OnPaintBuffer(pp::ImageData& buffer,
+                                     const std::vector<pp::Rect>& paint_rects,
+                                     const pp::Rect& /* paint_bounds */) {
+  for (size_t i = 0; i < paint_rects.size(); i++) {
+    const pp::Rect& rect = paint_rects[i];
+    for (int32_t y = rect.y(); y < rect.bottom(); y++) {
+      uint32_t* row = buffer.GetAddr32(pp::Point(rect.x(), y));
+      for (int32_t x = rect.x(); x < rect.right(); x++) {
+        *row++ = SceneColor(x + scroll_offset_.x(),
+                            y + scroll_offset_.y());
+      }
+    }
+    painted_bounds_ = painted_bounds_.Union(rect);
+  }
+  last_buffer_ = buffer.pp_resource();
+  last_paint_time_ = pp::Module::Get()->core()->GetTimeTicks();
+  paint_count_++;
+  return true;
+}
+
+void TestPaintManager::WillPaintFrame(PP_TimeTicks /* frame_time */) {
+  frame_count_++;
+}
+
+// static
+void TestPaintManager::CheckPaintDone(void* user_data, int32_t result) {
+  TestPaintManager* test = static_cast<TestPaintManager*>(user_data);
+  // Waiting for a paint rather than a flush: the PaintManager owns the
+  // flush callback.
+  if (test->paint_count_ > 0)
+    test->view_correct_ = test->IsViewCorrect();
+  if (test->view_correct_ || --test->checks_left_ <= 0) {
+    test->testing_interface_->QuitMessageLoop();
+    return;
+  }
+  pp::Module::Get()->core()->CallOnMainThread(
+      kCheckIntervalMs, pp::CompletionCallback(&CheckPaintDone, test), 0);
+}
+
+// static
+void TestPaintManager::QuitMessageLoop(void* user_data, int32_t result) {
+  static_cast<TestPaintManager*>(user_data)->testing_interface_->
+      QuitMessageLoop();
+}
+
+uint32_t TestPaintManager::SceneColor(int32_t x, int32_t y) const {
+  if (highlight_.Contains(x, y))
+    return 0xFFFF8000;
+  // A checkerboard of 8x8 squares with a gradient inside each square, so
+  // that a scroll by the wrong amount shows.
+  uint32_t red = ((x & 7) << 5) | 0x10;
+  uint32_t green = ((y & 7) << 5) | 0x10;
+  uint32_t blue = ((x >> 3) + (y >> 3)) & 1 ? 0xC0 : 0x40;
+  return 0xFF000000 | (red << 16) | (green << 8) | blue;
+}
+
+bool TestPaintManager::IsViewCorrect() const {
+  const pp::Graphics2D& graphics = paint_manager_.graphics();
+  pp::ImageData readback(PP_IMAGEDATAFORMAT_BGRA_PREMUL, graphics.size(),
+                         false);
+  if (readback.is_null())
+    return false;
+  pp::Point origin(0, 0);
+  if (!testing_interface_->ReadImageData(graphics.pp_resource(),
+                                         readback.pp_resource(),
+                                         &origin.pp_point()))
+    return false;
+  pp::Rect visible = paint_manager_.GetVisibleRect();
+  for (int32_t y = visible.y(); y < visible.bottom(); y++) {
+    for (int32_t x = visible.x(); x < visible.right(); x++) {
+      if (*readback.GetAddr32(pp::Point(x, y)) !=
+          SceneColor(x + scroll_offset_.x(), y + scroll_offset_.y()))
+        return false;
+    }
+  }
+  return true;
+}
+
+void TestPaintManager::ScrollBy(const pp::Point& delta) {
+  scroll_offset_ = scroll_offset_ + delta;
+  paint_manager_.ScrollRect(pp::Rect(paint_manager_.graphics().size()),
+                            pp::Point(-delta.x(), -delta.y()));
+}
+
+bool TestPaintManager::WaitForPaint() {
+  painted_bounds_ = pp::Rect();
+  paint_count_ = 0;
+  checks_left_ = kMaxChecks;
+  view_correct_ = false;
+  pp::Module::Get()->core()->CallOnMainThread(
+      0, pp::CompletionCallback(&CheckPaintDone, this), 0);
+  testing_interface_->RunMessageLoop();
+  return paint_count_ == 1 && view_correct_;
+}
+
+void TestPaintManager::RunMessageLoopFor(int32_t milliseconds) {
+  pp::Module::Get()->core()->CallOnMainThread(
+      milliseconds, pp::CompletionCallback(&QuitMessageLoop, this), 0);
+  testing_interface_->RunMessageLoop();
+}
+
+void TestPaintManager::MoveHighlight(const pp::Rect& highlight) {
+  pp::Rect old_highlight = highlight_;
+  highlight_ = highlight;
+  paint_manager_.InvalidateRect(pp::Rect(old_highlight.point() -
+                                         scroll_offset_,
+                                         old_highlight.size()));
+  paint_manager_.InvalidateRect(pp::Rect(highlight_.point() - scroll_offset_,
+                                         highlight_.size()));
+}
+
+std::string TestPaintManager::TestInitialPaint() {
+  paint_manager_.SetSize(pp::Size(kViewWidth, kViewHeight));
+  ASSERT_FALSE(paint_manager_.graphics().is_null());
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestPaintManager::TestScroll() {
+  ScrollBy(pp::Point(0, 8));
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestPaintManager::TestScrollDiagonal() {
+  ScrollBy(pp::Point(5, 3));
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestPaintManager::TestInvalidate() {
+  highlight_ = pp::Rect(scroll_offset_.x() + 10, scroll_offset_.y() + 12,
+                        20, 9);
+  paint_manager_.InvalidateRect(pp::Rect(10, 12, 20, 9));
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestPaintManager::TestScrollAndInvalidate() {
+  // Moves the highlight in the same update as a scroll, so the aggregator
+  // has to combine the scroll with an invalidation that overlaps it.
+  pp::Rect old_highlight = highlight_;
+  highlight_.Offset(7, -4);
+  ScrollBy(pp::Point(-3, 6));
+  pp::Rect dirty = old_highlight.Union(highlight_);
+  paint_manager_.InvalidateRect(pp::Rect(dirty.point() - scroll_offset_,
+                                         dirty.size()));
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestPaintManager::TestScrollPastView() {
+  ScrollBy(pp::Point(0, kViewHeight * 2));
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestPaintManager::TestClip() {
+  // Only the left half is visible, so only it is painted.
+  paint_manager_.SetClip(pp::Rect(0, 0, kViewWidth / 2, kViewHeight));
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 4, scroll_offset_.y() + 20,
+                         kViewWidth - 8, 10));
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_TRUE(paint_manager_.GetVisibleRect().Contains(painted_bounds_));
+  PASS();
+}
+
+std::string TestPaintManager::TestExposeClipped() {
+  // The damage that was left out is painted when it shows.
+  paint_manager_.SetClip(pp::Rect(0, 0, kViewWidth, kViewHeight));
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_TRUE(painted_bounds_.x() >= kViewWidth / 2);
+  PASS();
+}
+
+std::string TestPaintManager::TestFullyClipped() {
+  // Nothing is painted while the plugin can't be seen...
+  paint_manager_.SetClip(pp::Rect());
+  paint_count_ = 0;
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 30, scroll_offset_.y() + 5,
+                         12, 30));
+  RunMessageLoopFor(50);
+  ASSERT_EQ(paint_count_, 0);
+
+  // ...and all of it once it can.
+  paint_manager_.SetClip(pp::Rect(0, 0, kViewWidth, kViewHeight));
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestPaintManager::TestScrollHiddenDamage() {
+  // Damage below the visible top half isn't painted, but scrolling up moves
+  // it into view, where it has to be painted.
+  paint_manager_.SetClip(pp::Rect(0, 0, kViewWidth, kViewHeight / 2));
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 8,
+                         scroll_offset_.y() + kViewHeight / 2 + 4, 20, 12));
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_TRUE(paint_manager_.GetVisibleRect().Contains(painted_bounds_));
+
+  ScrollBy(pp::Point(0, 12));
+  ASSERT_TRUE(WaitForPaint());
+
+  paint_manager_.SetClip(pp::Rect(0, 0, kViewWidth, kViewHeight));
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestPaintManager::TestUnfocused() {
+  // Without focus paints are spaced out...
+  const int32_t kIntervalMs = 100;
+  paint_manager_.set_unfocused_paint_interval(kIntervalMs);
+  paint_manager_.SetFocus(false);
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 2, scroll_offset_.y() + 2,
+                         6, 6));
+  ASSERT_TRUE(WaitForPaint());
+  PP_TimeTicks first_paint_time = last_paint_time_;
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 3, scroll_offset_.y() + 3,
+                         6, 6));
+  ASSERT_TRUE(WaitForPaint());
+  // Allows for the clock having a coarser resolution than the timers.
+  ASSERT_TRUE(last_paint_time_ - first_paint_time >=
+              (kIntervalMs - 10) / 1000.0);
+
+  // ...or stopped...
+  paint_manager_.set_unfocused_paint_interval(-1);
+  paint_count_ = 0;
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 40, scroll_offset_.y() + 3,
+                         6, 6));
+  RunMessageLoopFor(kIntervalMs * 2);
+  ASSERT_EQ(paint_count_, 0);
+
+  // ...until focus comes back.
+  paint_manager_.SetFocus(true);
+  ASSERT_TRUE(WaitForPaint());
+  PASS();
+}
+
+std::string TestPaintManager::TestUnfocusedFrame() {
+  // A frame requested while painting is stopped for lack of focus...
+  const int32_t kWaitMs = 100;
+  paint_manager_.set_unfocused_paint_interval(-1);
+  paint_manager_.SetFocus(false);
+  paint_manager_.set_frame_listener(this);
+  frame_count_ = 0;
+  paint_manager_.RequestFrame();
+  RunMessageLoopFor(kWaitMs);
+  ASSERT_EQ(frame_count_, 0);
+
+  // ...starts when focus comes back, with nothing to paint.
+  paint_manager_.SetFocus(true);
+  RunMessageLoopFor(kWaitMs);
+  paint_manager_.set_frame_listener(NULL);
+  ASSERT_EQ(frame_count_, 1);
+  PASS();
+}
+
+std::string TestPaintManager::TestFullscreen() {
+  // The first frame paints a whole buffer.
+  paint_manager_.SetFullscreenMode(true);
+  ASSERT_TRUE(paint_manager_.is_fullscreen_mode());
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_TRUE(painted_bounds_ == pp::Rect(kViewWidth, kViewHeight));
+  ASSERT_TRUE(last_buffer_ != 0);
+  PASS();
+}
+
+std::string TestPaintManager::TestFullscreenBufferAge() {
+  // The second buffer is new, so it's painted whole too.
+  PP_Resource first_buffer = last_buffer_;
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 4, scroll_offset_.y() + 4,
+                         8, 8));
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_TRUE(painted_bounds_ == pp::Rect(kViewWidth, kViewHeight));
+  PP_Resource second_buffer = last_buffer_;
+  ASSERT_TRUE(second_buffer != first_buffer);
+
+  // The first buffer comes back one frame behind: it's painted with the
+  // damage of this frame and the last one, which had the highlight of
+  // TestUnfocused at 40,3, and no more.
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 40, scroll_offset_.y() + 30,
+                         8, 8));
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_EQ(last_buffer_, first_buffer);
+  ASSERT_TRUE(painted_bounds_ == pp::Rect(4, 3, 44, 35));
+
+  // And then the second, which misses the frame above.
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 42, scroll_offset_.y() + 30,
+                         8, 8));
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_EQ(last_buffer_, second_buffer);
+  ASSERT_TRUE(painted_bounds_ == pp::Rect(4, 4, 46, 34));
+  PASS();
+}
+
+std::string TestPaintManager::TestFullscreenScroll() {
+  // The buffers don't scroll, so what scrolled is painted again.
+  ScrollBy(pp::Point(0, 6));
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_TRUE(painted_bounds_ == pp::Rect(kViewWidth, kViewHeight));
+  PASS();
+}
+
+std::string TestPaintManager::TestFullscreenTripleBuffer() {
+  // Changing the number of buffers starts over with new ones, and each is
+  // then two frames behind when it comes back.
+  paint_manager_.set_buffer_count(3);
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 2, scroll_offset_.y() + 2,
+                         6, 6));
+  ASSERT_TRUE(WaitForPaint());
+  PP_Resource first_buffer = last_buffer_;
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 10, scroll_offset_.y() + 2,
+                         6, 6));
+  ASSERT_TRUE(WaitForPaint());
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 20, scroll_offset_.y() + 2,
+                         6, 6));
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_TRUE(painted_bounds_ == pp::Rect(kViewWidth, kViewHeight));
+
+  MoveHighlight(pp::Rect(scroll_offset_.x() + 30, scroll_offset_.y() + 2,
+                         6, 6));
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_EQ(last_buffer_, first_buffer);
+  ASSERT_TRUE(painted_bounds_ == pp::Rect(2, 2, 34, 6));
+  PASS();
+}
+
+std::string TestPaintManager::TestFullscreenExit() {
+  // Leaving fullscreen mode goes back to OnPaint, which repaints the whole
+  // device.
+  paint_manager_.SetFullscreenMode(false);
+  last_buffer_ = 0;
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_EQ(last_buffer_, 0);
+  ASSERT_TRUE(painted_bounds_ == pp::Rect(kViewWidth, kViewHeight));
+
+  ScrollBy(pp::Point(0, -6));
+  ASSERT_TRUE(WaitForPaint());
+  ASSERT_EQ(last_buffer_, 0);
+  PASS();
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_PAINT_MANAGER_H_
+#define PPAPI_TESTS_TEST_PAINT_MANAGER_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_resource.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/pp_time.h"
+#include "ppapi/cpp/paint_manager.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/tests/test_case.h"
+
+struct PPB_Testing_Dev;
+
+// Paints a scrolling scene through pp::PaintManager and checks the device
+// against the scene after every paint. Each wait is for exactly one frame,
+// so the headless host can also compare the frames with the goldens in
+// tests/goldens/PaintManager.
+class TestPaintManager : public TestCase,
+                         public pp::PaintManager::Client,
+                         public pp::PaintManager::FrameListener {
+ public:
+  explicit TestPaintManager(TestingInstance* instance);
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+  // pp::PaintManager::Client implementation.
+  virtual bool OnPaint(pp::Graphics2D& graphics,
+                       const std::vector<pp::Rect>& paint_rects,
+                       const pp::Rect& paint_bounds);
+  virtual bool OnPaintBuffer(pp::ImageData& buffer,
+                             const std::vector<pp::Rect>& paint_rects,
+                             const pp::Rect& paint_bounds);
+
+  // pp::PaintManager::FrameListener implementation.
+  virtual void WillPaintFrame(PP_TimeTicks frame_time);
+
+ private:
+  static void CheckPaintDone(void* user_data, int32_t result);
+  static void QuitMessageLoop(void* user_data, int32_t result);
+
+  // The color of the scene at |x|, |y| in content coordinates.
+  uint32_t SceneColor(int32_t x, int32_t y) const;
+
+  // Returns true if the visible part of the device shows the scene at the
+  // current scroll offset.
+  bool IsViewCorrect() const;
+
+  // Scrolls the view by |delta| in content coordinates.
+  void ScrollBy(const pp::Point& delta);
+
+  // Runs the message loop until the device shows the scene, or gives up
+  // after a second. Returns true if the scene was painted.
+  bool WaitForPaint();
+
+  // Runs the message loop for |milliseconds|.
+  void RunMessageLoopFor(int32_t milliseconds);
+
+  // Moves the highlight to |highlight| and invalidates the old and new one.
+  void MoveHighlight(const pp::Rect& highlight);
+
+  std::string TestInitialPaint();
+  std::string TestScroll();
+  std::string TestScrollDiagonal();
+  std::string TestInvalidate();
+  std::string TestScrollAndInvalidate();
+  std::string TestScrollPastView();
+  std::string TestClip();
+  std::string TestExposeClipped();
+  std::string TestFullyClipped();
+  std::string TestScrollHiddenDamage();
+  std::string TestUnfocused();
+  std::string TestUnfocusedFrame();
+  std::string TestFullscreen();
+  std::string TestFullscreenBufferAge();
+  std::string TestFullscreenScroll();
+  std::string TestFullscreenTripleBuffer();
+  std::string TestFullscreenExit();
+
+  const PPB_Testing_Dev* testing_interface_;
+  pp::PaintManager paint_manager_;
+
+  // Content coordinates of the top left of the view.
+  pp::Point scroll_offset_;
+
+  // Drawn over the scene, in content coordinates. May be empty.
+  pp::Rect highlight_;
+
+  // The union of the rects painted since the last WaitForPaint.
+  pp::Rect painted_bounds_;
+
+  // The buffer OnPaintBuffer last painted into.
+  PP_Resource last_buffer_;
+
+  // When OnPaint was last called, in time ticks.
+  PP_TimeTicks last_paint_time_;
+
+  // WaitForPaint state.
+  int paint_count_;
+  int checks_left_;
+  bool view_correct_;
+
+  // The number of WillPaintFrame calls.
+  int frame_count_;
+};
+
+#endif  // PPAPI_TESTS_TEST_PAINT_MANAGER_H_
@@ -0,0 +1,370 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_print_pipeline.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/dev/print_pipeline_dev.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(PrintPipeline);
+
+namespace {
+
+const int32_t kPageCount = 3;
+
+// Small enough that pages are many bands, the last one shorter.
+const int32_t kBandHeight = 7;
+
+uint32_t Luma(uint32_t red, uint32_t green, uint32_t blue) {
+  return (red * 77 + green * 150 + blue * 29 + 128) >> 8;
+}
+
+std::vector<uint32_t> GetPages(const PP_PrintPageNumberRange_Dev* ranges,
+                               uint32_t range_count) {
+  std::vector<uint32_t> pages;
+  for (uint32_t i = 0; i < range_count; i++) {
+    for (uint32_t page = ranges[i].first_page_number;
+         page <= ranges[i].last_page_number; page++)
+      pages.push_back(page);
+  }
+  return pages;
+}
+
+// The number after |key| in |text| from |pos|, or -1.
+long FindNumber(const std::string& text, const std::string& key, size_t pos) {
+  pos = text.find(key, pos);
+  if (pos == std::string::npos)
+    return -1;
+  return strtol(text.c_str() + pos + key.size(), NULL, 10);
+}
+
+// Collects the output, noting how many bands had been rasterized at each
+// write.
+class RecordingOutput : public pp::PrintPipeline_Dev::Output {
+ public:
+  explicit RecordingOutput(const int* bands_rasterized)
+      : bands_rasterized_(bands_rasterized) {
+  }
+
+  const std::string& data() const { return data_; }
+  const std::vector<int>& bands_at_write() const { return bands_at_write_; }
+
+  virtual bool Write(const void* data, size_t size) {
+    data_.append(static_cast<const char*>(data), size);
+    if (bands_rasterized_)
+      bands_at_write_.push_back(*bands_rasterized_);
+    return true;
+  }
+
+ private:
+  const int* bands_rasterized_;
+  std::string data_;
+  std::vector<int> bands_at_write_;
+};
+
+}  // namespace
+
+// Rasterizes PageColor.
+class TestPrintPipeline::Pipeline : public pp::PrintPipeline_Dev {
+ public:
+  Pipeline(pp::Instance* instance, int worker_count)
+      : pp::PrintPipeline_Dev(instance, worker_count),
+        bands_rasterized_(0) {
+    set_band_height(kBandHeight);
+  }
+
+  // Only counted right without worker threads.
+  const int* bands_rasterized() const { return &bands_rasterized_; }
+
+ protected:
+  virtual int32_t BeginPrinting(const PP_PrintSettings_Dev&) {
+    return kPageCount;
+  }
+
+  virtual void RasterizeBand(uint32_t page,
+                             const pp::Rect& band,
+                             pp::ImageData* image) {
+    for (int32_t y = 0; y < band.height(); y++) {
+      for (int32_t x = 0; x < band.width(); x++) {
+        uint32_t color = PageColor(page, band.x() + x, band.y() + y);
+        // Leaves transparent pixels alone, to check they're cleared.
+        if (color)
+          *image->GetAddr32(pp::Point(x, y)) = color;
+      }
+    }
+    bands_rasterized_++;
+  }
+
+ private:
+  int bands_rasterized_;
+};
+
+TestPrintPipeline::TestPrintPipeline(TestingInstance* instance)
+    : TestCase(instance) {
+}
+
+void TestPrintPipeline::RunTest() {
+  RUN_TEST(Formats);
+  RUN_TEST(Raster);
+  RUN_TEST(RasterGrayscale);
+  RUN_TEST(Pdf);
+  RUN_TEST(PdfStreaming);
+  RUN_TEST(BadRanges);
+}
+
+// static
+uint32_t TestPrintPipeline::PageColor(uint32_t page, int32_t x, int32_t y) {
+  // Some transparent and some half transparent pixels, which print over
+  // white, and long runs of the same color in between.
+  if ((x + y + static_cast<int32_t>(page)) % 11 == 0)
+    return 0;
+  uint32_t red = (page * 80 + (x / 16) * 20) & 0xFF;
+  uint32_t green = (y * 5) & 0xFF;
+  uint32_t blue = (x < 40) ? 0xFF : 0x20;
+  if (y % 9 == 0)
+    return 0x80000000 | (red / 2) << 16 | (green / 2) << 8 | blue / 2;
+  return 0xFF000000 | red << 16 | green << 8 | blue;
+}
+
+// static
+PP_PrintSettings_Dev TestPrintPipeline::MakeSettings(
+    PP_PrintOutputFormat_Dev format,
+    bool grayscale) {
+  PP_PrintSettings_Dev settings;
+  memset(&settings, 0, sizeof(settings));
+  settings.printable_area.size.width = 72;
+  settings.printable_area.size.height = 50;
+  settings.dpi = 144;
+  settings.orientation = PP_PRINTORIENTATION_NORMAL;
+  settings.grayscale = grayscale;
+  settings.format = format;
+  return settings;
+}
+
+// static
+std::string TestPrintPipeline::CheckPdf(
+    const std::string& pdf,
+    const PP_PrintSettings_Dev& settings,
+    const PP_PrintPageNumberRange_Dev* page_ranges,
+    uint32_t page_range_count) {
+  if (pdf.compare(0, 9, "%PDF-1.4\n") != 0)
+    return "No PDF header";
+  if (pdf.size() < 6 || pdf.compare(pdf.size() - 6, 6, "%%EOF\n") != 0)
+    return "No end of file marker";
+
+  // Every object is where the cross-reference table says.
+  long xref = FindNumber(pdf, "startxref\n", pdf.rfind("startxref\n"));
+  if (xref < 0 || pdf.compare(xref, 7, "xref\n0 ") != 0)
+    return "Bad startxref";
+  long object_count = FindNumber(pdf, "xref\n0 ", xref);
+  std::vector<long> offsets(object_count, 0);
+  size_t entry = pdf.find('\n', xref + 5) + 1 + 20;
+  for (long i = 1; i < object_count; i++, entry += 20) {
+    offsets[i] = strtol(pdf.c_str() + entry, NULL, 10);
+    char header[32];
+    sprintf(header, "%ld 0 obj\n", i);
+    if (pdf.compare(offsets[i], strlen(header), header) != 0)
+      return "Bad cross-reference entry";
+  }
+
+  std::vector<uint32_t> pages = GetPages(page_ranges, page_range_count);
+  if (FindNumber(pdf, "/Count ", offsets[2]) !=
+      static_cast<long>(pages.size()))
+    return "Wrong page count";
+  if (object_count != 3 + 4 * static_cast<long>(pages.size()))
+    return "Wrong object count";
+
+  int32_t width = settings.printable_area.size.width * settings.dpi / 72;
+  int32_t height = settings.printable_area.size.height * settings.dpi / 72;
+  size_t components = settings.grayscale ? 1 : 3;
+  for (size_t slot = 0; slot < pages.size(); slot++) {
+    long image_object = 5 + 4 * slot;
+    long image = offsets[image_object];
+    if (FindNumber(pdf, "/Width ", image) != width ||
+        FindNumber(pdf, "/Height ", image) != height)
+      return "Wrong image size";
+    if (pdf.find(settings.grayscale ? "/DeviceGray" : "/DeviceRGB", image) >
+        pdf.find("stream\n", image))
+      return "Wrong color space";
+
+    // Decode RunLengthDecode up to its end of data marker.
+    size_t start = pdf.find("stream\n", image) + 7;
+    size_t pos = start;
+    std::string pixels;
+    for (;;) {
+      if (pos >= pdf.size())
+        return "Unterminated image stream";
+      unsigned char length = pdf[pos++];
+      if (length == 128)
+        break;
+      if (length < 128) {
+        pixels.append(pdf, pos, length + 1);
+        pos += length + 1;
+      } else {
+        pixels.append(257 - length, pdf[pos++]);
+      }
+    }
+    if (FindNumber(pdf, " 0 obj\n", offsets[image_object + 1]) !=
+        static_cast<long>(pos - start))
+      return "Wrong stream length";
+    if (pixels.size() != width * height * components)
+      return "Wrong number of pixels";
+
+    for (int32_t y = 0; y < height; y++) {
+      for (int32_t x = 0; x < width; x++) {
+        uint32_t color = PageColor(pages[slot], x, y);
+        uint32_t white = 255 - (color >> 24);
+        uint32_t red = std::min(((color >> 16) & 0xFF) + white, 255u);
+        uint32_t green = std::min(((color >> 8) & 0xFF) + white, 255u);
+        uint32_t blue = std::min((color & 0xFF) + white, 255u);
+        const unsigned char* pixel = reinterpret_cast<const unsigned char*>(
+            pixels.data() + (y * width + x) * components);
+        if (settings.grayscale ? pixel[0] != Luma(red, green, blue) :
+            pixel[0] != red || pixel[1] != green || pixel[2] != blue)
+          return "Wrong pixel";
+      }
+    }
+  }
+  return std::string();
+}
+
+std::string TestPrintPipeline::TestFormats() {
+  Pipeline pipeline(instance_, 0);
+  uint32_t count = 0;
+  PP_PrintOutputFormat_Dev* formats =
+      pipeline.QuerySupportedPrintOutputFormats(&count);
+  ASSERT_TRUE(formats != NULL);
+  ASSERT_EQ(count, 2u);
+  ASSERT_TRUE(std::find(formats, formats + count, PP_PRINTOUTPUTFORMAT_PDF) !=
+              formats + count);
+  ASSERT_TRUE(std::find(formats, formats + count,
+                        PP_PRINTOUTPUTFORMAT_RASTER) != formats + count);
+  pp::Module::Get()->core()->MemFree(formats);
+
+  ASSERT_EQ(pipeline.PrintBegin(
+      MakeSettings(PP_PRINTOUTPUTFORMAT_POSTSCRIPT, false)), 0);
+  ASSERT_EQ(pipeline.PrintBegin(
+      MakeSettings(PP_PRINTOUTPUTFORMAT_PDF, false)), kPageCount);
+  ASSERT_TRUE(pipeline.GetPageSize() == pp::Size(144, 100));
+  pipeline.PrintEnd();
+  PASS();
+}
+
+std::string TestPrintPipeline::TestRaster() {
+  Pipeline pipeline(instance_, 3);
+  ASSERT_EQ(pipeline.PrintBegin(
+      MakeSettings(PP_PRINTOUTPUTFORMAT_RASTER, false)), kPageCount);
+  PP_PrintPageNumberRange_Dev ranges[] = { { 2, 2 }, { 0, 1 } };
+  pp::ImageData image = pipeline.RasterizePages(ranges, 2);
+  ASSERT_FALSE(image.is_null());
+  ASSERT_TRUE(image.size() == pp::Size(144, 300));
+
+  std::vector<uint32_t> pages = GetPages(ranges, 2);
+  for (int32_t y = 0; y < image.size().height(); y++) {
+    for (int32_t x = 0; x < image.size().width(); x++) {
+      ASSERT_EQ(*image.GetAddr32(pp::Point(x, y)),
+                PageColor(pages[y / 100], x, y % 100));
+    }
+  }
+
+  // PrintPages gives the same.
+  ASSERT_FALSE(pipeline.PrintPages(ranges, 2).is_null());
+  pipeline.PrintEnd();
+  PASS();
+}
+
+std::string TestPrintPipeline::TestRasterGrayscale() {
+  Pipeline pipeline(instance_, 2);
+  ASSERT_EQ(pipeline.PrintBegin(
+      MakeSettings(PP_PRINTOUTPUTFORMAT_RASTER, true)), kPageCount);
+  PP_PrintPageNumberRange_Dev range = { 1, 1 };
+  pp::ImageData image = pipeline.RasterizePages(&range, 1);
+  ASSERT_FALSE(image.is_null());
+  for (int32_t y = 0; y < image.size().height(); y++) {
+    for (int32_t x = 0; x < image.size().width(); x++) {
+      uint32_t color = PageColor(1, x, y);
+      uint32_t luma = Luma((color >> 16) & 0xFF, (color >> 8) & 0xFF,
+                           color & 0xFF);
+      ASSERT_EQ(*image.GetAddr32(pp::Point(x, y)),
+                (color & 0xFF000000) | luma << 16 | luma << 8 | luma);
+    }
+  }
+  pipeline.PrintEnd();
+  PASS();
+}
+
+std::string TestPrintPipeline::TestPdf() {
+  PP_PrintPageNumberRange_Dev ranges[] = { { 1, 2 }, { 0, 0 } };
+  for (int grayscale = 0; grayscale < 2; grayscale++) {
+    PP_PrintSettings_Dev settings =
+        MakeSettings(PP_PRINTOUTPUTFORMAT_PDF, grayscale != 0);
+
+    // The same document from worker threads and from the main thread.
+    std::string documents[2];
+    for (int workers = 0; workers < 2; workers++) {
+      Pipeline pipeline(instance_, workers * 3);
+      ASSERT_EQ(pipeline.PrintBegin(settings), kPageCount);
+      RecordingOutput output(NULL);
+      ASSERT_TRUE(pipeline.WritePdf(ranges, 2, &output));
+      pipeline.PrintEnd();
+      documents[workers] = output.data();
+    }
+    ASSERT_TRUE(documents[0] == documents[1]);
+
+    std::string error = CheckPdf(documents[0], settings, ranges, 2);
+    if (!error.empty())
+      return error;
+  }
+  PASS();
+}
+
+std::string TestPrintPipeline::TestPdfStreaming() {
+  // Each band is written before the next one is rasterized.
+  Pipeline pipeline(instance_, 0);
+  ASSERT_EQ(pipeline.PrintBegin(
+      MakeSettings(PP_PRINTOUTPUTFORMAT_PDF, false)), kPageCount);
+  RecordingOutput output(pipeline.bands_rasterized());
+  PP_PrintPageNumberRange_Dev range = { 0, 2 };
+  ASSERT_TRUE(pipeline.WritePdf(&range, 1, &output));
+  int band_count = *pipeline.bands_rasterized();
+  ASSERT_EQ(band_count, kPageCount * ((100 + kBandHeight - 1) / kBandHeight));
+  const std::vector<int>& bands_at_write = output.bands_at_write();
+  for (int i = 1; i <= band_count; i++) {
+    ASSERT_TRUE(std::find(bands_at_write.begin(), bands_at_write.end(), i) !=
+                bands_at_write.end());
+  }
+  pipeline.PrintEnd();
+  PASS();
+}
+
+std::string TestPrintPipeline::TestBadRanges() {
+  Pipeline pipeline(instance_, 2);
+  ASSERT_EQ(pipeline.PrintBegin(
+      MakeSettings(PP_PRINTOUTPUTFORMAT_RASTER, false)), kPageCount);
+  PP_PrintPageNumberRange_Dev past_end = { 1, 3 };
+  ASSERT_TRUE(pipeline.RasterizePages(&past_end, 1).is_null());
+  PP_PrintPageNumberRange_Dev backwards = { 2, 1 };
+  RecordingOutput output(NULL);
+  ASSERT_FALSE(pipeline.WritePdf(&backwards, 1, &output));
+  ASSERT_TRUE(output.data().empty());
+  ASSERT_TRUE(pipeline.RasterizePages(NULL, 0).is_null());
+  pipeline.PrintEnd();
+
+  // Nothing prints after the session ended.
+  PP_PrintPageNumberRange_Dev first = { 0, 0 };
+  ASSERT_TRUE(pipeline.RasterizePages(&first, 1).is_null());
+  PASS();
+}
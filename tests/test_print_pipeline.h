@@ -0,0 +1,49 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_PRINT_PIPELINE_H_
+#define PPAPI_TESTS_TEST_PRINT_PIPELINE_H_
+
+#include <string>
+
+#include "ppapi/c/dev/ppp_printing_dev.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/tests/test_case.h"
+
+// Prints generated pages with pp::PrintPipeline_Dev, on the main thread and
+// on worker threads, and checks the raster output and the pixels decoded
+// from the PDF output.
+class TestPrintPipeline : public TestCase {
+ public:
+  explicit TestPrintPipeline(TestingInstance* instance);
+
+  // TestCase implementation.
+  virtual void RunTest();
+
+ private:
+  class Pipeline;
+
+  // The color of |page| at |x|, |y|, BGRA premultiplied.
+  static uint32_t PageColor(uint32_t page, int32_t x, int32_t y);
+
+  // Settings for pages of 72 by 50 points at 144 dpi.
+  static PP_PrintSettings_Dev MakeSettings(PP_PrintOutputFormat_Dev format,
+                                           bool grayscale);
+
+  // Checks |pdf| against the pages of |page_ranges|. Returns an error
+  // message, or an empty string if it's right.
+  static std::string CheckPdf(const std::string& pdf,
+                              const PP_PrintSettings_Dev& settings,
+                              const PP_PrintPageNumberRange_Dev* page_ranges,
+                              uint32_t page_range_count);
+
+  std::string TestFormats();
+  std::string TestRaster();
+  std::string TestRasterGrayscale();
+  std::string TestPdf();
+  std::string TestPdfStreaming();
+  std::string TestBadRanges();
+};
+
+#endif  // PPAPI_TESTS_TEST_PRINT_PIPELINE_H_
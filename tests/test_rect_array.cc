@@ -0,0 +1,176 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_rect_array.h"
+
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect_array.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(RectArray);
+
+namespace {
+
+// Counts of rects to try: empty, less than a vector, whole vectors and
+// whole vectors with some left over.
+const size_t kCounts[] = { 0, 1, 3, 4, 8, 13, 64, 101 };
+const size_t kCountCount = sizeof(kCounts) / sizeof(kCounts[0]);
+
+// How many rects or points each count is checked with.
+const int kProbes = 200;
+
+}  // namespace
+
+bool TestRectArray::Init() {
+  return true;
+}
+
+void TestRectArray::RunTest() {
+  RUN_TEST(Edit);
+  RUN_TEST(UnionAll);
+  RUN_TEST(IntersectAll);
+  RUN_TEST(FindContaining);
+  RUN_TEST(FindTouching);
+  RUN_TEST(AreaSum);
+}
+
+int32_t TestRectArray::Random(int32_t range) {
+  seed_ = seed_ * 1103515245 + 12345;
+  return static_cast<int32_t>((seed_ >> 16) % range);
+}
+
+std::vector<pp::Rect> TestRectArray::MakeRects(size_t count) {
+  std::vector<pp::Rect> rects;
+  for (size_t i = 0; i < count; i++) {
+    if (Random(8) == 0) {
+      rects.push_back(pp::Rect());
+      continue;
+    }
+    rects.push_back(pp::Rect(Random(16) * 4 - 8, Random(16) * 4 - 8,
+                             Random(6) * 4, Random(6) * 4));
+  }
+  return rects;
+}
+
+std::string TestRectArray::TestEdit() {
+  std::vector<pp::Rect> rects = MakeRects(10);
+  pp::RectArray array;
+  ASSERT_TRUE(array.empty());
+  array.Append(rects);
+  ASSERT_EQ(array.size(), rects.size());
+  for (size_t i = 0; i < rects.size(); i++)
+    ASSERT_TRUE(array[i] == rects[i]);
+
+  array.Erase(3);
+  rects.erase(rects.begin() + 3);
+  array.Set(0, pp::Rect(1, 2, 3, 4));
+  rects[0] = pp::Rect(1, 2, 3, 4);
+  array.Append(pp::Rect(5, 6, 7, 8));
+  rects.push_back(pp::Rect(5, 6, 7, 8));
+  std::vector<pp::Rect> copy;
+  array.CopyTo(&copy);
+  ASSERT_EQ(copy.size(), rects.size());
+  for (size_t i = 0; i < rects.size(); i++)
+    ASSERT_TRUE(copy[i] == rects[i]);
+
+  array.Clear();
+  ASSERT_TRUE(array.empty());
+  PASS();
+}
+
+std::string TestRectArray::TestUnionAll() {
+  for (size_t c = 0; c < kCountCount; c++) {
+    std::vector<pp::Rect> rects = MakeRects(kCounts[c]);
+    pp::RectArray array;
+    array.Append(rects);
+    pp::Rect expected;
+    for (size_t i = 0; i < rects.size(); i++)
+      expected = expected.Union(rects[i]);
+    ASSERT_TRUE(array.UnionAll() == expected);
+  }
+
+  // All empty.
+  pp::RectArray array;
+  for (int i = 0; i < 6; i++)
+    array.Append(pp::Rect(i, i, 0, 0));
+  ASSERT_TRUE(array.UnionAll().IsEmpty());
+  PASS();
+}
+
+std::string TestRectArray::TestIntersectAll() {
+  for (size_t c = 0; c < kCountCount; c++) {
+    std::vector<pp::Rect> rects = MakeRects(kCounts[c]);
+    pp::Rect clip(Random(32) - 8, Random(32) - 8, Random(40), Random(40));
+    pp::RectArray array;
+    array.Append(rects);
+    array.IntersectAll(clip);
+    for (size_t i = 0; i < rects.size(); i++)
+      ASSERT_TRUE(array[i] == rects[i].Intersect(clip));
+  }
+  PASS();
+}
+
+std::string TestRectArray::TestFindContaining() {
+  for (size_t c = 0; c < kCountCount; c++) {
+    std::vector<pp::Rect> rects = MakeRects(kCounts[c]);
+    pp::RectArray array;
+    array.Append(rects);
+    for (int probe = 0; probe < kProbes; probe++) {
+      pp::Point point(Random(80) - 12, Random(80) - 12);
+      size_t expected = rects.size();
+      for (size_t i = 0; i < rects.size() && expected == rects.size(); i++) {
+        if (rects[i].Contains(point))
+          expected = i;
+      }
+      ASSERT_EQ(array.FindContaining(point), expected);
+      ASSERT_EQ(array.ContainsAny(point), expected != rects.size());
+    }
+  }
+  PASS();
+}
+
+std::string TestRectArray::TestFindTouching() {
+  for (size_t c = 0; c < kCountCount; c++) {
+    std::vector<pp::Rect> rects = MakeRects(kCounts[c]);
+    pp::RectArray array;
+    array.Append(rects);
+    std::vector<pp::Rect> probes = MakeRects(kProbes);
+    for (size_t p = 0; p < probes.size(); p++) {
+      const pp::Rect& rect = probes[p];
+      size_t expected = rects.size();
+      for (size_t i = 0; i < rects.size() && expected == rects.size(); i++) {
+        if (rects[i].Contains(rect) || rect.Intersects(rects[i]) ||
+            rect.SharesEdgeWith(rects[i]))
+          expected = i;
+      }
+      ASSERT_EQ(array.FindTouching(rect), expected);
+    }
+  }
+  PASS();
+}
+
+std::string TestRectArray::TestAreaSum() {
+  for (size_t c = 0; c < kCountCount; c++) {
+    std::vector<pp::Rect> rects = MakeRects(kCounts[c]);
+    pp::Rect outer(Random(16) - 8, Random(16) - 8, Random(60), Random(60));
+    pp::RectArray array;
+    array.Append(rects);
+    int64_t sum = 0;
+    int64_t contained_sum = 0;
+    for (size_t i = 0; i < rects.size(); i++) {
+      sum += rects[i].size().GetArea();
+      if (outer.Contains(rects[i]))
+        contained_sum += rects[i].size().GetArea();
+    }
+    ASSERT_EQ(array.AreaSum(), sum);
+    ASSERT_EQ(array.AreaSumContainedIn(outer), contained_sum);
+  }
+
+  // Areas that only fit in 64 bits.
+  pp::RectArray array;
+  for (int i = 0; i < 5; i++)
+    array.Append(pp::Rect(0, 0, 65536, 65536));
+  ASSERT_EQ(array.AreaSum(), static_cast<int64_t>(5) * 65536 * 65536);
+  PASS();
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_RECT_ARRAY_H_
+#define PPAPI_TESTS_TEST_RECT_ARRAY_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/tests/test_case.h"
+
+// Checks the batch operations of pp::RectArray against the Rect methods
+// applied one rect at a time, on counts that do and don't fill whole SSE2
+// vectors.
+class TestRectArray : public TestCase {
+ public:
+  TestRectArray(TestingInstance* instance)
+      : TestCase(instance), seed_(1) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+ private:
+  // Returns |count| rects on a small grid, so that they often touch, share
+  // edges or contain one another, with some empty ones among them.
+  std::vector<pp::Rect> MakeRects(size_t count);
+  int32_t Random(int32_t range);
+
+  std::string TestEdit();
+  std::string TestUnionAll();
+  std::string TestIntersectAll();
+  std::string TestFindContaining();
+  std::string TestFindTouching();
+  std::string TestAreaSum();
+
+  uint32_t seed_;
+};
+
+#endif  // PPAPI_TESTS_TEST_RECT_ARRAY_H_
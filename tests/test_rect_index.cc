@@ -0,0 +1,197 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_rect_index.h"
+
+#include <algorithm>
+
+#include "ppapi/cpp/point.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(RectIndex);
+
+namespace {
+
+const int kProbes = 300;
+
+}  // namespace
+
+bool TestRectIndex::Init() {
+  return true;
+}
+
+void TestRectIndex::RunTest() {
+  RUN_TEST(Insert);
+  RUN_TEST(MoveAndRemove);
+  RUN_TEST(HitTest);
+  RUN_TEST(ManyRects);
+}
+
+int32_t TestRectIndex::Random(int32_t range) {
+  seed_ = seed_ * 1103515245 + 12345;
+  return static_cast<int32_t>((seed_ >> 8) % range);
+}
+
+pp::Rect TestRectIndex::RandomRect() {
+  int32_t x = Random(1200) - 200;
+  int32_t y = Random(1200) - 200;
+  switch (Random(8)) {
+    case 0:
+      return pp::Rect(x, y, Random(700), Random(700));
+    case 1:
+      return pp::Rect(x, y, 0, Random(50));
+    case 2:
+      return pp::Rect(x, y, Random(50), 0);
+    default:
+      return pp::Rect(x, y, 1 + Random(90), 1 + Random(90));
+  }
+}
+
+std::string TestRectIndex::CheckQueries(const pp::RectIndex& index,
+                                        const std::vector<pp::Rect>& rects,
+                                        const std::vector<bool>& live,
+                                        int probes) {
+  std::vector<pp::RectIndex::Id> found;
+  std::vector<pp::RectIndex::Id> expected;
+  for (int probe = 0; probe < probes; probe++) {
+    pp::Point point(Random(1400) - 300, Random(1400) - 300);
+    expected.clear();
+    bool hit = false;
+    pp::RectIndex::Id top = 0;
+    for (size_t id = 0; id < rects.size(); id++) {
+      if (live[id] && rects[id].Contains(point)) {
+        expected.push_back(static_cast<pp::RectIndex::Id>(id));
+        hit = true;
+        top = static_cast<pp::RectIndex::Id>(id);
+      }
+    }
+    found.clear();
+    index.QueryPoint(point, &found);
+    std::sort(found.begin(), found.end());
+    ASSERT_TRUE(found == expected);
+    // Ids are in insertion order here, so the last one is on top.
+    pp::RectIndex::Id hit_id;
+    ASSERT_EQ(index.HitTest(point, &hit_id), hit);
+    if (hit)
+      ASSERT_EQ(hit_id, top);
+
+    pp::Rect rect = RandomRect();
+    expected.clear();
+    for (size_t id = 0; id < rects.size(); id++) {
+      if (live[id] && rects[id].Intersects(rect))
+        expected.push_back(static_cast<pp::RectIndex::Id>(id));
+    }
+    found.clear();
+    index.QueryRect(rect, &found);
+    std::sort(found.begin(), found.end());
+    ASSERT_TRUE(found == expected);
+  }
+  PASS();
+}
+
+std::string TestRectIndex::TestInsert() {
+  pp::RectIndex index;
+  std::vector<pp::Rect> rects;
+  std::vector<bool> live;
+  ASSERT_TRUE(index.empty());
+  for (size_t i = 0; i < 300; i++) {
+    rects.push_back(RandomRect());
+    live.push_back(true);
+    ASSERT_EQ(index.Insert(rects.back()), i);
+  }
+  ASSERT_EQ(index.size(), rects.size());
+  for (size_t i = 0; i < rects.size(); i++) {
+    ASSERT_TRUE(index.Contains(static_cast<pp::RectIndex::Id>(i)));
+    ASSERT_TRUE(index.GetRect(static_cast<pp::RectIndex::Id>(i)) == rects[i]);
+  }
+  return CheckQueries(index, rects, live, kProbes);
+}
+
+std::string TestRectIndex::TestMoveAndRemove() {
+  pp::RectIndex index(32);
+  std::vector<pp::Rect> rects;
+  std::vector<bool> live;
+  for (size_t i = 0; i < 300; i++) {
+    rects.push_back(RandomRect());
+    live.push_back(true);
+    index.Insert(rects.back());
+  }
+  for (int round = 0; round < 5; round++) {
+    for (size_t i = 0; i < rects.size(); i++) {
+      pp::RectIndex::Id id = static_cast<pp::RectIndex::Id>(i);
+      if (!live[i])
+        continue;
+      switch (Random(4)) {
+        case 0:
+          index.Remove(id);
+          live[i] = false;
+          break;
+        case 1:
+          // Nudged, which usually stays within the same cells.
+          rects[i].Offset(Random(5) - 2, Random(5) - 2);
+          index.Move(id, rects[i]);
+          break;
+        case 2:
+          rects[i] = RandomRect();
+          index.Move(id, rects[i]);
+          break;
+      }
+    }
+    std::string result = CheckQueries(index, rects, live, kProbes / 5);
+    if (!result.empty())
+      return result;
+  }
+
+  // Ids are reused.
+  size_t removed = std::find(live.begin(), live.end(), false) - live.begin();
+  ASSERT_TRUE(removed < live.size());
+  ASSERT_FALSE(index.Contains(static_cast<pp::RectIndex::Id>(removed)));
+  pp::RectIndex::Id id = index.Insert(pp::Rect(1, 2, 3, 4));
+  ASSERT_TRUE(id < rects.size());
+  ASSERT_FALSE(live[id]);
+
+  index.Clear();
+  ASSERT_TRUE(index.empty());
+  std::vector<pp::RectIndex::Id> found;
+  index.QueryRect(pp::Rect(-1000, -1000, 3000, 3000), &found);
+  ASSERT_TRUE(found.empty());
+  PASS();
+}
+
+std::string TestRectIndex::TestHitTest() {
+  // Later rects are on top, and moving one doesn't change that.
+  pp::RectIndex index;
+  pp::RectIndex::Id window = index.Insert(pp::Rect(0, 0, 500, 400));
+  pp::RectIndex::Id button = index.Insert(pp::Rect(20, 20, 80, 30));
+  pp::RectIndex::Id tooltip = index.Insert(pp::Rect(300, 300, 100, 20));
+  pp::RectIndex::Id hit;
+  ASSERT_TRUE(index.HitTest(pp::Point(30, 30), &hit));
+  ASSERT_EQ(hit, button);
+  ASSERT_TRUE(index.HitTest(pp::Point(200, 200), &hit));
+  ASSERT_EQ(hit, window);
+  ASSERT_FALSE(index.HitTest(pp::Point(600, 30), &hit));
+
+  index.Move(tooltip, pp::Rect(10, 10, 100, 20));
+  ASSERT_TRUE(index.HitTest(pp::Point(30, 25), &hit));
+  ASSERT_EQ(hit, tooltip);
+  ASSERT_TRUE(index.IsBelow(button, tooltip));
+
+  index.Remove(tooltip);
+  ASSERT_TRUE(index.HitTest(pp::Point(30, 25), &hit));
+  ASSERT_EQ(hit, button);
+  PASS();
+}
+
+std::string TestRectIndex::TestManyRects() {
+  // Enough rects for the table to grow several times.
+  pp::RectIndex index;
+  std::vector<pp::Rect> rects;
+  std::vector<bool> live;
+  for (size_t i = 0; i < 5000; i++) {
+    rects.push_back(RandomRect());
+    live.push_back(true);
+    index.Insert(rects.back());
+  }
+  return CheckQueries(index, rects, live, 50);
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_RECT_INDEX_H_
+#define PPAPI_TESTS_TEST_RECT_INDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/rect_index.h"
+#include "ppapi/tests/test_case.h"
+
+// Checks the queries of pp::RectIndex against going through all the rects,
+// as rects are inserted, moved and removed.
+class TestRectIndex : public TestCase {
+ public:
+  TestRectIndex(TestingInstance* instance)
+      : TestCase(instance), seed_(1) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+ private:
+  int32_t Random(int32_t range);
+
+  // A rect of the kinds the index treats differently: small ones, ones
+  // spanning many cells, ones without area and ones at negative
+  // coordinates.
+  pp::Rect RandomRect();
+
+  // Compares the queries of |index| with |rects|, the rect of each id or an
+  // empty rect for ids not in the index, at |probes| points and rects.
+  std::string CheckQueries(const pp::RectIndex& index,
+                           const std::vector<pp::Rect>& rects,
+                           const std::vector<bool>& live,
+                           int probes);
+
+  std::string TestInsert();
+  std::string TestMoveAndRemove();
+  std::string TestHitTest();
+  std::string TestManyRects();
+
+  uint32_t seed_;
+};
+
+#endif  // PPAPI_TESTS_TEST_RECT_INDEX_H_
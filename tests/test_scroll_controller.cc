@@ -0,0 +1,248 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_scroll_controller.h"
+
+#include <string.h>
+
+#include "ppapi/c/dev/ppb_testing_dev.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/core.h"
+#include "ppapi/cpp/graphics_2d.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/size.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(ScrollController);
+
+namespace {
+
+const int32_t kViewWidth = 64;
+const int32_t kViewHeight = 48;
+const int32_t kContentHeight = 400;
+const int32_t kMaxOffset = kContentHeight - kViewHeight;
+
+// How often and how long WaitForScroll polls.
+const int32_t kCheckIntervalMs = 10;
+const int kMaxChecks = 200;
+
+}  // namespace
+
+TestScrollController::TestScrollController(TestingInstance* instance)
+    : TestCase(instance),
+      testing_interface_(NULL),
+      scroll_controller_(&paint_manager_, this),
+      paints_(0),
+      offset_changes_(0),
+      has_expected_offset_(false),
+      checks_left_(0),
+      view_correct_(false) {
+}
+
+bool TestScrollController::Init() {
+  testing_interface_ = reinterpret_cast<PPB_Testing_Dev const*>(
+      pp::Module::Get()->GetBrowserInterface(PPB_TESTING_DEV_INTERFACE));
+  if (!testing_interface_) {
+    // Give a more helpful error message for the testing interface being gone
+    // since that needs special enabling in Chrome.
+    instance_->AppendError("This test needs the testing interface, which is "
+        "not currently available. In Chrome, use --enable-pepper-testing when "
+        "launching.");
+    return false;
+  }
+  paint_manager_.Initialize(instance_, this, true);
+  return true;
+}
+
+void TestScrollController::RunTest() {
+  // The steps build on each other and must run in order.
+  RUN_TEST(Initial);
+  RUN_TEST(WheelSmooth);
+  RUN_TEST(SubPixelWheel);
+  RUN_TEST(DragFling);
+  RUN_TEST(Clamp);
+  RUN_TEST(ScrollToImmediate);
+}
+
+bool TestScrollController::OnPaint(pp::Graphics2D& graphics,
+                                   const std::vector<pp::Rect>& paint_rects,
+                                   const pp::Rect& paint_bounds) {
+  pp::ImageData image(pp::ImageData::GetNativeImageDataFormat(),
+                      paint_bounds.size(), false);
+  if (image.is_null())
+    return false;
+  const pp::Point& offset = scroll_controller_.offset();
+  for (int32_t y = 0; y < paint_bounds.height(); y++) {
+    for (int32_t x = 0; x < paint_bounds.width(); x++) {
+      *image.GetAddr32(pp::Point(x, y)) =
+          ContentColor(paint_bounds.x() + x + offset.x(),
+                       paint_bounds.y() + y + offset.y());
+    }
+  }
+  for (size_t i = 0; i < paint_rects.size(); i++) {
+    pp::Rect src = paint_rects[i];
+    src.Offset(-paint_bounds.x(), -paint_bounds.y());
+    graphics.PaintImageData(image, paint_bounds.point(), src);
+  }
+  paints_++;
+  return true;
+}
+
+void TestScrollController::ScrollOffsetChanged(const pp::Point&) {
+  offset_changes_++;
+}
+
+// static
+void TestScrollController::CheckScrollDone(void* user_data, int32_t result) {
+  TestScrollController* test = static_cast<TestScrollController*>(user_data);
+  const pp::ScrollController& controller = test->scroll_controller_;
+  test->view_correct_ = !controller.IsAnimating() &&
+      (!test->has_expected_offset_ ||
+       controller.offset() == test->expected_offset_) &&
+      test->IsViewCorrect();
+  if (test->view_correct_ || --test->checks_left_ <= 0) {
+    test->testing_interface_->QuitMessageLoop();
+    return;
+  }
+  pp::Module::Get()->core()->CallOnMainThread(
+      kCheckIntervalMs, pp::CompletionCallback(&CheckScrollDone, test), 0);
+}
+
+// static
+uint32_t TestScrollController::ContentColor(int32_t x, int32_t y) {
+  return 0xFF000000 | (x * 4 & 0xFF) << 16 | (y & 0xFF) << 8 |
+      (y >> 8) << 7;
+}
+
+bool TestScrollController::IsViewCorrect() const {
+  const pp::Graphics2D& graphics = paint_manager_.graphics();
+  pp::ImageData readback(pp::ImageData::GetNativeImageDataFormat(),
+                         graphics.size(), false);
+  if (readback.is_null())
+    return false;
+  pp::Point origin(0, 0);
+  if (!testing_interface_->ReadImageData(graphics.pp_resource(),
+                                         readback.pp_resource(),
+                                         &origin.pp_point()))
+    return false;
+  const pp::Point& offset = scroll_controller_.offset();
+  for (int32_t y = 0; y < readback.size().height(); y++) {
+    for (int32_t x = 0; x < readback.size().width(); x++) {
+      if (*readback.GetAddr32(pp::Point(x, y)) !=
+          ContentColor(x + offset.x(), y + offset.y()))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool TestScrollController::WaitForScroll() {
+  checks_left_ = kMaxChecks;
+  view_correct_ = false;
+  pp::Module::Get()->core()->CallOnMainThread(
+      0, pp::CompletionCallback(&CheckScrollDone, this), 0);
+  testing_interface_->RunMessageLoop();
+  has_expected_offset_ = false;
+  return view_correct_;
+}
+
+bool TestScrollController::WaitForOffset(const pp::Point& offset) {
+  has_expected_offset_ = true;
+  expected_offset_ = offset;
+  return WaitForScroll();
+}
+
+void TestScrollController::SendWheel(float delta_y) {
+  PP_InputEvent event;
+  memset(&event, 0, sizeof(event));
+  event.type = PP_INPUTEVENT_TYPE_MOUSEWHEEL;
+  event.u.wheel.delta_y = delta_y;
+  scroll_controller_.HandleInputEvent(event);
+}
+
+void TestScrollController::SendMouse(PP_InputEvent_Type type,
+                                     float y,
+                                     PP_TimeTicks time_stamp) {
+  PP_InputEvent event;
+  memset(&event, 0, sizeof(event));
+  event.type = type;
+  event.time_stamp = time_stamp;
+  event.u.mouse.button = PP_INPUTEVENT_MOUSEBUTTON_LEFT;
+  event.u.mouse.x = 10;
+  event.u.mouse.y = y;
+  scroll_controller_.HandleInputEvent(event);
+}
+
+std::string TestScrollController::TestInitial() {
+  paint_manager_.SetSize(pp::Size(kViewWidth, kViewHeight));
+  scroll_controller_.SetContentSize(pp::Size(kViewWidth, kContentHeight));
+  scroll_controller_.SetViewRect(pp::Rect(0, 0, kViewWidth, kViewHeight));
+  ASSERT_TRUE(WaitForScroll());
+  ASSERT_TRUE(scroll_controller_.offset() == pp::Point(0, 0));
+  PASS();
+}
+
+std::string TestScrollController::TestWheelSmooth() {
+  paints_ = 0;
+  offset_changes_ = 0;
+  SendWheel(-40);
+  SendWheel(-40);
+  SendWheel(-40);
+  ASSERT_TRUE(scroll_controller_.IsAnimating());
+  ASSERT_TRUE(WaitForScroll());
+  ASSERT_TRUE(scroll_controller_.offset() == pp::Point(0, 120));
+  // Animated over several frames, with one scroll per frame at most.
+  ASSERT_TRUE(offset_changes_ > 1);
+  ASSERT_TRUE(offset_changes_ <= paints_);
+  PASS();
+}
+
+std::string TestScrollController::TestSubPixelWheel() {
+  // Each of these alone would round away.
+  for (int i = 0; i < 5; i++) {
+    SendWheel(-0.4f);
+    ASSERT_TRUE(WaitForScroll());
+  }
+  ASSERT_TRUE(scroll_controller_.offset() == pp::Point(0, 122));
+  PASS();
+}
+
+std::string TestScrollController::TestDragFling() {
+  scroll_controller_.set_drag_to_scroll(true);
+  // Dragging up by 30 pixels in about 0.1 s, so about 300 pixels a second.
+  SendMouse(PP_INPUTEVENT_TYPE_MOUSEDOWN, 40, 1.0);
+  ASSERT_TRUE(scroll_controller_.is_dragging());
+  SendMouse(PP_INPUTEVENT_TYPE_MOUSEMOVE, 30, 1.032);
+  SendMouse(PP_INPUTEVENT_TYPE_MOUSEMOVE, 20, 1.064);
+  SendMouse(PP_INPUTEVENT_TYPE_MOUSEMOVE, 10, 1.096);
+  SendMouse(PP_INPUTEVENT_TYPE_MOUSEUP, 10, 1.1);
+  ASSERT_FALSE(scroll_controller_.is_dragging());
+  ASSERT_TRUE(scroll_controller_.IsAnimating());
+  ASSERT_TRUE(WaitForScroll());
+  // It kept going after the drag, but slowed down before the end.
+  int32_t offset = scroll_controller_.offset().y();
+  ASSERT_TRUE(offset > 122 + 30 + 20);
+  ASSERT_TRUE(offset < kMaxOffset);
+  scroll_controller_.set_drag_to_scroll(false);
+  PASS();
+}
+
+std::string TestScrollController::TestClamp() {
+  SendWheel(-1000);
+  ASSERT_TRUE(WaitForScroll());
+  ASSERT_TRUE(scroll_controller_.offset() == pp::Point(0, kMaxOffset));
+  PASS();
+}
+
+std::string TestScrollController::TestScrollToImmediate() {
+  offset_changes_ = 0;
+  scroll_controller_.ScrollTo(0, 10.6f, false);
+  ASSERT_FALSE(scroll_controller_.IsAnimating());
+  ASSERT_TRUE(WaitForOffset(pp::Point(0, 11)));
+  ASSERT_TRUE(offset_changes_ == 1);
+  PASS();
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_SCROLL_CONTROLLER_H_
+#define PPAPI_TESTS_TEST_SCROLL_CONTROLLER_H_
+
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_input_event.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/c/pp_time.h"
+#include "ppapi/cpp/paint_manager.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/scroll_controller.h"
+#include "ppapi/tests/test_case.h"
+
+struct PPB_Testing_Dev;
+
+// Scrolls a view of a tall, patterned content area with pp::ScrollController
+// and checks that the animations end where they should, and that the device,
+// which is only ever scrolled and repainted where exposed, shows the content
+// at the final offset.
+class TestScrollController : public TestCase,
+                             public pp::PaintManager::Client,
+                             public pp::ScrollController::Client {
+ public:
+  explicit TestScrollController(TestingInstance* instance);
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+  // pp::PaintManager::Client implementation.
+  virtual bool OnPaint(pp::Graphics2D& graphics,
+                       const std::vector<pp::Rect>& paint_rects,
+                       const pp::Rect& paint_bounds);
+
+  // pp::ScrollController::Client implementation.
+  virtual void ScrollOffsetChanged(const pp::Point& offset);
+
+ private:
+  static void CheckScrollDone(void* user_data, int32_t result);
+
+  // The content's color at |x|, |y|.
+  static uint32_t ContentColor(int32_t x, int32_t y);
+
+  // Returns true if the device shows the content at the current offset.
+  bool IsViewCorrect() const;
+
+  // Runs the message loop until the controller stops animating and the
+  // device shows the content, or gives up after two seconds. Returns true if
+  // it does.
+  bool WaitForScroll();
+
+  // Like WaitForScroll, but also waits for the offset to be |offset|, for
+  // scrolls that don't animate.
+  bool WaitForOffset(const pp::Point& offset);
+
+  void SendWheel(float delta_y);
+  void SendMouse(PP_InputEvent_Type type, float y, PP_TimeTicks time_stamp);
+
+  std::string TestInitial();
+  std::string TestWheelSmooth();
+  std::string TestSubPixelWheel();
+  std::string TestDragFling();
+  std::string TestClamp();
+  std::string TestScrollToImmediate();
+
+  const PPB_Testing_Dev* testing_interface_;
+  pp::PaintManager paint_manager_;
+  pp::ScrollController scroll_controller_;
+
+  // Counted since the start of the current step.
+  int paints_;
+  int offset_changes_;
+
+  // WaitForScroll state.
+  bool has_expected_offset_;
+  pp::Point expected_offset_;
+  int checks_left_;
+  bool view_correct_;
+};
+
+#endif  // PPAPI_TESTS_TEST_SCROLL_CONTROLLER_H_
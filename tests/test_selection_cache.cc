@@ -0,0 +1,306 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_selection_cache.h"
+
+#include <stdio.h>
+
+#include "ppapi/c/dev/ppb_testing_dev.h"
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/dev/selection_cache_dev.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/var.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(SelectionCache);
+
+namespace {
+
+// Over 64 KB, so that the copied separators fill more than one chunk.
+const int kLineCount = 20000;
+
+// Not a divisor of the selection size.
+const size_t kSliceSize = 100003;
+
+}  // namespace
+
+// Selects the lines from |first_line| to |last_line| of the text, each
+// referenced, with a copied "|" in between. The html format has the lines
+// in <p> tags.
+class TestSelectionCache::Selection : public pp::SelectionCache_Dev {
+ public:
+  Selection(pp::Instance* instance, const std::string* text)
+      : pp::SelectionCache_Dev(instance),
+        text_(text),
+        first_line_(0),
+        last_line_(-1),
+        build_count_(0) {
+  }
+
+  void Select(int first_line, int last_line) {
+    first_line_ = first_line;
+    last_line_ = last_line;
+    InvalidateSelection();
+  }
+
+  // What BuildSelection should build.
+  std::string GetExpected(bool html) const {
+    std::string expected;
+    for (int i = first_line_; i <= last_line_; i++) {
+      if (html)
+        expected.append("<p>");
+      else if (i > first_line_)
+        expected.append("|");
+      expected.append(GetLine(i));
+      if (html)
+        expected.append("</p>");
+    }
+    return expected;
+  }
+
+  int build_count() const { return build_count_; }
+
+ protected:
+  virtual bool BuildSelection(bool html, Builder* builder) {
+    build_count_++;
+    if (last_line_ < first_line_)
+      return false;
+    for (int i = first_line_; i <= last_line_; i++) {
+      if (html)
+        builder->Append("<p>", 3);
+      else if (i > first_line_)
+        builder->Append("|", 1);
+      std::string line = GetLine(i);
+      builder->AppendReference(text_->data() + i * line.size(), line.size());
+      if (html)
+        builder->Append(std::string("</p>"));
+    }
+    return true;
+  }
+
+ private:
+  // All lines are the same size.
+  std::string GetLine(int line) const {
+    char buffer[32];
+    sprintf(buffer, "line %06d\n", line);
+    return buffer;
+  }
+
+  const std::string* text_;
+  int first_line_;
+  int last_line_;
+  int build_count_;
+};
+
+class TestSelectionCache::StringOutput
+    : public pp::SelectionCache_Dev::Output {
+ public:
+  StringOutput() : writes_(0), max_writes_(-1) {}
+
+  virtual bool Write(const void* data, size_t size) {
+    if (writes_ == max_writes_)
+      return false;
+    writes_++;
+    text_.append(static_cast<const char*>(data), size);
+    return true;
+  }
+
+  const std::string& text() const { return text_; }
+  int writes() const { return writes_; }
+
+  // Write fails after |count| writes.
+  void set_max_writes(int count) { max_writes_ = count; }
+
+ private:
+  std::string text_;
+  int writes_;
+  int max_writes_;
+};
+
+TestSelectionCache::TestSelectionCache(TestingInstance* instance)
+    : TestCase(instance),
+      testing_interface_(NULL),
+      stream_result_(0) {
+}
+
+bool TestSelectionCache::Init() {
+  testing_interface_ = reinterpret_cast<PPB_Testing_Dev const*>(
+      pp::Module::Get()->GetBrowserInterface(PPB_TESTING_DEV_INTERFACE));
+  if (!testing_interface_) {
+    // Give a more helpful error message for the testing interface being gone
+    // since that needs special enabling in Chrome.
+    instance_->AppendError("This test needs the testing interface, which is "
+        "not currently available. In Chrome, use --enable-pepper-testing when "
+        "launching.");
+  }
+  for (int i = 0; i < kLineCount; i++) {
+    char buffer[32];
+    sprintf(buffer, "line %06d\n", i);
+    text_.append(buffer);
+  }
+  return !!testing_interface_;
+}
+
+void TestSelectionCache::RunTest() {
+  RUN_TEST(Builder);
+  RUN_TEST(Cached);
+  RUN_TEST(MaxSize);
+  RUN_TEST(Stream);
+  RUN_TEST(StreamAbort);
+}
+
+// static
+void TestSelectionCache::RecordResult(void* user_data, int32_t result) {
+  static_cast<TestSelectionCache*>(user_data)->stream_result_ = result;
+}
+
+// static
+void TestSelectionCache::DidStream(void* user_data, int32_t result) {
+  TestSelectionCache* test = static_cast<TestSelectionCache*>(user_data);
+  test->stream_result_ = result;
+  test->testing_interface_->QuitMessageLoop();
+}
+
+int32_t TestSelectionCache::Stream(Selection* selection,
+                                   StringOutput* output) {
+  int32_t result = selection->StreamSelection(
+      false, output, pp::CompletionCallback(&DidStream, this));
+  if (result != PP_ERROR_WOULDBLOCK)
+    return result;
+  testing_interface_->RunMessageLoop();
+  return stream_result_;
+}
+
+std::string TestSelectionCache::TestBuilder() {
+  pp::SelectionCache_Dev::Builder builder;
+  ASSERT_TRUE(builder.empty());
+  ASSERT_TRUE(builder.ToVar().AsString().empty());
+
+  std::string expected;
+  std::string large(100000, 'x');
+  for (int i = 0; i < 3; i++) {
+    builder.Append("ab", 2);
+    builder.AppendReference(text_.data(), 12);
+    builder.Append(large);
+    expected.append("ab").append(text_, 0, 12).append(large);
+  }
+  ASSERT_EQ(expected.size(), builder.size());
+  ASSERT_TRUE(builder.ToString() == expected);
+  ASSERT_TRUE(builder.ToVar().AsString() == expected);
+
+  std::string part(20, '\0');
+  builder.CopyTo(100010, part.size(), &part[0]);
+  ASSERT_TRUE(part == expected.substr(100010, part.size()));
+
+  // The chunks are reused once cleared.
+  builder.Clear();
+  ASSERT_TRUE(builder.empty());
+  builder.Append("hello", 5);
+  builder.AppendReference(" world", 6);
+  ASSERT_TRUE(builder.ToString() == "hello world");
+  PASS();
+}
+
+std::string TestSelectionCache::TestCached() {
+  Selection selection(instance_, &text_);
+  ASSERT_TRUE(selection.GetSelectedText(false).is_undefined());
+
+  selection.Select(10, 15000);
+  ASSERT_EQ(1, selection.build_count());
+  pp::Var text = selection.GetSelectedText(false);
+  ASSERT_TRUE(text.AsString() == selection.GetExpected(false));
+  ASSERT_EQ(2, selection.build_count());
+
+  // Asking again returns the same Var, without building.
+  pp::Var again = selection.GetSelectedText(false);
+  ASSERT_TRUE(again.pp_var().value.as_id == text.pp_var().value.as_id);
+  ASSERT_EQ(2, selection.build_count());
+  ASSERT_EQ(selection.GetExpected(false).size(),
+            selection.GetSelectionSize(false));
+  ASSERT_EQ(2, selection.build_count());
+
+  // The formats are cached separately.
+  ASSERT_TRUE(selection.GetSelectedText(true).AsString() ==
+              selection.GetExpected(true));
+  ASSERT_EQ(3, selection.build_count());
+
+  // A new selection is built again.
+  selection.Select(3, 3);
+  ASSERT_TRUE(selection.GetSelectedText(false).AsString() ==
+              selection.GetExpected(false));
+  ASSERT_EQ(4, selection.build_count());
+  PASS();
+}
+
+std::string TestSelectionCache::TestMaxSize() {
+  Selection selection(instance_, &text_);
+  selection.set_max_selection_size(1000);
+  selection.Select(0, 10);
+  ASSERT_FALSE(selection.GetSelectedText(false).is_undefined());
+  selection.Select(0, 1000);
+  ASSERT_TRUE(selection.GetSelectedText(false).is_undefined());
+  ASSERT_EQ(selection.GetExpected(false).size(),
+            selection.GetSelectionSize(false));
+  PASS();
+}
+
+std::string TestSelectionCache::TestStream() {
+  Selection selection(instance_, &text_);
+  selection.set_stream_slice_size(kSliceSize);
+  selection.Select(1, kLineCount - 2);
+  std::string expected = selection.GetExpected(false);
+
+  StringOutput output;
+  int32_t result = selection.StreamSelection(
+      false, &output, pp::CompletionCallback(&DidStream, this));
+  ASSERT_EQ(PP_ERROR_WOULDBLOCK, result);
+  // Nothing is written, or built, until the first callback.
+  ASSERT_EQ(0, output.writes());
+  ASSERT_EQ(0, selection.build_count());
+  ASSERT_EQ(PP_ERROR_INPROGRESS,
+            selection.StreamSelection(false, &output,
+                                      pp::CompletionCallback(&DidStream,
+                                                             this)));
+  testing_interface_->RunMessageLoop();
+  ASSERT_EQ(PP_OK, stream_result_);
+  ASSERT_TRUE(output.text() == expected);
+  ASSERT_EQ(static_cast<int>((expected.size() + kSliceSize - 1) / kSliceSize),
+            output.writes());
+
+  // A failing output stops the stream.
+  StringOutput failing;
+  failing.set_max_writes(1);
+  ASSERT_EQ(PP_ERROR_FAILED, Stream(&selection, &failing));
+  ASSERT_TRUE(failing.text() == expected.substr(0, kSliceSize));
+
+  // So does having no selection.
+  selection.Select(5, 4);
+  StringOutput empty;
+  ASSERT_EQ(PP_ERROR_FAILED, Stream(&selection, &empty));
+  PASS();
+}
+
+std::string TestSelectionCache::TestStreamAbort() {
+  Selection selection(instance_, &text_);
+  selection.set_stream_slice_size(kSliceSize);
+  selection.Select(0, kLineCount - 1);
+
+  // Aborting runs the callback right away, outside the message loop.
+  StringOutput output;
+  stream_result_ = 1;
+  ASSERT_EQ(PP_ERROR_WOULDBLOCK,
+            selection.StreamSelection(false, &output,
+                                      pp::CompletionCallback(&RecordResult,
+                                                             this)));
+  selection.Select(0, 9);
+  ASSERT_EQ(PP_ERROR_ABORTED, stream_result_);
+
+  // The aborted stream's pending callback doesn't drive the new one.
+  StringOutput next;
+  ASSERT_EQ(PP_OK, Stream(&selection, &next));
+  ASSERT_TRUE(next.text() == selection.GetExpected(false));
+  ASSERT_EQ(1, next.writes());
+  PASS();
+}
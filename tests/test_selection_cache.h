@@ -0,0 +1,51 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_SELECTION_CACHE_H_
+#define PPAPI_TESTS_TEST_SELECTION_CACHE_H_
+
+#include <string>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/tests/test_case.h"
+
+struct PPB_Testing_Dev;
+
+// Builds selections of a large generated document with
+// pp::SelectionCache_Dev, and gets them back whole and streamed.
+class TestSelectionCache : public TestCase {
+ public:
+  explicit TestSelectionCache(TestingInstance* instance);
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+ private:
+  class Selection;
+  class StringOutput;
+
+  static void RecordResult(void* user_data, int32_t result);
+  static void DidStream(void* user_data, int32_t result);
+
+  // Streams the plain text selection of |selection| into |output| and waits
+  // for the end. Returns the result of the stream.
+  int32_t Stream(Selection* selection, StringOutput* output);
+
+  std::string TestBuilder();
+  std::string TestCached();
+  std::string TestMaxSize();
+  std::string TestStream();
+  std::string TestStreamAbort();
+
+  const PPB_Testing_Dev* testing_interface_;
+
+  // The document: lines of text, referenced by the selections.
+  std::string text_;
+
+  // The result of the last stream.
+  int32_t stream_result_;
+};
+
+#endif  // PPAPI_TESTS_TEST_SELECTION_CACHE_H_
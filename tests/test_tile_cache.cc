@@ -0,0 +1,488 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_tile_cache.h"
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "ppapi/c/dev/ppb_testing_dev.h"
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/graphics_2d.h"
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(TileCache);
+
+namespace {
+
+const int32_t kTileSize = 64;
+const int32_t kSurfaceWidth = 300;
+const int32_t kSurfaceHeight = 200;
+const int32_t kDeviceWidth = 100;
+const int32_t kDeviceHeight = 80;
+
+const uint32_t kPlaceholderColor = 0xFF00FF00;
+
+}  // namespace
+
+TestTileCache::TestTileCache(TestingInstance* instance)
+    : TestCase(instance),
+      testing_interface_(NULL),
+      tiles_done_(0),
+      waiting_for_tiles_(false),
+      smooth_(false),
+      last_rasterized_scale_(0),
+      zoom_factor_(0),
+      zoom_text_only_(false),
+      zoom_settled_(false),
+      zoom_settle_count_(0),
+      waiting_for_settle_(false) {
+}
+
+bool TestTileCache::Init() {
+  testing_interface_ = reinterpret_cast<PPB_Testing_Dev const*>(
+      pp::Module::Get()->GetBrowserInterface(PPB_TESTING_DEV_INTERFACE));
+  if (!testing_interface_) {
+    // Give a more helpful error message for the testing interface being gone
+    // since that needs special enabling in Chrome.
+    instance_->AppendError("This test needs the testing interface, which is "
+        "not currently available. In Chrome, use --enable-pepper-testing when "
+        "launching.");
+  }
+  return !!testing_interface_;
+}
+
+void TestTileCache::RunTest() {
+  RUN_TEST(Paint);
+  RUN_TEST(ScrollReusesTiles);
+  RUN_TEST(Invalidate);
+  RUN_TEST(Eviction);
+  RUN_TEST(Scale);
+  RUN_TEST(Workers);
+  RUN_TEST(ZoomLevels);
+  RUN_TEST(ZoomGesture);
+  RUN_TEST(ZoomWorkers);
+  RUN_TEST(TileZoom);
+}
+
+void TestTileCache::RasterizeTile(pp::ImageData* tile,
+                                  const pp::Rect& rect,
+                                  float scale) {
+  for (int32_t y = 0; y < rect.height(); y++) {
+    uint32_t* row = tile->GetAddr32(pp::Point(0, y));
+    for (int32_t x = 0; x < rect.width(); x++)
+      row[x] = smooth_ ? SmoothSurfaceColor(rect.x() + x, rect.y() + y, scale)
+                       : SurfaceColor(rect.x() + x, rect.y() + y, scale);
+  }
+  last_rasterized_scale_ = scale;
+}
+
+void TestTileCache::DidRasterizeTile(const pp::Rect& rect) {
+  tiles_done_++;
+  if (waiting_for_tiles_) {
+    waiting_for_tiles_ = false;
+    testing_interface_->QuitMessageLoop();
+  }
+}
+
+void TestTileCache::DidZoom(double factor, bool text_only, bool settled) {
+  zoom_factor_ = factor;
+  zoom_text_only_ = text_only;
+  zoom_settled_ = settled;
+  if (settled)
+    zoom_settle_count_++;
+  if (settled && waiting_for_settle_) {
+    waiting_for_settle_ = false;
+    testing_interface_->QuitMessageLoop();
+  }
+}
+
+// static
+void TestTileCache::QuitMessageLoop(void* user_data, int32_t result) {
+  TestTileCache* test = static_cast<TestTileCache*>(user_data);
+  test->testing_interface_->QuitMessageLoop();
+}
+
+// static
+uint32_t TestTileCache::SurfaceColor(int32_t x, int32_t y, float scale) {
+  uint32_t blue = scale == 1.0f ? 0x00 : 0x80;
+  return 0xFF000000 | ((x * 3) & 0xFF) << 16 | ((y * 5) & 0xFF) << 8 | blue;
+}
+
+// static
+uint32_t TestTileCache::SmoothSurfaceColor(int32_t x, int32_t y,
+                                           float scale) {
+  // Sampled at the pixel centers, in surface pixels at scale 1.
+  float u = (x + 0.5f) / scale;
+  float v = (y + 0.5f) / scale;
+  uint32_t red = static_cast<uint32_t>(u * 255 / kSurfaceWidth + 0.5f);
+  uint32_t green = static_cast<uint32_t>(v * 255 / kSurfaceHeight + 0.5f);
+  return 0xFF000000 | red << 16 | green << 8 | 0x40;
+}
+
+bool TestTileCache::PaintAll(pp::TileCache* cache,
+                             pp::Graphics2D* graphics,
+                             const pp::Point& scroll_offset) {
+  std::vector<pp::Rect> rects(1, pp::Rect(graphics->size()));
+  if (!cache->Paint(graphics, rects, scroll_offset))
+    return false;
+  int32_t result = graphics->Flush(pp::CompletionCallback(&QuitMessageLoop,
+                                                          this));
+  if (result == PP_ERROR_WOULDBLOCK)
+    testing_interface_->RunMessageLoop();
+  else if (result != PP_OK)
+    return false;
+  return true;
+}
+
+bool TestTileCache::IsSurfaceShown(const pp::Graphics2D& graphics,
+                                   const pp::Point& scroll_offset,
+                                   float scale) {
+  pp::ImageData readback(PP_IMAGEDATAFORMAT_BGRA_PREMUL, graphics.size(),
+                         false);
+  pp::Point origin(0, 0);
+  if (readback.is_null() ||
+      !testing_interface_->ReadImageData(graphics.pp_resource(),
+                                         readback.pp_resource(),
+                                         &origin.pp_point()))
+    return false;
+  for (int32_t y = 0; y < graphics.size().height(); y++) {
+    for (int32_t x = 0; x < graphics.size().width(); x++) {
+      if (*readback.GetAddr32(pp::Point(x, y)) !=
+          SurfaceColor(x + scroll_offset.x(), y + scroll_offset.y(), scale))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool TestTileCache::IsSmoothSurfaceShown(const pp::Graphics2D& graphics,
+                                         const pp::Point& scroll_offset,
+                                         float scale,
+                                         int tolerance) {
+  pp::ImageData readback(PP_IMAGEDATAFORMAT_BGRA_PREMUL, graphics.size(),
+                         false);
+  pp::Point origin(0, 0);
+  if (readback.is_null() ||
+      !testing_interface_->ReadImageData(graphics.pp_resource(),
+                                         readback.pp_resource(),
+                                         &origin.pp_point()))
+    return false;
+  for (int32_t y = 0; y < graphics.size().height(); y++) {
+    for (int32_t x = 0; x < graphics.size().width(); x++) {
+      uint32_t shown = *readback.GetAddr32(pp::Point(x, y));
+      uint32_t expected = SmoothSurfaceColor(
+          x + scroll_offset.x(), y + scroll_offset.y(), scale);
+      for (int shift = 0; shift < 32; shift += 8) {
+        int difference = static_cast<int>((shown >> shift) & 0xFF) -
+            static_cast<int>((expected >> shift) & 0xFF);
+        if (abs(difference) > tolerance)
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+void TestTileCache::WaitForTiles(int count) {
+  // If the workers hang, the test harness times out.
+  while (tiles_done_ < count) {
+    waiting_for_tiles_ = true;
+    testing_interface_->RunMessageLoop();
+  }
+}
+
+bool TestTileCache::IsUniformColor(const pp::Graphics2D& graphics,
+                                   uint32_t color) {
+  pp::ImageData readback(PP_IMAGEDATAFORMAT_BGRA_PREMUL, graphics.size(),
+                         false);
+  pp::Point origin(0, 0);
+  if (readback.is_null() ||
+      !testing_interface_->ReadImageData(graphics.pp_resource(),
+                                         readback.pp_resource(),
+                                         &origin.pp_point()))
+    return false;
+  for (int32_t y = 0; y < graphics.size().height(); y++) {
+    for (int32_t x = 0; x < graphics.size().width(); x++) {
+      if (*readback.GetAddr32(pp::Point(x, y)) != color)
+        return false;
+    }
+  }
+  return true;
+}
+
+std::string TestTileCache::TestPaint() {
+  pp::TileCache cache(this, pp::Size(kTileSize, kTileSize), 0);
+  cache.SetSurfaceSize(pp::Size(kSurfaceWidth, kSurfaceHeight));
+  pp::Graphics2D graphics(pp::Size(kDeviceWidth, kDeviceHeight), true);
+  ASSERT_FALSE(graphics.is_null());
+
+  // The view covers 2x2 tiles.
+  pp::Point offset(10, 20);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSurfaceShown(graphics, offset, 1.0f));
+  ASSERT_EQ(4, cache.rasterized_count());
+  ASSERT_EQ(4u, cache.tile_count());
+
+  // Painting again only copies.
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_EQ(4, cache.rasterized_count());
+  PASS();
+}
+
+std::string TestTileCache::TestScrollReusesTiles() {
+  pp::TileCache cache(this, pp::Size(kTileSize, kTileSize), 0);
+  cache.SetSurfaceSize(pp::Size(kSurfaceWidth, kSurfaceHeight));
+  pp::Graphics2D graphics(pp::Size(kDeviceWidth, kDeviceHeight), true);
+  ASSERT_FALSE(graphics.is_null());
+
+  ASSERT_TRUE(PaintAll(&cache, &graphics, pp::Point(10, 20)));
+  ASSERT_EQ(4, cache.rasterized_count());
+
+  // Moving right by 30 pixels exposes the third column of tiles only.
+  pp::Point offset(40, 20);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSurfaceShown(graphics, offset, 1.0f));
+  ASSERT_EQ(6, cache.rasterized_count());
+
+  // Past the bottom right corner of the surface nothing is painted.
+  std::vector<pp::Rect> rects(1, pp::Rect(graphics.size()));
+  ASSERT_FALSE(cache.Paint(&graphics, rects,
+                           pp::Point(kSurfaceWidth, kSurfaceHeight)));
+  PASS();
+}
+
+std::string TestTileCache::TestInvalidate() {
+  pp::TileCache cache(this, pp::Size(kTileSize, kTileSize), 0);
+  cache.SetSurfaceSize(pp::Size(kSurfaceWidth, kSurfaceHeight));
+  pp::Graphics2D graphics(pp::Size(kDeviceWidth, kDeviceHeight), true);
+  ASSERT_FALSE(graphics.is_null());
+
+  pp::Point offset(10, 20);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_EQ(4, cache.rasterized_count());
+
+  // Inside the tile at column 1, row 0.
+  cache.Invalidate(pp::Rect(70, 30, 5, 5));
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSurfaceShown(graphics, offset, 1.0f));
+  ASSERT_EQ(5, cache.rasterized_count());
+
+  // Straddling all four.
+  cache.Invalidate(pp::Rect(60, 60, 8, 8));
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_EQ(9, cache.rasterized_count());
+
+  cache.InvalidateAll();
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_EQ(13, cache.rasterized_count());
+  PASS();
+}
+
+std::string TestTileCache::TestEviction() {
+  pp::TileCache cache(this, pp::Size(kTileSize, kTileSize), 0);
+  cache.SetSurfaceSize(pp::Size(kSurfaceWidth, kSurfaceHeight));
+  cache.set_max_tiles(4);
+  pp::Graphics2D graphics(pp::Size(kTileSize, kTileSize), true);
+  ASSERT_FALSE(graphics.is_null());
+
+  // Each paint is aligned to one tile.
+  for (int32_t column = 0; column < 4; column++) {
+    ASSERT_TRUE(PaintAll(&cache, &graphics,
+                         pp::Point(column * kTileSize, 0)));
+  }
+  ASSERT_EQ(4u, cache.tile_count());
+  ASSERT_EQ(4, cache.rasterized_count());
+
+  // A fifth tile evicts the least recently used, the first.
+  pp::Point offset(0, kTileSize);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSurfaceShown(graphics, offset, 1.0f));
+  ASSERT_EQ(4u, cache.tile_count());
+  ASSERT_EQ(5, cache.rasterized_count());
+  ASSERT_TRUE(PaintAll(&cache, &graphics, pp::Point(kTileSize, 0)));
+  ASSERT_EQ(5, cache.rasterized_count());
+  ASSERT_TRUE(PaintAll(&cache, &graphics, pp::Point(0, 0)));
+  ASSERT_EQ(6, cache.rasterized_count());
+
+  // Tiles needed by one paint are kept even over the budget.
+  pp::Graphics2D large(pp::Size(kSurfaceWidth, kSurfaceHeight), true);
+  ASSERT_FALSE(large.is_null());
+  ASSERT_TRUE(PaintAll(&cache, &large, pp::Point(0, 0)));
+  ASSERT_TRUE(IsSurfaceShown(large, pp::Point(0, 0), 1.0f));
+  ASSERT_EQ(20u, cache.tile_count());
+  PASS();
+}
+
+std::string TestTileCache::TestScale() {
+  pp::TileCache cache(this, pp::Size(kTileSize, kTileSize), 0);
+  cache.SetSurfaceSize(pp::Size(kSurfaceWidth, kSurfaceHeight));
+  pp::Graphics2D graphics(pp::Size(kDeviceWidth, kDeviceHeight), true);
+  ASSERT_FALSE(graphics.is_null());
+
+  pp::Point offset(10, 20);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_EQ(4, cache.rasterized_count());
+
+  cache.SetScale(2.0f);
+  ASSERT_EQ(kSurfaceWidth * 2, cache.GetScaledSurfaceSize().width());
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSurfaceShown(graphics, offset, 2.0f));
+  ASSERT_EQ(8, cache.rasterized_count());
+
+  // The tiles at scale 1 were kept.
+  cache.SetScale(1.0f);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSurfaceShown(graphics, offset, 1.0f));
+  ASSERT_EQ(8, cache.rasterized_count());
+
+  // Invalidating in scale 1 coordinates reaches the scale 2 tiles too: the
+  // rect is at (80, 60) to (90, 70) at scale 2, in two of them.
+  cache.Invalidate(pp::Rect(40, 30, 5, 5));
+  cache.SetScale(2.0f);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSurfaceShown(graphics, offset, 2.0f));
+  ASSERT_EQ(10, cache.rasterized_count());
+  PASS();
+}
+
+std::string TestTileCache::TestWorkers() {
+  pp::TileCache cache(this, pp::Size(kTileSize, kTileSize), 2);
+  cache.SetSurfaceSize(pp::Size(kSurfaceWidth, kSurfaceHeight));
+  cache.set_placeholder_color(kPlaceholderColor);
+  pp::Graphics2D graphics(pp::Size(kDeviceWidth, kDeviceHeight), true);
+  ASSERT_FALSE(graphics.is_null());
+
+  // The tiles aren't there yet, so the placeholder is painted.
+  pp::Point offset(10, 20);
+  tiles_done_ = 0;
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsUniformColor(graphics, kPlaceholderColor));
+
+  WaitForTiles(4);
+  ASSERT_EQ(4, tiles_done_);
+  ASSERT_EQ(4, cache.rasterized_count());
+
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSurfaceShown(graphics, offset, 1.0f));
+  ASSERT_EQ(4, cache.rasterized_count());
+  PASS();
+}
+
+std::string TestTileCache::TestZoomLevels() {
+  ASSERT_TRUE(pp::TileCache::GetLevelScale(1.0f) == 1.0f);
+  ASSERT_TRUE(pp::TileCache::GetLevelScale(1.2f) == 2.0f);
+  ASSERT_TRUE(pp::TileCache::GetLevelScale(2.0f) == 2.0f);
+  ASSERT_TRUE(pp::TileCache::GetLevelScale(3.0f) == 4.0f);
+  ASSERT_TRUE(pp::TileCache::GetLevelScale(0.3f) == 0.5f);
+  ASSERT_TRUE(pp::TileCache::GetLevelScale(0.25f) == 0.25f);
+  PASS();
+}
+
+std::string TestTileCache::TestZoomGesture() {
+  smooth_ = true;
+  pp::TileCache cache(this, pp::Size(kTileSize, kTileSize), 0);
+  cache.SetSurfaceSize(pp::Size(kSurfaceWidth, kSurfaceHeight));
+  pp::Graphics2D graphics(pp::Size(kDeviceWidth, kDeviceHeight), true);
+  ASSERT_FALSE(graphics.is_null());
+
+  pp::Point offset(10, 20);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_EQ(4, cache.rasterized_count());
+
+  // The steps of the gesture are scaled down from the tiles at scale 2.
+  cache.Zoom(1.5f);
+  ASSERT_TRUE(cache.is_zooming());
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(last_rasterized_scale_ == 2.0f);
+  ASSERT_TRUE(IsSmoothSurfaceShown(graphics, offset, 1.5f, 2));
+  int rasterized = cache.rasterized_count();
+
+  // At 1.7 the view shows less of the surface, all of it in those tiles.
+  cache.Zoom(1.7f);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSmoothSurfaceShown(graphics, offset, 1.7f, 2));
+  ASSERT_EQ(rasterized, cache.rasterized_count());
+
+  // Once it ends, the tiles are rendered at 1.7.
+  cache.EndZoom();
+  ASSERT_FALSE(cache.is_zooming());
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(last_rasterized_scale_ == 1.7f);
+  ASSERT_TRUE(IsSmoothSurfaceShown(graphics, offset, 1.7f, 0));
+  ASSERT_EQ(rasterized + 4, cache.rasterized_count());
+  smooth_ = false;
+  PASS();
+}
+
+std::string TestTileCache::TestZoomWorkers() {
+  smooth_ = true;
+  pp::TileCache cache(this, pp::Size(kTileSize, kTileSize), 2);
+  cache.SetSurfaceSize(pp::Size(kSurfaceWidth, kSurfaceHeight));
+  cache.set_placeholder_color(kPlaceholderColor);
+  pp::Graphics2D graphics(pp::Size(kDeviceWidth, kDeviceHeight), true);
+  ASSERT_FALSE(graphics.is_null());
+
+  pp::Point offset(10, 20);
+  tiles_done_ = 0;
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  WaitForTiles(4);
+
+  // While the tiles at scale 2 are rendered, those at scale 1 are scaled
+  // up in their place. The device shows columns and rows 0 to 2 of them.
+  cache.Zoom(1.5f);
+  tiles_done_ = 0;
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSmoothSurfaceShown(graphics, offset, 1.5f, 2));
+  WaitForTiles(9);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSmoothSurfaceShown(graphics, offset, 1.5f, 2));
+  ASSERT_EQ(13, cache.rasterized_count());
+
+  // And then, at the end of the gesture, those at scale 2 are scaled down
+  // until the tiles at 1.5 are ready.
+  cache.EndZoom();
+  tiles_done_ = 0;
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSmoothSurfaceShown(graphics, offset, 1.5f, 2));
+  WaitForTiles(4);
+  ASSERT_TRUE(PaintAll(&cache, &graphics, offset));
+  ASSERT_TRUE(IsSmoothSurfaceShown(graphics, offset, 1.5f, 0));
+  ASSERT_EQ(17, cache.rasterized_count());
+  smooth_ = false;
+  PASS();
+}
+
+std::string TestTileCache::TestTileZoom() {
+  pp::TileCache cache(this, pp::Size(kTileSize, kTileSize), 0);
+  cache.SetSurfaceSize(pp::Size(kSurfaceWidth, kSurfaceHeight));
+  pp::TileZoom_Dev zoom(instance_, &cache, this);
+  zoom.set_settle_delay_ms(20);
+  zoom_settle_count_ = 0;
+
+  zoom.Zoom(1.2, false);
+  ASSERT_TRUE(cache.is_zooming());
+  ASSERT_FALSE(zoom_settled_);
+  zoom.Zoom(1.4, false);
+  ASSERT_TRUE(cache.scale() == 1.4f);
+
+  // Only the delay after the last factor ends the gesture.
+  waiting_for_settle_ = true;
+  testing_interface_->RunMessageLoop();
+  ASSERT_FALSE(cache.is_zooming());
+  ASSERT_TRUE(zoom_factor_ == 1.4);
+  ASSERT_EQ(1, zoom_settle_count_);
+
+  // Text only zooms are left to the client.
+  zoom.Zoom(2.0, true);
+  ASSERT_TRUE(zoom_text_only_);
+  ASSERT_TRUE(zoom_settled_);
+  ASSERT_TRUE(cache.scale() == 1.4f);
+  ASSERT_FALSE(cache.is_zooming());
+  PASS();
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_TILE_CACHE_H_
+#define PPAPI_TESTS_TEST_TILE_CACHE_H_
+
+#include <string>
+
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/dev/tile_zoom_dev.h"
+#include "ppapi/cpp/tile_cache.h"
+#include "ppapi/tests/test_case.h"
+
+struct PPB_Testing_Dev;
+
+namespace pp {
+class Graphics2D;
+}
+
+class TestTileCache : public TestCase,
+                      public pp::TileCache::Client,
+                      public pp::TileZoom_Dev::Client {
+ public:
+  explicit TestTileCache(TestingInstance* instance);
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+  // pp::TileCache::Client implementation.
+  virtual void RasterizeTile(pp::ImageData* tile,
+                             const pp::Rect& rect,
+                             float scale);
+  virtual void DidRasterizeTile(const pp::Rect& rect);
+
+  // pp::TileZoom_Dev::Client implementation.
+  virtual void DidZoom(double factor, bool text_only, bool settled);
+
+ private:
+  static void QuitMessageLoop(void* user_data, int32_t result);
+
+  // The color of the surface at |x|, |y| at |scale|.
+  static uint32_t SurfaceColor(int32_t x, int32_t y, float scale);
+
+  // The color of a surface that changes smoothly, so that it looks the same
+  // scaled, at |x|, |y| at |scale|.
+  static uint32_t SmoothSurfaceColor(int32_t x, int32_t y, float scale);
+
+  // Paints all of |graphics| from |cache|, flushes and waits for the flush.
+  bool PaintAll(pp::TileCache* cache,
+                pp::Graphics2D* graphics,
+                const pp::Point& scroll_offset);
+
+  // Returns true if |graphics| shows the surface at |scroll_offset| and
+  // |scale|.
+  bool IsSurfaceShown(const pp::Graphics2D& graphics,
+                      const pp::Point& scroll_offset,
+                      float scale);
+
+  // Returns true if |graphics| shows the smooth surface at |scroll_offset|
+  // and |scale|, each channel within |tolerance|.
+  bool IsSmoothSurfaceShown(const pp::Graphics2D& graphics,
+                            const pp::Point& scroll_offset,
+                            float scale,
+                            int tolerance);
+
+  // Waits for DidRasterizeTile() to have been called |count| times since
+  // tiles_done_ was reset.
+  void WaitForTiles(int count);
+
+  // Returns true if every pixel of |graphics| is |color|.
+  bool IsUniformColor(const pp::Graphics2D& graphics, uint32_t color);
+
+  std::string TestPaint();
+  std::string TestScrollReusesTiles();
+  std::string TestInvalidate();
+  std::string TestEviction();
+  std::string TestScale();
+  std::string TestWorkers();
+  std::string TestZoomLevels();
+  std::string TestZoomGesture();
+  std::string TestZoomWorkers();
+  std::string TestTileZoom();
+
+  const PPB_Testing_Dev* testing_interface_;
+
+  // Calls to DidRasterizeTile() since the last reset.
+  int tiles_done_;
+
+  // The next DidRasterizeTile() quits the nested message loop.
+  bool waiting_for_tiles_;
+
+  // RasterizeTile() renders the smooth surface.
+  bool smooth_;
+
+  // The scale of the last tile rendered synchronously.
+  float last_rasterized_scale_;
+
+  // The arguments of the last DidZoom(), and whether one with |settled|
+  // quits the nested message loop.
+  double zoom_factor_;
+  bool zoom_text_only_;
+  bool zoom_settled_;
+  int zoom_settle_count_;
+  bool waiting_for_settle_;
+};
+
+#endif  // PPAPI_TESTS_TEST_TILE_CACHE_H_
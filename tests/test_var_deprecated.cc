@@ -7,10 +7,14 @@
 #include <string.h>
 
 #include <limits>
+#include <map>
+#include <utility>
+#include <vector>
 
 #include "ppapi/c/pp_var.h"
 #include "ppapi/c/dev/ppb_testing_dev.h"
 #include "ppapi/c/dev/ppb_var_deprecated.h"
+#include "ppapi/cpp/dev/scriptable_object_deprecated.h"
 #include "ppapi/cpp/instance.h"
 #include "ppapi/cpp/module.h"
 #include "ppapi/cpp/var.h"
@@ -20,6 +24,43 @@ static uint32_t kInvalidLength = static_cast<uint32_t>(-1);
 
 REGISTER_TEST_CASE(VarDeprecated);
 
+namespace {
+
+// An object whose properties live in a map.  Setting "readOnly" throws.
+class PropertyBag : public pp::deprecated::ScriptableObject {
+ public:
+  virtual bool HasProperty(const pp::Var& name, pp::Var* exception) {
+    return properties_.find(name.AsString()) != properties_.end();
+  }
+  virtual pp::Var GetProperty(const pp::Var& name, pp::Var* exception) {
+    std::map<std::string, pp::Var>::const_iterator it =
+        properties_.find(name.AsString());
+    if (it == properties_.end())
+      return pp::Var();
+    return it->second;
+  }
+  virtual void GetAllPropertyNames(std::vector<pp::Var>* properties,
+                                   pp::Var* exception) {
+    std::map<std::string, pp::Var>::const_iterator it = properties_.begin();
+    for (; it != properties_.end(); ++it)
+      properties->push_back(pp::Var(it->first));
+  }
+  virtual void SetProperty(const pp::Var& name,
+                           const pp::Var& value,
+                           pp::Var* exception) {
+    if (name.AsString() == "readOnly") {
+      *exception = pp::Var("readOnly can't be set");
+      return;
+    }
+    properties_[name.AsString()] = value;
+  }
+
+ private:
+  std::map<std::string, pp::Var> properties_;
+};
+
+}  // namespace
+
 bool TestVarDeprecated::Init() {
   var_interface_ = reinterpret_cast<PPB_Var_Deprecated const*>(
       pp::Module::Get()->GetBrowserInterface(PPB_VAR_DEPRECATED_INTERFACE));
@@ -43,7 +84,10 @@ void TestVarDeprecated::RunTest() {
   RUN_TEST(ValidUtf8);
   RUN_TEST(Utf8WithEmbeddedNulls);
   RUN_TEST(VarToUtf8ForWrongType);
+  RUN_TEST(StringAccess);
+  RUN_TEST(BinaryArray);
   RUN_TEST(HasPropertyAndMethod);
+  RUN_TEST(BulkProperties);
 }
 
 std::string TestVarDeprecated::TestBasicString() {
@@ -250,6 +294,136 @@ std::string TestVarDeprecated::TestVarToUtf8ForWrongType() {
   return "";
 }
 
+std::string TestVarDeprecated::TestStringAccess() {
+  static const char kUtf8WithEmbededNull[] = "prop\0erty";
+  std::string orig_string(kUtf8WithEmbededNull,
+                          sizeof(kUtf8WithEmbededNull) - 1);
+  pp::Var name(orig_string);
+  ASSERT_TRUE(name.is_string());
+
+  // The contents are read in place, nulls and all.
+  uint32_t len = kInvalidLength;
+  const char* data = name.AsUtf8(&len);
+  ASSERT_EQ(orig_string.size(), len);
+  ASSERT_EQ(0, memcmp(orig_string.data(), data, len));
+  uint32_t len2 = kInvalidLength;
+  ASSERT_EQ(data, name.AsUtf8(&len2));
+  ASSERT_EQ(len, len2);
+
+  pp::Var empty("");
+  len = kInvalidLength;
+  ASSERT_NE(NULL, empty.AsUtf8(&len));
+  ASSERT_EQ(0, len);
+
+  // Separate strings with the same contents are equal and hash the same,
+  // whether or not either has its hash yet.
+  pp::Var same(orig_string);
+  ASSERT_NE(name.pp_var().value.as_id, same.pp_var().value.as_id);
+  ASSERT_TRUE(name == same);
+  ASSERT_EQ(name.Hash(), same.Hash());
+  ASSERT_TRUE(name == same);
+  pp::Var copy(same);
+  ASSERT_EQ(same.Hash(), copy.Hash());
+  ASSERT_TRUE(copy == name);
+
+  // Strings differing only after the null, or in length, aren't.
+  pp::Var other(std::string(kUtf8WithEmbededNull, 5) + "r");
+  pp::Var prefix(std::string(kUtf8WithEmbededNull, 4));
+  ASSERT_FALSE(name == other);
+  ASSERT_FALSE(name == prefix);
+  ASSERT_FALSE(prefix == name);
+  ASSERT_NE(name.Hash(), other.Hash());
+  ASSERT_FALSE(name == other);
+  ASSERT_FALSE(empty == prefix);
+
+  // Other types hash consistently with equality too.
+  ASSERT_EQ(pp::Var(42).Hash(), pp::Var(42).Hash());
+  ASSERT_EQ(pp::Var(0.0).Hash(), pp::Var(-0.0).Hash());
+  ASSERT_TRUE(pp::Var(0.0) == pp::Var(-0.0));
+
+  // Assigning a different string drops the old hash.
+  copy = other;
+  ASSERT_EQ(other.Hash(), copy.Hash());
+  ASSERT_FALSE(copy == name);
+  copy = pp::Var(orig_string);
+  ASSERT_TRUE(copy == name);
+  ASSERT_EQ(name.Hash(), copy.Hash());
+
+  return std::string();
+}
+
+std::string TestVarDeprecated::TestBinaryArray() {
+  uint32_t before_objects = testing_interface_->GetLiveObjectCount(
+      pp::Module::Get()->pp_module());
+  {
+    const float kFloats[] = { 1.5f, -2.0f, 3.25f };
+    pp::Var floats(PP_BINARYARRAYTYPE_FLOAT32, 3, kFloats);
+    ASSERT_TRUE(floats.is_binary_array());
+
+    // Only the view of the right type gets the elements.
+    uint32_t count = kInvalidLength;
+    float* elements = floats.AsFloat32Array(&count);
+    ASSERT_EQ(3, count);
+    ASSERT_EQ(0, memcmp(kFloats, elements, sizeof(kFloats)));
+    count = kInvalidLength;
+    ASSERT_EQ(NULL, floats.AsFloat64Array(&count));
+    ASSERT_EQ(0, count);
+    ASSERT_EQ(NULL, floats.AsUint8Array(&count));
+    ASSERT_EQ(NULL, floats.AsInt32Array(&count));
+    ASSERT_EQ(NULL, pp::Var("string").AsFloat32Array(&count));
+    ASSERT_EQ(0, count);
+
+    // Copies share the elements; writes through one are seen by the others.
+    pp::Var copy(floats);
+    ASSERT_TRUE(copy == floats);
+    elements[1] = 42.0f;
+    PP_BinaryArrayType type;
+    float* copy_elements =
+        static_cast<float*>(copy.AsBinaryArray(&type, &count));
+    ASSERT_EQ(PP_BINARYARRAYTYPE_FLOAT32, type);
+    ASSERT_EQ(3, count);
+    ASSERT_EQ(42.0f, copy_elements[1]);
+
+    // Arrays with the same contents are still different arrays.
+    pp::Var same(PP_BINARYARRAYTYPE_FLOAT32, 3, elements);
+    ASSERT_FALSE(same == floats);
+
+    // Without data the elements are zeroed, and aligned for the type.
+    pp::Var doubles(PP_BINARYARRAYTYPE_FLOAT64, 1000, NULL);
+    double* double_elements = doubles.AsFloat64Array(&count);
+    ASSERT_EQ(1000, count);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(double_elements) %
+                  sizeof(double));
+    for (uint32_t i = 0; i < count; i++)
+      ASSERT_EQ(0.0, double_elements[i]);
+
+    const int32_t kInts[] = { -1, 0, 2147483647 };
+    pp::Var ints(PP_BINARYARRAYTYPE_INT32, 3, kInts);
+    ASSERT_EQ(0, memcmp(kInts, ints.AsInt32Array(&count), sizeof(kInts)));
+    const uint8_t kBytes[] = { 0, 255 };
+    pp::Var bytes(PP_BINARYARRAYTYPE_UINT8, 2, kBytes);
+    ASSERT_EQ(255, bytes.AsUint8Array(&count)[1]);
+
+    // Empty arrays still have a non-NULL data pointer.
+    pp::Var empty(PP_BINARYARRAYTYPE_UINT8, 0, NULL);
+    count = kInvalidLength;
+    ASSERT_NE(NULL, empty.AsUint8Array(&count));
+    ASSERT_EQ(0, count);
+
+    // Unknown element types are refused.
+    PP_Var bad = var_interface_->CreateBinaryArray(
+        pp::Module::Get()->pp_module(), static_cast<PP_BinaryArrayType>(9),
+        1, NULL);
+    ASSERT_EQ(PP_VARTYPE_NULL, bad.type);
+  }
+
+  // Make sure nothing leaked.
+  ASSERT_TRUE(testing_interface_->GetLiveObjectCount(
+      pp::Module::Get()->pp_module()) == before_objects);
+
+  return std::string();
+}
+
 std::string TestVarDeprecated::TestHasPropertyAndMethod() {
   uint32_t before_objects = testing_interface_->GetLiveObjectCount(
       pp::Module::Get()->pp_module());
@@ -327,3 +501,75 @@ std::string TestVarDeprecated::TestHasPropertyAndMethod() {
   return std::string();
 }
 
+std::string TestVarDeprecated::TestBulkProperties() {
+  uint32_t before_objects = testing_interface_->GetLiveObjectCount(
+      pp::Module::Get()->pp_module());
+  {
+    pp::Var bag(new PropertyBag);
+    ASSERT_TRUE(bag.is_object());
+
+    // Set three properties in one call.
+    std::vector<std::pair<pp::Var, pp::Var> > set;
+    set.push_back(std::make_pair(pp::Var("x"), pp::Var(1)));
+    set.push_back(std::make_pair(pp::Var("y"), pp::Var(2.5)));
+    set.push_back(std::make_pair(pp::Var("name"), pp::Var("bag")));
+    pp::Var exception;
+    bag.SetProperties(set, &exception);
+    ASSERT_TRUE(exception.is_undefined());
+
+    // Read them back, along with one that isn't there.
+    std::vector<pp::Var> names;
+    names.push_back(pp::Var("name"));
+    names.push_back(pp::Var("missing"));
+    names.push_back(pp::Var("x"));
+    names.push_back(pp::Var("y"));
+    std::vector<pp::Var> values;
+    bag.GetProperties(names, &values, &exception);
+    ASSERT_TRUE(exception.is_undefined());
+    ASSERT_EQ(4, values.size());
+    ASSERT_TRUE(values[0] == pp::Var("bag"));
+    ASSERT_TRUE(values[1].is_undefined());
+    ASSERT_TRUE(values[2] == pp::Var(1));
+    ASSERT_TRUE(values[3] == pp::Var(2.5));
+
+    // Enumerate everything.  PropertyBag lists its names in order.
+    std::vector<std::pair<pp::Var, pp::Var> > all;
+    bag.GetAllProperties(&all, &exception);
+    ASSERT_TRUE(exception.is_undefined());
+    ASSERT_EQ(3, all.size());
+    ASSERT_TRUE(all[0].first == pp::Var("name"));
+    ASSERT_TRUE(all[0].second == pp::Var("bag"));
+    ASSERT_TRUE(all[1].first == pp::Var("x"));
+    ASSERT_TRUE(all[1].second == pp::Var(1));
+    ASSERT_TRUE(all[2].first == pp::Var("y"));
+    ASSERT_TRUE(all[2].second == pp::Var(2.5));
+
+    // A throwing setter stops the batch; the properties before it are set.
+    set.clear();
+    set.push_back(std::make_pair(pp::Var("x"), pp::Var(10)));
+    set.push_back(std::make_pair(pp::Var("readOnly"), pp::Var(true)));
+    set.push_back(std::make_pair(pp::Var("y"), pp::Var(20)));
+    bag.SetProperties(set, &exception);
+    ASSERT_FALSE(exception.is_undefined());
+    exception = pp::Var();
+    ASSERT_TRUE(bag.GetProperty("x") == pp::Var(10));
+    ASSERT_TRUE(bag.GetProperty("y") == pp::Var(2.5));
+
+    // Bulk calls on something that isn't an object throw.
+    pp::Var string_object("asdf");
+    string_object.GetProperties(names, &values, &exception);
+    ASSERT_FALSE(exception.is_undefined());
+    ASSERT_EQ(4, values.size());
+    ASSERT_TRUE(values[0].is_undefined());
+    exception = pp::Var();
+    string_object.GetAllProperties(&all, &exception);
+    ASSERT_FALSE(exception.is_undefined());
+    ASSERT_TRUE(all.empty());
+  }
+
+  // Make sure nothing leaked.
+  ASSERT_TRUE(testing_interface_->GetLiveObjectCount(
+      pp::Module::Get()->pp_module()) == before_objects);
+
+  return std::string();
+}
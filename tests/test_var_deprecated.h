@@ -28,7 +28,10 @@ class TestVarDeprecated : public TestCase {
   std::string TestValidUtf8();
   std::string TestUtf8WithEmbeddedNulls();
   std::string TestVarToUtf8ForWrongType();
+  std::string TestStringAccess();
+  std::string TestBinaryArray();
   std::string TestHasPropertyAndMethod();
+  std::string TestBulkProperties();
 
   // Used by the tests that access the C API directly.
   const PPB_Var_Deprecated* var_interface_;
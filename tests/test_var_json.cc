@@ -0,0 +1,391 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_var_json.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "ppapi/cpp/dev/scriptable_object_deprecated.h"
+#include "ppapi/cpp/var.h"
+#include "ppapi/cpp/var_json.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(VarJSON);
+
+namespace {
+
+bool Parse(const char* json, pp::Var* result) {
+  return pp::VarJSON::Parse(json, static_cast<uint32_t>(strlen(json)),
+                            result);
+}
+
+// Parses |json| and writes it back out, or returns "error".
+std::string Reformat(const char* json) {
+  pp::Var value;
+  std::string result;
+  if (!Parse(json, &value) || !pp::VarJSON::Stringify(value, &result))
+    return "error";
+  return result;
+}
+
+// Fills a Shape from {"name": ..., "points": [[x, y], ...]}, ignoring
+// anything else, without making any vars.
+struct Shape {
+  std::string name;
+  std::vector<std::pair<int32_t, int32_t> > points;
+};
+
+class ShapeHandler : public pp::VarJSON::Handler {
+ public:
+  explicit ShapeHandler(Shape* shape)
+      : shape_(shape), depth_(0), field_(kOther), coordinate_(0) {}
+
+  virtual bool OnInt(int32_t value) {
+    if (field_ != kPoints || depth_ != 3)
+      return true;
+    if (coordinate_++ == 0)
+      shape_->points.push_back(std::make_pair(value, 0));
+    else
+      shape_->points.back().second = value;
+    return true;
+  }
+  virtual bool OnDouble(double /*value*/) {
+    // Points are whole numbers.
+    return field_ != kPoints;
+  }
+  virtual bool OnString(const char* data, uint32_t len) {
+    if (field_ == kName && depth_ == 1)
+      shape_->name.assign(data, len);
+    return true;
+  }
+  virtual bool OnBeginObject() {
+    depth_++;
+    return true;
+  }
+  virtual bool OnKey(const char* data, uint32_t len) {
+    if (depth_ != 1)
+      return true;
+    std::string key(data, len);
+    field_ = key == "name" ? kName : key == "points" ? kPoints : kOther;
+    return true;
+  }
+  virtual bool OnEndObject() {
+    depth_--;
+    return true;
+  }
+  virtual bool OnBeginArray() {
+    depth_++;
+    coordinate_ = 0;
+    return true;
+  }
+  virtual bool OnEndArray() {
+    depth_--;
+    return true;
+  }
+
+ private:
+  enum Field { kName, kPoints, kOther };
+
+  Shape* shape_;
+  int depth_;
+  Field field_;
+  int coordinate_;
+};
+
+// An object that isn't an array, though its properties are "0" and "1".
+class NotAnArray : public pp::deprecated::ScriptableObject {
+ public:
+  virtual bool HasProperty(const pp::Var& name, pp::Var* /*exception*/) {
+    return name.is_string() &&
+        (name.AsString() == "0" || name.AsString() == "1");
+  }
+  virtual pp::Var GetProperty(const pp::Var& name, pp::Var* /*exception*/) {
+    return name.AsString() == "0" ? pp::Var("zero") : pp::Var("one");
+  }
+  virtual void GetAllPropertyNames(std::vector<pp::Var>* properties,
+                                   pp::Var* /*exception*/) {
+    properties->push_back(pp::Var("0"));
+    properties->push_back(pp::Var("1"));
+  }
+};
+
+}  // namespace
+
+bool TestVarJSON::Init() {
+  return true;
+}
+
+void TestVarJSON::RunTest() {
+  RUN_TEST(ParseScalars);
+  RUN_TEST(ParseTree);
+  RUN_TEST(ParseErrors);
+  RUN_TEST(Handler);
+  RUN_TEST(Writer);
+  RUN_TEST(Stringify);
+}
+
+std::string TestVarJSON::TestParseScalars() {
+  pp::Var value;
+  ASSERT_TRUE(Parse("null", &value));
+  ASSERT_TRUE(value.is_null());
+  ASSERT_TRUE(Parse(" true ", &value));
+  ASSERT_TRUE(value.is_bool() && value.AsBool());
+  ASSERT_TRUE(Parse("\tfalse\r\n", &value));
+  ASSERT_TRUE(value.is_bool() && !value.AsBool());
+
+  // Integers that fit are ints; other numbers are doubles.
+  ASSERT_TRUE(Parse("0", &value));
+  ASSERT_TRUE(value.is_int() && value.AsInt() == 0);
+  ASSERT_TRUE(Parse("-2147483648", &value));
+  ASSERT_TRUE(value.is_int() &&
+              value.AsInt() == std::numeric_limits<int32_t>::min());
+  ASSERT_TRUE(Parse("2147483648", &value));
+  ASSERT_TRUE(value.is_double() && value.AsDouble() == 2147483648.0);
+  ASSERT_TRUE(Parse("123456789012345678901234567890", &value));
+  ASSERT_TRUE(value.is_double() && value.AsDouble() > 1.2e29);
+  ASSERT_TRUE(Parse("-0", &value));
+  ASSERT_TRUE(value.is_double() && value.AsDouble() == 0.0);
+  ASSERT_TRUE(Parse("1.5e3", &value));
+  ASSERT_TRUE(value.is_double() && value.AsDouble() == 1500.0);
+  ASSERT_TRUE(Parse("-0.25", &value));
+  ASSERT_TRUE(value.is_double() && value.AsDouble() == -0.25);
+
+  ASSERT_TRUE(Parse("\"\"", &value));
+  ASSERT_TRUE(value.is_string() && value.AsString().empty());
+  // Long enough for the word-at-a-time scan, with the quote in each
+  // position of the last word.
+  for (int len = 0; len < 24; len++) {
+    std::string text(len, 'x');
+    std::string json = "\"" + text + "\"";
+    ASSERT_TRUE(Parse(json.c_str(), &value));
+    ASSERT_TRUE(value.is_string() && value.AsString() == text);
+  }
+  ASSERT_TRUE(Parse("\"tab\\there \\\"quoted\\\" back\\\\slash\\/\"",
+                    &value));
+  ASSERT_TRUE(value.AsString() == "tab\there \"quoted\" back\\slash/");
+  // U+00E9, U+20AC and U+1D11E, the last as a surrogate pair.
+  ASSERT_TRUE(Parse("\"\\u00e9\\u20AC\\ud834\\udd1e\"", &value));
+  ASSERT_TRUE(value.AsString() == "\xc3\xa9\xe2\x82\xac\xf0\x9d\x84\x9e");
+  ASSERT_TRUE(Parse("\"\\u0000\"", &value));
+  uint32_t len;
+  const char* data = value.AsUtf8(&len);
+  ASSERT_TRUE(len == 1 && data[0] == '\0');
+  PASS();
+}
+
+std::string TestVarJSON::TestParseTree() {
+  pp::Var value;
+  ASSERT_TRUE(Parse("{\"name\": \"box\", \"size\": [3, 4.5],"
+                    " \"tags\": {}, \"next\": null, \"name\": \"crate\"}",
+                    &value));
+  ASSERT_TRUE(value.is_object());
+
+  // A repeated key replaces the earlier value in place.
+  std::vector<std::pair<pp::Var, pp::Var> > properties;
+  pp::Var exception;
+  value.GetAllProperties(&properties, &exception);
+  ASSERT_TRUE(exception.is_undefined());
+  ASSERT_EQ(4, properties.size());
+  ASSERT_TRUE(properties[0].first == pp::Var("name"));
+  ASSERT_TRUE(properties[0].second == pp::Var("crate"));
+  ASSERT_TRUE(properties[1].first == pp::Var("size"));
+  ASSERT_TRUE(properties[2].first == pp::Var("tags"));
+  ASSERT_TRUE(properties[3].first == pp::Var("next"));
+  ASSERT_TRUE(properties[3].second.is_null());
+
+  ASSERT_TRUE(value.HasProperty("size"));
+  ASSERT_FALSE(value.HasProperty("weight"));
+  pp::Var size = value.GetProperty("size");
+  ASSERT_TRUE(size.is_object());
+  ASSERT_TRUE(size.GetProperty("length") == pp::Var(2));
+  ASSERT_TRUE(size.GetProperty(pp::Var(0)) == pp::Var(3));
+  ASSERT_TRUE(size.GetProperty("1") == pp::Var(4.5));
+  ASSERT_TRUE(size.GetProperty(pp::Var(2)).is_undefined());
+
+  // Parsed objects can be changed like any other.
+  value.SetProperty("weight", pp::Var(10), &exception);
+  ASSERT_TRUE(exception.is_undefined());
+  ASSERT_TRUE(value.GetProperty("weight") == pp::Var(10));
+  value.RemoveProperty("tags", &exception);
+  ASSERT_FALSE(value.HasProperty("tags"));
+  ASSERT_TRUE(value.GetProperty("weight") == pp::Var(10));
+  size.SetProperty(pp::Var(2), pp::Var("deep"), &exception);
+  ASSERT_TRUE(exception.is_undefined());
+  ASSERT_TRUE(size.GetProperty("length") == pp::Var(3));
+  size.SetProperty(pp::Var(5), pp::Var(1), &exception);
+  ASSERT_FALSE(exception.is_undefined());
+
+  // Enough keys for the table to grow a few times.
+  std::string json = "{";
+  for (int i = 0; i < 100; i++) {
+    char member[32];
+    snprintf(member, sizeof(member), "%s\"key%d\": %d",
+             i ? ", " : "", i, i);
+    json += member;
+  }
+  json += "}";
+  ASSERT_TRUE(Parse(json.c_str(), &value));
+  for (int i = 0; i < 100; i++) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%d", i);
+    ASSERT_TRUE(value.GetProperty(key) == pp::Var(i));
+  }
+  PASS();
+}
+
+std::string TestVarJSON::TestParseErrors() {
+  static const char* kBad[] = {
+    "", " ", "nul", "truex", "[1,]", "[1 2]", "{\"a\" 1}", "{\"a\":}",
+    "{a: 1}", "{\"a\": 1,}", "01", "1.", ".5", "-", "1e", "+1", "[1] 2",
+    "\"abc", "\"a\nb\"", "\"\\x\"", "\"\\u12\"", "\"\\ud800\"",
+    "\"\\udc00\"", "\"\\ud800\\u0041\"", "\"\xff\"", "{\"\xc3\": 1}"
+  };
+  pp::Var value(42);
+  for (size_t i = 0; i < sizeof(kBad) / sizeof(kBad[0]); i++) {
+    if (Parse(kBad[i], &value))
+      return std::string("Parsed: ") + kBad[i];
+  }
+  // The result is left alone on failure.
+  ASSERT_TRUE(value == pp::Var(42));
+
+  // Nesting is limited.
+  std::string deep(pp::VarJSON::kMaxDepth, '[');
+  deep += std::string(pp::VarJSON::kMaxDepth, ']');
+  ASSERT_TRUE(Parse(deep.c_str(), &value));
+  std::string too_deep = "[" + deep + "]";
+  ASSERT_FALSE(Parse(too_deep.c_str(), &value));
+  PASS();
+}
+
+std::string TestVarJSON::TestHandler() {
+  Shape shape;
+  ShapeHandler handler(&shape);
+  const char* json =
+      "{\"id\": 7, \"name\": \"tri\\u0061ngle\", \"style\": {\"name\": \"x\"},"
+      " \"points\": [[0, 0], [10, 0], [5, 8]]}";
+  ASSERT_TRUE(pp::VarJSON::Parse(json, static_cast<uint32_t>(strlen(json)),
+                                 &handler));
+  ASSERT_TRUE(shape.name == "triangle");
+  ASSERT_EQ(3, shape.points.size());
+  ASSERT_TRUE(shape.points[2] == std::make_pair(5, 8));
+
+  // The handler can stop the parse.
+  Shape bad_shape;
+  ShapeHandler bad_handler(&bad_shape);
+  json = "{\"points\": [[0.5, 0]]}";
+  ASSERT_FALSE(pp::VarJSON::Parse(json, static_cast<uint32_t>(strlen(json)),
+                                  &bad_handler));
+  PASS();
+}
+
+std::string TestVarJSON::TestWriter() {
+  std::string json;
+  pp::VarJSON::Writer writer(&json);
+  writer.BeginObject();
+  writer.Key("ints");
+  writer.BeginArray();
+  writer.Int(0);
+  writer.Int(-17);
+  writer.Int(std::numeric_limits<int32_t>::min());
+  writer.EndArray();
+  writer.Key("doubles");
+  writer.BeginArray();
+  writer.Double(0.1);
+  writer.Double(-123.456);
+  writer.Double(1e-7);
+  writer.Double(-0.0);
+  writer.Double(9007199254740992.0);
+  writer.Double(1e300);
+  writer.Double(1.0 / 3.0);
+  writer.Double(std::numeric_limits<double>::infinity());
+  writer.Double(std::numeric_limits<double>::quiet_NaN());
+  writer.EndArray();
+  writer.Key("strings");
+  writer.BeginArray();
+  writer.String("plain");
+  writer.String("quote\" backslash\\ newline\n bell\x07 \xc3\xa9");
+  writer.String("");
+  writer.EndArray();
+  writer.Key("empty");
+  writer.BeginObject();
+  writer.EndObject();
+  writer.Key("flags");
+  writer.BeginArray();
+  writer.Bool(true);
+  writer.Bool(false);
+  writer.Null();
+  writer.EndArray();
+  writer.EndObject();
+  ASSERT_TRUE(json ==
+      "{\"ints\":[0,-17,-2147483648],"
+      "\"doubles\":[0.1,-123.456,0.0000001,0,9007199254740992,1e+300,"
+      "0.33333333333333331,"
+      "null,null],"
+      "\"strings\":[\"plain\","
+      "\"quote\\\" backslash\\\\ newline\\n bell\\u0007 \xc3\xa9\",\"\"],"
+      "\"empty\":{},"
+      "\"flags\":[true,false,null]}");
+
+  // Whatever is written reads back the same.
+  pp::Var value;
+  ASSERT_TRUE(pp::VarJSON::Parse(json.data(),
+                                 static_cast<uint32_t>(json.size()), &value));
+  pp::Var doubles = value.GetProperty("doubles");
+  ASSERT_TRUE(doubles.GetProperty(pp::Var(1)) == pp::Var(-123.456));
+  ASSERT_TRUE(doubles.GetProperty(pp::Var(2)) == pp::Var(1e-7));
+  ASSERT_TRUE(doubles.GetProperty(pp::Var(6)) == pp::Var(1.0 / 3.0));
+  pp::Var strings = value.GetProperty("strings");
+  ASSERT_TRUE(strings.GetProperty(pp::Var(1)).AsString() ==
+              "quote\" backslash\\ newline\n bell\x07 \xc3\xa9");
+  PASS();
+}
+
+std::string TestVarJSON::TestStringify() {
+  ASSERT_TRUE(Reformat(" [ 1 , \"two\" , { \"three\" : [ ] } , null ] ") ==
+              "[1,\"two\",{\"three\":[]},null]");
+  ASSERT_TRUE(Reformat("{\"a\":{\"b\":{\"c\":[true,-1.5]}}}") ==
+              "{\"a\":{\"b\":{\"c\":[true,-1.5]}}}");
+  ASSERT_TRUE(Reformat("\"\\u001f\"") == "\"\\u001f\"");
+
+  std::string json;
+  ASSERT_TRUE(pp::VarJSON::Stringify(pp::Var(), &json));
+  ASSERT_TRUE(json == "null");
+
+  // Binary arrays are arrays of numbers.
+  float floats[] = { 0.5f, -2.0f, 0.25f };
+  pp::Var binary(PP_BINARYARRAYTYPE_FLOAT32, 3, floats);
+  ASSERT_TRUE(pp::VarJSON::Stringify(binary, &json));
+  ASSERT_TRUE(json == "[0.5,-2,0.25]");
+
+  // Undefined properties are left out; undefined elements are null.
+  pp::Var value;
+  ASSERT_TRUE(Parse("{\"a\": 1, \"b\": [1], \"c\": 3}", &value));
+  value.SetProperty("a", pp::Var());
+  value.GetProperty("b").SetProperty(pp::Var(1), pp::Var());
+  ASSERT_TRUE(pp::VarJSON::Stringify(value, &json));
+  ASSERT_TRUE(json == "{\"b\":[1,null],\"c\":3}");
+
+  // Only objects with a length are arrays.
+  ASSERT_TRUE(pp::VarJSON::Stringify(pp::Var(new NotAnArray), &json));
+  ASSERT_TRUE(json == "{\"0\":\"zero\",\"1\":\"one\"}");
+
+  // An object that contains itself can't be written.
+  value.SetProperty("self", value);
+  ASSERT_FALSE(pp::VarJSON::Stringify(value, &json));
+  ASSERT_TRUE(json.empty());
+  pp::Var string = pp::VarJSON::Stringify(value);
+  ASSERT_TRUE(string.is_null());
+  // Break the cycle so the object can go away.
+  value.RemoveProperty("self");
+
+  string = pp::VarJSON::Stringify(value);
+  ASSERT_TRUE(string.is_string());
+  ASSERT_TRUE(string.AsString() == "{\"b\":[1,null],\"c\":3}");
+  PASS();
+}
@@ -0,0 +1,30 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_VAR_JSON_H_
+#define PPAPI_TESTS_TEST_VAR_JSON_H_
+
+#include <string>
+
+#include "ppapi/tests/test_case.h"
+
+// Parses and writes JSON with pp::VarJSON.
+class TestVarJSON : public TestCase {
+ public:
+  TestVarJSON(TestingInstance* instance) : TestCase(instance) {}
+
+  // TestCase implementation.
+  virtual bool Init();
+  virtual void RunTest();
+
+ private:
+  std::string TestParseScalars();
+  std::string TestParseTree();
+  std::string TestParseErrors();
+  std::string TestHandler();
+  std::string TestWriter();
+  std::string TestStringify();
+};
+
+#endif  // PPAPI_TESTS_TEST_VAR_JSON_H_
@@ -0,0 +1,280 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ppapi/tests/test_widget_cache.h"
+
+#include <string.h>
+
+#include "ppapi/cpp/image_data.h"
+#include "ppapi/cpp/point.h"
+#include "ppapi/cpp/rect.h"
+#include "ppapi/cpp/size.h"
+#include "ppapi/tests/testing_instance.h"
+
+REGISTER_TEST_CASE(WidgetCache);
+
+namespace {
+
+// The scrollbar is only ever passed back to the cache, so it doesn't need to
+// be a real resource.
+const PP_Resource kScrollbarResource = 0x7FFF0001;
+
+const int32_t kThumbLength = 20;
+
+int64_t Area(const pp::Rect& rect) {
+  return static_cast<int64_t>(rect.width()) * rect.height();
+}
+
+}  // namespace
+
+TestWidgetCache::TestWidgetCache(TestingInstance* instance)
+    : TestCase(instance),
+      widget_(kScrollbarResource),
+      location_(100, 10, 16, 200),
+      value_(0),
+      hovered_(false),
+      pressed_(false),
+      style_(0) {
+}
+
+void TestWidgetCache::RunTest() {
+  // The steps build on each other and must run in order.
+  RUN_TEST(FirstPaint);
+  RUN_TEST(Unchanged);
+  RUN_TEST(ValueChange);
+  RUN_TEST(Hover);
+  RUN_TEST(PreviousValue);
+  RUN_TEST(Pressed);
+  RUN_TEST(InvalidateAll);
+  RUN_TEST(Eviction);
+  RUN_TEST(OffPlugin);
+  RUN_TEST(Resize);
+}
+
+bool TestWidgetCache::RasterizeWidget(pp::Widget_Dev* widget,
+                                      const pp::Rect& rect,
+                                      pp::ImageData* image) {
+  if (!(*widget == widget_))
+    return false;
+  // Like the browser, draws in plugin coordinates.
+  for (int32_t y = rect.y(); y < rect.bottom(); y++) {
+    for (int32_t x = rect.x(); x < rect.right(); x++) {
+      *image->GetAddr32(pp::Point(x, y)) =
+          ScrollbarColor(x - location_.x(), y - location_.y());
+    }
+  }
+  return true;
+}
+
+uint32_t TestWidgetCache::ScrollbarColor(int32_t x, int32_t y) const {
+  pp::Rect thumb = ThumbRect();
+  if (thumb.Contains(x + location_.x(), y + location_.y())) {
+    if (pressed_)
+      return 0xFF4040C0;
+    return hovered_ ? 0xFF8080FF : 0xFF6060E0;
+  }
+  return 0xFF000000 | ((x * 16 + style_) & 0xFF) << 16 | (y & 0xFF) << 8 |
+      (style_ & 0xFF);
+}
+
+pp::Rect TestWidgetCache::ThumbRect() const {
+  return pp::Rect(location_.x(), location_.y() + static_cast<int32_t>(value_),
+                  location_.width(), kThumbLength);
+}
+
+void TestWidgetCache::ChangeValue(uint32_t value) {
+  pp::Rect old_thumb = ThumbRect();
+  value_ = value;
+  Invalidate(widget_, old_thumb);
+  Invalidate(widget_, ThumbRect());
+  SetValue(widget_, value);
+}
+
+void TestWidgetCache::SendMouseEvent(PP_InputEvent_Type type,
+                                     int32_t x,
+                                     int32_t y,
+                                     bool hovered,
+                                     bool pressed) {
+  PP_InputEvent event;
+  memset(&event, 0, sizeof(event));
+  event.type = type;
+  event.u.mouse.x = static_cast<float>(x);
+  event.u.mouse.y = static_cast<float>(y);
+  if (hovered != hovered_ || pressed != pressed_) {
+    hovered_ = hovered;
+    pressed_ = pressed;
+    Invalidate(widget_, ThumbRect());
+  }
+  HandleEvent(widget_, event);
+}
+
+bool TestWidgetCache::PaintAndCheck(int64_t* rasterized) {
+  int64_t before = rasterized_pixels();
+  // An image of just the scrollbar, to check the image origin is used.
+  pp::ImageData image(pp::ImageData::GetNativeImageDataFormat(),
+                      location_.size(), false);
+  if (image.is_null() || !Paint(widget_, location_, &image, location_.point()))
+    return false;
+  *rasterized = rasterized_pixels() - before;
+  for (int32_t y = 0; y < location_.height(); y++) {
+    for (int32_t x = 0; x < location_.width(); x++) {
+      if (*image.GetAddr32(pp::Point(x, y)) != ScrollbarColor(x, y))
+        return false;
+    }
+  }
+  return true;
+}
+
+std::string TestWidgetCache::TestFirstPaint() {
+  SetLocation(widget_, location_);
+  int64_t rasterized = 0;
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, Area(location_));
+
+  // Part of it, into an image in plugin coordinates.
+  pp::ImageData image(pp::ImageData::GetNativeImageDataFormat(),
+                      pp::Size(location_.right(), location_.bottom()), true);
+  ASSERT_FALSE(image.is_null());
+  pp::Rect part(location_.x() + 4, location_.y() + 50, 8, 30);
+  ASSERT_TRUE(Paint(widget_, part, &image, pp::Point(0, 0)));
+  ASSERT_EQ(*image.GetAddr32(pp::Point(part.x(), part.y())),
+            ScrollbarColor(4, 50));
+  ASSERT_EQ(*image.GetAddr32(pp::Point(part.right() - 1, part.bottom() - 1)),
+            ScrollbarColor(11, 79));
+  ASSERT_EQ(*image.GetAddr32(pp::Point(part.right(), part.bottom())), 0u);
+  PASS();
+}
+
+std::string TestWidgetCache::TestUnchanged() {
+  int64_t rasterized = 0;
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, 0);
+  PASS();
+}
+
+std::string TestWidgetCache::TestValueChange() {
+  // Only the old and new thumb are rasterized.
+  pp::Rect old_thumb = ThumbRect();
+  ChangeValue(50);
+  int64_t rasterized = 0;
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, Area(old_thumb) + Area(ThumbRect()));
+  PASS();
+}
+
+std::string TestWidgetCache::TestHover() {
+  int64_t rasterized = 0;
+  SendMouseEvent(PP_INPUTEVENT_TYPE_MOUSEMOVE, location_.x() + 3,
+                 location_.y() + 55, true, false);
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, Area(ThumbRect()));
+
+  // The state before is still cached.
+  SendMouseEvent(PP_INPUTEVENT_TYPE_MOUSELEAVE, 0, 0, false, false);
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, 0);
+  PASS();
+}
+
+std::string TestWidgetCache::TestPreviousValue() {
+  ChangeValue(0);
+  int64_t rasterized = 0;
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, 0);
+  PASS();
+}
+
+std::string TestWidgetCache::TestPressed() {
+  int64_t rasterized = 0;
+  SendMouseEvent(PP_INPUTEVENT_TYPE_MOUSEDOWN, location_.x() + 3,
+                 location_.y() + 5, true, true);
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, Area(ThumbRect()));
+
+  // Released outside of the scrollbar.
+  SendMouseEvent(PP_INPUTEVENT_TYPE_MOUSEUP, 0, 0, false, false);
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, 0);
+  PASS();
+}
+
+std::string TestWidgetCache::TestInvalidateAll() {
+  style_ = 3;
+  InvalidateAll(widget_);
+  int64_t rasterized = 0;
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, Area(location_));
+
+  // The saved states are gone with the old style.
+  pp::Rect old_thumb = ThumbRect();
+  ChangeValue(50);
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, Area(old_thumb) + Area(ThumbRect()));
+  PASS();
+}
+
+std::string TestWidgetCache::TestEviction() {
+  // With one saved state, going 50 -> 100 -> 150 -> 50 has lost 50.
+  set_max_saved_states(1);
+  int64_t rasterized = 0;
+  ChangeValue(100);
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ChangeValue(150);
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  pp::Rect old_thumb = ThumbRect();
+  ChangeValue(50);
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, Area(old_thumb) + Area(ThumbRect()));
+
+  // But 150 is still there.
+  ChangeValue(150);
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, 0);
+  set_max_saved_states(4);
+  PASS();
+}
+
+std::string TestWidgetCache::TestOffPlugin() {
+  // Only what's on the plugin is rasterized when the scrollbar sticks out
+  // left of and above it...
+  pp::Rect old_location = location_;
+  location_ = pp::Rect(-8, -30, location_.width(), location_.height());
+  SetLocation(widget_, location_);
+  Invalidate(widget_, location_);
+  pp::Rect on_plugin(0, 0, location_.right(), location_.bottom());
+  pp::ImageData image(pp::ImageData::GetNativeImageDataFormat(),
+                      on_plugin.size(), false);
+  int64_t before = rasterized_pixels();
+  ASSERT_TRUE(Paint(widget_, location_, &image, on_plugin.point()));
+  ASSERT_EQ(rasterized_pixels() - before, Area(on_plugin));
+  for (int32_t y = 0; y < on_plugin.bottom(); y++) {
+    for (int32_t x = 0; x < on_plugin.right(); x++) {
+      ASSERT_EQ(*image.GetAddr32(pp::Point(x, y)),
+                ScrollbarColor(x - location_.x(), y - location_.y()));
+    }
+  }
+
+  // ...so moving it onto the plugin rasterizes all of it.
+  location_ = old_location;
+  SetLocation(widget_, location_);
+  int64_t rasterized = 0;
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, Area(location_));
+  PASS();
+}
+
+std::string TestWidgetCache::TestResize() {
+  location_ = pp::Rect(location_.x(), location_.y(), location_.width(), 120);
+  SetLocation(widget_, location_);
+  Invalidate(widget_, location_);
+  int64_t rasterized = 0;
+  ASSERT_TRUE(PaintAndCheck(&rasterized));
+  ASSERT_EQ(rasterized, Area(location_));
+
+  RemoveWidget(widget_);
+  pp::ImageData image(pp::ImageData::GetNativeImageDataFormat(),
+                      location_.size(), false);
+  ASSERT_FALSE(Paint(widget_, location_, &image, location_.point()));
+  PASS();
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2010 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PPAPI_TESTS_TEST_WIDGET_CACHE_H_
+#define PPAPI_TESTS_TEST_WIDGET_CACHE_H_
+
+#include <string>
+
+#include "ppapi/c/pp_input_event.h"
+#include "ppapi/c/pp_stdint.h"
+#include "ppapi/cpp/dev/widget_cache_dev.h"
+#include "ppapi/cpp/dev/widget_dev.h"
+#include "ppapi/tests/test_case.h"
+
+// Caches a scrollbar that is rasterized by the test rather than the browser,
+// so that it can count and check what the cache has rasterized. The test
+// plays the part of the browser: it changes the scrollbar's look and
+// invalidates what changed, like a real scrollbar would.
+class TestWidgetCache : public TestCase,
+                        public pp::WidgetCache_Dev {
+ public:
+  explicit TestWidgetCache(TestingInstance* instance);
+
+  // TestCase implementation.
+  virtual void RunTest();
+
+ protected:
+  // pp::WidgetCache_Dev implementation.
+  virtual bool RasterizeWidget(pp::Widget_Dev* widget,
+                               const pp::Rect& rect,
+                               pp::ImageData* image);
+
+ private:
+  // The scrollbar's color at |x|, |y| in widget coordinates.
+  uint32_t ScrollbarColor(int32_t x, int32_t y) const;
+
+  // The thumb in plugin coordinates.
+  pp::Rect ThumbRect() const;
+
+  // Changes the value like the browser does, invalidating the old and new
+  // thumb, and tells the cache.
+  void ChangeValue(uint32_t value);
+
+  // Sends a mouse event at |x|, |y| through the cache. |hovered| and
+  // |pressed| are how the browser would draw the scrollbar after it.
+  void SendMouseEvent(PP_InputEvent_Type type,
+                      int32_t x,
+                      int32_t y,
+                      bool hovered,
+                      bool pressed);
+
+  // Paints all of the scrollbar from the cache and returns true if it's
+  // right. Sets |*rasterized| to how many pixels that rasterized.
+  bool PaintAndCheck(int64_t* rasterized);
+
+  std::string TestFirstPaint();
+  std::string TestUnchanged();
+  std::string TestValueChange();
+  std::string TestHover();
+  std::string TestPreviousValue();
+  std::string TestPressed();
+  std::string TestInvalidateAll();
+  std::string TestEviction();
+  std::string TestOffPlugin();
+  std::string TestResize();
+
+  pp::Widget_Dev widget_;
+  pp::Rect location_;
+
+  // The browser side state of the scrollbar.
+  uint32_t value_;
+  bool hovered_;
+  bool pressed_;
+  uint32_t style_;
+};
+
+#endif  // PPAPI_TESTS_TEST_WIDGET_CACHE_H_
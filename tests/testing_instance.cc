@@ -22,6 +22,12 @@ TestingInstance::TestingInstance(PP_Instance instance)
   callback_factory_.Initialize(this);
 }
 
+TestingInstance::~TestingInstance() {
+  // The test case may hold per-instance objects, like a WidgetClient_Dev,
+  // that have to be gone before pp::Instance is destroyed.
+  delete current_case_;
+}
+
 bool TestingInstance::Init(uint32_t argc, const char* argn[], const char* argv[]) {
   // Create the proper test case from the argument.
   for (uint32_t i = 0; i < argc; i++) {
@@ -15,6 +15,7 @@ class TestCase;
 class TestingInstance : public pp::Instance {
  public:
   TestingInstance(PP_Instance instance);
+  virtual ~TestingInstance();
 
   // pp::Instance override.
   virtual bool Init(uint32_t argc, const char* argn[], const char* argv[]);
@@ -41,6 +42,9 @@ class TestingInstance : public pp::Instance {
   // Appends an error message to the log.
   void AppendError(const std::string& message);
 
+  // Appends the given HTML string to the console in the document.
+  void LogHTML(const std::string& html);
+
  private:
   void ExecuteTests(int32_t unused);
 
@@ -54,9 +58,6 @@ class TestingInstance : public pp::Instance {
   // Appends the given error test to the console in the document.
   void LogError(const std::string& text);
 
-  // Appends the given HTML string to the console in the document.
-  void LogHTML(const std::string& html);
-
   // Sets the given cookie in the current document.
   void SetCookie(const std::string& name, const std::string& value);
 